@@ -83,6 +83,28 @@ struct InstancePosNormalTangentTex
     matrix WorldInvTranspose : WorldInvTranspose;
 };
 
+// 紧凑的实例数据: 只保存世界矩阵的前三列(第四列恒为(0, 0, 0, 1)),法线变换在着色器中计算
+struct InstanceCompactPosNormalTex
+{
+    float3 PosL : POSITION;
+    float3 NormalL : NORMAL;
+    float2 Tex : TEXCOORD;
+    float4 WorldCol0 : WorldAffine0;
+    float4 WorldCol1 : WorldAffine1;
+    float4 WorldCol2 : WorldAffine2;
+};
+
+struct InstanceCompactPosNormalTangentTex
+{
+    float3 PosL : POSITION;
+    float3 NormalL : NORMAL;
+    float4 TangentL : TANGENT;
+    float2 Tex : TEXCOORD;
+    float4 WorldCol0 : WorldAffine0;
+    float4 WorldCol1 : WorldAffine1;
+    float4 WorldCol2 : WorldAffine2;
+};
+
 struct VertexOutBasic
 {
     float4 PosH : SV_POSITION;
@@ -102,6 +124,30 @@ struct VertexOutNormalMap
     float4 ShadowPosH : TEXCOORD1;
 };
 
+// 以世界矩阵的前三列变换点
+float3 TransformPointAffine(float3 posL, float4 col0, float4 col1, float4 col2)
+{
+    float4 pos = float4(posL, 1.0f);
+    return float3(dot(pos, col0), dot(pos, col1), dot(pos, col2));
+}
+
+// 以世界矩阵的前三列变换向量(忽略平移)
+float3 TransformVectorAffine(float3 vecL, float4 col0, float4 col1, float4 col2)
+{
+    return float3(dot(vecL, col0.xyz), dot(vecL, col1.xyz), dot(vecL, col2.xyz));
+}
+
+// 变换法线: 左上角3x3矩阵的逆转置与它的余子式矩阵只差一个1/det的缩放,
+// 因为像素着色器会重新规范化法线,只需要保留det的符号(镜像变换时翻转法线)
+// 对于均匀缩放与非均匀缩放都成立,且不需要求逆
+// CPU端的对应实现见CompactInstance.cpp,单元测试以其与逆转置矩阵的结果比较
+float3 TransformNormalAffine(float3 normalL, float4 col0, float4 col1, float4 col2)
+{
+    float3x3 world = transpose(float3x3(col0.xyz, col1.xyz, col2.xyz));
+    float3x3 cofactor = float3x3(cross(world[1], world[2]), cross(world[2], world[0]), cross(world[0], world[1]));
+    return mul(normalL, cofactor) * sign(dot(world[0], cofactor[0]));
+}
+
 
 
 
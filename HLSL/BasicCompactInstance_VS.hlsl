@@ -0,0 +1,18 @@
+#include "Basic.hlsli"
+
+// 顶点着色器
+VertexOutBasic VS(InstanceCompactPosNormalTex vIn)
+{
+    VertexOutBasic vOut;
+    
+    vector posW = float4(TransformPointAffine(vIn.PosL, vIn.WorldCol0, vIn.WorldCol1, vIn.WorldCol2), 1.0f);
+    matrix viewProj = mul(g_View, g_Proj);
+
+    vOut.PosW = posW.xyz;
+    vOut.PosH = mul(posW, viewProj);
+    vOut.NormalW = TransformNormalAffine(vIn.NormalL, vIn.WorldCol0, vIn.WorldCol1, vIn.WorldCol2);
+    vOut.Tex = vIn.Tex;
+    vOut.ShadowPosH = mul(posW, g_ShadowTransform);
+    
+    return vOut;
+}
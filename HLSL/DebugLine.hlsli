@@ -0,0 +1,13 @@
+uniform matrix g_WorldViewProj;
+
+struct VertexPosColor
+{
+    float3 PosL : POSITION;
+    float4 Color : COLOR;
+};
+
+struct VertexPosHColor
+{
+    float4 PosH : SV_POSITION;
+    float4 Color : COLOR;
+};
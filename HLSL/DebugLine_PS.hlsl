@@ -0,0 +1,6 @@
+#include "DebugLine.hlsli"
+
+float4 PS(VertexPosHColor pIn) : SV_Target
+{
+    return pIn.Color;
+}
@@ -0,0 +1,9 @@
+#include "DebugLine.hlsli"
+
+VertexPosHColor VS(VertexPosColor vIn)
+{
+    VertexPosHColor vOut;
+    vOut.PosH = mul(float4(vIn.PosL, 1.0f), g_WorldViewProj);
+    vOut.Color = vIn.Color;
+    return vOut;
+}
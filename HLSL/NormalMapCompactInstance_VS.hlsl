@@ -0,0 +1,19 @@
+#include "Basic.hlsli"
+
+// 顶点着色器
+VertexOutNormalMap VS(InstanceCompactPosNormalTangentTex vIn)
+{
+    VertexOutNormalMap vOut;
+    
+    matrix viewProj = mul(g_View, g_Proj);
+    vector posW = float4(TransformPointAffine(vIn.PosL, vIn.WorldCol0, vIn.WorldCol1, vIn.WorldCol2), 1.0f);
+
+    vOut.PosW = posW.xyz;
+    vOut.PosH = mul(posW, viewProj);
+    vOut.NormalW = TransformNormalAffine(vIn.NormalL, vIn.WorldCol0, vIn.WorldCol1, vIn.WorldCol2);
+    vOut.TangentW = float4(TransformVectorAffine(vIn.TangentL.xyz, vIn.WorldCol0, vIn.WorldCol1, vIn.WorldCol2), vIn.TangentL.w);
+    vOut.Tex = vIn.Tex;
+    vOut.ShadowPosH = mul(posW, g_ShadowTransform);
+    
+    return vOut;
+}
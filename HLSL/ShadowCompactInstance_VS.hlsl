@@ -0,0 +1,34 @@
+
+cbuffer CB : register(b0)
+{
+    matrix g_WorldViewProj;
+    matrix g_ViewProj;
+}
+
+// 紧凑的实例数据: 只保存世界矩阵的前三列
+struct InstanceCompactPosNormalTex
+{
+    float3 PosL : POSITION;
+    float3 NormalL : NORMAL;
+    float2 Tex : TEXCOORD;
+    float4 WorldCol0 : WorldAffine0;
+    float4 WorldCol1 : WorldAffine1;
+    float4 WorldCol2 : WorldAffine2;
+};
+
+struct VertexPosHTex
+{
+    float4 PosH : SV_POSITION;
+    float2 Tex : TEXCOORD;
+};
+
+VertexPosHTex VS(InstanceCompactPosNormalTex vIn)
+{
+    VertexPosHTex vOut;
+    float4 posL = float4(vIn.PosL, 1.0f);
+    float4 posW = float4(dot(posL, vIn.WorldCol0), dot(posL, vIn.WorldCol1), dot(posL, vIn.WorldCol2), 1.0f);
+    vOut.PosH = mul(posW, g_ViewProj);
+    vOut.Tex = vIn.Tex;
+
+    return vOut;
+}
@@ -17,10 +17,39 @@ public:
 	ComPtr<ID3D11InputLayout> m_pVertexPosNormalTexLayout;
 	ComPtr<ID3D11InputLayout> m_pInstancePosNormalTangentTexLayout;
 	ComPtr<ID3D11InputLayout> m_pVertexPosNormalTangentTexLayout;
+	ComPtr<ID3D11InputLayout> m_pCompactInstancePosNormalTexLayout;
+	ComPtr<ID3D11InputLayout> m_pCompactInstancePosNormalTangentTexLayout;
 
 	XMFLOAT4X4 m_world{};
 	XMFLOAT4X4 m_view{};
 	XMFLOAT4X4 m_proj{};
+
+	// 初始化时解析的渲染通道与句柄,之后的设置不再按名称查找
+	std::shared_ptr<IEffectPass> m_pBasicObjectPass;
+	std::shared_ptr<IEffectPass> m_pBasicInstancePass;
+	std::shared_ptr<IEffectPass> m_pBasicCompactInstancePass;
+	std::shared_ptr<IEffectPass> m_pNormalMapObjectPass;
+	std::shared_ptr<IEffectPass> m_pNormalMapInstancePass;
+	std::shared_ptr<IEffectPass> m_pNormalMapCompactInstancePass;
+
+	EffectVariableHandle m_worldHandle;
+	EffectVariableHandle m_viewHandle;
+	EffectVariableHandle m_projHandle;
+	EffectVariableHandle m_worldViewProjHandle;
+	EffectVariableHandle m_worldInvTransposeHandle;
+	EffectVariableHandle m_shadowTransformHandle;
+	EffectVariableHandle m_dirLightHandle;
+	EffectVariableHandle m_pointLightHandle;
+	EffectVariableHandle m_spotLightHandle;
+	EffectVariableHandle m_materialHandle;
+	EffectVariableHandle m_textureUsedHandle;
+	EffectVariableHandle m_enableShadowHandle;
+	EffectVariableHandle m_eyePosHandle;
+
+	EffectShaderResourceHandle m_diffuseMapHandle;
+	EffectShaderResourceHandle m_normalMapHandle;
+	EffectShaderResourceHandle m_shadowMapHandle;
+	EffectShaderResourceHandle m_texCubeHandle;
 };
 
 //
@@ -105,6 +134,26 @@ bool BasicEffect::InitAll(ID3D11Device* device) const
 		{ "WorldInvTranspose", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 96, D3D11_INPUT_PER_INSTANCE_DATA, 1},
 		{ "WorldInvTranspose", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 112, D3D11_INPUT_PER_INSTANCE_DATA, 1}
 	};
+
+	// 紧凑实例输入布局,只有世界矩阵的前三列
+	D3D11_INPUT_ELEMENT_DESC basicCompactInstLayout[] = {
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "WorldAffine", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{ "WorldAffine", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{ "WorldAffine", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1}
+	};
+
+	D3D11_INPUT_ELEMENT_DESC normalMapCompactInstLayout[] = {
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 40, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "WorldAffine", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{ "WorldAffine", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{ "WorldAffine", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1}
+	};
 	
 	ComPtr<ID3DBlob> blob;
 
@@ -137,6 +186,18 @@ bool BasicEffect::InitAll(ID3D11Device* device) const
 	HR(device->CreateInputLayout(VertexPosNormalTangentTex::InputLayout, ARRAYSIZE(VertexPosNormalTangentTex::InputLayout),
 		blob->GetBufferPointer(), blob->GetBufferSize(), m_pImpl->m_pVertexPosNormalTangentTexLayout.GetAddressOf()));
 
+	HR(CreateShaderFromFile(L"HLSL\\BasicCompactInstance_VS.cso", L"HLSL\\BasicCompactInstance_VS.hlsl", "VS", "vs_5_0", blob.ReleaseAndGetAddressOf()));
+	HR(m_pImpl->m_pEffectHelper->AddShader("BasicCompactInstance_VS", device, blob.Get()));
+	// 创建顶点布局
+	HR(device->CreateInputLayout(basicCompactInstLayout, ARRAYSIZE(basicCompactInstLayout),
+		blob->GetBufferPointer(), blob->GetBufferSize(), m_pImpl->m_pCompactInstancePosNormalTexLayout.GetAddressOf()));
+
+	HR(CreateShaderFromFile(L"HLSL\\NormalMapCompactInstance_VS.cso", L"HLSL\\NormalMapCompactInstance_VS.hlsl", "VS", "vs_5_0", blob.ReleaseAndGetAddressOf()));
+	HR(m_pImpl->m_pEffectHelper->AddShader("NormalMapCompactInstance_VS", device, blob.Get()));
+	// 创建顶点布局
+	HR(device->CreateInputLayout(normalMapCompactInstLayout, ARRAYSIZE(normalMapCompactInstLayout),
+		blob->GetBufferPointer(), blob->GetBufferSize(), m_pImpl->m_pCompactInstancePosNormalTangentTexLayout.GetAddressOf()));
+
 	// ******************
 	// 创建像素着色器
 	//
@@ -163,15 +224,51 @@ bool BasicEffect::InitAll(ID3D11Device* device) const
 	passDesc.nameVS = "NormalMapInstance_VS";
 	passDesc.namePS = "NormalMap_PS";
 	m_pImpl->m_pEffectHelper->AddEffectPass("NormalMapInstance", device, &passDesc);
+	passDesc.nameVS = "BasicCompactInstance_VS";
+	passDesc.namePS = "Basic_PS";
+	m_pImpl->m_pEffectHelper->AddEffectPass("BasicCompactInstance", device, &passDesc);
+	passDesc.nameVS = "NormalMapCompactInstance_VS";
+	passDesc.namePS = "NormalMap_PS";
+	m_pImpl->m_pEffectHelper->AddEffectPass("NormalMapCompactInstance", device, &passDesc);
 
 	m_pImpl->m_pEffectHelper->SetSamplerStateByName("g_Sam", RenderStates::SSLinearWrap.Get());
 	m_pImpl->m_pEffectHelper->SetSamplerStateByName("g_SamShadow", RenderStates::SSShadow.Get());
 
+	// 解析渲染通道与句柄
+	EffectHelper& effectHelper = *m_pImpl->m_pEffectHelper;
+	m_pImpl->m_pBasicObjectPass = effectHelper.GetEffectPass("BasicObject");
+	m_pImpl->m_pBasicInstancePass = effectHelper.GetEffectPass("BasicInstance");
+	m_pImpl->m_pBasicCompactInstancePass = effectHelper.GetEffectPass("BasicCompactInstance");
+	m_pImpl->m_pNormalMapObjectPass = effectHelper.GetEffectPass("NormalMapObject");
+	m_pImpl->m_pNormalMapInstancePass = effectHelper.GetEffectPass("NormalMapInstance");
+	m_pImpl->m_pNormalMapCompactInstancePass = effectHelper.GetEffectPass("NormalMapCompactInstance");
+
+	m_pImpl->m_worldHandle = effectHelper.GetConstantBufferVariableHandle("g_World");
+	m_pImpl->m_viewHandle = effectHelper.GetConstantBufferVariableHandle("g_View");
+	m_pImpl->m_projHandle = effectHelper.GetConstantBufferVariableHandle("g_Proj");
+	m_pImpl->m_worldViewProjHandle = effectHelper.GetConstantBufferVariableHandle("g_WorldViewProj");
+	m_pImpl->m_worldInvTransposeHandle = effectHelper.GetConstantBufferVariableHandle("g_WorldInvTranspose");
+	m_pImpl->m_shadowTransformHandle = effectHelper.GetConstantBufferVariableHandle("g_ShadowTransform");
+	m_pImpl->m_dirLightHandle = effectHelper.GetConstantBufferVariableHandle("g_DirLight");
+	m_pImpl->m_pointLightHandle = effectHelper.GetConstantBufferVariableHandle("g_PointLight");
+	m_pImpl->m_spotLightHandle = effectHelper.GetConstantBufferVariableHandle("g_SpotLight");
+	m_pImpl->m_materialHandle = effectHelper.GetConstantBufferVariableHandle("g_Material");
+	m_pImpl->m_textureUsedHandle = effectHelper.GetConstantBufferVariableHandle("g_TextureUsed");
+	m_pImpl->m_enableShadowHandle = effectHelper.GetConstantBufferVariableHandle("g_EnableShadow");
+	m_pImpl->m_eyePosHandle = effectHelper.GetConstantBufferVariableHandle("g_EyePosW");
+
+	m_pImpl->m_diffuseMapHandle = effectHelper.GetShaderResourceHandle("g_DiffuseMap");
+	m_pImpl->m_normalMapHandle = effectHelper.GetShaderResourceHandle("g_NormalMap");
+	m_pImpl->m_shadowMapHandle = effectHelper.GetShaderResourceHandle("g_ShadowMap");
+	m_pImpl->m_texCubeHandle = effectHelper.GetShaderResourceHandle("g_TexCube");
+
 	// 设置调试对象名
 	D3D11SetDebugObjectName(m_pImpl->m_pInstancePosNormalTexLayout.Get(), "BasicEffect.InstancePosNormalTexLayout");
 	D3D11SetDebugObjectName(m_pImpl->m_pVertexPosNormalTexLayout.Get(), "BasicEffect.VertexPosNormalTexLayout");
 	D3D11SetDebugObjectName(m_pImpl->m_pInstancePosNormalTangentTexLayout.Get(), "BasicEffect.InstancePosNormalTangentTexLayout");
 	D3D11SetDebugObjectName(m_pImpl->m_pVertexPosNormalTangentTexLayout.Get(), "BasicEffect.VertexPosNormalTangentTexLayout");
+	D3D11SetDebugObjectName(m_pImpl->m_pCompactInstancePosNormalTexLayout.Get(), "BasicEffect.CompactInstancePosNormalTexLayout");
+	D3D11SetDebugObjectName(m_pImpl->m_pCompactInstancePosNormalTangentTexLayout.Get(), "BasicEffect.CompactInstancePosNormalTangentTexLayout");
 	m_pImpl->m_pEffectHelper->SetDebugObjectName("BasicEffect");
 
 	return true;
@@ -182,12 +279,17 @@ void BasicEffect::SetRenderDefault(ID3D11DeviceContext* deviceContext, const Ren
 	if (type == RenderType::RenderInstance)
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pInstancePosNormalTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("BasicInstance");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pBasicInstancePass;
+	}
+	else if (type == RenderType::RenderCompactInstance)
+	{
+		deviceContext->IASetInputLayout(m_pImpl->m_pCompactInstancePosNormalTexLayout.Get());
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pBasicCompactInstancePass;
 	}
 	else
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosNormalTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("BasicObject");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pBasicObjectPass;
 	}
 	
 	/*
@@ -210,12 +312,17 @@ void BasicEffect::SetRenderWithNormalMap(ID3D11DeviceContext* deviceContext, Ren
 	if (type == RenderType::RenderInstance)
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pInstancePosNormalTangentTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("NormalMapInstance");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pNormalMapInstancePass;
+	}
+	else if (type == RenderType::RenderCompactInstance)
+	{
+		deviceContext->IASetInputLayout(m_pImpl->m_pCompactInstancePosNormalTangentTexLayout.Get());
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pNormalMapCompactInstancePass;
 	}
 	else
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosNormalTangentTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("NormalMapObject");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pNormalMapObjectPass;
 	}
 
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -239,62 +346,75 @@ void XM_CALLCONV BasicEffect::SetProjMatrix(FXMMATRIX proj) const
 void XM_CALLCONV BasicEffect::SetShadowTransformMatrix(FXMMATRIX shadow) const
 {
 	XMMATRIX shadowTransform = XMMatrixTranspose(shadow);
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_ShadowTransform")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&shadowTransform));
+	m_pImpl->m_shadowTransformHandle.SetMatrix(shadowTransform);
 }
 
 void BasicEffect::SetDirLight(const size_t position, const DirectionalLight& dirLight) const
 {
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_DirLight")->SetRaw(&dirLight, static_cast<UINT>(position) * sizeof(dirLight), sizeof(dirLight));
+	m_pImpl->m_dirLightHandle.SetRaw(&dirLight, static_cast<UINT>(position) * sizeof(dirLight), sizeof(dirLight));
 }
 
 void BasicEffect::SetPointLight(const size_t position, const PointLight& pointLight) const
 {
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_PointLight")->SetRaw(&pointLight, static_cast<UINT>(position) * sizeof(pointLight), sizeof(pointLight));
+	m_pImpl->m_pointLightHandle.SetRaw(&pointLight, static_cast<UINT>(position) * sizeof(pointLight), sizeof(pointLight));
 }
 
 void BasicEffect::SetSpotLight(const size_t position, const SpotLight& spotLight) const
 {
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SpotLight")->SetRaw(&spotLight, static_cast<UINT>(position) * sizeof(spotLight), sizeof(spotLight));
+	m_pImpl->m_spotLightHandle.SetRaw(&spotLight, static_cast<UINT>(position) * sizeof(spotLight), sizeof(spotLight));
 }
 
 void BasicEffect::SetMaterial(const Material& material) const
 {
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_Material")->SetRaw(&material);
+	m_pImpl->m_materialHandle.SetRaw(&material);
 }
 
 void BasicEffect::SetTextureUsed(const bool isUsed) const
 {
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_TextureUsed")->SetSInt(isUsed);
+	m_pImpl->m_textureUsedHandle.SetSInt(isUsed);
 }
 
 void BasicEffect::SetShadowEnabled(const bool enabled) const
 {
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_EnableShadow")->SetSInt(enabled);
+	m_pImpl->m_enableShadowHandle.SetSInt(enabled);
 }
 
 void BasicEffect::SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const
 {
-	m_pImpl->m_pEffectHelper->SetShaderResourceByName("g_DiffuseMap", textureDiffuse);
+	m_pImpl->m_diffuseMapHandle.Set(textureDiffuse);
 }
 
 void BasicEffect::SetTextureNormalMap(ID3D11ShaderResourceView* textureNormalMap) const
 {
-	m_pImpl->m_pEffectHelper->SetShaderResourceByName("g_NormalMap", textureNormalMap);
+	m_pImpl->m_normalMapHandle.Set(textureNormalMap);
 }
 
 void BasicEffect::SetTextureShadowMap(ID3D11ShaderResourceView* textureShadowMap) const
 {
-	m_pImpl->m_pEffectHelper->SetShaderResourceByName("g_ShadowMap", textureShadowMap);
+	m_pImpl->m_shadowMapHandle.Set(textureShadowMap);
 }
 
 void BasicEffect::SetTextureCube(ID3D11ShaderResourceView* textureCube) const
 {
-	m_pImpl->m_pEffectHelper->SetShaderResourceByName("g_TexCube", textureCube);
+	m_pImpl->m_texCubeHandle.Set(textureCube);
 }
 
 void XM_CALLCONV BasicEffect::SetEyePos(FXMVECTOR eyePos) const
 {
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_EyePosW")->SetFloatVector(3, reinterpret_cast<const FLOAT*>(&eyePos));
+	m_pImpl->m_eyePosHandle.SetFloatVector(3, reinterpret_cast<const FLOAT*>(&eyePos));
+}
+
+void XM_CALLCONV BasicEffect::SetDrawParameters(const EffectDrawParameters& parameters, FXMMATRIX world) const
+{
+	SetWorldMatrix(world);
+	SetInstancedDrawParameters(parameters);
+}
+
+void BasicEffect::SetInstancedDrawParameters(const EffectDrawParameters& parameters) const
+{
+	SetMaterial(*parameters.material);
+	SetTextureDiffuse(parameters.textureDiffuse);
+	SetTextureNormalMap(parameters.textureNormalMap);
 }
 
 void BasicEffect::Apply(ID3D11DeviceContext* deviceContext)
@@ -310,11 +430,11 @@ void BasicEffect::Apply(ID3D11DeviceContext* deviceContext)
 	view = XMMatrixTranspose(view);
 	proj = XMMatrixTranspose(proj);
 
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_World")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&world));
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_View")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&view));
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_Proj")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&proj));
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_WorldViewProj")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&worldViewPrjMatrix));
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_WorldInvTranspose")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&worldInvTranspose));
+	m_pImpl->m_worldHandle.SetMatrix(world);
+	m_pImpl->m_viewHandle.SetMatrix(view);
+	m_pImpl->m_projHandle.SetMatrix(proj);
+	m_pImpl->m_worldViewProjHandle.SetMatrix(worldViewPrjMatrix);
+	m_pImpl->m_worldInvTransposeHandle.SetMatrix(worldInvTranspose);
 
 	if (m_pImpl->m_pCurrEffectPass)
 	{
@@ -1,21 +1,36 @@
 #include "BasicTransform.h"
 
+#include <cmath>
+
 using namespace DirectX;
 
 BasicTransform::BasicTransform()
 	:
 	m_scale{ 1.0f, 1.0f, 1.0f },
-	m_rotation{},
-	m_position{}
+	m_rotation{ 0.0f, 0.0f, 0.0f, 1.0f },
+	m_position{},
+	m_rotationMatrix{},
+	m_localToWorldMatrix{},
+	m_eulerAngles{},
+	m_isRotationDirty(true),
+	m_isLocalToWorldDirty(true),
+	m_isEulerAnglesDirty(false)
 {
 }
 
 BasicTransform::BasicTransform(const XMFLOAT3& scale, const XMFLOAT3& rotation, const XMFLOAT3& position)
 	:
 	m_scale(scale),
-	m_rotation(rotation),
-	m_position(position)
+	m_rotation{},
+	m_position(position),
+	m_rotationMatrix{},
+	m_localToWorldMatrix{},
+	m_eulerAngles{},
+	m_isRotationDirty(true),
+	m_isLocalToWorldDirty(true),
+	m_isEulerAnglesDirty(false)
 {
+	SetRotationFromEulerAngles(XMLoadFloat3(&rotation));
 }
 
 XMFLOAT3 BasicTransform::GetScaleFloat3() const
@@ -35,17 +50,27 @@ XMMATRIX BasicTransform::GetScaleMatrix() const
 
 XMFLOAT3 BasicTransform::GetRotationFloat3() const
 {
-	return m_rotation;
+	return GetCachedEulerAngles();
 }
 
 XMVECTOR BasicTransform::GetRotationVector() const
 {
-	return XMLoadFloat3(&m_rotation);
+	return XMLoadFloat3(&GetCachedEulerAngles());
 }
 
 XMMATRIX BasicTransform::GetRotationMatrix() const
 {
-	return XMMatrixRotationRollPitchYawFromVector(GetRotationVector());
+	return XMLoadFloat4x4(&GetCachedRotationMatrix());
+}
+
+XMFLOAT4 BasicTransform::GetRotationQuaternionFloat4() const
+{
+	return m_rotation;
+}
+
+XMVECTOR BasicTransform::GetRotationQuaternion() const
+{
+	return XMLoadFloat4(&m_rotation);
 }
 
 XMFLOAT3 BasicTransform::GetPositionFloat3() const
@@ -65,30 +90,30 @@ XMMATRIX BasicTransform::GetPositionMatrix() const
 
 XMMATRIX BasicTransform::GetRotationTranslationMatrix() const
 {
-	return GetRotationMatrix() * GetPositionMatrix();
+	// 旋转矩阵的第四行替换为平移即可
+	XMMATRIX rotationTranslation = GetRotationMatrix();
+	rotationTranslation.r[3] = XMVectorSetW(GetPositionVector(), 1.0f);
+	return rotationTranslation;
 }
 
 XMVECTOR BasicTransform::GetRightAxisVector() const
 {
-	return GetRotationMatrix().r[0];
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(GetCachedRotationMatrix().m[0]));
 }
 
 XMVECTOR BasicTransform::GetUpAxisVector() const
 {
-	return GetRotationMatrix().r[1];
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(GetCachedRotationMatrix().m[1]));
 }
 
 XMVECTOR BasicTransform::GetForwardAxisVector() const
 {
-	return GetRotationMatrix().r[2];
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(GetCachedRotationMatrix().m[2]));
 }
 
 XMMATRIX BasicTransform::GetLocalToWorldMatrix() const
 {
-	return
-		XMMatrixScalingFromVector(XMLoadFloat3(&m_scale)) *
-		XMMatrixRotationRollPitchYawFromVector(XMLoadFloat3(&m_rotation)) *
-		XMMatrixTranslationFromVector(XMLoadFloat3(&m_position));
+	return XMLoadFloat4x4(&GetCachedLocalToWorldMatrix());
 }
 
 XMMATRIX BasicTransform::GetWorldToLocalMatrix() const
@@ -99,85 +124,90 @@ XMMATRIX BasicTransform::GetWorldToLocalMatrix() const
 void BasicTransform::SetScale(const XMFLOAT3& scale)
 {
 	m_scale = scale;
+	InvalidateLocalToWorld();
 }
 
 void XM_CALLCONV BasicTransform::SetScale(FXMVECTOR scale)
 {
 	XMStoreFloat3(&m_scale, scale);
+	InvalidateLocalToWorld();
 }
 
 void BasicTransform::SetScale(const float x, const float y, const float z)
 {
 	m_scale = XMFLOAT3(x, y, z);
+	InvalidateLocalToWorld();
 }
 
 void BasicTransform::SetRotation(const XMFLOAT3& eulerAnglesInRadian)
 {
-	m_rotation = eulerAnglesInRadian;
+	SetRotationFromEulerAngles(XMLoadFloat3(&eulerAnglesInRadian));
 }
 
 void XM_CALLCONV BasicTransform::SetRotation(FXMVECTOR eulerAnglesInRadian)
 {
-	XMStoreFloat3(&m_rotation, eulerAnglesInRadian);
+	SetRotationFromEulerAngles(eulerAnglesInRadian);
 }
 
 void BasicTransform::SetRotation(const float x, const float y, const float z)
 {
-	m_rotation = XMFLOAT3(x, y, z);
+	SetRotationFromEulerAngles(XMVectorSet(x, y, z, 0.0f));
+}
+
+void BasicTransform::SetRotationQuaternion(const XMFLOAT4& quaternion)
+{
+	SetRotationFromQuaternion(XMLoadFloat4(&quaternion));
+}
+
+void XM_CALLCONV BasicTransform::SetRotationQuaternion(FXMVECTOR quaternion)
+{
+	SetRotationFromQuaternion(quaternion);
 }
 
 void BasicTransform::SetPosition(const XMFLOAT3& position)
 {
 	m_position = position;
+	InvalidateLocalToWorld();
 }
 
 void XM_CALLCONV BasicTransform::SetPosition(FXMVECTOR position)
 {
 	XMStoreFloat3(&m_position, position);
+	InvalidateLocalToWorld();
 }
 
 void BasicTransform::SetPosition(const float x, const float y, const float z)
 {
 	m_position = XMFLOAT3(x, y, z);
+	InvalidateLocalToWorld();
 }
 
 void XM_CALLCONV BasicTransform::Rotate(FXMVECTOR eulerAnglesInRadian)
 {
 	// 基于旋转欧拉角的旋转，只需要更新欧拉角即可
-	XMStoreFloat3(&m_rotation, XMVectorAdd(XMLoadFloat3(&m_rotation), eulerAnglesInRadian));
+	SetRotationFromEulerAngles(XMVectorAdd(GetRotationVector(), eulerAnglesInRadian));
 }
 
 void XM_CALLCONV BasicTransform::RotateAxis(FXMVECTOR axis, const float radian)
 {
-	// 绕轴旋转，先根据当前欧拉角得到旋转矩阵，然后更新，最后还原欧拉角
-	XMFLOAT4X4 rotationTranslationFloat4X4{};
-	XMStoreFloat4x4(&rotationTranslationFloat4X4, GetRotationMatrix() * XMMatrixRotationAxis(axis, radian));
-
-	m_rotation = GetEulerAnglesFromRotationTranslationFloat4X4(rotationTranslationFloat4X4);
+	// 绕轴旋转，先进行当前的旋转，再绕轴旋转
+	SetRotationFromQuaternion(XMQuaternionMultiply(GetRotationQuaternion(), XMQuaternionRotationAxis(axis, radian)));
 }
 
 void XM_CALLCONV BasicTransform::RotateAround(FXMVECTOR point, FXMVECTOR axis, const float radian)
 {
 	// 基于某一点为旋转中心进行绕轴旋转
-	// 首先根据已有变换算出旋转矩阵*平移矩阵，然后将旋转中心平移到原点，再进行旋转，最后再平移回旋转中心
+	// 朝向绕轴旋转，位置先平移到以旋转中心为原点，旋转后再平移回旋转中心
+	const XMVECTOR axisRotation = XMQuaternionRotationAxis(axis, radian);
 
-	// 将旋转中心平移到原点
-	XMMATRIX rotationTranslationMatrix = GetRotationTranslationMatrix() * XMMatrixTranslationFromVector(-point);
-	// 进行旋转
-	rotationTranslationMatrix *= XMMatrixRotationAxis(axis, radian);
-	// 再平移回旋转中心
-	rotationTranslationMatrix *= XMMatrixTranslationFromVector(point);
-
-	XMFLOAT4X4 rotationTranslationFloat4X4{};
-	XMStoreFloat4x4(&rotationTranslationFloat4X4, rotationTranslationMatrix);
-
-	m_rotation = GetEulerAnglesFromRotationTranslationFloat4X4(rotationTranslationFloat4X4);
-	XMStoreFloat3(&m_position, rotationTranslationMatrix.r[3]);
+	XMStoreFloat3(&m_position, XMVectorAdd(XMVector3Rotate(XMVectorSubtract(GetPositionVector(), point), axisRotation), point));
+	SetRotationFromQuaternion(XMQuaternionMultiply(GetRotationQuaternion(), axisRotation));
 }
 
 void XM_CALLCONV BasicTransform::Translate(FXMVECTOR direction, const float magnitude)
 {
 	XMStoreFloat3(&m_position, XMVectorMultiplyAdd(XMVectorReplicate(magnitude), XMVector3Normalize(direction), GetPositionVector()));
+	InvalidateLocalToWorld();
 }
 
 void XM_CALLCONV BasicTransform::LookAt(FXMVECTOR target, FXMVECTOR up)
@@ -210,9 +240,8 @@ void XM_CALLCONV BasicTransform::LookAt(FXMVECTOR target, FXMVECTOR up)
 			FLOAT FarZ);                       // 远平面距离
 	 */
 	
-	XMFLOAT4X4 rotationTranslationFloat4X4{};
-	// 获取逆观察矩阵
-	XMStoreFloat4x4(&rotationTranslationFloat4X4,
+	// 逆观察矩阵的旋转部分即为对象的旋转
+	SetRotationFromQuaternion(XMQuaternionRotationMatrix(
 		XMMatrixInverse(
 			nullptr,
 			XMMatrixLookAtLH(
@@ -221,16 +250,13 @@ void XM_CALLCONV BasicTransform::LookAt(FXMVECTOR target, FXMVECTOR up)
 				up
 			)
 		)
-	);
-
-	m_rotation = GetEulerAnglesFromRotationTranslationFloat4X4(rotationTranslationFloat4X4);
+	));
 }
 
 void XM_CALLCONV BasicTransform::LookTo(FXMVECTOR direction, FXMVECTOR up)
 {
-	XMFLOAT4X4 rotationTranslationFloat4X4{};
-	// 获取逆观察矩阵
-	XMStoreFloat4x4(&rotationTranslationFloat4X4,
+	// 逆观察矩阵的旋转部分即为对象的旋转
+	SetRotationFromQuaternion(XMQuaternionRotationMatrix(
 		XMMatrixInverse(
 			nullptr,
 			XMMatrixLookToLH(
@@ -239,9 +265,7 @@ void XM_CALLCONV BasicTransform::LookTo(FXMVECTOR direction, FXMVECTOR up)
 				up
 			)
 		)
-	);
-
-	m_rotation = GetEulerAnglesFromRotationTranslationFloat4X4(rotationTranslationFloat4X4);
+	));
 }
 
 XMFLOAT3 BasicTransform::GetEulerAnglesFromRotationTranslationFloat4X4(const XMFLOAT4X4& rotationTranslationFloat4X4)
@@ -255,7 +279,7 @@ XMFLOAT3 BasicTransform::GetEulerAnglesFromRotationTranslationFloat4X4(const XMF
 	 */
 	float c = sqrtf(1.0f - rotationTranslationFloat4X4(2, 1) * rotationTranslationFloat4X4(2, 1));
 	// 防止r[2][1]出现大于1的情况
-	if (isnan(c))
+	if (std::isnan(c))
 	{
 		c = 0.0f;
 	}
@@ -286,3 +310,66 @@ XMFLOAT3 BasicTransform::GetTranslationFromRotationTranslationFloat4X4(const XMF
 		rotationTranslationFloat4X4(3, 2),
 	};
 }
+
+const XMFLOAT4X4& BasicTransform::GetCachedRotationMatrix() const
+{
+	if (m_isRotationDirty)
+	{
+		XMStoreFloat4x4(&m_rotationMatrix, XMMatrixRotationQuaternion(XMLoadFloat4(&m_rotation)));
+		m_isRotationDirty = false;
+	}
+	return m_rotationMatrix;
+}
+
+const XMFLOAT4X4& BasicTransform::GetCachedLocalToWorldMatrix() const
+{
+	if (m_isLocalToWorldDirty)
+	{
+		// S * R * T: 缩放矩阵为对角阵,相当于将旋转矩阵的每一行乘以对应的缩放分量
+		const XMMATRIX rotation = XMLoadFloat4x4(&GetCachedRotationMatrix());
+		XMMATRIX world;
+		world.r[0] = XMVectorScale(rotation.r[0], m_scale.x);
+		world.r[1] = XMVectorScale(rotation.r[1], m_scale.y);
+		world.r[2] = XMVectorScale(rotation.r[2], m_scale.z);
+		world.r[3] = XMVectorSetW(XMLoadFloat3(&m_position), 1.0f);
+		XMStoreFloat4x4(&m_localToWorldMatrix, world);
+		m_isLocalToWorldDirty = false;
+	}
+	return m_localToWorldMatrix;
+}
+
+const XMFLOAT3& BasicTransform::GetCachedEulerAngles() const
+{
+	if (m_isEulerAnglesDirty)
+	{
+		m_eulerAngles = GetEulerAnglesFromRotationTranslationFloat4X4(GetCachedRotationMatrix());
+		m_isEulerAnglesDirty = false;
+	}
+	return m_eulerAngles;
+}
+
+void XM_CALLCONV BasicTransform::SetRotationFromEulerAngles(FXMVECTOR eulerAnglesInRadian)
+{
+	XMStoreFloat3(&m_eulerAngles, eulerAnglesInRadian);
+	m_isEulerAnglesDirty = false;
+	XMStoreFloat4(&m_rotation, XMQuaternionRotationRollPitchYawFromVector(eulerAnglesInRadian));
+	InvalidateRotation();
+}
+
+void XM_CALLCONV BasicTransform::SetRotationFromQuaternion(FXMVECTOR quaternion)
+{
+	XMStoreFloat4(&m_rotation, XMQuaternionNormalize(quaternion));
+	m_isEulerAnglesDirty = true;
+	InvalidateRotation();
+}
+
+void BasicTransform::InvalidateRotation()
+{
+	m_isRotationDirty = true;
+	m_isLocalToWorldDirty = true;
+}
+
+void BasicTransform::InvalidateLocalToWorld()
+{
+	m_isLocalToWorldDirty = true;
+}
@@ -5,7 +5,9 @@
 //
 // 基于 X_Jun 的 Transform ,做了较大改动
 // 
-// 描述对象缩放、旋转(欧拉角为基础)、平移
+// 描述对象缩放、旋转、平移
+// 旋转在内部以四元数保存,欧拉角接口保留以兼容原有代码
+// 旋转矩阵与世界矩阵在被访问时才计算并缓存,修改变换后缓存失效
 // Provide 1st person(free view) and 3rd person cameras.
 //***************************************************************************************
 
@@ -51,6 +53,10 @@ public:
 	DirectX::XMFLOAT3 GetRotationFloat3() const;
 	DirectX::XMVECTOR GetRotationVector() const;
 	DirectX::XMMATRIX GetRotationMatrix() const;
+
+	// 获取对象旋转四元数
+	DirectX::XMFLOAT4 GetRotationQuaternionFloat4() const;
+	DirectX::XMVECTOR GetRotationQuaternion() const;
 	
 	// 获取对象位置
 	DirectX::XMFLOAT3 GetPositionFloat3() const;
@@ -83,12 +89,16 @@ public:
 	void XM_CALLCONV SetRotation(DirectX::FXMVECTOR eulerAnglesInRadian);
 	void SetRotation(float x, float y, float z);
 
+	// 设置对象旋转四元数,会被规范化
+	void SetRotationQuaternion(const DirectX::XMFLOAT4& quaternion);
+	void XM_CALLCONV SetRotationQuaternion(DirectX::FXMVECTOR quaternion);
+
 	// 设置对象位置
 	void SetPosition(const DirectX::XMFLOAT3& position);
 	void XM_CALLCONV SetPosition(DirectX::FXMVECTOR position);
 	void SetPosition(float x, float y, float z);
 	
-	// 指定欧拉角旋转对象
+	// 指定欧拉角旋转对象,与原来一样直接累加到欧拉角上
 	void XM_CALLCONV Rotate(DirectX::FXMVECTOR eulerAnglesInRadian);
 	// 指定以原点为中心绕轴旋转
 	void XM_CALLCONV RotateAxis(DirectX::FXMVECTOR axis, float radian);
@@ -99,9 +109,9 @@ public:
 	void XM_CALLCONV Translate(DirectX::FXMVECTOR direction, float magnitude);
 
 	// 观察某一点
-	void XM_CALLCONV LookAt(DirectX::FXMVECTOR target, DirectX::FXMVECTOR up = { {0.0f, 1.0f, 0.0f, 0.0f } });
+	void XM_CALLCONV LookAt(DirectX::FXMVECTOR target, DirectX::FXMVECTOR up = DirectX::g_XMIdentityR1);
 	// 沿着某一方向观察
-	void XM_CALLCONV LookTo(DirectX::FXMVECTOR direction, DirectX::FXMVECTOR up = { {0.0f, 1.0f, 0.0f, 0.0f } });
+	void XM_CALLCONV LookTo(DirectX::FXMVECTOR direction, DirectX::FXMVECTOR up = DirectX::g_XMIdentityR1);
 
 protected:
 	// 从旋转平移矩阵获取旋转欧拉角
@@ -110,8 +120,30 @@ protected:
 	static DirectX::XMFLOAT3 GetTranslationFromRotationTranslationFloat4X4(const DirectX::XMFLOAT4X4& rotationTranslationFloat4X4);
 
 	DirectX::XMFLOAT3 m_scale;				// 缩放
-	DirectX::XMFLOAT3 m_rotation;			// 旋转欧拉角(弧度制)
+	DirectX::XMFLOAT4 m_rotation;			// 旋转四元数
 	DirectX::XMFLOAT3 m_position;			// 位置
+
+private:
+	// 获取缓存的矩阵,过期时才会重新计算
+	const DirectX::XMFLOAT4X4& GetCachedRotationMatrix() const;
+	const DirectX::XMFLOAT4X4& GetCachedLocalToWorldMatrix() const;
+	const DirectX::XMFLOAT3& GetCachedEulerAngles() const;
+
+	// 以欧拉角设置旋转时同时记录欧拉角,保证Rotate的累加与原来一致
+	void XM_CALLCONV SetRotationFromEulerAngles(DirectX::FXMVECTOR eulerAnglesInRadian);
+	// 以四元数设置旋转时欧拉角在需要时才从旋转矩阵反求
+	void XM_CALLCONV SetRotationFromQuaternion(DirectX::FXMVECTOR quaternion);
+
+	// 旋转改变时两个矩阵都会过期,缩放或位置改变时只有世界矩阵过期
+	void InvalidateRotation();
+	void InvalidateLocalToWorld();
+
+	mutable DirectX::XMFLOAT4X4 m_rotationMatrix;		// 缓存的旋转矩阵
+	mutable DirectX::XMFLOAT4X4 m_localToWorldMatrix;	// 缓存的世界矩阵
+	mutable DirectX::XMFLOAT3 m_eulerAngles;			// 缓存的旋转欧拉角(弧度制)
+	mutable bool m_isRotationDirty;
+	mutable bool m_isLocalToWorldDirty;
+	mutable bool m_isEulerAnglesDirty;
 };
 
 #endif
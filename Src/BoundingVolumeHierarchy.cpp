@@ -0,0 +1,264 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+namespace
+{
+	// 避免方向分量为0时倒数出现inf*0=NaN
+	XMVECTOR XM_CALLCONV SafeReciprocal(FXMVECTOR direction)
+	{
+		static const XMVECTORF32 Tiny = { { { 1e-20f, 1e-20f, 1e-20f, 1e-20f } } };
+		const XMVECTOR isSmall = XMVectorLess(XMVectorAbs(direction), Tiny);
+		const XMVECTOR signedTiny = XMVectorSelect(Tiny, XMVectorNegate(Tiny), XMVectorLess(direction, g_XMZero));
+		return XMVectorReciprocal(XMVectorSelect(direction, signedTiny, isSmall));
+	}
+
+	// 射线与AABB的slab测试,命中时tNear为进入距离(原点位于盒内时为0)
+	bool XM_CALLCONV RayBoxSlab(FXMVECTOR origin, FXMVECTOR invDirection, FXMVECTOR boxMin, GXMVECTOR boxMax, const float maxDist, float& tNear)
+	{
+		const XMVECTOR t0 = XMVectorMultiply(XMVectorSubtract(boxMin, origin), invDirection);
+		const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(boxMax, origin), invDirection);
+		const XMVECTOR tMinV = XMVectorMin(t0, t1);
+		const XMVECTOR tMaxV = XMVectorMax(t0, t1);
+
+		const float tMin = (std::max)((std::max)(XMVectorGetX(tMinV), XMVectorGetY(tMinV)), (std::max)(XMVectorGetZ(tMinV), 0.0f));
+		const float tMax = (std::min)((std::min)(XMVectorGetX(tMaxV), XMVectorGetY(tMaxV)), (std::min)(XMVectorGetZ(tMaxV), maxDist));
+
+		tNear = tMin;
+		return tMin <= tMax;
+	}
+}
+
+BoundingVolumeHierarchy::TraversalStack::TraversalStack(const UINT treeDepth)
+	:
+	m_pNodes(m_inline),
+	m_size(0),
+	m_capacity(treeDepth + 1)
+{
+	if (m_capacity > InlineCapacity)
+	{
+		m_heap.resize(m_capacity);
+		m_pNodes = m_heap.data();
+	}
+}
+
+void BoundingVolumeHierarchy::Build(const std::vector<BoundingBox>& boxes, const UINT maxLeafSize)
+{
+	Clear();
+	if (boxes.empty())
+		return;
+
+	const UINT count = static_cast<UINT>(boxes.size());
+	m_primitiveBoxes = boxes;
+	m_primitiveIndices.resize(count);
+	m_centroids.resize(count);
+	for (UINT i = 0; i < count; ++i)
+	{
+		m_primitiveIndices[i] = i;
+		m_centroids[i] = boxes[i].Center;
+	}
+
+	// 完全二叉树最多2N-1个节点
+	m_nodes.reserve(static_cast<size_t>(count) * 2 - 1);
+	m_nodes.emplace_back();
+	Subdivide(0, 0, count, (std::max)(maxLeafSize, 1u), 0);
+
+	m_centroids.clear();
+	m_centroids.shrink_to_fit();
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+	m_nodes.clear();
+	m_primitiveIndices.clear();
+	m_primitiveBoxes.clear();
+	m_centroids.clear();
+	m_depth = 0;
+}
+
+bool BoundingVolumeHierarchy::Empty() const
+{
+	return m_nodes.empty();
+}
+
+UINT BoundingVolumeHierarchy::GetDepth() const
+{
+	return m_depth;
+}
+
+const std::vector<BoundingVolumeHierarchy::Node>& BoundingVolumeHierarchy::GetNodes() const
+{
+	return m_nodes;
+}
+
+const std::vector<UINT>& BoundingVolumeHierarchy::GetPrimitiveIndices() const
+{
+	return m_primitiveIndices;
+}
+
+const std::vector<BoundingBox>& BoundingVolumeHierarchy::GetPrimitiveBoxes() const
+{
+	return m_primitiveBoxes;
+}
+
+UINT XM_CALLCONV BoundingVolumeHierarchy::Hit(FXMVECTOR origin, FXMVECTOR direction, float* pOutDist, const float maxDist) const
+{
+	if (m_nodes.empty())
+		return InvalidIndex;
+
+	const XMVECTOR invDirection = SafeReciprocal(direction);
+
+	UINT closestIndex = InvalidIndex;
+	float closestDist = maxDist;
+
+	TraversalStack stack(m_depth);
+	stack.Push(0);
+
+	while (!stack.Empty())
+	{
+		const Node& node = m_nodes[stack.Pop()];
+
+		float tNear;
+		if (!RayBoxSlab(origin, invDirection, XMLoadFloat3(&node.boxMin), XMLoadFloat3(&node.boxMax), closestDist, tNear))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			for (UINT i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+			{
+				const UINT primitive = m_primitiveIndices[i];
+				const BoundingBox& box = m_primitiveBoxes[primitive];
+				const XMVECTOR center = XMLoadFloat3(&box.Center);
+				const XMVECTOR extents = XMLoadFloat3(&box.Extents);
+
+				float dist;
+				if (RayBoxSlab(origin, invDirection, center - extents, center + extents, closestDist, dist))
+				{
+					closestDist = dist;
+					closestIndex = primitive;
+				}
+			}
+		}
+		else
+		{
+			stack.Push(node.leftOrFirst + 1);
+			stack.Push(node.leftOrFirst);
+		}
+	}
+
+	if (pOutDist && closestIndex != InvalidIndex)
+		*pOutDist = closestDist;
+	return closestIndex;
+}
+
+void BoundingVolumeHierarchy::Query(const BoundingBox& box, std::vector<UINT>& outIndices) const
+{
+	if (m_nodes.empty())
+		return;
+
+	const XMVECTOR center = XMLoadFloat3(&box.Center);
+	const XMVECTOR extents = XMLoadFloat3(&box.Extents);
+	const XMVECTOR queryMin = center - extents;
+	const XMVECTOR queryMax = center + extents;
+
+	TraversalStack stack(m_depth);
+	stack.Push(0);
+
+	while (!stack.Empty())
+	{
+		const Node& node = m_nodes[stack.Pop()];
+
+		// 任一轴分离即不相交
+		if (!XMVector3LessOrEqual(XMLoadFloat3(&node.boxMin), queryMax) ||
+			!XMVector3GreaterOrEqual(XMLoadFloat3(&node.boxMax), queryMin))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			for (UINT i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+			{
+				const UINT primitive = m_primitiveIndices[i];
+				if (m_primitiveBoxes[primitive].Intersects(box))
+					outIndices.push_back(primitive);
+			}
+		}
+		else
+		{
+			stack.Push(node.leftOrFirst + 1);
+			stack.Push(node.leftOrFirst);
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::Subdivide(const UINT nodeIndex, const UINT first, const UINT count, const UINT maxLeafSize, const UINT depth)
+{
+	UpdateNodeBounds(nodeIndex, first, count);
+	m_depth = (std::max)(m_depth, depth);
+
+	// 求图元中心的包围范围,选择最长轴进行划分
+	XMVECTOR centroidMin = XMLoadFloat3(&m_centroids[m_primitiveIndices[first]]);
+	XMVECTOR centroidMax = centroidMin;
+	for (UINT i = first + 1; i < first + count; ++i)
+	{
+		const XMVECTOR centroid = XMLoadFloat3(&m_centroids[m_primitiveIndices[i]]);
+		centroidMin = XMVectorMin(centroidMin, centroid);
+		centroidMax = XMVectorMax(centroidMax, centroid);
+	}
+	XMFLOAT3 extent{};
+	XMStoreFloat3(&extent, centroidMax - centroidMin);
+
+	int axis = 0;
+	if (extent.y > extent.x)
+		axis = 1;
+	if (extent.z > (axis == 0 ? extent.x : extent.y))
+		axis = 2;
+	const float axisExtent = axis == 0 ? extent.x : (axis == 1 ? extent.y : extent.z);
+
+	// 图元足够少或者中心全部重合时成为叶节点
+	if (count <= maxLeafSize || axisExtent <= 0.0f)
+	{
+		m_nodes[nodeIndex].leftOrFirst = first;
+		m_nodes[nodeIndex].count = count;
+		return;
+	}
+
+	// 中位数划分
+	const UINT half = count / 2;
+	auto begin = m_primitiveIndices.begin() + first;
+	std::nth_element(begin, begin + half, begin + count,
+		[this, axis](const UINT lhs, const UINT rhs)
+		{
+			const float* l = &m_centroids[lhs].x;
+			const float* r = &m_centroids[rhs].x;
+			return l[axis] < r[axis];
+		});
+
+	// 兄弟节点连续分配
+	const UINT leftIndex = static_cast<UINT>(m_nodes.size());
+	m_nodes.emplace_back();
+	m_nodes.emplace_back();
+	m_nodes[nodeIndex].leftOrFirst = leftIndex;
+	m_nodes[nodeIndex].count = 0;
+
+	Subdivide(leftIndex, first, half, maxLeafSize, depth + 1);
+	Subdivide(leftIndex + 1, first + half, count - half, maxLeafSize, depth + 1);
+}
+
+void BoundingVolumeHierarchy::UpdateNodeBounds(const UINT nodeIndex, const UINT first, const UINT count)
+{
+	XMVECTOR boxMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR boxMax = XMVectorReplicate(-FLT_MAX);
+	for (UINT i = first; i < first + count; ++i)
+	{
+		const BoundingBox& box = m_primitiveBoxes[m_primitiveIndices[i]];
+		const XMVECTOR center = XMLoadFloat3(&box.Center);
+		const XMVECTOR extents = XMLoadFloat3(&box.Extents);
+		boxMin = XMVectorMin(boxMin, center - extents);
+		boxMax = XMVectorMax(boxMax, center + extents);
+	}
+
+	XMStoreFloat3(&m_nodes[nodeIndex].boxMin, boxMin);
+	XMStoreFloat3(&m_nodes[nodeIndex].boxMax, boxMax);
+}
@@ -0,0 +1,96 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 扁平化的包围体层次结构(BVH),以AABB作为图元
+// Flattened bounding volume hierarchy over axis-aligned boxes.
+//***************************************************************************************
+
+#ifndef BOUNDINGVOLUMEHIERARCHY_H
+#define BOUNDINGVOLUMEHIERARCHY_H
+
+#include "PortableTypes.h"
+
+#include <DirectXCollision.h>
+#include <cassert>
+#include <cfloat>
+#include <vector>
+
+class BoundingVolumeHierarchy
+{
+public:
+	// 节点按深度优先顺序存放在连续数组中,兄弟节点总是相邻(右子节点 = 左子节点 + 1)
+	// 这样遍历时只需要一次取址就能拿到两个子节点
+	struct Node
+	{
+		DirectX::XMFLOAT3 boxMin;
+		UINT leftOrFirst;		// 内部节点: 左子节点索引; 叶节点: 第一个图元在图元索引数组中的位置
+		DirectX::XMFLOAT3 boxMax;
+		UINT count;				// 叶节点图元数目,内部节点为0
+
+		bool IsLeaf() const { return count > 0; }
+	};
+
+	// 无效的索引
+	static constexpr UINT InvalidIndex = 0xFFFFFFFF;
+
+	// 深度优先遍历使用的栈
+	// 每下降一层弹出1个节点、压入2个子节点,栈中最多同时存放 树深度 + 1 个节点
+	// 容量由Build记录的树深度决定,不超过InlineCapacity时使用栈上数组,否则改为在堆上分配
+	class TraversalStack
+	{
+	public:
+		static constexpr UINT InlineCapacity = 64;
+
+		explicit TraversalStack(UINT treeDepth);
+
+		TraversalStack(const TraversalStack&) = delete;
+		TraversalStack& operator=(const TraversalStack&) = delete;
+
+		void Push(UINT nodeIndex) { assert(m_size < m_capacity); m_pNodes[m_size++] = nodeIndex; }
+		UINT Pop() { return m_pNodes[--m_size]; }
+		bool Empty() const { return m_size == 0; }
+
+	private:
+		UINT m_inline[InlineCapacity];
+		std::vector<UINT> m_heap;
+		UINT* m_pNodes;
+		UINT m_size;
+		UINT m_capacity;
+	};
+
+	// 以一组AABB构建BVH,图元索引即为boxes中的下标
+	void Build(const std::vector<DirectX::BoundingBox>& boxes, UINT maxLeafSize = 4);
+	// 清空
+	void Clear();
+
+	bool Empty() const;
+	// 获取树的深度(只有根节点时为0),遍历栈以此确定容量
+	UINT GetDepth() const;
+
+	// 获取节点数组(根节点位于0)
+	const std::vector<Node>& GetNodes() const;
+	// 获取叶节点引用的图元索引数组
+	const std::vector<UINT>& GetPrimitiveIndices() const;
+	// 获取图元包围盒
+	const std::vector<DirectX::BoundingBox>& GetPrimitiveBoxes() const;
+
+	// 射线最近命中,返回命中图元索引,未命中返回InvalidIndex
+	UINT XM_CALLCONV Hit(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
+	// 获取所有与box相交的图元索引(追加到outIndices中)
+	void Query(const DirectX::BoundingBox& box, std::vector<UINT>& outIndices) const;
+
+private:
+	// 递归划分[first, first + count)范围内的图元并填充nodeIndex节点
+	void Subdivide(UINT nodeIndex, UINT first, UINT count, UINT maxLeafSize, UINT depth);
+	// 根据图元计算节点包围盒
+	void UpdateNodeBounds(UINT nodeIndex, UINT first, UINT count);
+
+	std::vector<Node> m_nodes;
+	std::vector<UINT> m_primitiveIndices;
+	std::vector<DirectX::BoundingBox> m_primitiveBoxes;
+	UINT m_depth = 0;
+	// 图元中心,仅在构建期使用
+	std::vector<DirectX::XMFLOAT3> m_centroids;
+};
+
+#endif
@@ -0,0 +1,682 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 不依赖Windows头文件与DirectXCollision的包围体数学库(仅头文件)
+// 提供AABB/OBB/球/视锥体,以及对数组批量变换、剔除的函数
+// 矩阵约定与DirectXMath一致: 行向量右乘矩阵(v * M),内存布局与XMFLOAT4X4相同,
+// AABB/球/OBB的内存布局分别与BoundingBox/BoundingSphere/BoundingOrientedBox相同
+// SIMD后端按编译选项自动选择FMA/SSE2/NEON,定义BOUNDS_FORCE_SCALAR可强制使用标量实现
+// FMA后端仍然是4路__m128,只是乘加使用_mm_fmadd_ps(gcc/clang需要-mfma,MSVC需要/arch:AVX2)
+// Header-only portable bounding-volume math with SSE2/FMA/NEON backends.
+//***************************************************************************************
+
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(BOUNDS_FORCE_SCALAR)
+#define BOUNDS_BACKEND_SCALAR
+#elif defined(__FMA__) || defined(__AVX2__)
+#define BOUNDS_BACKEND_FMA
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOUNDS_BACKEND_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64) || defined(_M_ARM)
+#define BOUNDS_BACKEND_NEON
+#include <arm_neon.h>
+#else
+#define BOUNDS_BACKEND_SCALAR
+#endif
+
+namespace Bounds
+{
+	struct Float3
+	{
+		float x, y, z;
+	};
+
+	struct Float4
+	{
+		float x, y, z, w;
+	};
+
+	// 与XMFLOAT4X4布局相同,行优先
+	struct Matrix4x4
+	{
+		float m[4][4];
+	};
+
+	// 与BoundingBox布局相同
+	struct Aabb
+	{
+		Float3 center;
+		Float3 extents;
+	};
+
+	// 与BoundingSphere布局相同
+	struct Sphere
+	{
+		Float3 center;
+		float radius;
+	};
+
+	// 与BoundingOrientedBox布局相同,orientation为单位四元数
+	struct Obb
+	{
+		Float3 center;
+		Float3 extents;
+		Float4 orientation;
+	};
+
+	// 6个平面(nx, ny, nz, d),法线朝向视锥体内部,顺序: 左、右、下、上、近、远
+	struct Frustum
+	{
+		Float4 planes[6];
+	};
+
+	// 物体与视锥体的关系
+	enum class Containment : uint8_t { Disjoint, Intersects, Contains };
+
+	//
+	// 构造
+	//
+
+	// 从观察投影矩阵提取世界空间视锥体(Gribb-Hartmann,深度范围[0, 1])
+	Frustum FrustumFromMatrix(const Matrix4x4& viewProj);
+	Sphere SphereFromAabb(const Aabb& box);
+	Obb ObbFromAabb(const Aabb& box);
+	// 与BoundingBox::CreateMerged一致,数组版本要求count大于0
+	Aabb Merge(const Aabb& a, const Aabb& b);
+	Aabb Merge(const Aabb* boxes, size_t count);
+
+	//
+	// 变换,结果与DirectXCollision中对应的Transform一致
+	//
+
+	Aabb Transform(const Aabb& box, const Matrix4x4& matrix);
+	Sphere Transform(const Sphere& sphere, const Matrix4x4& matrix);
+	// 矩阵不能包含切变
+	Obb Transform(const Obb& box, const Matrix4x4& matrix);
+
+	// 以同一个矩阵变换数组
+	void TransformAabbs(const Aabb* boxes, size_t count, const Matrix4x4& matrix, Aabb* pOut);
+	void TransformSpheres(const Sphere* spheres, size_t count, const Matrix4x4& matrix, Sphere* pOut);
+	// 以一组矩阵变换同一个局部包围体(实例化)
+	void TransformAabbs(const Aabb& localBox, const Matrix4x4* matrices, size_t count, Aabb* pOut);
+	void TransformSpheres(const Sphere& localSphere, const Matrix4x4* matrices, size_t count, Sphere* pOut);
+
+	//
+	// 相交测试
+	//
+
+	bool Intersects(const Aabb& a, const Aabb& b);
+	bool Intersects(const Sphere& a, const Sphere& b);
+	bool Intersects(const Sphere& sphere, const Aabb& box);
+	Containment Contains(const Frustum& frustum, const Aabb& box);
+	Containment Contains(const Frustum& frustum, const Sphere& sphere);
+	Containment Contains(const Frustum& frustum, const Obb& box);
+
+	// 批量视锥体剔除,pOutVisible[i]为1表示可能可见,返回可见数目
+	size_t CullAabbs(const Frustum& frustum, const Aabb* boxes, size_t count, uint8_t* pOutVisible);
+	size_t CullSpheres(const Frustum& frustum, const Sphere* spheres, size_t count, uint8_t* pOutVisible);
+}
+
+namespace Bounds
+{
+	namespace Internal
+	{
+		//
+		// 4路浮点SIMD的最小抽象,仅供内部实现使用
+		//
+
+#if defined(BOUNDS_BACKEND_FMA) || defined(BOUNDS_BACKEND_SSE2)
+		using Vector = __m128;
+
+		inline Vector Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+		inline Vector Replicate(float value) { return _mm_set1_ps(value); }
+		inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+		inline Vector Subtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+		inline Vector Multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+#if defined(BOUNDS_BACKEND_FMA)
+		inline Vector MultiplyAdd(Vector a, Vector b, Vector c) { return _mm_fmadd_ps(a, b, c); }
+#else
+		inline Vector MultiplyAdd(Vector a, Vector b, Vector c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#endif
+		inline Vector Abs(Vector a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		inline Vector Negate(Vector a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+		inline Vector Min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+		inline Vector Max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+		inline Vector Less(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+		inline Vector Or(Vector a, Vector b) { return _mm_or_ps(a, b); }
+		inline Vector And(Vector a, Vector b) { return _mm_and_ps(a, b); }
+		// 每个元素的符号位组成的掩码
+		inline uint32_t MoveMask(Vector a) { return static_cast<uint32_t>(_mm_movemask_ps(a)); }
+		inline void Store(float* pOut, Vector a) { _mm_storeu_ps(pOut, a); }
+#elif defined(BOUNDS_BACKEND_NEON)
+		using Vector = float32x4_t;
+
+		inline Vector Set(float x, float y, float z, float w) { const float data[4] = { x, y, z, w }; return vld1q_f32(data); }
+		inline Vector Replicate(float value) { return vdupq_n_f32(value); }
+		inline Vector Add(Vector a, Vector b) { return vaddq_f32(a, b); }
+		inline Vector Subtract(Vector a, Vector b) { return vsubq_f32(a, b); }
+		inline Vector Multiply(Vector a, Vector b) { return vmulq_f32(a, b); }
+		inline Vector MultiplyAdd(Vector a, Vector b, Vector c) { return vmlaq_f32(c, a, b); }
+		inline Vector Abs(Vector a) { return vabsq_f32(a); }
+		inline Vector Negate(Vector a) { return vnegq_f32(a); }
+		inline Vector Min(Vector a, Vector b) { return vminq_f32(a, b); }
+		inline Vector Max(Vector a, Vector b) { return vmaxq_f32(a, b); }
+		inline Vector Less(Vector a, Vector b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+		inline Vector Or(Vector a, Vector b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline Vector And(Vector a, Vector b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline uint32_t MoveMask(Vector a)
+		{
+			const uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(a), 31);
+			return vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1) << 1 | vgetq_lane_u32(bits, 2) << 2 | vgetq_lane_u32(bits, 3) << 3;
+		}
+		inline void Store(float* pOut, Vector a) { vst1q_f32(pOut, a); }
+#else
+		struct Vector
+		{
+			float v[4];
+		};
+
+		inline Vector Set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+		inline Vector Replicate(float value) { return { { value, value, value, value } }; }
+		template <typename Function>
+		Vector Apply(const Vector& a, const Vector& b, Function function)
+		{
+			return { { function(a.v[0], b.v[0]), function(a.v[1], b.v[1]), function(a.v[2], b.v[2]), function(a.v[3], b.v[3]) } };
+		}
+		inline Vector Add(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return x + y; }); }
+		inline Vector Subtract(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return x - y; }); }
+		inline Vector Multiply(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return x * y; }); }
+		inline Vector MultiplyAdd(Vector a, Vector b, Vector c) { return Add(Multiply(a, b), c); }
+		inline Vector Abs(Vector a) { return Apply(a, a, [](float x, float) { return std::fabs(x); }); }
+		inline Vector Negate(Vector a) { return Apply(a, a, [](float x, float) { return -x; }); }
+		inline Vector Min(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return x < y ? x : y; }); }
+		inline Vector Max(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return x > y ? x : y; }); }
+		// 比较结果以负数(符号位为1)表示真
+		inline Vector Less(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return x < y ? -1.0f : 0.0f; }); }
+		inline Vector Or(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return std::signbit(x) || std::signbit(y) ? -1.0f : 0.0f; }); }
+		inline Vector And(Vector a, Vector b) { return Apply(a, b, [](float x, float y) { return std::signbit(x) && std::signbit(y) ? -1.0f : 0.0f; }); }
+		inline uint32_t MoveMask(Vector a)
+		{
+			return static_cast<uint32_t>(std::signbit(a.v[0])) | static_cast<uint32_t>(std::signbit(a.v[1])) << 1 |
+				static_cast<uint32_t>(std::signbit(a.v[2])) << 2 | static_cast<uint32_t>(std::signbit(a.v[3])) << 3;
+		}
+		inline void Store(float* pOut, Vector a) { for (int i = 0; i < 4; ++i) pOut[i] = a.v[i]; }
+#endif
+
+		// 以行向量右乘矩阵变换点
+		inline Float3 TransformPoint(const Float3& p, const Matrix4x4& matrix)
+		{
+			const float (&m)[4][4] = matrix.m;
+			return {
+				p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0],
+				p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1],
+				p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2]
+			};
+		}
+
+		inline float Dot(const Float3& a, const Float3& b)
+		{
+			return a.x * b.x + a.y * b.y + a.z * b.z;
+		}
+
+		// 与XMQuaternionMultiply一致: 先q1旋转,再q2旋转
+		inline Float4 QuaternionMultiply(const Float4& q1, const Float4& q2)
+		{
+			return {
+				q2.w * q1.x + q2.x * q1.w + q2.y * q1.z - q2.z * q1.y,
+				q2.w * q1.y - q2.x * q1.z + q2.y * q1.w + q2.z * q1.x,
+				q2.w * q1.z + q2.x * q1.y - q2.y * q1.x + q2.z * q1.w,
+				q2.w * q1.w - q2.x * q1.x - q2.y * q1.y - q2.z * q1.z
+			};
+		}
+
+		// 与XMQuaternionRotationMatrix一致,矩阵的3x3部分必须为正交矩阵
+		inline Float4 QuaternionFromRotation(const float (&m)[3][3])
+		{
+			const float trace = m[0][0] + m[1][1] + m[2][2];
+			if (trace > 0.0f)
+			{
+				const float s = std::sqrt(trace + 1.0f) * 2.0f;
+				return { (m[1][2] - m[2][1]) / s, (m[2][0] - m[0][2]) / s, (m[0][1] - m[1][0]) / s, 0.25f * s };
+			}
+			if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+			{
+				const float s = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+				return { 0.25f * s, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s, (m[1][2] - m[2][1]) / s };
+			}
+			if (m[1][1] > m[2][2])
+			{
+				const float s = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+				return { (m[0][1] + m[1][0]) / s, 0.25f * s, (m[1][2] + m[2][1]) / s, (m[2][0] - m[0][2]) / s };
+			}
+			const float s = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+			return { (m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, 0.25f * s, (m[0][1] - m[1][0]) / s };
+		}
+
+		// 与XMMatrixRotationQuaternion一致,返回旋转矩阵的三行(即局部坐标轴)
+		inline void RotationFromQuaternion(const Float4& q, Float3 (&axes)[3])
+		{
+			const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+			const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+			const float xw = q.x * q.w, yw = q.y * q.w, zw = q.z * q.w;
+			axes[0] = { 1.0f - 2.0f * (yy + zz), 2.0f * (xy + zw), 2.0f * (xz - yw) };
+			axes[1] = { 2.0f * (xy - zw), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + xw) };
+			axes[2] = { 2.0f * (xz + yw), 2.0f * (yz - xw), 1.0f - 2.0f * (xx + yy) };
+		}
+
+		// 包围体在平面法线方向上的半径与中心到平面的有向距离,求出与平面的关系
+		inline Containment Classify(const Frustum& frustum, const Float3& center, const Float3 (&axes)[3], const Float3& extents, float radius)
+		{
+			bool isInside = true;
+			for (const Float4& plane : frustum.planes)
+			{
+				const Float3 normal = { plane.x, plane.y, plane.z };
+				const float r = radius +
+					extents.x * std::fabs(Dot(normal, axes[0])) +
+					extents.y * std::fabs(Dot(normal, axes[1])) +
+					extents.z * std::fabs(Dot(normal, axes[2]));
+				const float distance = Dot(normal, center) + plane.w;
+				if (distance < -r)
+					return Containment::Disjoint;
+				if (distance < r)
+					isInside = false;
+			}
+			return isInside ? Containment::Contains : Containment::Intersects;
+		}
+
+		// 4个包围体的SoA数据对视锥体的可见性掩码,外侧判定: n·c + d + r < 0
+		inline uint32_t CullFour(const Frustum& frustum,
+			const Vector& centerX, const Vector& centerY, const Vector& centerZ,
+			const Vector& extentX, const Vector& extentY, const Vector& extentZ, const Vector& radius)
+		{
+			Vector outside = Replicate(0.0f);
+			for (const Float4& plane : frustum.planes)
+			{
+				Vector distance = MultiplyAdd(centerX, Replicate(plane.x), Replicate(plane.w));
+				distance = MultiplyAdd(centerY, Replicate(plane.y), distance);
+				distance = MultiplyAdd(centerZ, Replicate(plane.z), distance);
+
+				Vector r = MultiplyAdd(extentX, Replicate(std::fabs(plane.x)), radius);
+				r = MultiplyAdd(extentY, Replicate(std::fabs(plane.y)), r);
+				r = MultiplyAdd(extentZ, Replicate(std::fabs(plane.z)), r);
+
+				outside = Or(outside, Less(Add(distance, r), Replicate(0.0f)));
+			}
+			return ~MoveMask(outside) & 0xF;
+		}
+	}
+
+	//
+	// 构造
+	//
+
+	inline Frustum FrustumFromMatrix(const Matrix4x4& viewProj)
+	{
+		const float (&m)[4][4] = viewProj.m;
+		// 矩阵的第j列
+		auto column = [&m](int j) { return Float4{ m[0][j], m[1][j], m[2][j], m[3][j] }; };
+		auto add = [](const Float4& a, const Float4& b) { return Float4{ a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w }; };
+		auto subtract = [](const Float4& a, const Float4& b) { return Float4{ a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w }; };
+
+		const Float4 c0 = column(0), c1 = column(1), c2 = column(2), c3 = column(3);
+		Frustum frustum{ { add(c3, c0), subtract(c3, c0), add(c3, c1), subtract(c3, c1), c2, subtract(c3, c2) } };
+		for (Float4& plane : frustum.planes)
+		{
+			const float invLength = 1.0f / std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			plane = { plane.x * invLength, plane.y * invLength, plane.z * invLength, plane.w * invLength };
+		}
+		return frustum;
+	}
+
+	inline Sphere SphereFromAabb(const Aabb& box)
+	{
+		return { box.center, std::sqrt(Internal::Dot(box.extents, box.extents)) };
+	}
+
+	inline Obb ObbFromAabb(const Aabb& box)
+	{
+		return { box.center, box.extents, { 0.0f, 0.0f, 0.0f, 1.0f } };
+	}
+
+	inline Aabb Merge(const Aabb& a, const Aabb& b)
+	{
+		// 每个轴上取两个区间的并集
+		auto axis = [](float centerA, float extentA, float centerB, float extentB, float& center, float& extent)
+		{
+			const float minA = centerA - extentA, minB = centerB - extentB;
+			const float maxA = centerA + extentA, maxB = centerB + extentB;
+			const float lower = minA < minB ? minA : minB;
+			const float upper = maxA > maxB ? maxA : maxB;
+			center = (lower + upper) * 0.5f;
+			extent = (upper - lower) * 0.5f;
+		};
+		Aabb result;
+		axis(a.center.x, a.extents.x, b.center.x, b.extents.x, result.center.x, result.extents.x);
+		axis(a.center.y, a.extents.y, b.center.y, b.extents.y, result.center.y, result.extents.y);
+		axis(a.center.z, a.extents.z, b.center.z, b.extents.z, result.center.z, result.extents.z);
+		return result;
+	}
+
+	inline Aabb Merge(const Aabb* boxes, const size_t count)
+	{
+		using namespace Internal;
+
+		// 最小/最大角点各占一个向量的xyz分量,逐个包围盒取最小/最大值
+		auto load = [boxes](size_t i, Vector& center, Vector& extents)
+		{
+			const Aabb& b = boxes[i];
+			center = Set(b.center.x, b.center.y, b.center.z, 0.0f);
+			extents = Set(b.extents.x, b.extents.y, b.extents.z, 0.0f);
+		};
+		Vector center, extents;
+		load(0, center, extents);
+		Vector lower = Subtract(center, extents), upper = Add(center, extents);
+		for (size_t i = 1; i < count; ++i)
+		{
+			load(i, center, extents);
+			lower = Min(lower, Subtract(center, extents));
+			upper = Max(upper, Add(center, extents));
+		}
+
+		const Vector half = Replicate(0.5f);
+		float result[2][4];
+		Store(result[0], Multiply(Add(lower, upper), half));
+		Store(result[1], Multiply(Subtract(upper, lower), half));
+		return { { result[0][0], result[0][1], result[0][2] }, { result[1][0], result[1][1], result[1][2] } };
+	}
+
+	//
+	// 变换
+	//
+
+	inline Aabb Transform(const Aabb& box, const Matrix4x4& matrix)
+	{
+		// 中心直接变换,半长取矩阵3x3部分的绝对值后变换,与变换8个角点再取包围盒等价
+		const float (&m)[4][4] = matrix.m;
+		const Float3& e = box.extents;
+		return {
+			Internal::TransformPoint(box.center, matrix),
+			{
+				e.x * std::fabs(m[0][0]) + e.y * std::fabs(m[1][0]) + e.z * std::fabs(m[2][0]),
+				e.x * std::fabs(m[0][1]) + e.y * std::fabs(m[1][1]) + e.z * std::fabs(m[2][1]),
+				e.x * std::fabs(m[0][2]) + e.y * std::fabs(m[1][2]) + e.z * std::fabs(m[2][2])
+			}
+		};
+	}
+
+	inline Sphere Transform(const Sphere& sphere, const Matrix4x4& matrix)
+	{
+		// 半径按最大的轴缩放
+		const float (&m)[4][4] = matrix.m;
+		float maxScaleSq = 0.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float scaleSq = m[i][0] * m[i][0] + m[i][1] * m[i][1] + m[i][2] * m[i][2];
+			maxScaleSq = scaleSq > maxScaleSq ? scaleSq : maxScaleSq;
+		}
+		return { Internal::TransformPoint(sphere.center, matrix), sphere.radius * std::sqrt(maxScaleSq) };
+	}
+
+	inline Obb Transform(const Obb& box, const Matrix4x4& matrix)
+	{
+		// 归一化每一行得到旋转,行长度即缩放
+		const float (&m)[4][4] = matrix.m;
+		float rotation[3][3];
+		float scale[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			scale[i] = std::sqrt(m[i][0] * m[i][0] + m[i][1] * m[i][1] + m[i][2] * m[i][2]);
+			for (int j = 0; j < 3; ++j)
+				rotation[i][j] = m[i][j] / scale[i];
+		}
+
+		// 与BoundingOrientedBox::Transform一致,半长按各个轴的缩放分别缩放
+		return {
+			Internal::TransformPoint(box.center, matrix),
+			{ box.extents.x * scale[0], box.extents.y * scale[1], box.extents.z * scale[2] },
+			Internal::QuaternionMultiply(box.orientation, Internal::QuaternionFromRotation(rotation))
+		};
+	}
+
+	inline void TransformAabbs(const Aabb* boxes, const size_t count, const Matrix4x4& matrix, Aabb* pOut)
+	{
+		using namespace Internal;
+
+		const float (&m)[4][4] = matrix.m;
+		size_t i = 0;
+		// 每次处理4个包围盒
+		for (; i + 4 <= count; i += 4)
+		{
+			const Aabb* b = boxes + i;
+			const Vector cx = Set(b[0].center.x, b[1].center.x, b[2].center.x, b[3].center.x);
+			const Vector cy = Set(b[0].center.y, b[1].center.y, b[2].center.y, b[3].center.y);
+			const Vector cz = Set(b[0].center.z, b[1].center.z, b[2].center.z, b[3].center.z);
+			const Vector ex = Set(b[0].extents.x, b[1].extents.x, b[2].extents.x, b[3].extents.x);
+			const Vector ey = Set(b[0].extents.y, b[1].extents.y, b[2].extents.y, b[3].extents.y);
+			const Vector ez = Set(b[0].extents.z, b[1].extents.z, b[2].extents.z, b[3].extents.z);
+
+			float result[6][4];
+			for (int j = 0; j < 3; ++j)
+			{
+				Vector center = MultiplyAdd(cx, Replicate(m[0][j]), Replicate(m[3][j]));
+				center = MultiplyAdd(cy, Replicate(m[1][j]), center);
+				center = MultiplyAdd(cz, Replicate(m[2][j]), center);
+				Store(result[j], center);
+
+				Vector extent = Multiply(ex, Replicate(std::fabs(m[0][j])));
+				extent = MultiplyAdd(ey, Replicate(std::fabs(m[1][j])), extent);
+				extent = MultiplyAdd(ez, Replicate(std::fabs(m[2][j])), extent);
+				Store(result[3 + j], extent);
+			}
+
+			for (int k = 0; k < 4; ++k)
+			{
+				pOut[i + k] = {
+					{ result[0][k], result[1][k], result[2][k] },
+					{ result[3][k], result[4][k], result[5][k] }
+				};
+			}
+		}
+
+		for (; i < count; ++i)
+			pOut[i] = Transform(boxes[i], matrix);
+	}
+
+	inline void TransformSpheres(const Sphere* spheres, const size_t count, const Matrix4x4& matrix, Sphere* pOut)
+	{
+		using namespace Internal;
+
+		const float (&m)[4][4] = matrix.m;
+		const float scale = Transform(Sphere{ { 0.0f, 0.0f, 0.0f }, 1.0f }, matrix).radius;
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const Sphere* s = spheres + i;
+			const Vector cx = Set(s[0].center.x, s[1].center.x, s[2].center.x, s[3].center.x);
+			const Vector cy = Set(s[0].center.y, s[1].center.y, s[2].center.y, s[3].center.y);
+			const Vector cz = Set(s[0].center.z, s[1].center.z, s[2].center.z, s[3].center.z);
+
+			float result[3][4];
+			for (int j = 0; j < 3; ++j)
+			{
+				Vector center = MultiplyAdd(cx, Replicate(m[0][j]), Replicate(m[3][j]));
+				center = MultiplyAdd(cy, Replicate(m[1][j]), center);
+				center = MultiplyAdd(cz, Replicate(m[2][j]), center);
+				Store(result[j], center);
+			}
+
+			for (int k = 0; k < 4; ++k)
+				pOut[i + k] = { { result[0][k], result[1][k], result[2][k] }, s[k].radius * scale };
+		}
+
+		for (; i < count; ++i)
+			pOut[i] = Transform(spheres[i], matrix);
+	}
+
+	inline void TransformAabbs(const Aabb& localBox, const Matrix4x4* matrices, const size_t count, Aabb* pOut)
+	{
+		using namespace Internal;
+
+		// 矩阵的每一行与局部包围盒的一个分量各做一次乘加
+		const Vector ex = Replicate(localBox.extents.x), ey = Replicate(localBox.extents.y), ez = Replicate(localBox.extents.z);
+		const Vector cx = Replicate(localBox.center.x), cy = Replicate(localBox.center.y), cz = Replicate(localBox.center.z);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float (&m)[4][4] = matrices[i].m;
+			const Vector row0 = Set(m[0][0], m[0][1], m[0][2], 0.0f);
+			const Vector row1 = Set(m[1][0], m[1][1], m[1][2], 0.0f);
+			const Vector row2 = Set(m[2][0], m[2][1], m[2][2], 0.0f);
+			const Vector row3 = Set(m[3][0], m[3][1], m[3][2], 0.0f);
+
+			Vector c = MultiplyAdd(cx, row0, row3);
+			c = MultiplyAdd(cy, row1, c);
+			c = MultiplyAdd(cz, row2, c);
+
+			Vector e = Multiply(ex, Abs(row0));
+			e = MultiplyAdd(ey, Abs(row1), e);
+			e = MultiplyAdd(ez, Abs(row2), e);
+
+			float result[2][4];
+			Store(result[0], c);
+			Store(result[1], e);
+			pOut[i] = { { result[0][0], result[0][1], result[0][2] }, { result[1][0], result[1][1], result[1][2] } };
+		}
+	}
+
+	inline void TransformSpheres(const Sphere& localSphere, const Matrix4x4* matrices, const size_t count, Sphere* pOut)
+	{
+		for (size_t i = 0; i < count; ++i)
+			pOut[i] = Transform(localSphere, matrices[i]);
+	}
+
+	//
+	// 相交测试
+	//
+
+	inline bool Intersects(const Aabb& a, const Aabb& b)
+	{
+		return
+			std::fabs(a.center.x - b.center.x) <= a.extents.x + b.extents.x &&
+			std::fabs(a.center.y - b.center.y) <= a.extents.y + b.extents.y &&
+			std::fabs(a.center.z - b.center.z) <= a.extents.z + b.extents.z;
+	}
+
+	inline bool Intersects(const Sphere& a, const Sphere& b)
+	{
+		const Float3 d = { a.center.x - b.center.x, a.center.y - b.center.y, a.center.z - b.center.z };
+		const float r = a.radius + b.radius;
+		return Internal::Dot(d, d) <= r * r;
+	}
+
+	inline bool Intersects(const Sphere& sphere, const Aabb& box)
+	{
+		// 球心到AABB的最近距离
+		auto axisDistance = [](float c, float center, float extent)
+		{
+			const float d = std::fabs(c - center) - extent;
+			return d > 0.0f ? d : 0.0f;
+		};
+		const Float3 d = {
+			axisDistance(sphere.center.x, box.center.x, box.extents.x),
+			axisDistance(sphere.center.y, box.center.y, box.extents.y),
+			axisDistance(sphere.center.z, box.center.z, box.extents.z)
+		};
+		return Internal::Dot(d, d) <= sphere.radius * sphere.radius;
+	}
+
+	inline Containment Contains(const Frustum& frustum, const Aabb& box)
+	{
+		static constexpr Float3 Axes[3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		return Internal::Classify(frustum, box.center, Axes, box.extents, 0.0f);
+	}
+
+	inline Containment Contains(const Frustum& frustum, const Sphere& sphere)
+	{
+		static constexpr Float3 Axes[3] = {};
+		return Internal::Classify(frustum, sphere.center, Axes, Float3{ 0.0f, 0.0f, 0.0f }, sphere.radius);
+	}
+
+	inline Containment Contains(const Frustum& frustum, const Obb& box)
+	{
+		Float3 axes[3];
+		Internal::RotationFromQuaternion(box.orientation, axes);
+		return Internal::Classify(frustum, box.center, axes, box.extents, 0.0f);
+	}
+
+	inline size_t CullAabbs(const Frustum& frustum, const Aabb* boxes, const size_t count, uint8_t* pOutVisible)
+	{
+		using namespace Internal;
+
+		size_t visibleCount = 0;
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const Aabb* b = boxes + i;
+			const uint32_t mask = CullFour(frustum,
+				Set(b[0].center.x, b[1].center.x, b[2].center.x, b[3].center.x),
+				Set(b[0].center.y, b[1].center.y, b[2].center.y, b[3].center.y),
+				Set(b[0].center.z, b[1].center.z, b[2].center.z, b[3].center.z),
+				Set(b[0].extents.x, b[1].extents.x, b[2].extents.x, b[3].extents.x),
+				Set(b[0].extents.y, b[1].extents.y, b[2].extents.y, b[3].extents.y),
+				Set(b[0].extents.z, b[1].extents.z, b[2].extents.z, b[3].extents.z),
+				Replicate(0.0f));
+
+			for (int k = 0; k < 4; ++k)
+			{
+				pOutVisible[i + k] = static_cast<uint8_t>(mask >> k & 1);
+				visibleCount += mask >> k & 1;
+			}
+		}
+
+		for (; i < count; ++i)
+		{
+			pOutVisible[i] = Contains(frustum, boxes[i]) != Containment::Disjoint;
+			visibleCount += pOutVisible[i];
+		}
+		return visibleCount;
+	}
+
+	inline size_t CullSpheres(const Frustum& frustum, const Sphere* spheres, const size_t count, uint8_t* pOutVisible)
+	{
+		using namespace Internal;
+
+		size_t visibleCount = 0;
+		size_t i = 0;
+		const Vector zero = Replicate(0.0f);
+		for (; i + 4 <= count; i += 4)
+		{
+			const Sphere* s = spheres + i;
+			const uint32_t mask = CullFour(frustum,
+				Set(s[0].center.x, s[1].center.x, s[2].center.x, s[3].center.x),
+				Set(s[0].center.y, s[1].center.y, s[2].center.y, s[3].center.y),
+				Set(s[0].center.z, s[1].center.z, s[2].center.z, s[3].center.z),
+				zero, zero, zero,
+				Set(s[0].radius, s[1].radius, s[2].radius, s[3].radius));
+
+			for (int k = 0; k < 4; ++k)
+			{
+				pOutVisible[i + k] = static_cast<uint8_t>(mask >> k & 1);
+				visibleCount += mask >> k & 1;
+			}
+		}
+
+		for (; i < count; ++i)
+		{
+			pOutVisible[i] = Contains(frustum, spheres[i]) != Containment::Disjoint;
+			visibleCount += pOutVisible[i];
+		}
+		return visibleCount;
+	}
+}
+
+#endif
@@ -0,0 +1,69 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// Bounds与DirectXMath/DirectXCollision之间的类型转换
+// 两边的内存布局相同,按值逐项复制,不依赖reinterpret_cast
+// Conversions between Bounds types and DirectXMath/DirectXCollision types.
+//***************************************************************************************
+
+#ifndef BOUNDSINTEROP_H
+#define BOUNDSINTEROP_H
+
+#include <DirectXCollision.h>
+
+#include "Bounds.h"
+
+namespace Bounds
+{
+	inline Matrix4x4 XM_CALLCONV ToMatrix4x4(DirectX::FXMMATRIX matrix)
+	{
+		DirectX::XMFLOAT4X4 m;
+		DirectX::XMStoreFloat4x4(&m, matrix);
+		Matrix4x4 result;
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				result.m[i][j] = m.m[i][j];
+		return result;
+	}
+
+	inline Aabb ToAabb(const DirectX::BoundingBox& box)
+	{
+		return { { box.Center.x, box.Center.y, box.Center.z }, { box.Extents.x, box.Extents.y, box.Extents.z } };
+	}
+
+	inline Sphere ToSphere(const DirectX::BoundingSphere& sphere)
+	{
+		return { { sphere.Center.x, sphere.Center.y, sphere.Center.z }, sphere.Radius };
+	}
+
+	inline Obb ToObb(const DirectX::BoundingOrientedBox& box)
+	{
+		return {
+			{ box.Center.x, box.Center.y, box.Center.z },
+			{ box.Extents.x, box.Extents.y, box.Extents.z },
+			{ box.Orientation.x, box.Orientation.y, box.Orientation.z, box.Orientation.w }
+		};
+	}
+
+	inline DirectX::BoundingBox ToBoundingBox(const Aabb& box)
+	{
+		return DirectX::BoundingBox(
+			DirectX::XMFLOAT3(box.center.x, box.center.y, box.center.z),
+			DirectX::XMFLOAT3(box.extents.x, box.extents.y, box.extents.z));
+	}
+
+	inline DirectX::BoundingSphere ToBoundingSphere(const Sphere& sphere)
+	{
+		return DirectX::BoundingSphere(DirectX::XMFLOAT3(sphere.center.x, sphere.center.y, sphere.center.z), sphere.radius);
+	}
+
+	inline DirectX::BoundingOrientedBox ToBoundingOrientedBox(const Obb& box)
+	{
+		return DirectX::BoundingOrientedBox(
+			DirectX::XMFLOAT3(box.center.x, box.center.y, box.center.z),
+			DirectX::XMFLOAT3(box.extents.x, box.extents.y, box.extents.z),
+			DirectX::XMFLOAT4(box.orientation.x, box.orientation.y, box.orientation.z, box.orientation.w));
+	}
+}
+
+#endif
@@ -0,0 +1,307 @@
+#include "Broadphase.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	void GetMinMax(const BoundingBox& box, XMFLOAT3& outMin, XMFLOAT3& outMax)
+	{
+		outMin = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+		outMax = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+	}
+}
+
+//
+// SweepAndPrune
+//
+
+UINT SweepAndPrune::AddProxy(const BoundingBox& box)
+{
+	UINT proxy;
+	if (!m_freeProxies.empty())
+	{
+		proxy = m_freeProxies.back();
+		m_freeProxies.pop_back();
+	}
+	else
+	{
+		proxy = static_cast<UINT>(m_proxies.size());
+		m_proxies.emplace_back();
+	}
+
+	Proxy& p = m_proxies[proxy];
+	GetMinMax(box, p.boxMin, p.boxMax);
+	p.alive = true;
+
+	// 新端点放在末尾,下一次FindPairs时由插入排序归位
+	m_endpoints.push_back({ p.boxMin.x, proxy, true });
+	m_endpoints.push_back({ p.boxMax.x, proxy, false });
+	++m_proxyCount;
+
+	return proxy;
+}
+
+void SweepAndPrune::RemoveProxy(const UINT proxy)
+{
+	if (proxy >= m_proxies.size() || !m_proxies[proxy].alive)
+		return;
+
+	m_proxies[proxy].alive = false;
+	m_endpoints.erase(
+		std::remove_if(m_endpoints.begin(), m_endpoints.end(), [proxy](const Endpoint& endpoint) { return endpoint.proxy == proxy; }),
+		m_endpoints.end());
+	m_freeProxies.push_back(proxy);
+	--m_proxyCount;
+}
+
+void SweepAndPrune::UpdateProxy(const UINT proxy, const BoundingBox& box)
+{
+	Proxy& p = m_proxies[proxy];
+	assert(p.alive);
+	GetMinMax(box, p.boxMin, p.boxMax);
+}
+
+void SweepAndPrune::FindPairs(std::vector<CollisionPair>& outPairs)
+{
+	outPairs.clear();
+
+	// 刷新端点的值
+	for (Endpoint& endpoint : m_endpoints)
+	{
+		const Proxy& p = m_proxies[endpoint.proxy];
+		endpoint.value = endpoint.isMin ? p.boxMin.x : p.boxMax.x;
+	}
+
+	// 插入排序,值相同时最小端点在前,保证相接触的包围盒也被视为重叠(与BoundingBox::Intersects一致)
+	const auto less = [](const Endpoint& lhs, const Endpoint& rhs)
+	{
+		return lhs.value < rhs.value || (lhs.value == rhs.value && lhs.isMin && !rhs.isMin);
+	};
+	for (size_t i = 1; i < m_endpoints.size(); ++i)
+	{
+		const Endpoint endpoint = m_endpoints[i];
+		size_t j = i;
+		while (j > 0 && less(endpoint, m_endpoints[j - 1]))
+		{
+			m_endpoints[j] = m_endpoints[j - 1];
+			--j;
+		}
+		m_endpoints[j] = endpoint;
+	}
+
+	// 沿X轴扫描,只对X轴上重叠的代理检测Y/Z轴
+	m_activeProxies.clear();
+	for (const Endpoint& endpoint : m_endpoints)
+	{
+		if (!endpoint.isMin)
+		{
+			const auto it = std::find(m_activeProxies.begin(), m_activeProxies.end(), endpoint.proxy);
+			*it = m_activeProxies.back();
+			m_activeProxies.pop_back();
+			continue;
+		}
+
+		const Proxy& p = m_proxies[endpoint.proxy];
+		for (const UINT other : m_activeProxies)
+		{
+			const Proxy& q = m_proxies[other];
+			if (p.boxMin.y <= q.boxMax.y && q.boxMin.y <= p.boxMax.y &&
+				p.boxMin.z <= q.boxMax.z && q.boxMin.z <= p.boxMax.z)
+			{
+				outPairs.push_back({ (std::min)(endpoint.proxy, other), (std::max)(endpoint.proxy, other) });
+			}
+		}
+		m_activeProxies.push_back(endpoint.proxy);
+	}
+}
+
+void SweepAndPrune::Clear()
+{
+	m_proxies.clear();
+	m_freeProxies.clear();
+	m_endpoints.clear();
+	m_activeProxies.clear();
+	m_proxyCount = 0;
+}
+
+UINT SweepAndPrune::GetProxyCount() const
+{
+	return m_proxyCount;
+}
+
+//
+// SpatialHashGrid
+//
+
+SpatialHashGrid::SpatialHashGrid(const float cellSize, const UINT bucketCount)
+	:
+	m_cellSize(cellSize),
+	m_invCellSize(1.0f / cellSize),
+	m_bucketCount((std::max)(bucketCount, 1u))
+{
+	assert(cellSize > 0.0f);
+}
+
+void SpatialHashGrid::SetCellSize(const float cellSize)
+{
+	assert(cellSize > 0.0f);
+	m_cellSize = cellSize;
+	m_invCellSize = 1.0f / cellSize;
+	m_isDirty = true;
+}
+
+float SpatialHashGrid::GetCellSize() const
+{
+	return m_cellSize;
+}
+
+UINT SpatialHashGrid::Insert(const BoundingBox& box)
+{
+	m_boxes.push_back(box);
+	m_isDirty = true;
+	return static_cast<UINT>(m_boxes.size() - 1);
+}
+
+void SpatialHashGrid::FindPairs(std::vector<CollisionPair>& outPairs)
+{
+	outPairs.clear();
+	BuildBuckets();
+
+	for (UINT bucket = 0; bucket < m_bucketCount; ++bucket)
+	{
+		const UINT begin = m_bucketStarts[bucket];
+		const UINT end = m_bucketStarts[bucket + 1];
+		for (UINT i = begin; i < end; ++i)
+		{
+			const Entry& a = m_entries[i];
+			for (UINT j = i + 1; j < end; ++j)
+			{
+				const Entry& b = m_entries[j];
+				// 不同单元可能哈希到同一个桶
+				if (a.cell.x != b.cell.x || a.cell.y != b.cell.y || a.cell.z != b.cell.z)
+					continue;
+
+				const BoundingBox& boxA = m_boxes[a.object];
+				const BoundingBox& boxB = m_boxes[b.object];
+				if (!boxA.Intersects(boxB))
+					continue;
+
+				// 两个物体可能同时位于多个单元中,只在重叠区域最小角所在的单元中报告一次
+				XMFLOAT3 minA, maxA, minB, maxB;
+				GetMinMax(boxA, minA, maxA);
+				GetMinMax(boxB, minB, maxB);
+				const BoundingBox overlapCorner(XMFLOAT3((std::max)(minA.x, minB.x), (std::max)(minA.y, minB.y), (std::max)(minA.z, minB.z)), XMFLOAT3());
+				Cell cornerCell, unused;
+				GetCellRange(overlapCorner, cornerCell, unused);
+				if (cornerCell.x != a.cell.x || cornerCell.y != a.cell.y || cornerCell.z != a.cell.z)
+					continue;
+
+				outPairs.push_back({ (std::min)(a.object, b.object), (std::max)(a.object, b.object) });
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::Query(const BoundingBox& box, std::vector<UINT>& outIndices)
+{
+	BuildBuckets();
+
+	XMFLOAT3 queryMin, queryMax;
+	GetMinMax(box, queryMin, queryMax);
+
+	Cell cellMin, cellMax;
+	GetCellRange(box, cellMin, cellMax);
+	for (int z = cellMin.z; z <= cellMax.z; ++z)
+	{
+		for (int y = cellMin.y; y <= cellMax.y; ++y)
+		{
+			for (int x = cellMin.x; x <= cellMax.x; ++x)
+			{
+				const Cell cell{ x, y, z };
+				const UINT bucket = GetBucket(cell);
+				for (UINT i = m_bucketStarts[bucket]; i < m_bucketStarts[bucket + 1]; ++i)
+				{
+					const Entry& entry = m_entries[i];
+					if (entry.cell.x != x || entry.cell.y != y || entry.cell.z != z)
+						continue;
+
+					const BoundingBox& other = m_boxes[entry.object];
+					if (!other.Intersects(box))
+						continue;
+
+					// 同样只在重叠区域最小角所在的单元中报告
+					XMFLOAT3 otherMin, otherMax;
+					GetMinMax(other, otherMin, otherMax);
+					const BoundingBox overlapCorner(XMFLOAT3((std::max)(queryMin.x, otherMin.x), (std::max)(queryMin.y, otherMin.y), (std::max)(queryMin.z, otherMin.z)), XMFLOAT3());
+					Cell cornerCell, unused;
+					GetCellRange(overlapCorner, cornerCell, unused);
+					if (cornerCell.x == x && cornerCell.y == y && cornerCell.z == z)
+						outIndices.push_back(entry.object);
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::Clear()
+{
+	m_boxes.clear();
+	m_entries.clear();
+	m_isDirty = true;
+}
+
+UINT SpatialHashGrid::GetObjectCount() const
+{
+	return static_cast<UINT>(m_boxes.size());
+}
+
+void SpatialHashGrid::GetCellRange(const BoundingBox& box, Cell& outMin, Cell& outMax) const
+{
+	XMFLOAT3 boxMin, boxMax;
+	GetMinMax(box, boxMin, boxMax);
+
+	outMin = { static_cast<int>(std::floor(boxMin.x * m_invCellSize)), static_cast<int>(std::floor(boxMin.y * m_invCellSize)), static_cast<int>(std::floor(boxMin.z * m_invCellSize)) };
+	outMax = { static_cast<int>(std::floor(boxMax.x * m_invCellSize)), static_cast<int>(std::floor(boxMax.y * m_invCellSize)), static_cast<int>(std::floor(boxMax.z * m_invCellSize)) };
+}
+
+UINT SpatialHashGrid::GetBucket(const Cell& cell) const
+{
+	const UINT hash = static_cast<UINT>(cell.x) * 73856093u ^ static_cast<UINT>(cell.y) * 19349663u ^ static_cast<UINT>(cell.z) * 83492791u;
+	return hash % m_bucketCount;
+}
+
+void SpatialHashGrid::BuildBuckets()
+{
+	if (!m_isDirty)
+		return;
+	m_isDirty = false;
+
+	// 登记每个物体覆盖的单元
+	m_scratch.clear();
+	const UINT count = static_cast<UINT>(m_boxes.size());
+	for (UINT i = 0; i < count; ++i)
+	{
+		Cell cellMin, cellMax;
+		GetCellRange(m_boxes[i], cellMin, cellMax);
+		for (int z = cellMin.z; z <= cellMax.z; ++z)
+			for (int y = cellMin.y; y <= cellMax.y; ++y)
+				for (int x = cellMin.x; x <= cellMax.x; ++x)
+					m_scratch.push_back({ { x, y, z }, i });
+	}
+
+	// 计数排序分桶
+	m_bucketStarts.assign(static_cast<size_t>(m_bucketCount) + 1, 0);
+	for (const Entry& entry : m_scratch)
+		++m_bucketStarts[GetBucket(entry.cell) + 1];
+	for (UINT bucket = 0; bucket < m_bucketCount; ++bucket)
+		m_bucketStarts[bucket + 1] += m_bucketStarts[bucket];
+
+	m_entries.resize(m_scratch.size());
+	m_bucketCursors.assign(m_bucketStarts.begin(), m_bucketStarts.end() - 1);
+	for (const Entry& entry : m_scratch)
+		m_entries[m_bucketCursors[GetBucket(entry.cell)]++] = entry;
+}
@@ -0,0 +1,136 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 粗测阶段碰撞检测: 扫描剪枝(Sweep And Prune)与均匀空间哈希网格
+// 两者都只负责找出AABB重叠的物体对,精确检测交给后续阶段
+// Broadphase collision detection: sweep-and-prune and uniform spatial hash grid.
+//***************************************************************************************
+
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "PortableTypes.h"
+
+#include <DirectXCollision.h>
+#include <vector>
+
+// 重叠的物体对,总是满足first < second
+struct CollisionPair
+{
+	UINT first;
+	UINT second;
+};
+
+//
+// 扫描剪枝
+// 在X轴上维护排好序的端点列表,由于物体每帧移动很少,端点列表几乎有序,
+// 使用插入排序的代价接近O(n)
+//
+class SweepAndPrune
+{
+public:
+	// 无效的代理
+	static constexpr UINT InvalidProxy = 0xFFFFFFFF;
+
+	// 添加代理,返回代理编号,编号在移除之前保持不变
+	UINT AddProxy(const DirectX::BoundingBox& box);
+	// 使用物体的GetBoundingBox()(如GameObject),模块本身不依赖具体的物体类型
+	template<typename Object>
+	UINT AddProxy(const Object& object) { return AddProxy(object.GetBoundingBox()); }
+	// 移除代理,之后该编号可能会被重新分配
+	void RemoveProxy(UINT proxy);
+
+	// 更新代理的包围盒
+	void UpdateProxy(UINT proxy, const DirectX::BoundingBox& box);
+	template<typename Object>
+	void UpdateProxy(UINT proxy, const Object& object) { UpdateProxy(proxy, object.GetBoundingBox()); }
+
+	// 获取所有重叠的代理对(会先清空outPairs)
+	void FindPairs(std::vector<CollisionPair>& outPairs);
+
+	void Clear();
+
+	UINT GetProxyCount() const;
+
+private:
+	struct Proxy
+	{
+		DirectX::XMFLOAT3 boxMin;
+		DirectX::XMFLOAT3 boxMax;
+		bool alive;
+	};
+
+	struct Endpoint
+	{
+		float value;
+		UINT proxy;			// 代理编号
+		bool isMin;			// 是否为最小端点
+	};
+
+	std::vector<Proxy> m_proxies;
+	std::vector<UINT> m_freeProxies;			// 可重用的代理编号
+	std::vector<Endpoint> m_endpoints;			// X轴上的端点
+	std::vector<UINT> m_activeProxies;			// 扫描过程中与当前位置重叠的代理
+	UINT m_proxyCount = 0;
+};
+
+//
+// 均匀空间哈希网格
+// 每帧清空后重新插入,物体按包围盒覆盖的网格单元登记,
+// 只有落在同一单元内的物体才会进行AABB测试
+//
+class SpatialHashGrid
+{
+public:
+	// cellSize最好略大于大多数物体的尺寸
+	explicit SpatialHashGrid(float cellSize = 4.0f, UINT bucketCount = 4096);
+
+	void SetCellSize(float cellSize);
+	float GetCellSize() const;
+
+	// 插入物体,返回物体编号(按插入顺序从0开始)
+	UINT Insert(const DirectX::BoundingBox& box);
+	template<typename Object>
+	UINT Insert(const Object& object) { return Insert(object.GetBoundingBox()); }
+
+	// 获取所有重叠的物体对(会先清空outPairs)
+	void FindPairs(std::vector<CollisionPair>& outPairs);
+	// 获取所有与box相交的物体编号(追加到outIndices中)
+	void Query(const DirectX::BoundingBox& box, std::vector<UINT>& outIndices);
+
+	// 移除所有物体,保留已分配的内存
+	void Clear();
+
+	UINT GetObjectCount() const;
+
+private:
+	struct Cell
+	{
+		int x, y, z;
+	};
+
+	struct Entry
+	{
+		Cell cell;
+		UINT object;
+	};
+
+	// 获取box覆盖的单元范围
+	void GetCellRange(const DirectX::BoundingBox& box, Cell& outMin, Cell& outMax) const;
+	UINT GetBucket(const Cell& cell) const;
+	// 将所有物体按单元哈希分桶
+	void BuildBuckets();
+
+	float m_cellSize;
+	float m_invCellSize;
+	UINT m_bucketCount;
+
+	std::vector<DirectX::BoundingBox> m_boxes;
+	std::vector<Entry> m_entries;				// 按桶排列的单元登记项
+	std::vector<UINT> m_bucketStarts;			// 每个桶在m_entries中的起始位置(共m_bucketCount + 1项)
+	std::vector<Entry> m_scratch;
+	std::vector<UINT> m_bucketCursors;			// 分桶时每个桶的写入位置
+	bool m_isDirty = true;
+};
+
+#endif
@@ -102,16 +102,20 @@ void FirstPersonCamera::MoveForward(const float d)
 void FirstPersonCamera::Pitch(const float rad)
 {
 	// 将绕x轴旋转弧度限制在[-7pi/18, 7pi/18]之间
-	m_rotation.x += rad;
-	if (m_rotation.x > XM_PI * 7 / 18)
-		m_rotation.x = XM_PI * 7 / 18;
-	else if (m_rotation.x < -XM_PI * 7 / 18)
-		m_rotation.x = -XM_PI * 7 / 18;
+	XMFLOAT3 rotation = GetRotationFloat3();
+	rotation.x += rad;
+	if (rotation.x > XM_PI * 7 / 18)
+		rotation.x = XM_PI * 7 / 18;
+	else if (rotation.x < -XM_PI * 7 / 18)
+		rotation.x = -XM_PI * 7 / 18;
+	SetRotation(rotation);
 }
 
 void FirstPersonCamera::RotateY(const float rad)
 {
-	m_rotation.y = XMScalarModAngle(m_rotation.y + rad);
+	XMFLOAT3 rotation = GetRotationFloat3();
+	rotation.y = XMScalarModAngle(rotation.y + rad);
+	SetRotation(rotation);
 }
 
 // ******************
@@ -131,11 +135,13 @@ float ThirdPersonCamera::GetDistance() const
 void ThirdPersonCamera::RotateX(const float rad)
 {
 	// 将绕x轴旋转弧度限制在[0, pi/3]之间
-	m_rotation.x += rad;
-	if (m_rotation.x < 0.0f)
-		m_rotation.x = 0.0f;
-	else if (m_rotation.x > XM_PI / 3)
-		m_rotation.x = XM_PI / 3;
+	XMFLOAT3 rotation = GetRotationFloat3();
+	rotation.x += rad;
+	if (rotation.x < 0.0f)
+		rotation.x = 0.0f;
+	else if (rotation.x > XM_PI / 3)
+		rotation.x = XM_PI / 3;
+	SetRotation(rotation);
 
 	SetPosition(m_target);
 	Translate(GetForwardAxisVector(), -m_distance);
@@ -143,7 +149,9 @@ void ThirdPersonCamera::RotateX(const float rad)
 
 void ThirdPersonCamera::RotateY(const float rad)
 {
-	m_rotation.y = XMScalarModAngle(m_rotation.y + rad);
+	XMFLOAT3 rotation = GetRotationFloat3();
+	rotation.y = XMScalarModAngle(rotation.y + rad);
+	SetRotation(rotation);
 
 	SetPosition(m_target);
 	Translate(GetForwardAxisVector(), -m_distance);
@@ -165,11 +173,13 @@ void ThirdPersonCamera::Approach(const float dist)
 void ThirdPersonCamera::SetRotationX(const float rad)
 {
 	// 将绕x轴旋转弧度限制在[0, pi/3]之间
-	m_rotation.x = rad;
-	if (m_rotation.x < 0.0f)
-		m_rotation.x = 0.0f;
-	else if (m_rotation.x > XM_PI / 3)
-		m_rotation.x = XM_PI / 3;
+	XMFLOAT3 rotation = GetRotationFloat3();
+	rotation.x = rad;
+	if (rotation.x < 0.0f)
+		rotation.x = 0.0f;
+	else if (rotation.x > XM_PI / 3)
+		rotation.x = XM_PI / 3;
+	SetRotation(rotation);
 
 	SetPosition(m_target);
 	Translate(GetForwardAxisVector(), -m_distance);
@@ -177,7 +187,9 @@ void ThirdPersonCamera::SetRotationX(const float rad)
 
 void ThirdPersonCamera::SetRotationY(const float rad)
 {
-	m_rotation.y = XMScalarModAngle(rad);
+	XMFLOAT3 rotation = GetRotationFloat3();
+	rotation.y = XMScalarModAngle(rad);
+	SetRotation(rotation);
 
 	SetPosition(m_target);
 	Translate(GetForwardAxisVector(), -m_distance);
@@ -0,0 +1,306 @@
+#include "ClusteredLightCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	UINT XM_CALLCONV GetLaneMask(FXMVECTOR control)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		return static_cast<UINT>(_mm_movemask_ps(control));
+#else
+		XMUINT4 lanes;
+		XMStoreUInt4(&lanes, control);
+		return (lanes.x >> 31) | (lanes.y >> 31) << 1 | (lanes.z >> 31) << 2 | (lanes.w >> 31) << 3;
+#endif
+	}
+
+	// 将[0, count)范围内的连续坐标截断为簇的下标
+	UINT ClampTile(const float t, const UINT count)
+	{
+		const float index = std::floor(t);
+		if (index <= 0.0f)
+			return 0;
+		return (std::min)(static_cast<UINT>(index), count - 1);
+	}
+
+	XMVECTOR XM_CALLCONV LoadFloat4(const std::vector<float>& data, const UINT index)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(data.data() + index));
+	}
+}
+
+ClusteredLightCulling::ClusteredLightCulling(const UINT clusterCountX, const UINT clusterCountY, const UINT clusterCountZ)
+	:
+	m_clusterCountX(clusterCountX),
+	m_clusterCountY(clusterCountY),
+	m_clusterCountZ(clusterCountZ),
+	m_rowStride((clusterCountX + 3) & ~3u),
+	m_xScale(),
+	m_yScale(),
+	m_nearZ(),
+	m_farZ(),
+	m_sliceScale(),
+	m_statistics()
+{
+	// 补齐的元素永远不会与任何包围球相交
+	const size_t boxCount = static_cast<size_t>(m_rowStride) * clusterCountY * clusterCountZ;
+	m_minX.assign(boxCount, FLT_MAX);
+	m_minY.assign(boxCount, FLT_MAX);
+	m_minZ.assign(boxCount, FLT_MAX);
+	m_maxX.assign(boxCount, -FLT_MAX);
+	m_maxY.assign(boxCount, -FLT_MAX);
+	m_maxZ.assign(boxCount, -FLT_MAX);
+
+	m_clusters.resize(GetClusterCount());
+	m_pointCounts.resize(GetClusterCount());
+	m_spotCounts.resize(GetClusterCount());
+
+	SetProjection(XMMatrixPerspectiveFovLH(XM_PIDIV2, 16.0f / 9.0f, 0.5f, 1000.0f));
+}
+
+void ClusteredLightCulling::SetProjection(FXMMATRIX proj)
+{
+	XMFLOAT4X4 m{};
+	XMStoreFloat4x4(&m, proj);
+
+	// _33 = f / (f - n), _43 = -n * f / (f - n)
+	m_xScale = m._11;
+	m_yScale = m._22;
+	m_nearZ = -m._43 / m._33;
+	m_farZ = m._43 / (1.0f - m._33);
+
+	const float depthRatio = m_farZ / m_nearZ;
+	m_sliceScale = static_cast<float>(m_clusterCountZ) / std::log(depthRatio);
+
+	for (UINT z = 0; z < m_clusterCountZ; ++z)
+	{
+		// 深度方向按指数划分,使每个簇的长宽比接近
+		const float z0 = m_nearZ * std::pow(depthRatio, static_cast<float>(z) / m_clusterCountZ);
+		const float z1 = m_nearZ * std::pow(depthRatio, static_cast<float>(z + 1) / m_clusterCountZ);
+
+		for (UINT y = 0; y < m_clusterCountY; ++y)
+		{
+			const float ndcTop = 1.0f - 2.0f * y / m_clusterCountY;
+			const float ndcBottom = 1.0f - 2.0f * (y + 1) / m_clusterCountY;
+
+			for (UINT x = 0; x < m_clusterCountX; ++x)
+			{
+				const float ndcLeft = -1.0f + 2.0f * x / m_clusterCountX;
+				const float ndcRight = -1.0f + 2.0f * (x + 1) / m_clusterCountX;
+
+				// 簇是视锥体的一部分,取其8个角点的包围盒
+				const UINT index = (z * m_clusterCountY + y) * m_rowStride + x;
+				m_minX[index] = (std::min)({ ndcLeft * z0, ndcLeft * z1 }) / m_xScale;
+				m_maxX[index] = (std::max)({ ndcRight * z0, ndcRight * z1 }) / m_xScale;
+				m_minY[index] = (std::min)({ ndcBottom * z0, ndcBottom * z1 }) / m_yScale;
+				m_maxY[index] = (std::max)({ ndcTop * z0, ndcTop * z1 }) / m_yScale;
+				m_minZ[index] = z0;
+				m_maxZ[index] = z1;
+			}
+		}
+	}
+}
+
+const std::vector<ClusteredLightCulling::Cluster>& ClusteredLightCulling::Cull(FXMMATRIX view,
+	const PointLight* pointLights, const UINT pointLightCount,
+	const SpotLight* spotLights, const UINT spotLightCount)
+{
+	m_statistics = {};
+	m_pointPairs.clear();
+	m_spotPairs.clear();
+	std::fill(m_pointCounts.begin(), m_pointCounts.end(), 0u);
+	std::fill(m_spotCounts.begin(), m_spotCounts.end(), 0u);
+
+	// 按光源顺序生成(簇, 光源)配对
+	for (UINT i = 0; i < pointLightCount; ++i)
+	{
+		const PointLight& light = pointLights[i];
+		const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&light.position), view);
+		if (AssignLight(center, g_XMZero, light.range, false, i, m_pointPairs, m_pointCounts))
+			++m_statistics.visibleLights;
+	}
+
+	for (UINT i = 0; i < spotLightCount; ++i)
+	{
+		const SpotLight& light = spotLights[i];
+		const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&light.position), view);
+		const XMVECTOR direction = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&light.direction), view));
+		if (AssignLight(center, direction, light.range, true, i, m_spotPairs, m_spotCounts))
+			++m_statistics.visibleLights;
+	}
+
+	// 前缀和得到每个簇的偏移,此后计数数组复用为写入位置
+	UINT offset = 0;
+	const UINT clusterCount = GetClusterCount();
+	for (UINT i = 0; i < clusterCount; ++i)
+	{
+		Cluster& cluster = m_clusters[i];
+		cluster.offset = offset;
+		cluster.pointLightCount = m_pointCounts[i];
+		cluster.spotLightCount = m_spotCounts[i];
+		cluster.pad = 0;
+
+		const UINT lightCount = cluster.pointLightCount + cluster.spotLightCount;
+		m_statistics.maxLightsPerCluster = (std::max)(m_statistics.maxLightsPerCluster, lightCount);
+
+		m_pointCounts[i] = offset;
+		m_spotCounts[i] = offset + cluster.pointLightCount;
+		offset += lightCount;
+	}
+	m_statistics.lightClusterPairs = offset;
+
+	// 配对本身按光源索引升序生成,依次写入即可保证簇内有序
+	m_lightIndices.resize(offset);
+	for (const LightClusterPair& pair : m_pointPairs)
+		m_lightIndices[m_pointCounts[pair.cluster]++] = pair.light;
+	for (const LightClusterPair& pair : m_spotPairs)
+		m_lightIndices[m_spotCounts[pair.cluster]++] = pair.light;
+
+	return m_clusters;
+}
+
+UINT ClusteredLightCulling::GetClusterCountX() const
+{
+	return m_clusterCountX;
+}
+
+UINT ClusteredLightCulling::GetClusterCountY() const
+{
+	return m_clusterCountY;
+}
+
+UINT ClusteredLightCulling::GetClusterCountZ() const
+{
+	return m_clusterCountZ;
+}
+
+UINT ClusteredLightCulling::GetClusterCount() const
+{
+	return m_clusterCountX * m_clusterCountY * m_clusterCountZ;
+}
+
+UINT ClusteredLightCulling::GetClusterIndex(const UINT x, const UINT y, const UINT z) const
+{
+	return (z * m_clusterCountY + y) * m_clusterCountX + x;
+}
+
+UINT ClusteredLightCulling::GetSlice(const float viewZ) const
+{
+	if (viewZ <= m_nearZ)
+		return 0;
+	return ClampTile(std::log(viewZ / m_nearZ) * m_sliceScale, m_clusterCountZ);
+}
+
+const std::vector<ClusteredLightCulling::Cluster>& ClusteredLightCulling::GetClusters() const
+{
+	return m_clusters;
+}
+
+const std::vector<UINT>& ClusteredLightCulling::GetLightIndices() const
+{
+	return m_lightIndices;
+}
+
+const ClusteredLightCulling::Statistics& ClusteredLightCulling::GetStatistics() const
+{
+	return m_statistics;
+}
+
+bool ClusteredLightCulling::AssignLight(FXMVECTOR center, FXMVECTOR direction, const float radius, const bool isSpot,
+	const UINT light, std::vector<LightClusterPair>& pairs, std::vector<UINT>& counts)
+{
+	XMFLOAT3 c{};
+	XMStoreFloat3(&c, center);
+
+	// 深度范围
+	const float zMin = (std::max)(c.z - radius, m_nearZ);
+	const float zMax = (std::min)(c.z + radius, m_farZ);
+	if (zMin > zMax)
+		return false;
+
+	// 包围球在屏幕上的保守范围: x / z 在 zMin 或 zMax 处取得极值
+	const float xMin = c.x - radius, xMax = c.x + radius;
+	const float yMin = c.y - radius, yMax = c.y + radius;
+	const float ndcMinX = xMin * m_xScale / (xMin < 0.0f ? zMin : zMax);
+	const float ndcMaxX = xMax * m_xScale / (xMax > 0.0f ? zMin : zMax);
+	const float ndcMinY = yMin * m_yScale / (yMin < 0.0f ? zMin : zMax);
+	const float ndcMaxY = yMax * m_yScale / (yMax > 0.0f ? zMin : zMax);
+	if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f)
+		return false;
+
+	const UINT x0 = ClampTile((ndcMinX + 1.0f) * 0.5f * m_clusterCountX, m_clusterCountX);
+	const UINT x1 = ClampTile((ndcMaxX + 1.0f) * 0.5f * m_clusterCountX, m_clusterCountX);
+	const UINT y0 = ClampTile((1.0f - ndcMaxY) * 0.5f * m_clusterCountY, m_clusterCountY);
+	const UINT y1 = ClampTile((1.0f - ndcMinY) * 0.5f * m_clusterCountY, m_clusterCountY);
+	const UINT z0 = GetSlice(zMin);
+	const UINT z1 = GetSlice(zMax);
+
+	const XMVECTOR centerX = XMVectorReplicate(c.x);
+	const XMVECTOR centerY = XMVectorReplicate(c.y);
+	const XMVECTOR centerZ = XMVectorReplicate(c.z);
+	const XMVECTOR radiusSq = XMVectorReplicate(radius * radius);
+
+	// 聚光灯只照亮朝向方向一侧的半空间: 取包围盒在该方向上最远的顶点测试
+	XMFLOAT3 n{};
+	XMStoreFloat3(&n, direction);
+	const XMVECTOR normalX = XMVectorReplicate(n.x);
+	const XMVECTOR normalY = XMVectorReplicate(n.y);
+	const XMVECTOR normalZ = XMVectorReplicate(n.z);
+	const XMVECTOR planeOffset = XMVector3Dot(direction, center);
+	const std::vector<float>& supportX = n.x > 0.0f ? m_maxX : m_minX;
+	const std::vector<float>& supportY = n.y > 0.0f ? m_maxY : m_minY;
+	const std::vector<float>& supportZ = n.z > 0.0f ? m_maxZ : m_minZ;
+
+	const size_t firstPair = pairs.size();
+	for (UINT z = z0; z <= z1; ++z)
+	{
+		for (UINT y = y0; y <= y1; ++y)
+		{
+			const UINT row = (z * m_clusterCountY + y) * m_rowStride;
+			const UINT clusterRow = GetClusterIndex(0, y, z);
+
+			// 每次测试4个相邻的簇
+			for (UINT x = x0 & ~3u; x <= x1; x += 4)
+			{
+				const UINT index = row + x;
+
+				// 包围球与AABB的最近距离
+				const XMVECTOR dx = XMVectorMax(XMVectorMax(LoadFloat4(m_minX, index) - centerX, centerX - LoadFloat4(m_maxX, index)), g_XMZero);
+				const XMVECTOR dy = XMVectorMax(XMVectorMax(LoadFloat4(m_minY, index) - centerY, centerY - LoadFloat4(m_maxY, index)), g_XMZero);
+				const XMVECTOR dz = XMVectorMax(XMVectorMax(LoadFloat4(m_minZ, index) - centerZ, centerZ - LoadFloat4(m_maxZ, index)), g_XMZero);
+				XMVECTOR hit = XMVectorLessOrEqual(dx * dx + dy * dy + dz * dz, radiusSq);
+
+				if (isSpot)
+				{
+					const XMVECTOR side =
+						LoadFloat4(supportX, index) * normalX +
+						LoadFloat4(supportY, index) * normalY +
+						LoadFloat4(supportZ, index) * normalZ;
+					hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(side, planeOffset));
+				}
+
+				// 屏蔽[x0, x1]之外的簇
+				const UINT first = x0 > x ? x0 - x : 0;
+				const UINT last = (std::min)(x1 - x, 3u);
+				const UINT mask = GetLaneMask(hit) & (((1u << (last + 1)) - 1) & ~((1u << first) - 1));
+
+				for (UINT lane = 0; lane < 4; ++lane)
+				{
+					if (mask & (1u << lane))
+					{
+						const UINT cluster = clusterRow + x + lane;
+						pairs.push_back({ cluster, light });
+						++counts[cluster];
+					}
+				}
+			}
+		}
+	}
+
+	return pairs.size() != firstPair;
+}
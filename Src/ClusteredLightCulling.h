@@ -0,0 +1,104 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// CPU分簇光照剔除(Clustered Forward)
+// 将观察空间视锥体划分为X*Y*Z个簇(深度方向按指数划分),
+// 把点光源/聚光灯的包围体分配到簇中,生成紧凑的逐簇光源索引列表以供上传到GPU
+// 结果只取决于输入顺序,每个簇内先列出点光源再列出聚光灯,均按光源索引升序排列
+// 不依赖D3D,着色器尚未读取簇与索引列表,上传与着色器的接入另行处理
+// Clustered light culling on the CPU with compact per-cluster light index lists.
+//***************************************************************************************
+
+#ifndef CLUSTEREDLIGHTCULLING_H
+#define CLUSTEREDLIGHTCULLING_H
+
+#include "PortableTypes.h"
+#include <DirectXMath.h>
+#include <vector>
+
+#include "LightHelper.h"
+
+class ClusteredLightCulling
+{
+public:
+	// 单个簇在索引列表中的范围,大小为16字节,可直接作为结构化缓冲区的元素
+	// lightIndices[offset, offset + pointLightCount)为点光源索引,
+	// 随后的spotLightCount个为聚光灯索引
+	struct Cluster
+	{
+		UINT offset;
+		UINT pointLightCount;
+		UINT spotLightCount;
+		UINT pad;
+	};
+
+	// 统计信息,每次Cull时清零
+	struct Statistics
+	{
+		UINT visibleLights;				// 至少落入一个簇的光源数目
+		UINT lightClusterPairs;			// 光源与簇的配对数目,即索引列表的长度
+		UINT maxLightsPerCluster;		// 单个簇中的最大光源数目
+	};
+
+	// 簇的索引为 (z * clusterCountY + y) * clusterCountX + x
+	// x从屏幕左侧开始,y从屏幕顶部开始,z从近平面开始
+	explicit ClusteredLightCulling(UINT clusterCountX = 16, UINT clusterCountY = 9, UINT clusterCountZ = 24);
+
+	// 从透视投影矩阵(XMMatrixPerspectiveFovLH)重新计算所有簇在观察空间中的包围盒
+	// 只在投影矩阵变化时调用
+	void XM_CALLCONV SetProjection(DirectX::FXMMATRIX proj);
+
+	// 将光源分配到簇中
+	const std::vector<Cluster>& XM_CALLCONV Cull(DirectX::FXMMATRIX view,
+		const PointLight* pointLights, UINT pointLightCount,
+		const SpotLight* spotLights, UINT spotLightCount);
+
+	UINT GetClusterCountX() const;
+	UINT GetClusterCountY() const;
+	UINT GetClusterCountZ() const;
+	UINT GetClusterCount() const;
+	UINT GetClusterIndex(UINT x, UINT y, UINT z) const;
+	// 观察空间深度所在的簇层,超出[near, far]时截断
+	UINT GetSlice(float viewZ) const;
+
+	const std::vector<Cluster>& GetClusters() const;
+	const std::vector<UINT>& GetLightIndices() const;
+	const Statistics& GetStatistics() const;
+
+private:
+	struct LightClusterPair
+	{
+		UINT cluster;
+		UINT light;
+	};
+
+	// 以包围球(及可选的聚光灯半空间)测试给定范围内的簇,返回是否落入了至少一个簇
+	bool XM_CALLCONV AssignLight(DirectX::FXMVECTOR center, DirectX::FXMVECTOR direction, float radius, bool isSpot,
+		UINT light, std::vector<LightClusterPair>& pairs, std::vector<UINT>& counts);
+
+	UINT m_clusterCountX;
+	UINT m_clusterCountY;
+	UINT m_clusterCountZ;
+	UINT m_rowStride;				// 包围盒数组每行的长度,补齐到4的倍数
+
+	float m_xScale;					// 投影矩阵的_11
+	float m_yScale;					// 投影矩阵的_22
+	float m_nearZ;
+	float m_farZ;
+	float m_sliceScale;				// clusterCountZ / log(far / near)
+
+	// 观察空间中各簇的AABB(SoA),补齐的元素为空包围盒
+	std::vector<float> m_minX, m_minY, m_minZ;
+	std::vector<float> m_maxX, m_maxY, m_maxZ;
+
+	std::vector<LightClusterPair> m_pointPairs;
+	std::vector<LightClusterPair> m_spotPairs;
+	std::vector<UINT> m_pointCounts;
+	std::vector<UINT> m_spotCounts;
+
+	std::vector<Cluster> m_clusters;
+	std::vector<UINT> m_lightIndices;
+	Statistics m_statistics;
+};
+
+#endif
@@ -2,19 +2,6 @@
 
 using namespace DirectX;
 
-Ray::Ray(const XMFLOAT3 origin, FXMVECTOR direction)
-	:
-	origin(origin),
-	direction()
-{
-	// 射线的direction长度必须为1.0f，误差在1e-5f内
-	const XMVECTOR error = XMVectorAbs(XMVector3Length(direction) - XMVectorSplatOne());
-
-	assert(XMVector3Less(error, XMVectorReplicate(1e-5f)));
-
-	XMStoreFloat3(&this->direction, XMVector3Normalize(direction));
-}
-
 /*
 	一个3D对象的顶点原本是位于局部坐标系的，
 	然后经历了世界变换、观察变换、投影变换后，
@@ -89,43 +76,6 @@ Ray Ray::ScreenToRay(const Camera& camera, const float screenX, const float scre
 	return { camera.GetPositionFloat3(), XMVector3Normalize(target - camera.GetPositionVector()) };
 }
 
-bool Ray::Hit(const BoundingBox& box, float* pOutDist, const float maxDist) const
-{
-
-	float dist;
-	const bool res = box.Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), dist);
-	if (pOutDist)
-		*pOutDist = dist;
-	return dist > maxDist ? false : res;
-}
-
-bool Ray::Hit(const BoundingOrientedBox& box, float* pOutDist, const float maxDist) const
-{
-	float dist;
-	const bool res = box.Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), dist);
-	if (pOutDist)
-		*pOutDist = dist;
-	return dist > maxDist ? false : res;
-}
-
-bool Ray::Hit(const BoundingSphere& sphere, float* pOutDist, const float maxDist) const
-{
-	float dist;
-	const bool res = sphere.Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), dist);
-	if (pOutDist)
-		*pOutDist = dist;
-	return dist > maxDist ? false : res;
-}
-
-bool XM_CALLCONV Ray::Hit(FXMVECTOR vertex0, FXMVECTOR vertex1, FXMVECTOR vertex2, float* pOutDist, const float maxDist) const
-{
-	float dist;
-	const bool res = TriangleTests::Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), vertex0, vertex1, vertex2, dist);
-	if (pOutDist)
-		*pOutDist = dist;
-	return dist > maxDist ? false : res;
-}
-
 Collision::WireFrameData Collision::CreateBoundingBox(const BoundingBox& box, const XMFLOAT4& color)
 {
 	XMFLOAT3 corners[8];
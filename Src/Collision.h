@@ -15,22 +15,7 @@
 #include <vector>
 #include "Vertex.h"
 #include "Camera.h"
-
-struct Ray
-{
-	Ray(DirectX::XMFLOAT3 origin, DirectX::FXMVECTOR direction);
-
-	static Ray ScreenToRay(const Camera& camera, float screenX, float screenY);
-
-	bool Hit(const DirectX::BoundingBox& box, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
-	bool Hit(const DirectX::BoundingOrientedBox& box, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
-	bool Hit(const DirectX::BoundingSphere& sphere, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
-	// 三角形检测
-	bool XM_CALLCONV Hit(DirectX::FXMVECTOR vertex0, DirectX::FXMVECTOR vertex1, DirectX::FXMVECTOR vertex2, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
-
-	DirectX::XMFLOAT3 origin;		// 射线原点
-	DirectX::XMFLOAT3 direction;	// 单位方向向量
-};
+#include "Ray.h"
 
 class Collision
 {
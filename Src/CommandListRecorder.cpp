@@ -0,0 +1,133 @@
+#include "CommandListRecorder.h"
+#include "EffectHelper.h"
+#include "RecordingThreadCheck.h"
+#include "d3dUtil.h"
+#include "DXTrace.h"
+
+#include <cassert>
+#include <future>
+
+CommandListRecorder::~CommandListRecorder()
+{
+	ReleaseContexts();
+}
+
+CommandListRecorder& CommandListRecorder::operator=(CommandListRecorder&& other) noexcept
+{
+	if (this != &other)
+	{
+		ReleaseContexts();
+		m_deferredContexts = std::move(other.m_deferredContexts);
+		m_commandLists = std::move(other.m_commandLists);
+	}
+	return *this;
+}
+
+bool CommandListRecorder::IsDriverCommandListSupported(ID3D11Device* device)
+{
+	D3D11_FEATURE_DATA_THREADING threading{};
+	if (FAILED(device->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading))))
+		return false;
+	return threading.DriverCommandLists != FALSE;
+}
+
+HRESULT CommandListRecorder::InitResource(ID3D11Device* device, const UINT count)
+{
+	ReleaseContexts();
+
+	m_deferredContexts.resize(count);
+	m_commandLists.resize(count);
+	for (auto& deferredContext : m_deferredContexts)
+	{
+		const HRESULT hr = device->CreateDeferredContext(0, deferredContext.GetAddressOf());
+		if (FAILED(hr))
+		{
+			ReleaseContexts();
+			return hr;
+		}
+	}
+
+	return S_OK;
+}
+
+UINT CommandListRecorder::GetContextCount() const
+{
+	return static_cast<UINT>(m_deferredContexts.size());
+}
+
+void CommandListRecorder::Record(const std::vector<RecordFunction>& records)
+{
+	assert(records.size() <= m_deferredContexts.size());
+
+	const auto record = [this, &records](const size_t index)
+	{
+		ID3D11DeviceContext* deferredContext = m_deferredContexts[index].Get();
+		// 上一个命令列表结束时延迟上下文的状态已被清空
+		EffectStateCache::BeginCommandList(deferredContext);
+		records[index](deferredContext);
+		HR(deferredContext->FinishCommandList(FALSE, m_commandLists[index].ReleaseAndGetAddressOf()));
+	};
+
+	// 检查同一个特效是否被多个任务使用,录制前后的使用不受限制
+	// 录制结束时(包括任务抛出异常时)推进录制编号,guard在等待所有工作线程之后析构
+	RecordingThreadCheck::AdvanceEpoch();
+	struct EpochGuard
+	{
+		~EpochGuard() { RecordingThreadCheck::AdvanceEpoch(); }
+	} epochGuard;
+
+	std::vector<std::future<void>> jobs;
+	jobs.reserve(records.size());
+	for (size_t i = 1; i < records.size(); ++i)
+	{
+		jobs.push_back(std::async(std::launch::async, record, i));
+	}
+
+	if (!records.empty())
+		record(0);
+
+	// 等待所有工作线程,录制过程中的异常在这里重新抛出
+	for (auto& job : jobs)
+	{
+		job.get();
+	}
+}
+
+void CommandListRecorder::Execute(ID3D11DeviceContext* immediateContext)
+{
+	for (auto& commandList : m_commandLists)
+	{
+		if (commandList)
+		{
+			immediateContext->ExecuteCommandList(commandList.Get(), FALSE);
+			commandList.Reset();
+		}
+	}
+
+	// 不保留状态的ExecuteCommandList会清空立即上下文的状态
+	EffectStateCache::Invalidate(immediateContext);
+}
+
+void CommandListRecorder::ReleaseContexts()
+{
+	for (auto& deferredContext : m_deferredContexts)
+	{
+		if (deferredContext)
+			EffectStateCache::Release(deferredContext.Get());
+	}
+
+	m_deferredContexts.clear();
+	m_commandLists.clear();
+}
+
+void CommandListRecorder::SetDebugObjectName(const std::string& name)
+{
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+	for (size_t i = 0; i < m_deferredContexts.size(); ++i)
+	{
+		D3D11SetDebugObjectName(m_deferredContexts[i].Get(), name + ".DeferredContext[" + std::to_string(i) + "]");
+	}
+#else
+	UNREFERENCED_PARAMETER(name);
+#endif
+}
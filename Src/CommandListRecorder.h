@@ -0,0 +1,65 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 多线程命令列表录制
+// 每个录制任务拥有一个延迟上下文,除第一个任务在调用线程上录制外,其余任务交给工作线程并行录制
+// 全部录制完成后按任务顺序在立即上下文上执行命令列表,GPU看到的命令顺序与单线程绘制一致
+// 延迟上下文不继承立即上下文的任何状态,每个任务需要自己设置渲染目标、视口等状态
+// 命令列表执行后立即上下文的状态被清空,之后的绘制需要重新设置
+// Records D3D11 command lists on deferred contexts in parallel and executes them in order.
+//***************************************************************************************
+
+#ifndef COMMANDLISTRECORDER_H
+#define COMMANDLISTRECORDER_H
+
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+class CommandListRecorder
+{
+public:
+	template<typename T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	// 在给定的设备上下文上录制一个Pass
+	using RecordFunction = std::function<void(ID3D11DeviceContext*)>;
+
+	CommandListRecorder() = default;
+	// 释放延迟上下文在特效状态缓存中的状态
+	~CommandListRecorder();
+
+	// 不允许拷贝，允许移动
+	CommandListRecorder(const CommandListRecorder&) = delete;
+	CommandListRecorder& operator=(const CommandListRecorder&) = delete;
+	CommandListRecorder(CommandListRecorder&&) = default;
+	CommandListRecorder& operator=(CommandListRecorder&& other) noexcept;
+
+	// 驱动是否原生支持命令列表,不支持时由运行时模拟,结果正确但不一定能减少主线程的开销
+	static bool IsDriverCommandListSupported(ID3D11Device* device);
+
+	// 创建count个延迟上下文,即同时录制的任务数目上限
+	HRESULT InitResource(ID3D11Device* device, UINT count);
+
+	UINT GetContextCount() const;
+
+	// 第i个任务在第i个延迟上下文上录制,返回时所有任务都已录制完成
+	// 不同的任务不能使用同一个特效对象或修改同一个游戏对象,EffectPass::Apply检查前者,违反时抛出异常
+	void Record(const std::vector<RecordFunction>& records);
+	// 按任务顺序执行已录制的命令列表,执行后立即上下文的状态被清空
+	void Execute(ID3D11DeviceContext* immediateContext);
+
+	// 设置调试对象名
+	void SetDebugObjectName(const std::string& name);
+
+private:
+	// 从特效状态缓存中移除所有延迟上下文并释放它们
+	void ReleaseContexts();
+
+	std::vector<ComPtr<ID3D11DeviceContext>> m_deferredContexts;
+	std::vector<ComPtr<ID3D11CommandList>> m_commandLists;		// 与延迟上下文一一对应,执行后释放
+};
+
+#endif
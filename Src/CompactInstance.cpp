@@ -0,0 +1,55 @@
+#include "CompactInstance.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// 由前三列还原世界矩阵,第四列为(0, 0, 0, 1)
+	XMMATRIX LoadWorldMatrix(const CompactInstancedData& data)
+	{
+		const XMMATRIX columns(
+			XMLoadFloat4(&data.worldColumns[0]),
+			XMLoadFloat4(&data.worldColumns[1]),
+			XMLoadFloat4(&data.worldColumns[2]),
+			g_XMIdentityR3);
+		return XMMatrixTranspose(columns);
+	}
+}
+
+CompactInstancedData XM_CALLCONV CreateCompactInstancedData(FXMMATRIX world)
+{
+	// 转置后的前三行即为世界矩阵的前三列
+	const XMMATRIX worldTranspose = XMMatrixTranspose(world);
+	CompactInstancedData data;
+	XMStoreFloat4(&data.worldColumns[0], worldTranspose.r[0]);
+	XMStoreFloat4(&data.worldColumns[1], worldTranspose.r[1]);
+	XMStoreFloat4(&data.worldColumns[2], worldTranspose.r[2]);
+	return data;
+}
+
+XMVECTOR XM_CALLCONV TransformPointAffine(FXMVECTOR position, const CompactInstancedData& data)
+{
+	const XMVECTOR point = XMVectorSelect(g_XMOne, position, g_XMSelect1110);
+	return XMVectorSet(
+		XMVectorGetX(XMVector4Dot(point, XMLoadFloat4(&data.worldColumns[0]))),
+		XMVectorGetX(XMVector4Dot(point, XMLoadFloat4(&data.worldColumns[1]))),
+		XMVectorGetX(XMVector4Dot(point, XMLoadFloat4(&data.worldColumns[2]))),
+		1.0f);
+}
+
+XMVECTOR XM_CALLCONV TransformNormalAffine(FXMVECTOR normal, const CompactInstancedData& data)
+{
+	// 左上角3x3矩阵的逆转置与它的余子式矩阵只差一个1/det的缩放,
+	// 只保留det的符号(镜像变换时翻转法线),对于均匀缩放与非均匀缩放都成立
+	const XMMATRIX world = LoadWorldMatrix(data);
+	const XMVECTOR cofactor0 = XMVector3Cross(world.r[1], world.r[2]);
+	const XMVECTOR cofactor1 = XMVector3Cross(world.r[2], world.r[0]);
+	const XMVECTOR cofactor2 = XMVector3Cross(world.r[0], world.r[1]);
+
+	XMVECTOR result = XMVectorMultiply(XMVectorSplatX(normal), cofactor0);
+	result = XMVectorMultiplyAdd(XMVectorSplatY(normal), cofactor1, result);
+	result = XMVectorMultiplyAdd(XMVectorSplatZ(normal), cofactor2, result);
+
+	const float determinant = XMVectorGetX(XMVector3Dot(world.r[0], cofactor0));
+	return XMVectorScale(XMVectorSelect(g_XMZero, result, g_XMSelect1110), determinant < 0.0f ? -1.0f : 1.0f);
+}
@@ -0,0 +1,28 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 紧凑的实例数据: 只保存世界矩阵的前三列(第四列恒为(0, 0, 0, 1))
+// 法线变换在着色器中以余子式矩阵计算,不需要在CPU端求逆转置矩阵
+// 这里的变换函数与Basic.hlsli中的同名函数一一对应,供CPU端使用与验证
+// Compact 3x4 instance data and CPU mirrors of the shader-side affine transforms.
+//***************************************************************************************
+
+#ifndef COMPACTINSTANCE_H
+#define COMPACTINSTANCE_H
+
+#include <DirectXMath.h>
+
+struct CompactInstancedData
+{
+	DirectX::XMFLOAT4 worldColumns[3];
+};
+
+// 由世界矩阵计算紧凑的实例数据,世界矩阵的第四列需要为(0, 0, 0, 1)
+CompactInstancedData XM_CALLCONV CreateCompactInstancedData(DirectX::FXMMATRIX world);
+
+// 以世界矩阵的前三列变换点
+DirectX::XMVECTOR XM_CALLCONV TransformPointAffine(DirectX::FXMVECTOR position, const CompactInstancedData& data);
+// 变换法线: 与逆转置矩阵的结果只差一个正的缩放,使用前需要规范化
+DirectX::XMVECTOR XM_CALLCONV TransformNormalAffine(DirectX::FXMVECTOR normal, const CompactInstancedData& data);
+
+#endif
@@ -0,0 +1,66 @@
+#include "ConstantBufferAllocator.h"
+
+ConstantBufferAllocator::ConstantBufferAllocator(const UINT byteWidth)
+	:
+	m_byteWidth(byteWidth / ChunkByteWidth * ChunkByteWidth),
+	m_head(0),
+	m_generation(0),
+	m_isFresh(true)
+{
+}
+
+UINT ConstantBufferAllocator::GetAlignedByteWidth(const UINT byteWidth)
+{
+	return (byteWidth + ChunkByteWidth - 1) / ChunkByteWidth * ChunkByteWidth;
+}
+
+bool ConstantBufferAllocator::Allocate(const UINT byteWidth, Allocation* pAllocation)
+{
+	// 池的大小已经对齐,先比较未对齐的大小,避免对齐时溢出
+	if (byteWidth > m_byteWidth)
+		return false;
+
+	const UINT alignedByteWidth = GetAlignedByteWidth(byteWidth);
+
+	Allocation allocation{ m_head / ConstantByteWidth, alignedByteWidth / ConstantByteWidth, RenderMapType::WriteNoOverwrite };
+
+	if (m_isFresh)
+	{
+		// 第一次写入,缓冲区内容未定义
+		allocation.mapType = RenderMapType::WriteDiscard;
+		m_isFresh = false;
+	}
+	else if (alignedByteWidth > m_byteWidth - m_head)
+	{
+		// 空间不足: 丢弃整个缓冲区并从头开始,已经提交的绘制仍读取旧的数据
+		allocation.firstConstant = 0;
+		allocation.mapType = RenderMapType::WriteDiscard;
+		++m_generation;
+	}
+
+	m_head = allocation.firstConstant * ConstantByteWidth + alignedByteWidth;
+	*pAllocation = allocation;
+	return true;
+}
+
+void ConstantBufferAllocator::Reset()
+{
+	m_head = 0;
+	m_isFresh = true;
+	++m_generation;
+}
+
+UINT ConstantBufferAllocator::GetByteWidth() const
+{
+	return m_byteWidth;
+}
+
+UINT ConstantBufferAllocator::GetHead() const
+{
+	return m_head;
+}
+
+UINT ConstantBufferAllocator::GetGeneration() const
+{
+	return m_generation;
+}
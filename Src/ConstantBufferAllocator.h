@@ -0,0 +1,55 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 常量缓冲区池的分配逻辑,不涉及D3D资源
+// 以256字节(16个常量)为单位线性分配,每次分配追加到已分配数据的后面(WriteNoOverwrite),
+// 第一次分配或空间不足时丢弃整个缓冲区并从头开始(WriteDiscard)
+// 回绕后之前分配的位置对之后的绘制不再有效,使用者需要根据GetGeneration判断是否重新写入
+// Sub-allocation bookkeeping for the constant-buffer arena.
+//***************************************************************************************
+
+#ifndef CONSTANTBUFFERALLOCATOR_H
+#define CONSTANTBUFFERALLOCATOR_H
+
+#include "PortableTypes.h"
+#include "RenderBackend.h"
+
+class ConstantBufferAllocator
+{
+public:
+	// 偏移绑定要求起始位置与大小都是16个常量(256字节)的倍数
+	static constexpr UINT ChunkByteWidth = 256;
+	static constexpr UINT ConstantByteWidth = 16;
+
+	struct Allocation
+	{
+		UINT firstConstant;		// 起始常量
+		UINT numConstants;		// 常量数目
+		RenderMapType mapType;	// 映射方式
+	};
+
+	// byteWidth为池的总字节数,向下对齐到ChunkByteWidth
+	explicit ConstantBufferAllocator(UINT byteWidth = 0);
+
+	// byteWidth向上对齐到ChunkByteWidth后占用的字节数
+	static UINT GetAlignedByteWidth(UINT byteWidth);
+
+	// 分配byteWidth字节,对齐后超过池的大小时返回false且不改变任何状态
+	bool Allocate(UINT byteWidth, Allocation* pAllocation);
+	// 之前分配的位置全部失效,下一次分配从头开始并丢弃原有数据
+	void Reset();
+
+	UINT GetByteWidth() const;
+	// 当前回绕以来已经分配的字节数
+	UINT GetHead() const;
+	// 回绕与Reset的次数,变化后之前分配的位置全部失效
+	UINT GetGeneration() const;
+
+private:
+	UINT m_byteWidth;
+	UINT m_head;
+	UINT m_generation;
+	bool m_isFresh;
+};
+
+#endif
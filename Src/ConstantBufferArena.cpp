@@ -0,0 +1,75 @@
+#include "ConstantBufferArena.h"
+#include "RenderBackendD3D11.h"
+#include "d3dUtil.h"
+#include "DXTrace.h"
+
+#include <cstring>
+
+ConstantBufferArena::ConstantBufferArena(const UINT byteWidth)
+	:
+	m_allocator(byteWidth)
+{
+}
+
+bool ConstantBufferArena::IsSupported(ID3D11Device* device)
+{
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	if (FAILED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+		return false;
+	return options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+}
+
+HRESULT ConstantBufferArena::InitResource(ID3D11Device* device)
+{
+	D3D11_BUFFER_DESC cbd;
+	ZeroMemory(&cbd, sizeof(cbd));
+	cbd.Usage = D3D11_USAGE_DYNAMIC;
+	cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	cbd.ByteWidth = m_allocator.GetByteWidth();
+	return device->CreateBuffer(&cbd, nullptr, m_pBuffer.ReleaseAndGetAddressOf());
+}
+
+ID3D11Buffer* ConstantBufferArena::Upload(ID3D11DeviceContext* deviceContext, const void* data, const UINT byteWidth, UINT* pFirstConstant, UINT* pNumConstants)
+{
+	ConstantBufferAllocator::Allocation allocation;
+	if (!m_allocator.Allocate(byteWidth, &allocation))
+		return nullptr;
+
+	D3D11_MAPPED_SUBRESOURCE mappedData;
+	HR(deviceContext->Map(m_pBuffer.Get(), 0, ToD3D11Map(allocation.mapType), 0, &mappedData));
+	memcpy_s(static_cast<BYTE*>(mappedData.pData) + static_cast<size_t>(allocation.firstConstant) * ConstantBufferAllocator::ConstantByteWidth,
+		byteWidth, data, byteWidth);
+	deviceContext->Unmap(m_pBuffer.Get(), 0);
+
+	*pFirstConstant = allocation.firstConstant;
+	*pNumConstants = allocation.numConstants;
+	return m_pBuffer.Get();
+}
+
+void ConstantBufferArena::Reset()
+{
+	m_allocator.Reset();
+}
+
+ID3D11Buffer* ConstantBufferArena::GetBuffer() const
+{
+	return m_pBuffer.Get();
+}
+
+UINT ConstantBufferArena::GetGeneration() const
+{
+	return m_allocator.GetGeneration();
+}
+
+void ConstantBufferArena::SetDebugObjectName(const std::string& name)
+{
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+	if (m_pBuffer)
+	{
+		D3D11SetDebugObjectName(m_pBuffer.Get(), name + ".ConstantBufferArena");
+	}
+#else
+	UNREFERENCED_PARAMETER(name);
+#endif
+}
@@ -0,0 +1,54 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 常量缓冲区池
+// 一个较大的动态常量缓冲区,分配逻辑见ConstantBufferAllocator
+// 按分配结果以WRITE_NO_OVERWRITE或WRITE_DISCARD映射并写入,
+// 绑定时通过D3D11.1的XXSetConstantBuffers1指定起始常量与常量数目
+// Constant-buffer arena sub-allocated in 256-byte chunks and bound with SetConstantBuffers1 offsets.
+//***************************************************************************************
+
+#ifndef CONSTANTBUFFERARENA_H
+#define CONSTANTBUFFERARENA_H
+
+#include "ConstantBufferAllocator.h"
+
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <string>
+
+class ConstantBufferArena
+{
+public:
+	template<typename T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	static constexpr UINT DefaultByteWidth = 1024 * 1024;
+
+	explicit ConstantBufferArena(UINT byteWidth = DefaultByteWidth);
+
+	// 设备需要支持常量缓冲区的偏移绑定以及WRITE_NO_OVERWRITE映射
+	static bool IsSupported(ID3D11Device* device);
+
+	// 创建常量缓冲区
+	HRESULT InitResource(ID3D11Device* device);
+
+	// 分配并写入byteWidth字节,返回池的缓冲区以及用于XXSetConstantBuffers1的起始常量与常量数目
+	// byteWidth超过池的大小时返回nullptr
+	ID3D11Buffer* Upload(ID3D11DeviceContext* deviceContext, const void* data, UINT byteWidth, UINT* pFirstConstant, UINT* pNumConstants);
+	// 延迟上下文录制新的命令列表前调用,之前写入的数据对之后的绘制不再有效
+	void Reset();
+
+	ID3D11Buffer* GetBuffer() const;
+	UINT GetGeneration() const;
+
+	// 设置调试对象名
+	void SetDebugObjectName(const std::string& name);
+
+private:
+	ConstantBufferAllocator m_allocator;
+
+	ComPtr<ID3D11Buffer> m_pBuffer;
+};
+
+#endif
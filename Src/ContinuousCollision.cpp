@@ -0,0 +1,518 @@
+#include "ContinuousCollision.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// 线段o + t * d (t∈[0, maxT])进入AABB的时间
+	// pOutAxis为最后进入的轴,起点位于AABB内时为-1
+	bool SlabEnter(const XMFLOAT3& origin, const XMFLOAT3& delta, const XMFLOAT3& boxMin, const XMFLOAT3& boxMax,
+		const float maxT, float* pOutEnter, int* pOutAxis)
+	{
+		const float o[3] = { origin.x, origin.y, origin.z };
+		const float d[3] = { delta.x, delta.y, delta.z };
+		const float lo[3] = { boxMin.x, boxMin.y, boxMin.z };
+		const float hi[3] = { boxMax.x, boxMax.y, boxMax.z };
+
+		float tMin = 0.0f;
+		float tMax = maxT;
+		int axis = -1;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (std::fabs(d[i]) < 1e-12f)
+			{
+				// 与该轴的两个平面平行
+				if (o[i] < lo[i] || o[i] > hi[i])
+					return false;
+				continue;
+			}
+
+			const float inv = 1.0f / d[i];
+			float t1 = (lo[i] - o[i]) * inv;
+			float t2 = (hi[i] - o[i]) * inv;
+			if (t1 > t2)
+				std::swap(t1, t2);
+
+			if (t1 > tMin)
+			{
+				tMin = t1;
+				axis = i;
+			}
+			tMax = (std::min)(tMax, t2);
+			if (tMin > tMax)
+				return false;
+		}
+
+		*pOutEnter = tMin;
+		*pOutAxis = axis;
+		return true;
+	}
+
+	// 线段o + t * d与球体的首个交点,起点在球内时为0
+	bool XM_CALLCONV SegmentSphere(FXMVECTOR origin, FXMVECTOR delta, FXMVECTOR center, const float radius, const float maxT, float* pOutT)
+	{
+		const XMVECTOR m = origin - center;
+		const float b = XMVectorGetX(XMVector3Dot(m, delta));
+		const float c = XMVectorGetX(XMVector3LengthSq(m)) - radius * radius;
+		if (c <= 0.0f)
+		{
+			*pOutT = 0.0f;
+			return true;
+		}
+		// 在球外且远离球心
+		if (b > 0.0f)
+			return false;
+
+		const float a = XMVectorGetX(XMVector3LengthSq(delta));
+		const float discriminant = b * b - a * c;
+		if (discriminant < 0.0f || a <= 0.0f)
+			return false;
+
+		const float t = (-b - std::sqrt(discriminant)) / a;
+		if (t > maxT)
+			return false;
+		*pOutT = (std::max)(t, 0.0f);
+		return true;
+	}
+
+	// 线段与以p、q为端点的胶囊体的首个交点
+	bool XM_CALLCONV SegmentCapsule(FXMVECTOR origin, FXMVECTOR delta, FXMVECTOR p, GXMVECTOR q, const float radius, const float maxT, float* pOutT)
+	{
+		float best = maxT;
+		bool isHit = false;
+		float t;
+
+		// 圆柱侧面: 去掉沿轴方向的分量后解二次方程
+		const XMVECTOR axis = q - p;
+		const float axisLengthSq = XMVectorGetX(XMVector3LengthSq(axis));
+		if (axisLengthSq > 0.0f)
+		{
+			const XMVECTOR offset = origin - p;
+			const float axisDotDelta = XMVectorGetX(XMVector3Dot(axis, delta));
+			const float axisDotOffset = XMVectorGetX(XMVector3Dot(axis, offset));
+			const XMVECTOR deltaPerp = delta - axis * (axisDotDelta / axisLengthSq);
+			const XMVECTOR offsetPerp = offset - axis * (axisDotOffset / axisLengthSq);
+
+			const float a = XMVectorGetX(XMVector3LengthSq(deltaPerp));
+			const float b = XMVectorGetX(XMVector3Dot(offsetPerp, deltaPerp));
+			const float c = XMVectorGetX(XMVector3LengthSq(offsetPerp)) - radius * radius;
+
+			float tCylinder = -1.0f;
+			if (c <= 0.0f)
+			{
+				tCylinder = 0.0f;
+			}
+			else if (a > 0.0f && b < 0.0f)
+			{
+				const float discriminant = b * b - a * c;
+				if (discriminant >= 0.0f)
+					tCylinder = (-b - std::sqrt(discriminant)) / a;
+			}
+
+			if (tCylinder >= 0.0f && tCylinder <= best)
+			{
+				// 交点需要位于两个端点之间
+				const float s = (axisDotOffset + tCylinder * axisDotDelta) / axisLengthSq;
+				if (s >= 0.0f && s <= 1.0f)
+				{
+					best = tCylinder;
+					isHit = true;
+				}
+			}
+		}
+
+		// 两端的半球
+		if (SegmentSphere(origin, delta, p, radius, best, &t))
+		{
+			best = t;
+			isHit = true;
+		}
+		if (SegmentSphere(origin, delta, q, radius, best, &t))
+		{
+			best = t;
+			isHit = true;
+		}
+
+		*pOutT = best;
+		return isHit;
+	}
+
+	XMVECTOR XM_CALLCONV GetBoxCorner(FXMVECTOR boxMin, FXMVECTOR boxMax, const UINT corner)
+	{
+		// 第i位为1时在第i个轴上取最大值
+		const XMVECTOR select = XMVectorSelectControl(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1, 0);
+		return XMVectorSelect(boxMin, boxMax, select);
+	}
+
+	// 计算OBB与AABB在15条分离轴上的最大间隙,它不超过两者的真实距离,且仅在相交时不大于0
+	// pOutNormal为取得最大间隙的轴,由AABB指向OBB
+	float SeparationGap(const BoundingOrientedBox& obb, const BoundingBox& box, XMFLOAT3* pOutNormal)
+	{
+		const XMMATRIX rotation = XMMatrixRotationQuaternion(XMLoadFloat4(&obb.Orientation));
+		const XMVECTOR axesA[3] = { rotation.r[0], rotation.r[1], rotation.r[2] };
+		const XMVECTOR axesB[3] = { g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2 };
+		const float extentsA[3] = { obb.Extents.x, obb.Extents.y, obb.Extents.z };
+		const float extentsB[3] = { box.Extents.x, box.Extents.y, box.Extents.z };
+		const XMVECTOR translation = XMLoadFloat3(&obb.Center) - XMLoadFloat3(&box.Center);
+
+		float maxGap = -FLT_MAX;
+		XMVECTOR bestAxis = g_XMIdentityR1;
+
+		auto testAxis = [&](const XMVECTOR& candidate)
+		{
+			const float lengthSq = XMVectorGetX(XMVector3LengthSq(candidate));
+			// 平行的边产生的叉积忽略
+			if (lengthSq < 1e-8f)
+				return;
+
+			const XMVECTOR axis = candidate / std::sqrt(lengthSq);
+			float radius = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				radius += extentsA[i] * std::fabs(XMVectorGetX(XMVector3Dot(axesA[i], axis)));
+				radius += extentsB[i] * std::fabs(XMVectorGetX(XMVector3Dot(axesB[i], axis)));
+			}
+
+			const float distance = XMVectorGetX(XMVector3Dot(translation, axis));
+			const float gap = std::fabs(distance) - radius;
+			if (gap > maxGap)
+			{
+				maxGap = gap;
+				bestAxis = distance < 0.0f ? -axis : axis;
+			}
+		};
+
+		for (int i = 0; i < 3; ++i)
+		{
+			testAxis(axesA[i]);
+			testAxis(axesB[i]);
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+				testAxis(XMVector3Cross(axesA[i], axesB[j]));
+		}
+
+		if (pOutNormal)
+			XMStoreFloat3(pOutNormal, bestAxis);
+		return maxGap;
+	}
+
+	// 在BVH上沿线段遍历,节点包围盒按inflate膨胀
+	// test(图元索引, 当前最近TOI, 输出TOI, 输出法线)
+	template <typename NarrowTest>
+	bool TraverseSegment(const BoundingVolumeHierarchy& hierarchy, const XMFLOAT3& origin, const XMFLOAT3& delta,
+		const XMFLOAT3& inflate, NarrowTest&& test, SweepHit* pOutHit)
+	{
+		SweepHit hit{ 1.0f, SweepHit::InvalidIndex, XMFLOAT3() };
+
+		const auto& nodes = hierarchy.GetNodes();
+		if (!nodes.empty())
+		{
+			const auto& primitiveIndices = hierarchy.GetPrimitiveIndices();
+
+			BoundingVolumeHierarchy::TraversalStack stack(hierarchy.GetDepth());
+			stack.Push(0);
+
+			while (!stack.Empty())
+			{
+				const BoundingVolumeHierarchy::Node& node = nodes[stack.Pop()];
+
+				const XMFLOAT3 boxMin(node.boxMin.x - inflate.x, node.boxMin.y - inflate.y, node.boxMin.z - inflate.z);
+				const XMFLOAT3 boxMax(node.boxMax.x + inflate.x, node.boxMax.y + inflate.y, node.boxMax.z + inflate.z);
+				float tEnter;
+				int axis;
+				if (!SlabEnter(origin, delta, boxMin, boxMax, hit.toi, &tEnter, &axis))
+					continue;
+
+				if (node.IsLeaf())
+				{
+					for (UINT i = 0; i < node.count; ++i)
+					{
+						const UINT primitive = primitiveIndices[node.leftOrFirst + i];
+						float toi;
+						XMFLOAT3 normal;
+						if (test(primitive, hit.toi, &toi, &normal) && (hit.index == SweepHit::InvalidIndex || toi < hit.toi))
+						{
+							hit.toi = toi;
+							hit.index = primitive;
+							hit.normal = normal;
+						}
+					}
+				}
+				else
+				{
+					stack.Push(node.leftOrFirst + 1);
+					stack.Push(node.leftOrFirst);
+				}
+			}
+		}
+
+		if (pOutHit)
+			*pOutHit = hit;
+		return hit.index != SweepHit::InvalidIndex;
+	}
+}
+
+void ContinuousCollision::Build(const std::vector<BoundingBox>& boxes)
+{
+	m_hierarchy.Build(boxes);
+}
+
+void ContinuousCollision::Clear()
+{
+	m_hierarchy.Clear();
+}
+
+const BoundingVolumeHierarchy& ContinuousCollision::GetHierarchy() const
+{
+	return m_hierarchy;
+}
+
+bool ContinuousCollision::SweepSphere(FXMVECTOR start, FXMVECTOR end, const float radius, SweepHit* pOutHit) const
+{
+	const XMVECTOR displacement = end - start;
+	XMFLOAT3 origin{}, delta{};
+	XMStoreFloat3(&origin, start);
+	XMStoreFloat3(&delta, displacement);
+
+	const auto& boxes = m_hierarchy.GetPrimitiveBoxes();
+	return TraverseSegment(m_hierarchy, origin, delta, XMFLOAT3(radius, radius, radius),
+		[&](const UINT index, const float maxToi, float* pOutToi, XMFLOAT3* pOutNormal)
+		{
+			return SweepSphereBox(start, displacement, radius, boxes[index], pOutToi, pOutNormal, maxToi);
+		}, pOutHit);
+}
+
+bool ContinuousCollision::SweepBox(const BoundingBox& box, FXMVECTOR displacement, SweepHit* pOutHit) const
+{
+	XMFLOAT3 delta{};
+	XMStoreFloat3(&delta, displacement);
+
+	const auto& boxes = m_hierarchy.GetPrimitiveBoxes();
+	return TraverseSegment(m_hierarchy, box.Center, delta, box.Extents,
+		[&](const UINT index, const float maxToi, float* pOutToi, XMFLOAT3* pOutNormal)
+		{
+			return SweepBoxBox(box, displacement, boxes[index], pOutToi, pOutNormal, maxToi);
+		}, pOutHit);
+}
+
+bool ContinuousCollision::SweepOrientedBox(const BoundingOrientedBox& start, const BoundingOrientedBox& end, SweepHit* pOutHit,
+	const float tolerance, const UINT maxIterations) const
+{
+	SweepHit hit{ 1.0f, SweepHit::InvalidIndex, XMFLOAT3() };
+
+	// 旋转过程中OBB总位于以中心为球心、半对角线长为半径的球内
+	const float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&start.Extents)));
+	const XMVECTOR inflate = XMVectorReplicate(radius);
+	const XMVECTOR centerStart = XMLoadFloat3(&start.Center);
+	const XMVECTOR centerEnd = XMLoadFloat3(&end.Center);
+
+	BoundingBox sweptBox;
+	BoundingBox::CreateFromPoints(sweptBox,
+		XMVectorMin(centerStart, centerEnd) - inflate,
+		XMVectorMax(centerStart, centerEnd) + inflate);
+
+	std::vector<UINT> candidates;
+	m_hierarchy.Query(sweptBox, candidates);
+
+	const auto& boxes = m_hierarchy.GetPrimitiveBoxes();
+	for (const UINT index : candidates)
+	{
+		float toi;
+		XMFLOAT3 normal;
+		if (SweepOrientedBoxBox(start, end, boxes[index], &toi, &normal, tolerance, maxIterations, hit.toi) &&
+			(hit.index == SweepHit::InvalidIndex || toi < hit.toi))
+		{
+			hit.toi = toi;
+			hit.index = index;
+			hit.normal = normal;
+		}
+	}
+
+	if (pOutHit)
+		*pOutHit = hit;
+	return hit.index != SweepHit::InvalidIndex;
+}
+
+UINT ContinuousCollision::SweepSpheres(const SweptSphere* spheres, const UINT count, SweepHit* pOutHits) const
+{
+	UINT hitCount = 0;
+	for (UINT i = 0; i < count; ++i)
+	{
+		const SweptSphere& sphere = spheres[i];
+		if (SweepSphere(XMLoadFloat3(&sphere.start), XMLoadFloat3(&sphere.end), sphere.radius, pOutHits + i))
+			++hitCount;
+	}
+	return hitCount;
+}
+
+bool ContinuousCollision::SweepSphereBox(FXMVECTOR center, FXMVECTOR displacement, const float radius,
+	const BoundingBox& box, float* pOutToi, XMFLOAT3* pOutNormal, const float maxToi)
+{
+	const XMVECTOR boxCenter = XMLoadFloat3(&box.Center);
+	const XMVECTOR boxExtents = XMLoadFloat3(&box.Extents);
+	const XMVECTOR boxMin = boxCenter - boxExtents;
+	const XMVECTOR boxMax = boxCenter + boxExtents;
+
+	// 先与按半径膨胀后的AABB求交,再根据交点所在的Voronoi区域修正棱和顶点处的圆角
+	XMFLOAT3 origin{}, delta{}, expandedMin{}, expandedMax{};
+	XMStoreFloat3(&origin, center);
+	XMStoreFloat3(&delta, displacement);
+	XMStoreFloat3(&expandedMin, boxMin - XMVectorReplicate(radius));
+	XMStoreFloat3(&expandedMax, boxMax + XMVectorReplicate(radius));
+
+	float t;
+	int axis;
+	if (!SlabEnter(origin, delta, expandedMin, expandedMax, maxToi, &t, &axis))
+		return false;
+
+	XMFLOAT3 point{};
+	XMStoreFloat3(&point, center + displacement * t);
+	XMFLOAT3 lo{}, hi{};
+	XMStoreFloat3(&lo, boxMin);
+	XMStoreFloat3(&hi, boxMax);
+
+	UINT below = 0, above = 0;
+	if (point.x < lo.x) below |= 1;
+	if (point.x > hi.x) above |= 1;
+	if (point.y < lo.y) below |= 2;
+	if (point.y > hi.y) above |= 2;
+	if (point.z < lo.z) below |= 4;
+	if (point.z > hi.z) above |= 4;
+	const UINT region = below | above;
+
+	if (region == 7)
+	{
+		// 顶点区域: 与从该顶点出发的三条棱组成的胶囊体求交
+		float best = maxToi;
+		bool isHit = false;
+		const XMVECTOR corner = GetBoxCorner(boxMin, boxMax, above);
+		for (const UINT bit : { 1u, 2u, 4u })
+		{
+			float tCapsule;
+			if (SegmentCapsule(center, displacement, corner, GetBoxCorner(boxMin, boxMax, above ^ bit), radius, best, &tCapsule))
+			{
+				best = tCapsule;
+				isHit = true;
+			}
+		}
+		if (!isHit)
+			return false;
+		t = best;
+	}
+	else if (region & (region - 1))
+	{
+		// 棱区域
+		if (!SegmentCapsule(center, displacement, GetBoxCorner(boxMin, boxMax, below ^ 7), GetBoxCorner(boxMin, boxMax, above), radius, maxToi, &t))
+			return false;
+	}
+
+	*pOutToi = t;
+	if (pOutNormal)
+	{
+		// 碰撞时球心与AABB上最近点的连线
+		const XMVECTOR hitCenter = center + displacement * t;
+		const XMVECTOR direction = hitCenter - XMVectorClamp(hitCenter, boxMin, boxMax);
+		if (XMVector3Less(XMVector3LengthSq(direction), XMVectorReplicate(1e-12f)))
+			XMStoreFloat3(pOutNormal, XMVector3Normalize(-displacement));
+		else
+			XMStoreFloat3(pOutNormal, XMVector3Normalize(direction));
+	}
+	return true;
+}
+
+bool ContinuousCollision::SweepBoxBox(const BoundingBox& moving, FXMVECTOR displacement,
+	const BoundingBox& box, float* pOutToi, XMFLOAT3* pOutNormal, const float maxToi)
+{
+	// 两个AABB平移时,等价于运动盒中心与按其半长膨胀的静止盒求交
+	const XMFLOAT3 expandedMin(
+		box.Center.x - box.Extents.x - moving.Extents.x,
+		box.Center.y - box.Extents.y - moving.Extents.y,
+		box.Center.z - box.Extents.z - moving.Extents.z);
+	const XMFLOAT3 expandedMax(
+		box.Center.x + box.Extents.x + moving.Extents.x,
+		box.Center.y + box.Extents.y + moving.Extents.y,
+		box.Center.z + box.Extents.z + moving.Extents.z);
+	XMFLOAT3 delta{};
+	XMStoreFloat3(&delta, displacement);
+
+	float t;
+	int axis;
+	if (!SlabEnter(moving.Center, delta, expandedMin, expandedMax, maxToi, &t, &axis))
+		return false;
+
+	*pOutToi = t;
+	if (pOutNormal)
+	{
+		if (axis < 0)
+		{
+			// 起点已经相交
+			XMStoreFloat3(pOutNormal, XMVector3Normalize(-displacement));
+		}
+		else
+		{
+			// 法线与进入面相对,指向运动盒
+			const float d[3] = { delta.x, delta.y, delta.z };
+			float n[3] = { 0.0f, 0.0f, 0.0f };
+			n[axis] = d[axis] > 0.0f ? -1.0f : 1.0f;
+			*pOutNormal = XMFLOAT3(n[0], n[1], n[2]);
+		}
+	}
+	return true;
+}
+
+bool ContinuousCollision::SweepOrientedBoxBox(const BoundingOrientedBox& start, const BoundingOrientedBox& end,
+	const BoundingBox& box, float* pOutToi, XMFLOAT3* pOutNormal,
+	const float tolerance, const UINT maxIterations, const float maxToi)
+{
+	const XMVECTOR centerStart = XMLoadFloat3(&start.Center);
+	const XMVECTOR centerEnd = XMLoadFloat3(&end.Center);
+	const XMVECTOR orientationStart = XMLoadFloat4(&start.Orientation);
+	XMVECTOR orientationEnd = XMLoadFloat4(&end.Orientation);
+	// 取最短路径插值
+	const float cosine = XMVectorGetX(XMQuaternionDot(orientationStart, orientationEnd));
+	if (cosine < 0.0f)
+		orientationEnd = -orientationEnd;
+
+	// OBB上任意一点单位时间内移动距离的上界: 平移距离 + 旋转角度 * 半对角线长
+	const float angle = 2.0f * std::acos((std::min)(std::fabs(cosine), 1.0f));
+	const float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&start.Extents)));
+	const float motionBound = XMVectorGetX(XMVector3Length(centerEnd - centerStart)) + angle * radius;
+
+	BoundingOrientedBox pose = start;
+	float t = 0.0f;
+	for (UINT iteration = 0; iteration < maxIterations; ++iteration)
+	{
+		XMStoreFloat3(&pose.Center, XMVectorLerp(centerStart, centerEnd, t));
+		XMStoreFloat4(&pose.Orientation, XMQuaternionSlerp(orientationStart, orientationEnd, t));
+
+		XMFLOAT3 normal{};
+		const float gap = SeparationGap(pose, box, &normal);
+		if (gap <= tolerance)
+		{
+			*pOutToi = t;
+			if (pOutNormal)
+				*pOutNormal = normal;
+			return true;
+		}
+
+		if (motionBound <= 0.0f)
+			return false;
+
+		// 间隙不超过真实距离,前进gap / motionBound的时间不会越过接触点
+		t += gap / motionBound;
+		if (t > maxToi)
+			return false;
+	}
+
+	// 迭代次数用尽时保守地认为发生碰撞
+	*pOutToi = t;
+	if (pOutNormal)
+		SeparationGap(pose, box, pOutNormal);
+	return true;
+}
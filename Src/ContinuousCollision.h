@@ -0,0 +1,74 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 连续碰撞检测(CCD)
+// 求运动物体在一帧位移内与静态场景最早接触的时间(TOI),避免高速物体在大步长下穿透薄物体
+// 1. 扫掠球/扫掠AABB: 在闵可夫斯基和上做射线测试,得到精确的TOI
+// 2. 旋转的OBB: 使用保守推进(Conservative Advancement)
+// Continuous collision detection: swept spheres/boxes and conservative advancement for rotating OBBs.
+//***************************************************************************************
+
+#ifndef CONTINUOUSCOLLISION_H
+#define CONTINUOUSCOLLISION_H
+
+#include "BoundingVolumeHierarchy.h"
+
+// 扫掠检测的结果
+struct SweepHit
+{
+	static constexpr UINT InvalidIndex = 0xFFFFFFFF;
+
+	float toi;					// 碰撞时间,0为起点,1为终点
+	UINT index;					// 碰撞的场景图元索引,未碰撞为InvalidIndex
+	DirectX::XMFLOAT3 normal;	// 碰撞法线,由场景物体指向运动物体
+};
+
+// 从start运动到end的球体
+struct SweptSphere
+{
+	DirectX::XMFLOAT3 start;
+	float radius;
+	DirectX::XMFLOAT3 end;
+};
+
+class ContinuousCollision
+{
+public:
+	// 以静态场景物体的AABB构建BVH
+	void Build(const std::vector<DirectX::BoundingBox>& boxes);
+	void Clear();
+
+	const BoundingVolumeHierarchy& GetHierarchy() const;
+
+	//
+	// 与场景的扫掠检测,返回是否在[0, 1]内发生碰撞
+	//
+
+	bool XM_CALLCONV SweepSphere(DirectX::FXMVECTOR start, DirectX::FXMVECTOR end, float radius, SweepHit* pOutHit) const;
+	bool XM_CALLCONV SweepBox(const DirectX::BoundingBox& box, DirectX::FXMVECTOR displacement, SweepHit* pOutHit) const;
+	// 起止姿态之间中心线性插值、朝向球面插值
+	bool SweepOrientedBox(const DirectX::BoundingOrientedBox& start, const DirectX::BoundingOrientedBox& end, SweepHit* pOutHit,
+		float tolerance = 1e-3f, UINT maxIterations = 32) const;
+
+	// 批量扫掠球体,pOutHits需要容纳count个结果,返回发生碰撞的数目
+	UINT SweepSpheres(const SweptSphere* spheres, UINT count, SweepHit* pOutHits) const;
+
+	//
+	// 与单个AABB的扫掠检测,只报告TOI不超过maxToi的碰撞
+	// 起点已经相交时TOI为0
+	//
+
+	static bool XM_CALLCONV SweepSphereBox(DirectX::FXMVECTOR center, DirectX::FXMVECTOR displacement, float radius,
+		const DirectX::BoundingBox& box, float* pOutToi, DirectX::XMFLOAT3* pOutNormal = nullptr, float maxToi = 1.0f);
+	static bool XM_CALLCONV SweepBoxBox(const DirectX::BoundingBox& moving, DirectX::FXMVECTOR displacement,
+		const DirectX::BoundingBox& box, float* pOutToi, DirectX::XMFLOAT3* pOutNormal = nullptr, float maxToi = 1.0f);
+	// 达到最大迭代次数时保守地报告碰撞
+	static bool SweepOrientedBoxBox(const DirectX::BoundingOrientedBox& start, const DirectX::BoundingOrientedBox& end,
+		const DirectX::BoundingBox& box, float* pOutToi, DirectX::XMFLOAT3* pOutNormal = nullptr,
+		float tolerance = 1e-3f, UINT maxIterations = 32, float maxToi = 1.0f);
+
+private:
+	BoundingVolumeHierarchy m_hierarchy;
+};
+
+#endif
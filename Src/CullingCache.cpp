@@ -0,0 +1,178 @@
+#include "CullingCache.h"
+
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr UINT AllPlanes = 0x3F;
+
+	// 点到平面的有向距离,位于法线一侧时为正
+	float PlaneDistance(const Bounds::Float4& plane, const Bounds::Float3& point)
+	{
+		return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+	}
+}
+
+void CullingCache::Build(const BoundingBox& localBox, const std::vector<BasicTransform>& transforms)
+{
+	std::vector<Bounds::Matrix4x4> worldMatrices(transforms.size());
+	for (size_t i = 0; i < transforms.size(); ++i)
+		worldMatrices[i] = Bounds::ToMatrix4x4(transforms[i].GetLocalToWorldMatrix());
+	Build(localBox, worldMatrices);
+}
+
+void CullingCache::Build(const BoundingBox& localBox, const std::vector<XMFLOAT4X4>& worldMatrices)
+{
+	std::vector<Bounds::Matrix4x4> matrices(worldMatrices.size());
+	for (size_t i = 0; i < worldMatrices.size(); ++i)
+		matrices[i] = Bounds::ToMatrix4x4(XMLoadFloat4x4(&worldMatrices[i]));
+	Build(localBox, matrices);
+}
+
+void CullingCache::SetInstance(const UINT index, const BasicTransform& transform)
+{
+	SetInstance(index, transform.GetLocalToWorldMatrix());
+}
+
+void CullingCache::SetInstance(const UINT index, FXMMATRIX world)
+{
+	const Bounds::Matrix4x4 matrix = Bounds::ToMatrix4x4(world);
+	m_worldSpheres[index] = Bounds::Transform(m_localSphere, matrix);
+	m_worldBoxes[index] = Bounds::Transform(m_localBox, matrix);
+	m_isDirty[index] = 1;
+	m_hasDirty = true;
+}
+
+const std::vector<UINT>& CullingCache::Cull(FXMMATRIX viewProj)
+{
+	m_statistics = {};
+
+	const Bounds::Frustum frustum = Bounds::FrustumFromMatrix(Bounds::ToMatrix4x4(viewProj));
+
+	// 找出发生变化的平面
+	UINT changedMask = 0;
+	for (UINT i = 0; i < 6; ++i)
+	{
+		const Bounds::Float4& plane = frustum.planes[i];
+		Bounds::Float4& lastPlane = m_frustum.planes[i];
+		if (plane.x != lastPlane.x || plane.y != lastPlane.y || plane.z != lastPlane.z || plane.w != lastPlane.w)
+		{
+			changedMask |= 1u << i;
+		}
+		lastPlane = plane;
+	}
+
+	const UINT count = GetInstanceCount();
+
+	// 摄像机没有变化,也没有实例变化,直接沿用上一帧的结果
+	if (changedMask == 0 && !m_hasDirty)
+	{
+		m_statistics.reusedInstances = count;
+		return m_visibleIndices;
+	}
+
+	m_visibleIndices.clear();
+	for (UINT i = 0; i < count; ++i)
+	{
+		UINT8& lastPlane = m_lastPlanes[i];
+
+		if (m_isDirty[i])
+		{
+			lastPlane = TestInstance(i, AllPlanes, lastPlane == Visible ? 0 : lastPlane);
+			m_isDirty[i] = 0;
+		}
+		else if (lastPlane == Visible)
+		{
+			// 可见物体只需要重新测试发生变化的平面
+			if (changedMask != 0)
+				lastPlane = TestInstance(i, changedMask, 0);
+			else
+				++m_statistics.reusedInstances;
+		}
+		else if (changedMask & (1u << lastPlane))
+		{
+			// 上一帧拒绝它的平面发生了变化,从该平面开始测试
+			lastPlane = TestInstance(i, AllPlanes, lastPlane);
+		}
+		else
+		{
+			// 拒绝它的平面没有变化,仍然不可见
+			++m_statistics.reusedInstances;
+		}
+
+		if (lastPlane == Visible)
+			m_visibleIndices.push_back(i);
+	}
+
+	m_hasDirty = false;
+	return m_visibleIndices;
+}
+
+UINT CullingCache::GetInstanceCount() const
+{
+	return static_cast<UINT>(m_worldSpheres.size());
+}
+
+const Bounds::Sphere& CullingCache::GetWorldSphere(const UINT index) const
+{
+	return m_worldSpheres[index];
+}
+
+const Bounds::Aabb& CullingCache::GetWorldBox(const UINT index) const
+{
+	return m_worldBoxes[index];
+}
+
+const CullingCache::Statistics& CullingCache::GetStatistics() const
+{
+	return m_statistics;
+}
+
+UINT8 CullingCache::TestInstance(const UINT index, const UINT planeMask, const UINT8 firstPlane)
+{
+	const Bounds::Sphere& sphere = m_worldSpheres[index];
+	const Bounds::Aabb& box = m_worldBoxes[index];
+
+	for (UINT8 n = 0; n < 6; ++n)
+	{
+		const UINT8 plane = static_cast<UINT8>((firstPlane + n) % 6);
+		if (!(planeMask & (1u << plane)))
+			continue;
+
+		++m_statistics.planeTests;
+		const Bounds::Float4& p = m_frustum.planes[plane];
+
+		// 先用包围球快速判断
+		const float sphereDist = PlaneDistance(p, sphere.center);
+		if (sphereDist < -sphere.radius)
+			return plane;
+		if (sphereDist >= sphere.radius)
+			continue;
+
+		// 包围球跨越平面时再用AABB精确判断: 取最靠近平面正侧的顶点
+		const float boxDist = PlaneDistance(p, box.center) +
+			std::fabs(p.x) * box.extents.x + std::fabs(p.y) * box.extents.y + std::fabs(p.z) * box.extents.z;
+		if (boxDist < 0.0f)
+			return plane;
+	}
+
+	return Visible;
+}
+
+void CullingCache::Build(const BoundingBox& localBox, const std::vector<Bounds::Matrix4x4>& worldMatrices)
+{
+	const size_t count = worldMatrices.size();
+	m_localBox = Bounds::ToAabb(localBox);
+	m_localSphere = Bounds::SphereFromAabb(m_localBox);
+
+	m_worldSpheres.resize(count);
+	m_worldBoxes.resize(count);
+	Bounds::TransformSpheres(m_localSphere, worldMatrices.data(), count, m_worldSpheres.data());
+	Bounds::TransformAabbs(m_localBox, worldMatrices.data(), count, m_worldBoxes.data());
+
+	m_lastPlanes.assign(count, Visible);
+	m_isDirty.assign(count, 1);
+	m_hasDirty = true;
+}
@@ -0,0 +1,71 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 静态实例的视锥体剔除缓存
+// 预先计算每个实例在世界空间中的包围球与AABB,并利用帧间相关性:
+// 上一帧拒绝该实例的平面优先测试,摄像机没有变化的平面不再重复测试
+// 包围体的变换与视锥体平面的提取使用Bounds.h
+// Temporal-coherence frustum culling cache for static instances.
+//***************************************************************************************
+
+#ifndef CULLINGCACHE_H
+#define CULLINGCACHE_H
+
+#include "PortableTypes.h"
+#include <vector>
+
+#include "BasicTransform.h"
+#include "BoundsInterop.h"
+
+class CullingCache
+{
+public:
+	// 统计信息,每次Cull时清零
+	struct Statistics
+	{
+		UINT planeTests;			// 实际进行的平面测试次数
+		UINT reusedInstances;		// 直接沿用上一帧结果的实例数目
+	};
+
+	// 以模型的局部包围盒与一组静态实例构建缓存
+	void Build(const DirectX::BoundingBox& localBox, const std::vector<BasicTransform>& transforms);
+	void Build(const DirectX::BoundingBox& localBox, const std::vector<DirectX::XMFLOAT4X4>& worldMatrices);
+	// 单个实例发生变化时更新,只有该实例会在下一次剔除时被重新测试
+	void SetInstance(UINT index, const BasicTransform& transform);
+	void XM_CALLCONV SetInstance(UINT index, DirectX::FXMMATRIX world);
+
+	// 以观察投影矩阵剔除,返回可见实例的索引(在下一次Cull之前有效)
+	const std::vector<UINT>& XM_CALLCONV Cull(DirectX::FXMMATRIX viewProj);
+
+	UINT GetInstanceCount() const;
+	// 获取世界空间包围体
+	const Bounds::Sphere& GetWorldSphere(UINT index) const;
+	const Bounds::Aabb& GetWorldBox(UINT index) const;
+
+	const Statistics& GetStatistics() const;
+
+private:
+	// 上一帧可见
+	static constexpr UINT8 Visible = 0xFF;
+
+	// 测试单个实例,planeMask为需要测试的平面,返回拒绝它的平面或Visible
+	UINT8 TestInstance(UINT index, UINT planeMask, UINT8 firstPlane);
+	// 以一组世界矩阵批量计算所有实例的世界空间包围体
+	void Build(const DirectX::BoundingBox& localBox, const std::vector<Bounds::Matrix4x4>& worldMatrices);
+
+	Bounds::Aabb m_localBox{};
+	Bounds::Sphere m_localSphere{};
+
+	std::vector<Bounds::Sphere> m_worldSpheres;
+	std::vector<Bounds::Aabb> m_worldBoxes;
+	std::vector<UINT8> m_lastPlanes;			// 上一帧拒绝该实例的平面,可见时为Visible
+	std::vector<UINT8> m_isDirty;				// 实例是否需要完整测试
+	bool m_hasDirty = true;
+
+	Bounds::Frustum m_frustum{};				// 上一帧的世界空间视锥体,法线朝内
+	std::vector<UINT> m_visibleIndices;
+
+	Statistics m_statistics{};
+};
+
+#endif
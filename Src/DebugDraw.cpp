@@ -0,0 +1,69 @@
+#include "DebugDraw.h"
+#include "RenderBackendD3D11.h"
+#include "Vertex.h"
+#include "d3dUtil.h"
+#include "DXTrace.h"
+
+#include <algorithm>
+#include <cstddef>
+
+using namespace DirectX;
+
+// 线框顶点直接按VertexPosColor的输入布局读取
+static_assert(sizeof(DebugLineBatch::Vertex) == sizeof(VertexPosColor) &&
+	offsetof(DebugLineBatch::Vertex, color) == offsetof(VertexPosColor, color), "DebugLineBatch::Vertex must match VertexPosColor");
+
+DebugDraw::DebugDraw(const UINT reservedVertices, const UINT reservedIndices)
+	:
+	DebugLineBatch(reservedVertices, reservedIndices),
+	m_vertexCapacity(reservedVertices),
+	m_indexCapacity(reservedIndices)
+{
+}
+
+HRESULT DebugDraw::InitResource(ID3D11Device* device)
+{
+	HRESULT hr = CreateVertexBuffer(device, nullptr, m_vertexCapacity * sizeof(Vertex), m_pVertexBuffer.ReleaseAndGetAddressOf(), true);
+	if (FAILED(hr))
+		return hr;
+	hr = CreateIndexBuffer(device, nullptr, m_indexCapacity * sizeof(UINT), m_pIndexBuffer.ReleaseAndGetAddressOf(), true);
+	return hr;
+}
+
+void DebugDraw::Flush(ID3D11DeviceContext* deviceContext, IEffect* effect)
+{
+	if (GetIndexCount() == 0)
+		return;
+
+	if (GetVertexCount() > m_vertexCapacity || GetIndexCount() > m_indexCapacity)
+	{
+		ComPtr<ID3D11Device> device;
+		deviceContext->GetDevice(device.GetAddressOf());
+		ResizeBuffers(device.Get());
+	}
+
+	D3D11RenderBackend backend(deviceContext);
+	Draw(backend, ToRenderBuffer(m_pVertexBuffer.Get()), ToRenderBuffer(m_pIndexBuffer.Get()), ToRenderEffect(effect));
+
+	Clear();
+}
+
+void DebugDraw::SetDebugObjectName(const std::string& name)
+{
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+	D3D11SetDebugObjectName(m_pVertexBuffer.Get(), name + ".VertexBuffer");
+	D3D11SetDebugObjectName(m_pIndexBuffer.Get(), name + ".IndexBuffer");
+#else
+	UNREFERENCED_PARAMETER(name);
+#endif
+}
+
+void DebugDraw::ResizeBuffers(ID3D11Device* device)
+{
+	// 按1.5倍增长,减少之后再次重建的次数
+	m_vertexCapacity = (std::max)(m_vertexCapacity, GetVertexCount() + GetVertexCount() / 2);
+	m_indexCapacity = (std::max)(m_indexCapacity, GetIndexCount() + GetIndexCount() / 2);
+
+	HR(CreateVertexBuffer(device, nullptr, m_vertexCapacity * sizeof(Vertex), m_pVertexBuffer.ReleaseAndGetAddressOf(), true));
+	HR(CreateIndexBuffer(device, nullptr, m_indexCapacity * sizeof(UINT), m_pIndexBuffer.ReleaseAndGetAddressOf(), true));
+}
@@ -0,0 +1,50 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 立即模式的调试线框绘制
+// 每帧将所有包围盒/球/视锥体/射线/BVH节点追加到同一份顶点/索引数组中,
+// 最后以一次线段列表绘制提交,与Collision::CreateBounding*不同,不会为每个物体单独分配内存
+// 线框的合批在DebugLineBatch中,这里只负责D3D缓冲区的创建与扩容
+// Immediate-mode batched wireframe debug drawing.
+//***************************************************************************************
+
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <string>
+
+#include "DebugLineBatch.h"
+#include "EffectHelper.h"
+
+class DebugDraw : public DebugLineBatch
+{
+public:
+	template<typename T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	// 预先保留的顶点/索引数目
+	explicit DebugDraw(UINT reservedVertices = 65536, UINT reservedIndices = 131072);
+
+	// 创建顶点/索引缓冲区
+	HRESULT InitResource(ID3D11Device* device);
+
+	// 上传并以一次DrawIndexed绘制全部线框,然后清空
+	// 调用前需要设置好绘制线框的特效(例如DebugEffect::SetRenderLine)
+	void Flush(ID3D11DeviceContext* deviceContext, IEffect* effect);
+
+	// 设置调试对象名
+	void SetDebugObjectName(const std::string& name);
+
+private:
+	// 确保缓冲区可以容纳当前的数据
+	void ResizeBuffers(ID3D11Device* device);
+
+	ComPtr<ID3D11Buffer> m_pVertexBuffer;
+	ComPtr<ID3D11Buffer> m_pIndexBuffer;
+	UINT m_vertexCapacity;
+	UINT m_indexCapacity;
+};
+
+#endif
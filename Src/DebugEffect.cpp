@@ -14,10 +14,22 @@ public:
 	std::shared_ptr<IEffectPass> m_pCurrEffectPass;
 
 	ComPtr<ID3D11InputLayout> m_pVertexPosNormalTexLayout;
+	ComPtr<ID3D11InputLayout> m_pVertexPosColorLayout;
 
 	XMFLOAT4X4 m_world;
 	XMFLOAT4X4 m_view;
 	XMFLOAT4X4 m_proj;
+
+	// 初始化时解析的渲染通道与句柄,之后的设置不再按名称查找
+	std::shared_ptr<IEffectPass> m_pDebugTextureRGBAPass;
+	std::shared_ptr<IEffectPass> m_pDebugTextureOneCompPass;
+	std::shared_ptr<IEffectPass> m_pDebugTextureOneCompGrayPass;
+	std::shared_ptr<IEffectPass> m_pDebugLinePass;
+
+	EffectVariableHandle m_oneCompIndexHandle;
+	EffectVariableHandle m_oneCompGrayIndexHandle;
+	EffectVariableHandle m_worldViewProjHandle;
+	EffectShaderResourceHandle m_diffuseMapHandle;
 };
 
 //
@@ -80,6 +92,12 @@ bool DebugEffect::InitAll(ID3D11Device* device) const
 	HR(device->CreateInputLayout(VertexPosNormalTex::InputLayout, ARRAYSIZE(VertexPosNormalTex::InputLayout),
 		blob->GetBufferPointer(), blob->GetBufferSize(), m_pImpl->m_pVertexPosNormalTexLayout.GetAddressOf()));
 
+	HR(CreateShaderFromFile(L"HLSL\\DebugLine_VS.cso", L"HLSL\\DebugLine_VS.hlsl", "VS", "vs_5_0", blob.ReleaseAndGetAddressOf()));
+	HR(m_pImpl->m_pEffectHelper->AddShader("DebugLine_VS", device, blob.Get()));
+	// 创建顶点布局
+	HR(device->CreateInputLayout(VertexPosColor::InputLayout, ARRAYSIZE(VertexPosColor::InputLayout),
+		blob->GetBufferPointer(), blob->GetBufferSize(), m_pImpl->m_pVertexPosColorLayout.GetAddressOf()));
+
 	// ******************
 	// 创建像素着色器
 	//
@@ -93,6 +111,9 @@ bool DebugEffect::InitAll(ID3D11Device* device) const
 	HR(CreateShaderFromFile(L"HLSL\\DebugTextureOneCompGray_PS.cso", L"HLSL\\DebugTextureOneCompGray_PS.hlsl", "PS", "ps_5_0", blob.ReleaseAndGetAddressOf()));
 	HR(m_pImpl->m_pEffectHelper->AddShader("DebugTextureOneCompGray_PS", device, blob.Get()));
 
+	HR(CreateShaderFromFile(L"HLSL\\DebugLine_PS.cso", L"HLSL\\DebugLine_PS.hlsl", "PS", "ps_5_0", blob.ReleaseAndGetAddressOf()));
+	HR(m_pImpl->m_pEffectHelper->AddShader("DebugLine_PS", device, blob.Get()));
+
 	// ******************
 	// 创建通道
 	//
@@ -106,12 +127,27 @@ bool DebugEffect::InitAll(ID3D11Device* device) const
 	passDesc.nameVS = "DebugTexture_VS";
 	passDesc.namePS = "DebugTextureOneCompGray_PS";
 	HR(m_pImpl->m_pEffectHelper->AddEffectPass("DebugTextureOneCompGray", device, &passDesc));
+	passDesc.nameVS = "DebugLine_VS";
+	passDesc.namePS = "DebugLine_PS";
+	HR(m_pImpl->m_pEffectHelper->AddEffectPass("DebugLine", device, &passDesc));
 
 	// 设置采样器
 	m_pImpl->m_pEffectHelper->SetSamplerStateByName("g_Sam", RenderStates::SSLinearWrap.Get());
 
+	// 解析渲染通道与句柄
+	EffectHelper& effectHelper = *m_pImpl->m_pEffectHelper;
+	m_pImpl->m_pDebugTextureRGBAPass = effectHelper.GetEffectPass("DebugTextureRGBA");
+	m_pImpl->m_pDebugTextureOneCompPass = effectHelper.GetEffectPass("DebugTextureOneComp");
+	m_pImpl->m_pDebugTextureOneCompGrayPass = effectHelper.GetEffectPass("DebugTextureOneCompGray");
+	m_pImpl->m_pDebugLinePass = effectHelper.GetEffectPass("DebugLine");
+	m_pImpl->m_oneCompIndexHandle = m_pImpl->m_pDebugTextureOneCompPass->PSGetParamHandle("index");
+	m_pImpl->m_oneCompGrayIndexHandle = m_pImpl->m_pDebugTextureOneCompGrayPass->PSGetParamHandle("index");
+	m_pImpl->m_worldViewProjHandle = effectHelper.GetConstantBufferVariableHandle("g_WorldViewProj");
+	m_pImpl->m_diffuseMapHandle = effectHelper.GetShaderResourceHandle("g_DiffuseMap");
+
 	// 设置调试对象名
 	D3D11SetDebugObjectName(m_pImpl->m_pVertexPosNormalTexLayout.Get(), "DebugEffect.VertexPosNormalTexLayout");
+	D3D11SetDebugObjectName(m_pImpl->m_pVertexPosColorLayout.Get(), "DebugEffect.VertexPosColorLayout");
 	m_pImpl->m_pEffectHelper->SetDebugObjectName("DebugEffect");
 
 	return true;
@@ -120,21 +156,27 @@ bool DebugEffect::InitAll(ID3D11Device* device) const
 void DebugEffect::SetRenderDefault(ID3D11DeviceContext* deviceContext) const
 {
 	deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosNormalTexLayout.Get());
-	m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("DebugTextureRGBA");
+	m_pImpl->m_pCurrEffectPass = m_pImpl->m_pDebugTextureRGBAPass;
 }
 
 void DebugEffect::SetRenderOneComponent(ID3D11DeviceContext* deviceContext, int index) const
 {
 	deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosNormalTexLayout.Get());
-	m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("DebugTextureOneComp");
-	m_pImpl->m_pCurrEffectPass->PSGetParamByName("index")->SetSInt(index);
+	m_pImpl->m_pCurrEffectPass = m_pImpl->m_pDebugTextureOneCompPass;
+	m_pImpl->m_oneCompIndexHandle.SetSInt(index);
 }
 
 void DebugEffect::SetRenderOneComponentGray(ID3D11DeviceContext* deviceContext, int index) const
 {
 	deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosNormalTexLayout.Get());
-	m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("DebugTextureOneCompGray");
-	m_pImpl->m_pCurrEffectPass->PSGetParamByName("index")->SetSInt(index);
+	m_pImpl->m_pCurrEffectPass = m_pImpl->m_pDebugTextureOneCompGrayPass;
+	m_pImpl->m_oneCompGrayIndexHandle.SetSInt(index);
+}
+
+void DebugEffect::SetRenderLine(ID3D11DeviceContext* deviceContext) const
+{
+	deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosColorLayout.Get());
+	m_pImpl->m_pCurrEffectPass = m_pImpl->m_pDebugLinePass;
 }
 
 void XM_CALLCONV DebugEffect::SetWorldMatrix(FXMMATRIX world) const
@@ -154,13 +196,24 @@ void XM_CALLCONV DebugEffect::SetProjMatrix(FXMMATRIX proj) const
 
 void DebugEffect::SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const
 {
-	m_pImpl->m_pEffectHelper->SetShaderResourceByName("g_DiffuseMap", textureDiffuse);
+	m_pImpl->m_diffuseMapHandle.Set(textureDiffuse);
+}
+
+void XM_CALLCONV DebugEffect::SetDrawParameters(const EffectDrawParameters& parameters, FXMMATRIX world) const
+{
+	SetWorldMatrix(world);
+	SetInstancedDrawParameters(parameters);
+}
+
+void DebugEffect::SetInstancedDrawParameters(const EffectDrawParameters& parameters) const
+{
+	SetTextureDiffuse(parameters.textureDiffuse);
 }
 
 void DebugEffect::Apply(ID3D11DeviceContext* deviceContext)
 {
 	XMMATRIX worldViewProjMatrix = XMMatrixTranspose(XMLoadFloat4x4(&m_pImpl->m_world) * XMLoadFloat4x4(&m_pImpl->m_view) * XMLoadFloat4x4(&m_pImpl->m_proj));
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_WorldViewProj")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&worldViewProjMatrix));
+	m_pImpl->m_worldViewProjHandle.SetMatrix(worldViewProjMatrix);
 
 	m_pImpl->m_pCurrEffectPass->Apply(deviceContext);
 }
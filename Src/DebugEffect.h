@@ -53,10 +53,16 @@ public:
 	// 绘制单通道，但以灰度的形式呈现(0-R, 1-G, 2-B, 3-A)
 	void SetRenderOneComponentGray(ID3D11DeviceContext* deviceContext, int index) const;
 
+	// 绘制带顶点颜色的线框(VertexPosColor)
+	void SetRenderLine(ID3D11DeviceContext* deviceContext) const;
+
 	//
 	// IEffect
 	//
 
+	void XM_CALLCONV SetDrawParameters(const EffectDrawParameters& parameters, DirectX::FXMMATRIX world) const override;
+	void SetInstancedDrawParameters(const EffectDrawParameters& parameters) const override;
+
 	// 应用常量缓冲区和纹理资源的变更
 	void Apply(ID3D11DeviceContext* deviceContext) override;
 
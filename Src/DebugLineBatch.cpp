@@ -0,0 +1,205 @@
+#include "DebugLineBatch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace DirectX;
+
+namespace
+{
+	// 长方体的12条棱,与Collision::CreateFromCorners一致
+	constexpr UINT BoxEdgeIndices[24] =
+	{
+		0, 4, 0, 1, 4, 5,
+		1, 5, 1, 2, 5, 6,
+		2, 6, 2, 3, 6, 7,
+		3, 7, 3, 0, 7, 4
+	};
+}
+
+DebugLineBatch::DebugLineBatch(const UINT reservedVertices, const UINT reservedIndices)
+{
+	Reserve(reservedVertices, reservedIndices);
+}
+
+void DebugLineBatch::Reserve(const UINT vertexCount, const UINT indexCount)
+{
+	m_vertices.reserve(vertexCount);
+	m_indices.reserve(indexCount);
+}
+
+void DebugLineBatch::Clear()
+{
+	m_vertices.clear();
+	m_indices.clear();
+}
+
+void DebugLineBatch::AddLine(FXMVECTOR start, FXMVECTOR end, const XMFLOAT4& color)
+{
+	const UINT base = static_cast<UINT>(m_vertices.size());
+	Vertex vertex{ {}, color };
+	XMStoreFloat3(&vertex.pos, start);
+	m_vertices.push_back(vertex);
+	XMStoreFloat3(&vertex.pos, end);
+	m_vertices.push_back(vertex);
+	m_indices.push_back(base);
+	m_indices.push_back(base + 1);
+}
+
+void DebugLineBatch::AddBox(const BoundingBox& box, const XMFLOAT4& color)
+{
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	box.GetCorners(corners);
+	AddCorners(corners, color);
+}
+
+void DebugLineBatch::AddOrientedBox(const BoundingOrientedBox& box, const XMFLOAT4& color)
+{
+	XMFLOAT3 corners[BoundingOrientedBox::CORNER_COUNT];
+	box.GetCorners(corners);
+	AddCorners(corners, color);
+}
+
+void DebugLineBatch::AddSphere(const BoundingSphere& sphere, const XMFLOAT4& color, const UINT slices)
+{
+	const UINT base = static_cast<UINT>(m_vertices.size());
+	const XMVECTOR center = XMLoadFloat3(&sphere.Center);
+	const float radius = sphere.Radius;
+
+	// 依次为XZ、XY、YZ平面上的圆
+	const size_t vertexOffset = m_vertices.size();
+	m_vertices.resize(vertexOffset + static_cast<size_t>(slices) * 3);
+	Vertex* pVertex = m_vertices.data() + vertexOffset;
+	for (UINT i = 0; i < slices; ++i)
+	{
+		float sine, cosine;
+		XMScalarSinCos(&sine, &cosine, XM_2PI * static_cast<float>(i) / static_cast<float>(slices));
+		sine *= radius;
+		cosine *= radius;
+
+		XMStoreFloat3(&pVertex[i].pos, center + XMVectorSet(cosine, 0.0f, sine, 0.0f));
+		XMStoreFloat3(&pVertex[i + slices].pos, center + XMVectorSet(cosine, sine, 0.0f, 0.0f));
+		XMStoreFloat3(&pVertex[i + slices * 2].pos, center + XMVectorSet(0.0f, cosine, sine, 0.0f));
+	}
+	for (UINT i = 0; i < slices * 3; ++i)
+		pVertex[i].color = color;
+
+	for (UINT circle = 0; circle < 3; ++circle)
+	{
+		const UINT circleBase = base + circle * slices;
+		for (UINT i = 0; i < slices; ++i)
+		{
+			m_indices.push_back(circleBase + i);
+			m_indices.push_back(circleBase + (i + 1) % slices);
+		}
+	}
+}
+
+void DebugLineBatch::AddFrustum(const BoundingFrustum& frustum, const XMFLOAT4& color)
+{
+	XMFLOAT3 corners[BoundingFrustum::CORNER_COUNT];
+	frustum.GetCorners(corners);
+	AddCorners(corners, color);
+}
+
+void DebugLineBatch::AddRay(const Ray& ray, const float length, const XMFLOAT4& color)
+{
+	const XMVECTOR origin = XMLoadFloat3(&ray.origin);
+	AddLine(origin, origin + XMLoadFloat3(&ray.direction) * length, color);
+}
+
+void DebugLineBatch::AddBoundingVolumeHierarchy(const BoundingVolumeHierarchy& bvh, const XMFLOAT4& nodeColor,
+	const XMFLOAT4& leafColor, const UINT maxDepth)
+{
+	const auto& nodes = bvh.GetNodes();
+	if (nodes.empty())
+		return;
+
+	// (节点索引, 深度)
+	// 深度优先遍历时栈中最多同时有深度+1个节点,栈的大小由树的深度决定,不会跳过任何子树
+	std::vector<std::pair<UINT, UINT>> stack;
+	stack.reserve(static_cast<size_t>((std::min)(bvh.GetDepth(), maxDepth)) + 1);
+	stack.emplace_back(0, 0);
+
+	while (!stack.empty())
+	{
+		const auto [index, depth] = stack.back();
+		stack.pop_back();
+		const BoundingVolumeHierarchy::Node& node = nodes[index];
+
+		BoundingBox box;
+		BoundingBox::CreateFromPoints(box, XMLoadFloat3(&node.boxMin), XMLoadFloat3(&node.boxMax));
+		AddBox(box, node.IsLeaf() ? leafColor : nodeColor);
+
+		if (!node.IsLeaf() && depth < maxDepth)
+		{
+			stack.emplace_back(node.leftOrFirst + 1, depth + 1);
+			stack.emplace_back(node.leftOrFirst, depth + 1);
+		}
+	}
+}
+
+UINT DebugLineBatch::GetVertexCount() const
+{
+	return static_cast<UINT>(m_vertices.size());
+}
+
+UINT DebugLineBatch::GetIndexCount() const
+{
+	return static_cast<UINT>(m_indices.size());
+}
+
+const std::vector<DebugLineBatch::Vertex>& DebugLineBatch::GetVertices() const
+{
+	return m_vertices;
+}
+
+const std::vector<UINT>& DebugLineBatch::GetIndices() const
+{
+	return m_indices;
+}
+
+void DebugLineBatch::Upload(IRenderBackend& backend, RenderBuffer* vertexBuffer, RenderBuffer* indexBuffer) const
+{
+	const UINT vertexBytes = static_cast<UINT>(m_vertices.size() * sizeof(Vertex));
+	std::memcpy(backend.Map(vertexBuffer, RenderMapType::WriteDiscard, 0, vertexBytes), m_vertices.data(), vertexBytes);
+	backend.Unmap(vertexBuffer);
+
+	const UINT indexBytes = static_cast<UINT>(m_indices.size() * sizeof(UINT));
+	std::memcpy(backend.Map(indexBuffer, RenderMapType::WriteDiscard, 0, indexBytes), m_indices.data(), indexBytes);
+	backend.Unmap(indexBuffer);
+}
+
+void DebugLineBatch::Draw(IRenderBackend& backend, RenderBuffer* vertexBuffer, RenderBuffer* indexBuffer, RenderEffect* effect) const
+{
+	if (m_indices.empty())
+		return;
+
+	Upload(backend, vertexBuffer, indexBuffer);
+
+	const UINT stride = sizeof(Vertex);
+	const UINT offset = 0;
+	backend.SetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+	backend.SetIndexBuffer(indexBuffer, RenderIndexFormat::UInt32, 0);
+	backend.SetPrimitiveTopology(RenderTopology::LineList);
+
+	backend.ApplyEffect(effect);
+	backend.DrawIndexed(static_cast<UINT>(m_indices.size()), 0, 0);
+
+	// 恢复为其余物体使用的三角形列表
+	backend.SetPrimitiveTopology(RenderTopology::TriangleList);
+}
+
+void DebugLineBatch::AddCorners(const XMFLOAT3 (&corners)[8], const XMFLOAT4& color)
+{
+	const UINT base = static_cast<UINT>(m_vertices.size());
+	for (const XMFLOAT3& corner : corners)
+		m_vertices.push_back({ corner, color });
+
+	const size_t indexOffset = m_indices.size();
+	m_indices.resize(indexOffset + 24);
+	UINT* pIndex = m_indices.data() + indexOffset;
+	for (UINT i = 0; i < 24; ++i)
+		pIndex[i] = base + BoxEdgeIndices[i];
+}
@@ -0,0 +1,73 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 调试线框的合批逻辑,不依赖D3D
+// 所有包围盒/球/视锥体/射线/BVH节点追加到同一份顶点/索引数组中,
+// 通过IRenderBackend上传并以一次线段列表绘制,DebugDraw在此之上管理D3D缓冲区
+// Batched wireframe debug line accumulation, submitted through IRenderBackend.
+//***************************************************************************************
+
+#ifndef DEBUGLINEBATCH_H
+#define DEBUGLINEBATCH_H
+
+#include "RenderBackend.h"
+#include "BoundingVolumeHierarchy.h"
+#include "Ray.h"
+
+#include <DirectXCollision.h>
+#include <climits>
+#include <vector>
+
+class DebugLineBatch
+{
+public:
+	// 与VertexPosColor布局相同
+	struct Vertex
+	{
+		DirectX::XMFLOAT3 pos;
+		DirectX::XMFLOAT4 color;
+	};
+
+	// 预先保留的顶点/索引数目
+	explicit DebugLineBatch(UINT reservedVertices = 65536, UINT reservedIndices = 131072);
+
+	// 预先保留内存,避免一帧之内反复扩容
+	void Reserve(UINT vertexCount, UINT indexCount);
+	// 清空本帧累积的线框,保留已分配的内存
+	void Clear();
+
+	//
+	// 追加线框
+	//
+
+	void XM_CALLCONV AddLine(DirectX::FXMVECTOR start, DirectX::FXMVECTOR end, const DirectX::XMFLOAT4& color);
+	void AddBox(const DirectX::BoundingBox& box, const DirectX::XMFLOAT4& color);
+	void AddOrientedBox(const DirectX::BoundingOrientedBox& box, const DirectX::XMFLOAT4& color);
+	// 以三个互相垂直的大圆表示球体
+	void AddSphere(const DirectX::BoundingSphere& sphere, const DirectX::XMFLOAT4& color, UINT slices = 20);
+	void AddFrustum(const DirectX::BoundingFrustum& frustum, const DirectX::XMFLOAT4& color);
+	void AddRay(const Ray& ray, float length, const DirectX::XMFLOAT4& color);
+	// 绘制深度不超过maxDepth(根节点深度为0)的所有BVH节点,叶节点使用leafColor
+	void AddBoundingVolumeHierarchy(const BoundingVolumeHierarchy& bvh, const DirectX::XMFLOAT4& nodeColor,
+		const DirectX::XMFLOAT4& leafColor, UINT maxDepth = UINT_MAX);
+
+	UINT GetVertexCount() const;
+	UINT GetIndexCount() const;
+	const std::vector<Vertex>& GetVertices() const;
+	const std::vector<UINT>& GetIndices() const;
+
+	// 以WRITE_DISCARD映射顶点/索引缓冲区并写入全部线框,缓冲区需要能够容纳当前的数据
+	void Upload(IRenderBackend& backend, RenderBuffer* vertexBuffer, RenderBuffer* indexBuffer) const;
+	// 上传并以一次DrawIndexed绘制全部线框,之后恢复为三角形列表,不清空
+	// 调用前需要设置好绘制线框的特效渲染状态
+	void Draw(IRenderBackend& backend, RenderBuffer* vertexBuffer, RenderBuffer* indexBuffer, RenderEffect* effect) const;
+
+private:
+	// 以8个角点追加一个长方体线框,角点顺序与BoundingBox::GetCorners一致
+	void AddCorners(const DirectX::XMFLOAT3 (&corners)[8], const DirectX::XMFLOAT4& color);
+
+	std::vector<Vertex> m_vertices;
+	std::vector<UINT> m_indices;
+};
+
+#endif
@@ -0,0 +1,193 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 设备上下文绑定状态的缓存
+// 记录每个着色器阶段当前绑定的着色器、常量缓冲区(包括偏移绑定的起始常量与常量数目)、采样器与着色器资源,
+// 以及光栅化、混合与深度模板状态,只有要设置的值与记录的值不同时才需要调用D3D
+// 记录的对象持有引用: 仅比较指针时,对象释放后新对象恰好分配在同一地址会被误认为已经绑定
+// 不依赖D3D,EffectHelper与单元测试中的对象类型共用同一份实现
+// Per-context shadow of bound shaders, slots and pipeline states that holds references to what it records.
+//***************************************************************************************
+
+#ifndef EFFECTBINDINGCACHE_H
+#define EFFECTBINDINGCACHE_H
+
+#include "PortableTypes.h"
+
+#include <cstring>
+
+//
+// Object为所有被绑定对象的公共基类(EffectHelper中为IUnknown)
+// Reference需要提供:
+//	默认构造为空,以Object*赋值时持有它的引用并释放原有的引用,以nullptr赋值时释放引用
+//	Object* Get() const;
+//
+template <typename Object, typename Reference>
+class EffectBindingCache
+{
+public:
+	// 着色器阶段,与EFFECTPASS_XXX宏中的ShaderType对应
+	enum Stage : UINT
+	{
+		StageVS,
+		StageHS,
+		StageDS,
+		StageGS,
+		StagePS,
+		StageCS,
+		StageCount
+	};
+
+	// 与D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT等常量相同
+	static constexpr UINT ConstantBufferSlotCount = 14;
+	static constexpr UINT SamplerSlotCount = 16;
+	static constexpr UINT ShaderResourceSlotCount = 128;
+
+	// 所有记录的值都视为未知并释放持有的引用,下次设置时一定需要调用D3D
+	void Invalidate();
+
+	// 以下函数记录要设置的值,返回true表示与记录的值不同(或未知)需要调用D3D,返回false表示可以省略
+	bool SetShader(Stage stage, Object* pShader);
+	// 不使用偏移绑定时firstConstant与numConstants为0
+	bool SetConstantBuffer(Stage stage, UINT slot, Object* pBuffer, UINT firstConstant, UINT numConstants);
+	bool SetSampler(Stage stage, UINT slot, Object* pSampler);
+	bool SetShaderResource(Stage stage, UINT slot, Object* pShaderResource);
+	bool SetRasterizerState(Object* pState);
+	bool SetBlendState(Object* pState, const float blendFactor[4], UINT sampleMask);
+	bool SetDepthStencilState(Object* pState, UINT stencilRef);
+
+private:
+	struct Binding
+	{
+		Reference object;
+		bool isKnown = false;
+	};
+
+	struct ConstantBufferBinding : Binding
+	{
+		UINT firstConstant = 0;
+		UINT numConstants = 0;
+	};
+
+	struct StageBindings
+	{
+		Binding shader;
+		ConstantBufferBinding constantBuffers[ConstantBufferSlotCount];
+		Binding samplers[SamplerSlotCount];
+		Binding shaderResources[ShaderResourceSlotCount];
+	};
+
+	// 记录的值与pObject相同时返回false,否则记录pObject并返回true
+	static bool Update(Binding& binding, Object* pObject);
+	static void Forget(Binding& binding);
+
+	StageBindings m_stages[StageCount];
+
+	Binding m_rasterizerState;
+
+	Binding m_blendState;
+	float m_blendFactor[4] = {};
+	UINT m_sampleMask = 0;
+
+	Binding m_depthStencilState;
+	UINT m_stencilRef = 0;
+};
+
+template <typename Object, typename Reference>
+void EffectBindingCache<Object, Reference>::Invalidate()
+{
+	for (StageBindings& stage : m_stages)
+	{
+		Forget(stage.shader);
+		for (ConstantBufferBinding& binding : stage.constantBuffers)
+			Forget(binding);
+		for (Binding& binding : stage.samplers)
+			Forget(binding);
+		for (Binding& binding : stage.shaderResources)
+			Forget(binding);
+	}
+	Forget(m_rasterizerState);
+	Forget(m_blendState);
+	Forget(m_depthStencilState);
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::SetShader(const Stage stage, Object* pShader)
+{
+	return Update(m_stages[stage].shader, pShader);
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::SetConstantBuffer(const Stage stage, const UINT slot, Object* pBuffer, const UINT firstConstant, const UINT numConstants)
+{
+	ConstantBufferBinding& binding = m_stages[stage].constantBuffers[slot];
+	// 同一个常量缓冲区池的不同位置也需要重新绑定
+	const bool isRangeChanged = binding.firstConstant != firstConstant || binding.numConstants != numConstants;
+	if (!Update(binding, pBuffer) && !isRangeChanged)
+		return false;
+
+	binding.firstConstant = firstConstant;
+	binding.numConstants = numConstants;
+	return true;
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::SetSampler(const Stage stage, const UINT slot, Object* pSampler)
+{
+	return Update(m_stages[stage].samplers[slot], pSampler);
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::SetShaderResource(const Stage stage, const UINT slot, Object* pShaderResource)
+{
+	return Update(m_stages[stage].shaderResources[slot], pShaderResource);
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::SetRasterizerState(Object* pState)
+{
+	return Update(m_rasterizerState, pState);
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::SetBlendState(Object* pState, const float blendFactor[4], const UINT sampleMask)
+{
+	const bool isParameterChanged = std::memcmp(m_blendFactor, blendFactor, sizeof(m_blendFactor)) != 0 || m_sampleMask != sampleMask;
+	if (!Update(m_blendState, pState) && !isParameterChanged)
+		return false;
+
+	std::memcpy(m_blendFactor, blendFactor, sizeof(m_blendFactor));
+	m_sampleMask = sampleMask;
+	return true;
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::SetDepthStencilState(Object* pState, const UINT stencilRef)
+{
+	const bool isParameterChanged = m_stencilRef != stencilRef;
+	if (!Update(m_depthStencilState, pState) && !isParameterChanged)
+		return false;
+
+	m_stencilRef = stencilRef;
+	return true;
+}
+
+template <typename Object, typename Reference>
+bool EffectBindingCache<Object, Reference>::Update(Binding& binding, Object* pObject)
+{
+	if (binding.isKnown && binding.object.Get() == pObject)
+		return false;
+
+	binding.object = pObject;
+	binding.isKnown = true;
+	return true;
+}
+
+template <typename Object, typename Reference>
+void EffectBindingCache<Object, Reference>::Forget(Binding& binding)
+{
+	binding.object = nullptr;
+	binding.isKnown = false;
+}
+
+#endif
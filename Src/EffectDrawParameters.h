@@ -0,0 +1,47 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 每次绘制的参数块
+// 绘制路径只负责填写模型部分的材质与纹理,特效通过一次虚函数调用读取自己需要的部分
+// 不依赖D3D,IEffect与单元测试中的特效共用同一份接口
+// Per-draw parameter block passed from the draw paths to the effects.
+//***************************************************************************************
+
+#ifndef EFFECTDRAWPARAMETERS_H
+#define EFFECTDRAWPARAMETERS_H
+
+#include "LightHelper.h"
+
+#include <DirectXMath.h>
+
+struct ID3D11ShaderResourceView;
+
+// 每个模型部分的绘制参数,由绘制路径直接填写
+// 特效只读取自己需要的部分,绘制路径不需要判断特效的类型
+struct EffectDrawParameters
+{
+	const Material* material;							// 读取材质的特效要求不为nullptr
+	ID3D11ShaderResourceView* textureDiffuse;
+	ID3D11ShaderResourceView* textureNormalMap;
+};
+
+class IEffectDrawParameters
+{
+public:
+	IEffectDrawParameters() = default;
+	virtual ~IEffectDrawParameters() = default;
+
+	// 不允许拷贝，允许移动
+	IEffectDrawParameters(const IEffectDrawParameters&) = delete;
+	IEffectDrawParameters& operator=(const IEffectDrawParameters&) = delete;
+
+	IEffectDrawParameters(IEffectDrawParameters&&) = default;
+	IEffectDrawParameters& operator=(IEffectDrawParameters&&) = default;
+
+	// 设置一次绘制的参数与世界矩阵,不需要这些参数的特效可以不重写
+	virtual void XM_CALLCONV SetDrawParameters(const EffectDrawParameters&, DirectX::FXMMATRIX) const {}
+	// 设置一次实例绘制的参数,世界矩阵来自实例缓冲区
+	virtual void SetInstancedDrawParameters(const EffectDrawParameters&) const {}
+};
+
+#endif
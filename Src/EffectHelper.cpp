@@ -1,4 +1,10 @@
 #include "EffectHelper.h"
+#include "ConstantBufferArena.h"
+#include "EffectBindingCache.h"
+#include "RecordingThreadCheck.h"
+
+#include <atomic>
+#include <mutex>
 
 using namespace Microsoft::WRL;
 
@@ -48,9 +54,66 @@ namespace
 		}\
 	}
 
+	// 以下宏只在状态缓存中记录的值与要设置的值不同时才调用D3D,否则累加elided
 	#define EFFECTPASS_SET_SHADER(ShaderType)\
 	{\
-		deviceContext->##ShaderType##SetShader(p##ShaderType##Info->p##ShaderType##.Get(), nullptr, 0);\
+		if (state.bindings.SetShader(BindingCache::Stage##ShaderType, p##ShaderType##Info->p##ShaderType##.Get()))\
+			deviceContext->##ShaderType##SetShader(p##ShaderType##Info->p##ShaderType##.Get(), nullptr, 0);\
+		else\
+			++elided;\
+	}
+
+	#define EFFECTPASS_CLEAR_SHADER(ShaderType)\
+	{\
+		if (state.bindings.SetShader(BindingCache::Stage##ShaderType, nullptr))\
+			deviceContext->##ShaderType##SetShader(nullptr, nullptr, 0);\
+		else\
+			++elided;\
+	}
+
+	// 使用常量缓冲区池时绑定池中的一段(缓冲区与起始常量都相同才省略),否则绑定常量缓冲区自身
+	#define EFFECTPASS_BIND_CONSTANTBUFFER(ShaderType, Slot, cbData)\
+	{\
+		if (state.pArena)\
+		{\
+			ID3D11Buffer* pArenaBuffer = state.pArena->GetBuffer();\
+			const UINT firstConstant = (cbData).firstConstant;\
+			const UINT numConstants = (cbData).numConstants;\
+			if (state.bindings.SetConstantBuffer(BindingCache::Stage##ShaderType, Slot, pArenaBuffer, firstConstant, numConstants))\
+				state.pDeviceContext1->##ShaderType##SetConstantBuffers1(Slot, 1, &pArenaBuffer, &firstConstant, &numConstants);\
+			else\
+				++elided;\
+		}\
+		else if (state.bindings.SetConstantBuffer(BindingCache::Stage##ShaderType, Slot, (cbData).cBuffer.Get(), 0, 0))\
+			deviceContext->##ShaderType##SetConstantBuffers(Slot, 1, (cbData).cBuffer.GetAddressOf());\
+		else\
+			++elided;\
+	}
+
+	// 将用到的常量缓冲区与形参常量缓冲区写入常量缓冲区池,只在使用常量缓冲区池时调用
+	#define EFFECTPASS_UPLOAD_CONSTANTBUFFER(ShaderType)\
+	{\
+		if (p##ShaderType##Info)\
+		{\
+			for (UINT slot = 0, mask = p##ShaderType##Info->cbUseMask; mask; ++slot, mask >>= 1)\
+			{\
+				if (mask & 1)\
+					UploadToArena(*state.pArena, deviceContext, cBuffers.at(slot));\
+			}\
+			if (!p##ShaderType##Info->params.empty())\
+				UploadToArena(*state.pArena, deviceContext, *p##ShaderType##ParamData);\
+		}\
+	}
+
+	// 累加形参常量缓冲区在常量缓冲区池中占用的字节数,并记录用到的常量缓冲区槽
+	#define EFFECTPASS_ADD_ARENA_BYTEWIDTH(ShaderType)\
+	{\
+		if (p##ShaderType##Info)\
+		{\
+			cbUseMask |= p##ShaderType##Info->cbUseMask;\
+			if (!p##ShaderType##Info->params.empty())\
+				byteWidth += ConstantBufferAllocator::GetAlignedByteWidth(p##ShaderType##ParamData->byteWidth);\
+		}\
 	}
 
 	#define EFFECTPASS_SET_CONSTANTBUFFER(ShaderType)\
@@ -60,42 +123,69 @@ namespace
 			if (mask & 1)\
 			{\
 				CBufferData& cbData = cBuffers.at(slot);\
-				cbData.UpdateBuffer(deviceContext);\
-				deviceContext->##ShaderType##SetConstantBuffers(slot, 1, cBuffers.at(slot).cBuffer.GetAddressOf());\
+				if (!state.pArena)\
+					cbData.UpdateBuffer(deviceContext);\
+				EFFECTPASS_BIND_CONSTANTBUFFER(ShaderType, slot, cbData);\
 			}\
 		}\
 	}
 
+	// 使用常量缓冲区池时每个Pass的形参直接写入池中,否则复制到着色器共享的形参常量缓冲区
 	#define EFFECTPASS_SET_PARAM(ShaderType)\
 	{\
 		if (!p##ShaderType##Info->params.empty())\
 		{\
-			if (p##ShaderType##ParamData->isDirty)\
+			if (state.pArena)\
+			{\
+				EFFECTPASS_BIND_CONSTANTBUFFER(ShaderType, p##ShaderType##ParamData->startSlot, *p##ShaderType##ParamData);\
+			}\
+			else\
 			{\
-				p##ShaderType##ParamData->isDirty = false;\
-				p##ShaderType##Info->pParamData->isDirty = true;\
-				memcpy_s(p##ShaderType##Info->pParamData->pData.get(), p##ShaderType##ParamData->byteWidth,\
-					p##ShaderType##ParamData->pData.get(), p##ShaderType##ParamData->byteWidth);\
-				p##ShaderType##Info->pParamData->UpdateBuffer(deviceContext);\
+				if (p##ShaderType##ParamData->isDirty)\
+				{\
+					p##ShaderType##ParamData->isDirty = false;\
+					p##ShaderType##Info->pParamData->isDirty = true;\
+					memcpy_s(p##ShaderType##Info->pParamData->pData.get(), p##ShaderType##ParamData->byteWidth,\
+						p##ShaderType##ParamData->pData.get(), p##ShaderType##ParamData->byteWidth);\
+					p##ShaderType##Info->pParamData->UpdateBuffer(deviceContext);\
+				}\
+				EFFECTPASS_BIND_CONSTANTBUFFER(ShaderType, p##ShaderType##Info->pParamData->startSlot,\
+					*p##ShaderType##Info->pParamData);\
 			}\
-			deviceContext->##ShaderType##SetConstantBuffers(p##ShaderType##Info->pParamData->startSlot,\
-				1, p##ShaderType##Info->pParamData->cBuffer.GetAddressOf());\
 		}\
 	}
 
 	#define EFFECTPASS_SET_SAMPLER(ShaderType)\
 	{\
 		for (UINT slot = 0, mask = p##ShaderType##Info->ssUseMask; mask; ++slot, mask >>= 1)\
+		{\
 			if (mask & 1)\
-				deviceContext->##ShaderType##SetSamplers(slot, 1, samplers.at(slot).pSS.GetAddressOf());\
+			{\
+				ID3D11SamplerState* pSampler = samplers.at(slot).pSS.Get();\
+				if (state.bindings.SetSampler(BindingCache::Stage##ShaderType, slot, pSampler))\
+					deviceContext->##ShaderType##SetSamplers(slot, 1, &pSampler);\
+				else\
+					++elided;\
+			}\
+		}\
 	}
 
 	#define EFFECTPASS_SET_SHADERRESOURCE(ShaderType)\
 	{\
 		for (UINT i = 0, slot = i * 32; i < 4; ++i, slot = i * 32)\
+		{\
 			for (UINT mask = p##ShaderType##Info->srUseMasks[i]; mask; ++slot, mask >>= 1)\
+			{\
 				if (mask & 1)\
-					deviceContext->##ShaderType##SetShaderResources(slot, 1, shaderResources.at(slot).pSRV.GetAddressOf());\
+				{\
+					ID3D11ShaderResourceView* pSRV = shaderResources.at(slot).pSRV.Get();\
+					if (state.bindings.SetShaderResource(BindingCache::Stage##ShaderType, slot, pSRV))\
+						deviceContext->##ShaderType##SetShaderResources(slot, 1, &pSRV);\
+					else\
+						++elided;\
+				}\
+			}\
+		}\
 	}
 }
 
@@ -146,6 +236,12 @@ struct CBufferData : CBufferBase
 	UINT startSlot;
 	UINT byteWidth;
 
+	// 最近一次写入常量缓冲区池的位置,池不同或已经回绕时失效
+	const ConstantBufferArena* pArena = nullptr;
+	UINT arenaGeneration = 0;
+	UINT firstConstant = 0;
+	UINT numConstants = 0;
+
 	CBufferData() : CBufferBase(), startSlot(), byteWidth() {}
 	CBufferData(const LPCSTR name, const UINT startSlot, const UINT byteWidth, BYTE* initData = nullptr) :
 		CBufferBase(), pData(new BYTE[byteWidth]{}), cbufferName(name), startSlot(startSlot),
@@ -211,6 +307,19 @@ struct CBufferData : CBufferBase
 	}
 };
 
+// 将常量缓冲区数据写入常量缓冲区池,数据没有变化且之前的位置仍然有效时不重复写入
+static void UploadToArena(ConstantBufferArena& arena, ID3D11DeviceContext* deviceContext, CBufferData& cbData)
+{
+	if (cbData.isDirty || cbData.pArena != &arena || cbData.arenaGeneration != arena.GetGeneration())
+	{
+		if (!arena.Upload(deviceContext, cbData.pData.get(), cbData.byteWidth, &cbData.firstConstant, &cbData.numConstants))
+			throw std::exception("The constant buffer is larger than the constant buffer arena!");
+		cbData.isDirty = false;
+		cbData.pArena = &arena;
+		cbData.arenaGeneration = arena.GetGeneration();
+	}
+}
+
 struct ConstantBufferVariable : public IEffectConstantBufferVariable
 {
 	ConstantBufferVariable() = default;
@@ -312,6 +421,11 @@ struct ConstantBufferVariable : public IEffectConstantBufferVariable
 		return S_OK;
 	}
 
+	EffectVariableHandle GetHandle() const
+	{
+		return { pCBufferData->pData.get() + startByteOffset, &pCBufferData->isDirty, byteWidth };
+	}
+
 	void SetMatrixInBytes(const UINT rows, const UINT cols, const BYTE* noPadData) const
 	{
 		// 仅允许1x1到4x4
@@ -406,14 +520,118 @@ struct ComputeShaderInfo
 };
 
 
+// 绑定的对象以IUnknown记录并持有引用
+using BindingCache = EffectBindingCache<IUnknown, ComPtr<IUnknown>>;
+static_assert(BindingCache::ConstantBufferSlotCount == D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, "constant buffer slot count mismatch");
+static_assert(BindingCache::SamplerSlotCount == D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, "sampler slot count mismatch");
+static_assert(BindingCache::ShaderResourceSlotCount == D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, "shader resource slot count mismatch");
+
+// 设备上下文当前绑定的状态
+// 状态缓存持有绑定对象的引用,直到槽被替换、Invalidate或EffectStateCache::Release
+struct DeviceContextState
+{
+	// 所有记录的值都视为未知,下次设置时一定会调用D3D
+	void Invalidate()
+	{
+		bindings.Invalidate();
+	}
+
+	// 获取设备上下文对应的状态,不同的线程可以同时访问各自的设备上下文
+	static DeviceContextState& Get(ID3D11DeviceContext* deviceContext);
+	// 销毁设备上下文对应的状态与常量缓冲区池,之后再次Get会重新创建
+	static void Release(ID3D11DeviceContext* deviceContext);
+
+	BindingCache bindings;
+
+	// 持有引用,保证作为键的指针在状态销毁之前不会被其它设备上下文复用
+	ComPtr<ID3D11DeviceContext> pDeviceContext;
+	// 设备支持常量缓冲区偏移绑定时,常量缓冲区都写入该设备上下文独有的常量缓冲区池,否则为nullptr
+	ComPtr<ID3D11DeviceContext1> pDeviceContext1;
+	std::unique_ptr<ConstantBufferArena> pArena;
+};
+
+// 所有设备上下文的状态
+struct DeviceContextStates
+{
+	static DeviceContextStates& Instance()
+	{
+		static DeviceContextStates s_states;
+		return s_states;
+	}
+
+	std::mutex mutex;
+	std::unordered_map<ID3D11DeviceContext*, std::unique_ptr<DeviceContextState>> states;
+	// 每次释放状态时递增,各线程缓存的上一次结果随之失效
+	std::atomic<UINT> generation{ 0 };
+};
+
+DeviceContextState& DeviceContextState::Get(ID3D11DeviceContext* deviceContext)
+{
+	DeviceContextStates& registry = DeviceContextStates::Instance();
+
+	// 同一线程通常连续使用同一个设备上下文,先检查上一次的结果以避免加锁
+	thread_local ID3D11DeviceContext* t_pLastContext = nullptr;
+	thread_local DeviceContextState* t_pLastState = nullptr;
+	thread_local UINT t_lastGeneration = 0;
+	const UINT generation = registry.generation.load(std::memory_order_acquire);
+	if (t_pLastContext == deviceContext && t_lastGeneration == generation)
+		return *t_pLastState;
+
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	auto& pState = registry.states[deviceContext];
+	if (!pState)
+	{
+		pState = std::make_unique<DeviceContextState>();
+		pState->pDeviceContext = deviceContext;
+
+		ComPtr<ID3D11Device> device;
+		ComPtr<ID3D11DeviceContext1> deviceContext1;
+		deviceContext->GetDevice(device.GetAddressOf());
+		if (ConstantBufferArena::IsSupported(device.Get()) && SUCCEEDED(deviceContext->QueryInterface(deviceContext1.GetAddressOf())))
+		{
+			auto pArena = std::make_unique<ConstantBufferArena>();
+			if (SUCCEEDED(pArena->InitResource(device.Get())))
+			{
+				pState->pDeviceContext1 = std::move(deviceContext1);
+				pState->pArena = std::move(pArena);
+				pState->pArena->SetDebugObjectName("EffectHelper");
+			}
+		}
+	}
+
+	t_pLastContext = deviceContext;
+	t_pLastState = pState.get();
+	t_lastGeneration = generation;
+	return *pState;
+}
+
+void DeviceContextState::Release(ID3D11DeviceContext* deviceContext)
+{
+	DeviceContextStates& registry = DeviceContextStates::Instance();
+
+	// 在锁外销毁,释放常量缓冲区池时不阻塞其它线程
+	std::unique_ptr<DeviceContextState> pState;
+	{
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		const auto it = registry.states.find(deviceContext);
+		if (it == registry.states.end())
+			return;
+		pState = std::move(it->second);
+		registry.states.erase(it);
+		// 先使所有线程缓存的指针失效,再销毁状态
+		registry.generation.fetch_add(1, std::memory_order_release);
+	}
+}
+
 struct EffectPass : public IEffectPass
 {
 	EffectPass(std::unordered_map<UINT, CBufferData>& cBuffers,
 		std::unordered_map<UINT, ShaderResource>& shaderResources,
 		std::unordered_map<UINT, SamplerState>& samplers,
-		std::unordered_map<UINT, RWResource>& rwResources)
+		std::unordered_map<UINT, RWResource>& rwResources,
+		RecordingThreadCheck& threadCheck)
 		: cBuffers(cBuffers), shaderResources(shaderResources),
-		samplers(samplers), rwResources(rwResources)
+		samplers(samplers), rwResources(rwResources), threadCheck(threadCheck)
 	{
 	}
 
@@ -426,7 +644,16 @@ struct EffectPass : public IEffectPass
 	std::shared_ptr<IEffectConstantBufferVariable> GSGetParamByName(LPCSTR paramName) override;
 	std::shared_ptr<IEffectConstantBufferVariable> PSGetParamByName(LPCSTR paramName) override;
 	std::shared_ptr<IEffectConstantBufferVariable> CSGetParamByName(LPCSTR paramName) override;
-	void Apply(ID3D11DeviceContext * deviceContext) override;
+	EffectVariableHandle VSGetParamHandle(LPCSTR paramName) override;
+	EffectVariableHandle DSGetParamHandle(LPCSTR paramName) override;
+	EffectVariableHandle HSGetParamHandle(LPCSTR paramName) override;
+	EffectVariableHandle GSGetParamHandle(LPCSTR paramName) override;
+	EffectVariableHandle PSGetParamHandle(LPCSTR paramName) override;
+	EffectVariableHandle CSGetParamHandle(LPCSTR paramName) override;
+	UINT Apply(ID3D11DeviceContext * deviceContext) override;
+
+	// 一次Apply最多写入常量缓冲区池的字节数,同一个常量缓冲区只计算一次
+	UINT GetArenaByteWidth() const;
 
 	// 渲染状态
 	ComPtr<ID3D11BlendState> pBlendState = nullptr;
@@ -459,6 +686,9 @@ struct EffectPass : public IEffectPass
 	std::unordered_map<UINT, ShaderResource>& shaderResources;
 	std::unordered_map<UINT, SamplerState>& samplers;
 	std::unordered_map<UINT, RWResource>& rwResources;
+
+	// 所属特效的线程检查,同一特效的所有渲染通道共用
+	RecordingThreadCheck& threadCheck;
 };
 
 class EffectHelper::Impl
@@ -489,6 +719,7 @@ public:
 	std::unordered_map<UINT, ShaderResource> m_ShaderResources;									// 着色器资源
 	std::unordered_map<UINT, SamplerState> m_Samplers;											// 采样器
 	std::unordered_map<UINT, RWResource> m_RWResources;											// 可读写资源
+	RecordingThreadCheck m_ThreadCheck;															// 一次录制中只能由一个线程使用
 
 	std::unordered_map<std::string, std::shared_ptr<VertexShaderInfo>> m_VertexShaders;			// 顶点着色器
 	std::unordered_map<std::string, std::shared_ptr<HullShaderInfo>> m_HullShaders;				// 外壳着色器
@@ -498,6 +729,28 @@ public:
 	std::unordered_map<std::string, std::shared_ptr<ComputeShaderInfo>> m_ComputeShaders;		// 计算着色器												
 };
 
+//
+// EffectStateCache
+//
+
+void EffectStateCache::Invalidate(ID3D11DeviceContext* deviceContext)
+{
+	DeviceContextState::Get(deviceContext).Invalidate();
+}
+
+void EffectStateCache::Release(ID3D11DeviceContext* deviceContext)
+{
+	DeviceContextState::Release(deviceContext);
+}
+
+void EffectStateCache::BeginCommandList(ID3D11DeviceContext* deviceContext)
+{
+	DeviceContextState& state = DeviceContextState::Get(deviceContext);
+	state.Invalidate();
+	if (state.pArena)
+		state.pArena->Reset();
+}
+
 //
 // EffectHelper::Impl
 //
@@ -814,7 +1067,7 @@ HRESULT EffectHelper::AddEffectPass(const LPCSTR effectPassName, ID3D11Device* d
 		return ERROR_OBJECT_NAME_EXISTS;
 
 	auto pEffectPass = m_pImpl->m_EffectPasses[effectPassName] = 
-		std::make_shared<EffectPass>(m_pImpl->m_CBuffers, m_pImpl->m_ShaderResources, m_pImpl->m_Samplers, m_pImpl->m_RWResources);
+		std::make_shared<EffectPass>(m_pImpl->m_CBuffers, m_pImpl->m_ShaderResources, m_pImpl->m_Samplers, m_pImpl->m_RWResources, m_pImpl->m_ThreadCheck);
 
 	EFFECTHELPER_EFFECTPASS_SET_SHADER_AND_PARAM(VertexShader, VS);
 	EFFECTHELPER_EFFECTPASS_SET_SHADER_AND_PARAM(DomainShader, DS);
@@ -822,6 +1075,13 @@ HRESULT EffectHelper::AddEffectPass(const LPCSTR effectPassName, ID3D11Device* d
 	EFFECTHELPER_EFFECTPASS_SET_SHADER_AND_PARAM(GeometryShader, GS);
 	EFFECTHELPER_EFFECTPASS_SET_SHADER_AND_PARAM(PixelShader, PS);
 	EFFECTHELPER_EFFECTPASS_SET_SHADER_AND_PARAM(ComputeShader, CS);
+
+	// 常量缓冲区池回绕后Apply需要重新写入本通道用到的所有常量缓冲区,它们必须能同时放入池中
+	if (pEffectPass->GetArenaByteWidth() > ConstantBufferArena::DefaultByteWidth)
+	{
+		m_pImpl->m_EffectPasses.erase(effectPassName);
+		return E_INVALIDARG;
+	}
 		
 	return S_OK;
 }
@@ -843,6 +1103,38 @@ std::shared_ptr<IEffectConstantBufferVariable> EffectHelper::GetConstantBufferVa
 	return nullptr;
 }
 
+EffectVariableHandle EffectHelper::GetConstantBufferVariableHandle(const LPCSTR name) const
+{
+	const auto it = m_pImpl->m_ConstantBufferVariables.find(name);
+	if (it != m_pImpl->m_ConstantBufferVariables.end())
+		return it->second->GetHandle();
+
+	return {};
+}
+
+EffectShaderResourceHandle EffectHelper::GetShaderResourceHandle(const LPCSTR name) const
+{
+	// unordered_map的元素地址在插入其他元素后保持不变
+	auto it = std::find_if(m_pImpl->m_ShaderResources.begin(), m_pImpl->m_ShaderResources.end(),
+		[name](const std::pair<UINT, ShaderResource>& p) {
+			return p.second.name == name;
+		});
+	if (it != m_pImpl->m_ShaderResources.end())
+		return { &it->second.pSRV };
+	return {};
+}
+
+EffectSamplerStateHandle EffectHelper::GetSamplerStateHandle(const LPCSTR name) const
+{
+	auto it = std::find_if(m_pImpl->m_Samplers.begin(), m_pImpl->m_Samplers.end(),
+		[name](const std::pair<UINT, SamplerState>& p) {
+			return p.second.name == name;
+		});
+	if (it != m_pImpl->m_Samplers.end())
+		return { &it->second.pSS };
+	return {};
+}
+
 void EffectHelper::SetSamplerStateBySlot(const UINT slot, ID3D11SamplerState* samplerState) const
 {
 	auto it = m_pImpl->m_Samplers.find(slot);
@@ -1004,8 +1296,104 @@ std::shared_ptr<IEffectConstantBufferVariable> EffectPass::CSGetParamByName(LPCS
 	return nullptr;
 }
 
-void EffectPass::Apply(ID3D11DeviceContext* deviceContext)
+EffectVariableHandle EffectPass::VSGetParamHandle(LPCSTR paramName)
+{
+	if (pVSInfo)
+	{
+		auto it = pVSInfo->params.find(paramName);
+		if (it != pVSInfo->params.end())
+			return { pVSParamData->pData.get() + it->second->startByteOffset, &pVSParamData->isDirty, it->second->byteWidth };
+	}
+	return {};
+}
+
+EffectVariableHandle EffectPass::DSGetParamHandle(LPCSTR paramName)
+{
+	if (pDSInfo)
+	{
+		auto it = pDSInfo->params.find(paramName);
+		if (it != pDSInfo->params.end())
+			return { pDSParamData->pData.get() + it->second->startByteOffset, &pDSParamData->isDirty, it->second->byteWidth };
+	}
+	return {};
+}
+
+EffectVariableHandle EffectPass::HSGetParamHandle(LPCSTR paramName)
 {
+	if (pHSInfo)
+	{
+		auto it = pHSInfo->params.find(paramName);
+		if (it != pHSInfo->params.end())
+			return { pHSParamData->pData.get() + it->second->startByteOffset, &pHSParamData->isDirty, it->second->byteWidth };
+	}
+	return {};
+}
+
+EffectVariableHandle EffectPass::GSGetParamHandle(LPCSTR paramName)
+{
+	if (pGSInfo)
+	{
+		auto it = pGSInfo->params.find(paramName);
+		if (it != pGSInfo->params.end())
+			return { pGSParamData->pData.get() + it->second->startByteOffset, &pGSParamData->isDirty, it->second->byteWidth };
+	}
+	return {};
+}
+
+EffectVariableHandle EffectPass::PSGetParamHandle(LPCSTR paramName)
+{
+	if (pPSInfo)
+	{
+		auto it = pPSInfo->params.find(paramName);
+		if (it != pPSInfo->params.end())
+			return { pPSParamData->pData.get() + it->second->startByteOffset, &pPSParamData->isDirty, it->second->byteWidth };
+	}
+	return {};
+}
+
+EffectVariableHandle EffectPass::CSGetParamHandle(LPCSTR paramName)
+{
+	if (pCSInfo)
+	{
+		auto it = pCSInfo->params.find(paramName);
+		if (it != pCSInfo->params.end())
+			return { pCSParamData->pData.get() + it->second->startByteOffset, &pCSParamData->isDirty, it->second->byteWidth };
+	}
+	return {};
+}
+
+UINT EffectPass::Apply(ID3D11DeviceContext* deviceContext)
+{
+	// 特效的暂存数据不区分设备上下文,多个录制任务需要各自使用不同的特效对象
+	if (!threadCheck.Acquire())
+		throw std::exception("An effect must not be applied from two threads within one CommandListRecorder::Record!");
+
+	DeviceContextState& state = DeviceContextState::Get(deviceContext);
+	UINT elided = 0;
+
+	//
+	// 使用常量缓冲区池时先写入所有用到的常量缓冲区再绑定
+	// 写入过程中池回绕会使之前写入的位置失效,此时需要重新写入一次
+	// 回绕后池中只有本通道的数据,AddEffectPass保证它们能同时放入池中,重新写入时不会再回绕
+	//
+	if (state.pArena)
+	{
+		for (UINT attempt = 0; ; ++attempt)
+		{
+			const UINT generation = state.pArena->GetGeneration();
+			EFFECTPASS_UPLOAD_CONSTANTBUFFER(VS);
+			EFFECTPASS_UPLOAD_CONSTANTBUFFER(DS);
+			EFFECTPASS_UPLOAD_CONSTANTBUFFER(HS);
+			EFFECTPASS_UPLOAD_CONSTANTBUFFER(GS);
+			EFFECTPASS_UPLOAD_CONSTANTBUFFER(PS);
+			EFFECTPASS_UPLOAD_CONSTANTBUFFER(CS);
+			if (generation == state.pArena->GetGeneration())
+				break;
+			if (attempt > 0)
+				throw std::exception("The constant buffers of the effect pass do not fit in the constant buffer arena!");
+		}
+	}
+
 	//
 	// 设置着色器、常量缓冲区、形参常量缓冲区、采样器、着色器资源、可读写资源
 	//
@@ -1019,7 +1407,7 @@ void EffectPass::Apply(ID3D11DeviceContext* deviceContext)
 	}
 	else
 	{
-		deviceContext->VSSetShader(nullptr, nullptr, 0);
+		EFFECTPASS_CLEAR_SHADER(VS);
 	}
 	
 	if (pDSInfo)
@@ -1032,7 +1420,7 @@ void EffectPass::Apply(ID3D11DeviceContext* deviceContext)
 	}
 	else
 	{
-		deviceContext->DSSetShader(nullptr, nullptr, 0);
+		EFFECTPASS_CLEAR_SHADER(DS);
 	}
 
 	if (pHSInfo)
@@ -1045,7 +1433,7 @@ void EffectPass::Apply(ID3D11DeviceContext* deviceContext)
 	}
 	else
 	{
-		deviceContext->HSSetShader(nullptr, nullptr, 0);
+		EFFECTPASS_CLEAR_SHADER(HS);
 	}
 
 	if (pGSInfo)
@@ -1058,7 +1446,7 @@ void EffectPass::Apply(ID3D11DeviceContext* deviceContext)
 	}
 	else
 	{
-		deviceContext->GSSetShader(nullptr, nullptr, 0);
+		EFFECTPASS_CLEAR_SHADER(GS);
 	}
 	
 	if (pPSInfo)
@@ -1081,7 +1469,7 @@ void EffectPass::Apply(ID3D11DeviceContext* deviceContext)
 	}
 	else
 	{
-		deviceContext->PSSetShader(nullptr, nullptr, 0);
+		EFFECTPASS_CLEAR_SHADER(PS);
 	}
 	
 	if (pCSInfo)
@@ -1103,11 +1491,43 @@ void EffectPass::Apply(ID3D11DeviceContext* deviceContext)
 	}
 	else
 	{
-		deviceContext->CSSetShader(nullptr, nullptr, 0);
+		EFFECTPASS_CLEAR_SHADER(CS);
 	}
 
 	// 设置渲染状态
-	deviceContext->RSSetState(pRasterizerState.Get());
-	deviceContext->OMSetBlendState(pBlendState.Get(), blendFactor, sampleMask);
-	deviceContext->OMSetDepthStencilState(pDepthStencilState.Get(), stencilRef);
+	if (state.bindings.SetRasterizerState(pRasterizerState.Get()))
+		deviceContext->RSSetState(pRasterizerState.Get());
+	else
+		++elided;
+
+	if (state.bindings.SetBlendState(pBlendState.Get(), blendFactor, sampleMask))
+		deviceContext->OMSetBlendState(pBlendState.Get(), blendFactor, sampleMask);
+	else
+		++elided;
+
+	if (state.bindings.SetDepthStencilState(pDepthStencilState.Get(), stencilRef))
+		deviceContext->OMSetDepthStencilState(pDepthStencilState.Get(), stencilRef);
+	else
+		++elided;
+
+	return elided;
+}
+
+UINT EffectPass::GetArenaByteWidth() const
+{
+	UINT cbUseMask = 0;
+	UINT byteWidth = 0;
+	EFFECTPASS_ADD_ARENA_BYTEWIDTH(VS);
+	EFFECTPASS_ADD_ARENA_BYTEWIDTH(DS);
+	EFFECTPASS_ADD_ARENA_BYTEWIDTH(HS);
+	EFFECTPASS_ADD_ARENA_BYTEWIDTH(GS);
+	EFFECTPASS_ADD_ARENA_BYTEWIDTH(PS);
+	EFFECTPASS_ADD_ARENA_BYTEWIDTH(CS);
+
+	for (UINT slot = 0; cbUseMask; ++slot, cbUseMask >>= 1)
+	{
+		if (cbUseMask & 1)
+			byteWidth += ConstantBufferAllocator::GetAlignedByteWidth(cBuffers.at(slot).byteWidth);
+	}
+	return byteWidth;
 }
@@ -33,6 +33,8 @@
 
 #include "LightHelper.h"
 #include "RenderStates.h"
+#include "EffectDrawParameters.h"
+#include "EffectVariableHandle.h"
 
 // 若类需要内存对齐，从该类派生
 template<typename DerivedType>
@@ -191,10 +193,11 @@ struct EffectPassDesc
 	LPCSTR nameCS = nullptr;
 };
 
-class IEffect
+class IEffect : public IEffectDrawParameters
 {
 public:
-	enum class RenderType { RenderObject, RenderInstance };
+	// RenderCompactInstance: 实例数据只有世界矩阵的前三列(GameObject::CompactInstancedData)
+	enum class RenderType { RenderObject, RenderInstance, RenderCompactInstance };
 	
 	template <typename T>
 	using ComPtr = Microsoft::WRL::ComPtr<T>;
@@ -301,6 +304,24 @@ struct IEffectConstantBufferVariable
 	virtual HRESULT GetRaw(void* pOutput, UINT byteOffset = 0, UINT byteCount = 0xFFFFFFFF) = 0;
 };
 
+// 着色器资源的句柄,直接指向EffectHelper中对应槽的存储
+struct EffectShaderResourceHandle
+{
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>* pSRV = nullptr;
+
+	bool IsValid() const { return pSRV != nullptr; }
+	void Set(ID3D11ShaderResourceView* srv) const { if (pSRV) *pSRV = srv; }
+};
+
+// 采样器状态的句柄,直接指向EffectHelper中对应槽的存储
+struct EffectSamplerStateHandle
+{
+	Microsoft::WRL::ComPtr<ID3D11SamplerState>* pSS = nullptr;
+
+	bool IsValid() const { return pSS != nullptr; }
+	void Set(ID3D11SamplerState* samplerState) const { if (pSS) *pSS = samplerState; }
+};
+
 // 渲染通道
 // 非COM组件
 struct IEffectPass
@@ -333,8 +354,38 @@ struct IEffectPass
 	virtual std::shared_ptr<IEffectConstantBufferVariable> PSGetParamByName(LPCSTR paramName) = 0;
 	// 获取计算着色器的uniform形参用于设置值
 	virtual std::shared_ptr<IEffectConstantBufferVariable> CSGetParamByName(LPCSTR paramName) = 0;
+	// 获取uniform形参的句柄,初始化时解析一次,之后设置值不会分配内存
+	// 找不到时返回无效的句柄
+	virtual EffectVariableHandle VSGetParamHandle(LPCSTR paramName) = 0;
+	virtual EffectVariableHandle DSGetParamHandle(LPCSTR paramName) = 0;
+	virtual EffectVariableHandle HSGetParamHandle(LPCSTR paramName) = 0;
+	virtual EffectVariableHandle GSGetParamHandle(LPCSTR paramName) = 0;
+	virtual EffectVariableHandle PSGetParamHandle(LPCSTR paramName) = 0;
+	virtual EffectVariableHandle CSGetParamHandle(LPCSTR paramName) = 0;
 	// 应用着色器、常量缓冲区(包括函数形参)、采样器、着色器资源和可读写资源到渲染管线
-	virtual void Apply(ID3D11DeviceContext* deviceContext) = 0;
+	// 与设备上下文当前状态相同的部分不会重复设置,返回因此省略的D3D调用次数
+	virtual UINT Apply(ID3D11DeviceContext* deviceContext) = 0;
+};
+
+// 设备上下文的状态缓存
+// EffectPass::Apply只在着色器、常量缓冲区、采样器、着色器资源与渲染状态发生变化时才调用D3D
+// 以下情况之后需要调用Invalidate,否则缓存与实际状态不一致:
+// 1. 绕过EffectPass直接修改了这些状态(例如Dear ImGui、Direct2D、MinimapEffect)
+// 2. 资源被绑定为渲染目标或深度模板,运行时自动解除了它作为着色器资源的绑定
+// 3. 设备上下文的状态被重置(ClearState,或不保留状态的FinishCommandList/ExecuteCommandList)
+// 缓存持有记录的对象的引用,对象释放后地址被新对象复用时不会被误认为已经绑定
+// 状态缓存与常量缓冲区池按设备上下文区分,不同线程可以同时在各自的延迟上下文上录制,
+// 但同一个特效对象同一时间只能在一个线程中使用,一次CommandListRecorder::Record中被第二个线程使用时EffectPass::Apply抛出异常
+class EffectStateCache
+{
+public:
+	static void Invalidate(ID3D11DeviceContext* deviceContext);
+	// 延迟上下文开始录制新的命令列表前调用
+	// 除了使缓存失效外,常量缓冲区池也从头开始,命令列表中对动态资源的第一次映射必须是WRITE_DISCARD
+	static void BeginCommandList(ID3D11DeviceContext* deviceContext);
+	// 设备上下文销毁前调用,释放状态缓存持有的设备上下文、绑定对象的引用与常量缓冲区池
+	// 必须在设备销毁之前完成,之后再使用该设备上下文会重新创建状态
+	static void Release(ID3D11DeviceContext* deviceContext);
 };
 
 // 特效助理
@@ -377,6 +428,11 @@ public:
 
 	// 获取常量缓冲区的变量用于设置值
 	std::shared_ptr<IEffectConstantBufferVariable> GetConstantBufferVariable(LPCSTR name) const;
+	// 获取常量缓冲区变量的句柄,每帧都要设置的变量应在初始化时获取句柄
+	EffectVariableHandle GetConstantBufferVariableHandle(LPCSTR name) const;
+	// 按名获取着色器资源/采样器状态的句柄(若存在同槽多名称则返回第一个匹配的槽)
+	EffectShaderResourceHandle GetShaderResourceHandle(LPCSTR name) const;
+	EffectSamplerStateHandle GetSamplerStateHandle(LPCSTR name) const;
 
 	// 按槽设置采样器状态
 	void SetSamplerStateBySlot(UINT slot, ID3D11SamplerState* samplerState) const;
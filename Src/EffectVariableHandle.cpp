@@ -0,0 +1,27 @@
+#include "EffectVariableHandle.h"
+
+#include <cstring>
+
+using namespace DirectX;
+
+void EffectVariableHandle::SetRaw(const void* data, const UINT byteOffset, UINT byteCount) const
+{
+	if (!pData || byteOffset > byteWidth)
+		return;
+	if (byteCount > byteWidth - byteOffset)
+		byteCount = byteWidth - byteOffset;
+
+	// 仅当值不同时更新
+	if (std::memcmp(pData + byteOffset, data, byteCount) != 0)
+	{
+		std::memcpy(pData + byteOffset, data, byteCount);
+		*pIsDirty = true;
+	}
+}
+
+void XM_CALLCONV EffectVariableHandle::SetMatrix(FXMMATRIX matrix) const
+{
+	XMFLOAT4X4 data;
+	XMStoreFloat4x4(&data, matrix);
+	SetRaw(&data, 0, sizeof(data));
+}
@@ -0,0 +1,37 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 常量缓冲区变量的句柄
+// 初始化时按名称解析一次,之后直接写入常量缓冲区的暂存数据,不再查找字符串也不分配内存
+// 不依赖D3D,EffectHelper与单元测试共用同一份实现
+// Resolve-once handle that writes straight into a constant buffer's staging memory.
+//***************************************************************************************
+
+#ifndef EFFECTVARIABLEHANDLE_H
+#define EFFECTVARIABLEHANDLE_H
+
+#include "PortableTypes.h"
+
+#include <algorithm>
+#include <DirectXMath.h>
+
+// 可以随意拷贝,在所属的EffectHelper(或EffectPass)被清空或销毁之前有效
+struct EffectVariableHandle
+{
+	BYTE* pData = nullptr;					// 变量在暂存数据中的起始地址
+	BOOL* pIsDirty = nullptr;				// 所属常量缓冲区的脏标记,值改变时置为TRUE
+	UINT byteWidth = 0;
+
+	bool IsValid() const { return pData != nullptr; }
+
+	// 仅当值不同时写入,超出变量大小的部分被截断
+	void SetRaw(const void* data, UINT byteOffset = 0, UINT byteCount = 0xFFFFFFFF) const;
+	void SetUInt(UINT val) const { SetRaw(&val, 0, sizeof(val)); }
+	void SetSInt(INT val) const { SetRaw(&val, 0, sizeof(val)); }
+	void SetFloat(float val) const { SetRaw(&val, 0, sizeof(val)); }
+	void SetFloatVector(UINT numComponents, const float data[4]) const { SetRaw(data, 0, (std::min)(numComponents, 4u) * sizeof(float)); }
+	// 写入完整的4x4矩阵,需要的话由调用者转置
+	void XM_CALLCONV SetMatrix(DirectX::FXMMATRIX matrix) const;
+};
+
+#endif
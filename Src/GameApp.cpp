@@ -8,7 +8,25 @@ GameApp::GameApp(HINSTANCE hInstance)
 	D3DApp(hInstance),
 	m_enableDebug(true),
 	m_grayMode(true),
+	m_drawBounds(false),
+	m_enableDeferredContexts(false),
+	m_enableStaticBatching(false),
 	m_slopeIndex(),
+	m_playerCullStatistics(),
+	m_instanceBuffer(sizeof(GameObject::CompactInstancedData)),
+	m_visibleCylinderRange(),
+	m_visibleSphereRange(),
+	m_shadowCylinderRange(),
+	m_shadowSphereRange(),
+	m_normalMapObjectPipeline(),
+	m_normalMapInstancePipeline(),
+	m_shadowObjectPipeline(),
+	m_shadowInstancePipeline(),
+	m_mainQueueStatistics(),
+	m_shadowQueueStatistics(),
+	m_groundSource(),
+	m_cylinderSourceBase(),
+	m_sphereSourceBase(),
 	m_dirLights{},
 	m_originalLightDirs{},
 	m_pBasicEffect(std::make_unique<BasicEffect>()),
@@ -337,6 +355,9 @@ void GameApp::UpdateScene(const float dt)
 	// 投影区域为正方体，以原点为中心，以方向光为+Z朝向
 	const XMMATRIX lightView = XMMatrixLookAtLH(XMLoadFloat3(&m_dirLights[0].direction) * 20.0f * -2.0f, g_XMZero, g_XMIdentityR1);
 	m_pShadowEffect->SetViewMatrix(lightView);
+	m_renderQueue.SetViewMatrix(SHADOW_PASS, lightView);
+	m_shadowCulling.SetLightVolume(lightView, ShadowLightVolume.width, ShadowLightVolume.height, ShadowLightVolume.nearZ, ShadowLightVolume.farZ);
+	m_shadowCulling.SetCameraFrustum(m_pCamera->GetViewMatrix(), m_pCamera->GetProjMatrix());
 
 	// 将NDC空间 [-1, +1]^2 变换到纹理坐标空间 [0, 1]^2
 	static XMMATRIX transform
@@ -347,11 +368,32 @@ void GameApp::UpdateScene(const float dt)
 		0.5f, 0.5f, 0.0f, 1.0f
 	);
 	// S = V * P * T
-	m_pBasicEffect->SetShadowTransformMatrix(lightView * XMMatrixOrthographicLH(100.0f, 100.0f, 0.0f, 100.0f) * transform);
+	m_pBasicEffect->SetShadowTransformMatrix(lightView * GetShadowProjMatrix() * transform);
+
+	// 遮挡剔除
+	CullScene();
 
 	// 重置滚轮值
 	m_pMouse->ResetScrollWheelValue();
 	
+	// 切换包围盒线框的绘制
+	if (m_keyboardTracker.IsKeyPressed(Keyboard::Keys::B))
+	{
+		m_drawBounds = !m_drawBounds;
+	}
+
+	// 切换多线程录制,创建延迟上下文失败时保持单线程绘制
+	if (m_keyboardTracker.IsKeyPressed(Keyboard::Keys::M) && m_commandListRecorder.GetContextCount() > 0)
+	{
+		m_enableDeferredContexts = !m_enableDeferredContexts;
+	}
+
+	// 切换静态合批与实例化绘制
+	if (m_keyboardTracker.IsKeyPressed(Keyboard::Keys::N))
+	{
+		m_enableStaticBatching = !m_enableStaticBatching;
+	}
+
 	// 退出程序，这里应向窗口发送销毁信息
 	if (m_keyboardTracker.IsKeyPressed(Keyboard::Keys::ESCAPE))
 	{
@@ -372,48 +414,70 @@ void GameApp::DrawScene()
 
 	m_pd3dImmediateContext->ClearRenderTargetView(m_pRenderTargetView.Get(), Colors::Silver);
 	m_pd3dImmediateContext->ClearDepthStencilView(m_pDepthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	
-	// ******************
-	// 绘制到阴影贴图
-	//
-	m_pShadowMap->Begin(m_pd3dImmediateContext.Get(), nullptr);
-	{
-		DrawScene(m_pShadowEffect.get());
-	}
-	m_pShadowMap->End(m_pd3dImmediateContext.Get());
-
-	// ******************
-	// 正常绘制场景
-	//
-	m_pBasicEffect->SetTextureShadowMap(m_pShadowMap->GetOutputTexture());
-	DrawScene(m_pBasicEffect.get());
-	
-	// 绘制天空盒
-	m_pSkyEffect->SetRenderDefault(m_pd3dImmediateContext.Get());
-	m_pDaylight->Draw(m_pd3dImmediateContext.Get(), *m_pSkyEffect, *m_pCamera);
 
-	// 解除深度缓冲区绑定
-	m_pBasicEffect->SetTextureShadowMap(nullptr);
-	m_pBasicEffect->Apply(m_pd3dImmediateContext.Get());
+	// 上一帧末尾的Direct2D与Dear ImGui绕过了特效的状态缓存
+	EffectStateCache::Invalidate(m_pd3dImmediateContext.Get());
 
-	// ******************
-	// 调试绘制阴影贴图
-	//
-	if (m_enableDebug)
+	m_renderQueue.Clear();
+	m_renderQueue.SetViewMatrix(MAIN_PASS, m_pCamera->GetViewMatrix());
+	if (m_enableStaticBatching)
 	{
-		if (m_grayMode)
+		// 剔除得到的实例索引转换为静态合批的来源编号,地面总是可见
+		// 绘制范围在录制之前生成,各Pass只读取它们
+		const auto collectSources = [this](const std::vector<UINT>& cylinderIndices, const std::vector<UINT>& sphereIndices, std::vector<UINT>& outSources)
 		{
-			m_pDebugEffect->SetRenderOneComponentGray(m_pd3dImmediateContext.Get(), 0);
-		}
-		else
-		{
-			m_pDebugEffect->SetRenderOneComponent(m_pd3dImmediateContext.Get(), 0);
-		}
+			outSources.assign(1, m_groundSource);
+			for (const UINT index : cylinderIndices)
+				outSources.push_back(m_cylinderSourceBase + index);
+			for (const UINT index : sphereIndices)
+				outSources.push_back(m_sphereSourceBase + index);
+		};
+		collectSources(m_shadowCylinderIndices, m_shadowSphereIndices, m_shadowStaticSources);
+		collectSources(m_visibleCylinderIndices, m_visibleSphereIndices, m_visibleStaticSources);
+		m_staticBatch.BuildDrawRanges(m_shadowStaticSources, m_shadowStaticRanges);
+		m_staticBatch.BuildDrawRanges(m_visibleStaticSources, m_mainStaticRanges);
+	}
+	else
+	{
+		// 本帧所有的实例数据一次性追加到共享的实例缓冲区,两个Pass直接引用
+		m_instanceBuffer.BeginFrame();
+		m_shadowCylinderRange = GameObject::UploadInstances(m_pd3dImmediateContext.Get(), m_instanceBuffer, m_cylinderInstances, m_shadowCylinderIndices);
+		m_shadowSphereRange = GameObject::UploadInstances(m_pd3dImmediateContext.Get(), m_instanceBuffer, m_sphereInstances, m_shadowSphereIndices);
+		m_visibleCylinderRange = GameObject::UploadInstances(m_pd3dImmediateContext.Get(), m_instanceBuffer, m_cylinderInstances, m_visibleCylinderIndices);
+		m_visibleSphereRange = GameObject::UploadInstances(m_pd3dImmediateContext.Get(), m_instanceBuffer, m_sphereInstances, m_visibleSphereIndices);
+
+		// 地面、石柱与石球提交到渲染队列,按状态排序后在各自的Pass中执行
+		m_ground.Submit(m_renderQueue, SHADOW_PASS, m_shadowObjectPipeline);
+		m_cylinder.SubmitInstanced(m_renderQueue, SHADOW_PASS, m_shadowInstancePipeline, m_shadowCylinderRange);
+		m_sphere.SubmitInstanced(m_renderQueue, SHADOW_PASS, m_shadowInstancePipeline, m_shadowSphereRange);
+		m_ground.Submit(m_renderQueue, MAIN_PASS, m_normalMapObjectPipeline);
+		m_cylinder.SubmitInstanced(m_renderQueue, MAIN_PASS, m_normalMapInstancePipeline, m_visibleCylinderRange);
+		m_sphere.SubmitInstanced(m_renderQueue, MAIN_PASS, m_normalMapInstancePipeline, m_visibleSphereRange);
+	}
+	m_renderQueue.Sort();
 
-		m_debugQuad.Draw(m_pd3dImmediateContext.Get(), m_pDebugEffect.get());
-		// 解除绑定
-		m_pDebugEffect->SetTextureDiffuse(nullptr);
-		m_pDebugEffect->Apply(m_pd3dImmediateContext.Get());
+	// 玩家的世界矩阵与层次包围盒在两个Pass之前更新一次,之后两个Pass的剔除绘制只读取它们
+	// 剔除状态保存在每次Cull调用自己的数组中,阴影Pass与主Pass可以在不同线程同时剔除
+	m_player.UpdateBounds();
+
+	if (m_enableDeferredContexts)
+	{
+		// 三个Pass在各自的延迟上下文上并行录制,再按顺序执行
+		m_commandListRecorder.Record({
+			[this](ID3D11DeviceContext* deviceContext) { DrawShadowPass(deviceContext); },
+			[this](ID3D11DeviceContext* deviceContext) { DrawMainPass(deviceContext); },
+			[this](ID3D11DeviceContext* deviceContext) { DrawSkyAndDebugPass(deviceContext); } });
+		m_commandListRecorder.Execute(m_pd3dImmediateContext.Get());
+
+		// 命令列表执行后立即上下文的状态被清空,Dear ImGui需要绑定后备缓冲区
+		m_pd3dImmediateContext->OMSetRenderTargets(1, m_pRenderTargetView.GetAddressOf(), m_pDepthStencilView.Get());
+		m_pd3dImmediateContext->RSSetViewports(1, &m_screenViewport);
+	}
+	else
+	{
+		DrawShadowPass(m_pd3dImmediateContext.Get());
+		DrawMainPass(m_pd3dImmediateContext.Get());
+		DrawSkyAndDebugPass(m_pd3dImmediateContext.Get());
 	}
 	
 	// 绘制Direct2D部分
@@ -441,7 +505,26 @@ void GameApp::DrawScene()
 				text += L"\n(按左CTRL以切换对IMGUI和摄像机的控制)";
 			}
 		}
-		text += L"\n(主键盘8在第一人称和自由视角间切换,主键盘9切换第三人称)\n";
+		text += L"\n(主键盘8在第一人称和自由视角间切换,主键盘9切换第三人称,B切换包围盒线框,M切换多线程录制,N切换静态合批)\n";
+		text += m_enableDeferredContexts ? L"当前录制: 延迟上下文(多线程)\n" : L"当前录制: 立即上下文\n";
+		text += m_enableStaticBatching ? L"静态物体: 静态合批\n" : L"静态物体: 实例化\n";
+		if (m_drawBounds)
+		{
+			text += L"玩家层次剔除: 测试" + std::to_wstring(m_playerCullStatistics.testedNodes) +
+				L" 完全可见" + std::to_wstring(m_playerCullStatistics.acceptedNodes) +
+				L" 剔除" + std::to_wstring(m_playerCullStatistics.culledNodes) + L"\n";
+			text += L"渲染队列: 绘制包" + std::to_wstring(m_mainQueueStatistics.packetCount + m_shadowQueueStatistics.packetCount) +
+				L" 管线切换" + std::to_wstring(m_mainQueueStatistics.pipelineChanges + m_shadowQueueStatistics.pipelineChanges) +
+				L" 纹理切换" + std::to_wstring(m_mainQueueStatistics.textureSetChanges + m_shadowQueueStatistics.textureSetChanges) +
+				L" 材质切换" + std::to_wstring(m_mainQueueStatistics.materialChanges + m_shadowQueueStatistics.materialChanges) + L"\n";
+			if (m_enableStaticBatching)
+			{
+				text += L"静态合批: 批次" + std::to_wstring(m_staticBatch.GetBatchCount()) +
+					L" 来源" + std::to_wstring(m_staticBatch.GetSourceCount()) +
+					L" 主Pass绘制" + std::to_wstring(m_mainStaticRanges.size()) + L"/" + std::to_wstring(m_visibleStaticSources.size()) +
+					L" 阴影绘制" + std::to_wstring(m_shadowStaticRanges.size()) + L"/" + std::to_wstring(m_shadowStaticSources.size()) + L"\n";
+			}
+		}
 
 		m_pd2dRenderTarget->DrawTextW(text.c_str(), static_cast<UINT32>(text.length()), m_pTextFormat.Get(),
 			D2D1_RECT_F{ 0.0f, 0.0f, 600.0f, 200.0f }, m_pColorBrush.Get());
@@ -454,42 +537,179 @@ void GameApp::DrawScene()
 	HR(m_pSwapChain->Present(0, 0));
 }
 
-void GameApp::DrawScene(BasicEffect* pBasicEffect)
+void GameApp::DrawShadowPass(ID3D11DeviceContext* deviceContext)
 {
-	// 地面
-	pBasicEffect->SetRenderWithNormalMap(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderObject);
-	m_ground.Draw(m_pd3dImmediateContext.Get(), pBasicEffect);
+	// ******************
+	// 绘制到阴影贴图
+	//
+	m_pShadowMap->Begin(deviceContext, nullptr);
+	{
+		DrawScene(deviceContext, m_pShadowEffect.get());
+	}
+	m_pShadowMap->End(deviceContext);
+}
+
+void GameApp::DrawMainPass(ID3D11DeviceContext* deviceContext)
+{
+	// 延迟上下文不继承立即上下文的渲染目标与视口
+	deviceContext->OMSetRenderTargets(1, m_pRenderTargetView.GetAddressOf(), m_pDepthStencilView.Get());
+	deviceContext->RSSetViewports(1, &m_screenViewport);
+
+	// ******************
+	// 正常绘制场景
+	//
+	m_pBasicEffect->SetTextureShadowMap(m_pShadowMap->GetOutputTexture());
+	DrawScene(deviceContext, m_pBasicEffect.get());
+
+	// 解除深度缓冲区绑定
+	m_pBasicEffect->SetTextureShadowMap(nullptr);
+	m_pBasicEffect->Apply(deviceContext);
+}
 
-	// 石柱
-	pBasicEffect->SetRenderWithNormalMap(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderInstance);
-	m_cylinder.DrawInstanced(m_pd3dImmediateContext.Get(), pBasicEffect, m_cylinderTransforms);
+void GameApp::DrawSkyAndDebugPass(ID3D11DeviceContext* deviceContext)
+{
+	deviceContext->OMSetRenderTargets(1, m_pRenderTargetView.GetAddressOf(), m_pDepthStencilView.Get());
+	deviceContext->RSSetViewports(1, &m_screenViewport);
 
-	// 石球
-	pBasicEffect->SetRenderWithNormalMap(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderInstance);
-	m_sphere.DrawInstanced(m_pd3dImmediateContext.Get(), pBasicEffect, m_sphereTransforms);
+	// 绘制天空盒
+	m_pSkyEffect->SetRenderDefault(deviceContext);
+	m_pDaylight->Draw(deviceContext, *m_pSkyEffect, *m_pCamera);
+
+	// ******************
+	// 调试绘制包围盒线框
+	//
+	if (m_drawBounds)
+	{
+		m_debugDraw.AddOrientedBox(Bounds::ToBoundingOrientedBox(m_shadowCulling.GetLightVolume()), XMFLOAT4(1.0f, 1.0f, 0.0f, 1.0f));
+
+		m_pDebugEffect->SetViewMatrix(m_pCamera->GetViewMatrix());
+		m_pDebugEffect->SetProjMatrix(m_pCamera->GetProjMatrix());
+		m_pDebugEffect->SetRenderLine(deviceContext);
+		m_debugDraw.Flush(deviceContext, m_pDebugEffect.get());
+		m_pDebugEffect->SetViewMatrix(XMMatrixIdentity());
+		m_pDebugEffect->SetProjMatrix(XMMatrixIdentity());
+	}
+
+	// ******************
+	// 调试绘制阴影贴图
+	//
+	if (m_enableDebug)
+	{
+		if (m_grayMode)
+		{
+			m_pDebugEffect->SetRenderOneComponentGray(deviceContext, 0);
+		}
+		else
+		{
+			m_pDebugEffect->SetRenderOneComponent(deviceContext, 0);
+		}
+
+		m_debugQuad.Draw(deviceContext, m_pDebugEffect.get());
+		// 解除绑定
+		m_pDebugEffect->SetTextureDiffuse(nullptr);
+		m_pDebugEffect->Apply(deviceContext);
+	}
+}
+
+void GameApp::DrawScene(ID3D11DeviceContext* deviceContext, BasicEffect* pBasicEffect)
+{
+	// 地面、石柱与石球
+	D3D11RenderBackend backend(deviceContext);
+	m_mainQueueStatistics = m_renderQueue.Execute(backend, MAIN_PASS);
+	if (m_enableStaticBatching)
+	{
+		pBasicEffect->SetRenderWithNormalMap(deviceContext, IEffect::RenderType::RenderObject);
+		m_staticBatch.Draw(backend, pBasicEffect, m_mainStaticRanges);
+	}
 	
-	// 玩家
-	pBasicEffect->SetRenderDefault(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderObject);
-	m_player.Draw(m_pd3dImmediateContext.Get(), pBasicEffect);
+	// 玩家,以层次包围盒对摄像机视锥体剔除
+	BoundingFrustum frustum;
+	BoundingFrustum::CreateFromMatrix(frustum, m_pCamera->GetProjMatrix());
+	frustum.Transform(frustum, XMMatrixInverse(nullptr, m_pCamera->GetViewMatrix()));
+	m_playerCullStatistics = {};
+
+	pBasicEffect->SetRenderDefault(deviceContext, IEffect::RenderType::RenderObject);
+	m_player.Draw(backend, pBasicEffect, frustum, &m_playerCullStatistics);
 }
 
-void GameApp::DrawScene(ShadowEffect* pShadowEffect)
+void GameApp::DrawScene(ID3D11DeviceContext* deviceContext, ShadowEffect* pShadowEffect)
 {
-	// 地面
-	pShadowEffect->SetRenderDefault(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderObject);
-	m_ground.Draw(m_pd3dImmediateContext.Get(), pShadowEffect);
+	// 地面、石柱与石球
+	D3D11RenderBackend backend(deviceContext);
+	m_shadowQueueStatistics = m_renderQueue.Execute(backend, SHADOW_PASS);
+	if (m_enableStaticBatching)
+	{
+		pShadowEffect->SetRenderDefault(deviceContext, IEffect::RenderType::RenderObject);
+		m_staticBatch.Draw(backend, pShadowEffect, m_shadowStaticRanges);
+	}
 
-	// 石柱
-	pShadowEffect->SetRenderDefault(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderInstance);
-	m_cylinder.DrawInstanced(m_pd3dImmediateContext.Get(), pShadowEffect, m_cylinderTransforms);
+	// 玩家,以层次包围盒对光源投影体剔除
+	pShadowEffect->SetRenderDefault(deviceContext, IEffect::RenderType::RenderObject);
+	m_player.Draw(backend, pShadowEffect, Bounds::ToBoundingOrientedBox(m_shadowCulling.GetLightVolume()), nullptr);
+}
 
-	// 石球
-	pShadowEffect->SetRenderDefault(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderInstance);
-	m_sphere.DrawInstanced(m_pd3dImmediateContext.Get(), pShadowEffect, m_sphereTransforms);
+void GameApp::CullScene()
+{
+	const XMMATRIX viewProj = m_pCamera->GetViewProjMatrix();
 
-	// 玩家
-	pShadowEffect->SetRenderDefault(m_pd3dImmediateContext.Get(), IEffect::RenderType::RenderObject);
-	m_player.Draw(m_pd3dImmediateContext.Get(), pShadowEffect);
+	// 静态实例的视锥体剔除,包围体已预先变换到世界空间
+	const std::vector<UINT>& cylinderIndices = m_cylinderCulling.Cull(viewProj);
+	const std::vector<UINT>& sphereIndices = m_sphereCulling.Cull(viewProj);
+
+	// 只有视锥体内的石柱才作为遮挡物
+	m_occlusionCulling.BeginFrame(viewProj);
+	for (const UINT index : cylinderIndices)
+	{
+		m_occlusionCulling.RasterizeOccluder(m_cylinderOccluders[index]);
+	}
+	m_occlusionCulling.BuildHiZ();
+
+	// 调试线框: 可见的为绿色,被遮挡的为红色
+	const XMFLOAT4 visibleColor(0.0f, 1.0f, 0.0f, 1.0f);
+	const XMFLOAT4 occludedColor(1.0f, 0.0f, 0.0f, 1.0f);
+	m_debugDraw.Clear();
+
+	m_visibleCylinderIndices.clear();
+	for (const UINT index : cylinderIndices)
+	{
+		const BoundingBox box = Bounds::ToBoundingBox(m_cylinderCulling.GetWorldBox(index));
+		const bool isVisible = m_occlusionCulling.IsVisible(box);
+		if (isVisible)
+			m_visibleCylinderIndices.push_back(index);
+		if (m_drawBounds)
+			m_debugDraw.AddBox(box, isVisible ? visibleColor : occludedColor);
+	}
+
+	m_visibleSphereIndices.clear();
+	for (const UINT index : sphereIndices)
+	{
+		const BoundingBox box = Bounds::ToBoundingBox(m_sphereCulling.GetWorldBox(index));
+		const bool isVisible = m_occlusionCulling.IsVisible(box);
+		if (isVisible)
+			m_visibleSphereIndices.push_back(index);
+		if (m_drawBounds)
+			m_debugDraw.AddSphere(Bounds::ToBoundingSphere(m_sphereCulling.GetWorldSphere(index)), isVisible ? visibleColor : occludedColor);
+	}
+
+	// 阴影投射者不受摄像机视锥体限制,需要测试全部实例
+	m_shadowCylinderIndices.clear();
+	for (UINT i = 0; i < m_cylinderCulling.GetInstanceCount(); ++i)
+	{
+		if (m_shadowCulling.IsCasterVisible(m_cylinderCulling.GetWorldBox(i)))
+			m_shadowCylinderIndices.push_back(i);
+	}
+
+	m_shadowSphereIndices.clear();
+	for (UINT i = 0; i < m_sphereCulling.GetInstanceCount(); ++i)
+	{
+		if (m_shadowCulling.IsCasterVisible(m_sphereCulling.GetWorldBox(i)))
+			m_shadowSphereIndices.push_back(i);
+	}
+}
+
+XMMATRIX GameApp::GetShadowProjMatrix()
+{
+	return XMMatrixOrthographicLH(ShadowLightVolume.width, ShadowLightVolume.height, ShadowLightVolume.nearZ, ShadowLightVolume.farZ);
 }
 
 bool GameApp::InitResource()
@@ -533,11 +753,33 @@ bool GameApp::InitResource()
 	m_pBasicEffect->SetViewMatrix(camera->GetViewMatrix());
 	m_pBasicEffect->SetProjMatrix(camera->GetProjMatrix());
 
-	m_pShadowEffect->SetProjMatrix(XMMatrixOrthographicLH(100.0f, 100.0f, 0.0f, 100.0f));
+	m_pShadowEffect->SetProjMatrix(GetShadowProjMatrix());
 
 	m_pDebugEffect->SetWorldMatrix(XMMatrixIdentity());
 	m_pDebugEffect->SetViewMatrix(XMMatrixIdentity());
 	m_pDebugEffect->SetProjMatrix(XMMatrixIdentity());
+
+	HR(m_debugDraw.InitResource(m_pd3dDevice.Get()));
+	HR(m_instanceBuffer.InitResource(m_pd3dDevice.Get()));
+
+	// 阴影、主Pass、天空盒与调试绘制各使用一个延迟上下文
+	// 驱动不支持时运行时会模拟命令列表,仍然可以切换,只是不一定更快
+	if (SUCCEEDED(m_commandListRecorder.InitResource(m_pd3dDevice.Get(), 3)))
+	{
+		m_enableDeferredContexts = CommandListRecorder::IsDriverCommandListSupported(m_pd3dDevice.Get());
+	}
+
+	// 渲染队列使用的管线状态
+	BasicEffect* pBasicEffect = m_pBasicEffect.get();
+	ShadowEffect* pShadowEffect = m_pShadowEffect.get();
+	m_normalMapObjectPipeline = m_renderQueue.RegisterPipeline(pBasicEffect, MakeRenderState(
+		[pBasicEffect](ID3D11DeviceContext* deviceContext) { pBasicEffect->SetRenderWithNormalMap(deviceContext, IEffect::RenderType::RenderObject); }));
+	m_normalMapInstancePipeline = m_renderQueue.RegisterPipeline(pBasicEffect, MakeRenderState(
+		[pBasicEffect](ID3D11DeviceContext* deviceContext) { pBasicEffect->SetRenderWithNormalMap(deviceContext, IEffect::RenderType::RenderCompactInstance); }));
+	m_shadowObjectPipeline = m_renderQueue.RegisterPipeline(pShadowEffect, MakeRenderState(
+		[pShadowEffect](ID3D11DeviceContext* deviceContext) { pShadowEffect->SetRenderDefault(deviceContext, IEffect::RenderType::RenderObject); }));
+	m_shadowInstancePipeline = m_renderQueue.RegisterPipeline(pShadowEffect, MakeRenderState(
+		[pShadowEffect](ID3D11DeviceContext* deviceContext) { pShadowEffect->SetRenderDefault(deviceContext, IEffect::RenderType::RenderCompactInstance); }));
 	
 	// ******************
 	// 初始化对象
@@ -546,9 +788,14 @@ bool GameApp::InitResource()
 	m_player.Init(m_pd3dDevice.Get());
 	m_player.SetPosition({ 0.0f, 0.6f, -20.0f });
 
+	// 地面、球体与柱体的网格数据在静态合批时还要使用
+	const StaticBatch::MeshData groundMesh = Geometry::CreatePlane<VertexPosNormalTangentTex>(XMFLOAT2(100.0f, 100.0f), XMFLOAT2(6.0f, 9.0f));
+	const StaticBatch::MeshData sphereMesh = Geometry::CreateSphere<VertexPosNormalTangentTex>(3.0f, 30, 30);
+	const StaticBatch::MeshData cylinderMesh = Geometry::CreateCylinder<VertexPosNormalTangentTex>(0.75f, 3.0f);
+
 	 // 地面
 	{
-		Model ground(m_pd3dDevice.Get(), Geometry::CreatePlane<VertexPosNormalTangentTex>(XMFLOAT2(100.0f, 100.0f), XMFLOAT2(6.0f, 9.0f)));
+		Model ground(m_pd3dDevice.Get(), groundMesh);
 		ModelPart& modelPart = ground.modelParts.front();
 		modelPart.material.ambient = XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f);
 		modelPart.material.diffuse = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -573,7 +820,7 @@ bool GameApp::InitResource()
 	}
 	// 球体
 	{
-		Model sphere(m_pd3dDevice.Get(), Geometry::CreateSphere<VertexPosNormalTangentTex>(3.0f, 30, 30));
+		Model sphere(m_pd3dDevice.Get(), sphereMesh);
 		ModelPart& modelPart = sphere.modelParts.front();
 		modelPart.material.ambient = XMFLOAT4(0.8f, 0.8f, 0.8f, 1.0f);
 		modelPart.material.diffuse = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -598,7 +845,7 @@ bool GameApp::InitResource()
 	}
 	// 柱体
 	{
-		Model cylinder(m_pd3dDevice.Get(), Geometry::CreateCylinder<VertexPosNormalTangentTex>(0.75f, 3.0f));
+		Model cylinder(m_pd3dDevice.Get(), cylinderMesh);
 		ModelPart& modelPart = cylinder.modelParts.front();
 		modelPart.material.ambient = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
 		modelPart.material.diffuse = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -623,8 +870,16 @@ bool GameApp::InitResource()
 	}
 	// 柱子和球的位置
 	{
-		m_sphereTransforms.resize(90);
-		m_cylinderTransforms.resize(90);
+		// 先按顺序创建全部实例,使实例在连续数组中的位置与剔除缓存的索引一致
+		std::vector<TransformStore::Handle> sphereHandles(90);
+		std::vector<TransformStore::Handle> cylinderHandles(90);
+		m_sphereTransforms.Reserve(90);
+		m_cylinderTransforms.Reserve(90);
+		for (size_t i = 0; i < 90; ++i)
+		{
+			sphereHandles[i] = m_sphereTransforms.Create(XMFLOAT3(0.35f, 0.35f, 0.35f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), XMFLOAT3());
+			cylinderHandles[i] = m_cylinderTransforms.Create(XMFLOAT3(0.35f, 1.0f, 0.35f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), XMFLOAT3());
+		}
 
 		// 前10个离得太近了,我们跳过
 		for(int i = 0; i < 45; ++i)
@@ -633,17 +888,59 @@ bool GameApp::InitResource()
 			const float x = (5 + (50.f - j) * 0.4f) * (2 * sinf(XM_PI * j / 50) - sinf(XM_2PI * j / 50));
 			const float z = 12 + 15 * (2 * cosf(XM_PI * j / 50) - cosf(XM_2PI * j / 50));
 
-			m_sphereTransforms[i].SetPosition(x, 5.51f, z);
-			m_sphereTransforms[i].SetScale(0.35f, 0.35f, 0.35f);
-			m_sphereTransforms[static_cast<size_t>(89) - i].SetPosition(-x, 5.51f, z);
-			m_sphereTransforms[static_cast<size_t>(89) - i].SetScale(0.35f, 0.35f, 0.35f);
+			m_sphereTransforms.SetPosition(sphereHandles[i], XMFLOAT3(x, 5.51f, z));
+			m_sphereTransforms.SetPosition(sphereHandles[static_cast<size_t>(89) - i], XMFLOAT3(-x, 5.51f, z));
 
-			m_cylinderTransforms[i].SetPosition(x, 0.51f, z);
-			m_cylinderTransforms[i].SetScale(0.35f, 1.0f, 0.35f);
-			m_cylinderTransforms[static_cast<size_t>(89) - i].SetPosition(-x, 0.51f, z);
-			m_cylinderTransforms[static_cast<size_t>(89) - i].SetScale(0.35f, 1.0f, 0.35f);
+			m_cylinderTransforms.SetPosition(cylinderHandles[i], XMFLOAT3(x, 0.51f, z));
+			m_cylinderTransforms.SetPosition(cylinderHandles[static_cast<size_t>(89) - i], XMFLOAT3(-x, 0.51f, z));
+		}
+		m_sphereTransforms.UpdateWorldMatrices();
+		m_cylinderTransforms.UpdateWorldMatrices();
+
+		// 实例数据只计算一次,使用紧凑格式,法线变换由着色器完成
+		for (const XMFLOAT4X4& world : m_sphereTransforms.GetWorldMatrices())
+			m_sphereInstances.push_back(GameObject::CreateCompactInstancedData(XMLoadFloat4x4(&world)));
+		for (const XMFLOAT4X4& world : m_cylinderTransforms.GetWorldMatrices())
+			m_cylinderInstances.push_back(GameObject::CreateCompactInstancedData(XMLoadFloat4x4(&world)));
+
+		// 柱子和球都是静态的,预先计算世界空间包围体
+		m_cylinderCulling.Build(m_cylinder.GetLocalBoundingBox(), m_cylinderTransforms.GetWorldMatrices());
+		m_sphereCulling.Build(m_sphere.GetLocalBoundingBox(), m_sphereTransforms.GetWorldMatrices());
+
+		// 石柱内接的长方体作为遮挡物,保证遮挡物不会超出石柱本身
+		BoundingBox innerBox = m_cylinder.GetLocalBoundingBox();
+		innerBox.Extents.x *= 0.7071f;
+		innerBox.Extents.z *= 0.7071f;
+		BoundingOrientedBox localOccluder;
+		BoundingOrientedBox::CreateFromBoundingBox(localOccluder, innerBox);
+
+		const std::vector<XMFLOAT4X4>& cylinderWorlds = m_cylinderTransforms.GetWorldMatrices();
+		m_cylinderOccluders.resize(cylinderWorlds.size());
+		for (size_t i = 0; i < cylinderWorlds.size(); ++i)
+		{
+			localOccluder.Transform(m_cylinderOccluders[i], XMLoadFloat4x4(&cylinderWorlds[i]));
 		}
 	}
+	// 静态合批
+	{
+		StaticBatch::Builder staticBatchBuilder;
+		const ModelPart& groundPart = m_ground.GetModel().modelParts.front();
+		m_groundSource = m_staticBatch.Add(staticBatchBuilder, groundMesh, groundPart.material, groundPart.texDiffuse.Get(), groundPart.texNormalMap.Get(),
+			m_ground.GetTransform().GetLocalToWorldMatrix());
+
+		// 每个实例作为一个来源,编号与剔除缓存中的实例索引一一对应
+		const auto addInstances = [this, &staticBatchBuilder](const StaticBatch::MeshData& meshData, const ModelPart& part, const std::vector<XMFLOAT4X4>& worlds)
+		{
+			const UINT firstSource = static_cast<UINT>(staticBatchBuilder.GetSources().size());
+			for (const XMFLOAT4X4& world : worlds)
+				m_staticBatch.Add(staticBatchBuilder, meshData, part.material, part.texDiffuse.Get(), part.texNormalMap.Get(), XMLoadFloat4x4(&world));
+			return firstSource;
+		};
+		m_cylinderSourceBase = addInstances(cylinderMesh, m_cylinder.GetModel().modelParts.front(), m_cylinderTransforms.GetWorldMatrices());
+		m_sphereSourceBase = addInstances(sphereMesh, m_sphere.GetModel().modelParts.front(), m_sphereTransforms.GetWorldMatrices());
+
+		HR(m_staticBatch.InitResource(m_pd3dDevice.Get(), std::move(staticBatchBuilder)));
+	}
 
 	// 调试用矩形
 	Model quadModel;
@@ -684,8 +981,12 @@ bool GameApp::InitResource()
 	m_cylinder.SetDebugObjectName("Cylinder");
 	m_sphere.SetDebugObjectName("Sphere");
 	m_debugQuad.SetDebugObjectName("DebugQuad");
+	m_debugDraw.SetDebugObjectName("DebugDraw");
+	m_instanceBuffer.SetDebugObjectName("SceneInstances");
+	m_staticBatch.SetDebugObjectName("StaticScene");
 	m_pShadowMap->SetDebugObjectName("ShadowMap");
 	m_pDaylight->SetDebugObjectName("DayLight");
+	m_commandListRecorder.SetDebugObjectName("Scene");
 	
 	return true;
 }
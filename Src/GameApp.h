@@ -7,15 +7,24 @@
 
 #include "Camera.h"
 #include "Player.h"
+#include "OcclusionCulling.h"
+#include "CullingCache.h"
+#include "ShadowCulling.h"
+#include "DebugDraw.h"
+#include "TransformStore.h"
+#include "StaticBatch.h"
 
 #include "Effect.h"
 #include "Render.h"
+#include "CommandListRecorder.h"
 
 class GameApp final : public D3DApp
 {
 public:
 	// 摄像机模式
 	enum class CameraMode { FIRST_PERSON, THIRD_PERSON, FREE };
+	// 渲染队列中的Pass,阴影贴图先于主Pass绘制
+	enum RenderPass : UINT { SHADOW_PASS, MAIN_PASS };
 	
 	explicit GameApp(HINSTANCE hInstance);
 	~GameApp();
@@ -31,9 +40,28 @@ public:
 	void DrawScene() override;
 	
 private:
-	void DrawScene(BasicEffect* pBasicEffect);
-	void DrawScene(ShadowEffect* pShadowEffect);
+	void DrawScene(ID3D11DeviceContext* deviceContext, BasicEffect* pBasicEffect);
+	void DrawScene(ID3D11DeviceContext* deviceContext, ShadowEffect* pShadowEffect);
+	// 各Pass的绘制,可以直接在立即上下文上执行,也可以在各自的延迟上下文上并行录制
+	// 三个Pass使用的特效与修改的成员互不相同
+	void DrawShadowPass(ID3D11DeviceContext* deviceContext);
+	void DrawMainPass(ID3D11DeviceContext* deviceContext);
+	void DrawSkyAndDebugPass(ID3D11DeviceContext* deviceContext);
+	// 视锥体剔除、软件遮挡剔除与阴影投射者剔除,得到本帧需要绘制的实例
+	void CullScene();
 	bool InitResource();
+
+	// 光源观察空间中以原点为中心的正交投影体
+	// 阴影贴图的投影、阴影变换与阴影投射者剔除都由它得到
+	struct LightVolume
+	{
+		float width;
+		float height;
+		float nearZ;
+		float farZ;
+	};
+	static constexpr LightVolume ShadowLightVolume = { 100.0f, 100.0f, 0.0f, 100.0f };
+	static DirectX::XMMATRIX XM_CALLCONV GetShadowProjMatrix();
 	
 	ComPtr<ID2D1SolidColorBrush> m_pColorBrush;				    // 单色笔刷
 	ComPtr<IDWriteFont> m_pFont;								// 字体
@@ -41,18 +69,63 @@ private:
 
 	bool m_enableDebug;											// 开启调试模式
 	bool m_grayMode;											// 深度值以灰度形式显示
+	bool m_drawBounds;											// 绘制包围盒线框
+	bool m_enableDeferredContexts;								// 在延迟上下文上并行录制各Pass
+	bool m_enableStaticBatching;								// 地面、圆柱体与球以静态合批绘制
 	int m_slopeIndex;											// 斜率索引
 	
 	Player m_player;											// 玩家
+	GameObject::CullStatistics m_playerCullStatistics;			// 玩家层次剔除的统计信息
 	
 	GameObject m_ground;										// 地面
 	
 	GameObject m_cylinder;									    // 圆柱体
-	std::vector<BasicTransform> m_cylinderTransforms;			// 圆柱体变换信息
+	TransformStore m_cylinderTransforms;						// 圆柱体变换信息
 	GameObject m_sphere;										// 球
-	std::vector<BasicTransform> m_sphereTransforms;				// 球体变换信息
+	TransformStore m_sphereTransforms;							// 球体变换信息
+
+	CullingCache m_cylinderCulling;								// 圆柱体视锥体剔除缓存
+	CullingCache m_sphereCulling;								// 球体视锥体剔除缓存
+	std::vector<DirectX::BoundingOrientedBox> m_cylinderOccluders;	// 圆柱体内接的遮挡物
+
+	OcclusionCulling m_occlusionCulling;						// 软件遮挡剔除
+	std::vector<UINT> m_visibleCylinderIndices;					// 未被遮挡的圆柱体
+	std::vector<UINT> m_visibleSphereIndices;					// 未被遮挡的球体
+
+	ShadowCulling m_shadowCulling;								// 阴影投射者剔除
+	std::vector<UINT> m_shadowCylinderIndices;					// 需要投射阴影的圆柱体
+	std::vector<UINT> m_shadowSphereIndices;					// 需要投射阴影的球体
+
+	// 柱子和球都是静态的,实例数据只计算一次,每帧只需要按索引复制到共享的实例缓冲区
+	std::vector<GameObject::CompactInstancedData> m_cylinderInstances;
+	std::vector<GameObject::CompactInstancedData> m_sphereInstances;
+	InstanceBuffer m_instanceBuffer;							// 阴影与主Pass共享的实例缓冲区
+	InstanceBuffer::Range m_visibleCylinderRange;
+	InstanceBuffer::Range m_visibleSphereRange;
+	InstanceBuffer::Range m_shadowCylinderRange;
+	InstanceBuffer::Range m_shadowSphereRange;
+
+	RenderQueue m_renderQueue;									// 地面、圆柱体与球的排序渲染队列
+	UINT m_normalMapObjectPipeline;								// 法线贴图,普通绘制
+	UINT m_normalMapInstancePipeline;							// 法线贴图,紧凑实例
+	UINT m_shadowObjectPipeline;								// 阴影,普通绘制
+	UINT m_shadowInstancePipeline;								// 阴影,紧凑实例
+	RenderQueue::Statistics m_mainQueueStatistics;				// 主Pass执行渲染队列的统计信息
+	RenderQueue::Statistics m_shadowQueueStatistics;			// 阴影Pass执行渲染队列的统计信息
+
+	// 地面、圆柱体与球都不会移动,预先变换到世界空间并按材质合并到共享的顶点/索引缓冲区
+	// 可见性仍然来自上面的剔除结果,相邻的可见来源合并为一次绘制
+	StaticBatch m_staticBatch;
+	UINT m_groundSource;										// 地面在静态合批中的来源编号
+	UINT m_cylinderSourceBase;									// 第一个圆柱体的来源编号,之后按实例顺序连续编号
+	UINT m_sphereSourceBase;									// 第一个球的来源编号
+	std::vector<UINT> m_visibleStaticSources;					// 主Pass可见的来源
+	std::vector<UINT> m_shadowStaticSources;					// 需要投射阴影的来源
+	std::vector<StaticBatch::DrawRange> m_mainStaticRanges;		// 主Pass的绘制范围
+	std::vector<StaticBatch::DrawRange> m_shadowStaticRanges;	// 阴影Pass的绘制范围
 
 	GameObject m_debugQuad;										// 调试用四边形
+	DebugDraw m_debugDraw;										// 调试用线框
 
 	DirectionalLight m_dirLights[3];							// 方向光
 	DirectX::XMFLOAT3 m_originalLightDirs[3];					// 初始光方向
@@ -64,6 +137,8 @@ private:
 
 	std::unique_ptr<TextureRender> m_pShadowMap;				// 阴影贴图
 	std::unique_ptr<SkyRender> m_pDaylight;						// 天空盒(白天)
+
+	CommandListRecorder m_commandListRecorder;					// 阴影、主Pass、天空盒与调试绘制的命令列表录制
 	
 	std::shared_ptr<Camera> m_pCamera;						    // 摄像机
 
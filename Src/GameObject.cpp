@@ -5,6 +5,12 @@ using namespace DirectX;
 void GameObject::AddChild(GameObject* child)
 {
 	m_children.insert(child);
+	m_hierarchyBounds.isDirty = true;
+}
+
+const std::set<GameObject*>& GameObject::GetChildren() const
+{
+	return m_children;
 }
 
 BasicTransform& GameObject::GetTransform()
@@ -22,6 +28,11 @@ BoundingBox GameObject::GetLocalBoundingBox() const
 	return m_model.boundingBox;
 }
 
+bool GameObject::HasLocalBoundingBox() const
+{
+	return !m_model.modelParts.empty();
+}
+
 BoundingBox GameObject::GetBoundingBox() const
 {
 	BoundingBox box;
@@ -37,6 +48,16 @@ BoundingOrientedBox GameObject::GetBoundingOrientedBox() const
 	return box;
 }
 
+void GameObject::UpdateBounds()
+{
+	HierarchyCulling<GameObject>::UpdateBounds(*this, XMMatrixIdentity(), XMMatrixIdentity());
+}
+
+const BoundingBox& GameObject::GetSubtreeBoundingBox() const
+{
+	return m_hierarchyBounds.subtreeBox;
+}
+
 size_t GameObject::GetCapacity() const
 {
 	return m_capacity;
@@ -63,74 +84,123 @@ void GameObject::SetModel(Model&& model)
 	std::swap(m_model, model);
 	model.modelParts.clear();
 	model.boundingBox = BoundingBox();
+	m_hierarchyBounds.isDirty = true;
 }
 
 void GameObject::SetModel(const Model& model)
 {
 	m_model = model;
+	m_hierarchyBounds.isDirty = true;
+}
+
+const Model& GameObject::GetModel() const
+{
+	return m_model;
 }
 
 void GameObject::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect)
 {
-	Draw(deviceContext, effect, XMMatrixIdentity(), XMMatrixIdentity());
+	D3D11RenderBackend backend(deviceContext);
+	Draw(backend, effect);
+}
+
+void GameObject::Draw(IRenderBackend& backend, IEffect* effect)
+{
+	Draw(backend, effect, XMMatrixIdentity(), XMMatrixIdentity());
+}
+
+void GameObject::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingFrustum& frustum, CullStatistics* pStatistics)
+{
+	D3D11RenderBackend backend(deviceContext);
+	Draw(backend, effect, frustum, pStatistics);
+}
+
+void GameObject::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingOrientedBox& volume, CullStatistics* pStatistics)
+{
+	D3D11RenderBackend backend(deviceContext);
+	Draw(backend, effect, volume, pStatistics);
+}
+
+void GameObject::Draw(IRenderBackend& backend, IEffect* effect, const BoundingFrustum& frustum, CullStatistics* pStatistics)
+{
+	DrawCulled(backend, effect, frustum, pStatistics);
+}
+
+void GameObject::Draw(IRenderBackend& backend, IEffect* effect, const BoundingOrientedBox& volume, CullStatistics* pStatistics)
+{
+	DrawCulled(backend, effect, volume, pStatistics);
 }
 
 void GameObject::DrawInstanced(ID3D11DeviceContext* deviceContext, IEffect* effect, const std::vector<BasicTransform>& data)
 {
-	D3D11_MAPPED_SUBRESOURCE mappedData;
+	// 没有需要绘制的实例(例如全部被剔除)
+	if (data.empty())
+		return;
+
 	const UINT numInstances = static_cast<UINT>(data.size());
-	// 若传入的数据比实例缓冲区还大，需要重新分配
-	if (numInstances > m_capacity)
+	auto* iter = MapInstancedBuffer(deviceContext, numInstances);
+	for (auto& transform : data)
 	{
-		ComPtr<ID3D11Device> device;
-		deviceContext->GetDevice(device.GetAddressOf());
-		ResizeBuffer(device.Get(), numInstances);
+		*iter = CreateInstancedData(transform.GetLocalToWorldMatrix());
+		++iter;
 	}
+	deviceContext->Unmap(m_pInstancedBuffer.Get(), 0);
 
-	HR(deviceContext->Map(m_pInstancedBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData));
+	D3D11RenderBackend backend(deviceContext);
+	DrawInstancedParts(backend, effect, ToRenderBuffer(m_pInstancedBuffer.Get()), sizeof(InstancedData), 0, numInstances);
+}
 
-	auto* iter = reinterpret_cast<InstancedData*>(mappedData.pData);
-	for (auto& transform : data)
+void GameObject::DrawInstanced(ID3D11DeviceContext* deviceContext, IEffect* effect, const std::vector<XMFLOAT4X4>& worldMatrices)
+{
+	// 没有需要绘制的实例(例如全部被剔除)
+	if (worldMatrices.empty())
+		return;
+
+	const UINT numInstances = static_cast<UINT>(worldMatrices.size());
+	auto* iter = MapInstancedBuffer(deviceContext, numInstances);
+	for (auto& worldMatrix : worldMatrices)
 	{
-		const XMMATRIX world = transform.GetLocalToWorldMatrix();
-		iter->world = XMMatrixTranspose(world);
-		iter->worldInvTranspose = XMMatrixTranspose(InverseTranspose(world));	
+		*iter = CreateInstancedData(XMLoadFloat4x4(&worldMatrix));
 		++iter;
 	}
-
 	deviceContext->Unmap(m_pInstancedBuffer.Get(), 0);
 
-	UINT strides[2] = { m_model.vertexStride, sizeof(InstancedData) };
-	UINT offsets[2] = { 0, 0 };
-	ID3D11Buffer* buffers[2] = { nullptr, m_pInstancedBuffer.Get() };
-	for (auto& part : m_model.modelParts)
-	{
-		buffers[0] = part.vertexBuffer.Get();
-
-		// 设置顶点/索引缓冲区
-		deviceContext->IASetVertexBuffers(0, 2, buffers, strides, offsets);
-		deviceContext->IASetIndexBuffer(part.indexBuffer.Get(), part.indexFormat, 0);
-
-		// 更新数据并应用
-		const auto* pBasicEffect = dynamic_cast<BasicEffect*>(effect);
-		if (pBasicEffect)
-		{
-			pBasicEffect->SetTextureNormalMap(part.texNormalMap.Get());
-			pBasicEffect->SetMaterial(part.material);
-			pBasicEffect->SetTextureDiffuse(part.texDiffuse.Get());
-		}
-		else
-		{
-			auto* pEffectTextureDiffuse = dynamic_cast<IEffectTextureDiffuse*>(effect);
-			if (pEffectTextureDiffuse)
-			{
-				pEffectTextureDiffuse->SetTextureDiffuse(part.texDiffuse.Get());
-			}
-		}
-		effect->Apply(deviceContext);
-
-		deviceContext->DrawIndexedInstanced(part.indexCount, numInstances, 0, 0, 0);
-	}
+	D3D11RenderBackend backend(deviceContext);
+	DrawInstancedParts(backend, effect, ToRenderBuffer(m_pInstancedBuffer.Get()), sizeof(InstancedData), 0, numInstances);
+}
+
+void GameObject::DrawInstanced(ID3D11DeviceContext* deviceContext, IEffect* effect, const InstanceBuffer::Range& range)
+{
+	D3D11RenderBackend backend(deviceContext);
+	DrawInstanced(backend, effect, range);
+}
+
+void GameObject::DrawInstanced(IRenderBackend& backend, IEffect* effect, const InstanceBuffer::Range& range)
+{
+	if (range.count == 0)
+		return;
+
+	DrawInstancedParts(backend, effect, range.buffer, range.stride, range.offset, range.count);
+}
+
+void GameObject::Submit(RenderQueue& queue, const UINT pass, const UINT pipeline)
+{
+	Submit(queue, pass, pipeline, XMMatrixIdentity(), XMMatrixIdentity());
+}
+
+void GameObject::SubmitInstanced(RenderQueue& queue, const UINT pass, const UINT pipeline, const InstanceBuffer::Range& range) const
+{
+	queue.SubmitInstanced(pass, pipeline, m_model, { range.buffer, range.stride, range.offset, range.count });
+}
+
+GameObject::InstancedData GameObject::CreateInstancedData(FXMMATRIX world)
+{
+	return { XMMatrixTranspose(world), XMMatrixTranspose(InverseTranspose(world)) };
+}
+
+GameObject::CompactInstancedData GameObject::CreateCompactInstancedData(FXMMATRIX world)
+{
+	return ::CreateCompactInstancedData(world);
 }
 
 void GameObject::SetDebugObjectName(const std::string& name)
@@ -146,52 +216,83 @@ void GameObject::SetDebugObjectName(const std::string& name)
 #endif
 }
 
-void GameObject::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, FXMMATRIX parentScale, CXMMATRIX parentRotTraMatrix)
+void GameObject::Draw(IRenderBackend& backend, IEffect* effect, FXMMATRIX parentScale, CXMMATRIX parentRotTraMatrix)
+{
+	const XMMATRIX scale = XMMatrixScalingFromVector(m_transform.GetScaleVector());
+	const XMMATRIX rotationTranslation = m_transform.GetRotationTranslationMatrix();
+
+	DrawParts(backend, effect, scale * parentScale * rotationTranslation * parentRotTraMatrix);
+
+	// 子物体绘制
+	for(GameObject* child : m_children)
+	{
+		// 子物体的RT矩阵可以让子物体从子物体自身的局部坐标系变换到父物体的局部坐标系,然后再乘上父物体的Rotation*Translation矩阵变换到世界坐标系
+		child->Draw(backend, effect, scale * scale, rotationTranslation * parentRotTraMatrix);
+	}
+}
+
+void GameObject::Submit(RenderQueue& queue, const UINT pass, const UINT pipeline, FXMMATRIX parentScale, CXMMATRIX parentRotTraMatrix)
 {
 	const XMMATRIX scale = XMMatrixScalingFromVector(m_transform.GetScaleVector());
-	const XMMATRIX rotationTranslation = XMMatrixRotationRollPitchYawFromVector(m_transform.GetRotationVector()) * XMMatrixTranslationFromVector(m_transform.GetPositionVector());
+	const XMMATRIX rotationTranslation = m_transform.GetRotationTranslationMatrix();
+
+	queue.Submit(pass, pipeline, m_model, scale * parentScale * rotationTranslation * parentRotTraMatrix);
 
-	UINT strides = m_model.vertexStride;
-	UINT offsets = 0;
+	for (GameObject* child : m_children)
+	{
+		child->Submit(queue, pass, pipeline, scale * scale, rotationTranslation * parentRotTraMatrix);
+	}
+}
+
+void GameObject::DrawParts(ID3D11DeviceContext* deviceContext, IEffect* effect, FXMMATRIX world)
+{
+	D3D11RenderBackend backend(deviceContext);
+	DrawParts(backend, effect, world);
+}
 
+void GameObject::DrawParts(IRenderBackend& backend, IEffect* effect, FXMMATRIX world)
+{
 	for (auto& part : m_model.modelParts)
 	{
-		// 设置顶点/索引缓冲区
-		deviceContext->IASetVertexBuffers(0, 1, part.vertexBuffer.GetAddressOf(), &strides, &offsets);
-		deviceContext->IASetIndexBuffer(part.indexBuffer.Get(), part.indexFormat, 0);
-
-		const auto* pBasicEffect = dynamic_cast<BasicEffect*>(effect);
-		if (pBasicEffect)
-		{
-			pBasicEffect->SetTextureNormalMap(part.texNormalMap.Get());
-			pBasicEffect->SetMaterial(part.material);
-			pBasicEffect->SetWorldMatrix(scale * parentScale * rotationTranslation * parentRotTraMatrix);
-			pBasicEffect->SetTextureDiffuse(part.texDiffuse.Get());
-		}
-		else
-		{
-			const auto* pEffectTransform = dynamic_cast<IEffectTransform*>(effect);
-			if (pEffectTransform)
-			{
-				pEffectTransform->SetWorldMatrix(scale * parentScale * rotationTranslation * parentRotTraMatrix);
-			}
-
-			const auto* pEffectTextureDiffuse = dynamic_cast<IEffectTextureDiffuse*>(effect);
-			if (pEffectTextureDiffuse)
-			{
-				pEffectTextureDiffuse->SetTextureDiffuse(part.texDiffuse.Get());
-			}
-		}
-		
-		effect->Apply(deviceContext);
-
-		deviceContext->DrawIndexed(part.indexCount, 0, 0);
+		RenderQueue::DrawPart(backend, ToRenderEffect(effect), *effect, RenderQueue::MakePartState(m_model, part), world);
 	}
+}
 
-	// 子物体绘制
-	for(GameObject* child : m_children)
+template <typename BoundingVolume>
+void GameObject::DrawCulled(IRenderBackend& backend, IEffect* effect, const BoundingVolume& volume, CullStatistics* pStatistics)
+{
+	auto drawNode = [&backend, effect](GameObject& node, FXMMATRIX world)
 	{
-		// 子物体的RT矩阵可以让子物体从子物体自身的局部坐标系变换到父物体的局部坐标系,然后再乘上父物体的Rotation*Translation矩阵变换到世界坐标系
-		child->Draw(deviceContext, effect, scale * scale, rotationTranslation * parentRotTraMatrix);
+		node.DrawParts(backend, effect, world);
+	};
+	HierarchyCulling<GameObject>::Cull(*this, volume, false, pStatistics, drawNode);
+}
+
+HierarchyBounds& GameObject::GetHierarchyBounds()
+{
+	return m_hierarchyBounds;
+}
+
+GameObject::InstancedData* GameObject::MapInstancedBuffer(ID3D11DeviceContext* deviceContext, const UINT numInstances)
+{
+	// 若传入的数据比实例缓冲区还大，需要重新分配
+	if (numInstances > m_capacity)
+	{
+		ComPtr<ID3D11Device> device;
+		deviceContext->GetDevice(device.GetAddressOf());
+		ResizeBuffer(device.Get(), numInstances);
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedData;
+	HR(deviceContext->Map(m_pInstancedBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData));
+	return reinterpret_cast<InstancedData*>(mappedData.pData);
+}
+
+void GameObject::DrawInstancedParts(IRenderBackend& backend, IEffect* effect, RenderBuffer* instanceBuffer, const UINT instanceStride, const UINT startInstance, const UINT numInstances)
+{
+	const RenderQueue::InstanceRange range{ instanceBuffer, instanceStride, startInstance, numInstances };
+	for (auto& part : m_model.modelParts)
+	{
+		RenderQueue::DrawPartInstanced(backend, ToRenderEffect(effect), *effect, RenderQueue::MakePartState(m_model, part), range);
 	}
 }
@@ -13,6 +13,10 @@
 #include "Model.h"
 #include "BasicTransform.h"
 #include "BasicEffect.h"
+#include "InstanceBuffer.h"
+#include "CompactInstance.h"
+#include "RenderQueue.h"
+#include "HierarchyCulling.h"
 
 #include <set>
 
@@ -22,8 +26,34 @@ public:
 	template <typename T>
 	using ComPtr = Microsoft::WRL::ComPtr<T>;
 
+	// 层次剔除的统计信息,每次绘制累加,由调用者清零
+	using CullStatistics = HierarchyCullStatistics;
+
+	// 实例缓冲区中每个实例的数据
+	struct InstancedData
+	{
+		DirectX::XMMATRIX world;
+		DirectX::XMMATRIX worldInvTranspose;
+	};
+
+	// 紧凑的实例数据,只保存世界矩阵的前三列,使用RenderType::RenderCompactInstance绘制
+	using CompactInstancedData = ::CompactInstancedData;
+
+	// 由世界矩阵计算实例数据
+	static InstancedData XM_CALLCONV CreateInstancedData(DirectX::FXMMATRIX world);
+	static CompactInstancedData XM_CALLCONV CreateCompactInstancedData(DirectX::FXMMATRIX world);
+	// 将data中indices指定的实例写入共享的实例缓冲区,缓冲区的步长需要与InstanceType一致
+	template <typename InstanceType>
+	static InstanceBuffer::Range UploadInstances(ID3D11DeviceContext* deviceContext, InstanceBuffer& buffer,
+		const std::vector<InstanceType>& data, const std::vector<UINT>& indices);
+	template <typename InstanceType>
+	static InstanceBuffer::Range UploadInstances(IRenderBackend& backend, InstanceBuffer& buffer,
+		const std::vector<InstanceType>& data, const std::vector<UINT>& indices);
+
 	// 添加子对象
 	void AddChild(GameObject* child);
+	// 获取子对象
+	const std::set<GameObject*>& GetChildren() const;
 	
 	// 获取物体变换
 	BasicTransform& GetTransform();
@@ -35,9 +65,17 @@ public:
 	//
 
 	DirectX::BoundingBox GetLocalBoundingBox() const;
+	// 模型是否包含可绘制的部分,没有模型的对象只负责传递变换
+	bool HasLocalBoundingBox() const;
 	DirectX::BoundingBox GetBoundingBox() const;
 	DirectX::BoundingOrientedBox GetBoundingOrientedBox() const;
 
+	// 重新计算以该对象为根的子树的世界矩阵与包围盒
+	// 只有变换发生变化的节点及其祖先会重新合并包围盒
+	void UpdateBounds();
+	// 获取子树的世界空间包围盒,需要先调用UpdateBounds
+	const DirectX::BoundingBox& GetSubtreeBoundingBox() const;
+
 	//
 	// 设置实例缓冲区
 	//
@@ -53,15 +91,42 @@ public:
 
 	void SetModel(Model&& model);
 	void SetModel(const Model& model);
+	// 获取模型
+	const Model& GetModel() const;
 
 	//
 	// 绘制
 	//
 
 	// 绘制对象
+	// 传入设备上下文的版本直接使用D3D11RenderBackend
 	void Draw(ID3D11DeviceContext* deviceContext,IEffect* effect);
+	void Draw(IRenderBackend& backend, IEffect* effect);
+	// 绘制对象,整棵子树与包围体不相交时直接跳过,完全位于包围体内的子树不再测试
+	// 需要先调用UpdateBounds,绘制过程不修改对象,多个线程可以使用不同的特效同时绘制
+	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingFrustum& frustum, CullStatistics* pStatistics = nullptr);
+	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingOrientedBox& volume, CullStatistics* pStatistics = nullptr);
+	void Draw(IRenderBackend& backend, IEffect* effect, const DirectX::BoundingFrustum& frustum, CullStatistics* pStatistics = nullptr);
+	void Draw(IRenderBackend& backend, IEffect* effect, const DirectX::BoundingOrientedBox& volume, CullStatistics* pStatistics = nullptr);
+	// 使用给定的世界矩阵绘制自身的所有模型部分,不绘制子对象
+	void XM_CALLCONV DrawParts(ID3D11DeviceContext* deviceContext, IEffect* effect, DirectX::FXMMATRIX world);
+	void XM_CALLCONV DrawParts(IRenderBackend& backend, IEffect* effect, DirectX::FXMMATRIX world);
 	// 绘制实例
 	void DrawInstanced(ID3D11DeviceContext* deviceContext, IEffect* effect, const std::vector<BasicTransform>& data);
+	// 绘制实例,直接使用已经计算好的世界矩阵(例如TransformStore)
+	void DrawInstanced(ID3D11DeviceContext* deviceContext, IEffect* effect, const std::vector<DirectX::XMFLOAT4X4>& worldMatrices);
+	// 绘制实例,使用已经写入共享实例缓冲区的数据
+	void DrawInstanced(ID3D11DeviceContext* deviceContext, IEffect* effect, const InstanceBuffer::Range& range);
+	void DrawInstanced(IRenderBackend& backend, IEffect* effect, const InstanceBuffer::Range& range);
+
+	//
+	// 提交到渲染队列
+	//
+
+	// 提交对象及其子对象,矩阵的组合方式与Draw一致
+	void Submit(RenderQueue& queue, UINT pass, UINT pipeline);
+	// 提交实例,使用已经写入共享实例缓冲区的数据
+	void SubmitInstanced(RenderQueue& queue, UINT pass, UINT pipeline, const InstanceBuffer::Range& range) const;
 
 	//
 	// 调试 
@@ -72,13 +137,18 @@ public:
 	void SetDebugObjectName(const std::string& name);
 
 private:
-	void XM_CALLCONV Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, DirectX::FXMMATRIX parentScale, DirectX::CXMMATRIX parentRotTraMatrix);
-	
-	struct InstancedData
-	{
-		DirectX::XMMATRIX world;
-		DirectX::XMMATRIX worldInvTranspose;
-	};
+	void XM_CALLCONV Draw(IRenderBackend& backend, IEffect* effect, DirectX::FXMMATRIX parentScale, DirectX::CXMMATRIX parentRotTraMatrix);
+	void XM_CALLCONV Submit(RenderQueue& queue, UINT pass, UINT pipeline, DirectX::FXMMATRIX parentScale, DirectX::CXMMATRIX parentRotTraMatrix);
+	template <typename BoundingVolume>
+	void DrawCulled(IRenderBackend& backend, IEffect* effect, const BoundingVolume& volume, CullStatistics* pStatistics);
+
+	friend class HierarchyCulling<GameObject>;
+	HierarchyBounds& GetHierarchyBounds();
+
+	// 映射实例缓冲区,容量不足时重新分配,写入后需要Unmap
+	InstancedData* MapInstancedBuffer(ID3D11DeviceContext* deviceContext, UINT numInstances);
+	// 使用实例缓冲区中从startInstance开始的numInstances个实例绘制所有模型部分
+	void DrawInstancedParts(IRenderBackend& backend, IEffect* effect, RenderBuffer* instanceBuffer, UINT instanceStride, UINT startInstance, UINT numInstances);
 	
 	// 子对象
 	std::set<GameObject*> m_children;
@@ -88,6 +158,35 @@ private:
 
 	ComPtr<ID3D11Buffer> m_pInstancedBuffer = nullptr;				// 实例缓冲区
 	size_t m_capacity = 0;
+
+	HierarchyBounds m_hierarchyBounds;			// 层次包围盒
 };
 
+template <typename InstanceType>
+InstanceBuffer::Range GameObject::UploadInstances(ID3D11DeviceContext* deviceContext, InstanceBuffer& buffer,
+	const std::vector<InstanceType>& data, const std::vector<UINT>& indices)
+{
+	D3D11RenderBackend backend(deviceContext);
+	return UploadInstances(backend, buffer, data, indices);
+}
+
+template <typename InstanceType>
+InstanceBuffer::Range GameObject::UploadInstances(IRenderBackend& backend, InstanceBuffer& buffer,
+	const std::vector<InstanceType>& data, const std::vector<UINT>& indices)
+{
+	InstanceBuffer::Range range{};
+	if (indices.empty())
+		return range;
+
+	auto* iter = static_cast<InstanceType*>(buffer.Map(backend, static_cast<UINT>(indices.size()), &range));
+	for (const UINT index : indices)
+	{
+		*iter = data[index];
+		++iter;
+	}
+	buffer.Unmap(backend);
+
+	return range;
+}
+
 #endif
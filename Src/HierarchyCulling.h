@@ -0,0 +1,150 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 层次包围盒与层次剔除
+// 每个节点缓存世界矩阵与子树的世界空间AABB,只有发生变化的路径会重新合并
+// 剔除时整棵与包围体不相交的子树直接跳过,完全位于包围体内的子树不再测试
+// 不依赖D3D,GameObject与单元测试中的节点类型共用同一份实现
+// Cached subtree bounds and hierarchical culling for object trees.
+//***************************************************************************************
+
+#ifndef HIERARCHYCULLING_H
+#define HIERARCHYCULLING_H
+
+#include "PortableTypes.h"
+#include "BasicTransform.h"
+
+#include <DirectXCollision.h>
+
+// 层次剔除的统计信息,每次剔除累加,由调用者清零
+struct HierarchyCullStatistics
+{
+	UINT testedNodes;		// 进行包围盒测试的节点数目
+	UINT acceptedNodes;		// 完全位于包围体内,其子树不再测试的节点数目
+	UINT culledNodes;		// 被剔除的节点数目(包括被剔除子树中的所有节点)
+};
+
+// 每个节点缓存的层次包围盒
+struct HierarchyBounds
+{
+	DirectX::XMFLOAT4X4 world{};			// 上次UpdateBounds时的世界矩阵
+	DirectX::BoundingBox subtreeBox{};		// 子树的世界空间包围盒
+	UINT subtreeNodeCount = 1;				// 子树的节点数目(包括自身)
+	bool hasSubtreeBox = false;				// 子树中是否存在带包围盒的节点
+	bool isDirty = true;					// 模型或子对象发生了变化,需要重新合并
+};
+
+//
+// Node需要提供:
+//	const BasicTransform& GetTransform() const;
+//	GetChildren(),可以遍历的Node*容器
+//	bool HasLocalBoundingBox() const;			// 没有模型的节点只负责传递变换
+//	DirectX::BoundingBox GetLocalBoundingBox() const;
+//	HierarchyBounds& GetHierarchyBounds();
+//
+template <typename Node>
+class HierarchyCulling
+{
+public:
+	// 矩阵的组合方式与GameObject::Draw一致,返回子树的包围盒是否发生了变化
+	static bool XM_CALLCONV UpdateBounds(Node& node, DirectX::FXMMATRIX parentScale, DirectX::CXMMATRIX parentRotTraMatrix);
+
+	// 对每个没有被剔除的节点调用drawNode(node, world),需要先调用UpdateBounds
+	// isInside为true时表示父节点已经完全位于包围体内
+	template <typename BoundingVolume, typename DrawNode>
+	static void Cull(Node& node, const BoundingVolume& volume, bool isInside, HierarchyCullStatistics* pStatistics, DrawNode& drawNode);
+};
+
+template <typename Node>
+bool HierarchyCulling<Node>::UpdateBounds(Node& node, DirectX::FXMMATRIX parentScale, DirectX::CXMMATRIX parentRotTraMatrix)
+{
+	using namespace DirectX;
+
+	HierarchyBounds& bounds = node.GetHierarchyBounds();
+	const BasicTransform& transform = node.GetTransform();
+	const XMMATRIX scale = XMMatrixScalingFromVector(transform.GetScaleVector());
+	const XMMATRIX rotationTranslation = transform.GetRotationTranslationMatrix();
+	const XMMATRIX world = scale * parentScale * rotationTranslation * parentRotTraMatrix;
+
+	const XMMATRIX lastWorld = XMLoadFloat4x4(&bounds.world);
+	bool isChanged = bounds.isDirty ||
+		!XMVector4Equal(world.r[0], lastWorld.r[0]) || !XMVector4Equal(world.r[1], lastWorld.r[1]) ||
+		!XMVector4Equal(world.r[2], lastWorld.r[2]) || !XMVector4Equal(world.r[3], lastWorld.r[3]);
+	if (isChanged)
+		XMStoreFloat4x4(&bounds.world, world);
+	bounds.isDirty = false;
+
+	UINT nodeCount = 1;
+	const XMMATRIX childScale = scale * scale;
+	const XMMATRIX childRotTraMatrix = rotationTranslation * parentRotTraMatrix;
+	for (Node* child : node.GetChildren())
+	{
+		// 即使已经确定发生变化,也需要更新子对象
+		isChanged |= UpdateBounds(*child, childScale, childRotTraMatrix);
+		nodeCount += child->GetHierarchyBounds().subtreeNodeCount;
+	}
+
+	if (!isChanged)
+		return false;
+
+	bounds.subtreeNodeCount = nodeCount;
+	bounds.hasSubtreeBox = node.HasLocalBoundingBox();
+	if (bounds.hasSubtreeBox)
+		node.GetLocalBoundingBox().Transform(bounds.subtreeBox, world);
+
+	for (Node* child : node.GetChildren())
+	{
+		const HierarchyBounds& childBounds = child->GetHierarchyBounds();
+		if (!childBounds.hasSubtreeBox)
+			continue;
+
+		if (bounds.hasSubtreeBox)
+		{
+			BoundingBox::CreateMerged(bounds.subtreeBox, bounds.subtreeBox, childBounds.subtreeBox);
+		}
+		else
+		{
+			bounds.subtreeBox = childBounds.subtreeBox;
+			bounds.hasSubtreeBox = true;
+		}
+	}
+
+	return true;
+}
+
+template <typename Node>
+template <typename BoundingVolume, typename DrawNode>
+void HierarchyCulling<Node>::Cull(Node& node, const BoundingVolume& volume, bool isInside, HierarchyCullStatistics* pStatistics, DrawNode& drawNode)
+{
+	using namespace DirectX;
+
+	HierarchyBounds& bounds = node.GetHierarchyBounds();
+
+	// 父节点已经完全位于包围体内时不再测试
+	if (!isInside && bounds.hasSubtreeBox)
+	{
+		if (pStatistics)
+			++pStatistics->testedNodes;
+
+		const ContainmentType containment = volume.Contains(bounds.subtreeBox);
+		if (containment == DISJOINT)
+		{
+			if (pStatistics)
+				pStatistics->culledNodes += bounds.subtreeNodeCount;
+			return;
+		}
+
+		isInside = containment == CONTAINS;
+		if (isInside && pStatistics)
+			++pStatistics->acceptedNodes;
+	}
+
+	drawNode(node, XMLoadFloat4x4(&bounds.world));
+
+	for (Node* child : node.GetChildren())
+	{
+		Cull(*child, volume, isInside, pStatistics, drawNode);
+	}
+}
+
+#endif
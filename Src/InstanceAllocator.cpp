@@ -0,0 +1,50 @@
+#include "InstanceAllocator.h"
+
+#include <algorithm>
+
+InstanceAllocator::InstanceAllocator(const UINT capacity)
+	:
+	m_capacity(capacity),
+	m_head(0),
+	m_isFrameStart(true)
+{
+}
+
+void InstanceAllocator::BeginFrame()
+{
+	m_head = 0;
+	m_isFrameStart = true;
+}
+
+InstanceAllocator::Allocation InstanceAllocator::Allocate(const UINT count)
+{
+	Allocation allocation{ m_head, 0, false };
+
+	if (count > m_capacity - m_head)
+	{
+		// 空间不足: 按2倍增长并从新缓冲区的开头分配,本帧之前的分配仍留在旧缓冲区中
+		m_capacity = (std::max)({ m_capacity * 2, count, 64u });
+		allocation.offset = 0;
+		allocation.newCapacity = m_capacity;
+		allocation.isDiscard = true;
+	}
+	else if (m_isFrameStart)
+	{
+		// 每帧第一次写入时丢弃上一帧的数据,GPU可能仍在读取它们
+		allocation.isDiscard = true;
+	}
+
+	m_head = allocation.offset + count;
+	m_isFrameStart = false;
+	return allocation;
+}
+
+UINT InstanceAllocator::GetCapacity() const
+{
+	return m_capacity;
+}
+
+UINT InstanceAllocator::GetHead() const
+{
+	return m_head;
+}
@@ -0,0 +1,42 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 实例缓冲区的分配逻辑,不涉及D3D资源
+// 每帧第一次分配时丢弃原有数据,之后追加到已分配范围的后面
+// 空间不足时按2倍容量增长,并从新缓冲区的开头分配
+// Offset and growth bookkeeping for the per-frame instance buffer.
+//***************************************************************************************
+
+#ifndef INSTANCEALLOCATOR_H
+#define INSTANCEALLOCATOR_H
+
+#include "PortableTypes.h"
+
+class InstanceAllocator
+{
+public:
+	struct Allocation
+	{
+		UINT offset;			// 起始元素
+		UINT newCapacity;		// 需要以该容量重新创建缓冲区,不需要时为0
+		bool isDiscard;			// 为true时以WRITE_DISCARD映射,否则以WRITE_NO_OVERWRITE映射
+	};
+
+	explicit InstanceAllocator(UINT capacity = 0);
+
+	// 新的一帧,之后的第一次分配从头开始并丢弃原有数据
+	void BeginFrame();
+	// 分配count个元素
+	Allocation Allocate(UINT count);
+
+	UINT GetCapacity() const;
+	// 本帧已经分配的元素数目(扩容后从新缓冲区开始计算)
+	UINT GetHead() const;
+
+private:
+	UINT m_capacity;
+	UINT m_head;
+	bool m_isFrameStart;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "InstanceBuffer.h"
+#include "d3dUtil.h"
+#include "DXTrace.h"
+
+InstanceBuffer::InstanceBuffer(const UINT stride, const UINT initialCapacity)
+	:
+	m_allocator(initialCapacity),
+	m_stride(stride)
+{
+}
+
+HRESULT InstanceBuffer::InitResource(ID3D11Device* device)
+{
+	m_pDevice = device;
+	if (m_allocator.GetCapacity() == 0)
+		return S_OK;
+
+	return CreateVertexBuffer(device, nullptr, m_allocator.GetCapacity() * m_stride, m_pBuffer.ReleaseAndGetAddressOf(), true);
+}
+
+void InstanceBuffer::BeginFrame()
+{
+	m_allocator.BeginFrame();
+	m_retiredBuffers.clear();
+}
+
+void* InstanceBuffer::Map(ID3D11DeviceContext* deviceContext, const UINT count, Range* pOutRange)
+{
+	D3D11RenderBackend backend(deviceContext);
+	return Map(backend, count, pOutRange);
+}
+
+void* InstanceBuffer::Map(IRenderBackend& backend, const UINT count, Range* pOutRange)
+{
+	const InstanceAllocator::Allocation allocation = m_allocator.Allocate(count);
+	if (allocation.newCapacity)
+	{
+		if (m_pBuffer)
+			m_retiredBuffers.push_back(m_pBuffer);
+
+		HR(CreateVertexBuffer(m_pDevice.Get(), nullptr, allocation.newCapacity * m_stride, m_pBuffer.ReleaseAndGetAddressOf(), true));
+	}
+
+	*pOutRange = { ToRenderBuffer(m_pBuffer.Get()), m_stride, allocation.offset, count };
+	return backend.Map(pOutRange->buffer, allocation.isDiscard ? RenderMapType::WriteDiscard : RenderMapType::WriteNoOverwrite,
+		allocation.offset * m_stride, count * m_stride);
+}
+
+void InstanceBuffer::Unmap(ID3D11DeviceContext* deviceContext)
+{
+	D3D11RenderBackend backend(deviceContext);
+	Unmap(backend);
+}
+
+void InstanceBuffer::Unmap(IRenderBackend& backend)
+{
+	backend.Unmap(ToRenderBuffer(m_pBuffer.Get()));
+}
+
+UINT InstanceBuffer::GetCapacity() const
+{
+	return m_allocator.GetCapacity();
+}
+
+void InstanceBuffer::SetDebugObjectName(const std::string& name)
+{
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+	if (m_pBuffer)
+	{
+		D3D11SetDebugObjectName(m_pBuffer.Get(), name + ".InstanceBuffer");
+	}
+#else
+	UNREFERENCED_PARAMETER(name);
+#endif
+}
@@ -0,0 +1,66 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 每帧共享的实例缓冲区
+// 每帧第一次写入时以WRITE_DISCARD映射,之后以WRITE_NO_OVERWRITE追加到已写入数据的后面,
+// 同一帧内的多个物体、多个Pass的实例数据都放在同一个缓冲区中,已写入的范围在本帧内一直有效
+// 空间不足时按2倍容量重新创建缓冲区,旧缓冲区保留到下一帧开始,保证本帧已分配的范围仍然可用
+// Per-frame instance buffer that appends with NO_OVERWRITE and grows geometrically.
+//***************************************************************************************
+
+#ifndef INSTANCEBUFFER_H
+#define INSTANCEBUFFER_H
+
+#include "RenderBackendD3D11.h"
+#include "InstanceAllocator.h"
+
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <string>
+#include <vector>
+
+class InstanceBuffer
+{
+public:
+	template<typename T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	// 缓冲区中的一段实例数据,绘制时作为StartInstanceLocation使用
+	struct Range
+	{
+		RenderBuffer* buffer;
+		UINT stride;
+		UINT offset;			// 起始元素
+		UINT count;				// 元素数目
+	};
+
+	// stride为每个实例的字节数
+	explicit InstanceBuffer(UINT stride, UINT initialCapacity = 1024);
+
+	// 创建实例缓冲区,扩容时也使用该设备
+	HRESULT InitResource(ID3D11Device* device);
+
+	// 每帧开始时调用,上一帧的数据将被丢弃
+	void BeginFrame();
+	// 分配count个元素并映射,写入完成后需要调用Unmap
+	// 返回的范围在下一次BeginFrame之前有效
+	void* Map(ID3D11DeviceContext* deviceContext, UINT count, Range* pOutRange);
+	void* Map(IRenderBackend& backend, UINT count, Range* pOutRange);
+	void Unmap(ID3D11DeviceContext* deviceContext);
+	void Unmap(IRenderBackend& backend);
+
+	UINT GetCapacity() const;
+
+	// 设置调试对象名
+	void SetDebugObjectName(const std::string& name);
+
+private:
+	InstanceAllocator m_allocator;
+	UINT m_stride;
+
+	ComPtr<ID3D11Device> m_pDevice;
+	ComPtr<ID3D11Buffer> m_pBuffer;
+	std::vector<ComPtr<ID3D11Buffer>> m_retiredBuffers;		// 本帧扩容前的缓冲区,仍被本帧的绘制引用
+};
+
+#endif
@@ -196,6 +196,9 @@ void MinimapEffect::SetTexture(ID3D11ShaderResourceView* texture) const
 
 void MinimapEffect::Apply(ID3D11DeviceContext* deviceContext)
 {
+	// 直接修改管线状态,EffectPass记录的状态不再可信
+	EffectStateCache::Invalidate(deviceContext);
+
 	auto& pCBuffers = m_pImpl->m_pCBuffers;
 	// 将缓冲区绑定到渲染管线上
 	pCBuffers[0]->BindPS(deviceContext);
@@ -0,0 +1,896 @@
+#include "Narrowphase.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float Epsilon = 1e-6f;
+
+	// 边-边轴需要比面轴明显更优才会被选中,避免两者接近时来回跳变
+	constexpr float EdgeRelativeTolerance = 0.95f;
+	constexpr float EdgeAbsoluteTolerance = 0.001f;
+
+	constexpr int GjkMaxIterations = 64;
+	constexpr int EpaMaxIterations = 64;
+	constexpr int EpaMaxFaces = 128;
+	constexpr int EpaMaxLooseEdges = 64;
+	constexpr float EpaTolerance = 1e-4f;
+
+	// 裁剪多边形最多的顶点数: 四边形被4个平面裁剪
+	constexpr UINT MaxClipVertices = 8;
+
+	struct LoadedBox
+	{
+		XMVECTOR center;
+		XMVECTOR axes[3];
+		float extents[3];
+	};
+
+	struct Candidate
+	{
+		XMVECTOR position;
+		float penetration;
+	};
+
+	void LoadBox(const Narrowphase::BoxFrame& frame, LoadedBox& out)
+	{
+		out.center = XMLoadFloat3(&frame.center);
+		for (int i = 0; i < 3; ++i)
+			out.axes[i] = XMLoadFloat3(&frame.axes[i]);
+		out.extents[0] = frame.extents.x;
+		out.extents[1] = frame.extents.y;
+		out.extents[2] = frame.extents.z;
+	}
+
+	float XM_CALLCONV Dot(FXMVECTOR lhs, FXMVECTOR rhs)
+	{
+		return XMVectorGetX(XMVector3Dot(lhs, rhs));
+	}
+
+	void ResetPoint(ContactPoint& point)
+	{
+		point.normalImpulse = 0.0f;
+		point.tangentImpulse[0] = 0.0f;
+		point.tangentImpulse[1] = 0.0f;
+	}
+
+	// 持久化流形按物体对排序
+	bool PairLess(const ContactManifoldCache::PersistentManifold& lhs, const UINT first, const UINT second)
+	{
+		return lhs.first < first || (lhs.first == first && lhs.second < second);
+	}
+
+	bool PairLess(const ContactManifoldCache::PersistentManifold& lhs, const ContactManifoldCache::PersistentManifold& rhs)
+	{
+		return PairLess(lhs, rhs.first, rhs.second);
+	}
+
+	void XM_CALLCONV AddPoint(ContactManifold& manifold, FXMVECTOR position, const float penetration)
+	{
+		ContactPoint& point = manifold.points[manifold.pointCount++];
+		XMStoreFloat3(&point.position, position);
+		point.penetration = penetration;
+		ResetPoint(point);
+	}
+
+	// Sutherland-Hodgman: 保留dot(normal, p) <= offset的部分
+	UINT XM_CALLCONV ClipPolygon(const XMVECTOR* in, const UINT inCount, FXMVECTOR normal, const float offset, XMVECTOR* out)
+	{
+		UINT outCount = 0;
+		for (UINT i = 0; i < inCount; ++i)
+		{
+			const XMVECTOR a = in[i];
+			const XMVECTOR b = in[(i + 1) % inCount];
+			const float da = Dot(normal, a) - offset;
+			const float db = Dot(normal, b) - offset;
+
+			if (da <= 0.0f && outCount < MaxClipVertices)
+				out[outCount++] = a;
+			if ((da <= 0.0f) != (db <= 0.0f) && outCount < MaxClipVertices)
+				out[outCount++] = XMVectorLerp(a, b, da / (da - db));
+		}
+		return outCount;
+	}
+
+	// 多于4个候选接触点时,保留最深的点以及尽可能张成最大面积的另外三个点
+	void XM_CALLCONV ReduceContacts(const Candidate* candidates, const UINT count, FXMVECTOR normal, ContactManifold& manifold)
+	{
+		if (count <= ContactManifold::MaxPoints)
+		{
+			for (UINT i = 0; i < count; ++i)
+				AddPoint(manifold, candidates[i].position, candidates[i].penetration);
+			return;
+		}
+
+		UINT chosen[ContactManifold::MaxPoints] = {};
+
+		// 最深点
+		for (UINT i = 1; i < count; ++i)
+		{
+			if (candidates[i].penetration > candidates[chosen[0]].penetration)
+				chosen[0] = i;
+		}
+		const XMVECTOR p0 = candidates[chosen[0]].position;
+
+		// 离最深点最远的点
+		float best = -1.0f;
+		for (UINT i = 0; i < count; ++i)
+		{
+			const float distSq = XMVectorGetX(XMVector3LengthSq(candidates[i].position - p0));
+			if (distSq > best)
+			{
+				best = distSq;
+				chosen[1] = i;
+			}
+		}
+		const XMVECTOR p1 = candidates[chosen[1]].position;
+
+		// 在p0p1两侧分别取有向面积最大的点
+		float bestPositive = 0.0f, bestNegative = 0.0f;
+		chosen[2] = chosen[0];
+		chosen[3] = chosen[1];
+		for (UINT i = 0; i < count; ++i)
+		{
+			const float area = Dot(XMVector3Cross(p0 - candidates[i].position, p1 - candidates[i].position), normal);
+			if (area > bestPositive)
+			{
+				bestPositive = area;
+				chosen[2] = i;
+			}
+			else if (area < bestNegative)
+			{
+				bestNegative = area;
+				chosen[3] = i;
+			}
+		}
+
+		for (UINT i = 0; i < ContactManifold::MaxPoints; ++i)
+		{
+			// 退化情况下可能重复选中同一个点
+			bool isDuplicate = false;
+			for (UINT j = 0; j < i; ++j)
+				isDuplicate |= chosen[j] == chosen[i];
+			if (!isDuplicate)
+				AddPoint(manifold, candidates[chosen[i]].position, candidates[chosen[i]].penetration);
+		}
+	}
+
+	// 参考面与入射面之间的接触: refNormal为参考面法线,由参考盒指向入射盒
+	void XM_CALLCONV FaceContact(const LoadedBox& ref, const int refAxis, FXMVECTOR refNormal, const LoadedBox& inc, ContactManifold& manifold)
+	{
+		// 入射面为入射盒中与参考面法线最反向的面
+		int incAxis = 0;
+		float incDot = Dot(inc.axes[0], refNormal);
+		for (int k = 1; k < 3; ++k)
+		{
+			const float d = Dot(inc.axes[k], refNormal);
+			if (std::fabs(d) > std::fabs(incDot))
+			{
+				incAxis = k;
+				incDot = d;
+			}
+		}
+
+		const XMVECTOR incNormal = incDot > 0.0f ? XMVectorNegate(inc.axes[incAxis]) : inc.axes[incAxis];
+		const XMVECTOR faceCenter = inc.center + incNormal * inc.extents[incAxis];
+		const int k1 = (incAxis + 1) % 3;
+		const int k2 = (incAxis + 2) % 3;
+		const XMVECTOR a1 = inc.axes[k1] * inc.extents[k1];
+		const XMVECTOR a2 = inc.axes[k2] * inc.extents[k2];
+
+		XMVECTOR polygon[2][MaxClipVertices] = {
+			{ faceCenter + a1 + a2, faceCenter - a1 + a2, faceCenter - a1 - a2, faceCenter + a1 - a2 }
+		};
+		UINT polygonCount = 4;
+		int current = 0;
+
+		// 用参考面的4个侧面裁剪入射面
+		for (int side = 1; side <= 2 && polygonCount > 0; ++side)
+		{
+			const int r = (refAxis + side) % 3;
+			const float centerDist = Dot(ref.center, ref.axes[r]);
+
+			polygonCount = ClipPolygon(polygon[current], polygonCount, ref.axes[r], centerDist + ref.extents[r], polygon[1 - current]);
+			current = 1 - current;
+			polygonCount = ClipPolygon(polygon[current], polygonCount, XMVectorNegate(ref.axes[r]), ref.extents[r] - centerDist, polygon[1 - current]);
+			current = 1 - current;
+		}
+
+		// 只保留位于参考面之下的点,接触位置取入射点与参考面的中点
+		const float refOffset = Dot(ref.center, refNormal) + ref.extents[refAxis];
+		Candidate candidates[MaxClipVertices];
+		UINT candidateCount = 0;
+		for (UINT i = 0; i < polygonCount; ++i)
+		{
+			const float separation = Dot(polygon[current][i], refNormal) - refOffset;
+			if (separation <= 0.0f)
+			{
+				candidates[candidateCount++] = { polygon[current][i] - refNormal * (0.5f * separation), -separation };
+			}
+		}
+
+		ReduceContacts(candidates, candidateCount, refNormal, manifold);
+	}
+
+	//
+	// GJK/EPA
+	//
+
+	struct SupportPoint
+	{
+		XMVECTOR v;		// Minkowski差 A - B 上的点
+		XMVECTOR a;		// 对应A上的点
+	};
+
+	XMVECTOR XM_CALLCONV HullSupport(const ConvexHull& hull, FXMVECTOR direction)
+	{
+		XMVECTOR best = XMLoadFloat3(&hull.vertices[0]);
+		float bestDot = Dot(best, direction);
+		for (UINT i = 1; i < hull.vertexCount; ++i)
+		{
+			const XMVECTOR v = XMLoadFloat3(&hull.vertices[i]);
+			const float d = Dot(v, direction);
+			if (d > bestDot)
+			{
+				best = v;
+				bestDot = d;
+			}
+		}
+		return best;
+	}
+
+	SupportPoint XM_CALLCONV MinkowskiSupport(const ConvexHull& a, const ConvexHull& b, FXMVECTOR direction)
+	{
+		SupportPoint point;
+		point.a = HullSupport(a, direction);
+		point.v = point.a - HullSupport(b, XMVectorNegate(direction));
+		return point;
+	}
+
+	XMVECTOR XM_CALLCONV TripleCross(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c)
+	{
+		return XMVector3Cross(XMVector3Cross(a, b), c);
+	}
+
+	// a为最新加入的点
+	void UpdateSimplex3(SupportPoint& a, SupportPoint& b, SupportPoint& c, SupportPoint& d, int& dim, XMVECTOR& searchDir)
+	{
+		const XMVECTOR ab = b.v - a.v;
+		const XMVECTOR ac = c.v - a.v;
+		const XMVECTOR n = XMVector3Cross(ab, ac);
+		const XMVECTOR ao = XMVectorNegate(a.v);
+
+		dim = 2;
+		if (Dot(XMVector3Cross(ab, n), ao) > 0.0f)
+		{
+			c = a;
+			searchDir = TripleCross(ab, ao, ab);
+			return;
+		}
+		if (Dot(XMVector3Cross(n, ac), ao) > 0.0f)
+		{
+			b = a;
+			searchDir = TripleCross(ac, ao, ac);
+			return;
+		}
+
+		dim = 3;
+		if (Dot(n, ao) > 0.0f)
+		{
+			d = c;
+			c = b;
+			b = a;
+			searchDir = n;
+			return;
+		}
+		d = b;
+		b = a;
+		searchDir = XMVectorNegate(n);
+	}
+
+	bool UpdateSimplex4(SupportPoint& a, SupportPoint& b, SupportPoint& c, SupportPoint& d, int& dim, XMVECTOR& searchDir)
+	{
+		const XMVECTOR abc = XMVector3Cross(b.v - a.v, c.v - a.v);
+		const XMVECTOR acd = XMVector3Cross(c.v - a.v, d.v - a.v);
+		const XMVECTOR adb = XMVector3Cross(d.v - a.v, b.v - a.v);
+		const XMVECTOR ao = XMVectorNegate(a.v);
+
+		dim = 3;
+		if (Dot(abc, ao) > 0.0f)
+		{
+			d = c;
+			c = b;
+			b = a;
+			searchDir = abc;
+			return false;
+		}
+		if (Dot(acd, ao) > 0.0f)
+		{
+			b = a;
+			searchDir = acd;
+			return false;
+		}
+		if (Dot(adb, ao) > 0.0f)
+		{
+			c = d;
+			d = b;
+			b = a;
+			searchDir = adb;
+			return false;
+		}
+		// 原点位于四面体内
+		return true;
+	}
+
+	struct EpaFace
+	{
+		SupportPoint points[3];
+		XMVECTOR normal;
+	};
+
+	struct EpaEdge
+	{
+		SupportPoint points[2];
+	};
+
+	bool XM_CALLCONV SetFace(EpaFace& face, const SupportPoint& p0, const SupportPoint& p1, const SupportPoint& p2)
+	{
+		face.points[0] = p0;
+		face.points[1] = p1;
+		face.points[2] = p2;
+		const XMVECTOR n = XMVector3Cross(p1.v - p0.v, p2.v - p0.v);
+		if (XMVectorGetX(XMVector3LengthSq(n)) < Epsilon * Epsilon)
+			return false;
+		face.normal = XMVector3Normalize(n);
+		return true;
+	}
+
+	// 返回离原点最近的面,dist为该面到原点的距离
+	int FindClosestFace(const EpaFace* faces, const int faceCount, float& dist)
+	{
+		int closest = 0;
+		dist = FLT_MAX;
+		for (int i = 0; i < faceCount; ++i)
+		{
+			const float faceDist = Dot(faces[i].points[0].v, faces[i].normal);
+			if (faceDist < dist)
+			{
+				dist = faceDist;
+				closest = i;
+			}
+		}
+		return closest;
+	}
+
+	// 以包含原点的四面体为起点扩展多面体,求Minkowski差表面上离原点最近的点
+	bool Epa(const ConvexHull& hullA, const ConvexHull& hullB, const SupportPoint& a, const SupportPoint& b, const SupportPoint& c, const SupportPoint& d, ContactManifold& manifold)
+	{
+		EpaFace faces[EpaMaxFaces];
+		int faceCount = 0;
+
+		// 初始四面体,法线均朝外
+		faceCount += SetFace(faces[faceCount], a, b, c);
+		faceCount += SetFace(faces[faceCount], a, c, d);
+		faceCount += SetFace(faces[faceCount], a, d, b);
+		faceCount += SetFace(faces[faceCount], b, d, c);
+		if (faceCount < 4)
+			return false;
+
+		float minDist = FLT_MAX;
+		int closest = FindClosestFace(faces, faceCount, minDist);
+		for (int iteration = 0; iteration < EpaMaxIterations; ++iteration)
+		{
+			const XMVECTOR searchDir = faces[closest].normal;
+			const SupportPoint p = MinkowskiSupport(hullA, hullB, searchDir);
+			if (Dot(p.v, searchDir) - minDist < EpaTolerance)
+				break;
+
+			// 找出所有能被新点看到的面,收集形成空洞边界的边
+			// 先不移除这些面,容量不足时当前多面体仍然完整
+			bool isVisible[EpaMaxFaces];
+			int visibleCount = 0;
+			EpaEdge looseEdges[EpaMaxLooseEdges];
+			int looseCount = 0;
+			bool isOverflow = false;
+			for (int i = 0; i < faceCount && !isOverflow; ++i)
+			{
+				isVisible[i] = Dot(faces[i].normal, p.v - faces[i].points[0].v) > 0.0f;
+				if (!isVisible[i])
+					continue;
+				++visibleCount;
+
+				for (int e = 0; e < 3; ++e)
+				{
+					const SupportPoint& e0 = faces[i].points[e];
+					const SupportPoint& e1 = faces[i].points[(e + 1) % 3];
+
+					// 相邻两个被移除的面共享的边反向出现,二者抵消
+					bool isShared = false;
+					for (int k = 0; k < looseCount; ++k)
+					{
+						if (XMVector3Equal(looseEdges[k].points[0].v, e1.v) && XMVector3Equal(looseEdges[k].points[1].v, e0.v))
+						{
+							looseEdges[k] = looseEdges[--looseCount];
+							isShared = true;
+							break;
+						}
+					}
+					if (!isShared)
+					{
+						if (looseCount >= EpaMaxLooseEdges)
+						{
+							isOverflow = true;
+							break;
+						}
+						looseEdges[looseCount++] = { { e0, e1 } };
+					}
+				}
+			}
+
+			// 重建后的面数超出容量时多面体会出现空洞,停止扩展,使用当前最近的面
+			if (isOverflow || faceCount - visibleCount + looseCount > EpaMaxFaces)
+				break;
+
+			int keptCount = 0;
+			for (int i = 0; i < faceCount; ++i)
+			{
+				if (!isVisible[i])
+					faces[keptCount++] = faces[i];
+			}
+			faceCount = keptCount;
+
+			// 以新点与边界边重建面
+			for (int k = 0; k < looseCount; ++k)
+			{
+				EpaFace& face = faces[faceCount];
+				if (!SetFace(face, looseEdges[k].points[0], looseEdges[k].points[1], p))
+					continue;
+				// 保证法线朝外
+				if (Dot(face.points[0].v, face.normal) < -Epsilon)
+				{
+					std::swap(face.points[0], face.points[1]);
+					face.normal = XMVectorNegate(face.normal);
+				}
+				++faceCount;
+			}
+
+			if (faceCount == 0)
+				return false;
+
+			// 每次扩展之后重新选择最近的面,达到迭代上限退出时结果也对应当前多面体
+			closest = FindClosestFace(faces, faceCount, minDist);
+		}
+
+		// 原点在最近面上的投影的重心坐标,用于求A上的接触点
+		const EpaFace& face = faces[closest];
+		const XMVECTOR projection = face.normal * minDist;
+		const XMVECTOR v0 = face.points[1].v - face.points[0].v;
+		const XMVECTOR v1 = face.points[2].v - face.points[0].v;
+		const XMVECTOR v2 = projection - face.points[0].v;
+		const float d00 = Dot(v0, v0), d01 = Dot(v0, v1), d11 = Dot(v1, v1);
+		const float d20 = Dot(v2, v0), d21 = Dot(v2, v1);
+		const float denom = d00 * d11 - d01 * d01;
+		float u = 1.0f, v = 0.0f, w = 0.0f;
+		if (std::fabs(denom) > Epsilon)
+		{
+			v = (d11 * d20 - d01 * d21) / denom;
+			w = (d00 * d21 - d01 * d20) / denom;
+			u = 1.0f - v - w;
+		}
+
+		const XMVECTOR contactA = face.points[0].a * u + face.points[1].a * v + face.points[2].a * w;
+
+		XMStoreFloat3(&manifold.normal, face.normal);
+		manifold.pointCount = 0;
+		// 接触位置取A、B上对应点的中点
+		AddPoint(manifold, contactA - face.normal * (0.5f * minDist), (std::max)(minDist, 0.0f));
+		return true;
+	}
+}
+
+//
+// ContactManifoldCache
+//
+
+ContactManifoldCache::ContactManifoldCache(const float matchDistance)
+	:
+	m_matchDistanceSq(matchDistance * matchDistance)
+{
+}
+
+void ContactManifoldCache::Update(const UINT first, const UINT second, const ContactManifold& manifold)
+{
+	const auto it = std::lower_bound(m_manifolds.begin(), m_manifolds.end(), std::make_pair(first, second),
+		[](const PersistentManifold& lhs, const std::pair<UINT, UINT>& rhs) { return PairLess(lhs, rhs.first, rhs.second); });
+
+	if (it == m_manifolds.end() || it->first != first || it->second != second)
+	{
+		// 新出现的物体对先追加,同一帧内的重复更新在EndFrame中合并
+		m_pendingManifolds.push_back({ first, second, manifold, true });
+		for (UINT i = 0; i < manifold.pointCount; ++i)
+			ResetPoint(m_pendingManifolds.back().manifold.points[i]);
+		return;
+	}
+
+	// 新接触点继承距离最近的旧接触点的冲量
+	const ContactManifold& old = it->manifold;
+	ContactManifold updated = manifold;
+	for (UINT i = 0; i < updated.pointCount; ++i)
+	{
+		ContactPoint& point = updated.points[i];
+		ResetPoint(point);
+
+		const XMVECTOR position = XMLoadFloat3(&point.position);
+		float bestDistSq = m_matchDistanceSq;
+		for (UINT j = 0; j < old.pointCount; ++j)
+		{
+			const float distSq = XMVectorGetX(XMVector3LengthSq(position - XMLoadFloat3(&old.points[j].position)));
+			if (distSq < bestDistSq)
+			{
+				bestDistSq = distSq;
+				point.normalImpulse = old.points[j].normalImpulse;
+				point.tangentImpulse[0] = old.points[j].tangentImpulse[0];
+				point.tangentImpulse[1] = old.points[j].tangentImpulse[1];
+			}
+		}
+	}
+
+	it->manifold = updated;
+	it->isTouched = true;
+}
+
+void ContactManifoldCache::EndFrame()
+{
+	m_manifolds.erase(
+		std::remove_if(m_manifolds.begin(), m_manifolds.end(), [](const PersistentManifold& manifold) { return !manifold.isTouched; }),
+		m_manifolds.end());
+
+	if (!m_pendingManifolds.empty())
+	{
+		// 新物体对按物体对排序,同一物体对的多次更新按追加顺序排在一起
+		const UINT pendingCount = static_cast<UINT>(m_pendingManifolds.size());
+		m_pendingOrder.resize(pendingCount);
+		for (UINT i = 0; i < pendingCount; ++i)
+			m_pendingOrder[i] = i;
+		std::sort(m_pendingOrder.begin(), m_pendingOrder.end(),
+			[this](const UINT lhs, const UINT rhs)
+			{
+				const PersistentManifold& a = m_pendingManifolds[lhs];
+				const PersistentManifold& b = m_pendingManifolds[rhs];
+				return PairLess(a, b) || (!PairLess(b, a) && lhs < rhs);
+			});
+
+		// 与已有的有序流形归并,新物体对不会与已有的物体对重复
+		m_mergedManifolds.clear();
+		m_mergedManifolds.reserve(m_manifolds.size() + pendingCount);
+		auto existing = m_manifolds.cbegin();
+		for (UINT i = 0; i < pendingCount; ++i)
+		{
+			const PersistentManifold& pending = m_pendingManifolds[m_pendingOrder[i]];
+			// 同一帧内多次更新的物体对只保留最后一次的流形
+			if (i + 1 < pendingCount && !PairLess(pending, m_pendingManifolds[m_pendingOrder[i + 1]]))
+				continue;
+
+			while (existing != m_manifolds.cend() && PairLess(*existing, pending))
+				m_mergedManifolds.push_back(*existing++);
+			m_mergedManifolds.push_back(pending);
+		}
+		m_mergedManifolds.insert(m_mergedManifolds.end(), existing, m_manifolds.cend());
+
+		m_manifolds.swap(m_mergedManifolds);
+		m_pendingManifolds.clear();
+	}
+
+	for (PersistentManifold& manifold : m_manifolds)
+		manifold.isTouched = false;
+}
+
+void ContactManifoldCache::Clear()
+{
+	m_manifolds.clear();
+	m_pendingManifolds.clear();
+	m_pendingOrder.clear();
+	m_mergedManifolds.clear();
+}
+
+const std::vector<ContactManifoldCache::PersistentManifold>& ContactManifoldCache::GetManifolds() const
+{
+	return m_manifolds;
+}
+
+std::vector<ContactManifoldCache::PersistentManifold>& ContactManifoldCache::GetManifolds()
+{
+	return m_manifolds;
+}
+
+//
+// Narrowphase
+//
+
+void Narrowphase::CreateBoxFrame(const BoundingOrientedBox& box, BoxFrame& out)
+{
+	// 旋转矩阵的每一行即一条局部轴
+	const XMMATRIX rotation = XMMatrixRotationQuaternion(XMLoadFloat4(&box.Orientation));
+	out.center = box.Center;
+	XMStoreFloat3(&out.axes[0], rotation.r[0]);
+	XMStoreFloat3(&out.axes[1], rotation.r[1]);
+	XMStoreFloat3(&out.axes[2], rotation.r[2]);
+	out.extents = box.Extents;
+}
+
+bool Narrowphase::Collide(const BoxFrame& a, const BoxFrame& b, ContactManifold& manifold)
+{
+	manifold.pointCount = 0;
+
+	LoadedBox boxA, boxB;
+	LoadBox(a, boxA);
+	LoadBox(b, boxB);
+	const float* eA = boxA.extents;
+	const float* eB = boxB.extents;
+
+	// R[i][j]为A的第i条轴与B的第j条轴的点积,即B在A局部坐标系下的旋转
+	// absR加上一个小量,防止两条轴接近平行时叉积退化导致误判
+	float R[3][3], absR[3][3];
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			R[i][j] = Dot(boxA.axes[i], boxB.axes[j]);
+			absR[i][j] = std::fabs(R[i][j]) + Epsilon;
+		}
+	}
+
+	// B中心相对A中心的偏移,在A局部坐标系下表示
+	const XMVECTOR offset = boxB.center - boxA.center;
+	const float t[3] = { Dot(offset, boxA.axes[0]), Dot(offset, boxA.axes[1]), Dot(offset, boxA.axes[2]) };
+
+	float bestPenetration = FLT_MAX;
+	int bestAxis = -1;			// 0~2: A的面, 3~5: B的面, 6~14: 边-边
+	XMVECTOR bestNormal = XMVectorZero();
+
+	// A的3条面法线
+	for (int i = 0; i < 3; ++i)
+	{
+		const float rb = eB[0] * absR[i][0] + eB[1] * absR[i][1] + eB[2] * absR[i][2];
+		const float penetration = eA[i] + rb - std::fabs(t[i]);
+		if (penetration < 0.0f)
+			return false;
+		if (penetration < bestPenetration)
+		{
+			bestPenetration = penetration;
+			bestAxis = i;
+			bestNormal = t[i] < 0.0f ? XMVectorNegate(boxA.axes[i]) : boxA.axes[i];
+		}
+	}
+
+	// B的3条面法线
+	for (int j = 0; j < 3; ++j)
+	{
+		const float ra = eA[0] * absR[0][j] + eA[1] * absR[1][j] + eA[2] * absR[2][j];
+		const float s = t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j];
+		const float penetration = ra + eB[j] - std::fabs(s);
+		if (penetration < 0.0f)
+			return false;
+		if (penetration < bestPenetration)
+		{
+			bestPenetration = penetration;
+			bestAxis = 3 + j;
+			bestNormal = s < 0.0f ? XMVectorNegate(boxB.axes[j]) : boxB.axes[j];
+		}
+	}
+
+	// 9条边-边叉积轴
+	float bestEdgePenetration = FLT_MAX;
+	int bestEdgeAxis = -1;
+	XMVECTOR bestEdgeNormal = XMVectorZero();
+	for (int i = 0; i < 3; ++i)
+	{
+		const int i1 = (i + 1) % 3;
+		const int i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; ++j)
+		{
+			const int j1 = (j + 1) % 3;
+			const int j2 = (j + 2) % 3;
+
+			// 两条轴几乎平行时叉积退化,该情况已由面法线覆盖
+			const float length = std::sqrt((std::max)(0.0f, 1.0f - R[i][j] * R[i][j]));
+			if (length < 1e-4f)
+				continue;
+
+			const float ra = eA[i1] * absR[i2][j] + eA[i2] * absR[i1][j];
+			const float rb = eB[j1] * absR[i][j2] + eB[j2] * absR[i][j1];
+			const float s = t[i2] * R[i1][j] - t[i1] * R[i2][j];
+			const float penetration = (ra + rb - std::fabs(s)) / length;
+			if (penetration < 0.0f)
+				return false;
+			if (penetration < bestEdgePenetration)
+			{
+				bestEdgePenetration = penetration;
+				bestEdgeAxis = 6 + i * 3 + j;
+				const XMVECTOR axis = XMVector3Normalize(XMVector3Cross(boxA.axes[i], boxB.axes[j]));
+				bestEdgeNormal = s < 0.0f ? XMVectorNegate(axis) : axis;
+			}
+		}
+	}
+
+	if (bestEdgeAxis >= 0 && bestEdgePenetration < bestPenetration * EdgeRelativeTolerance - EdgeAbsoluteTolerance)
+	{
+		// 边-边接触: 求两条支撑边的最近点
+		const int i = (bestEdgeAxis - 6) / 3;
+		const int j = (bestEdgeAxis - 6) % 3;
+
+		XMVECTOR pointA = boxA.center;
+		XMVECTOR pointB = boxB.center;
+		for (int k = 0; k < 3; ++k)
+		{
+			if (k != i)
+				pointA += boxA.axes[k] * (Dot(boxA.axes[k], bestEdgeNormal) > 0.0f ? eA[k] : -eA[k]);
+			if (k != j)
+				pointB += boxB.axes[k] * (Dot(boxB.axes[k], bestEdgeNormal) > 0.0f ? -eB[k] : eB[k]);
+		}
+
+		const XMVECTOR dirA = boxA.axes[i];
+		const XMVECTOR dirB = boxB.axes[j];
+		const XMVECTOR r = pointA - pointB;
+		const float cosine = Dot(dirA, dirB);
+		const float c = Dot(dirA, r);
+		const float f = Dot(dirB, r);
+		const float denom = 1.0f - cosine * cosine;
+		const float s = std::clamp((cosine * f - c) / denom, -eA[i], eA[i]);
+		const float u = std::clamp(cosine * s + f, -eB[j], eB[j]);
+
+		const XMVECTOR closestA = pointA + dirA * s;
+		const XMVECTOR closestB = pointB + dirB * u;
+
+		XMStoreFloat3(&manifold.normal, bestEdgeNormal);
+		AddPoint(manifold, (closestA + closestB) * 0.5f, bestEdgePenetration);
+		return true;
+	}
+
+	// 面接触,法线总是由A指向B
+	XMStoreFloat3(&manifold.normal, bestNormal);
+	if (bestAxis < 3)
+		FaceContact(boxA, bestAxis, bestNormal, boxB, manifold);
+	else
+		FaceContact(boxB, bestAxis - 3, XMVectorNegate(bestNormal), boxA, manifold);
+
+	// 数值误差导致裁剪后没有剩余点时,退化为单点接触
+	if (manifold.pointCount == 0)
+		AddPoint(manifold, (boxA.center + boxB.center) * 0.5f, bestPenetration);
+	return true;
+}
+
+bool Narrowphase::Collide(const BoundingOrientedBox& a, const BoundingOrientedBox& b, ContactManifold& manifold)
+{
+	BoxFrame frameA, frameB;
+	CreateBoxFrame(a, frameA);
+	CreateBoxFrame(b, frameB);
+	return Collide(frameA, frameB, manifold);
+}
+
+bool Narrowphase::Collide(const BoundingSphere& a, const BoundingOrientedBox& b, ContactManifold& manifold)
+{
+	manifold.pointCount = 0;
+
+	BoxFrame frame;
+	CreateBoxFrame(b, frame);
+	LoadedBox box;
+	LoadBox(frame, box);
+
+	// 球心在OBB局部坐标系下的坐标,夹取后得到OBB上离球心最近的点
+	const XMVECTOR center = XMLoadFloat3(&a.Center);
+	const XMVECTOR offset = center - box.center;
+	float local[3];
+	XMVECTOR closest = box.center;
+	for (int k = 0; k < 3; ++k)
+	{
+		local[k] = Dot(offset, box.axes[k]);
+		closest += box.axes[k] * std::clamp(local[k], -box.extents[k], box.extents[k]);
+	}
+
+	const XMVECTOR diff = closest - center;
+	const float distSq = XMVectorGetX(XMVector3LengthSq(diff));
+	if (distSq > a.Radius * a.Radius)
+		return false;
+
+	if (distSq > Epsilon * Epsilon)
+	{
+		const float dist = std::sqrt(distSq);
+		XMStoreFloat3(&manifold.normal, diff / dist);
+		AddPoint(manifold, closest, a.Radius - dist);
+		return true;
+	}
+
+	// 球心位于OBB内部,沿穿透最浅的面推出
+	int axis = 0;
+	float minDepth = box.extents[0] - std::fabs(local[0]);
+	for (int k = 1; k < 3; ++k)
+	{
+		const float depth = box.extents[k] - std::fabs(local[k]);
+		if (depth < minDepth)
+		{
+			minDepth = depth;
+			axis = k;
+		}
+	}
+
+	XMStoreFloat3(&manifold.normal, local[axis] > 0.0f ? XMVectorNegate(box.axes[axis]) : box.axes[axis]);
+	AddPoint(manifold, center, a.Radius + minDepth);
+	return true;
+}
+
+bool Narrowphase::Collide(const BoundingOrientedBox& a, const BoundingSphere& b, ContactManifold& manifold)
+{
+	if (!Collide(b, a, manifold))
+		return false;
+
+	XMStoreFloat3(&manifold.normal, XMVectorNegate(XMLoadFloat3(&manifold.normal)));
+	return true;
+}
+
+bool Narrowphase::Collide(const ConvexHull& a, const ConvexHull& b, ContactManifold& manifold)
+{
+	manifold.pointCount = 0;
+	if (a.vertexCount == 0 || b.vertexCount == 0)
+		return false;
+
+	SupportPoint pa{}, pb{}, pc{}, pd{};
+
+	// 以两个凸包首顶点的连线作为初始搜索方向
+	XMVECTOR searchDir = XMLoadFloat3(&a.vertices[0]) - XMLoadFloat3(&b.vertices[0]);
+	if (XMVector3NearEqual(searchDir, XMVectorZero(), XMVectorReplicate(Epsilon)))
+		searchDir = g_XMIdentityR0;
+
+	pc = MinkowskiSupport(a, b, searchDir);
+	searchDir = XMVectorNegate(pc.v);
+	pb = MinkowskiSupport(a, b, searchDir);
+	if (Dot(pb.v, searchDir) < 0.0f)
+		return false;
+
+	const XMVECTOR bc = pc.v - pb.v;
+	searchDir = TripleCross(bc, XMVectorNegate(pb.v), bc);
+	if (XMVector3NearEqual(searchDir, XMVectorZero(), XMVectorReplicate(Epsilon)))
+	{
+		// 原点位于线段bc上,任取一条垂直方向
+		searchDir = XMVector3Cross(bc, g_XMIdentityR0);
+		if (XMVector3NearEqual(searchDir, XMVectorZero(), XMVectorReplicate(Epsilon)))
+			searchDir = XMVector3Cross(bc, g_XMNegIdentityR2);
+	}
+
+	int dim = 2;
+	for (int iteration = 0; iteration < GjkMaxIterations; ++iteration)
+	{
+		pa = MinkowskiSupport(a, b, searchDir);
+		if (Dot(pa.v, searchDir) < 0.0f)
+			return false;
+
+		++dim;
+		if (dim == 3)
+		{
+			UpdateSimplex3(pa, pb, pc, pd, dim, searchDir);
+		}
+		else if (UpdateSimplex4(pa, pb, pc, pd, dim, searchDir))
+		{
+			return Epa(a, b, pa, pb, pc, pd, manifold);
+		}
+	}
+	return false;
+}
+
+void Narrowphase::CollideBatch(const std::vector<BoundingOrientedBox>& boxes, const std::vector<CollisionPair>& pairs, ContactManifoldCache& cache)
+{
+	m_frames.resize(boxes.size());
+	for (size_t i = 0; i < boxes.size(); ++i)
+		CreateBoxFrame(boxes[i], m_frames[i]);
+
+	ContactManifold manifold;
+	for (const CollisionPair& pair : pairs)
+	{
+		if (Collide(m_frames[pair.first], m_frames[pair.second], manifold))
+			cache.Update(pair.first, pair.second, manifold);
+	}
+}
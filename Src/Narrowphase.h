@@ -0,0 +1,113 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 细测阶段碰撞检测: 生成接触点、法线与穿透深度
+// OBB-OBB使用分离轴定理(15条轴),球-OBB使用最近点,凸包使用GJK/EPA
+// 接触流形可以跨帧保存,用于冲量的warm starting
+// Narrowphase contact generation with persistent contact manifolds.
+//***************************************************************************************
+
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include "Broadphase.h"
+
+// 接触点
+struct ContactPoint
+{
+	DirectX::XMFLOAT3 position;		// 世界空间中的接触位置
+	float penetration;				// 穿透深度(非负)
+	float normalImpulse;			// 法向累积冲量,用于warm starting
+	float tangentImpulse[2];		// 切向累积冲量,用于warm starting
+};
+
+// 接触流形
+struct ContactManifold
+{
+	static constexpr UINT MaxPoints = 4;
+
+	DirectX::XMFLOAT3 normal;		// 单位法线,由物体A指向物体B
+	UINT pointCount;
+	ContactPoint points[MaxPoints];
+};
+
+// 凸包,顶点位于世界空间
+// 只引用外部的顶点数组,不持有内存
+struct ConvexHull
+{
+	const DirectX::XMFLOAT3* vertices;
+	UINT vertexCount;
+};
+
+//
+// 跨帧保存的接触流形
+// 内部按物体对有序存放,预热之后每帧不再分配内存
+//
+class ContactManifoldCache
+{
+public:
+	struct PersistentManifold
+	{
+		UINT first;
+		UINT second;
+		ContactManifold manifold;
+		bool isTouched;				// 本帧是否被更新过
+	};
+
+	// 新旧接触点的距离小于该值时视为同一个接触点
+	explicit ContactManifoldCache(float matchDistance = 0.05f);
+
+	// 以本帧新生成的流形更新物体对(first, second)的持久化流形
+	// 与上一帧匹配的接触点会继承累积冲量
+	void Update(UINT first, UINT second, const ContactManifold& manifold);
+	// 结束一帧: 移除本帧没有更新的物体对,加入新的物体对
+	void EndFrame();
+
+	void Clear();
+
+	// 获取所有持久化流形(EndFrame之后有效)
+	const std::vector<PersistentManifold>& GetManifolds() const;
+	// 求解器通过该接口写回累积冲量,供下一帧warm starting
+	std::vector<PersistentManifold>& GetManifolds();
+
+private:
+	float m_matchDistanceSq;
+	std::vector<PersistentManifold> m_manifolds;
+	std::vector<PersistentManifold> m_pendingManifolds;		// 本帧新出现的物体对,按更新顺序追加,可能重复
+	std::vector<UINT> m_pendingOrder;						// EndFrame中新物体对的排序结果
+	std::vector<PersistentManifold> m_mergedManifolds;		// EndFrame中归并的目标,与m_manifolds交换
+};
+
+class Narrowphase
+{
+public:
+	// OBB的展开形式: 中心、三条局部轴在世界空间中的方向、半长
+	struct BoxFrame
+	{
+		DirectX::XMFLOAT3 center;
+		DirectX::XMFLOAT3 axes[3];
+		DirectX::XMFLOAT3 extents;
+	};
+
+	static void CreateBoxFrame(const DirectX::BoundingOrientedBox& box, BoxFrame& out);
+
+	//
+	// 单对检测,相交时返回true并填充manifold,法线由a指向b
+	//
+
+	static bool Collide(const BoxFrame& a, const BoxFrame& b, ContactManifold& manifold);
+	static bool Collide(const DirectX::BoundingOrientedBox& a, const DirectX::BoundingOrientedBox& b, ContactManifold& manifold);
+	static bool Collide(const DirectX::BoundingSphere& a, const DirectX::BoundingOrientedBox& b, ContactManifold& manifold);
+	static bool Collide(const DirectX::BoundingOrientedBox& a, const DirectX::BoundingSphere& b, ContactManifold& manifold);
+	// GJK判断相交,EPA求穿透深度,只生成一个接触点
+	static bool Collide(const ConvexHull& a, const ConvexHull& b, ContactManifold& manifold);
+
+	// 批量处理粗测阶段给出的物体对,结果写入cache(调用者负责cache.EndFrame())
+	// 每个OBB只展开一次,预热之后不再分配内存
+	void CollideBatch(const std::vector<DirectX::BoundingOrientedBox>& boxes, const std::vector<CollisionPair>& pairs, ContactManifoldCache& cache);
+
+private:
+	std::vector<BoxFrame> m_frames;
+};
+
+#endif
@@ -468,11 +468,43 @@ void NormalTank::Init(ID3D11Device* device)
 	m_battery[4].SetDebugObjectName("TankBatteryRight");
 	
 	m_barrel.SetDebugObjectName("TankBarrel");
+
+	// 树的结构已经确定,展开为按深度排列的数组
+	m_hierarchy.Build(&body);
+}
+
+void NormalTank::UpdateBounds()
+{
+	m_hierarchy.Update();
 }
 
 void NormalTank::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect)
 {
-	m_tankMainBody[0].Draw(deviceContext, effect);
+	const std::vector<XMFLOAT4X4>& worldMatrices = m_hierarchy.GetWorldMatrices();
+	for (UINT i = 0; i < m_hierarchy.GetNodeCount(); ++i)
+	{
+		m_hierarchy.GetNode(i)->DrawParts(deviceContext, effect, XMLoadFloat4x4(&worldMatrices[i]));
+	}
+}
+
+void NormalTank::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingFrustum& frustum, GameObject::CullStatistics* pStatistics)
+{
+	DrawCulled(deviceContext, effect, frustum, pStatistics);
+}
+
+void NormalTank::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingOrientedBox& volume, GameObject::CullStatistics* pStatistics)
+{
+	DrawCulled(deviceContext, effect, volume, pStatistics);
+}
+
+template <typename BoundingVolume>
+void NormalTank::DrawCulled(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingVolume& volume, GameObject::CullStatistics* pStatistics)
+{
+	m_hierarchy.Cull(volume, pStatistics,
+		[deviceContext, effect](GameObject& node, FXMMATRIX world)
+		{
+			node.DrawParts(deviceContext, effect, world);
+		});
 }
 
 BasicTransform& NormalTank::GetTankTransform()
@@ -2,6 +2,7 @@
 #define NORMALTANK_H
 
 #include "TankStructureHelper.h"
+#include "SceneHierarchy.h"
 
 class NormalTank final : public BasicTankStructure
 {
@@ -18,7 +19,10 @@ public:
 	
 	void Init(ID3D11Device* device) override;
 
+	void UpdateBounds() override;
 	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect) override;
+	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingFrustum& frustum, GameObject::CullStatistics* pStatistics) override;
+	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingOrientedBox& volume, GameObject::CullStatistics* pStatistics) override;
 	
 private:
 	BasicTransform& GetTankTransform() override;
@@ -36,6 +40,9 @@ private:
 	BasicTransform& GetBatteryTransform() override;
 
 	const BasicTransform& GetBatteryTransform() const override;
+
+	template <typename BoundingVolume>
+	void DrawCulled(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingVolume& volume, GameObject::CullStatistics* pStatistics);
 	
 	// 载具车身(立方体)
 	static constexpr float BodyWidth = 3.5f;		// 载具俯视角(车头朝上下)宽度
@@ -108,6 +115,9 @@ private:
 	
 	// 炮管
 	GameObject m_barrel;
+
+	// 按深度展开的部件,UpdateBounds时逐层计算世界矩阵与子树包围盒
+	SceneHierarchy<GameObject> m_hierarchy;
 };
 
 #endif
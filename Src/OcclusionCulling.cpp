@@ -0,0 +1,331 @@
+#include "OcclusionCulling.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// w小于该值的顶点视为位于近平面之后
+	constexpr float NearClipW = 1e-4f;
+	// HiZ测试时屏幕矩形在所选层级上最多覆盖的纹素宽度
+	constexpr UINT MaxTestTexels = 4;
+
+	// OBB的12个三角形,顶点顺序与BoundingOrientedBox::GetCorners一致
+	constexpr UINT BoxIndices[36] =
+	{
+		0, 1, 2, 0, 2, 3,		// +Z
+		4, 6, 5, 4, 7, 6,		// -Z
+		0, 5, 1, 0, 4, 5,		// -Y
+		3, 2, 6, 3, 6, 7,		// +Y
+		0, 3, 7, 0, 7, 4,		// -X
+		1, 5, 6, 1, 6, 2		// +X
+	};
+}
+
+OcclusionCulling::OcclusionCulling(const UINT width, const UINT height)
+	:
+	m_width(width),
+	m_height(height),
+	m_viewProj(),
+	m_depth(static_cast<size_t>(width) * height, 1.0f),
+	m_statistics()
+{
+	assert(width % 4 == 0 && width > 0 && height > 0);
+
+	// 预先分配好所有层级
+	UINT levelWidth = width;
+	UINT levelHeight = height;
+	while (levelWidth > 1 || levelHeight > 1)
+	{
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+		m_hiZ.push_back({ levelWidth, levelHeight, std::vector<float>(static_cast<size_t>(levelWidth) * levelHeight, 1.0f) });
+	}
+}
+
+UINT OcclusionCulling::GetWidth() const
+{
+	return m_width;
+}
+
+UINT OcclusionCulling::GetHeight() const
+{
+	return m_height;
+}
+
+void OcclusionCulling::BeginFrame(FXMMATRIX viewProj)
+{
+	XMStoreFloat4x4(&m_viewProj, viewProj);
+	std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+	m_isHiZBuilt = false;
+	m_statistics = {};
+}
+
+void OcclusionCulling::RasterizeOccluder(const XMFLOAT3* vertices, const UINT vertexCount,
+	const UINT* indices, const UINT indexCount, FXMMATRIX world)
+{
+	RasterizeMesh(vertices, vertexCount, indices, indexCount, world);
+}
+
+void OcclusionCulling::RasterizeOccluder(const XMFLOAT3* vertices, const UINT vertexCount,
+	const WORD* indices, const UINT indexCount, FXMMATRIX world)
+{
+	RasterizeMesh(vertices, vertexCount, indices, indexCount, world);
+}
+
+void OcclusionCulling::RasterizeOccluder(const BoundingOrientedBox& box)
+{
+	XMFLOAT3 corners[BoundingOrientedBox::CORNER_COUNT];
+	box.GetCorners(corners);
+	RasterizeMesh(corners, BoundingOrientedBox::CORNER_COUNT, BoxIndices, 36, XMMatrixIdentity());
+}
+
+void OcclusionCulling::BuildHiZ()
+{
+	const float* pSrc = m_depth.data();
+	UINT srcWidth = m_width;
+	UINT srcHeight = m_height;
+
+	for (HiZLevel& level : m_hiZ)
+	{
+		for (UINT y = 0; y < level.height; ++y)
+		{
+			const UINT y0 = y * 2;
+			const UINT y1 = (std::min)(y0 + 1, srcHeight - 1);
+			for (UINT x = 0; x < level.width; ++x)
+			{
+				const UINT x0 = x * 2;
+				const UINT x1 = (std::min)(x0 + 1, srcWidth - 1);
+				level.depth[static_cast<size_t>(y) * level.width + x] = (std::max)(
+					(std::max)(pSrc[y0 * srcWidth + x0], pSrc[y0 * srcWidth + x1]),
+					(std::max)(pSrc[y1 * srcWidth + x0], pSrc[y1 * srcWidth + x1]));
+			}
+		}
+
+		pSrc = level.depth.data();
+		srcWidth = level.width;
+		srcHeight = level.height;
+	}
+
+	m_isHiZBuilt = true;
+}
+
+bool OcclusionCulling::IsVisible(const BoundingBox& box)
+{
+	++m_statistics.testedObjects;
+
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	box.GetCorners(corners);
+
+	const XMMATRIX viewProj = XMLoadFloat4x4(&m_viewProj);
+	XMVECTOR screenMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR screenMax = XMVectorReplicate(-FLT_MAX);
+	for (const XMFLOAT3& corner : corners)
+	{
+		const XMVECTOR clip = XMVector3Transform(XMLoadFloat3(&corner), viewProj);
+		const float w = XMVectorGetW(clip);
+		// 与近平面相交,无法得到可靠的屏幕矩形
+		if (w <= NearClipW)
+			return true;
+
+		const XMVECTOR ndc = clip / XMVectorSplatW(clip);
+		screenMin = XMVectorMin(screenMin, ndc);
+		screenMax = XMVectorMax(screenMax, ndc);
+	}
+
+	XMFLOAT3 ndcMin, ndcMax;
+	XMStoreFloat3(&ndcMin, screenMin);
+	XMStoreFloat3(&ndcMax, screenMax);
+
+	// NDC到像素坐标,注意y轴翻转
+	const float width = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+	const float pixelMinX = (ndcMin.x * 0.5f + 0.5f) * width;
+	const float pixelMaxX = (ndcMax.x * 0.5f + 0.5f) * width;
+	const float pixelMinY = (0.5f - ndcMax.y * 0.5f) * height;
+	const float pixelMaxY = (0.5f - ndcMin.y * 0.5f) * height;
+
+	// 完全位于屏幕之外
+	if (pixelMaxX < 0.0f || pixelMaxY < 0.0f || pixelMinX >= width || pixelMinY >= height)
+	{
+		++m_statistics.culledObjects;
+		return false;
+	}
+
+	const UINT x0 = static_cast<UINT>((std::max)(pixelMinX, 0.0f));
+	const UINT y0 = static_cast<UINT>((std::max)(pixelMinY, 0.0f));
+	const UINT x1 = (std::min)(static_cast<UINT>(pixelMaxX), m_width - 1);
+	const UINT y1 = (std::min)(static_cast<UINT>(pixelMaxY), m_height - 1);
+	const float nearestDepth = ndcMin.z;
+
+	// 选择使矩形最多覆盖MaxTestTexels x MaxTestTexels个纹素的层级
+	UINT level = 0;
+	if (m_isHiZBuilt)
+	{
+		UINT extent = (std::max)(x1 - x0, y1 - y0) + 1;
+		while (extent > MaxTestTexels && level < m_hiZ.size())
+		{
+			extent = (extent + 1) / 2;
+			++level;
+		}
+	}
+
+	const float* pDepth = level == 0 ? m_depth.data() : m_hiZ[level - 1].depth.data();
+	const UINT levelWidth = level == 0 ? m_width : m_hiZ[level - 1].width;
+	for (UINT y = y0 >> level; y <= y1 >> level; ++y)
+	{
+		for (UINT x = x0 >> level; x <= x1 >> level; ++x)
+		{
+			// 只要有一处物体最近点比遮挡物最远深度更近,就可能可见
+			if (nearestDepth <= pDepth[y * levelWidth + x])
+				return true;
+		}
+	}
+
+	++m_statistics.culledObjects;
+	return false;
+}
+
+const OcclusionCulling::Statistics& OcclusionCulling::GetStatistics() const
+{
+	return m_statistics;
+}
+
+const std::vector<float>& OcclusionCulling::GetDepthBuffer() const
+{
+	return m_depth;
+}
+
+template<typename IndexType>
+void OcclusionCulling::RasterizeMesh(const XMFLOAT3* vertices, const UINT vertexCount,
+	const IndexType* indices, const UINT indexCount, FXMMATRIX world)
+{
+	const XMMATRIX worldViewProj = world * XMLoadFloat4x4(&m_viewProj);
+	const float width = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+
+	m_screenVertices.resize(vertexCount);
+	for (UINT i = 0; i < vertexCount; ++i)
+	{
+		const XMVECTOR clip = XMVector3Transform(XMLoadFloat3(&vertices[i]), worldViewProj);
+		XMFLOAT4 v;
+		XMStoreFloat4(&v, clip);
+		if (v.w > NearClipW)
+		{
+			const float invW = 1.0f / v.w;
+			v.x = (v.x * invW * 0.5f + 0.5f) * width;
+			v.y = (0.5f - v.y * invW * 0.5f) * height;
+			v.z *= invW;
+		}
+		m_screenVertices[i] = v;
+	}
+
+	for (UINT i = 0; i + 2 < indexCount; i += 3)
+	{
+		const XMFLOAT4& v0 = m_screenVertices[indices[i]];
+		const XMFLOAT4& v1 = m_screenVertices[indices[i + 1]];
+		const XMFLOAT4& v2 = m_screenVertices[indices[i + 2]];
+
+		// 跳过与近平面相交的三角形
+		if (v0.w <= NearClipW || v1.w <= NearClipW || v2.w <= NearClipW ||
+			v0.z < 0.0f || v1.z < 0.0f || v2.z < 0.0f)
+			continue;
+
+		RasterizeTriangle(v0, v1, v2);
+	}
+}
+
+void OcclusionCulling::RasterizeTriangle(const XMFLOAT4& v0, const XMFLOAT4& v1, const XMFLOAT4& v2)
+{
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+	if (std::fabs(area) < 1e-8f)
+		return;
+
+	// 遮挡物不做背面剔除,统一调整为正面积的顶点顺序
+	const XMFLOAT4& a = v0;
+	const XMFLOAT4& b = area > 0.0f ? v1 : v2;
+	const XMFLOAT4& c = area > 0.0f ? v2 : v1;
+	area = std::fabs(area);
+
+	const float minX = (std::min)((std::min)(a.x, b.x), c.x);
+	const float maxX = (std::max)((std::max)(a.x, b.x), c.x);
+	const float minY = (std::min)((std::min)(a.y, b.y), c.y);
+	const float maxY = (std::max)((std::max)(a.y, b.y), c.y);
+	if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(m_width) || minY >= static_cast<float>(m_height))
+		return;
+
+	// 起始列对齐到4
+	const int x0 = static_cast<int>((std::max)(minX, 0.0f)) & ~3;
+	const int x1 = (std::min)(static_cast<int>(maxX), static_cast<int>(m_width) - 1);
+	const int y0 = static_cast<int>((std::max)(minY, 0.0f));
+	const int y1 = (std::min)(static_cast<int>(maxY), static_cast<int>(m_height) - 1);
+
+	++m_statistics.occluderTriangles;
+
+	// 边函数 E(p) = A * px + B * py + C,三角形内部三个边函数均非负
+	// 边bc对应顶点a的重心坐标,以此类推
+	const float edgeA[3] = { b.y - c.y, c.y - a.y, a.y - b.y };
+	const float edgeB[3] = { c.x - b.x, a.x - c.x, b.x - a.x };
+	const float edgeC[3] = {
+		-(edgeA[0] * b.x + edgeB[0] * b.y),
+		-(edgeA[1] * c.x + edgeB[1] * c.y),
+		-(edgeA[2] * a.x + edgeB[2] * a.y)
+	};
+
+	// 以重心坐标插值深度: z = (E0 * za + E1 * zb + E2 * zc) / area
+	const float invArea = 1.0f / area;
+	const XMVECTOR depthA = XMVectorReplicate(a.z * invArea);
+	const XMVECTOR depthB = XMVectorReplicate(b.z * invArea);
+	const XMVECTOR depthC = XMVectorReplicate(c.z * invArea);
+
+	static const XMVECTORF32 PixelOffsets = { { { 0.5f, 1.5f, 2.5f, 3.5f } } };
+	XMVECTOR rowStep[3], columnStep[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		rowStep[i] = XMVectorReplicate(edgeB[i]);
+		columnStep[i] = XMVectorReplicate(edgeA[i] * 4.0f);
+	}
+
+	const XMVECTOR startX = XMVectorAdd(XMVectorReplicate(static_cast<float>(x0)), PixelOffsets);
+	const XMVECTOR startY = XMVectorReplicate(static_cast<float>(y0) + 0.5f);
+	XMVECTOR rowEdge[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		rowEdge[i] = XMVectorMultiplyAdd(XMVectorReplicate(edgeA[i]), startX,
+			XMVectorMultiplyAdd(XMVectorReplicate(edgeB[i]), startY, XMVectorReplicate(edgeC[i])));
+	}
+
+	for (int y = y0; y <= y1; ++y)
+	{
+		float* pRow = &m_depth[static_cast<size_t>(y) * m_width];
+		XMVECTOR e0 = rowEdge[0];
+		XMVECTOR e1 = rowEdge[1];
+		XMVECTOR e2 = rowEdge[2];
+
+		for (int x = x0; x <= x1; x += 4)
+		{
+			const XMVECTOR inside = XMVectorAndInt(
+				XMVectorAndInt(XMVectorGreaterOrEqual(e0, g_XMZero), XMVectorGreaterOrEqual(e1, g_XMZero)),
+				XMVectorGreaterOrEqual(e2, g_XMZero));
+
+			if (!XMVector4EqualInt(inside, XMVectorFalseInt()))
+			{
+				const XMVECTOR depth = XMVectorMultiplyAdd(e0, depthA, XMVectorMultiplyAdd(e1, depthB, XMVectorMultiply(e2, depthC)));
+				auto* pDepth = reinterpret_cast<XMFLOAT4*>(pRow + x);
+				const XMVECTOR old = XMLoadFloat4(pDepth);
+				XMStoreFloat4(pDepth, XMVectorSelect(old, XMVectorMin(old, depth), inside));
+			}
+
+			e0 = XMVectorAdd(e0, columnStep[0]);
+			e1 = XMVectorAdd(e1, columnStep[1]);
+			e2 = XMVectorAdd(e2, columnStep[2]);
+		}
+
+		for (int i = 0; i < 3; ++i)
+			rowEdge[i] = XMVectorAdd(rowEdge[i], rowStep[i]);
+	}
+}
@@ -0,0 +1,88 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// CPU软件遮挡剔除: 将遮挡物光栅化到低分辨率深度缓冲区,
+// 再以层次Z(HiZ)测试被遮挡物在屏幕上的包围矩形
+// 完全在CPU上运行,不依赖D3D设备
+// CPU software occlusion culling with a low-resolution depth rasterizer and hierarchical-Z.
+//***************************************************************************************
+
+#ifndef OCCLUSIONCULLING_H
+#define OCCLUSIONCULLING_H
+
+#include "PortableTypes.h"
+#include <DirectXCollision.h>
+#include <vector>
+
+class OcclusionCulling
+{
+public:
+	// 统计信息,每次BeginFrame时清零
+	struct Statistics
+	{
+		UINT occluderTriangles;		// 光栅化的遮挡物三角形数目
+		UINT testedObjects;			// 测试的物体数目
+		UINT culledObjects;			// 被遮挡剔除的物体数目
+	};
+
+	// width必须为4的倍数
+	explicit OcclusionCulling(UINT width = 256, UINT height = 128);
+
+	UINT GetWidth() const;
+	UINT GetHeight() const;
+
+	// 开始新的一帧: 清空深度缓冲区并设置观察投影矩阵
+	void XM_CALLCONV BeginFrame(DirectX::FXMMATRIX viewProj);
+
+	//
+	// 光栅化遮挡物
+	// 遮挡物必须完全位于真实物体内部(例如简化后的内嵌网格),否则会错误地剔除可见物体
+	// 与近平面相交的三角形会被跳过,这只会让剔除更保守
+	//
+
+	void XM_CALLCONV RasterizeOccluder(const DirectX::XMFLOAT3* vertices, UINT vertexCount,
+		const UINT* indices, UINT indexCount, DirectX::FXMMATRIX world);
+	void XM_CALLCONV RasterizeOccluder(const DirectX::XMFLOAT3* vertices, UINT vertexCount,
+		const WORD* indices, UINT indexCount, DirectX::FXMMATRIX world);
+	void RasterizeOccluder(const DirectX::BoundingOrientedBox& box);
+
+	// 所有遮挡物光栅化完毕后构建层次Z
+	void BuildHiZ();
+
+	// 测试世界空间包围盒是否可能可见
+	// 位于屏幕外的物体视为不可见,与近平面相交的物体视为可见
+	bool IsVisible(const DirectX::BoundingBox& box);
+
+	const Statistics& GetStatistics() const;
+	// 获取深度缓冲区(行优先,近处为0,远处为1)
+	const std::vector<float>& GetDepthBuffer() const;
+
+private:
+	template<typename IndexType>
+	void XM_CALLCONV RasterizeMesh(const DirectX::XMFLOAT3* vertices, UINT vertexCount,
+		const IndexType* indices, UINT indexCount, DirectX::FXMMATRIX world);
+	// 以半空间函数光栅化一个屏幕空间三角形,每次处理4个像素
+	void RasterizeTriangle(const DirectX::XMFLOAT4& v0, const DirectX::XMFLOAT4& v1, const DirectX::XMFLOAT4& v2);
+
+	// 层次Z的一级,每个纹素保存其覆盖区域内的最大(最远)深度
+	struct HiZLevel
+	{
+		UINT width;
+		UINT height;
+		std::vector<float> depth;
+	};
+
+	UINT m_width;
+	UINT m_height;
+	DirectX::XMFLOAT4X4 m_viewProj;
+
+	std::vector<float> m_depth;
+	// 层次Z的第1级及以上,第0级即m_depth
+	std::vector<HiZLevel> m_hiZ;
+	bool m_isHiZBuilt = false;
+	std::vector<DirectX::XMFLOAT4> m_screenVertices;		// 变换后的顶点缓存(x, y为像素坐标, z为深度, w为裁剪空间w)
+
+	Statistics m_statistics;
+};
+
+#endif
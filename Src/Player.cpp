@@ -66,4 +66,19 @@ void Player::SetPosition(const XMFLOAT3& position)
 void Player::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect)
 {
 	m_tank.Draw(deviceContext, effect);
+}
+
+void Player::UpdateBounds()
+{
+	m_tank.UpdateBounds();
+}
+
+void Player::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingFrustum& frustum, GameObject::CullStatistics* pStatistics)
+{
+	m_tank.Draw(deviceContext, effect, frustum, pStatistics);
+}
+
+void Player::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const BoundingOrientedBox& volume, GameObject::CullStatistics* pStatistics)
+{
+	m_tank.Draw(deviceContext, effect, volume, pStatistics);
 }
\ No newline at end of file
@@ -27,8 +27,13 @@ public:
 	
 	void XM_CALLCONV AdjustPosition(DirectX::FXMVECTOR minCoordinate, DirectX::FXMVECTOR maxCoordinate);
 
-	// 绘制
+	// 绘制,需要先调用UpdateBounds
 	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect);
+	// 重新计算世界矩阵与层次包围盒,每帧在绘制前调用一次
+	void UpdateBounds();
+	// 以层次包围盒剔除后绘制,需要先调用UpdateBounds,pStatistics可以为nullptr
+	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingFrustum& frustum, GameObject::CullStatistics* pStatistics);
+	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingOrientedBox& volume, GameObject::CullStatistics* pStatistics);
 
 private:
 
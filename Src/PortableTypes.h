@@ -0,0 +1,30 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 不依赖D3D的模块(碰撞、剔除、排序等)只需要UINT等基础类型
+// Windows下直接使用SDK中的定义,其它平台(单元测试)使用相同宽度的标准类型
+// Windows integer typedefs for modules that do not need the D3D headers.
+//***************************************************************************************
+
+#ifndef PORTABLETYPES_H
+#define PORTABLETYPES_H
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cstdint>
+
+using BYTE = uint8_t;
+using UINT8 = uint8_t;
+using WORD = uint16_t;
+using UINT16 = uint16_t;
+using INT = int32_t;
+using UINT = uint32_t;
+using UINT32 = uint32_t;
+using DWORD = uint32_t;
+using BOOL = int32_t;
+using INT64 = int64_t;
+using UINT64 = uint64_t;
+#endif
+
+#endif
@@ -0,0 +1,53 @@
+#include "Ray.h"
+
+#include <cassert>
+
+using namespace DirectX;
+
+Ray::Ray(const XMFLOAT3 origin, FXMVECTOR direction)
+	:
+	origin(origin),
+	direction()
+{
+	// 射线的direction长度必须为1.0f，误差在1e-5f内
+	assert(XMVector3Less(XMVectorAbs(XMVector3Length(direction) - XMVectorSplatOne()), XMVectorReplicate(1e-5f)));
+
+	XMStoreFloat3(&this->direction, XMVector3Normalize(direction));
+}
+
+bool Ray::Hit(const BoundingBox& box, float* pOutDist, const float maxDist) const
+{
+
+	float dist;
+	const bool res = box.Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), dist);
+	if (pOutDist)
+		*pOutDist = dist;
+	return dist > maxDist ? false : res;
+}
+
+bool Ray::Hit(const BoundingOrientedBox& box, float* pOutDist, const float maxDist) const
+{
+	float dist;
+	const bool res = box.Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), dist);
+	if (pOutDist)
+		*pOutDist = dist;
+	return dist > maxDist ? false : res;
+}
+
+bool Ray::Hit(const BoundingSphere& sphere, float* pOutDist, const float maxDist) const
+{
+	float dist;
+	const bool res = sphere.Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), dist);
+	if (pOutDist)
+		*pOutDist = dist;
+	return dist > maxDist ? false : res;
+}
+
+bool XM_CALLCONV Ray::Hit(FXMVECTOR vertex0, FXMVECTOR vertex1, FXMVECTOR vertex2, float* pOutDist, const float maxDist) const
+{
+	float dist;
+	const bool res = TriangleTests::Intersects(XMLoadFloat3(&origin), XMLoadFloat3(&direction), vertex0, vertex1, vertex2, dist);
+	if (pOutDist)
+		*pOutDist = dist;
+	return dist > maxDist ? false : res;
+}
@@ -0,0 +1,35 @@
+//***************************************************************************************
+// Author: X_Jun(MKXJun)(MIT License)
+//
+// Modified By: life4gal(NiceT)(MIT License)
+//
+// 射线,从Collision.h中拆分出来,不依赖D3D,可以在射线包与单元测试中单独使用
+// ScreenToRay需要Camera,定义在Collision.cpp中
+// Ray with intersection queries against bounding volumes and triangles.
+//***************************************************************************************
+
+#ifndef RAY_H
+#define RAY_H
+
+#include <DirectXCollision.h>
+#include <cfloat>
+
+class Camera;
+
+struct Ray
+{
+	Ray(DirectX::XMFLOAT3 origin, DirectX::FXMVECTOR direction);
+
+	static Ray ScreenToRay(const Camera& camera, float screenX, float screenY);
+
+	bool Hit(const DirectX::BoundingBox& box, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
+	bool Hit(const DirectX::BoundingOrientedBox& box, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
+	bool Hit(const DirectX::BoundingSphere& sphere, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
+	// 三角形检测
+	bool XM_CALLCONV Hit(DirectX::FXMVECTOR vertex0, DirectX::FXMVECTOR vertex1, DirectX::FXMVECTOR vertex2, float* pOutDist = nullptr, float maxDist = FLT_MAX) const;
+
+	DirectX::XMFLOAT3 origin;		// 射线原点
+	DirectX::XMFLOAT3 direction;	// 单位方向向量
+};
+
+#endif
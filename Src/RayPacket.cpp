@@ -0,0 +1,327 @@
+#include "RayPacket.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+namespace
+{
+	// 将比较结果转为通道掩码
+	UINT XM_CALLCONV GetLaneMask(FXMVECTOR control)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		return static_cast<UINT>(_mm_movemask_ps(control));
+#else
+		XMUINT4 lanes;
+		XMStoreUInt4(&lanes, control);
+		return (lanes.x >> 31) | (lanes.y >> 31) << 1 | (lanes.z >> 31) << 2 | (lanes.w >> 31) << 3;
+#endif
+	}
+
+	XMVECTOR XM_CALLCONV SafeReciprocal(FXMVECTOR v)
+	{
+		static const XMVECTORF32 Tiny = { { { 1e-20f, 1e-20f, 1e-20f, 1e-20f } } };
+		const XMVECTOR isSmall = XMVectorLess(XMVectorAbs(v), Tiny);
+		const XMVECTOR signedTiny = XMVectorSelect(Tiny, XMVectorNegate(Tiny), XMVectorLess(v, g_XMZero));
+		return XMVectorReciprocal(XMVectorSelect(v, signedTiny, isSmall));
+	}
+
+	// 4条射线与同一个AABB的slab测试
+	// 返回命中控制向量,pOutNear为各通道的进入距离(原点位于盒内时为0)
+	XMVECTOR XM_CALLCONV PacketSlab(
+		FXMVECTOR originX, FXMVECTOR originY, FXMVECTOR originZ,
+		GXMVECTOR invDirectionX, HXMVECTOR invDirectionY, HXMVECTOR invDirectionZ,
+		CXMVECTOR closest, CXMVECTOR active,
+		const XMFLOAT3& boxMin, const XMFLOAT3& boxMax, XMVECTOR* pOutNear)
+	{
+		const XMVECTOR t0x = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(boxMin.x), originX), invDirectionX);
+		const XMVECTOR t1x = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(boxMax.x), originX), invDirectionX);
+		const XMVECTOR t0y = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(boxMin.y), originY), invDirectionY);
+		const XMVECTOR t1y = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(boxMax.y), originY), invDirectionY);
+		const XMVECTOR t0z = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(boxMin.z), originZ), invDirectionZ);
+		const XMVECTOR t1z = XMVectorMultiply(XMVectorSubtract(XMVectorReplicate(boxMax.z), originZ), invDirectionZ);
+
+		const XMVECTOR tNear = XMVectorMax(
+			XMVectorMax(XMVectorMin(t0x, t1x), XMVectorMin(t0y, t1y)),
+			XMVectorMax(XMVectorMin(t0z, t1z), g_XMZero));
+		const XMVECTOR tFar = XMVectorMin(
+			XMVectorMin(XMVectorMax(t0x, t1x), XMVectorMax(t0y, t1y)),
+			XMVectorMin(XMVectorMax(t0z, t1z), closest));
+
+		*pOutNear = tNear;
+		return XMVectorAndInt(XMVectorLessOrEqual(tNear, tFar), active);
+	}
+
+	// 写回命中通道的索引
+	void RecordHits(UINT mask, const UINT index, UINT (&indices)[RayPacket::Width])
+	{
+		for (UINT lane = 0; mask; ++lane, mask >>= 1)
+		{
+			if (mask & 1)
+				indices[lane] = index;
+		}
+	}
+
+	template<typename Shape>
+	void HitBatchImpl(const std::vector<Ray>& rays, const std::vector<Shape>& shapes, std::vector<RayHit>& outHits, const float maxDist)
+	{
+		outHits.resize(rays.size());
+
+		const UINT rayCount = static_cast<UINT>(rays.size());
+		const UINT shapeCount = static_cast<UINT>(shapes.size());
+		for (UINT first = 0; first < rayCount; first += RayPacket::Width)
+		{
+			const UINT count = (std::min)(RayPacket::Width, rayCount - first);
+			const RayPacket packet(rays.data() + first, count);
+
+			XMVECTOR closest = XMVectorReplicate(maxDist);
+			UINT indices[RayPacket::Width] = { RayHit::InvalidIndex, RayHit::InvalidIndex, RayHit::InvalidIndex, RayHit::InvalidIndex };
+			for (UINT i = 0; i < shapeCount; ++i)
+			{
+				const UINT mask = packet.Hit(shapes[i], &closest);
+				if (mask)
+					RecordHits(mask, i, indices);
+			}
+
+			XMFLOAT4 dists{};
+			XMStoreFloat4(&dists, closest);
+			const float* pDists = &dists.x;
+			for (UINT lane = 0; lane < count; ++lane)
+			{
+				outHits[first + lane] = { pDists[lane], indices[lane] };
+			}
+		}
+	}
+}
+
+RayPacket::RayPacket(const Ray* rays, UINT count)
+	:
+	activeMask()
+{
+	count = (std::min)(count, Width);
+
+	// 非活动通道复制第一条射线,保证计算过程中不会出现无意义的值
+	XMFLOAT4 lanes[6]{};
+	for (UINT lane = 0; lane < Width; ++lane)
+	{
+		const Ray& ray = rays[lane < count ? lane : 0];
+		(&lanes[0].x)[lane] = ray.origin.x;
+		(&lanes[1].x)[lane] = ray.origin.y;
+		(&lanes[2].x)[lane] = ray.origin.z;
+		(&lanes[3].x)[lane] = ray.direction.x;
+		(&lanes[4].x)[lane] = ray.direction.y;
+		(&lanes[5].x)[lane] = ray.direction.z;
+	}
+
+	originX = XMLoadFloat4(&lanes[0]);
+	originY = XMLoadFloat4(&lanes[1]);
+	originZ = XMLoadFloat4(&lanes[2]);
+	directionX = XMLoadFloat4(&lanes[3]);
+	directionY = XMLoadFloat4(&lanes[4]);
+	directionZ = XMLoadFloat4(&lanes[5]);
+	invDirectionX = SafeReciprocal(directionX);
+	invDirectionY = SafeReciprocal(directionY);
+	invDirectionZ = SafeReciprocal(directionZ);
+
+	activeMask = (1u << count) - 1;
+	active = XMVectorSelectControl(count > 0, count > 1, count > 2, count > 3);
+}
+
+UINT RayPacket::Hit(const BoundingBox& box, XMVECTOR* pInOutDist) const
+{
+	const XMFLOAT3 boxMin(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+	const XMFLOAT3 boxMax(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+
+	XMVECTOR tNear;
+	const XMVECTOR hit = PacketSlab(originX, originY, originZ, invDirectionX, invDirectionY, invDirectionZ,
+		*pInOutDist, active, boxMin, boxMax, &tNear);
+
+	*pInOutDist = XMVectorSelect(*pInOutDist, tNear, hit);
+	return GetLaneMask(hit);
+}
+
+UINT RayPacket::Hit(const BoundingOrientedBox& box, XMVECTOR* pInOutDist) const
+{
+	// 将射线变换到OBB的局部坐标系中,再当作以原点为中心的AABB处理
+	// 旋转矩阵的每一行即OBB的一个局部轴在世界空间中的方向
+	const XMMATRIX rotation = XMMatrixRotationQuaternion(XMLoadFloat4(&box.Orientation));
+	XMFLOAT4X4 axes{};
+	XMStoreFloat4x4(&axes, rotation);
+
+	const XMVECTOR relX = XMVectorSubtract(originX, XMVectorReplicate(box.Center.x));
+	const XMVECTOR relY = XMVectorSubtract(originY, XMVectorReplicate(box.Center.y));
+	const XMVECTOR relZ = XMVectorSubtract(originZ, XMVectorReplicate(box.Center.z));
+
+	XMVECTOR localOrigin[3];
+	XMVECTOR localInvDirection[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		const XMVECTOR ax = XMVectorReplicate(axes(i, 0));
+		const XMVECTOR ay = XMVectorReplicate(axes(i, 1));
+		const XMVECTOR az = XMVectorReplicate(axes(i, 2));
+		localOrigin[i] = XMVectorMultiplyAdd(relZ, az, XMVectorMultiplyAdd(relY, ay, XMVectorMultiply(relX, ax)));
+		localInvDirection[i] = SafeReciprocal(
+			XMVectorMultiplyAdd(directionZ, az, XMVectorMultiplyAdd(directionY, ay, XMVectorMultiply(directionX, ax))));
+	}
+
+	const XMFLOAT3 boxMin(-box.Extents.x, -box.Extents.y, -box.Extents.z);
+	XMVECTOR tNear;
+	const XMVECTOR hit = PacketSlab(localOrigin[0], localOrigin[1], localOrigin[2],
+		localInvDirection[0], localInvDirection[1], localInvDirection[2],
+		*pInOutDist, active, boxMin, box.Extents, &tNear);
+
+	*pInOutDist = XMVectorSelect(*pInOutDist, tNear, hit);
+	return GetLaneMask(hit);
+}
+
+UINT RayPacket::Hit(const BoundingSphere& sphere, XMVECTOR* pInOutDist) const
+{
+	// 与BoundingSphere::Intersects保持一致: 原点位于球内时取离开球面的距离
+	const XMVECTOR lx = XMVectorSubtract(XMVectorReplicate(sphere.Center.x), originX);
+	const XMVECTOR ly = XMVectorSubtract(XMVectorReplicate(sphere.Center.y), originY);
+	const XMVECTOR lz = XMVectorSubtract(XMVectorReplicate(sphere.Center.z), originZ);
+
+	// s为球心在射线上的投影长度
+	const XMVECTOR s = XMVectorMultiplyAdd(lz, directionZ, XMVectorMultiplyAdd(ly, directionY, XMVectorMultiply(lx, directionX)));
+	const XMVECTOR l2 = XMVectorMultiplyAdd(lz, lz, XMVectorMultiplyAdd(ly, ly, XMVectorMultiply(lx, lx)));
+	const XMVECTOR r2 = XMVectorReplicate(sphere.Radius * sphere.Radius);
+	// 球心到射线距离的平方
+	const XMVECTOR m2 = XMVectorNegativeMultiplySubtract(s, s, l2);
+
+	const XMVECTOR originInside = XMVectorLessOrEqual(l2, r2);
+	const XMVECTOR noIntersection = XMVectorOrInt(
+		XMVectorAndCInt(XMVectorLess(s, g_XMZero), originInside),
+		XMVectorGreater(m2, r2));
+
+	const XMVECTOR q = XMVectorSqrt(XMVectorMax(XMVectorSubtract(r2, m2), g_XMZero));
+	const XMVECTOR t = XMVectorSelect(XMVectorSubtract(s, q), XMVectorAdd(s, q), originInside);
+
+	const XMVECTOR hit = XMVectorAndInt(
+		XMVectorAndCInt(XMVectorLess(t, *pInOutDist), noIntersection),
+		active);
+
+	*pInOutDist = XMVectorSelect(*pInOutDist, t, hit);
+	return GetLaneMask(hit);
+}
+
+void RayPacket::Hit(const BoundingVolumeHierarchy& bvh, RayHit* pOutHits, const float maxDist) const
+{
+	XMVECTOR closest = XMVectorReplicate(maxDist);
+	UINT indices[Width] = { RayHit::InvalidIndex, RayHit::InvalidIndex, RayHit::InvalidIndex, RayHit::InvalidIndex };
+
+	const auto& nodes = bvh.GetNodes();
+	const auto& primitiveIndices = bvh.GetPrimitiveIndices();
+	const auto& primitiveBoxes = bvh.GetPrimitiveBoxes();
+
+	BoundingVolumeHierarchy::TraversalStack stack(bvh.GetDepth());
+	if (!nodes.empty())
+		stack.Push(0);
+
+	while (!stack.Empty())
+	{
+		const BoundingVolumeHierarchy::Node& node = nodes[stack.Pop()];
+
+		// 只要有一条射线比当前最近命中更早进入节点就需要继续
+		XMVECTOR tNear;
+		const XMVECTOR nodeHit = PacketSlab(originX, originY, originZ, invDirectionX, invDirectionY, invDirectionZ,
+			closest, active, node.boxMin, node.boxMax, &tNear);
+		if (GetLaneMask(nodeHit) == 0)
+			continue;
+
+		// 未命中节点的通道也不会命中其中的子节点与图元,之后的测试只对nodeHit中的通道进行
+		if (node.IsLeaf())
+		{
+			for (UINT i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+			{
+				const UINT primitive = primitiveIndices[i];
+				const BoundingBox& box = primitiveBoxes[primitive];
+				const XMFLOAT3 boxMin(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+				const XMFLOAT3 boxMax(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+
+				XMVECTOR tNear;
+				const XMVECTOR hit = PacketSlab(originX, originY, originZ, invDirectionX, invDirectionY, invDirectionZ,
+					closest, nodeHit, boxMin, boxMax, &tNear);
+				const UINT mask = GetLaneMask(hit);
+				if (mask)
+				{
+					closest = XMVectorSelect(closest, tNear, hit);
+					RecordHits(mask, primitive, indices);
+				}
+			}
+		}
+		else
+		{
+			// 兄弟节点相邻存放,一并读取后按照进入距离由近到远遍历
+			const BoundingVolumeHierarchy::Node& left = nodes[node.leftOrFirst];
+			const BoundingVolumeHierarchy::Node& right = nodes[node.leftOrFirst + 1];
+
+			XMVECTOR leftNear, rightNear;
+			const XMVECTOR leftHit = PacketSlab(originX, originY, originZ, invDirectionX, invDirectionY, invDirectionZ,
+				closest, nodeHit, left.boxMin, left.boxMax, &leftNear);
+			const XMVECTOR rightHit = PacketSlab(originX, originY, originZ, invDirectionX, invDirectionY, invDirectionZ,
+				closest, nodeHit, right.boxMin, right.boxMax, &rightNear);
+
+			const UINT leftMask = GetLaneMask(leftHit);
+			const UINT rightMask = GetLaneMask(rightHit);
+			if (leftMask == 0 || rightMask == 0)
+			{
+				// 只命中一个子节点时不需要排序
+				if (leftMask)
+					stack.Push(node.leftOrFirst);
+				else if (rightMask)
+					stack.Push(node.leftOrFirst + 1);
+				continue;
+			}
+
+			// 以命中通道中的最小进入距离作为排序依据
+			XMFLOAT4 leftDists{}, rightDists{};
+			XMStoreFloat4(&leftDists, XMVectorSelect(g_XMFltMax, leftNear, leftHit));
+			XMStoreFloat4(&rightDists, XMVectorSelect(g_XMFltMax, rightNear, rightHit));
+			const float leftMin = (std::min)((std::min)(leftDists.x, leftDists.y), (std::min)(leftDists.z, leftDists.w));
+			const float rightMin = (std::min)((std::min)(rightDists.x, rightDists.y), (std::min)(rightDists.z, rightDists.w));
+
+			const bool leftFirst = leftMin <= rightMin;
+			stack.Push(leftFirst ? node.leftOrFirst + 1 : node.leftOrFirst);
+			stack.Push(leftFirst ? node.leftOrFirst : node.leftOrFirst + 1);
+		}
+	}
+
+	XMFLOAT4 dists{};
+	XMStoreFloat4(&dists, closest);
+	const float* pDists = &dists.x;
+	for (UINT lane = 0; lane < Width; ++lane)
+	{
+		pOutHits[lane] = { pDists[lane], indices[lane] };
+	}
+}
+
+void RayPacket::HitBatch(const std::vector<Ray>& rays, const std::vector<BoundingBox>& boxes, std::vector<RayHit>& outHits, const float maxDist)
+{
+	HitBatchImpl(rays, boxes, outHits, maxDist);
+}
+
+void RayPacket::HitBatch(const std::vector<Ray>& rays, const std::vector<BoundingOrientedBox>& boxes, std::vector<RayHit>& outHits, const float maxDist)
+{
+	HitBatchImpl(rays, boxes, outHits, maxDist);
+}
+
+void RayPacket::HitBatch(const std::vector<Ray>& rays, const std::vector<BoundingSphere>& spheres, std::vector<RayHit>& outHits, const float maxDist)
+{
+	HitBatchImpl(rays, spheres, outHits, maxDist);
+}
+
+void RayPacket::HitBatch(const std::vector<Ray>& rays, const BoundingVolumeHierarchy& bvh, std::vector<RayHit>& outHits, const float maxDist)
+{
+	outHits.resize(rays.size());
+
+	const UINT rayCount = static_cast<UINT>(rays.size());
+	RayHit hits[Width];
+	for (UINT first = 0; first < rayCount; first += Width)
+	{
+		const UINT count = (std::min)(Width, rayCount - first);
+		const RayPacket packet(rays.data() + first, count);
+		packet.Hit(bvh, hits, maxDist);
+
+		std::copy_n(hits, count, outHits.begin() + first);
+	}
+}
@@ -0,0 +1,72 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 射线包: 将4条射线以SoA形式打包,利用SIMD一次与同一个包围体求交
+// 适用于大量开炮/视线检测等相互独立的射线查询
+// Ray packets: four rays in SoA layout intersected against one bounding volume at a time.
+//***************************************************************************************
+
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+
+#include "Ray.h"
+#include "BoundingVolumeHierarchy.h"
+
+#include <vector>
+
+// 射线命中结果
+struct RayHit
+{
+	float dist;		// 命中距离
+	UINT index;		// 命中物体的索引,未命中为InvalidIndex
+
+	static constexpr UINT InvalidIndex = 0xFFFFFFFF;
+};
+
+// 4条射线组成的射线包
+// XMVECTOR的4个分量分别对应4条射线,DirectXMath在x86下使用SSE,在ARM下使用NEON
+struct RayPacket
+{
+	static constexpr UINT Width = 4;
+
+	// 从连续的射线中载入最多Width条,不足的通道处于非活动状态
+	RayPacket(const Ray* rays, UINT count);
+
+	//
+	// 与单个包围体求交
+	// pInOutDist 各通道当前的最近距离,只有比它更近的命中才会被记录并写回
+	// 返回命中掩码,第i位对应第i条射线
+	//
+
+	UINT Hit(const DirectX::BoundingBox& box, DirectX::XMVECTOR* pInOutDist) const;
+	UINT Hit(const DirectX::BoundingOrientedBox& box, DirectX::XMVECTOR* pInOutDist) const;
+	UINT Hit(const DirectX::BoundingSphere& sphere, DirectX::XMVECTOR* pInOutDist) const;
+
+	// 与BVH求最近命中,pOutHits需要能够容纳Width个结果
+	// 4条射线共享同一次节点读取,只要有一条射线命中节点就继续向下遍历
+	// 子节点与图元只对命中父节点的通道测试,只命中一个子节点时不排序
+	void Hit(const BoundingVolumeHierarchy& bvh, RayHit* pOutHits, float maxDist = FLT_MAX) const;
+
+	//
+	// 批量查询: 对每条射线求与一组物体的最近命中,outHits与rays一一对应
+	//
+
+	static void HitBatch(const std::vector<Ray>& rays, const std::vector<DirectX::BoundingBox>& boxes, std::vector<RayHit>& outHits, float maxDist = FLT_MAX);
+	static void HitBatch(const std::vector<Ray>& rays, const std::vector<DirectX::BoundingOrientedBox>& boxes, std::vector<RayHit>& outHits, float maxDist = FLT_MAX);
+	static void HitBatch(const std::vector<Ray>& rays, const std::vector<DirectX::BoundingSphere>& spheres, std::vector<RayHit>& outHits, float maxDist = FLT_MAX);
+	static void HitBatch(const std::vector<Ray>& rays, const BoundingVolumeHierarchy& bvh, std::vector<RayHit>& outHits, float maxDist = FLT_MAX);
+
+	DirectX::XMVECTOR originX;
+	DirectX::XMVECTOR originY;
+	DirectX::XMVECTOR originZ;
+	DirectX::XMVECTOR directionX;
+	DirectX::XMVECTOR directionY;
+	DirectX::XMVECTOR directionZ;
+	DirectX::XMVECTOR invDirectionX;
+	DirectX::XMVECTOR invDirectionY;
+	DirectX::XMVECTOR invDirectionZ;
+	DirectX::XMVECTOR active;		// 活动通道为全1
+	UINT activeMask;				// 活动通道掩码
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "RecordingThreadCheck.h"
+
+namespace
+{
+	std::atomic<UINT> g_epoch{ 0 };
+	std::atomic<UINT> g_threadCount{ 0 };
+
+	// 每个线程第一次使用时分配的编号,从1开始
+	UINT GetThreadNumber()
+	{
+		thread_local const UINT threadNumber = g_threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+		return threadNumber;
+	}
+}
+
+void RecordingThreadCheck::AdvanceEpoch()
+{
+	g_epoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+UINT RecordingThreadCheck::GetEpoch()
+{
+	return g_epoch.load(std::memory_order_acquire);
+}
+
+bool RecordingThreadCheck::Acquire()
+{
+	const UINT64 epoch = GetEpoch();
+	const UINT64 owner = epoch << 32 | GetThreadNumber();
+
+	// 本次录制中当前线程已经使用过,不需要写入
+	UINT64 current = m_owner.load(std::memory_order_relaxed);
+	if (current == owner)
+		return true;
+
+	// 本次录制中还没有所属线程时尝试成为所属线程,失败时current为其它线程写入的值
+	while ((current >> 32) != epoch || (current & 0xFFFFFFFF) == 0)
+	{
+		if (m_owner.compare_exchange_weak(current, owner, std::memory_order_acq_rel, std::memory_order_relaxed))
+			return true;
+	}
+	return current == owner;
+}
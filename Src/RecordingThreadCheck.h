@@ -0,0 +1,42 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 多线程录制的线程检查
+// 特效的常量缓冲区暂存数据与资源槽被它的所有渲染通道共享,多个线程同时修改会得到错误的绘制结果
+// 每次CommandListRecorder::Record开始与结束时推进录制编号,同一编号内只允许一个线程使用同一个对象
+// 所属线程与录制编号合并为一个原子变量,同一线程重复使用时只需一次读取,发布版本中同样启用
+// 不依赖D3D,EffectHelper与单元测试共用同一份实现
+// Lock-free check, enabled in all builds, that an object is used from a single thread within one recording.
+//***************************************************************************************
+
+#ifndef RECORDINGTHREADCHECK_H
+#define RECORDINGTHREADCHECK_H
+
+#include "PortableTypes.h"
+
+#include <atomic>
+
+class RecordingThreadCheck
+{
+public:
+	RecordingThreadCheck() = default;
+	~RecordingThreadCheck() = default;
+
+	// 拷贝得到的对象重新确定所属线程
+	RecordingThreadCheck(const RecordingThreadCheck&) : RecordingThreadCheck() {}
+	RecordingThreadCheck& operator=(const RecordingThreadCheck&) { return *this; }
+
+	// 开始或结束一次多线程录制,之后第一个调用Acquire的线程成为所属线程
+	static void AdvanceEpoch();
+	static UINT GetEpoch();
+
+	// 当前线程将要使用该对象,返回false表示本次录制中已经有其它线程使用过
+	// 多个线程同时调用时只有一个线程成功
+	bool Acquire();
+
+private:
+	// 高32位为录制编号,低32位为所属线程的编号,0表示没有所属线程
+	std::atomic<UINT64> m_owner{ 0 };
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "RenderBackend.h"
+
+#include <cstring>
+
+RecordingRenderBackend::RecordingRenderBackend()
+	:
+	m_statistics(),
+	m_vertexBuffers(),
+	m_indexBuffer(),
+	m_indexFormat(),
+	m_indexOffset(),
+	m_topology(),
+	m_effectRenderState()
+{
+	Clear();
+}
+
+void RecordingRenderBackend::Clear()
+{
+	m_commands.clear();
+	m_statistics = {};
+	m_objectIds.clear();
+
+	memset(m_vertexBuffers, 0xFF, sizeof(m_vertexBuffers));
+	m_indexBuffer = m_indexFormat = m_indexOffset = ~0u;
+	m_topology = ~0u;
+	m_effectRenderState = ~0u;
+}
+
+const std::vector<RecordingRenderBackend::Command>& RecordingRenderBackend::GetCommands() const
+{
+	return m_commands;
+}
+
+const RecordingRenderBackend::Statistics& RecordingRenderBackend::GetStatistics() const
+{
+	return m_statistics;
+}
+
+std::string RecordingRenderBackend::ToString() const
+{
+	static const char* const s_names[] =
+	{
+		"Map", "Unmap", "SetVertexBuffer", "SetIndexBuffer", "SetPrimitiveTopology",
+		"SetEffectRenderState", "ApplyEffect", "Draw", "DrawIndexed", "DrawIndexedInstanced"
+	};
+	static const UINT s_argCounts[] = { 4, 1, 4, 3, 1, 1, 1, 2, 3, 5 };
+
+	std::string text;
+	for (const Command& command : m_commands)
+	{
+		const UINT type = static_cast<UINT>(command.type);
+		text += s_names[type];
+		for (UINT i = 0; i < s_argCounts[type]; ++i)
+		{
+			text += ' ';
+			// DrawXXX的baseVertex为有符号数
+			text += std::to_string(static_cast<INT>(command.args[i]));
+		}
+		text += '\n';
+	}
+	return text;
+}
+
+void* RecordingRenderBackend::Map(RenderBuffer* buffer, const RenderMapType mapType, const UINT byteOffset, const UINT byteCount)
+{
+	Record(CommandType::Map, GetObjectId(buffer), static_cast<UINT>(mapType), byteOffset, byteCount);
+	++m_statistics.maps;
+	m_statistics.bytesUploaded += byteCount;
+
+	if (m_mappedData.size() < byteCount)
+		m_mappedData.resize(byteCount);
+	return m_mappedData.data();
+}
+
+void RecordingRenderBackend::Unmap(RenderBuffer* buffer)
+{
+	Record(CommandType::Unmap, GetObjectId(buffer));
+}
+
+void RecordingRenderBackend::SetVertexBuffers(const UINT startSlot, const UINT numBuffers, RenderBuffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	for (UINT i = 0; i < numBuffers; ++i)
+	{
+		const VertexBufferBinding binding{ GetObjectId(buffers[i]), strides[i], offsets[i] };
+		VertexBufferBinding& current = m_vertexBuffers[startSlot + i];
+		CountStateChange(current.buffer != binding.buffer || current.stride != binding.stride || current.offset != binding.offset);
+		current = binding;
+		Record(CommandType::SetVertexBuffer, startSlot + i, binding.buffer, binding.stride, binding.offset);
+	}
+}
+
+void RecordingRenderBackend::SetIndexBuffer(RenderBuffer* buffer, const RenderIndexFormat format, const UINT offset)
+{
+	const UINT id = GetObjectId(buffer);
+	CountStateChange(m_indexBuffer != id || m_indexFormat != static_cast<UINT>(format) || m_indexOffset != offset);
+	m_indexBuffer = id;
+	m_indexFormat = static_cast<UINT>(format);
+	m_indexOffset = offset;
+	Record(CommandType::SetIndexBuffer, id, m_indexFormat, offset);
+}
+
+void RecordingRenderBackend::SetPrimitiveTopology(const RenderTopology topology)
+{
+	CountStateChange(m_topology != static_cast<UINT>(topology));
+	m_topology = static_cast<UINT>(topology);
+	Record(CommandType::SetPrimitiveTopology, m_topology);
+}
+
+void RecordingRenderBackend::SetEffectRenderState(const RenderState* renderState)
+{
+	const UINT id = GetObjectId(renderState);
+	CountStateChange(m_effectRenderState != id);
+	m_effectRenderState = id;
+	Record(CommandType::SetEffectRenderState, id);
+}
+
+void RecordingRenderBackend::ApplyEffect(RenderEffect* effect)
+{
+	Record(CommandType::ApplyEffect, GetObjectId(effect));
+	++m_statistics.effectApplies;
+}
+
+void RecordingRenderBackend::Draw(const UINT vertexCount, const UINT startVertex)
+{
+	Record(CommandType::Draw, vertexCount, startVertex);
+	++m_statistics.drawCalls;
+	m_statistics.indexCount += vertexCount;
+	++m_statistics.instanceCount;
+}
+
+void RecordingRenderBackend::DrawIndexed(const UINT indexCount, const UINT startIndex, const INT baseVertex)
+{
+	Record(CommandType::DrawIndexed, indexCount, startIndex, static_cast<UINT>(baseVertex));
+	++m_statistics.drawCalls;
+	m_statistics.indexCount += indexCount;
+	++m_statistics.instanceCount;
+}
+
+void RecordingRenderBackend::DrawIndexedInstanced(const UINT indexCount, const UINT instanceCount, const UINT startIndex, const INT baseVertex, const UINT startInstance)
+{
+	Record(CommandType::DrawIndexedInstanced, indexCount, instanceCount, startIndex, static_cast<UINT>(baseVertex), startInstance);
+	++m_statistics.drawCalls;
+	m_statistics.indexCount += static_cast<UINT64>(indexCount) * instanceCount;
+	m_statistics.instanceCount += instanceCount;
+}
+
+UINT RecordingRenderBackend::GetObjectId(const void* object)
+{
+	if (!object)
+		return 0;
+	return m_objectIds.try_emplace(object, static_cast<UINT>(m_objectIds.size()) + 1).first->second;
+}
+
+void RecordingRenderBackend::Record(const CommandType type, const UINT arg0, const UINT arg1, const UINT arg2, const UINT arg3, const UINT arg4)
+{
+	m_commands.push_back({ type, { arg0, arg1, arg2, arg3, arg4 } });
+}
+
+void RecordingRenderBackend::CountStateChange(const bool isChanged)
+{
+	if (isChanged)
+		++m_statistics.stateChanges;
+	else
+		++m_statistics.redundantStateChanges;
+}
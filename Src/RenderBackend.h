@@ -0,0 +1,176 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 渲染命令后端
+// 提交端(渲染队列、游戏对象、天空盒等)通过IRenderBackend映射缓冲区、绑定状态、应用特效与绘制,
+// 不再直接使用ID3D11DeviceContext
+// 缓冲区、特效与渲染状态以不透明句柄传递,提交端只传递与比较,不依赖D3D
+// D3D11RenderBackend(RenderBackendD3D11.h)将句柄还原为D3D对象并转发给设备上下文
+// RecordingRenderBackend只记录命令并统计上传字节数、状态切换与绘制次数,不调用D3D,
+// 可以用于度量提交端的开销,或比较两帧的命令流
+// Render command abstraction with opaque handles and a headless recording backend.
+//***************************************************************************************
+
+#ifndef RENDERBACKEND_H
+#define RENDERBACKEND_H
+
+#include "PortableTypes.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 不透明句柄,只声明不定义,由具体的后端转换为自己的对象
+struct RenderBuffer;		// 顶点/索引/实例缓冲区
+struct RenderEffect;		// 特效
+struct RenderState;			// 特效的渲染状态(着色器、输入布局等)
+
+enum class RenderMapType : UINT
+{
+	WriteDiscard,			// 丢弃缓冲区原有的内容
+	WriteNoOverwrite		// 追加写入,保证不覆盖本帧已经使用的数据
+};
+
+enum class RenderIndexFormat : UINT
+{
+	UInt16,
+	UInt32
+};
+
+enum class RenderTopology : UINT
+{
+	PointList,
+	LineList,
+	LineStrip,
+	TriangleList,
+	TriangleStrip
+};
+
+class IRenderBackend
+{
+public:
+	// 顶点缓冲区槽的数目,与D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT相同
+	static constexpr UINT VertexBufferSlotCount = 32;
+
+	virtual ~IRenderBackend() = default;
+
+	//
+	// 缓冲区
+	//
+
+	// 映射缓冲区用于写入,返回从byteOffset开始的byteCount字节,写入完成后需要调用Unmap
+	virtual void* Map(RenderBuffer* buffer, RenderMapType mapType, UINT byteOffset, UINT byteCount) = 0;
+	virtual void Unmap(RenderBuffer* buffer) = 0;
+
+	//
+	// 状态绑定
+	//
+
+	virtual void SetVertexBuffers(UINT startSlot, UINT numBuffers, RenderBuffer* const* buffers, const UINT* strides, const UINT* offsets) = 0;
+	virtual void SetIndexBuffer(RenderBuffer* buffer, RenderIndexFormat format, UINT offset) = 0;
+	virtual void SetPrimitiveTopology(RenderTopology topology) = 0;
+	// 设置特效的渲染状态,句柄在多帧之间保持不变时可以用于比较命令流
+	virtual void SetEffectRenderState(const RenderState* renderState) = 0;
+	// 应用特效,将特效中修改过的参数提交到渲染管线
+	virtual void ApplyEffect(RenderEffect* effect) = 0;
+
+	//
+	// 绘制
+	//
+
+	virtual void Draw(UINT vertexCount, UINT startVertex) = 0;
+	virtual void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) = 0;
+	virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) = 0;
+};
+
+class RecordingRenderBackend final : public IRenderBackend
+{
+public:
+	enum class CommandType : UINT
+	{
+		Map,
+		Unmap,
+		SetVertexBuffer,
+		SetIndexBuffer,
+		SetPrimitiveTopology,
+		SetEffectRenderState,
+		ApplyEffect,
+		Draw,
+		DrawIndexed,
+		DrawIndexedInstanced
+	};
+
+	// 句柄(缓冲区、特效、渲染状态)按第一次出现的顺序编号,nullptr为0
+	// 枚举记录为其数值
+	// 每个顶点缓冲区槽单独记录为一条SetVertexBuffer
+	struct Command
+	{
+		CommandType type;
+		UINT args[5];
+	};
+
+	struct Statistics
+	{
+		UINT drawCalls;
+		UINT64 indexCount;				// 所有绘制处理的索引(或顶点)数目之和,实例绘制乘以实例数目
+		UINT64 instanceCount;			// 所有绘制的实例数目之和,非实例绘制计为1
+		UINT maps;
+		UINT64 bytesUploaded;			// 映射写入的字节数
+		UINT stateChanges;				// 与当前状态不同的顶点/索引缓冲区、图元类型与特效渲染状态设置
+		UINT redundantStateChanges;		// 与当前状态相同的设置
+		UINT effectApplies;
+	};
+
+	RecordingRenderBackend();
+
+	// 清空记录的命令、统计信息与当前状态,对象编号也从头开始
+	void Clear();
+
+	const std::vector<Command>& GetCommands() const;
+	const Statistics& GetStatistics() const;
+	// 每行一条命令的文本形式,对象以编号表示,可以直接比较两帧
+	std::string ToString() const;
+
+	// 返回的内存只用于接收写入,不会被读取
+	void* Map(RenderBuffer* buffer, RenderMapType mapType, UINT byteOffset, UINT byteCount) override;
+	void Unmap(RenderBuffer* buffer) override;
+
+	void SetVertexBuffers(UINT startSlot, UINT numBuffers, RenderBuffer* const* buffers, const UINT* strides, const UINT* offsets) override;
+	void SetIndexBuffer(RenderBuffer* buffer, RenderIndexFormat format, UINT offset) override;
+	void SetPrimitiveTopology(RenderTopology topology) override;
+	// 句柄不会被解引用,只记录
+	void SetEffectRenderState(const RenderState* renderState) override;
+	void ApplyEffect(RenderEffect* effect) override;
+
+	void Draw(UINT vertexCount, UINT startVertex) override;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+
+private:
+	struct VertexBufferBinding
+	{
+		UINT buffer;
+		UINT stride;
+		UINT offset;
+	};
+
+	UINT GetObjectId(const void* object);
+	void Record(CommandType type, UINT arg0 = 0, UINT arg1 = 0, UINT arg2 = 0, UINT arg3 = 0, UINT arg4 = 0);
+	// 记录一次状态设置是否改变了当前状态
+	void CountStateChange(bool isChanged);
+
+	std::vector<Command> m_commands;
+	Statistics m_statistics;
+	std::unordered_map<const void*, UINT> m_objectIds;
+	std::vector<BYTE> m_mappedData;
+
+	// 当前状态,未设置时为~0u
+	VertexBufferBinding m_vertexBuffers[VertexBufferSlotCount];
+	UINT m_indexBuffer;
+	UINT m_indexFormat;
+	UINT m_indexOffset;
+	UINT m_topology;
+	UINT m_effectRenderState;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "RenderBackendD3D11.h"
+#include "EffectHelper.h"
+#include "DXTrace.h"
+
+#include <cassert>
+
+RenderIndexFormat ToRenderIndexFormat(const DXGI_FORMAT format)
+{
+	assert(format == DXGI_FORMAT_R16_UINT || format == DXGI_FORMAT_R32_UINT);
+	return format == DXGI_FORMAT_R16_UINT ? RenderIndexFormat::UInt16 : RenderIndexFormat::UInt32;
+}
+
+DXGI_FORMAT ToDXGIFormat(const RenderIndexFormat format)
+{
+	return format == RenderIndexFormat::UInt16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+}
+
+D3D11_MAP ToD3D11Map(const RenderMapType mapType)
+{
+	return mapType == RenderMapType::WriteDiscard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+}
+
+D3D11_PRIMITIVE_TOPOLOGY ToD3D11Topology(const RenderTopology topology)
+{
+	switch (topology)
+	{
+	case RenderTopology::PointList: return D3D11_PRIMITIVE_TOPOLOGY_POINTLIST;
+	case RenderTopology::LineList: return D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+	case RenderTopology::LineStrip: return D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP;
+	case RenderTopology::TriangleList: return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	case RenderTopology::TriangleStrip: return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+	}
+	return D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+}
+
+D3D11RenderBackend::D3D11RenderBackend(ID3D11DeviceContext* deviceContext)
+	:
+	m_pDeviceContext(deviceContext)
+{
+}
+
+ID3D11DeviceContext* D3D11RenderBackend::GetDeviceContext() const
+{
+	return m_pDeviceContext;
+}
+
+void* D3D11RenderBackend::Map(RenderBuffer* buffer, const RenderMapType mapType, const UINT byteOffset, const UINT byteCount)
+{
+	UNREFERENCED_PARAMETER(byteCount);
+
+	D3D11_MAPPED_SUBRESOURCE mappedData;
+	HR(m_pDeviceContext->Map(ToD3D11Buffer(buffer), 0, ToD3D11Map(mapType), 0, &mappedData));
+	return static_cast<BYTE*>(mappedData.pData) + byteOffset;
+}
+
+void D3D11RenderBackend::Unmap(RenderBuffer* buffer)
+{
+	m_pDeviceContext->Unmap(ToD3D11Buffer(buffer), 0);
+}
+
+void D3D11RenderBackend::SetVertexBuffers(const UINT startSlot, const UINT numBuffers, RenderBuffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	// 句柄就是缓冲区的地址,数组可以直接传递
+	m_pDeviceContext->IASetVertexBuffers(startSlot, numBuffers, reinterpret_cast<ID3D11Buffer* const*>(buffers), strides, offsets);
+}
+
+void D3D11RenderBackend::SetIndexBuffer(RenderBuffer* buffer, const RenderIndexFormat format, const UINT offset)
+{
+	m_pDeviceContext->IASetIndexBuffer(ToD3D11Buffer(buffer), ToDXGIFormat(format), offset);
+}
+
+void D3D11RenderBackend::SetPrimitiveTopology(const RenderTopology topology)
+{
+	m_pDeviceContext->IASetPrimitiveTopology(ToD3D11Topology(topology));
+}
+
+void D3D11RenderBackend::SetEffectRenderState(const RenderState* renderState)
+{
+	renderState->setRenderState(m_pDeviceContext);
+}
+
+void D3D11RenderBackend::ApplyEffect(RenderEffect* effect)
+{
+	ToEffect(effect)->Apply(m_pDeviceContext);
+}
+
+void D3D11RenderBackend::Draw(const UINT vertexCount, const UINT startVertex)
+{
+	m_pDeviceContext->Draw(vertexCount, startVertex);
+}
+
+void D3D11RenderBackend::DrawIndexed(const UINT indexCount, const UINT startIndex, const INT baseVertex)
+{
+	m_pDeviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void D3D11RenderBackend::DrawIndexedInstanced(const UINT indexCount, const UINT instanceCount, const UINT startIndex, const INT baseVertex, const UINT startInstance)
+{
+	m_pDeviceContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
@@ -0,0 +1,85 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 渲染命令后端的D3D11实现
+// 不透明句柄就是D3D对象(或特效)本身的地址,这里提供两者之间的转换
+// RenderState保存设置特效渲染状态的回调,由渲染队列的管线或调用者持有
+// D3D11 render backend and conversions between opaque handles and D3D objects.
+//***************************************************************************************
+
+#ifndef RENDERBACKENDD3D11_H
+#define RENDERBACKENDD3D11_H
+
+#include "RenderBackend.h"
+
+#include <d3d11_1.h>
+#include <functional>
+#include <memory>
+
+class IEffect;
+
+// 设置特效渲染状态的回调,通常为特效的SetRenderXXX
+struct RenderState
+{
+	std::function<void(ID3D11DeviceContext*)> setRenderState;
+};
+
+inline std::shared_ptr<const RenderState> MakeRenderState(std::function<void(ID3D11DeviceContext*)> setRenderState)
+{
+	return std::make_shared<const RenderState>(RenderState{ std::move(setRenderState) });
+}
+
+//
+// 句柄转换
+//
+
+inline RenderBuffer* ToRenderBuffer(ID3D11Buffer* buffer)
+{
+	return reinterpret_cast<RenderBuffer*>(buffer);
+}
+
+inline ID3D11Buffer* ToD3D11Buffer(RenderBuffer* buffer)
+{
+	return reinterpret_cast<ID3D11Buffer*>(buffer);
+}
+
+inline RenderEffect* ToRenderEffect(IEffect* effect)
+{
+	return reinterpret_cast<RenderEffect*>(effect);
+}
+
+inline IEffect* ToEffect(RenderEffect* effect)
+{
+	return reinterpret_cast<IEffect*>(effect);
+}
+
+RenderIndexFormat ToRenderIndexFormat(DXGI_FORMAT format);
+DXGI_FORMAT ToDXGIFormat(RenderIndexFormat format);
+D3D11_MAP ToD3D11Map(RenderMapType mapType);
+D3D11_PRIMITIVE_TOPOLOGY ToD3D11Topology(RenderTopology topology);
+
+class D3D11RenderBackend final : public IRenderBackend
+{
+public:
+	explicit D3D11RenderBackend(ID3D11DeviceContext* deviceContext);
+
+	ID3D11DeviceContext* GetDeviceContext() const;
+
+	void* Map(RenderBuffer* buffer, RenderMapType mapType, UINT byteOffset, UINT byteCount) override;
+	void Unmap(RenderBuffer* buffer) override;
+
+	void SetVertexBuffers(UINT startSlot, UINT numBuffers, RenderBuffer* const* buffers, const UINT* strides, const UINT* offsets) override;
+	void SetIndexBuffer(RenderBuffer* buffer, RenderIndexFormat format, UINT offset) override;
+	void SetPrimitiveTopology(RenderTopology topology) override;
+	void SetEffectRenderState(const RenderState* renderState) override;
+	void ApplyEffect(RenderEffect* effect) override;
+
+	void Draw(UINT vertexCount, UINT startVertex) override;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+
+private:
+	ID3D11DeviceContext* m_pDeviceContext;
+};
+
+#endif
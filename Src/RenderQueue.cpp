@@ -0,0 +1,282 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace DirectX;
+
+UINT64 RenderQueue::MakeKey(const UINT pass, const UINT pipeline, const UINT textureSet, const UINT material, const float depth)
+{
+	const auto field = [](const UINT value, const UINT bits, const UINT shift)
+	{
+		return (static_cast<UINT64>(value) & ((1ull << bits) - 1)) << shift;
+	};
+
+	return field(pass, PassBits, PassShift) |
+		field(pipeline, PipelineBits, PipelineShift) |
+		field(textureSet, TextureSetBits, TextureSetShift) |
+		field(material, MaterialBits, MaterialShift) |
+		field(QuantizeDepth(depth), DepthBits, DepthShift);
+}
+
+UINT RenderQueue::QuantizeDepth(const float depth)
+{
+	// 非负浮点数的位模式与其大小顺序一致,符号位为0,取最高的DepthBits位即可
+	if (!(depth > 0.0f))
+		return 0;
+
+	UINT bits;
+	std::memcpy(&bits, &depth, sizeof(bits));
+	return bits >> (32 - DepthBits);
+}
+
+UINT RenderQueue::RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& temp)
+{
+	const size_t count = items.size();
+	temp.resize(count);
+
+	UINT passCount = 0;
+	for (UINT shift = 0; shift < 64; shift += 8)
+	{
+		size_t offsets[256] = {};
+		for (const SortItem& item : items)
+			++offsets[(item.key >> shift) & 0xFF];
+
+		// 所有元素在这一字节上相同,排序结果不变
+		if (count == 0 || offsets[(items.front().key >> shift) & 0xFF] == count)
+			continue;
+
+		size_t sum = 0;
+		for (size_t& offset : offsets)
+		{
+			const size_t bucketCount = offset;
+			offset = sum;
+			sum += bucketCount;
+		}
+
+		for (const SortItem& item : items)
+			temp[offsets[(item.key >> shift) & 0xFF]++] = item;
+
+		items.swap(temp);
+		++passCount;
+	}
+
+	return passCount;
+}
+
+UINT RenderQueue::GetStateChanges(const DrawPacket* prev, const DrawPacket& curr)
+{
+	// 切换管线后特效可能不同,其余状态都需要重新设置
+	if (!prev || prev->pipeline != curr.pipeline)
+		return StateChangeAll;
+
+	const PartState& prevState = prev->state;
+	const PartState& currState = curr.state;
+	UINT changes = 0;
+	if (prevState.textureDiffuse != currState.textureDiffuse || prevState.textureNormalMap != currState.textureNormalMap)
+		changes |= StateChangeTextureSet;
+	if (prevState.material != currState.material)
+		changes |= StateChangeMaterial;
+	if (prevState.vertexBuffer != currState.vertexBuffer || prevState.vertexStride != currState.vertexStride ||
+		prev->instances.buffer != curr.instances.buffer || prev->instances.stride != curr.instances.stride)
+		changes |= StateChangeVertexBuffer;
+	if (prevState.indexBuffer != currState.indexBuffer || prevState.indexFormat != currState.indexFormat)
+		changes |= StateChangeIndexBuffer;
+	return changes;
+}
+
+void RenderQueue::DrawPart(IRenderBackend& backend, RenderEffect* effect, const IEffectDrawParameters& parameters,
+	const PartState& state, FXMMATRIX world)
+{
+	const UINT offset = 0;
+	backend.SetVertexBuffers(0, 1, &state.vertexBuffer, &state.vertexStride, &offset);
+	backend.SetIndexBuffer(state.indexBuffer, state.indexFormat, 0);
+
+	// 特效只读取自己需要的参数
+	parameters.SetDrawParameters({ state.material, state.textureDiffuse, state.textureNormalMap }, world);
+	backend.ApplyEffect(effect);
+
+	backend.DrawIndexed(state.indexCount, 0, 0);
+}
+
+void RenderQueue::DrawPartInstanced(IRenderBackend& backend, RenderEffect* effect, const IEffectDrawParameters& parameters,
+	const PartState& state, const InstanceRange& range)
+{
+	const UINT strides[2] = { state.vertexStride, range.stride };
+	const UINT offsets[2] = { 0, 0 };
+	RenderBuffer* const buffers[2] = { state.vertexBuffer, range.buffer };
+	backend.SetVertexBuffers(0, 2, buffers, strides, offsets);
+	backend.SetIndexBuffer(state.indexBuffer, state.indexFormat, 0);
+
+	parameters.SetInstancedDrawParameters({ state.material, state.textureDiffuse, state.textureNormalMap });
+	backend.ApplyEffect(effect);
+
+	backend.DrawIndexedInstanced(state.indexCount, range.count, 0, 0, range.offset);
+}
+
+UINT RenderQueue::RegisterPipeline(RenderEffect* effect, const IEffectDrawParameters* parameters, std::shared_ptr<const RenderState> renderState)
+{
+	m_pipelines.push_back({ effect, parameters, std::move(renderState) });
+	return static_cast<UINT>(m_pipelines.size()) - 1;
+}
+
+void RenderQueue::SetViewMatrix(const UINT pass, FXMMATRIX view)
+{
+	XMStoreFloat4(&m_viewDepthRows[pass], XMMatrixTranspose(view).r[2]);
+}
+
+void RenderQueue::Clear()
+{
+	m_packets.clear();
+	m_sortItems.clear();
+	m_sortPassCount = 0;
+	m_materialIds.clear();
+	m_textureSetIds.clear();
+}
+
+void RenderQueue::SubmitPart(const UINT pass, const UINT pipeline, const PartState& state, FXMMATRIX world)
+{
+	const float depth = XMVectorGetX(XMVector4Dot(world.r[3], XMLoadFloat4(&m_viewDepthRows[pass])));
+
+	DrawPacket packet{};
+	packet.key = MakeKey(pass, pipeline, GetTextureSetId(state), GetMaterialId(state.material), depth);
+	packet.pipeline = pipeline;
+	packet.state = state;
+	XMStoreFloat4x4(&packet.world, world);
+
+	m_sortItems.push_back({ packet.key, static_cast<UINT>(m_packets.size()) });
+	m_packets.push_back(packet);
+}
+
+void RenderQueue::SubmitPartInstanced(const UINT pass, const UINT pipeline, const PartState& state, const InstanceRange& range)
+{
+	if (range.count == 0)
+		return;
+
+	DrawPacket packet{};
+	packet.key = MakeKey(pass, pipeline, GetTextureSetId(state), GetMaterialId(state.material), 0.0f);
+	packet.pipeline = pipeline;
+	packet.state = state;
+	packet.instances = range;
+
+	m_sortItems.push_back({ packet.key, static_cast<UINT>(m_packets.size()) });
+	m_packets.push_back(packet);
+}
+
+void RenderQueue::Sort()
+{
+	m_sortPassCount = RadixSort(m_sortItems, m_sortTemp);
+}
+
+RenderQueue::Statistics RenderQueue::Execute(IRenderBackend& backend, const UINT pass) const
+{
+	Statistics statistics{};
+	const DrawPacket* prev = nullptr;
+	const Pipeline* pipeline = nullptr;
+
+	const auto range = GetPassRange(pass);
+	for (auto iter = range.first; iter != range.second; ++iter)
+	{
+		const DrawPacket& packet = m_packets[iter->index];
+		const PartState& state = packet.state;
+		const UINT changes = GetStateChanges(prev, packet);
+
+		if (changes & StateChangePipeline)
+		{
+			pipeline = &m_pipelines[packet.pipeline];
+			backend.SetEffectRenderState(pipeline->renderState.get());
+			++statistics.pipelineChanges;
+		}
+
+		statistics.textureSetChanges += (changes & StateChangeTextureSet) ? 1 : 0;
+		statistics.materialChanges += (changes & StateChangeMaterial) ? 1 : 0;
+
+		// 普通绘制每次都要设置世界矩阵,实例绘制只在纹理或材质变化时设置参数
+		const EffectDrawParameters parameters{ state.material, state.textureDiffuse, state.textureNormalMap };
+		if (packet.instances.count == 0)
+			pipeline->parameters->SetDrawParameters(parameters, XMLoadFloat4x4(&packet.world));
+		else if (changes & (StateChangeTextureSet | StateChangeMaterial))
+			pipeline->parameters->SetInstancedDrawParameters(parameters);
+
+		if (changes & StateChangeVertexBuffer)
+		{
+			const UINT strides[2] = { state.vertexStride, packet.instances.stride };
+			const UINT offsets[2] = { 0, 0 };
+			RenderBuffer* const buffers[2] = { state.vertexBuffer, packet.instances.buffer };
+			backend.SetVertexBuffers(0, packet.instances.buffer ? 2 : 1, buffers, strides, offsets);
+			++statistics.vertexBufferChanges;
+		}
+
+		if (changes & StateChangeIndexBuffer)
+		{
+			backend.SetIndexBuffer(state.indexBuffer, state.indexFormat, 0);
+			++statistics.indexBufferChanges;
+		}
+
+		backend.ApplyEffect(pipeline->effect);
+
+		if (packet.instances.count == 0)
+			backend.DrawIndexed(state.indexCount, 0, 0);
+		else
+			backend.DrawIndexedInstanced(state.indexCount, packet.instances.count, 0, 0, packet.instances.offset);
+
+		++statistics.packetCount;
+		prev = &packet;
+	}
+
+	return statistics;
+}
+
+RenderQueue::Statistics RenderQueue::GetStatistics(const UINT pass) const
+{
+	Statistics statistics{};
+	const DrawPacket* prev = nullptr;
+
+	const auto range = GetPassRange(pass);
+	for (auto iter = range.first; iter != range.second; ++iter)
+	{
+		const DrawPacket& packet = m_packets[iter->index];
+		const UINT changes = GetStateChanges(prev, packet);
+
+		statistics.pipelineChanges += (changes & StateChangePipeline) ? 1 : 0;
+		statistics.textureSetChanges += (changes & StateChangeTextureSet) ? 1 : 0;
+		statistics.materialChanges += (changes & StateChangeMaterial) ? 1 : 0;
+		statistics.vertexBufferChanges += (changes & StateChangeVertexBuffer) ? 1 : 0;
+		statistics.indexBufferChanges += (changes & StateChangeIndexBuffer) ? 1 : 0;
+		++statistics.packetCount;
+		prev = &packet;
+	}
+
+	return statistics;
+}
+
+UINT RenderQueue::GetPacketCount() const
+{
+	return static_cast<UINT>(m_packets.size());
+}
+
+UINT RenderQueue::GetSortPassCount() const
+{
+	return m_sortPassCount;
+}
+
+std::pair<std::vector<RenderQueue::SortItem>::const_iterator, std::vector<RenderQueue::SortItem>::const_iterator> RenderQueue::GetPassRange(const UINT pass) const
+{
+	// Pass位于排序键的最高位,排序后同一Pass的绘制包连续存放
+	const auto first = std::lower_bound(m_sortItems.cbegin(), m_sortItems.cend(), pass,
+		[](const SortItem& item, const UINT value) { return (item.key >> PassShift) < value; });
+	const auto last = std::upper_bound(first, m_sortItems.cend(), pass,
+		[](const UINT value, const SortItem& item) { return value < (item.key >> PassShift); });
+	return { first, last };
+}
+
+UINT RenderQueue::GetMaterialId(const Material* material)
+{
+	return m_materialIds.try_emplace(material, static_cast<UINT>(m_materialIds.size())).first->second;
+}
+
+UINT RenderQueue::GetTextureSetId(const PartState& state)
+{
+	const std::pair<const void*, const void*> textureSet(state.textureDiffuse, state.textureNormalMap);
+	return m_textureSetIds.try_emplace(textureSet, static_cast<UINT>(m_textureSetIds.size())).first->second;
+}
@@ -0,0 +1,182 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 排序渲染队列
+// 物体不再直接绘制,而是提交带有64位排序键的绘制包,每帧按键基数排序后统一执行
+// 排序键从高位到低位依次为: Pass | 管线状态(特效、着色器Pass与输入布局) | 纹理组 | 材质 | 深度
+// 相邻绘制包之间没有变化的状态(管线、纹理、材质、顶点/索引缓冲区)不会重复设置
+// 排序、执行与直接绘制只通过IRenderBackend与IEffectDrawParameters,不依赖D3D(RenderQueue.cpp),
+// 注册IEffect与从Model提交位于RenderQueueD3D11.cpp
+// Sorted render queue with 64-bit state keys, radix sort and redundant state elision.
+//***************************************************************************************
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "PortableTypes.h"
+#include "RenderBackend.h"
+#include "EffectDrawParameters.h"
+
+#include <DirectXMath.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+struct Model;
+struct ModelPart;
+class IEffect;
+
+class RenderQueue
+{
+public:
+	// 排序键各字段的位宽
+	static constexpr UINT PassBits = 4;
+	static constexpr UINT PipelineBits = 12;
+	static constexpr UINT TextureSetBits = 16;
+	static constexpr UINT MaterialBits = 12;
+	static constexpr UINT DepthBits = 20;
+
+	static constexpr UINT DepthShift = 0;
+	static constexpr UINT MaterialShift = DepthShift + DepthBits;
+	static constexpr UINT TextureSetShift = MaterialShift + MaterialBits;
+	static constexpr UINT PipelineShift = TextureSetShift + TextureSetBits;
+	static constexpr UINT PassShift = PipelineShift + PipelineBits;
+
+	static constexpr UINT MaxPassCount = 1u << PassBits;
+
+	// 相邻两个绘制包之间需要重新设置的状态
+	enum StateChange : UINT
+	{
+		StateChangePipeline = 1 << 0,
+		StateChangeTextureSet = 1 << 1,
+		StateChangeMaterial = 1 << 2,
+		StateChangeVertexBuffer = 1 << 3,
+		StateChangeIndexBuffer = 1 << 4,
+		StateChangeAll = 0x1F
+	};
+
+	// 一个模型部分的绘制状态,由ModelPart填写,排序与比较时只比较指针
+	struct PartState
+	{
+		const Material* material;
+		ID3D11ShaderResourceView* textureDiffuse;
+		ID3D11ShaderResourceView* textureNormalMap;
+		RenderBuffer* vertexBuffer;
+		RenderBuffer* indexBuffer;
+		RenderIndexFormat indexFormat;
+		UINT indexCount;
+		UINT vertexStride;
+	};
+
+	// 共享实例缓冲区中的一段实例数据
+	struct InstanceRange
+	{
+		RenderBuffer* buffer;
+		UINT stride;
+		UINT offset;						// 起始实例
+		UINT count;
+	};
+
+	struct DrawPacket
+	{
+		UINT64 key;
+		UINT pipeline;						// RegisterPipeline返回的索引
+		PartState state;
+		// instances.count为0时为普通绘制,使用world
+		InstanceRange instances;
+		DirectX::XMFLOAT4X4 world;
+	};
+
+	struct SortItem
+	{
+		UINT64 key;
+		UINT index;							// 绘制包在提交顺序中的索引
+	};
+
+	// 每次Execute的统计信息
+	struct Statistics
+	{
+		UINT packetCount;
+		UINT pipelineChanges;
+		UINT textureSetChanges;
+		UINT materialChanges;
+		UINT vertexBufferChanges;
+		UINT indexBufferChanges;
+	};
+
+	// 组合排序键,超出位宽的部分被截断
+	static UINT64 MakeKey(UINT pass, UINT pipeline, UINT textureSet, UINT material, float depth);
+	// 将非负的深度量化为DepthBits位,保持大小顺序(直接截取浮点数的高位),负数视为0
+	static UINT QuantizeDepth(float depth);
+	// 按排序键对items进行稳定的LSD基数排序(每次8位),所有元素该字节相同时跳过这一趟
+	// temp为临时缓冲区,返回实际执行的趟数
+	static UINT RadixSort(std::vector<SortItem>& items, std::vector<SortItem>& temp);
+	// 计算从prev切换到curr需要设置的状态,prev为nullptr时需要设置所有状态
+	static UINT GetStateChanges(const DrawPacket* prev, const DrawPacket& curr);
+
+	// 从模型部分填写绘制状态
+	static PartState MakePartState(const Model& model, const ModelPart& part);
+	// 不经过排序直接绘制一个模型部分: 绑定顶点/索引缓冲区,设置绘制参数,应用特效并绘制
+	// 游戏对象与天空盒直接绘制时使用,parameters通常就是effect对应的特效
+	static void XM_CALLCONV DrawPart(IRenderBackend& backend, RenderEffect* effect, const IEffectDrawParameters& parameters,
+		const PartState& state, DirectX::FXMMATRIX world);
+	static void DrawPartInstanced(IRenderBackend& backend, RenderEffect* effect, const IEffectDrawParameters& parameters,
+		const PartState& state, const InstanceRange& range);
+
+	// 注册管线状态,返回用于提交的索引,在初始化时注册一次即可
+	// effect用于应用,parameters用于设置每次绘制的参数,renderState在切换管线时设置
+	UINT RegisterPipeline(RenderEffect* effect, const IEffectDrawParameters* parameters, std::shared_ptr<const RenderState> renderState);
+	UINT RegisterPipeline(IEffect* effect, std::shared_ptr<const RenderState> renderState);
+
+	// 设置某个Pass用于计算深度的观察矩阵,保持到下次设置
+	void XM_CALLCONV SetViewMatrix(UINT pass, DirectX::FXMMATRIX view);
+
+	// 每帧开始时清空所有绘制包
+	void Clear();
+	// 提交模型的所有部分
+	void XM_CALLCONV Submit(UINT pass, UINT pipeline, const Model& model, DirectX::FXMMATRIX world);
+	// 提交模型的所有部分,使用已经写入共享实例缓冲区的实例数据
+	void SubmitInstanced(UINT pass, UINT pipeline, const Model& model, const InstanceRange& range);
+	// 提交一个模型部分,深度由world的平移与该Pass的观察矩阵计算
+	void XM_CALLCONV SubmitPart(UINT pass, UINT pipeline, const PartState& state, DirectX::FXMMATRIX world);
+	// 实例分散在场景各处,不参与深度排序
+	void SubmitPartInstanced(UINT pass, UINT pipeline, const PartState& state, const InstanceRange& range);
+
+	// 对本帧提交的所有绘制包排序,需要在Execute之前调用
+	void Sort();
+	// 按顺序执行某个Pass的所有绘制包
+	Statistics Execute(IRenderBackend& backend, UINT pass) const;
+	// 不进行绘制,只统计执行某个Pass时的状态切换次数
+	Statistics GetStatistics(UINT pass) const;
+
+	UINT GetPacketCount() const;
+	// 本帧排序实际执行的趟数
+	UINT GetSortPassCount() const;
+
+private:
+	struct Pipeline
+	{
+		RenderEffect* effect;
+		const IEffectDrawParameters* parameters;
+		std::shared_ptr<const RenderState> renderState;
+	};
+
+	// 排序后某个Pass的绘制包范围
+	std::pair<std::vector<SortItem>::const_iterator, std::vector<SortItem>::const_iterator> GetPassRange(UINT pass) const;
+	UINT GetMaterialId(const Material* material);
+	UINT GetTextureSetId(const PartState& state);
+
+	std::vector<Pipeline> m_pipelines;
+	DirectX::XMFLOAT4 m_viewDepthRows[MaxPassCount]{};		// 观察矩阵的第三列,与世界坐标点乘即为观察空间深度
+
+	std::vector<DrawPacket> m_packets;
+	std::vector<SortItem> m_sortItems;
+	std::vector<SortItem> m_sortTemp;
+	UINT m_sortPassCount = 0;
+
+	// 本帧内资源到排序键中编号的映射,只用于将相同的状态排在一起
+	std::map<const Material*, UINT> m_materialIds;
+	std::map<std::pair<const void*, const void*>, UINT> m_textureSetIds;
+};
+
+#endif
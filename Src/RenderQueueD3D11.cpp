@@ -0,0 +1,40 @@
+// RenderQueue中依赖D3D与特效的部分: 注册IEffect与从Model提交
+// 排序、执行与直接绘制位于RenderQueue.cpp,单元测试只编译那一部分
+#include "RenderQueue.h"
+#include "RenderBackendD3D11.h"
+#include "Model.h"
+#include "EffectHelper.h"
+
+using namespace DirectX;
+
+RenderQueue::PartState RenderQueue::MakePartState(const Model& model, const ModelPart& part)
+{
+	return
+	{
+		&part.material,
+		part.texDiffuse.Get(),
+		part.texNormalMap.Get(),
+		ToRenderBuffer(part.vertexBuffer.Get()),
+		ToRenderBuffer(part.indexBuffer.Get()),
+		ToRenderIndexFormat(part.indexFormat),
+		part.indexCount,
+		model.vertexStride
+	};
+}
+
+UINT RenderQueue::RegisterPipeline(IEffect* effect, std::shared_ptr<const RenderState> renderState)
+{
+	return RegisterPipeline(ToRenderEffect(effect), effect, std::move(renderState));
+}
+
+void RenderQueue::Submit(const UINT pass, const UINT pipeline, const Model& model, FXMMATRIX world)
+{
+	for (const ModelPart& part : model.modelParts)
+		SubmitPart(pass, pipeline, MakePartState(model, part), world);
+}
+
+void RenderQueue::SubmitInstanced(const UINT pass, const UINT pipeline, const Model& model, const InstanceRange& range)
+{
+	for (const ModelPart& part : model.modelParts)
+		SubmitPartInstanced(pass, pipeline, MakePartState(model, part), range);
+}
@@ -0,0 +1,307 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 扁平化的场景层次
+// 将对象树按深度展开为连续数组,每个节点只记录父节点索引
+// 世界矩阵逐层计算,同一深度的节点互不依赖,可以并行更新
+// 剔除与绘制直接读取连续的世界矩阵与子树包围盒数组
+// 不依赖D3D,GameObject与单元测试中的节点类型共用同一份实现
+// Flattened, depth-ordered scene hierarchy with level-parallel world matrix updates.
+//***************************************************************************************
+
+#ifndef SCENEHIERARCHY_H
+#define SCENEHIERARCHY_H
+
+#include "HierarchyCulling.h"
+
+#include <algorithm>
+#include <execution>
+#include <vector>
+
+//
+// Node需要提供:
+//	const BasicTransform& GetTransform() const;
+//	GetChildren(),可以遍历的Node*容器
+//	bool HasLocalBoundingBox() const;			// 没有模型的节点只负责传递变换
+//	DirectX::BoundingBox GetLocalBoundingBox() const;
+//
+template <typename Node>
+class SceneHierarchy
+{
+public:
+	static constexpr UINT InvalidIndex = 0xFFFFFFFF;
+	// 同一层的节点数目达到该值时才并行更新,节点太少时线程调度的开销更大
+	static constexpr UINT ParallelThreshold = 256;
+
+	// 以广度优先展开整棵树,同一深度的节点连续存放,父节点总是位于子节点之前
+	// 树的结构(AddChild)发生变化后需要重新构建
+	void Build(Node* root);
+	void Build(const std::vector<Node*>& roots);
+	void Clear();
+
+	// 读取每个节点的变换并逐层计算世界矩阵,然后自底向上合并子树包围盒
+	// 矩阵的组合方式与GameObject::Draw一致
+	void Update();
+
+	// 按数组顺序对每个没有被剔除的节点调用drawNode(node, world),需要先调用Update
+	// 统计方式与HierarchyCulling::Cull一致,pStatistics可以为nullptr
+	// 剔除状态保存在每次调用自己的数组中,多个线程可以以不同的包围体同时剔除
+	template <typename BoundingVolume, typename DrawNode>
+	void Cull(const BoundingVolume& volume, HierarchyCullStatistics* pStatistics, DrawNode&& drawNode) const;
+
+	UINT GetNodeCount() const;
+	UINT GetLevelCount() const;
+	// 第level层的节点在数组中的范围为[GetLevelBegin(level), GetLevelEnd(level))
+	UINT GetLevelBegin(UINT level) const;
+	UINT GetLevelEnd(UINT level) const;
+
+	Node* GetNode(UINT index) const;
+	// 根节点返回InvalidIndex
+	UINT GetParentIndex(UINT index) const;
+	// 按数组顺序排列的世界矩阵,需要先调用Update
+	const std::vector<DirectX::XMFLOAT4X4>& GetWorldMatrices() const;
+
+private:
+	// 节点在剔除时的状态,子节点从父节点继承
+	enum class Visibility : uint8_t
+	{
+		Test,		// 需要测试子树包围盒
+		Inside,		// 祖先完全位于包围体内,不再测试
+		Culled		// 祖先已经被剔除
+	};
+
+	// 只读写自身与父节点的数据,同一层的节点可以同时更新
+	void UpdateNode(UINT index);
+
+	std::vector<Node*> m_nodes;
+	std::vector<UINT> m_parents;
+	std::vector<UINT> m_levelOffsets;							// 每层的起始位置,最后一个元素为节点数目
+	std::vector<UINT> m_subtreeNodeCounts;						// 子树的节点数目(包括自身)
+
+	std::vector<DirectX::XMFLOAT3> m_childScales;				// 传递给子节点的缩放
+	std::vector<DirectX::XMFLOAT4X4> m_rotationTranslations;	// 累乘到根节点的旋转平移矩阵
+	std::vector<DirectX::XMFLOAT4X4> m_worldMatrices;
+	std::vector<DirectX::BoundingBox> m_subtreeBoxes;			// 子树的世界空间包围盒
+	std::vector<uint8_t> m_hasSubtreeBoxes;						// 子树中是否存在带包围盒的节点
+};
+
+template <typename Node>
+void SceneHierarchy<Node>::Build(Node* root)
+{
+	Build(std::vector<Node*>{ root });
+}
+
+template <typename Node>
+void SceneHierarchy<Node>::Build(const std::vector<Node*>& roots)
+{
+	Clear();
+
+	m_nodes = roots;
+	m_parents.assign(roots.size(), InvalidIndex);
+
+	// 逐层展开,上一层的范围为[begin, end)
+	UINT begin = 0;
+	while (begin < m_nodes.size())
+	{
+		const UINT end = static_cast<UINT>(m_nodes.size());
+		m_levelOffsets.push_back(begin);
+
+		for (UINT i = begin; i < end; ++i)
+		{
+			for (Node* child : m_nodes[i]->GetChildren())
+			{
+				m_nodes.push_back(child);
+				m_parents.push_back(i);
+			}
+		}
+
+		begin = end;
+	}
+	m_levelOffsets.push_back(GetNodeCount());
+
+	// 子节点总是位于父节点之后,逆序累加即可得到子树大小
+	m_subtreeNodeCounts.assign(m_nodes.size(), 1);
+	for (UINT i = GetNodeCount(); i > 0; --i)
+	{
+		const UINT parent = m_parents[i - 1];
+		if (parent != InvalidIndex)
+			m_subtreeNodeCounts[parent] += m_subtreeNodeCounts[i - 1];
+	}
+
+	m_childScales.resize(m_nodes.size());
+	m_rotationTranslations.resize(m_nodes.size());
+	m_worldMatrices.resize(m_nodes.size());
+	m_subtreeBoxes.resize(m_nodes.size());
+	m_hasSubtreeBoxes.resize(m_nodes.size());
+}
+
+template <typename Node>
+void SceneHierarchy<Node>::Clear()
+{
+	m_nodes.clear();
+	m_parents.clear();
+	m_levelOffsets.clear();
+	m_subtreeNodeCounts.clear();
+	m_childScales.clear();
+	m_rotationTranslations.clear();
+	m_worldMatrices.clear();
+	m_subtreeBoxes.clear();
+	m_hasSubtreeBoxes.clear();
+}
+
+template <typename Node>
+void SceneHierarchy<Node>::Update()
+{
+	for (UINT level = 0; level < GetLevelCount(); ++level)
+	{
+		const UINT begin = GetLevelBegin(level);
+		const UINT end = GetLevelEnd(level);
+
+		if (end - begin < ParallelThreshold)
+		{
+			for (UINT i = begin; i < end; ++i)
+				UpdateNode(i);
+		}
+		else
+		{
+			// 父节点都位于之前的层,已经更新完毕
+			std::for_each(std::execution::par, m_parents.begin() + begin, m_parents.begin() + end,
+				[this](const UINT& parent)
+				{
+					UpdateNode(static_cast<UINT>(&parent - m_parents.data()));
+				});
+		}
+	}
+
+	// 多个子节点会合并到同一个父节点,这一步逆序串行完成
+	for (UINT i = GetNodeCount(); i > 0; --i)
+	{
+		const UINT parent = m_parents[i - 1];
+		if (parent == InvalidIndex || !m_hasSubtreeBoxes[i - 1])
+			continue;
+
+		if (m_hasSubtreeBoxes[parent])
+		{
+			DirectX::BoundingBox::CreateMerged(m_subtreeBoxes[parent], m_subtreeBoxes[parent], m_subtreeBoxes[i - 1]);
+		}
+		else
+		{
+			m_subtreeBoxes[parent] = m_subtreeBoxes[i - 1];
+			m_hasSubtreeBoxes[parent] = true;
+		}
+	}
+}
+
+template <typename Node>
+template <typename BoundingVolume, typename DrawNode>
+void SceneHierarchy<Node>::Cull(const BoundingVolume& volume, HierarchyCullStatistics* pStatistics, DrawNode&& drawNode) const
+{
+	using namespace DirectX;
+
+	// 父节点总是先于子节点处理,按数组顺序即可把状态传递下去
+	std::vector<Visibility> visibilities(m_nodes.size());
+	for (UINT i = 0; i < GetNodeCount(); ++i)
+	{
+		const UINT parent = m_parents[i];
+		Visibility visibility = parent == InvalidIndex ? Visibility::Test : visibilities[parent];
+
+		if (visibility == Visibility::Test && m_hasSubtreeBoxes[i])
+		{
+			if (pStatistics)
+				++pStatistics->testedNodes;
+
+			const ContainmentType containment = volume.Contains(m_subtreeBoxes[i]);
+			if (containment == DISJOINT)
+			{
+				if (pStatistics)
+					pStatistics->culledNodes += m_subtreeNodeCounts[i];
+				visibility = Visibility::Culled;
+			}
+			else if (containment == CONTAINS)
+			{
+				if (pStatistics)
+					++pStatistics->acceptedNodes;
+				visibility = Visibility::Inside;
+			}
+		}
+
+		visibilities[i] = visibility;
+		if (visibility != Visibility::Culled)
+			drawNode(*m_nodes[i], XMLoadFloat4x4(&m_worldMatrices[i]));
+	}
+}
+
+template <typename Node>
+UINT SceneHierarchy<Node>::GetNodeCount() const
+{
+	return static_cast<UINT>(m_nodes.size());
+}
+
+template <typename Node>
+UINT SceneHierarchy<Node>::GetLevelCount() const
+{
+	return m_levelOffsets.empty() ? 0 : static_cast<UINT>(m_levelOffsets.size()) - 1;
+}
+
+template <typename Node>
+UINT SceneHierarchy<Node>::GetLevelBegin(const UINT level) const
+{
+	return m_levelOffsets[level];
+}
+
+template <typename Node>
+UINT SceneHierarchy<Node>::GetLevelEnd(const UINT level) const
+{
+	return m_levelOffsets[level + 1];
+}
+
+template <typename Node>
+Node* SceneHierarchy<Node>::GetNode(const UINT index) const
+{
+	return m_nodes[index];
+}
+
+template <typename Node>
+UINT SceneHierarchy<Node>::GetParentIndex(const UINT index) const
+{
+	return m_parents[index];
+}
+
+template <typename Node>
+const std::vector<DirectX::XMFLOAT4X4>& SceneHierarchy<Node>::GetWorldMatrices() const
+{
+	return m_worldMatrices;
+}
+
+template <typename Node>
+void SceneHierarchy<Node>::UpdateNode(const UINT index)
+{
+	using namespace DirectX;
+
+	// 每个节点只访问自身的变换,BasicTransform内部的缓存不会被多个线程同时写入
+	const Node& node = *m_nodes[index];
+	const BasicTransform& transform = node.GetTransform();
+	const XMVECTOR scale = transform.GetScaleVector();
+	XMMATRIX rotationTranslation = transform.GetRotationTranslationMatrix();
+	XMVECTOR parentScale = g_XMOne;
+
+	const UINT parent = m_parents[index];
+	if (parent != InvalidIndex)
+	{
+		rotationTranslation *= XMLoadFloat4x4(&m_rotationTranslations[parent]);
+		parentScale = XMLoadFloat3(&m_childScales[parent]);
+	}
+
+	// 与GameObject::Draw一致: 子对象得到的缩放为父对象自身缩放的平方
+	const XMMATRIX world = XMMatrixScalingFromVector(XMVectorMultiply(scale, parentScale)) * rotationTranslation;
+	XMStoreFloat3(&m_childScales[index], XMVectorMultiply(scale, scale));
+	XMStoreFloat4x4(&m_rotationTranslations[index], rotationTranslation);
+	XMStoreFloat4x4(&m_worldMatrices[index], world);
+
+	// 子树包围盒先只包含自身,Update的最后再合并子节点
+	m_hasSubtreeBoxes[index] = node.HasLocalBoundingBox();
+	if (m_hasSubtreeBoxes[index])
+		node.GetLocalBoundingBox().Transform(m_subtreeBoxes[index], world);
+}
+
+#endif
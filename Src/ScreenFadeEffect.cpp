@@ -181,6 +181,9 @@ void ScreenFadeEffect::SetTexture(ID3D11ShaderResourceView* texture) const
 
 void ScreenFadeEffect::Apply(ID3D11DeviceContext* deviceContext)
 {
+	// 直接修改管线状态,EffectPass记录的状态不再可信
+	EffectStateCache::Invalidate(deviceContext);
+
 	auto& pCBuffers = m_pImpl->m_pCBuffers;
 	// 将缓冲区绑定到渲染管线上
 	pCBuffers[0]->BindPS(deviceContext);
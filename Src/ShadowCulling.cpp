@@ -0,0 +1,77 @@
+#include "ShadowCulling.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+ShadowCulling::ShadowCulling()
+	:
+	m_lightView(Bounds::ToMatrix4x4(XMMatrixIdentity())),
+	m_invLightView(Bounds::ToMatrix4x4(XMMatrixIdentity())),
+	m_localLightVolume(),
+	m_lightVolume(),
+	m_cameraFrustum(),
+	m_statistics()
+{
+}
+
+void ShadowCulling::SetLightVolume(FXMMATRIX lightView, const float width, const float height, const float nearZ, const float farZ)
+{
+	m_lightView = Bounds::ToMatrix4x4(lightView);
+	m_invLightView = Bounds::ToMatrix4x4(XMMatrixInverse(nullptr, lightView));
+
+	// 光源观察空间中的正交投影体是一个AABB,变换回世界空间即为OBB
+	m_localLightVolume = {
+		{ 0.0f, 0.0f, (nearZ + farZ) * 0.5f },
+		{ width * 0.5f, height * 0.5f, (farZ - nearZ) * 0.5f }
+	};
+	m_lightVolume = Bounds::Transform(Bounds::ObbFromAabb(m_localLightVolume), m_invLightView);
+
+	m_statistics = {};
+}
+
+void ShadowCulling::SetCameraFrustum(FXMMATRIX view, CXMMATRIX proj)
+{
+	m_cameraFrustum = Bounds::FrustumFromMatrix(Bounds::ToMatrix4x4(view * proj));
+
+	m_statistics = {};
+}
+
+bool ShadowCulling::IsCasterVisible(const Bounds::Aabb& box)
+{
+	++m_statistics.testedCasters;
+
+	// 在光源观察空间中与投影体比较
+	Bounds::Aabb lightSpaceBox = Bounds::Transform(box, m_lightView);
+	if (!Bounds::Intersects(lightSpaceBox, m_localLightVolume))
+	{
+		++m_statistics.outsideLightVolume;
+		return false;
+	}
+
+	// 将包围盒沿光照方向(+Z)延伸到投影体远平面,得到阴影可能覆盖的区域
+	const float lightFarZ = m_localLightVolume.center.z + m_localLightVolume.extents.z;
+	const float minZ = lightSpaceBox.center.z - lightSpaceBox.extents.z;
+	const float maxZ = (std::max)(lightSpaceBox.center.z + lightSpaceBox.extents.z, lightFarZ);
+	lightSpaceBox.center.z = (minZ + maxZ) * 0.5f;
+	lightSpaceBox.extents.z = (maxZ - minZ) * 0.5f;
+
+	const Bounds::Obb shadowVolume = Bounds::Transform(Bounds::ObbFromAabb(lightSpaceBox), m_invLightView);
+	if (Bounds::Contains(m_cameraFrustum, shadowVolume) == Bounds::Containment::Disjoint)
+	{
+		++m_statistics.outsideReceivers;
+		return false;
+	}
+
+	return true;
+}
+
+const Bounds::Obb& ShadowCulling::GetLightVolume() const
+{
+	return m_lightVolume;
+}
+
+const ShadowCulling::Statistics& ShadowCulling::GetStatistics() const
+{
+	return m_statistics;
+}
@@ -0,0 +1,53 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 阴影投射者剔除
+// 1. 不与光源正交投影体相交的物体不会出现在阴影贴图中
+// 2. 沿光照方向延伸后仍不与摄像机视锥体相交的物体,其阴影不可能落在可见的接收者上
+// 测试都使用Bounds.h,第1步在光源观察空间中以AABB进行,第2步只测试视锥体的6个平面,两者都是保守的
+// Shadow caster culling against the light volume and the camera frustum (receiver-aware).
+//***************************************************************************************
+
+#ifndef SHADOWCULLING_H
+#define SHADOWCULLING_H
+
+#include "PortableTypes.h"
+#include "BoundsInterop.h"
+
+class ShadowCulling
+{
+public:
+	// 统计信息,每次设置光源或摄像机时清零
+	struct Statistics
+	{
+		UINT testedCasters;			// 测试的投射者数目
+		UINT outsideLightVolume;	// 不在光源投影体内的数目
+		UINT outsideReceivers;		// 阴影不会落入摄像机视锥体的数目
+	};
+
+	ShadowCulling();
+
+	// 设置光源的正交投影体,与XMMatrixOrthographicLH(width, height, nearZ, farZ)对应
+	void XM_CALLCONV SetLightVolume(DirectX::FXMMATRIX lightView, float width, float height, float nearZ, float farZ);
+	// 设置摄像机视锥体,即阴影接收者所在的区域
+	void XM_CALLCONV SetCameraFrustum(DirectX::FXMMATRIX view, DirectX::CXMMATRIX proj);
+
+	// 世界空间包围盒对应的物体是否需要绘制到阴影贴图
+	bool IsCasterVisible(const Bounds::Aabb& box);
+
+	// 获取世界空间中的光源投影体
+	const Bounds::Obb& GetLightVolume() const;
+	const Statistics& GetStatistics() const;
+
+private:
+	Bounds::Matrix4x4 m_lightView;
+	Bounds::Matrix4x4 m_invLightView;
+
+	Bounds::Aabb m_localLightVolume;			// 光源观察空间
+	Bounds::Obb m_lightVolume;					// 世界空间
+	Bounds::Frustum m_cameraFrustum;			// 世界空间
+
+	Statistics m_statistics;
+};
+
+#endif
@@ -15,11 +15,24 @@ public:
 
 	ComPtr<ID3D11InputLayout> m_pInstancePosNormalTexLayout;
 	ComPtr<ID3D11InputLayout> m_pVertexPosNormalTexLayout;
+	ComPtr<ID3D11InputLayout> m_pCompactInstancePosNormalTexLayout;
 
 	XMFLOAT4X4 m_world{};
 	XMFLOAT4X4 m_view{};
 	XMFLOAT4X4 m_proj{};
 	RenderType m_renderType = RenderType::RenderObject;
+
+	// 初始化时解析的渲染通道与句柄,之后的设置不再按名称查找
+	std::shared_ptr<IEffectPass> m_pShadowObjectPass;
+	std::shared_ptr<IEffectPass> m_pShadowInstancePass;
+	std::shared_ptr<IEffectPass> m_pShadowCompactInstancePass;
+	std::shared_ptr<IEffectPass> m_pShadowObjectAlphaClipPass;
+	std::shared_ptr<IEffectPass> m_pShadowInstanceAlphaClipPass;
+	std::shared_ptr<IEffectPass> m_pShadowCompactInstanceAlphaClipPass;
+
+	EffectVariableHandle m_viewProjHandle;
+	EffectVariableHandle m_worldViewProjHandle;
+	EffectShaderResourceHandle m_diffuseMapHandle;
 };
 
 //
@@ -83,6 +96,16 @@ bool ShadowEffect::InitAll(ID3D11Device* device) const
 		{ "World", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1}
 	};
 
+	// 紧凑实例输入布局,只有世界矩阵的前三列
+	D3D11_INPUT_ELEMENT_DESC shadowCompactInstLayout[] = {
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "WorldAffine", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{ "WorldAffine", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{ "WorldAffine", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1}
+	};
+
 	// ******************
 	// 创建顶点着色器
 	//
@@ -99,6 +122,12 @@ bool ShadowEffect::InitAll(ID3D11Device* device) const
 	HR(device->CreateInputLayout(VertexPosNormalTex::InputLayout, ARRAYSIZE(VertexPosNormalTex::InputLayout),
 		blob->GetBufferPointer(), blob->GetBufferSize(), m_pImpl->m_pVertexPosNormalTexLayout.GetAddressOf()));
 
+	HR(CreateShaderFromFile(L"HLSL\\ShadowCompactInstance_VS.cso", L"HLSL\\ShadowCompactInstance_VS.hlsl", "VS", "vs_5_0", blob.ReleaseAndGetAddressOf()));
+	HR(m_pImpl->m_pEffectHelper->AddShader("ShadowCompactInstance_VS", device, blob.Get()));
+	// 创建顶点布局
+	HR(device->CreateInputLayout(shadowCompactInstLayout, ARRAYSIZE(shadowCompactInstLayout),
+		blob->GetBufferPointer(), blob->GetBufferSize(), m_pImpl->m_pCompactInstancePosNormalTexLayout.GetAddressOf()));
+
 	// ******************
 	// 创建像素着色器
 	//
@@ -117,6 +146,10 @@ bool ShadowEffect::InitAll(ID3D11Device* device) const
 	HR(m_pImpl->m_pEffectHelper->AddEffectPass("ShadowObject", device, &passDesc));
 	m_pImpl->m_pEffectHelper->GetEffectPass("ShadowObject")->SetRasterizerState(RenderStates::RSDepth.Get());
 
+	passDesc.nameVS = "ShadowCompactInstance_VS";
+	HR(m_pImpl->m_pEffectHelper->AddEffectPass("ShadowCompactInstance", device, &passDesc));
+	m_pImpl->m_pEffectHelper->GetEffectPass("ShadowCompactInstance")->SetRasterizerState(RenderStates::RSDepth.Get());
+
 	passDesc.nameVS = "ShadowInstance_VS";
 	passDesc.namePS = "Shadow_PS";
 	HR(m_pImpl->m_pEffectHelper->AddEffectPass("ShadowInstanceAlphaClip", device, &passDesc));
@@ -127,11 +160,29 @@ bool ShadowEffect::InitAll(ID3D11Device* device) const
 	HR(m_pImpl->m_pEffectHelper->AddEffectPass("ShadowObjectAlphaClip", device, &passDesc));
 	m_pImpl->m_pEffectHelper->GetEffectPass("ShadowObjectAlphaClip")->SetRasterizerState(RenderStates::RSDepth.Get());
 
+	passDesc.nameVS = "ShadowCompactInstance_VS";
+	passDesc.namePS = "Shadow_PS";
+	HR(m_pImpl->m_pEffectHelper->AddEffectPass("ShadowCompactInstanceAlphaClip", device, &passDesc));
+	m_pImpl->m_pEffectHelper->GetEffectPass("ShadowCompactInstanceAlphaClip")->SetRasterizerState(RenderStates::RSDepth.Get());
+
 	m_pImpl->m_pEffectHelper->SetSamplerStateByName("g_Sam", RenderStates::SSLinearWrap.Get());
 
+	// 解析渲染通道与句柄
+	EffectHelper& effectHelper = *m_pImpl->m_pEffectHelper;
+	m_pImpl->m_pShadowObjectPass = effectHelper.GetEffectPass("ShadowObject");
+	m_pImpl->m_pShadowInstancePass = effectHelper.GetEffectPass("ShadowInstance");
+	m_pImpl->m_pShadowCompactInstancePass = effectHelper.GetEffectPass("ShadowCompactInstance");
+	m_pImpl->m_pShadowObjectAlphaClipPass = effectHelper.GetEffectPass("ShadowObjectAlphaClip");
+	m_pImpl->m_pShadowInstanceAlphaClipPass = effectHelper.GetEffectPass("ShadowInstanceAlphaClip");
+	m_pImpl->m_pShadowCompactInstanceAlphaClipPass = effectHelper.GetEffectPass("ShadowCompactInstanceAlphaClip");
+	m_pImpl->m_viewProjHandle = effectHelper.GetConstantBufferVariableHandle("g_ViewProj");
+	m_pImpl->m_worldViewProjHandle = effectHelper.GetConstantBufferVariableHandle("g_WorldViewProj");
+	m_pImpl->m_diffuseMapHandle = effectHelper.GetShaderResourceHandle("g_DiffuseMap");
+
 	// 设置调试对象名
 	D3D11SetDebugObjectName(m_pImpl->m_pInstancePosNormalTexLayout.Get(), "ShadowEffect.InstancePosNormalTexLayout");
 	D3D11SetDebugObjectName(m_pImpl->m_pVertexPosNormalTexLayout.Get(), "ShadowEffect.VertexPosNormalTexLayout");
+	D3D11SetDebugObjectName(m_pImpl->m_pCompactInstancePosNormalTexLayout.Get(), "ShadowEffect.CompactInstancePosNormalTexLayout");
 	m_pImpl->m_pEffectHelper->SetDebugObjectName("ShadowEffect");
 
 	return true;
@@ -142,12 +193,17 @@ void ShadowEffect::SetRenderDefault(ID3D11DeviceContext* deviceContext, const Re
 	if (type == RenderType::RenderInstance)
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pInstancePosNormalTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("ShadowInstance");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pShadowInstancePass;
+	}
+	else if (type == RenderType::RenderCompactInstance)
+	{
+		deviceContext->IASetInputLayout(m_pImpl->m_pCompactInstancePosNormalTexLayout.Get());
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pShadowCompactInstancePass;
 	}
 	else
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosNormalTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("ShadowObject");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pShadowObjectPass;
 	}
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	m_pImpl->m_renderType = type;
@@ -158,12 +214,17 @@ void ShadowEffect::SetRenderAlphaClip(ID3D11DeviceContext* deviceContext, const
 	if (type == RenderType::RenderInstance)
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pInstancePosNormalTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("ShadowInstanceAlphaClip");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pShadowInstanceAlphaClipPass;
+	}
+	else if (type == RenderType::RenderCompactInstance)
+	{
+		deviceContext->IASetInputLayout(m_pImpl->m_pCompactInstancePosNormalTexLayout.Get());
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pShadowCompactInstanceAlphaClipPass;
 	}
 	else
 	{
 		deviceContext->IASetInputLayout(m_pImpl->m_pVertexPosNormalTexLayout.Get());
-		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pEffectHelper->GetEffectPass("ShadowObjectAlphaClip");
+		m_pImpl->m_pCurrEffectPass = m_pImpl->m_pShadowObjectAlphaClipPass;
 	}
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	m_pImpl->m_renderType = type;
@@ -171,7 +232,7 @@ void ShadowEffect::SetRenderAlphaClip(ID3D11DeviceContext* deviceContext, const
 
 void ShadowEffect::SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const
 {
-	m_pImpl->m_pEffectHelper->SetShaderResourceByName("g_DiffuseMap", textureDiffuse);
+	m_pImpl->m_diffuseMapHandle.Set(textureDiffuse);
 }
 
 void XM_CALLCONV ShadowEffect::SetWorldMatrix(FXMMATRIX world) const
@@ -189,17 +250,28 @@ void XM_CALLCONV ShadowEffect::SetProjMatrix(FXMMATRIX proj) const
 	XMStoreFloat4x4(&m_pImpl->m_proj, proj);
 }
 
+void XM_CALLCONV ShadowEffect::SetDrawParameters(const EffectDrawParameters& parameters, FXMMATRIX world) const
+{
+	SetWorldMatrix(world);
+	SetInstancedDrawParameters(parameters);
+}
+
+void ShadowEffect::SetInstancedDrawParameters(const EffectDrawParameters& parameters) const
+{
+	SetTextureDiffuse(parameters.textureDiffuse);
+}
+
 void ShadowEffect::Apply(ID3D11DeviceContext* deviceContext)
 {
-	if (m_pImpl->m_renderType == RenderType::RenderInstance)
+	if (m_pImpl->m_renderType != RenderType::RenderObject)
 	{
 		XMMATRIX viewProjMatrix = XMMatrixTranspose(XMLoadFloat4x4(&m_pImpl->m_view) * XMLoadFloat4x4(&m_pImpl->m_proj));
-		m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_ViewProj")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&viewProjMatrix));
+		m_pImpl->m_viewProjHandle.SetMatrix(viewProjMatrix);
 	}
 	else
 	{
 		XMMATRIX worldViewProjMatrix = XMMatrixTranspose(XMLoadFloat4x4(&m_pImpl->m_world) * XMLoadFloat4x4(&m_pImpl->m_view) * XMLoadFloat4x4(&m_pImpl->m_proj));
-		m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_WorldViewProj")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&worldViewProjMatrix));
+		m_pImpl->m_worldViewProjHandle.SetMatrix(worldViewProjMatrix);
 	}
 
 	m_pImpl->m_pCurrEffectPass->Apply(deviceContext);
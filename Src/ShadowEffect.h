@@ -55,6 +55,9 @@ public:
 	// IEffect
 	//
 
+	void XM_CALLCONV SetDrawParameters(const EffectDrawParameters& parameters, DirectX::FXMMATRIX world) const override;
+	void SetInstancedDrawParameters(const EffectDrawParameters& parameters) const override;
+
 	// 应用常量缓冲区和纹理资源的变更
 	void Apply(ID3D11DeviceContext* deviceContext) override;
 
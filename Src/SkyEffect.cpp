@@ -19,6 +19,10 @@ public:
 	XMFLOAT4X4 m_world{};
 	XMFLOAT4X4 m_view{};
 	XMFLOAT4X4 m_proj{};
+
+	// 初始化时解析的句柄
+	EffectVariableHandle m_worldViewProjHandle;
+	EffectShaderResourceHandle m_texCubeHandle;
 };
 
 //
@@ -101,6 +105,9 @@ bool SkyEffect::InitAll(ID3D11Device* device) const
 	m_pImpl->m_pCurrEffectPass->SetDepthStencilState(RenderStates::DSSLessEqual.Get(), 0);
 	m_pImpl->m_pCurrEffectPass->SetRasterizerState(RenderStates::RSNoCull.Get());
 
+	m_pImpl->m_worldViewProjHandle = m_pImpl->m_pEffectHelper->GetConstantBufferVariableHandle("g_WorldViewProj");
+	m_pImpl->m_texCubeHandle = m_pImpl->m_pEffectHelper->GetShaderResourceHandle("g_TexCube");
+
 	// 设置调试对象名
 	D3D11SetDebugObjectName(m_pImpl->m_pVertexPosLayout.Get(), "SkyEffect.VertexPosLayout");
 	m_pImpl->m_pEffectHelper->SetDebugObjectName("SkyEffect");
@@ -129,15 +136,20 @@ void XM_CALLCONV SkyEffect::SetProjMatrix(FXMMATRIX proj) const
 	XMStoreFloat4x4(&m_pImpl->m_proj, proj);
 }
 
+void XM_CALLCONV SkyEffect::SetDrawParameters(const EffectDrawParameters&, FXMMATRIX world) const
+{
+	SetWorldMatrix(world);
+}
+
 void SkyEffect::SetTextureCube(ID3D11ShaderResourceView* textureCube) const
 {
-	m_pImpl->m_pEffectHelper->SetShaderResourceByName("g_TexCube", textureCube);
+	m_pImpl->m_texCubeHandle.Set(textureCube);
 }
 
 void SkyEffect::Apply(ID3D11DeviceContext* deviceContext)
 {
 	XMMATRIX worldViewProjMatrix = XMMatrixTranspose(XMLoadFloat4x4(&m_pImpl->m_world) * XMLoadFloat4x4(&m_pImpl->m_view) * XMLoadFloat4x4(&m_pImpl->m_proj));
-	m_pImpl->m_pEffectHelper->GetConstantBufferVariable("g_WorldViewProj")->SetFloatMatrix(4, 4, reinterpret_cast<const FLOAT*>(&worldViewProjMatrix));
+	m_pImpl->m_worldViewProjHandle.SetMatrix(worldViewProjMatrix);
 
 	m_pImpl->m_pCurrEffectPass->Apply(deviceContext);
 }
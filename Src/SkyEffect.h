@@ -43,9 +43,12 @@ public:
 	void SetTextureCube(ID3D11ShaderResourceView* textureCube) const;
 
 	//
-	// 矩阵设置
+	// IEffect
 	//
 
+	// 天空盒没有材质与纹理,只使用世界矩阵
+	void XM_CALLCONV SetDrawParameters(const EffectDrawParameters& parameters, DirectX::FXMMATRIX world) const override;
+
 	// 应用常量缓冲区和纹理资源的变更
 	void Apply(ID3D11DeviceContext* deviceContext) override;
 
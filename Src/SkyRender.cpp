@@ -1,4 +1,5 @@
 #include "SkyRender.h"
+#include "RenderQueue.h"
 
 #pragma warning(disable: 26812)
 
@@ -66,12 +67,12 @@ ID3D11ShaderResourceView* SkyRender::GetTextureCube() const
 
 void SkyRender::Draw(ID3D11DeviceContext* deviceContext, SkyEffect& skyEffect, const Camera& camera)
 {
-	UINT strides[1] = { sizeof(XMFLOAT3) };
-	UINT offsets[1] = { 0 };
-	deviceContext->IASetVertexBuffers(0, 1, m_pVertexBuffer.GetAddressOf(), strides, offsets);
-	deviceContext->IASetIndexBuffer(m_pIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+	D3D11RenderBackend backend(deviceContext);
+	Draw(backend, skyEffect, camera);
+}
 
-	skyEffect.SetWorldMatrix(XMMatrixIdentity());
+void SkyRender::Draw(IRenderBackend& backend, SkyEffect& skyEffect, const Camera& camera)
+{
 	// 抹除平移分量，避免摄像机移动带来天空盒抖动
 	XMMATRIX view = camera.GetViewMatrix();
 	view.r[3] = g_XMIdentityR3;
@@ -79,8 +80,15 @@ void SkyRender::Draw(ID3D11DeviceContext* deviceContext, SkyEffect& skyEffect, c
 	skyEffect.SetProjMatrix(camera.GetProjMatrix());
 	
 	skyEffect.SetTextureCube(m_pTextureCubeSRV.Get());
-	skyEffect.Apply(deviceContext);
-	deviceContext->DrawIndexed(m_indexCount, 0, 0);
+
+	// 天空盒没有材质与纹理,SkyEffect只读取世界矩阵
+	RenderQueue::PartState state{};
+	state.vertexBuffer = ToRenderBuffer(m_pVertexBuffer.Get());
+	state.indexBuffer = ToRenderBuffer(m_pIndexBuffer.Get());
+	state.indexFormat = RenderIndexFormat::UInt32;
+	state.indexCount = m_indexCount;
+	state.vertexStride = sizeof(XMFLOAT3);
+	RenderQueue::DrawPart(backend, ToRenderEffect(&skyEffect), skyEffect, state, XMMatrixIdentity());
 }
 
 void SkyRender::SetDebugObjectName(const std::string& name) const
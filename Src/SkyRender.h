@@ -15,6 +15,7 @@
 #include "Geometry.h"
 #include "d3dUtil.h"
 #include "Effect.h"
+#include "RenderBackendD3D11.h"
 
 class SkyRender
 {
@@ -49,6 +50,7 @@ public:
 	ID3D11ShaderResourceView* GetTextureCube() const;
 
 	void Draw(ID3D11DeviceContext* deviceContext, SkyEffect& skyEffect, const Camera& camera);
+	void Draw(IRenderBackend& backend, SkyEffect& skyEffect, const Camera& camera);
 
 	// 设置调试对象名
 	void SetDebugObjectName(const std::string& name) const;
@@ -0,0 +1,127 @@
+#include "StaticBatch.h"
+#include "EffectHelper.h"
+#include "d3dUtil.h"
+#include "DXTrace.h"
+
+using namespace DirectX;
+
+UINT StaticBatch::Add(Builder& builder, const MeshData& meshData, const Material& material,
+	ID3D11ShaderResourceView* texDiffuse, ID3D11ShaderResourceView* texNormalMap, FXMMATRIX world)
+{
+	return builder.Add(meshData.vertexVec, meshData.indexVec, material, RegisterTexture(texDiffuse), RegisterTexture(texNormalMap), world);
+}
+
+HRESULT StaticBatch::InitResource(ID3D11Device* device, Builder builder)
+{
+	m_builder = std::move(builder);
+	m_builder.Build();
+
+	m_pVertexBuffer.Reset();
+	m_pIndexBuffer.Reset();
+
+	const std::vector<VertexType>& vertices = m_builder.GetVertices();
+	const std::vector<DWORD>& indices = m_builder.GetIndices();
+	if (vertices.empty() || indices.empty())
+		return S_OK;
+
+	HRESULT hr = CreateVertexBuffer(device, const_cast<VertexType*>(vertices.data()),
+		static_cast<UINT>(vertices.size() * sizeof(VertexType)), m_pVertexBuffer.GetAddressOf());
+	if (FAILED(hr))
+		return hr;
+
+	hr = CreateIndexBuffer(device, const_cast<DWORD*>(indices.data()),
+		static_cast<UINT>(indices.size() * sizeof(DWORD)), m_pIndexBuffer.GetAddressOf());
+	if (FAILED(hr))
+		return hr;
+
+	// 几何体已经在GPU上,CPU端只保留生成绘制范围需要的信息
+	m_builder.ReleaseGeometry();
+	return S_OK;
+}
+
+UINT StaticBatch::BuildDrawRanges(const std::vector<UINT>& visibleSources, std::vector<DrawRange>& outRanges) const
+{
+	return m_builder.BuildDrawRanges(visibleSources, outRanges);
+}
+
+void StaticBatch::Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const std::vector<DrawRange>& ranges) const
+{
+	D3D11RenderBackend backend(deviceContext);
+	Draw(backend, effect, ranges);
+}
+
+void StaticBatch::Draw(IRenderBackend& backend, IEffect* effect, const std::vector<DrawRange>& ranges) const
+{
+	if (ranges.empty() || !m_pVertexBuffer)
+		return;
+
+	// 所有批次共享同一组顶点/索引缓冲区,只绑定一次
+	const UINT strides = sizeof(VertexType);
+	const UINT offsets = 0;
+	RenderBuffer* const vertexBuffer = ToRenderBuffer(m_pVertexBuffer.Get());
+	backend.SetVertexBuffers(0, 1, &vertexBuffer, &strides, &offsets);
+	backend.SetIndexBuffer(ToRenderBuffer(m_pIndexBuffer.Get()), RenderIndexFormat::UInt32, 0);
+
+	const std::vector<Builder::Batch>& batches = m_builder.GetBatches();
+	UINT currBatch = static_cast<UINT>(batches.size());
+	for (const DrawRange& range : ranges)
+	{
+		// 范围按批次排序,只在批次变化时更新材质与纹理
+		if (range.batch != currBatch)
+		{
+			const Builder::Batch& batch = batches[range.batch];
+			effect->SetDrawParameters({ &batch.material, GetTexture(batch.texDiffuse), GetTexture(batch.texNormalMap) }, XMMatrixIdentity());
+			backend.ApplyEffect(ToRenderEffect(effect));
+			currBatch = range.batch;
+		}
+
+		backend.DrawIndexed(range.indexCount, range.startIndex, range.baseVertex);
+	}
+}
+
+UINT StaticBatch::GetBatchCount() const
+{
+	return static_cast<UINT>(m_builder.GetBatches().size());
+}
+
+UINT StaticBatch::GetSourceCount() const
+{
+	return static_cast<UINT>(m_builder.GetSources().size());
+}
+
+UINT StaticBatch::RegisterTexture(ID3D11ShaderResourceView* texture)
+{
+	if (!texture)
+		return 0;
+
+	// 纹理数目很少,直接线性查找
+	for (UINT i = 0; i < static_cast<UINT>(m_textures.size()); ++i)
+	{
+		if (m_textures[i].Get() == texture)
+			return i + 1;
+	}
+
+	m_textures.emplace_back(texture);
+	return static_cast<UINT>(m_textures.size());
+}
+
+ID3D11ShaderResourceView* StaticBatch::GetTexture(const UINT id) const
+{
+	return id == 0 ? nullptr : m_textures[id - 1].Get();
+}
+
+void StaticBatch::SetDebugObjectName(const std::string& name)
+{
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+	if (m_pVertexBuffer)
+	{
+		D3D11SetDebugObjectName(m_pVertexBuffer.Get(), name + ".StaticVertexBuffer");
+	}
+	if (m_pIndexBuffer)
+	{
+		D3D11SetDebugObjectName(m_pIndexBuffer.Get(), name + ".StaticIndexBuffer");
+	}
+#else
+	UNREFERENCED_PARAMETER(name);
+#endif
+}
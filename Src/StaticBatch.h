@@ -0,0 +1,69 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 静态几何体合批
+// 合并逻辑位于StaticBatchBuilder,这里登记纹理、创建共享的顶点/索引缓冲区并绘制合并后的范围
+// Static geometry batch: owns the textures and the shared vertex/index buffers.
+//***************************************************************************************
+
+#ifndef STATICBATCH_H
+#define STATICBATCH_H
+
+#include "Geometry.h"
+#include "StaticBatchBuilder.h"
+#include "RenderBackendD3D11.h"
+
+#include <d3d11_1.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <string>
+#include <vector>
+
+class IEffect;
+
+class StaticBatch
+{
+public:
+	template<typename T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+	using VertexType = VertexPosNormalTangentTex;
+	using MeshData = Geometry::MeshData<VertexType, DWORD>;
+	using Builder = StaticBatchBuilder<VertexType>;
+	using DrawRange = Builder::DrawRange;
+
+	// 登记纹理并将网格合并到builder中,返回来源的编号
+	// 纹理由StaticBatch持有,builder中只保存编号
+	UINT XM_CALLCONV Add(Builder& builder, const MeshData& meshData, const Material& material,
+		ID3D11ShaderResourceView* texDiffuse, ID3D11ShaderResourceView* texNormalMap, DirectX::FXMMATRIX world);
+
+	// 以builder合并的结果创建顶点/索引缓冲区,builder尚未Build时先Build
+	// 上传后不再保留合并后的顶点与索引数组
+	HRESULT InitResource(ID3D11Device* device, Builder builder);
+
+	// 在绘制线程之外调用,结果在绘制之前保持不变
+	UINT BuildDrawRanges(const std::vector<UINT>& visibleSources, std::vector<DrawRange>& outRanges) const;
+
+	// 绘制范围,渲染状态需要事先设置为普通绘制(RenderObject),世界矩阵为单位矩阵
+	void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const std::vector<DrawRange>& ranges) const;
+	void Draw(IRenderBackend& backend, IEffect* effect, const std::vector<DrawRange>& ranges) const;
+
+	UINT GetBatchCount() const;
+	UINT GetSourceCount() const;
+
+	// 设置调试对象名
+	void SetDebugObjectName(const std::string& name);
+
+private:
+	// 同一纹理总是得到同一编号,nullptr为0
+	UINT RegisterTexture(ID3D11ShaderResourceView* texture);
+	ID3D11ShaderResourceView* GetTexture(UINT id) const;
+
+	Builder m_builder;
+	std::vector<ComPtr<ID3D11ShaderResourceView>> m_textures;		// 编号为下标加1
+
+	ComPtr<ID3D11Buffer> m_pVertexBuffer;
+	ComPtr<ID3D11Buffer> m_pIndexBuffer;
+};
+
+#endif
@@ -0,0 +1,284 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 静态合批的合并逻辑
+// 不会移动的网格按材质与纹理分组,顶点预先变换到世界空间后追加到同一组顶点/索引数组中,
+// 同一批次的网格在索引数组中连续存放,绘制时世界矩阵为单位矩阵,以BaseVertexLocation定位批次
+// 每个合并进来的网格(来源)保留自己的索引范围,剔除后相邻的可见范围合并为一次DrawIndexed
+// 纹理以调用者分配的编号区分,不依赖D3D,StaticBatch与单元测试中的顶点类型共用同一份实现
+// Static geometry batching with merged draw ranges, keyed on opaque texture ids.
+//***************************************************************************************
+
+#ifndef STATICBATCHBUILDER_H
+#define STATICBATCHBUILDER_H
+
+#include "PortableTypes.h"
+#include "LightHelper.h"
+
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+//
+// VertexType需要提供:
+//	DirectX::XMFLOAT3 pos;
+//	DirectX::XMFLOAT3 normal;
+//	DirectX::XMFLOAT4 tangent;				// w为副切线的方向
+//
+template <typename VertexType>
+class StaticBatchBuilder
+{
+public:
+	// 材质与纹理相同的网格合并为一个批次
+	struct Batch
+	{
+		Material material;
+		UINT texDiffuse;		// 调用者分配的纹理编号
+		UINT texNormalMap;
+		UINT baseVertex;		// 批次在合并顶点数组中的起始顶点,批次内的索引相对于它
+		UINT vertexCount;
+		UINT startIndex;		// 批次在合并索引数组中的起始位置
+		UINT indexCount;
+	};
+
+	// 一个合并进来的网格
+	struct Source
+	{
+		UINT batch;
+		UINT startIndex;		// Build之后为合并索引数组中的位置
+		UINT indexCount;
+	};
+
+	// 一次DrawIndexed的参数
+	struct DrawRange
+	{
+		UINT batch;
+		UINT startIndex;
+		UINT indexCount;
+		INT baseVertex;
+	};
+
+	// 合并一个网格,顶点按world变换到世界空间(法线使用逆转置矩阵),返回来源的编号
+	// 纹理编号只用于比较,相同的纹理需要使用相同的编号
+	// 来源按添加顺序编号,同一批次内相邻添加的网格在索引数组中也相邻
+	UINT XM_CALLCONV Add(const std::vector<VertexType>& vertices, const std::vector<DWORD>& indices, const Material& material,
+		UINT texDiffuse, UINT texNormalMap, DirectX::FXMMATRIX world);
+	// 按批次顺序拼接所有顶点与索引,之后不能再添加网格
+	void Build();
+	// 释放合并后的顶点与索引数组,保留批次与来源信息
+	void ReleaseGeometry();
+
+	// 由可见来源生成绘制范围,按批次排序,同一批次中索引连续的来源合并为一个范围,返回范围数目
+	UINT BuildDrawRanges(const std::vector<UINT>& visibleSources, std::vector<DrawRange>& outRanges) const;
+	// 所有来源都可见,每个批次一个范围
+	UINT BuildDrawRanges(std::vector<DrawRange>& outRanges) const;
+
+	const std::vector<Batch>& GetBatches() const;
+	const std::vector<Source>& GetSources() const;
+	const std::vector<VertexType>& GetVertices() const;
+	const std::vector<DWORD>& GetIndices() const;
+	bool IsBuilt() const;
+
+private:
+	UINT FindBatch(const Material& material, UINT texDiffuse, UINT texNormalMap);
+
+	std::vector<Batch> m_batches;
+	std::vector<Source> m_sources;
+	// Build之前每个批次单独存放
+	std::vector<std::vector<VertexType>> m_batchVertices;
+	std::vector<std::vector<DWORD>> m_batchIndices;
+
+	std::vector<VertexType> m_vertices;
+	std::vector<DWORD> m_indices;
+	bool m_isBuilt = false;
+};
+
+template <typename VertexType>
+UINT StaticBatchBuilder<VertexType>::Add(const std::vector<VertexType>& vertices, const std::vector<DWORD>& indices, const Material& material,
+	const UINT texDiffuse, const UINT texNormalMap, DirectX::FXMMATRIX world)
+{
+	using namespace DirectX;
+
+	assert(!m_isBuilt);
+
+	const UINT batch = FindBatch(material, texDiffuse, texNormalMap);
+	std::vector<VertexType>& batchVertices = m_batchVertices[batch];
+	std::vector<DWORD>& batchIndices = m_batchIndices[batch];
+
+	// 法线与切线使用逆转置矩阵,非等比缩放时仍与表面垂直/相切
+	XMMATRIX normalMatrix = world;
+	normalMatrix.r[3] = g_XMIdentityR3;
+	normalMatrix = XMMatrixTranspose(XMMatrixInverse(nullptr, normalMatrix));
+
+	const UINT vertexBase = static_cast<UINT>(batchVertices.size());
+	batchVertices.reserve(batchVertices.size() + vertices.size());
+	for (const VertexType& vertex : vertices)
+	{
+		VertexType transformed = vertex;
+		XMStoreFloat3(&transformed.pos, XMVector3TransformCoord(XMLoadFloat3(&vertex.pos), world));
+		XMStoreFloat3(&transformed.normal, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&vertex.normal), normalMatrix)));
+		// 切线沿表面方向,直接以世界矩阵变换,w为副切线的方向
+		const XMVECTOR tangent = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat4(&vertex.tangent), world));
+		XMStoreFloat4(&transformed.tangent, XMVectorSelect(XMLoadFloat4(&vertex.tangent), tangent, g_XMSelect1110));
+		batchVertices.push_back(transformed);
+	}
+
+	const UINT startIndex = static_cast<UINT>(batchIndices.size());
+	batchIndices.reserve(batchIndices.size() + indices.size());
+	for (const DWORD index : indices)
+	{
+		batchIndices.push_back(index + vertexBase);
+	}
+
+	m_batches[batch].vertexCount += static_cast<UINT>(vertices.size());
+	m_batches[batch].indexCount += static_cast<UINT>(indices.size());
+	m_sources.push_back({ batch, startIndex, static_cast<UINT>(indices.size()) });
+	return static_cast<UINT>(m_sources.size()) - 1;
+}
+
+template <typename VertexType>
+void StaticBatchBuilder<VertexType>::Build()
+{
+	if (m_isBuilt)
+		return;
+
+	UINT baseVertex = 0;
+	UINT startIndex = 0;
+	for (Batch& batch : m_batches)
+	{
+		batch.baseVertex = baseVertex;
+		batch.startIndex = startIndex;
+		baseVertex += batch.vertexCount;
+		startIndex += batch.indexCount;
+	}
+
+	m_vertices.reserve(baseVertex);
+	m_indices.reserve(startIndex);
+	for (size_t i = 0; i < m_batches.size(); ++i)
+	{
+		m_vertices.insert(m_vertices.end(), m_batchVertices[i].cbegin(), m_batchVertices[i].cend());
+		m_indices.insert(m_indices.end(), m_batchIndices[i].cbegin(), m_batchIndices[i].cend());
+	}
+
+	// 来源的索引范围改为合并索引数组中的位置
+	for (Source& source : m_sources)
+	{
+		source.startIndex += m_batches[source.batch].startIndex;
+	}
+
+	m_batchVertices.clear();
+	m_batchIndices.clear();
+	m_isBuilt = true;
+}
+
+template <typename VertexType>
+void StaticBatchBuilder<VertexType>::ReleaseGeometry()
+{
+	std::vector<VertexType>().swap(m_vertices);
+	std::vector<DWORD>().swap(m_indices);
+}
+
+template <typename VertexType>
+UINT StaticBatchBuilder<VertexType>::BuildDrawRanges(const std::vector<UINT>& visibleSources, std::vector<DrawRange>& outRanges) const
+{
+	assert(m_isBuilt);
+
+	outRanges.clear();
+	for (const UINT index : visibleSources)
+	{
+		const Source& source = m_sources[index];
+		outRanges.push_back({ source.batch, source.startIndex, source.indexCount, static_cast<INT>(m_batches[source.batch].baseVertex) });
+	}
+
+	// 批次在索引数组中按顺序存放,按起始位置排序即按批次排序
+	std::sort(outRanges.begin(), outRanges.end(),
+		[](const DrawRange& lhs, const DrawRange& rhs) { return lhs.startIndex < rhs.startIndex; });
+
+	// 合并首尾相接的范围,同一来源重复出现时也只绘制一次
+	size_t count = 0;
+	for (const DrawRange& range : outRanges)
+	{
+		if (count > 0)
+		{
+			DrawRange& last = outRanges[count - 1];
+			const UINT lastEnd = last.startIndex + last.indexCount;
+			if (last.batch == range.batch && range.startIndex <= lastEnd)
+			{
+				last.indexCount = (std::max)(lastEnd, range.startIndex + range.indexCount) - last.startIndex;
+				continue;
+			}
+		}
+		outRanges[count++] = range;
+	}
+	outRanges.resize(count);
+
+	return static_cast<UINT>(count);
+}
+
+template <typename VertexType>
+UINT StaticBatchBuilder<VertexType>::BuildDrawRanges(std::vector<DrawRange>& outRanges) const
+{
+	assert(m_isBuilt);
+
+	outRanges.clear();
+	for (UINT i = 0; i < static_cast<UINT>(m_batches.size()); ++i)
+	{
+		const Batch& batch = m_batches[i];
+		if (batch.indexCount > 0)
+			outRanges.push_back({ i, batch.startIndex, batch.indexCount, static_cast<INT>(batch.baseVertex) });
+	}
+
+	return static_cast<UINT>(outRanges.size());
+}
+
+template <typename VertexType>
+const std::vector<typename StaticBatchBuilder<VertexType>::Batch>& StaticBatchBuilder<VertexType>::GetBatches() const
+{
+	return m_batches;
+}
+
+template <typename VertexType>
+const std::vector<typename StaticBatchBuilder<VertexType>::Source>& StaticBatchBuilder<VertexType>::GetSources() const
+{
+	return m_sources;
+}
+
+template <typename VertexType>
+const std::vector<VertexType>& StaticBatchBuilder<VertexType>::GetVertices() const
+{
+	return m_vertices;
+}
+
+template <typename VertexType>
+const std::vector<DWORD>& StaticBatchBuilder<VertexType>::GetIndices() const
+{
+	return m_indices;
+}
+
+template <typename VertexType>
+bool StaticBatchBuilder<VertexType>::IsBuilt() const
+{
+	return m_isBuilt;
+}
+
+template <typename VertexType>
+UINT StaticBatchBuilder<VertexType>::FindBatch(const Material& material, const UINT texDiffuse, const UINT texNormalMap)
+{
+	// 批次数目很少,直接线性查找
+	for (UINT i = 0; i < static_cast<UINT>(m_batches.size()); ++i)
+	{
+		const Batch& batch = m_batches[i];
+		if (batch.texDiffuse == texDiffuse && batch.texNormalMap == texNormalMap &&
+			std::memcmp(&batch.material, &material, sizeof(Material)) == 0)
+			return i;
+	}
+
+	m_batches.push_back({ material, texDiffuse, texNormalMap, 0, 0, 0, 0 });
+	m_batchVertices.emplace_back();
+	m_batchIndices.emplace_back();
+	return static_cast<UINT>(m_batches.size()) - 1;
+}
+
+#endif
@@ -78,8 +78,13 @@ public:
 		SetTankPosition(adjustedPos);
 	}
 
-	// 绘制
+	// 绘制,需要先调用UpdateBounds
 	virtual void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect) = 0;
+	// 重新计算世界矩阵与层次包围盒,每帧在所有绘制之前调用一次,绘制过程只读取它们
+	virtual void UpdateBounds() = 0;
+	// 以层次包围盒剔除后绘制
+	virtual void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingFrustum& frustum, GameObject::CullStatistics* pStatistics) = 0;
+	virtual void Draw(ID3D11DeviceContext* deviceContext, IEffect* effect, const DirectX::BoundingOrientedBox& volume, GameObject::CullStatistics* pStatistics) = 0;
 
 private:
 	// 获取坦克Transform
@@ -1,4 +1,5 @@
 #include "TextureRender.h"
+#include "EffectHelper.h"
 
 #pragma warning(disable: 26812)
 
@@ -120,6 +121,9 @@ void TextureRender::Begin(ID3D11DeviceContext* deviceContext, const FLOAT backgr
 		m_pOutputTextureDSV.Get());
 	// 设置视口
 	deviceContext->RSSetViewports(1, &m_outputViewPort);
+
+	// 输出纹理若仍作为着色器资源绑定,会被运行时自动解除
+	EffectStateCache::Invalidate(deviceContext);
 }
 
 void TextureRender::End(ID3D11DeviceContext* deviceContext)
@@ -127,6 +131,7 @@ void TextureRender::End(ID3D11DeviceContext* deviceContext)
 	// 恢复默认设定
 	deviceContext->RSSetViewports(1, &m_cacheViewPort);
 	deviceContext->OMSetRenderTargets(1, m_pCacheRTV.GetAddressOf(), m_pCacheDSV.Get());
+	EffectStateCache::Invalidate(deviceContext);
 
 	// 若之前有指定需要mipmap链，则生成
 	if (m_generateMips)
@@ -0,0 +1,242 @@
+#include "TransformStore.h"
+
+#include <cassert>
+
+using namespace DirectX;
+
+namespace
+{
+	// 最低位的1所在的位置,word不能为0
+	// 只保留最低位的1后乘以De Bruijn序列,高5位即为查表的下标,不依赖编译器内建函数
+	UINT CountTrailingZeros(const UINT word)
+	{
+		static constexpr UINT8 Positions[32] =
+		{
+			0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+			31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+		};
+		assert(word != 0);
+		return Positions[((word & (0u - word)) * 0x077CB531u) >> 27];
+	}
+}
+
+void TransformStore::Reserve(const UINT count)
+{
+	m_scales.reserve(count);
+	m_rotations.reserve(count);
+	m_positions.reserve(count);
+	m_worldMatrices.reserve(count);
+	m_dirtyBits.reserve((count + 31) / 32);
+	m_denseToHandle.reserve(count);
+	m_handleToDense.reserve(count);
+	m_generations.reserve(count);
+}
+
+void TransformStore::Clear()
+{
+	m_scales.clear();
+	m_rotations.clear();
+	m_positions.clear();
+	m_worldMatrices.clear();
+	m_dirtyBits.clear();
+	m_denseToHandle.clear();
+
+	// 已经发出的句柄全部失效
+	m_freeHandles.clear();
+	for (UINT i = 0; i < m_handleToDense.size(); ++i)
+	{
+		m_handleToDense[i] = InvalidIndex;
+		++m_generations[i];
+		m_freeHandles.push_back(i);
+	}
+}
+
+TransformStore::Handle TransformStore::Create(const XMFLOAT3& scale, const XMFLOAT4& rotation, const XMFLOAT3& position)
+{
+	UINT index;
+	if (!m_freeHandles.empty())
+	{
+		index = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+	else
+	{
+		index = static_cast<UINT>(m_handleToDense.size());
+		m_handleToDense.push_back(InvalidIndex);
+		m_generations.push_back(0);
+	}
+
+	const UINT denseIndex = GetCount();
+	m_handleToDense[index] = denseIndex;
+	m_denseToHandle.push_back(index);
+
+	m_scales.push_back(scale);
+	m_rotations.push_back(rotation);
+	m_positions.push_back(position);
+	m_worldMatrices.emplace_back();
+	if (denseIndex / 32 >= m_dirtyBits.size())
+		m_dirtyBits.push_back(0);
+	MarkDirty(denseIndex);
+
+	return { index, m_generations[index] };
+}
+
+TransformStore::Handle TransformStore::Create(const BasicTransform& transform)
+{
+	return Create(transform.GetScaleFloat3(), transform.GetRotationQuaternionFloat4(), transform.GetPositionFloat3());
+}
+
+void TransformStore::Destroy(const Handle handle)
+{
+	if (!IsValid(handle))
+		return;
+
+	const UINT denseIndex = m_handleToDense[handle.index];
+	const UINT lastIndex = GetCount() - 1;
+
+	// 将最后一个实例移动到空出的位置
+	if (denseIndex != lastIndex)
+	{
+		m_scales[denseIndex] = m_scales[lastIndex];
+		m_rotations[denseIndex] = m_rotations[lastIndex];
+		m_positions[denseIndex] = m_positions[lastIndex];
+		m_worldMatrices[denseIndex] = m_worldMatrices[lastIndex];
+		if (IsDirty(lastIndex))
+			MarkDirty(denseIndex);
+		else
+			ClearDirty(denseIndex);
+
+		const UINT movedHandle = m_denseToHandle[lastIndex];
+		m_denseToHandle[denseIndex] = movedHandle;
+		m_handleToDense[movedHandle] = denseIndex;
+	}
+
+	ClearDirty(lastIndex);
+	m_scales.pop_back();
+	m_rotations.pop_back();
+	m_positions.pop_back();
+	m_worldMatrices.pop_back();
+	m_denseToHandle.pop_back();
+	if (lastIndex % 32 == 0)
+		m_dirtyBits.pop_back();
+
+	m_handleToDense[handle.index] = InvalidIndex;
+	++m_generations[handle.index];
+	m_freeHandles.push_back(handle.index);
+}
+
+bool TransformStore::IsValid(const Handle handle) const
+{
+	return handle.index < m_handleToDense.size() &&
+		m_generations[handle.index] == handle.generation &&
+		m_handleToDense[handle.index] != InvalidIndex;
+}
+
+UINT TransformStore::GetCount() const
+{
+	return static_cast<UINT>(m_denseToHandle.size());
+}
+
+UINT TransformStore::GetDenseIndex(const Handle handle) const
+{
+	return IsValid(handle) ? m_handleToDense[handle.index] : InvalidIndex;
+}
+
+XMFLOAT3 TransformStore::GetScale(const Handle handle) const
+{
+	return m_scales[ToDense(handle)];
+}
+
+XMFLOAT4 TransformStore::GetRotation(const Handle handle) const
+{
+	return m_rotations[ToDense(handle)];
+}
+
+XMFLOAT3 TransformStore::GetPosition(const Handle handle) const
+{
+	return m_positions[ToDense(handle)];
+}
+
+void TransformStore::SetScale(const Handle handle, const XMFLOAT3& scale)
+{
+	const UINT denseIndex = ToDense(handle);
+	m_scales[denseIndex] = scale;
+	MarkDirty(denseIndex);
+}
+
+void TransformStore::SetRotation(const Handle handle, const XMFLOAT4& rotation)
+{
+	const UINT denseIndex = ToDense(handle);
+	m_rotations[denseIndex] = rotation;
+	MarkDirty(denseIndex);
+}
+
+void TransformStore::SetRotationEuler(const Handle handle, const XMFLOAT3& eulerAnglesInRadian)
+{
+	XMFLOAT4 rotation{};
+	XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYawFromVector(XMLoadFloat3(&eulerAnglesInRadian)));
+	SetRotation(handle, rotation);
+}
+
+void TransformStore::SetPosition(const Handle handle, const XMFLOAT3& position)
+{
+	const UINT denseIndex = ToDense(handle);
+	m_positions[denseIndex] = position;
+	MarkDirty(denseIndex);
+}
+
+UINT TransformStore::UpdateWorldMatrices()
+{
+	UINT updatedCount = 0;
+	const UINT wordCount = static_cast<UINT>(m_dirtyBits.size());
+	for (UINT wordIndex = 0; wordIndex < wordCount; ++wordIndex)
+	{
+		// 整个字为0时一次跳过32个实例
+		UINT word = m_dirtyBits[wordIndex];
+		m_dirtyBits[wordIndex] = 0;
+
+		while (word)
+		{
+			const UINT i = wordIndex * 32 + CountTrailingZeros(word);
+			word &= word - 1;
+
+			// S * R * T
+			const XMMATRIX world = XMMatrixAffineTransformation(
+				XMLoadFloat3(&m_scales[i]), g_XMZero, XMLoadFloat4(&m_rotations[i]), XMLoadFloat3(&m_positions[i]));
+			XMStoreFloat4x4(&m_worldMatrices[i], world);
+			++updatedCount;
+		}
+	}
+	return updatedCount;
+}
+
+const XMFLOAT4X4& TransformStore::GetWorldMatrix(const Handle handle) const
+{
+	return m_worldMatrices[ToDense(handle)];
+}
+
+const std::vector<XMFLOAT4X4>& TransformStore::GetWorldMatrices() const
+{
+	return m_worldMatrices;
+}
+
+UINT TransformStore::ToDense(const Handle handle) const
+{
+	assert(IsValid(handle));
+	return m_handleToDense[handle.index];
+}
+
+void TransformStore::MarkDirty(const UINT denseIndex)
+{
+	m_dirtyBits[denseIndex / 32] |= 1u << (denseIndex % 32);
+}
+
+void TransformStore::ClearDirty(const UINT denseIndex)
+{
+	m_dirtyBits[denseIndex / 32] &= ~(1u << (denseIndex % 32));
+}
+
+bool TransformStore::IsDirty(const UINT denseIndex) const
+{
+	return (m_dirtyBits[denseIndex / 32] >> (denseIndex % 32)) & 1;
+}
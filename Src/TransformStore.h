@@ -0,0 +1,89 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 以结构数组(SoA)方式存放大量实例的变换
+// 位置、旋转(四元数)、缩放与世界矩阵分别连续存放,只有被修改过的实例才会重建世界矩阵
+// 句柄在其他实例被删除后仍然有效,数据始终保持紧密排列,可以直接作为实例数据使用
+// Structure-of-arrays transform storage with stable handles and dirty-bit world matrix updates.
+//***************************************************************************************
+
+#ifndef TRANSFORMSTORE_H
+#define TRANSFORMSTORE_H
+
+#include "PortableTypes.h"
+#include <DirectXMath.h>
+#include <vector>
+
+#include "BasicTransform.h"
+
+class TransformStore
+{
+public:
+	// 稳定的句柄,实例被删除后对应的句柄失效
+	struct Handle
+	{
+		UINT index;
+		UINT generation;
+	};
+
+	static constexpr UINT InvalidIndex = 0xFFFFFFFF;
+
+	void Reserve(UINT count);
+	void Clear();
+
+	// 创建实例,rotation为四元数
+	Handle Create(const DirectX::XMFLOAT3& scale, const DirectX::XMFLOAT4& rotation, const DirectX::XMFLOAT3& position);
+	// 以BasicTransform的缩放、旋转与位置创建实例
+	Handle Create(const BasicTransform& transform);
+	// 删除实例,最后一个实例会被移动到空出的位置
+	void Destroy(Handle handle);
+	bool IsValid(Handle handle) const;
+
+	// 实例数目
+	UINT GetCount() const;
+	// 句柄对应的实例在连续数组中的位置,删除实例后可能改变
+	UINT GetDenseIndex(Handle handle) const;
+
+	//
+	// 读写实例,修改后对应的世界矩阵在下一次UpdateWorldMatrices时重建
+	//
+
+	DirectX::XMFLOAT3 GetScale(Handle handle) const;
+	DirectX::XMFLOAT4 GetRotation(Handle handle) const;
+	DirectX::XMFLOAT3 GetPosition(Handle handle) const;
+
+	void SetScale(Handle handle, const DirectX::XMFLOAT3& scale);
+	void SetRotation(Handle handle, const DirectX::XMFLOAT4& rotation);
+	// 欧拉角(弧度制),与BasicTransform一致以Z-X-Y轴顺序旋转
+	void SetRotationEuler(Handle handle, const DirectX::XMFLOAT3& eulerAnglesInRadian);
+	void SetPosition(Handle handle, const DirectX::XMFLOAT3& position);
+
+	// 重建所有被修改过的世界矩阵,返回重建的数目
+	UINT UpdateWorldMatrices();
+
+	// 获取世界矩阵,需要先调用UpdateWorldMatrices
+	const DirectX::XMFLOAT4X4& GetWorldMatrix(Handle handle) const;
+	// 按连续数组顺序排列的全部世界矩阵
+	const std::vector<DirectX::XMFLOAT4X4>& GetWorldMatrices() const;
+
+private:
+	UINT ToDense(Handle handle) const;
+	void MarkDirty(UINT denseIndex);
+	void ClearDirty(UINT denseIndex);
+	bool IsDirty(UINT denseIndex) const;
+
+	// 按连续数组顺序排列
+	std::vector<DirectX::XMFLOAT3> m_scales;
+	std::vector<DirectX::XMFLOAT4> m_rotations;
+	std::vector<DirectX::XMFLOAT3> m_positions;
+	std::vector<DirectX::XMFLOAT4X4> m_worldMatrices;
+	std::vector<UINT> m_dirtyBits;				// 每一位对应一个实例
+	std::vector<UINT> m_denseToHandle;
+
+	// 按句柄索引排列
+	std::vector<UINT> m_handleToDense;
+	std::vector<UINT> m_generations;
+	std::vector<UINT> m_freeHandles;
+};
+
+#endif
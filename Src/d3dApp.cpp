@@ -1,6 +1,7 @@
 #include "d3dApp.h"
 #include "d3dUtil.h"
 #include "DXTrace.h"
+#include "EffectHelper.h"
 #include <sstream>
 
 namespace
@@ -53,7 +54,11 @@ D3DApp::~D3DApp()
 {
 	// 恢复所有默认设定
 	if (m_pd3dImmediateContext)
+	{
 		m_pd3dImmediateContext->ClearState();
+		// 特效状态缓存持有立即上下文的引用与常量缓冲区池,需要在设备销毁之前释放
+		EffectStateCache::Release(m_pd3dImmediateContext.Get());
+	}
 	
 	// 关闭ImGui
 	ImguiPanel::Shutdown();
@@ -0,0 +1,307 @@
+#include "TestHarness.h"
+#include "BasicTransform.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float Epsilon = 1e-4f;
+
+	// 直接修改受保护的成员而不使缓存失效,用来区分缓存命中与重新计算:
+	// 命中时读到的仍然是修改之前的结果
+	class ProbeTransform : public BasicTransform
+	{
+	public:
+		void PokeScale(const XMFLOAT3& scale) { m_scale = scale; }
+		void PokeRotation(const XMFLOAT4& rotation) { m_rotation = rotation; }
+		void PokePosition(const XMFLOAT3& position) { m_position = position; }
+	};
+
+	// 不使用缓存,由当前的缩放、旋转与位置直接计算
+	XMMATRIX ReferenceWorld(const BasicTransform& transform)
+	{
+		const XMFLOAT3 position = transform.GetPositionFloat3();
+		return XMMatrixScalingFromVector(transform.GetScaleVector()) *
+			XMMatrixRotationQuaternion(transform.GetRotationQuaternion()) *
+			XMMatrixTranslation(position.x, position.y, position.z);
+	}
+
+	bool SameMatrix(FXMMATRIX actual, CXMMATRIX expected)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			if (!XMVector4NearEqual(actual.r[i], expected.r[i], XMVectorReplicate(Epsilon)))
+				return false;
+		}
+		return true;
+	}
+
+	bool SameVector(FXMVECTOR actual, FXMVECTOR expected)
+	{
+		return XMVector3NearEqual(actual, expected, XMVectorReplicate(Epsilon));
+	}
+
+	const XMFLOAT4 QuarterTurnY(0.0f, 0.70710678f, 0.0f, 0.70710678f);
+
+	// 避开万向节死锁,俯仰角限制在(-π/2, π/2)之内
+	XMFLOAT3 RandomEulerAngles(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> pitch(-XM_PIDIV2 + 0.05f, XM_PIDIV2 - 0.05f);
+		std::uniform_real_distribution<float> angle(-XM_PI + 0.01f, XM_PI - 0.01f);
+		return XMFLOAT3(pitch(rng), angle(rng), angle(rng));
+	}
+
+	XMVECTOR RandomAxis(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		return XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0.0f) + XMVectorSet(0.0f, 0.0f, 1e-3f, 0.0f));
+	}
+
+	// 原来以欧拉角保存旋转时的实现: 组合矩阵后再反求欧拉角
+	class EulerTransform : public BasicTransform
+	{
+	public:
+		static XMFLOAT3 XM_CALLCONV RotateAxis(FXMVECTOR eulerAngles, FXMVECTOR axis, const float radian)
+		{
+			XMFLOAT4X4 rotation;
+			XMStoreFloat4x4(&rotation, XMMatrixRotationRollPitchYawFromVector(eulerAngles) * XMMatrixRotationAxis(axis, radian));
+			return GetEulerAnglesFromRotationTranslationFloat4X4(rotation);
+		}
+	};
+}
+
+TEST_CASE(RepeatedReadsHitTheCache)
+{
+	ProbeTransform transform;
+	transform.SetScale(2.0f, 3.0f, 4.0f);
+	transform.SetRotation(0.3f, 0.2f, 0.1f);
+	transform.SetPosition(1.0f, 2.0f, 3.0f);
+
+	const XMMATRIX world = transform.GetLocalToWorldMatrix();
+	const XMMATRIX rotation = transform.GetRotationMatrix();
+	const XMVECTOR right = transform.GetRightAxisVector();
+
+	// 绕过Set*修改数据,缓存没有失效,读到的仍是原来的矩阵
+	transform.PokeScale(XMFLOAT3(1.0f, 1.0f, 1.0f));
+	transform.PokeRotation(QuarterTurnY);
+	transform.PokePosition(XMFLOAT3(9.0f, 9.0f, 9.0f));
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), world));
+	CHECK(SameMatrix(transform.GetRotationMatrix(), rotation));
+	// 坐标轴读取缓存的旋转矩阵的行
+	CHECK(SameVector(transform.GetRightAxisVector(), right));
+	CHECK(SameVector(transform.GetUpAxisVector(), rotation.r[1]));
+	CHECK(SameVector(transform.GetForwardAxisVector(), rotation.r[2]));
+}
+
+TEST_CASE(ScaleAndPositionInvalidateOnlyTheWorldMatrix)
+{
+	ProbeTransform transform;
+	transform.SetRotation(0.3f, 0.2f, 0.1f);
+	const XMMATRIX rotation = transform.GetRotationMatrix();
+	transform.GetLocalToWorldMatrix();
+
+	// 旋转缓存命中: 修改了旋转但只使世界矩阵失效,世界矩阵以缓存的旋转重新计算
+	transform.PokeRotation(QuarterTurnY);
+	transform.SetPosition(5.0f, 6.0f, 7.0f);
+	const XMMATRIX world = transform.GetLocalToWorldMatrix();
+	CHECK(SameMatrix(transform.GetRotationMatrix(), rotation));
+	CHECK(SameVector(world.r[0], rotation.r[0]));
+	CHECK(SameVector(world.r[3], XMVectorSet(5.0f, 6.0f, 7.0f, 1.0f)));
+
+	transform.SetScale(2.0f, 2.0f, 2.0f);
+	CHECK(SameVector(transform.GetLocalToWorldMatrix().r[1], XMVectorScale(rotation.r[1], 2.0f)));
+
+	transform.Translate(g_XMIdentityR0, 1.0f);
+	CHECK(SameVector(transform.GetLocalToWorldMatrix().r[3], XMVectorSet(6.0f, 6.0f, 7.0f, 1.0f)));
+	CHECK(SameMatrix(transform.GetRotationMatrix(), rotation));
+}
+
+TEST_CASE(RotationInvalidatesBothMatrices)
+{
+	ProbeTransform transform;
+	transform.SetPosition(1.0f, 2.0f, 3.0f);
+	transform.GetLocalToWorldMatrix();
+
+	// 位置被绕过修改,旋转的改变使世界矩阵重新计算,因此也会读到新的位置
+	transform.PokePosition(XMFLOAT3(4.0f, 5.0f, 6.0f));
+	transform.SetRotationQuaternion(QuarterTurnY);
+	CHECK(SameMatrix(transform.GetRotationMatrix(), XMMatrixRotationY(XM_PIDIV2)));
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+	CHECK(SameVector(transform.GetForwardAxisVector(), XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f)));
+
+	// 其余修改旋转的操作同样会使缓存失效
+	const XMVECTOR axis = XMVector3Normalize(XMVectorSet(1.0f, 1.0f, 0.0f, 0.0f));
+	transform.SetRotation(0.1f, 0.2f, 0.3f);
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+	transform.Rotate(XMVectorSet(0.2f, 0.0f, 0.0f, 0.0f));
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+	transform.RotateAxis(axis, 0.7f);
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+	transform.RotateAround(g_XMZero, axis, 0.4f);
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+	transform.LookAt(XMVectorSet(10.0f, 0.0f, 10.0f, 1.0f));
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+	transform.LookTo(XMVectorSet(0.0f, -1.0f, 1.0f, 0.0f));
+	CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+}
+
+TEST_CASE(CachedResultsMatchDirectComputation)
+{
+	// 随机交替修改与读取,每次读取都与不使用缓存的计算结果一致
+	std::mt19937 rng(3);
+	std::uniform_int_distribution<int> operation(0, 7);
+	std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+
+	BasicTransform transform;
+	BasicTransform copy;
+	for (int i = 0; i < 2000; ++i)
+	{
+		switch (operation(rng))
+		{
+		case 0: transform.SetScale(value(rng) + 3.0f, value(rng) + 3.0f, value(rng) + 3.0f); break;
+		case 1: transform.SetRotation(value(rng), value(rng), value(rng)); break;
+		case 2: transform.SetPosition(value(rng), value(rng), value(rng)); break;
+		case 3: transform.Rotate(XMVectorSet(value(rng), value(rng), value(rng), 0.0f)); break;
+		case 4: transform.RotateAxis(XMVector3Normalize(XMVectorSet(value(rng), value(rng), value(rng) + 5.0f, 0.0f)), value(rng)); break;
+		case 5: transform.Translate(transform.GetForwardAxisVector(), value(rng)); break;
+		case 6: copy = transform; break;
+		default: break;
+		}
+
+		const XMMATRIX rotation = XMMatrixRotationQuaternion(transform.GetRotationQuaternion());
+		CHECK(SameMatrix(transform.GetRotationMatrix(), rotation));
+		CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), ReferenceWorld(transform)));
+		CHECK(SameVector(transform.GetRightAxisVector(), rotation.r[0]));
+		CHECK(SameVector(transform.GetUpAxisVector(), rotation.r[1]));
+		CHECK(SameVector(transform.GetForwardAxisVector(), rotation.r[2]));
+		// 复制时缓存一起复制
+		CHECK(SameMatrix(copy.GetLocalToWorldMatrix(), ReferenceWorld(copy)));
+	}
+}
+
+TEST_CASE(EulerAnglesRoundTripThroughQuaternion)
+{
+	std::mt19937 rng(4);
+	for (int i = 0; i < 1000; ++i)
+	{
+		const XMFLOAT3 angles = RandomEulerAngles(rng);
+		const XMMATRIX expected = XMMatrixRotationRollPitchYaw(angles.x, angles.y, angles.z);
+
+		// 以欧拉角设置: 旋转矩阵与XMMatrixRotationRollPitchYaw一致,欧拉角原样保存
+		BasicTransform transform;
+		transform.SetRotation(angles);
+		CHECK(SameMatrix(transform.GetRotationMatrix(), expected));
+		CHECK_EQ(transform.GetRotationFloat3().x, angles.x);
+		CHECK_EQ(transform.GetRotationFloat3().z, angles.z);
+
+		// 以四元数设置: 反求的欧拉角还原出同一个旋转,且在非奇异区域与原来的角度相同
+		BasicTransform fromQuaternion;
+		fromQuaternion.SetRotationQuaternion(XMQuaternionRotationRollPitchYaw(angles.x, angles.y, angles.z));
+		CHECK(SameMatrix(fromQuaternion.GetRotationMatrix(), expected));
+		const XMFLOAT3 derived = fromQuaternion.GetRotationFloat3();
+		CHECK(SameMatrix(XMMatrixRotationRollPitchYaw(derived.x, derived.y, derived.z), expected));
+		CHECK_NEAR(derived.x, angles.x, 1e-3f);
+		CHECK_NEAR(derived.y, angles.y, 1e-3f);
+		CHECK_NEAR(derived.z, angles.z, 1e-3f);
+
+		// 四元数 -> 欧拉角 -> 四元数表示同一个旋转(q与-q等价)
+		const float dot = XMVectorGetX(XMQuaternionDot(XMQuaternionRotationRollPitchYaw(derived.x, derived.y, derived.z),
+			fromQuaternion.GetRotationQuaternion()));
+		CHECK_NEAR(std::fabs(dot), 1.0f, 1e-4f);
+	}
+}
+
+TEST_CASE(RotateKeepsAdditiveEulerSemantics)
+{
+	// 摄像机与坦克的轮子依赖Rotate直接累加欧拉角
+	BasicTransform transform;
+	transform.SetRotation(0.1f, 0.2f, 0.3f);
+	transform.Rotate(XMVectorSet(0.4f, 0.5f, 0.6f, 0.0f));
+	CHECK_NEAR(transform.GetRotationFloat3().x, 0.5f, 1e-6f);
+	CHECK_NEAR(transform.GetRotationFloat3().y, 0.7f, 1e-6f);
+	CHECK_NEAR(transform.GetRotationFloat3().z, 0.9f, 1e-6f);
+	CHECK(SameMatrix(transform.GetRotationMatrix(), XMMatrixRotationRollPitchYaw(0.5f, 0.7f, 0.9f)));
+
+	// 超过±π的累加也不会被规范化
+	for (int i = 0; i < 20; ++i)
+		transform.Rotate(XMVectorSet(0.0f, 0.5f, 0.0f, 0.0f));
+	CHECK_NEAR(transform.GetRotationFloat3().y, 10.7f, 1e-4f);
+}
+
+TEST_CASE(QuaternionOperationsMatchEulerImplementation)
+{
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> radian(-XM_PI, XM_PI);
+	for (int i = 0; i < 1000; ++i)
+	{
+		const XMFLOAT3 angles = RandomEulerAngles(rng);
+		const XMVECTOR axis = RandomAxis(rng);
+		const float r = radian(rng);
+
+		// RotateAxis: 先进行当前的旋转,再绕轴旋转
+		BasicTransform transform;
+		transform.SetRotation(angles);
+		transform.RotateAxis(axis, r);
+		const XMMATRIX expected = XMMatrixRotationRollPitchYaw(angles.x, angles.y, angles.z) * XMMatrixRotationAxis(axis, r);
+		CHECK(SameMatrix(transform.GetRotationMatrix(), expected));
+
+		// 原来的实现反求欧拉角后得到同一个旋转(非奇异区域)
+		const XMFLOAT3 euler = EulerTransform::RotateAxis(XMLoadFloat3(&angles), axis, r);
+		if (std::fabs(std::fabs(euler.x) - XM_PIDIV2) > 0.05f)
+			CHECK(SameMatrix(transform.GetRotationMatrix(), XMMatrixRotationRollPitchYaw(euler.x, euler.y, euler.z)));
+
+		// RotateAround: 位置绕点旋转,朝向与RotateAxis相同
+		const XMVECTOR point = XMVectorSet(radian(rng), radian(rng), radian(rng), 1.0f);
+		BasicTransform around;
+		around.SetRotation(angles);
+		around.SetPosition(1.0f, 2.0f, 3.0f);
+		around.RotateAround(point, axis, r);
+		CHECK(SameMatrix(around.GetRotationMatrix(), expected));
+		const XMVECTOR expectedPosition = XMVector3Transform(XMVectorSet(1.0f, 2.0f, 3.0f, 1.0f) - point, XMMatrixRotationAxis(axis, r)) + point;
+		CHECK(SameVector(around.GetPositionVector(), expectedPosition));
+	}
+}
+
+TEST_CASE(LookAtMatchesInverseViewMatrix)
+{
+	std::mt19937 rng(6);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	for (int i = 0; i < 500; ++i)
+	{
+		const XMVECTOR eye = XMVectorSet(position(rng), position(rng), position(rng), 1.0f);
+		const XMVECTOR target = XMVectorSet(position(rng), position(rng), position(rng), 1.0f);
+
+		BasicTransform transform;
+		transform.SetPosition(eye);
+		transform.LookAt(target);
+
+		// 世界矩阵即观察矩阵的逆,前向轴指向目标
+		CHECK(SameMatrix(transform.GetLocalToWorldMatrix(), XMMatrixInverse(nullptr, XMMatrixLookAtLH(eye, target, g_XMIdentityR1))));
+		CHECK(SameVector(transform.GetForwardAxisVector(), XMVector3Normalize(target - eye)));
+		// 右轴保持水平
+		CHECK_NEAR(XMVectorGetY(transform.GetRightAxisVector()), 0.0f, Epsilon);
+
+		BasicTransform lookTo;
+		lookTo.SetPosition(eye);
+		lookTo.LookTo(target - eye);
+		CHECK(SameMatrix(lookTo.GetRotationMatrix(), transform.GetRotationMatrix()));
+	}
+}
+
+TEST_CASE(RepeatedRotateAxisStaysOrthonormal)
+{
+	// 原来的实现在俯仰角接近±π/2时反求欧拉角会丢失一个自由度,四元数不受影响
+	BasicTransform transform;
+	transform.SetRotation(XM_PIDIV2 - 1e-3f, 0.0f, 0.0f);
+	const XMVECTOR axis = XMVector3Normalize(XMVectorSet(0.3f, 1.0f, 0.2f, 0.0f));
+	for (int i = 0; i < 10000; ++i)
+		transform.RotateAxis(axis, 0.01f);
+
+	const XMMATRIX expected = XMMatrixRotationRollPitchYaw(XM_PIDIV2 - 1e-3f, 0.0f, 0.0f) * XMMatrixRotationAxis(axis, 100.0f);
+	const XMMATRIX rotation = transform.GetRotationMatrix();
+	CHECK(SameMatrix(rotation, expected));
+	CHECK_NEAR(XMVectorGetX(XMVector3Length(rotation.r[0])), 1.0f, Epsilon);
+	CHECK_NEAR(XMVectorGetX(XMVector3Dot(rotation.r[0], rotation.r[1])), 0.0f, Epsilon);
+}
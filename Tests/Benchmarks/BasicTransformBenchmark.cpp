@@ -0,0 +1,107 @@
+#include "BenchmarkHarness.h"
+#include "BasicTransform.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// 不使用缓存: 每次获取坐标轴或世界矩阵都重新由四元数构造旋转矩阵
+	XMMATRIX UncachedWorld(const BasicTransform& transform)
+	{
+		return XMMatrixScalingFromVector(transform.GetScaleVector()) *
+			XMMatrixRotationQuaternion(transform.GetRotationQuaternion()) *
+			XMMatrixTranslationFromVector(transform.GetPositionVector());
+	}
+
+	// 原来以欧拉角保存旋转时的RotateAxis与LookAt: 经过矩阵并反求欧拉角
+	class EulerTransform : public BasicTransform
+	{
+	public:
+		static XMFLOAT3 XM_CALLCONV RotateAxis(const XMFLOAT3& eulerAngles, FXMVECTOR axis, const float radian)
+		{
+			XMFLOAT4X4 rotation;
+			XMStoreFloat4x4(&rotation, XMMatrixRotationRollPitchYawFromVector(XMLoadFloat3(&eulerAngles)) * XMMatrixRotationAxis(axis, radian));
+			return GetEulerAnglesFromRotationTranslationFloat4X4(rotation);
+		}
+
+		static XMFLOAT3 XM_CALLCONV LookAt(FXMVECTOR position, FXMVECTOR target)
+		{
+			XMFLOAT4X4 rotation;
+			XMStoreFloat4x4(&rotation, XMMatrixInverse(nullptr, XMMatrixLookAtLH(position, target, g_XMIdentityR1)));
+			return GetEulerAnglesFromRotationTranslationFloat4X4(rotation);
+		}
+	};
+}
+
+// 摄像机与坦克每帧的典型访问: 平移后读取三个坐标轴与世界矩阵,以及旋转不变时的多次读取
+// 以及Rotate/RotateAxis/LookAt的吞吐量,与原来经过欧拉角的实现比较
+int main()
+{
+	const int count = 10000;
+	BasicTransform transform;
+	transform.SetRotation(0.3f, 0.7f, 0.1f);
+
+	XMVECTOR sum = g_XMZero;
+	BenchmarkHarness::Measure("translate + 3 axes + world, uncached", 5, count, [&]()
+		{
+			transform.Translate(g_XMIdentityR2, 0.01f);
+			const XMMATRIX rotation = XMMatrixRotationQuaternion(transform.GetRotationQuaternion());
+			sum += rotation.r[0];
+			sum += XMMatrixRotationQuaternion(transform.GetRotationQuaternion()).r[1];
+			sum += XMMatrixRotationQuaternion(transform.GetRotationQuaternion()).r[2];
+			sum += UncachedWorld(transform).r[3];
+		});
+	BenchmarkHarness::Measure("translate + 3 axes + world, cached", 5, count, [&]()
+		{
+			transform.Translate(g_XMIdentityR2, 0.01f);
+			sum += transform.GetRightAxisVector();
+			sum += transform.GetUpAxisVector();
+			sum += transform.GetForwardAxisVector();
+			sum += transform.GetLocalToWorldMatrix().r[3];
+		});
+
+	BenchmarkHarness::Measure("4 world reads, uncached", 5, count, [&]()
+		{
+			for (int i = 0; i < 4; ++i)
+				sum += UncachedWorld(transform).r[i];
+		});
+	BenchmarkHarness::Measure("4 world reads, cached", 5, count, [&]()
+		{
+			for (int i = 0; i < 4; ++i)
+				sum += transform.GetLocalToWorldMatrix().r[i];
+		});
+
+	const XMVECTOR axis = XMVector3Normalize(XMVectorSet(0.3f, 1.0f, 0.2f, 0.0f));
+	BenchmarkHarness::Measure("Rotate + world", 5, count, [&]()
+		{
+			transform.Rotate(XMVectorSet(0.0f, 0.001f, 0.0f, 0.0f));
+			sum += transform.GetLocalToWorldMatrix().r[2];
+		});
+
+	XMFLOAT3 eulerAngles = transform.GetRotationFloat3();
+	BenchmarkHarness::Measure("RotateAxis + world, euler round-trip", 5, count, [&]()
+		{
+			eulerAngles = EulerTransform::RotateAxis(eulerAngles, axis, 0.001f);
+			sum += XMMatrixRotationRollPitchYawFromVector(XMLoadFloat3(&eulerAngles)).r[2];
+		});
+	BenchmarkHarness::Measure("RotateAxis + world, quaternion", 5, count, [&]()
+		{
+			transform.RotateAxis(axis, 0.001f);
+			sum += transform.GetLocalToWorldMatrix().r[2];
+		});
+
+	const XMVECTOR target = XMVectorSet(10.0f, 2.0f, 30.0f, 1.0f);
+	BenchmarkHarness::Measure("LookAt + world, euler round-trip", 5, count, [&]()
+		{
+			eulerAngles = EulerTransform::LookAt(transform.GetPositionVector(), target);
+			sum += XMMatrixRotationRollPitchYawFromVector(XMLoadFloat3(&eulerAngles)).r[2];
+		});
+	BenchmarkHarness::Measure("LookAt + world, quaternion", 5, count, [&]()
+		{
+			transform.LookAt(target);
+			sum += transform.GetLocalToWorldMatrix().r[2];
+		});
+
+	BenchmarkHarness::DoNotOptimize(XMVectorGetX(sum));
+	return 0;
+}
@@ -0,0 +1,50 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 极简基准测试工具
+// 先预热一次,再重复执行若干轮取最快的一轮,输出每次操作的平均耗时
+// Minimal timing helper for the module benchmarks.
+//***************************************************************************************
+
+#ifndef BENCHMARKHARNESS_H
+#define BENCHMARKHARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace BenchmarkHarness
+{
+	// 防止编译器把结果未被使用的计算优化掉
+	inline volatile unsigned long long g_sink = 0;
+
+	template<typename T>
+	void DoNotOptimize(const T& value)
+	{
+		g_sink = g_sink + static_cast<unsigned long long>(value);
+	}
+
+	// 执行rounds轮,每轮调用function operations次,返回最快一轮中每次操作的纳秒数
+	template<typename Function>
+	double Measure(const char* name, const int rounds, const int operations, Function&& function)
+	{
+		function();
+
+		double best = 0.0;
+		for (int round = 0; round < rounds; ++round)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < operations; ++i)
+				function();
+			const auto end = std::chrono::steady_clock::now();
+
+			const double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / operations;
+			best = round == 0 ? nanoseconds : (std::min)(best, nanoseconds);
+		}
+
+		std::printf("%-48s %14.1f ns/op\n", name, best);
+		return best;
+	}
+}
+
+#endif
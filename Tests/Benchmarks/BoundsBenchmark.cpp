@@ -0,0 +1,156 @@
+#include "BenchmarkHarness.h"
+#include "BoundsInterop.h"
+
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+#if defined(BOUNDS_BACKEND_FMA)
+static const char* const BackendName = "fma";
+#elif defined(BOUNDS_BACKEND_SSE2)
+static const char* const BackendName = "sse2";
+#elif defined(BOUNDS_BACKEND_NEON)
+static const char* const BackendName = "neon";
+#else
+static const char* const BackendName = "scalar";
+#endif
+
+// 同一份基准测试以不同的编译选项为每个SIMD后端各构建一次(与BoundsTests相同),
+// 比较各后端的变换、合并与视锥体测试,DirectXCollision的结果作为参照
+int main()
+{
+	constexpr size_t Count = 4096;
+
+	std::mt19937 rng(36);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> extent(0.1f, 8.0f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+	std::vector<BoundingBox> boxes(Count);
+	std::vector<Bounds::Aabb> aabbs(Count);
+	std::vector<Bounds::Sphere> spheres(Count);
+	std::vector<Bounds::Matrix4x4> worlds(Count);
+	for (size_t i = 0; i < Count; ++i)
+	{
+		boxes[i] = BoundingBox(XMFLOAT3(position(rng), position(rng), position(rng)), XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+		aabbs[i] = Bounds::ToAabb(boxes[i]);
+		spheres[i] = Bounds::SphereFromAabb(aabbs[i]);
+		worlds[i] = Bounds::ToMatrix4x4(XMMatrixRotationRollPitchYaw(angle(rng), angle(rng), angle(rng)) *
+			XMMatrixTranslation(position(rng), position(rng), position(rng)));
+	}
+
+	const XMMATRIX world = XMMatrixScaling(1.5f, 0.5f, 2.0f) * XMMatrixRotationRollPitchYaw(0.3f, 1.1f, -0.4f) * XMMatrixTranslation(3.0f, -2.0f, 8.0f);
+	const Bounds::Matrix4x4 matrix = Bounds::ToMatrix4x4(world);
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 20.0f, -120.0f, 1.0f), XMVectorZero(), g_XMIdentityR1);
+	const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 1.0f, 200.0f);
+	const Bounds::Frustum frustum = Bounds::FrustumFromMatrix(Bounds::ToMatrix4x4(view * proj));
+
+	std::vector<BoundingBox> transformedBoxes(Count);
+	std::vector<Bounds::Aabb> transformed(Count);
+	std::vector<Bounds::Sphere> transformedSpheres(Count);
+	std::vector<uint8_t> visible(Count);
+
+	std::printf("Bounds backend: %s, %zu boxes\n", BackendName, Count);
+	char name[64];
+
+	//
+	// 变换
+	//
+
+	std::snprintf(name, sizeof(name), "[%s] transform, BoundingBox::Transform", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			for (size_t i = 0; i < Count; ++i)
+				boxes[i].Transform(transformedBoxes[i], world);
+			BenchmarkHarness::DoNotOptimize(transformedBoxes[Count - 1].Center.x > 0.0f);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] transform, Transform per box", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			for (size_t i = 0; i < Count; ++i)
+				transformed[i] = Bounds::Transform(aabbs[i], matrix);
+			BenchmarkHarness::DoNotOptimize(transformed[Count - 1].center.x > 0.0f);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] transform, TransformAabbs", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			Bounds::TransformAabbs(aabbs.data(), aabbs.size(), matrix, transformed.data());
+			BenchmarkHarness::DoNotOptimize(transformed[Count - 1].center.x > 0.0f);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] transform, TransformAabbs instanced", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			Bounds::TransformAabbs(aabbs[0], worlds.data(), worlds.size(), transformed.data());
+			BenchmarkHarness::DoNotOptimize(transformed[Count - 1].center.x > 0.0f);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] transform, TransformSpheres", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			Bounds::TransformSpheres(spheres.data(), spheres.size(), matrix, transformedSpheres.data());
+			BenchmarkHarness::DoNotOptimize(transformedSpheres[Count - 1].center.x > 0.0f);
+		});
+
+	//
+	// 合并
+	//
+
+	std::snprintf(name, sizeof(name), "[%s] merge, BoundingBox::CreateMerged", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			BoundingBox merged = boxes[0];
+			for (size_t i = 1; i < Count; ++i)
+				BoundingBox::CreateMerged(merged, merged, boxes[i]);
+			BenchmarkHarness::DoNotOptimize(merged.Extents.x > 0.0f);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] merge, Merge pairwise", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			Bounds::Aabb merged = aabbs[0];
+			for (size_t i = 1; i < Count; ++i)
+				merged = Bounds::Merge(merged, aabbs[i]);
+			BenchmarkHarness::DoNotOptimize(merged.extents.x > 0.0f);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] merge, Merge array", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			const Bounds::Aabb merged = Bounds::Merge(aabbs.data(), aabbs.size());
+			BenchmarkHarness::DoNotOptimize(merged.extents.x > 0.0f);
+		});
+
+	//
+	// 视锥体测试
+	//
+
+	size_t visibleCount = 0;
+	std::snprintf(name, sizeof(name), "[%s] contains, Contains per box", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			visibleCount = 0;
+			for (size_t i = 0; i < Count; ++i)
+				visibleCount += Bounds::Contains(frustum, aabbs[i]) != Bounds::Containment::Disjoint;
+			BenchmarkHarness::DoNotOptimize(visibleCount);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] contains, CullAabbs", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			visibleCount = Bounds::CullAabbs(frustum, aabbs.data(), aabbs.size(), visible.data());
+			BenchmarkHarness::DoNotOptimize(visibleCount);
+		});
+
+	std::snprintf(name, sizeof(name), "[%s] contains, CullSpheres", BackendName);
+	BenchmarkHarness::Measure(name, 5, 50, [&]()
+		{
+			BenchmarkHarness::DoNotOptimize(Bounds::CullSpheres(frustum, spheres.data(), spheres.size(), visible.data()));
+		});
+	std::printf("%zu of %zu boxes inside the frustum\n", visibleCount, Count);
+
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include "BenchmarkHarness.h"
+#include "Broadphase.h"
+
+#include <random>
+
+using namespace DirectX;
+
+// 数千个每帧移动的物体(坦克大小的包围盒),比较暴力检测、扫描剪枝与空间哈希网格每帧的耗时
+int main()
+{
+	for (const UINT count : { 1000u, 4000u })
+	{
+		std::mt19937 rng(21);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> velocity(-0.2f, 0.2f);
+
+		std::vector<BoundingBox> boxes(count);
+		std::vector<XMFLOAT3> velocities(count);
+		for (UINT i = 0; i < count; ++i)
+		{
+			boxes[i] = BoundingBox(XMFLOAT3(position(rng), 0.0f, position(rng)), XMFLOAT3(1.2f, 0.8f, 1.8f));
+			velocities[i] = XMFLOAT3(velocity(rng), 0.0f, velocity(rng));
+		}
+		const auto step = [&]()
+		{
+			for (UINT i = 0; i < count; ++i)
+			{
+				boxes[i].Center.x += velocities[i].x;
+				boxes[i].Center.z += velocities[i].z;
+			}
+		};
+
+		std::vector<CollisionPair> pairs;
+		char name[64];
+
+		std::snprintf(name, sizeof(name), "%u objects, brute force", count);
+		BenchmarkHarness::Measure(name, 3, 10, [&]()
+			{
+				step();
+				pairs.clear();
+				for (UINT i = 0; i < count; ++i)
+					for (UINT j = i + 1; j < count; ++j)
+						if (boxes[i].Intersects(boxes[j]))
+							pairs.push_back({ i, j });
+				BenchmarkHarness::DoNotOptimize(pairs.size());
+			});
+
+		SweepAndPrune sap;
+		for (const BoundingBox& box : boxes)
+			sap.AddProxy(box);
+		std::snprintf(name, sizeof(name), "%u objects, sweep and prune", count);
+		BenchmarkHarness::Measure(name, 3, 100, [&]()
+			{
+				step();
+				for (UINT i = 0; i < count; ++i)
+					sap.UpdateProxy(i, boxes[i]);
+				sap.FindPairs(pairs);
+				BenchmarkHarness::DoNotOptimize(pairs.size());
+			});
+
+		SpatialHashGrid grid(4.0f, 4096);
+		std::snprintf(name, sizeof(name), "%u objects, spatial hash grid", count);
+		BenchmarkHarness::Measure(name, 3, 100, [&]()
+			{
+				step();
+				grid.Clear();
+				for (const BoundingBox& box : boxes)
+					grid.Insert(box);
+				grid.FindPairs(pairs);
+				BenchmarkHarness::DoNotOptimize(pairs.size());
+			});
+	}
+
+	return 0;
+}
@@ -0,0 +1,57 @@
+#include "BenchmarkHarness.h"
+#include "ClusteredLightCulling.h"
+
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+// 1000与4000个光源(一半点光源,一半聚光灯)分配到16x9x24个簇的耗时
+int main()
+{
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 10.0f, -120.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.5f, 400.0f);
+
+	for (const UINT lightCount : { 1000u, 4000u })
+	{
+		// 光源散布在摄像机前方的场景中,部分位于视锥体之外
+		std::mt19937 rng(62);
+		std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+		std::uniform_real_distribution<float> height(0.5f, 15.0f);
+		std::uniform_real_distribution<float> range(2.0f, 10.0f);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+		std::vector<PointLight> pointLights(lightCount / 2);
+		for (PointLight& light : pointLights)
+		{
+			light = PointLight();
+			light.position = XMFLOAT3(position(rng), height(rng), position(rng));
+			light.range = range(rng);
+		}
+		std::vector<SpotLight> spotLights(lightCount - lightCount / 2);
+		for (SpotLight& light : spotLights)
+		{
+			light = SpotLight();
+			light.position = XMFLOAT3(position(rng), height(rng), position(rng));
+			light.range = range(rng);
+			XMStoreFloat3(&light.direction, XMVector3Normalize(XMVectorSet(unit(rng), -1.0f, unit(rng), 0.0f)));
+		}
+
+		ClusteredLightCulling culling;
+		culling.SetProjection(proj);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "%u lights, cull", lightCount);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				culling.Cull(view, pointLights.data(), static_cast<UINT>(pointLights.size()), spotLights.data(), static_cast<UINT>(spotLights.size()));
+				BenchmarkHarness::DoNotOptimize(culling.GetStatistics().lightClusterPairs);
+			});
+
+		const ClusteredLightCulling::Statistics& statistics = culling.GetStatistics();
+		std::printf("%u lights: %u visible, %u light-cluster pairs, at most %u lights per cluster\n",
+			lightCount, statistics.visibleLights, statistics.lightClusterPairs, statistics.maxLightsPerCluster);
+	}
+
+	return 0;
+}
@@ -0,0 +1,69 @@
+#include "BenchmarkHarness.h"
+#include "PortableTypes.h"
+#include "CompactInstance.h"
+
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// 与GameObject::InstancedData相同的布局: 转置后的世界矩阵与逆转置矩阵
+	struct InstancedData
+	{
+		XMMATRIX world;
+		XMMATRIX worldInvTranspose;
+	};
+}
+
+// 比较每帧填充实例缓冲区的耗时: 4x4世界矩阵与逆转置(128字节),以及只有前三列的紧凑格式(48字节)
+int main()
+{
+	for (const UINT count : { 1000u, 20000u })
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+		std::vector<XMFLOAT4X4> worlds(count);
+		for (XMFLOAT4X4& world : worlds)
+		{
+			XMStoreFloat4x4(&world, XMMatrixScaling(scale(rng), scale(rng), scale(rng)) *
+				XMMatrixRotationRollPitchYaw(angle(rng), angle(rng), angle(rng)) *
+				XMMatrixTranslation(position(rng), position(rng), position(rng)));
+		}
+
+		std::vector<InstancedData> full(count);
+		std::vector<CompactInstancedData> compact(count);
+		char name[64];
+
+		std::snprintf(name, sizeof(name), "%u instances, 4x4 + inverse transpose", count);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				for (UINT i = 0; i < count; ++i)
+				{
+					const XMMATRIX world = XMLoadFloat4x4(&worlds[i]);
+					XMMATRIX local = world;
+					local.r[3] = g_XMIdentityR3;
+					full[i].world = XMMatrixTranspose(world);
+					// 与GameObject::CreateInstancedData相同: 逆转置矩阵再转置即为逆矩阵
+					full[i].worldInvTranspose = XMMatrixInverse(nullptr, local);
+				}
+				BenchmarkHarness::DoNotOptimize(XMVectorGetX(full.back().world.r[0]));
+			});
+
+		std::snprintf(name, sizeof(name), "%u instances, compact 3x4", count);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				for (UINT i = 0; i < count; ++i)
+					compact[i] = CreateCompactInstancedData(XMLoadFloat4x4(&worlds[i]));
+				BenchmarkHarness::DoNotOptimize(compact.back().worldColumns[0].x);
+			});
+
+		std::printf("%u instances: %zu bytes vs %zu bytes\n", count, count * sizeof(InstancedData), count * sizeof(CompactInstancedData));
+	}
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include "BenchmarkHarness.h"
+#include "ConstantBufferAllocator.h"
+
+#include <cstring>
+#include <vector>
+
+// 每帧10k次绘制,每次绘制写入一个192字节的物体常量缓冲区(世界矩阵、逆转置矩阵与材质),
+// 比较两种写入方式经过渲染后端Map/Unmap的耗时与丢弃次数:
+//	每个常量缓冲区单独一个动态缓冲区,每次绘制以WriteDiscard映射
+//	常量缓冲区池,每次绘制以WriteNoOverwrite追加,只在每帧开始与回绕时以WriteDiscard映射
+// RecordingRenderBackend返回的内存与映射后的D3D缓冲区一样只是一次memcpy,
+// 驱动为WriteDiscard重命名缓冲区的开销需要在真实设备上度量,这里以丢弃次数表示
+namespace
+{
+	constexpr UINT DrawCount = 10000;
+	constexpr UINT ObjectByteWidth = 192;
+
+	UINT CountDiscards(const RecordingRenderBackend& backend)
+	{
+		UINT discards = 0;
+		for (const RecordingRenderBackend::Command& command : backend.GetCommands())
+		{
+			if (command.type == RecordingRenderBackend::CommandType::Map && command.args[1] == static_cast<UINT>(RenderMapType::WriteDiscard))
+				++discards;
+		}
+		return discards;
+	}
+
+	void PrintStatistics(const RecordingRenderBackend& backend)
+	{
+		const RecordingRenderBackend::Statistics& statistics = backend.GetStatistics();
+		std::printf("  %u maps, %u discards, %.1f KB per frame\n", statistics.maps, CountDiscards(backend),
+			statistics.bytesUploaded / 1024.0);
+	}
+}
+
+int main()
+{
+	std::vector<BYTE> objectData(static_cast<size_t>(DrawCount) * ObjectByteWidth);
+	for (size_t i = 0; i < objectData.size(); ++i)
+		objectData[i] = static_cast<BYTE>(i);
+
+	// 句柄只被编号,不解引用
+	char handle;
+	RenderBuffer* buffer = reinterpret_cast<RenderBuffer*>(&handle);
+	RecordingRenderBackend backend;
+
+	BenchmarkHarness::Measure("10k draws, WriteDiscard per draw (per frame)", 5, 20, [&]()
+		{
+			backend.Clear();
+			for (UINT i = 0; i < DrawCount; ++i)
+			{
+				void* pData = backend.Map(buffer, RenderMapType::WriteDiscard, 0, ObjectByteWidth);
+				std::memcpy(pData, objectData.data() + static_cast<size_t>(i) * ObjectByteWidth, ObjectByteWidth);
+				backend.Unmap(buffer);
+			}
+			BenchmarkHarness::DoNotOptimize(backend.GetStatistics().bytesUploaded);
+		});
+	PrintStatistics(backend);
+
+	// 64KB的池每帧回绕多次,1MB的池(ConstantBufferArena的默认大小)在一帧内回绕两次
+	for (const UINT arenaByteWidth : { 64u * 1024u, 1024u * 1024u })
+	{
+		ConstantBufferAllocator allocator(arenaByteWidth);
+		char name[64];
+		std::snprintf(name, sizeof(name), "10k draws, %u KB arena (per frame)", arenaByteWidth / 1024);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				backend.Clear();
+				allocator.Reset();
+				for (UINT i = 0; i < DrawCount; ++i)
+				{
+					ConstantBufferAllocator::Allocation allocation;
+					allocator.Allocate(ObjectByteWidth, &allocation);
+					void* pData = backend.Map(buffer, allocation.mapType, allocation.firstConstant * ConstantBufferAllocator::ConstantByteWidth, ObjectByteWidth);
+					std::memcpy(pData, objectData.data() + static_cast<size_t>(i) * ObjectByteWidth, ObjectByteWidth);
+					backend.Unmap(buffer);
+				}
+				BenchmarkHarness::DoNotOptimize(backend.GetStatistics().bytesUploaded);
+			});
+		PrintStatistics(backend);
+	}
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include "BenchmarkHarness.h"
+#include "ContinuousCollision.h"
+
+#include <random>
+
+using namespace DirectX;
+
+// 静态场景中每帧数千次扫掠查询的吞吐量:
+// 炮弹(扫掠球)批量查询、坦克(扫掠AABB)与转向中的坦克(旋转OBB的保守推进)
+int main()
+{
+	std::mt19937 rng(71);
+	std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> extent(0.5f, 4.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> speed(5.0f, 40.0f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+	// 地面上的建筑、墙与道具
+	std::vector<BoundingBox> boxes(2000);
+	for (BoundingBox& box : boxes)
+	{
+		const XMFLOAT3 extents(extent(rng), extent(rng), extent(rng));
+		box = BoundingBox(XMFLOAT3(position(rng), extents.y, position(rng)), extents);
+	}
+
+	ContinuousCollision ccd;
+	ccd.Build(boxes);
+	std::printf("%zu static boxes, BVH depth %u\n", boxes.size(), ccd.GetHierarchy().GetDepth());
+
+	for (const UINT count : { 1000u, 4000u })
+	{
+		// 炮弹: 一帧内飞行数米到数十米
+		std::vector<SweptSphere> spheres(count);
+		for (SweptSphere& sphere : spheres)
+		{
+			sphere.start = XMFLOAT3(position(rng), 0.5f + 5.0f * (unit(rng) + 1.0f), position(rng));
+			sphere.radius = 0.2f;
+			const XMVECTOR direction = XMVector3Normalize(XMVectorSet(unit(rng), 0.1f * unit(rng), unit(rng), 0.0f));
+			XMStoreFloat3(&sphere.end, XMLoadFloat3(&sphere.start) + direction * speed(rng));
+		}
+		std::vector<SweepHit> hits(count);
+
+		char name[64];
+		UINT hitCount = 0;
+		std::snprintf(name, sizeof(name), "%u swept spheres, SweepSpheres", count);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				hitCount = ccd.SweepSpheres(spheres.data(), count, hits.data());
+				BenchmarkHarness::DoNotOptimize(hitCount);
+			});
+		std::printf("%u of %u swept spheres hit\n", hitCount, count);
+
+		// 暴力测试只用于比较,只运行一轮
+		if (count == 1000)
+		{
+			BenchmarkHarness::Measure("1000 swept spheres, brute force", 1, 1, [&]()
+				{
+					UINT bruteForceHits = 0;
+					for (const SweptSphere& sphere : spheres)
+					{
+						const XMVECTOR start = XMLoadFloat3(&sphere.start);
+						const XMVECTOR displacement = XMLoadFloat3(&sphere.end) - start;
+						float closest = 1.0f;
+						bool isHit = false;
+						for (const BoundingBox& box : boxes)
+						{
+							float toi;
+							if (ContinuousCollision::SweepSphereBox(start, displacement, sphere.radius, box, &toi, nullptr, closest))
+							{
+								closest = toi;
+								isHit = true;
+							}
+						}
+						bruteForceHits += isHit ? 1 : 0;
+					}
+					BenchmarkHarness::DoNotOptimize(bruteForceHits);
+				});
+		}
+
+		// 坦克: 一帧内移动不到1米,大部分查询没有碰撞
+		std::vector<BoundingBox> tanks(count);
+		std::vector<XMFLOAT3> displacements(count);
+		for (UINT i = 0; i < count; ++i)
+		{
+			tanks[i] = BoundingBox(XMFLOAT3(position(rng), 0.8f, position(rng)), XMFLOAT3(1.2f, 0.8f, 1.8f));
+			displacements[i] = XMFLOAT3(unit(rng), 0.0f, unit(rng));
+		}
+		std::snprintf(name, sizeof(name), "%u swept boxes, SweepBox", count);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				UINT boxHits = 0;
+				SweepHit hit;
+				for (UINT i = 0; i < count; ++i)
+					boxHits += ccd.SweepBox(tanks[i], XMLoadFloat3(&displacements[i]), &hit) ? 1 : 0;
+				BenchmarkHarness::DoNotOptimize(boxHits);
+			});
+
+		// 转向中的坦克: 一帧内旋转最多约30度
+		std::vector<BoundingOrientedBox> starts(count), ends(count);
+		for (UINT i = 0; i < count; ++i)
+		{
+			const float yaw = angle(rng);
+			starts[i] = BoundingOrientedBox(tanks[i].Center, tanks[i].Extents, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+			XMStoreFloat4(&starts[i].Orientation, XMQuaternionRotationRollPitchYaw(0.0f, yaw, 0.0f));
+			ends[i] = starts[i];
+			XMStoreFloat3(&ends[i].Center, XMLoadFloat3(&tanks[i].Center) + XMLoadFloat3(&displacements[i]));
+			XMStoreFloat4(&ends[i].Orientation, XMQuaternionRotationRollPitchYaw(0.0f, yaw + 0.5f * unit(rng), 0.0f));
+		}
+		std::snprintf(name, sizeof(name), "%u rotating boxes, SweepOrientedBox", count);
+		BenchmarkHarness::Measure(name, 5, 5, [&]()
+			{
+				UINT orientedHits = 0;
+				SweepHit hit;
+				for (UINT i = 0; i < count; ++i)
+					orientedHits += ccd.SweepOrientedBox(starts[i], ends[i], &hit) ? 1 : 0;
+				BenchmarkHarness::DoNotOptimize(orientedHits);
+			});
+	}
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+#include "BenchmarkHarness.h"
+#include "DebugLineBatch.h"
+
+#include <random>
+
+using namespace DirectX;
+
+// 100k个包围盒的调试线框: 追加到合批数组的耗时,以及通过渲染后端上传的耗时
+// 上传写入RecordingRenderBackend返回的内存,与写入映射后的D3D缓冲区相同,只是一次memcpy
+int main()
+{
+	std::mt19937 rng(51);
+	std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> extent(0.5f, 3.0f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+	const UINT count = 100000;
+	std::vector<BoundingBox> boxes(count);
+	std::vector<BoundingOrientedBox> orientedBoxes(count);
+	for (UINT i = 0; i < count; ++i)
+	{
+		boxes[i] = BoundingBox(XMFLOAT3(position(rng), position(rng), position(rng)), XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+		orientedBoxes[i] = BoundingOrientedBox(boxes[i].Center, boxes[i].Extents, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+		XMStoreFloat4(&orientedBoxes[i].Orientation, XMQuaternionRotationRollPitchYaw(angle(rng), angle(rng), angle(rng)));
+	}
+	const XMFLOAT4 color(0.0f, 1.0f, 0.0f, 1.0f);
+
+	// 预先保留的容量足够时每帧不再分配内存
+	DebugLineBatch batch(count * 8, count * 24);
+
+	BenchmarkHarness::Measure("100k boxes, build batch", 5, 10, [&]()
+		{
+			batch.Clear();
+			for (const BoundingBox& box : boxes)
+				batch.AddBox(box, color);
+			BenchmarkHarness::DoNotOptimize(batch.GetIndexCount());
+		});
+	BenchmarkHarness::Measure("100k oriented boxes, build batch", 5, 10, [&]()
+		{
+			batch.Clear();
+			for (const BoundingOrientedBox& box : orientedBoxes)
+				batch.AddOrientedBox(box, color);
+			BenchmarkHarness::DoNotOptimize(batch.GetIndexCount());
+		});
+
+	// 句柄只被编号,不解引用
+	char handles[3];
+	RenderBuffer* vertexBuffer = reinterpret_cast<RenderBuffer*>(handles);
+	RenderBuffer* indexBuffer = reinterpret_cast<RenderBuffer*>(handles + 1);
+	RenderEffect* effect = reinterpret_cast<RenderEffect*>(handles + 2);
+
+	RecordingRenderBackend backend;
+	std::printf("%u vertices, %u indices, %.1f MB per upload\n", batch.GetVertexCount(), batch.GetIndexCount(),
+		(batch.GetVertexCount() * sizeof(DebugLineBatch::Vertex) + batch.GetIndexCount() * sizeof(UINT)) / (1024.0 * 1024.0));
+	BenchmarkHarness::Measure("100k boxes, upload", 5, 10, [&]()
+		{
+			backend.Clear();
+			batch.Upload(backend, vertexBuffer, indexBuffer);
+			BenchmarkHarness::DoNotOptimize(backend.GetStatistics().bytesUploaded);
+		});
+	BenchmarkHarness::Measure("100k boxes, build + draw", 5, 10, [&]()
+		{
+			backend.Clear();
+			batch.Clear();
+			for (const BoundingBox& box : boxes)
+				batch.AddBox(box, color);
+			batch.Draw(backend, vertexBuffer, indexBuffer, effect);
+			BenchmarkHarness::DoNotOptimize(backend.GetStatistics().drawCalls);
+		});
+
+	return 0;
+}
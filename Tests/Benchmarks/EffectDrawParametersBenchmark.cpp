@@ -0,0 +1,173 @@
+#include "BenchmarkHarness.h"
+#include "EffectDrawParameters.h"
+#include "PortableTypes.h"
+
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	class TransformSetter
+	{
+	public:
+		virtual ~TransformSetter() = default;
+		virtual void XM_CALLCONV SetWorldMatrix(FXMMATRIX world) const = 0;
+	};
+
+	class TextureDiffuseSetter
+	{
+	public:
+		virtual ~TextureDiffuseSetter() = default;
+		virtual void SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const = 0;
+	};
+
+	// 与BasicEffect相同的继承结构,设置函数只写入成员
+	class FullEffect final : public IEffectDrawParameters, public TransformSetter, public TextureDiffuseSetter
+	{
+	public:
+		void XM_CALLCONV SetWorldMatrix(FXMMATRIX world) const override { XMStoreFloat4x4(&m_world, world); }
+		void SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const override { m_textureDiffuse = textureDiffuse; }
+		void SetMaterial(const Material& material) const { m_material = material; }
+		void SetTextureNormalMap(ID3D11ShaderResourceView* textureNormalMap) const { m_textureNormalMap = textureNormalMap; }
+
+		void XM_CALLCONV SetDrawParameters(const EffectDrawParameters& parameters, FXMMATRIX world) const override
+		{
+			SetWorldMatrix(world);
+			SetMaterial(*parameters.material);
+			SetTextureDiffuse(parameters.textureDiffuse);
+			SetTextureNormalMap(parameters.textureNormalMap);
+		}
+
+		mutable XMFLOAT4X4 m_world{};
+		mutable Material m_material{};
+		mutable ID3D11ShaderResourceView* m_textureDiffuse = nullptr;
+		mutable ID3D11ShaderResourceView* m_textureNormalMap = nullptr;
+	};
+
+	// 与ShadowEffect相同的继承结构
+	class ShadowLikeEffect final : public IEffectDrawParameters, public TransformSetter, public TextureDiffuseSetter
+	{
+	public:
+		void XM_CALLCONV SetWorldMatrix(FXMMATRIX world) const override { XMStoreFloat4x4(&m_world, world); }
+		void SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const override { m_textureDiffuse = textureDiffuse; }
+
+		void XM_CALLCONV SetDrawParameters(const EffectDrawParameters& parameters, FXMMATRIX world) const override
+		{
+			SetWorldMatrix(world);
+			SetTextureDiffuse(parameters.textureDiffuse);
+		}
+
+		mutable XMFLOAT4X4 m_world{};
+		mutable ID3D11ShaderResourceView* m_textureDiffuse = nullptr;
+	};
+
+	// 只统计调用次数的设备上下文,代替每个模型部分的缓冲区绑定、Apply与DrawIndexed
+	class MockContext
+	{
+	public:
+		virtual ~MockContext() = default;
+		virtual void SetBuffers(const UINT partIndex) { m_bindCount += partIndex & 1; }
+		virtual void Apply(const IEffectDrawParameters*) { ++m_applyCount; }
+		virtual void DrawIndexed(const UINT indexCount) { m_indexCount += indexCount; }
+
+		UINT m_bindCount = 0;
+		UINT m_applyCount = 0;
+		UINT64 m_indexCount = 0;
+	};
+
+	struct Part
+	{
+		Material material;
+		ID3D11ShaderResourceView* textureDiffuse;
+		ID3D11ShaderResourceView* textureNormalMap;
+		UINT indexCount;
+	};
+
+	// 原先GameObject::DrawParts的分派方式
+	void XM_CALLCONV DrawByCast(MockContext& context, IEffectDrawParameters* effect, const std::vector<Part>& parts, FXMMATRIX world)
+	{
+		for (UINT i = 0; i < static_cast<UINT>(parts.size()); ++i)
+		{
+			const Part& part = parts[i];
+			context.SetBuffers(i);
+
+			if (const auto* pFullEffect = dynamic_cast<FullEffect*>(effect))
+			{
+				pFullEffect->SetTextureNormalMap(part.textureNormalMap);
+				pFullEffect->SetMaterial(part.material);
+				pFullEffect->SetWorldMatrix(world);
+				pFullEffect->SetTextureDiffuse(part.textureDiffuse);
+			}
+			else
+			{
+				if (const auto* pTransform = dynamic_cast<TransformSetter*>(effect))
+					pTransform->SetWorldMatrix(world);
+				if (const auto* pTextureDiffuse = dynamic_cast<TextureDiffuseSetter*>(effect))
+					pTextureDiffuse->SetTextureDiffuse(part.textureDiffuse);
+			}
+
+			context.Apply(effect);
+			context.DrawIndexed(part.indexCount);
+		}
+	}
+
+	// 现在的分派方式: 填写参数块,一次虚函数调用
+	void XM_CALLCONV DrawByParameters(MockContext& context, IEffectDrawParameters* effect, const std::vector<Part>& parts, FXMMATRIX world)
+	{
+		for (UINT i = 0; i < static_cast<UINT>(parts.size()); ++i)
+		{
+			const Part& part = parts[i];
+			context.SetBuffers(i);
+			effect->SetDrawParameters({ &part.material, part.textureDiffuse, part.textureNormalMap }, world);
+			context.Apply(effect);
+			context.DrawIndexed(part.indexCount);
+		}
+	}
+}
+
+// 每帧提交10000个模型部分,比较按dynamic_cast分派与使用参数块的提交耗时
+int main()
+{
+	constexpr UINT PartCount = 10000;
+
+	static char s_textures[16];
+	std::mt19937 rng(44);
+	std::vector<Part> parts(PartCount);
+	for (Part& part : parts)
+	{
+		part.material = Material{};
+		part.textureDiffuse = reinterpret_cast<ID3D11ShaderResourceView*>(s_textures + rng() % 8);
+		part.textureNormalMap = reinterpret_cast<ID3D11ShaderResourceView*>(s_textures + 8 + rng() % 8);
+		part.indexCount = 36 + rng() % 64;
+	}
+
+	FullEffect fullEffect;
+	ShadowLikeEffect shadowEffect;
+	MockContext context;
+	const XMMATRIX world = XMMatrixTranslation(1.0f, 2.0f, 3.0f);
+
+	// 通过基类指针调用,与绘制路径只持有IEffect*时相同
+	IEffectDrawParameters* effects[] = { &fullEffect, &shadowEffect };
+	const char* names[][2] = {
+		{ "10000 parts, BasicEffect-like, dynamic_cast", "10000 parts, BasicEffect-like, parameter block" },
+		{ "10000 parts, ShadowEffect-like, dynamic_cast", "10000 parts, ShadowEffect-like, parameter block" }
+	};
+	for (int i = 0; i < 2; ++i)
+	{
+		IEffectDrawParameters* effect = effects[i];
+		BenchmarkHarness::Measure(names[i][0], 5, 20, [&]()
+			{
+				DrawByCast(context, effect, parts, world);
+				BenchmarkHarness::DoNotOptimize(context.m_applyCount);
+			});
+		BenchmarkHarness::Measure(names[i][1], 5, 20, [&]()
+			{
+				DrawByParameters(context, effect, parts, world);
+				BenchmarkHarness::DoNotOptimize(context.m_applyCount);
+			});
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+#include "BenchmarkHarness.h"
+#include "EffectVariableHandle.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+using namespace DirectX;
+
+static size_t g_allocationCount = 0;
+
+void* operator new(const size_t size)
+{
+	++g_allocationCount;
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace
+{
+	// 原先EffectPass::XXGetParamByName返回的变量: 每次查找都按名称哈希并分配一个新对象
+	struct ByNameVariable
+	{
+		ByNameVariable(BYTE* pData, BOOL* pIsDirty, const UINT byteWidth) : pData(pData), pIsDirty(pIsDirty), byteWidth(byteWidth) {}
+		virtual ~ByNameVariable() = default;
+
+		virtual void SetRaw(const void* data, const UINT byteCount)
+		{
+			const UINT count = byteCount < byteWidth ? byteCount : byteWidth;
+			if (std::memcmp(pData, data, count) != 0)
+			{
+				std::memcpy(pData, data, count);
+				*pIsDirty = true;
+			}
+		}
+
+		BYTE* pData;
+		BOOL* pIsDirty;
+		UINT byteWidth;
+	};
+
+	struct VariableDesc
+	{
+		UINT byteOffset;
+		UINT byteWidth;
+	};
+}
+
+// BasicEffect每次绘制写入的变量(世界矩阵、观察投影、逆转置、材质等),
+// 比较每次按名称查找并分配变量与初始化时解析一次句柄
+int main()
+{
+	constexpr UINT DrawCount = 1000;
+
+	static BYTE s_staging[512];
+	static BOOL s_isDirty = false;
+
+	const char* names[] = { "g_World", "g_View", "g_Proj", "g_WorldViewProj", "g_WorldInvTranspose", "g_Material", "g_EyePosW", "g_TextureUsed" };
+	const VariableDesc descs[] = { { 0, 64 }, { 64, 64 }, { 128, 64 }, { 192, 64 }, { 256, 64 }, { 320, 64 }, { 384, 12 }, { 396, 4 } };
+	constexpr UINT VariableCount = sizeof(descs) / sizeof(descs[0]);
+
+	std::unordered_map<std::string, VariableDesc> params;
+	for (UINT i = 0; i < VariableCount; ++i)
+		params[names[i]] = descs[i];
+
+	EffectVariableHandle handles[VariableCount];
+	for (UINT i = 0; i < VariableCount; ++i)
+		handles[i] = { s_staging + descs[i].byteOffset, &s_isDirty, descs[i].byteWidth };
+
+	XMFLOAT4X4 values[DrawCount];
+	for (UINT i = 0; i < DrawCount; ++i)
+		XMStoreFloat4x4(&values[i], XMMatrixTranslation(static_cast<float>(i), 1.0f, 2.0f));
+
+	const auto byName = [&]()
+	{
+		for (UINT draw = 0; draw < DrawCount; ++draw)
+		{
+			for (UINT i = 0; i < VariableCount; ++i)
+			{
+				// const char*到std::string的转换与哈希查找,与原先的调用方式相同
+				const auto it = params.find(names[i]);
+				const auto variable = std::make_shared<ByNameVariable>(s_staging + it->second.byteOffset, &s_isDirty, it->second.byteWidth);
+				variable->SetRaw(&values[draw], sizeof(XMFLOAT4X4));
+			}
+		}
+		BenchmarkHarness::DoNotOptimize(s_isDirty);
+	};
+	const auto byHandle = [&]()
+	{
+		for (UINT draw = 0; draw < DrawCount; ++draw)
+		{
+			for (UINT i = 0; i < VariableCount; ++i)
+				handles[i].SetRaw(&values[draw], 0, sizeof(XMFLOAT4X4));
+		}
+		BenchmarkHarness::DoNotOptimize(s_isDirty);
+	};
+
+	BenchmarkHarness::Measure("1000 draws x 8 variables, lookup by name", 5, 20, byName);
+	BenchmarkHarness::Measure("1000 draws x 8 variables, resolved handles", 5, 20, byHandle);
+
+	// 单独执行一帧统计堆分配次数
+	size_t allocations = g_allocationCount;
+	byName();
+	std::printf("heap allocations per frame: lookup by name %zu", g_allocationCount - allocations);
+	allocations = g_allocationCount;
+	byHandle();
+	std::printf(", resolved handles %zu\n", g_allocationCount - allocations);
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+#include "BenchmarkHarness.h"
+#include "Narrowphase.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace DirectX;
+
+// 每帧数千个物体对时接触流形缓存的更新耗时,以及粗测+细测+缓存的整帧耗时
+int main()
+{
+	ContactManifold manifold{};
+	manifold.normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+	manifold.pointCount = 4;
+	for (UINT i = 0; i < manifold.pointCount; ++i)
+		manifold.points[i] = { XMFLOAT3(static_cast<float>(i & 1), 0.0f, static_cast<float>(i >> 1)), 0.01f, 0.0f, { 0.0f, 0.0f } };
+
+	for (const UINT pairCount : { 2000u, 8000u })
+	{
+		// 两组互不相同的物体对,按随机顺序更新
+		std::mt19937 rng(31);
+		std::vector<CollisionPair> pairSets[2];
+		for (UINT set = 0; set < 2; ++set)
+		{
+			for (UINT i = 0; i < pairCount; ++i)
+				pairSets[set].push_back({ i, pairCount + 2 * i + set });
+			std::shuffle(pairSets[set].begin(), pairSets[set].end(), rng);
+		}
+
+		char name[64];
+		ContactManifoldCache cache;
+
+		// 每帧换一组物体对: 所有物体对都是新出现的,上一帧的全部被移除
+		UINT frame = 0;
+		std::snprintf(name, sizeof(name), "%u new pairs per frame", pairCount);
+		BenchmarkHarness::Measure(name, 3, 20, [&]()
+			{
+				for (const CollisionPair& pair : pairSets[frame++ & 1])
+					cache.Update(pair.first, pair.second, manifold);
+				cache.EndFrame();
+				BenchmarkHarness::DoNotOptimize(cache.GetManifolds().size());
+			});
+
+		// 物体对保持不变: 全部匹配已有的流形并继承冲量
+		cache.Clear();
+		std::snprintf(name, sizeof(name), "%u persistent pairs per frame", pairCount);
+		BenchmarkHarness::Measure(name, 3, 20, [&]()
+			{
+				for (const CollisionPair& pair : pairSets[0])
+					cache.Update(pair.first, pair.second, manifold);
+				cache.EndFrame();
+				BenchmarkHarness::DoNotOptimize(cache.GetManifolds().size());
+			});
+	}
+
+	// 4000个坦克(与BroadphaseBenchmark相同的分布),每帧移动后经过扫描剪枝、OBB细测与缓存更新
+	{
+		const UINT count = 4000;
+		std::mt19937 rng(32);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> velocity(-0.05f, 0.05f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+		std::vector<BoundingOrientedBox> boxes(count);
+		std::vector<XMFLOAT3> velocities(count);
+		for (UINT i = 0; i < count; ++i)
+		{
+			boxes[i].Center = XMFLOAT3(position(rng), 0.0f, position(rng));
+			boxes[i].Extents = XMFLOAT3(1.2f, 0.8f, 1.8f);
+			XMStoreFloat4(&boxes[i].Orientation, XMQuaternionRotationRollPitchYaw(0.0f, angle(rng), 0.0f));
+			velocities[i] = XMFLOAT3(velocity(rng), 0.0f, velocity(rng));
+		}
+
+		const auto aabbOf = [](const BoundingOrientedBox& box)
+		{
+			XMFLOAT3 corners[BoundingOrientedBox::CORNER_COUNT];
+			box.GetCorners(corners);
+			BoundingBox aabb;
+			BoundingBox::CreateFromPoints(aabb, BoundingOrientedBox::CORNER_COUNT, corners, sizeof(XMFLOAT3));
+			return aabb;
+		};
+
+		SweepAndPrune sap;
+		for (const BoundingOrientedBox& box : boxes)
+			sap.AddProxy(aabbOf(box));
+
+		Narrowphase narrowphase;
+		ContactManifoldCache cache;
+		std::vector<CollisionPair> pairs;
+		sap.FindPairs(pairs);
+		std::printf("%u tanks, %zu broadphase pairs in the first frame\n", count, pairs.size());
+
+		BenchmarkHarness::Measure("4000 tanks, broadphase + narrowphase + cache", 3, 20, [&]()
+			{
+				for (UINT i = 0; i < count; ++i)
+				{
+					boxes[i].Center.x += velocities[i].x;
+					boxes[i].Center.z += velocities[i].z;
+					sap.UpdateProxy(i, aabbOf(boxes[i]));
+				}
+				sap.FindPairs(pairs);
+				narrowphase.CollideBatch(boxes, pairs, cache);
+				cache.EndFrame();
+				BenchmarkHarness::DoNotOptimize(cache.GetManifolds().size());
+			});
+	}
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include "BenchmarkHarness.h"
+#include "OcclusionCulling.h"
+
+#include <random>
+
+using namespace DirectX;
+
+// 城镇式场景: 地面上的建筑作为遮挡物,坦克与道具作为被遮挡物
+// 分别测量光栅化遮挡物、构建层次Z与测试被遮挡物的耗时,并输出被剔除的比例
+int main()
+{
+	std::mt19937 rng(41);
+	std::uniform_real_distribution<float> position(-150.0f, 150.0f);
+	std::uniform_real_distribution<float> buildingExtent(3.0f, 12.0f);
+	std::uniform_real_distribution<float> buildingHeight(4.0f, 20.0f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+	std::uniform_real_distribution<float> propExtent(0.5f, 2.0f);
+
+	// 遮挡物为内嵌于建筑的OBB,每个12个三角形
+	std::vector<BoundingOrientedBox> occluders(40);
+	for (BoundingOrientedBox& occluder : occluders)
+	{
+		const float height = buildingHeight(rng);
+		occluder.Center = XMFLOAT3(position(rng), height, position(rng));
+		occluder.Extents = XMFLOAT3(buildingExtent(rng), height, buildingExtent(rng));
+		XMStoreFloat4(&occluder.Orientation, XMQuaternionRotationRollPitchYaw(0.0f, angle(rng), 0.0f));
+	}
+
+	std::vector<BoundingBox> occludees(4000);
+	for (BoundingBox& occludee : occludees)
+	{
+		const float extent = propExtent(rng);
+		occludee = BoundingBox(XMFLOAT3(position(rng), extent, position(rng)), XMFLOAT3(extent, extent, extent));
+	}
+
+	// 摄像机位于场景边缘的高处,俯视场景中心
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 12.0f, -160.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+
+	std::printf("%zu occluders (%zu triangles), %zu occludees\n", occluders.size(), occluders.size() * 12, occludees.size());
+
+	const std::pair<UINT, UINT> resolutions[] = { { 256u, 128u }, { 512u, 256u } };
+	for (const auto& [width, height] : resolutions)
+	{
+		const XMMATRIX viewProj = view * XMMatrixPerspectiveFovLH(XM_PIDIV4, static_cast<float>(width) / height, 0.5f, 400.0f);
+		OcclusionCulling culling(width, height);
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "%ux%u, rasterize occluders", width, height);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				culling.BeginFrame(viewProj);
+				for (const BoundingOrientedBox& occluder : occluders)
+					culling.RasterizeOccluder(occluder);
+				BenchmarkHarness::DoNotOptimize(culling.GetStatistics().occluderTriangles);
+			});
+
+		std::snprintf(name, sizeof(name), "%ux%u, build HiZ", width, height);
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				culling.BuildHiZ();
+				BenchmarkHarness::DoNotOptimize(culling.GetDepthBuffer().size());
+			});
+
+		std::snprintf(name, sizeof(name), "%ux%u, test %zu occludees", width, height, occludees.size());
+		UINT visibleCount = 0;
+		BenchmarkHarness::Measure(name, 5, 20, [&]()
+			{
+				visibleCount = 0;
+				for (const BoundingBox& occludee : occludees)
+					visibleCount += culling.IsVisible(occludee) ? 1 : 0;
+				BenchmarkHarness::DoNotOptimize(visibleCount);
+			});
+
+		// 单独统计一帧: 屏幕外的物体也计入被剔除的数目,另外给出屏幕内物体中被遮挡的比例
+		culling.BeginFrame(viewProj);
+		culling.BuildHiZ();
+		UINT onScreenCount = 0;
+		for (const BoundingBox& occludee : occludees)
+			onScreenCount += culling.IsVisible(occludee) ? 1 : 0;
+
+		culling.BeginFrame(viewProj);
+		for (const BoundingOrientedBox& occluder : occluders)
+			culling.RasterizeOccluder(occluder);
+		culling.BuildHiZ();
+		for (const BoundingBox& occludee : occludees)
+			culling.IsVisible(occludee);
+
+		const OcclusionCulling::Statistics& statistics = culling.GetStatistics();
+		std::printf("%ux%u: %u of %u culled (%.1f%%), %u of %u on-screen objects occluded (%.1f%%)\n",
+			width, height, statistics.culledObjects, statistics.testedObjects,
+			100.0 * statistics.culledObjects / statistics.testedObjects,
+			onScreenCount - (statistics.testedObjects - statistics.culledObjects), onScreenCount,
+			onScreenCount ? 100.0 * (onScreenCount - (statistics.testedObjects - statistics.culledObjects)) / onScreenCount : 0.0);
+	}
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include "BenchmarkHarness.h"
+#include "RayPacket.h"
+
+#include <random>
+#include <utility>
+
+using namespace DirectX;
+
+// 比较逐条射线与4条射线一组的射线包在包围盒数组与BVH上的最近命中查询
+int main()
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> extent(0.1f, 1.5f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<BoundingBox> boxes(20000);
+	for (BoundingBox& box : boxes)
+	{
+		box.Center = XMFLOAT3(position(rng), position(rng), position(rng));
+		box.Extents = XMFLOAT3(extent(rng), extent(rng), extent(rng));
+	}
+
+	std::vector<Ray> rays;
+	rays.reserve(16384);
+	for (UINT i = 0; i < 16384; ++i)
+	{
+		const XMFLOAT3 origin(position(rng), position(rng), position(rng));
+		rays.emplace_back(origin, XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0.0f) + XMVectorSet(0.0f, 0.0f, 1e-3f, 0.0f)));
+	}
+
+	BoundingVolumeHierarchy bvh;
+	bvh.Build(boxes, 4);
+	std::printf("%zu boxes, %zu rays per op, BVH depth %u\n", boxes.size(), rays.size(), bvh.GetDepth());
+
+	std::vector<RayHit> hits(rays.size());
+
+	// 包围盒数组只取前1024个,否则暴力查询耗时过长
+	const std::vector<BoundingBox> fewBoxes(boxes.begin(), boxes.begin() + 1024);
+	BenchmarkHarness::Measure("boxes x1024, scalar Ray::Hit", 3, 1, [&]()
+		{
+			for (size_t i = 0; i < rays.size(); ++i)
+			{
+				RayHit hit{ FLT_MAX, RayHit::InvalidIndex };
+				for (UINT j = 0; j < static_cast<UINT>(fewBoxes.size()); ++j)
+				{
+					float dist;
+					if (rays[i].Hit(fewBoxes[j], &dist, hit.dist) && dist < hit.dist)
+						hit = { dist, j };
+				}
+				hits[i] = hit;
+			}
+			BenchmarkHarness::DoNotOptimize(hits.back().index);
+		});
+	BenchmarkHarness::Measure("boxes x1024, RayPacket::HitBatch", 3, 1, [&]()
+		{
+			RayPacket::HitBatch(rays, fewBoxes, hits);
+			BenchmarkHarness::DoNotOptimize(hits.back().index);
+		});
+
+	// 随机射线之间互不相关,射线包的4条射线几乎走不同的路径,BVH遍历的收益有限
+	// 从同一点向屏幕网格发出的射线(视线检测、拾取)以2x2为一组打包,同一包内的射线走相近的路径
+	std::vector<Ray> coherentRays;
+	coherentRays.reserve(16384);
+	for (UINT tileY = 0; tileY < 128; tileY += 2)
+	{
+		for (UINT tileX = 0; tileX < 128; tileX += 2)
+		{
+			for (UINT i = 0; i < 4; ++i)
+			{
+				const float x = (tileX + i % 2) / 64.0f - 1.0f;
+				const float y = (tileY + i / 2) / 64.0f - 1.0f;
+				coherentRays.emplace_back(XMFLOAT3(0.0f, 0.0f, -60.0f), XMVector3Normalize(XMVectorSet(x, y, 1.0f, 0.0f)));
+			}
+		}
+	}
+
+	const std::pair<const char*, const std::vector<Ray>*> rayKinds[] =
+	{
+		{ "random", &rays },
+		{ "coherent", &coherentRays }
+	};
+	for (const auto& rayKind : rayKinds)
+	{
+		const std::vector<Ray>& queryRays = *rayKind.second;
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "bvh %s rays, BoundingVolumeHierarchy::Hit", rayKind.first);
+		BenchmarkHarness::Measure(name, 5, 1, [&]()
+			{
+				for (size_t i = 0; i < queryRays.size(); ++i)
+				{
+					float dist = FLT_MAX;
+					hits[i].index = bvh.Hit(XMLoadFloat3(&queryRays[i].origin), XMLoadFloat3(&queryRays[i].direction), &dist);
+					hits[i].dist = dist;
+				}
+				BenchmarkHarness::DoNotOptimize(hits.back().index);
+			});
+		std::snprintf(name, sizeof(name), "bvh %s rays, RayPacket::HitBatch", rayKind.first);
+		BenchmarkHarness::Measure(name, 5, 1, [&]()
+			{
+				RayPacket::HitBatch(queryRays, bvh, hits);
+				BenchmarkHarness::DoNotOptimize(hits.back().index);
+			});
+	}
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "BenchmarkHarness.h"
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+// 每帧提交50000个绘制包(64个管线/纹理/材质组合,随机深度),比较基数排序与std::sort,
+// 并统计排序前后(提交顺序与排序顺序)的状态切换次数
+int main()
+{
+	constexpr UINT PacketCount = 50000;
+
+	static char s_resources[256];
+	static const Material s_materials[16]{};
+
+	std::mt19937 rng(46);
+	std::uniform_real_distribution<float> depth(0.5f, 800.0f);
+
+	struct Submission
+	{
+		UINT pipeline;
+		RenderQueue::PartState state;
+		XMFLOAT4X4 world;
+	};
+	std::vector<Submission> submissions(PacketCount);
+	for (Submission& submission : submissions)
+	{
+		const UINT mesh = rng() % 32;
+		submission.pipeline = rng() % 4;
+		submission.state.material = &s_materials[rng() % 16];
+		submission.state.textureDiffuse = reinterpret_cast<ID3D11ShaderResourceView*>(s_resources + rng() % 16);
+		submission.state.vertexBuffer = reinterpret_cast<RenderBuffer*>(s_resources + 64 + mesh);
+		submission.state.indexBuffer = reinterpret_cast<RenderBuffer*>(s_resources + 128 + mesh);
+		submission.state.indexCount = 36;
+		submission.state.vertexStride = 32;
+		XMStoreFloat4x4(&submission.world, XMMatrixTranslation(0.0f, 0.0f, depth(rng)));
+	}
+
+	RenderQueue queue;
+	queue.SetViewMatrix(0, XMMatrixIdentity());
+	const auto submit = [&]()
+	{
+		queue.Clear();
+		for (const Submission& submission : submissions)
+			queue.SubmitPart(0, submission.pipeline, submission.state, XMLoadFloat4x4(&submission.world));
+	};
+
+	BenchmarkHarness::Measure("50000 packets, submit", 5, 10, [&]()
+		{
+			submit();
+			BenchmarkHarness::DoNotOptimize(queue.GetPacketCount());
+		});
+
+	BenchmarkHarness::Measure("50000 packets, submit + radix sort", 5, 10, [&]()
+		{
+			submit();
+			queue.Sort();
+			BenchmarkHarness::DoNotOptimize(queue.GetSortPassCount());
+		});
+
+	std::vector<RenderQueue::SortItem> items(PacketCount);
+	std::vector<RenderQueue::SortItem> temp;
+	for (UINT i = 0; i < PacketCount; ++i)
+		items[i] = { RenderQueue::MakeKey(0, submissions[i].pipeline, i % 16, i % 16, submissions[i].world._43), i };
+	std::vector<RenderQueue::SortItem> work;
+
+	BenchmarkHarness::Measure("50000 keys, RenderQueue::RadixSort", 5, 20, [&]()
+		{
+			work = items;
+			RenderQueue::RadixSort(work, temp);
+			BenchmarkHarness::DoNotOptimize(work.front().index);
+		});
+	BenchmarkHarness::Measure("50000 keys, std::stable_sort", 5, 20, [&]()
+		{
+			work = items;
+			std::stable_sort(work.begin(), work.end(),
+				[](const RenderQueue::SortItem& lhs, const RenderQueue::SortItem& rhs) { return lhs.key < rhs.key; });
+			BenchmarkHarness::DoNotOptimize(work.front().index);
+		});
+
+	// 状态切换: 按提交顺序执行与排序后执行
+	RenderQueue::Statistics unsorted{};
+	for (UINT i = 0; i < PacketCount; ++i)
+	{
+		const RenderQueue::DrawPacket prev = i > 0 ? RenderQueue::DrawPacket{ 0, submissions[i - 1].pipeline, submissions[i - 1].state, {}, {} } : RenderQueue::DrawPacket{};
+		const RenderQueue::DrawPacket curr{ 0, submissions[i].pipeline, submissions[i].state, {}, {} };
+		const UINT changes = RenderQueue::GetStateChanges(i > 0 ? &prev : nullptr, curr);
+		unsorted.pipelineChanges += (changes & RenderQueue::StateChangePipeline) ? 1 : 0;
+		unsorted.textureSetChanges += (changes & RenderQueue::StateChangeTextureSet) ? 1 : 0;
+		unsorted.materialChanges += (changes & RenderQueue::StateChangeMaterial) ? 1 : 0;
+		unsorted.vertexBufferChanges += (changes & RenderQueue::StateChangeVertexBuffer) ? 1 : 0;
+	}
+	submit();
+	queue.Sort();
+	const RenderQueue::Statistics sorted = queue.GetStatistics(0);
+	std::printf("state changes (pipeline/texture/material/vertex buffer): submission order %u/%u/%u/%u, sorted %u/%u/%u/%u\n",
+		unsorted.pipelineChanges, unsorted.textureSetChanges, unsorted.materialChanges, unsorted.vertexBufferChanges,
+		sorted.pipelineChanges, sorted.textureSetChanges, sorted.materialChanges, sorted.vertexBufferChanges);
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+#include "BenchmarkHarness.h"
+#include "TransformStore.h"
+
+#include <random>
+
+using namespace DirectX;
+
+// 一万个实例每帧只有一部分被修改: 比较逐个BasicTransform重建世界矩阵与TransformStore只重建被修改的实例
+int main()
+{
+	const UINT count = 10000;
+	std::mt19937 rng(37);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+	std::uniform_int_distribution<UINT> pick(0, count - 1);
+
+	std::vector<BasicTransform> transforms;
+	TransformStore store;
+	std::vector<TransformStore::Handle> handles;
+	transforms.reserve(count);
+	for (UINT i = 0; i < count; ++i)
+	{
+		transforms.emplace_back(XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT3(angle(rng), angle(rng), angle(rng)),
+			XMFLOAT3(position(rng), position(rng), position(rng)));
+		handles.push_back(store.Create(transforms.back()));
+	}
+	store.UpdateWorldMatrices();
+
+	std::vector<XMFLOAT4X4> worlds(count);
+	// BasicTransform缓存了世界矩阵,修改位置后重新读取才会重建
+	BenchmarkHarness::Measure("BasicTransform, 10000 of 10000 modified", 5, 10, [&]()
+		{
+			for (UINT i = 0; i < count; ++i)
+			{
+				transforms[i].SetPosition(position(rng), 0.0f, 0.0f);
+				XMStoreFloat4x4(&worlds[i], transforms[i].GetLocalToWorldMatrix());
+			}
+			BenchmarkHarness::DoNotOptimize(worlds.back()._41);
+		});
+
+	for (const UINT modified : { 100u, 1000u, count })
+	{
+		char name[96];
+		std::snprintf(name, sizeof(name), "TransformStore, %u of %u modified", modified, count);
+		BenchmarkHarness::Measure(name, 5, 10, [&]()
+			{
+				for (UINT i = 0; i < modified; ++i)
+					store.SetPosition(handles[modified == count ? i : pick(rng)], XMFLOAT3(position(rng), 0.0f, 0.0f));
+				BenchmarkHarness::DoNotOptimize(store.UpdateWorldMatrices());
+			});
+	}
+
+	return 0;
+}
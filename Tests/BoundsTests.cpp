@@ -0,0 +1,329 @@
+#include "TestHarness.h"
+#include "BoundsInterop.h"
+
+#include <random>
+
+// 同一份测试以不同的编译选项为每个SIMD后端各构建一次,检查选中的确实是期望的后端
+#if defined(BOUNDS_TEST_EXPECT_SCALAR) && !defined(BOUNDS_BACKEND_SCALAR)
+#error "expected the scalar Bounds backend"
+#endif
+#if defined(BOUNDS_TEST_EXPECT_FMA) && !defined(BOUNDS_BACKEND_FMA)
+#error "expected the FMA Bounds backend"
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float Epsilon = 1e-3f;
+
+	struct RandomScene
+	{
+		explicit RandomScene(const unsigned seed) : rng(seed) {}
+
+		XMFLOAT3 Position()
+		{
+			std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+			return XMFLOAT3(position(rng), position(rng), position(rng));
+		}
+
+		XMFLOAT3 Extents()
+		{
+			std::uniform_real_distribution<float> extent(0.1f, 8.0f);
+			return XMFLOAT3(extent(rng), extent(rng), extent(rng));
+		}
+
+		XMVECTOR Rotation()
+		{
+			std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+			return XMQuaternionRotationRollPitchYaw(angle(rng), angle(rng), angle(rng));
+		}
+
+		BoundingBox Box() { return BoundingBox(Position(), Extents()); }
+		BoundingSphere Sphere() { return BoundingSphere(Position(), Extents().x); }
+		BoundingOrientedBox OrientedBox()
+		{
+			XMFLOAT4 orientation;
+			XMStoreFloat4(&orientation, Rotation());
+			return BoundingOrientedBox(Position(), Extents(), orientation);
+		}
+
+		// 缩放 * 旋转 * 平移,nonUniform为false时为等比缩放
+		XMMATRIX World(const bool nonUniform)
+		{
+			std::uniform_real_distribution<float> scale(0.25f, 3.0f);
+			const float sx = scale(rng);
+			const XMMATRIX scaling = nonUniform ? XMMatrixScaling(sx, scale(rng), scale(rng)) : XMMatrixScaling(sx, sx, sx);
+			const XMFLOAT3 translation = Position();
+			return scaling * XMMatrixRotationQuaternion(Rotation()) * XMMatrixTranslation(translation.x, translation.y, translation.z);
+		}
+
+		std::mt19937 rng;
+	};
+
+	bool Near(const Bounds::Float3& actual, const XMFLOAT3& expected, const float epsilon = Epsilon)
+	{
+		return std::fabs(actual.x - expected.x) <= epsilon && std::fabs(actual.y - expected.y) <= epsilon && std::fabs(actual.z - expected.z) <= epsilon;
+	}
+
+	bool SameBox(const Bounds::Aabb& actual, const BoundingBox& expected)
+	{
+		return Near(actual.center, expected.Center) && Near(actual.extents, expected.Extents);
+	}
+
+	bool SameSphere(const Bounds::Sphere& actual, const BoundingSphere& expected)
+	{
+		return Near(actual.center, expected.Center) && std::fabs(actual.radius - expected.Radius) <= Epsilon;
+	}
+
+	// q与-q表示同一个旋转
+	bool SameOrientedBox(const Bounds::Obb& actual, const BoundingOrientedBox& expected)
+	{
+		const Bounds::Float4& q = actual.orientation;
+		const XMFLOAT4& e = expected.Orientation;
+		const float dot = q.x * e.x + q.y * e.y + q.z * e.z + q.w * e.w;
+		return Near(actual.center, expected.Center) && Near(actual.extents, expected.Extents) && std::fabs(std::fabs(dot) - 1.0f) <= Epsilon;
+	}
+
+	Bounds::Containment ToContainment(const ContainmentType type)
+	{
+		return type == DISJOINT ? Bounds::Containment::Disjoint :
+			type == CONTAINS ? Bounds::Containment::Contains : Bounds::Containment::Intersects;
+	}
+
+	// 透视视锥体,以及与之对应的DirectXCollision平面(法线朝外)
+	struct TestFrustum
+	{
+		TestFrustum()
+		{
+			const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(5.0f, 10.0f, -60.0f, 1.0f), XMVectorSet(-5.0f, 0.0f, 0.0f, 1.0f), g_XMIdentityR1);
+			const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 1.0f, 90.0f);
+			frustum = Bounds::FrustumFromMatrix(Bounds::ToMatrix4x4(view * proj));
+			for (int i = 0; i < 6; ++i)
+			{
+				const Bounds::Float4& p = frustum.planes[i];
+				planes[i] = XMVectorSet(-p.x, -p.y, -p.z, -p.w);
+			}
+		}
+
+		template <typename DirectXBounds>
+		Bounds::Containment Expected(const DirectXBounds& bounds) const
+		{
+			return ToContainment(bounds.ContainedBy(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5]));
+		}
+
+		Bounds::Frustum frustum;
+		XMVECTOR planes[6];
+	};
+}
+
+TEST_CASE(FrustumPlanesMatchBoundingFrustum)
+{
+	// 视锥体内外的点在两种表示下结论相同
+	const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 1.5f, 0.5f, 100.0f);
+	const Bounds::Frustum frustum = Bounds::FrustumFromMatrix(Bounds::ToMatrix4x4(proj));
+	const BoundingFrustum reference(proj);
+
+	RandomScene scene(1);
+	uint32_t insideCount = 0;
+	for (int i = 0; i < 2000; ++i)
+	{
+		XMFLOAT3 point = scene.Position();
+		point.z += 50.0f;
+		const Bounds::Sphere sphere{ { point.x, point.y, point.z }, 0.0f };
+		const bool isInside = Bounds::Contains(frustum, sphere) != Bounds::Containment::Disjoint;
+		CHECK_EQ(isInside, reference.Contains(XMLoadFloat3(&point)) != DISJOINT);
+		insideCount += isInside ? 1 : 0;
+	}
+	CHECK(insideCount > 100);
+	CHECK(insideCount < 1900);
+}
+
+TEST_CASE(TransformMatchesDirectXCollision)
+{
+	RandomScene scene(2);
+	for (int i = 0; i < 500; ++i)
+	{
+		const XMMATRIX world = scene.World(true);
+		const Bounds::Matrix4x4 matrix = Bounds::ToMatrix4x4(world);
+
+		const BoundingBox box = scene.Box();
+		BoundingBox expectedBox;
+		box.Transform(expectedBox, world);
+		CHECK(SameBox(Bounds::Transform(Bounds::ToAabb(box), matrix), expectedBox));
+
+		const BoundingSphere sphere = scene.Sphere();
+		BoundingSphere expectedSphere;
+		sphere.Transform(expectedSphere, world);
+		CHECK(SameSphere(Bounds::Transform(Bounds::ToSphere(sphere), matrix), expectedSphere));
+
+		// 非等比缩放时半长按各个轴分别缩放
+		const BoundingOrientedBox orientedBox = scene.OrientedBox();
+		BoundingOrientedBox expectedOrientedBox;
+		orientedBox.Transform(expectedOrientedBox, world);
+		CHECK(SameOrientedBox(Bounds::Transform(Bounds::ToObb(orientedBox), matrix), expectedOrientedBox));
+	}
+}
+
+TEST_CASE(BatchTransformMatchesDirectXCollision)
+{
+	// 数目不是4的倍数,最后几个走标量路径
+	RandomScene scene(3);
+	const size_t count = 1003;
+
+	std::vector<BoundingBox> boxes(count);
+	std::vector<BoundingSphere> spheres(count);
+	std::vector<Bounds::Aabb> aabbs(count);
+	std::vector<Bounds::Sphere> boundsSpheres(count);
+	std::vector<Bounds::Matrix4x4> matrices(count);
+	std::vector<XMFLOAT4X4> worlds(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		boxes[i] = scene.Box();
+		spheres[i] = scene.Sphere();
+		aabbs[i] = Bounds::ToAabb(boxes[i]);
+		boundsSpheres[i] = Bounds::ToSphere(spheres[i]);
+		const XMMATRIX world = scene.World(true);
+		XMStoreFloat4x4(&worlds[i], world);
+		matrices[i] = Bounds::ToMatrix4x4(world);
+	}
+
+	// 以同一个矩阵变换数组,球体的批量变换要求等比缩放
+	const XMMATRIX world = scene.World(false);
+	std::vector<Bounds::Aabb> outBoxes(count);
+	std::vector<Bounds::Sphere> outSpheres(count);
+	Bounds::TransformAabbs(aabbs.data(), count, Bounds::ToMatrix4x4(world), outBoxes.data());
+	Bounds::TransformSpheres(boundsSpheres.data(), count, Bounds::ToMatrix4x4(world), outSpheres.data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		BoundingBox expectedBox;
+		boxes[i].Transform(expectedBox, world);
+		CHECK(SameBox(outBoxes[i], expectedBox));
+
+		BoundingSphere expectedSphere;
+		spheres[i].Transform(expectedSphere, world);
+		CHECK(SameSphere(outSpheres[i], expectedSphere));
+	}
+
+	// 以一组矩阵变换同一个局部包围体
+	Bounds::TransformAabbs(aabbs[0], matrices.data(), count, outBoxes.data());
+	Bounds::TransformSpheres(boundsSpheres[0], matrices.data(), count, outSpheres.data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		BoundingBox expectedBox;
+		boxes[0].Transform(expectedBox, XMLoadFloat4x4(&worlds[i]));
+		CHECK(SameBox(outBoxes[i], expectedBox));
+
+		BoundingSphere expectedSphere;
+		spheres[0].Transform(expectedSphere, XMLoadFloat4x4(&worlds[i]));
+		CHECK(SameSphere(outSpheres[i], expectedSphere));
+	}
+}
+
+TEST_CASE(MergeMatchesDirectXCollision)
+{
+	RandomScene scene(5);
+	// 长度不是4的倍数,数组版本也覆盖只有一个包围盒的情况
+	std::vector<Bounds::Aabb> boxes(37);
+	BoundingBox expected;
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		const BoundingBox box = scene.Box();
+		const BoundingBox other = scene.Box();
+		BoundingBox merged;
+		BoundingBox::CreateMerged(merged, box, other);
+		CHECK(SameBox(Bounds::Merge(Bounds::ToAabb(box), Bounds::ToAabb(other)), merged));
+
+		boxes[i] = Bounds::ToAabb(box);
+		if (i == 0)
+			expected = box;
+		else
+			BoundingBox::CreateMerged(expected, expected, box);
+		CHECK(SameBox(Bounds::Merge(boxes.data(), i + 1), expected));
+	}
+}
+
+TEST_CASE(IntersectsMatchesDirectXCollision)
+{
+	RandomScene scene(4);
+	uint32_t hitCount = 0;
+	for (int i = 0; i < 5000; ++i)
+	{
+		const BoundingBox boxA = scene.Box(), boxB = scene.Box();
+		const BoundingSphere sphereA = scene.Sphere(), sphereB = scene.Sphere();
+
+		const bool boxHit = Bounds::Intersects(Bounds::ToAabb(boxA), Bounds::ToAabb(boxB));
+		CHECK_EQ(boxHit, boxA.Intersects(boxB));
+		CHECK_EQ(Bounds::Intersects(Bounds::ToSphere(sphereA), Bounds::ToSphere(sphereB)), sphereA.Intersects(sphereB));
+		CHECK_EQ(Bounds::Intersects(Bounds::ToSphere(sphereA), Bounds::ToAabb(boxA)), sphereA.Intersects(boxA));
+		hitCount += boxHit ? 1 : 0;
+	}
+	CHECK(hitCount > 0);
+}
+
+TEST_CASE(ContainsMatchesDirectXPlaneTests)
+{
+	const TestFrustum test;
+	RandomScene scene(5);
+
+	uint32_t counts[3] = {};
+	for (int i = 0; i < 5000; ++i)
+	{
+		const BoundingBox box = scene.Box();
+		const BoundingSphere sphere = scene.Sphere();
+		const BoundingOrientedBox orientedBox = scene.OrientedBox();
+
+		const Bounds::Containment boxResult = Bounds::Contains(test.frustum, Bounds::ToAabb(box));
+		CHECK(boxResult == test.Expected(box));
+		CHECK(Bounds::Contains(test.frustum, Bounds::ToSphere(sphere)) == test.Expected(sphere));
+		CHECK(Bounds::Contains(test.frustum, Bounds::ToObb(orientedBox)) == test.Expected(orientedBox));
+		++counts[static_cast<int>(boxResult)];
+	}
+
+	// 三种结果都需要出现
+	CHECK(counts[0] > 0);
+	CHECK(counts[1] > 0);
+	CHECK(counts[2] > 0);
+}
+
+TEST_CASE(BatchCullMatchesDirectXPlaneTests)
+{
+	const TestFrustum test;
+	RandomScene scene(6);
+	const size_t count = 2001;
+
+	std::vector<BoundingBox> boxes(count);
+	std::vector<BoundingSphere> spheres(count);
+	std::vector<Bounds::Aabb> aabbs(count);
+	std::vector<Bounds::Sphere> boundsSpheres(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		boxes[i] = scene.Box();
+		spheres[i] = scene.Sphere();
+		aabbs[i] = Bounds::ToAabb(boxes[i]);
+		boundsSpheres[i] = Bounds::ToSphere(spheres[i]);
+	}
+
+	std::vector<uint8_t> visible(count);
+	size_t expectedCount = 0;
+	const size_t boxCount = Bounds::CullAabbs(test.frustum, aabbs.data(), count, visible.data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		const bool isVisible = test.Expected(boxes[i]) != Bounds::Containment::Disjoint;
+		CHECK_EQ(visible[i] != 0, isVisible);
+		expectedCount += isVisible ? 1 : 0;
+	}
+	CHECK_EQ(boxCount, expectedCount);
+	CHECK(boxCount > 0);
+	CHECK(boxCount < count);
+
+	expectedCount = 0;
+	const size_t sphereCount = Bounds::CullSpheres(test.frustum, boundsSpheres.data(), count, visible.data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		const bool isVisible = test.Expected(spheres[i]) != Bounds::Containment::Disjoint;
+		CHECK_EQ(visible[i] != 0, isVisible);
+		expectedCount += isVisible ? 1 : 0;
+	}
+	CHECK_EQ(sphereCount, expectedCount);
+}
@@ -0,0 +1,307 @@
+#include "TestHarness.h"
+#include "Broadphase.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace DirectX;
+
+// 需要与CollisionPair位于同一命名空间才能被std::sort等找到
+static bool operator<(const CollisionPair& lhs, const CollisionPair& rhs)
+{
+	return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+}
+
+static bool operator==(const CollisionPair& lhs, const CollisionPair& rhs)
+{
+	return lhs.first == rhs.first && lhs.second == rhs.second;
+}
+
+namespace
+{
+	// O(n²)的参考结果,alive为空时所有物体都参与
+	std::vector<CollisionPair> BruteForcePairs(const std::vector<BoundingBox>& boxes, const std::vector<bool>& alive = {})
+	{
+		std::vector<CollisionPair> pairs;
+		const UINT count = static_cast<UINT>(boxes.size());
+		for (UINT i = 0; i < count; ++i)
+		{
+			if (!alive.empty() && !alive[i])
+				continue;
+			for (UINT j = i + 1; j < count; ++j)
+			{
+				if (!alive.empty() && !alive[j])
+					continue;
+				if (boxes[i].Intersects(boxes[j]))
+					pairs.push_back({ i, j });
+			}
+		}
+		return pairs;
+	}
+
+	// 排序后逐项比较,同一对出现两次也会导致不相等
+	bool SamePairs(std::vector<CollisionPair> actual, const std::vector<CollisionPair>& expected)
+	{
+		for (const CollisionPair& pair : actual)
+		{
+			if (pair.first >= pair.second)
+				return false;
+		}
+		std::sort(actual.begin(), actual.end());
+		return actual == expected;
+	}
+
+	// 随机场景: 大部分是小物体,少数跨越许多单元的大物体,
+	// 另有完全重合的物体与恰好相接触的物体
+	std::vector<BoundingBox> RandomScene(std::mt19937& rng, const UINT count)
+	{
+		std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+		std::uniform_real_distribution<float> smallExtent(0.2f, 2.0f);
+		std::uniform_real_distribution<float> largeExtent(5.0f, 15.0f);
+		std::uniform_int_distribution<int> gridPosition(-20, 20);
+
+		std::vector<BoundingBox> boxes;
+		boxes.reserve(count);
+		while (boxes.size() < count)
+		{
+			const size_t kind = boxes.size() % 20;
+			BoundingBox box;
+			if (kind == 0 && !boxes.empty())
+			{
+				box = boxes[boxes.size() / 2];
+			}
+			else if (kind == 1)
+			{
+				box.Center = XMFLOAT3(position(rng), position(rng), position(rng));
+				box.Extents = XMFLOAT3(largeExtent(rng), largeExtent(rng), largeExtent(rng));
+			}
+			else if (kind == 2)
+			{
+				// 两个整数坐标的盒子恰好在x = center.x + 1处相接
+				box.Center = XMFLOAT3(static_cast<float>(gridPosition(rng)), static_cast<float>(gridPosition(rng)), static_cast<float>(gridPosition(rng)));
+				box.Extents = XMFLOAT3(1.0f, 1.0f, 1.0f);
+				boxes.push_back(box);
+				box.Center.x += 2.0f;
+			}
+			else
+			{
+				box.Center = XMFLOAT3(position(rng), position(rng), position(rng));
+				box.Extents = XMFLOAT3(smallExtent(rng), smallExtent(rng), smallExtent(rng));
+			}
+			boxes.push_back(box);
+		}
+		boxes.resize(count);
+		return boxes;
+	}
+
+	struct BoxObject
+	{
+		const BoundingBox& GetBoundingBox() const { return box; }
+		BoundingBox box;
+	};
+}
+
+TEST_CASE(SweepAndPruneMatchesBruteForce)
+{
+	std::mt19937 rng(11);
+	const std::vector<BoundingBox> boxes = RandomScene(rng, 600);
+	const std::vector<CollisionPair> expected = BruteForcePairs(boxes);
+	CHECK(!expected.empty());
+
+	SweepAndPrune sap;
+	for (const BoundingBox& box : boxes)
+		sap.AddProxy(box);
+	CHECK_EQ(sap.GetProxyCount(), static_cast<UINT>(boxes.size()));
+
+	std::vector<CollisionPair> pairs;
+	sap.FindPairs(pairs);
+	CHECK(SamePairs(pairs, expected));
+}
+
+TEST_CASE(SweepAndPruneTracksMovingAndRemovedProxies)
+{
+	std::mt19937 rng(12);
+	std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+	std::uniform_int_distribution<UINT> pick(0, 399);
+
+	std::vector<BoundingBox> boxes = RandomScene(rng, 400);
+	std::vector<bool> alive(boxes.size(), true);
+
+	SweepAndPrune sap;
+	for (const BoundingBox& box : boxes)
+		sap.AddProxy(box);
+
+	std::vector<CollisionPair> pairs;
+	for (int frame = 0; frame < 30; ++frame)
+	{
+		// 每帧移动所有物体,并移除/重新添加一部分代理,编号会被复用
+		for (UINT i = 0; i < static_cast<UINT>(boxes.size()); ++i)
+		{
+			if (!alive[i])
+				continue;
+			boxes[i].Center.x += step(rng);
+			boxes[i].Center.y += step(rng);
+			boxes[i].Center.z += step(rng);
+			sap.UpdateProxy(i, boxes[i]);
+		}
+		for (int k = 0; k < 5; ++k)
+		{
+			const UINT proxy = pick(rng);
+			if (alive[proxy])
+			{
+				sap.RemoveProxy(proxy);
+				alive[proxy] = false;
+			}
+		}
+		if (frame % 3 == 2)
+		{
+			// 新代理复用某个已移除的编号,以编号作为物体下标
+			const BoundingBox box = boxes[pick(rng)];
+			const UINT proxy = sap.AddProxy(box);
+			CHECK(proxy < boxes.size());
+			CHECK(!alive[proxy]);
+			boxes[proxy] = box;
+			alive[proxy] = true;
+		}
+
+		sap.FindPairs(pairs);
+		CHECK(SamePairs(pairs, BruteForcePairs(boxes, alive)));
+	}
+}
+
+TEST_CASE(SpatialHashGridMatchesBruteForce)
+{
+	std::mt19937 rng(13);
+	const std::vector<BoundingBox> boxes = RandomScene(rng, 600);
+	const std::vector<CollisionPair> expected = BruteForcePairs(boxes);
+
+	// 单元远小于物体时一个物体登记在许多单元中;桶很少时不同单元会哈希到同一个桶
+	const std::pair<float, UINT> configs[] = { { 0.75f, 4096u }, { 4.0f, 4096u }, { 4.0f, 7u }, { 40.0f, 7u } };
+	for (const auto& [cellSize, bucketCount] : configs)
+	{
+		SpatialHashGrid grid(cellSize, bucketCount);
+		for (const BoundingBox& box : boxes)
+			grid.Insert(box);
+		CHECK_EQ(grid.GetObjectCount(), static_cast<UINT>(boxes.size()));
+
+		std::vector<CollisionPair> pairs;
+		grid.FindPairs(pairs);
+		CHECK(SamePairs(pairs, expected));
+	}
+}
+
+TEST_CASE(SpatialHashGridRebuildsAfterClearAndCellSizeChange)
+{
+	std::mt19937 rng(14);
+	SpatialHashGrid grid(2.0f, 64);
+	std::vector<CollisionPair> pairs;
+
+	for (int frame = 0; frame < 5; ++frame)
+	{
+		const std::vector<BoundingBox> boxes = RandomScene(rng, 300);
+		grid.Clear();
+		grid.SetCellSize(1.0f + frame);
+		for (const BoundingBox& box : boxes)
+			grid.Insert(box);
+
+		grid.FindPairs(pairs);
+		CHECK(SamePairs(pairs, BruteForcePairs(boxes)));
+	}
+}
+
+TEST_CASE(SpatialHashGridQueryReportsEachObjectOnce)
+{
+	std::mt19937 rng(15);
+	const std::vector<BoundingBox> boxes = RandomScene(rng, 500);
+	const std::vector<BoundingBox> queries = RandomScene(rng, 60);
+
+	SpatialHashGrid grid(1.5f, 128);
+	for (const BoundingBox& box : boxes)
+		grid.Insert(box);
+
+	for (const BoundingBox& query : queries)
+	{
+		std::vector<UINT> indices;
+		grid.Query(query, indices);
+		std::sort(indices.begin(), indices.end());
+
+		std::vector<UINT> expected;
+		for (UINT i = 0; i < static_cast<UINT>(boxes.size()); ++i)
+		{
+			if (boxes[i].Intersects(query))
+				expected.push_back(i);
+		}
+		CHECK(indices == expected);
+	}
+}
+
+TEST_CASE(AcceptsObjectsWithGetBoundingBox)
+{
+	const BoxObject a{ BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)) };
+	BoxObject b{ BoundingBox(XMFLOAT3(1.5f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)) };
+
+	SweepAndPrune sap;
+	const UINT proxyA = sap.AddProxy(a);
+	const UINT proxyB = sap.AddProxy(b);
+	SpatialHashGrid grid;
+	grid.Insert(a);
+	grid.Insert(b);
+
+	std::vector<CollisionPair> pairs;
+	sap.FindPairs(pairs);
+	CHECK_EQ(pairs.size(), 1u);
+	grid.FindPairs(pairs);
+	CHECK_EQ(pairs.size(), 1u);
+
+	b.box.Center.x = 5.0f;
+	sap.UpdateProxy(proxyB, b);
+	sap.FindPairs(pairs);
+	CHECK(pairs.empty());
+	CHECK(proxyA != proxyB);
+}
+
+TEST_CASE(MovingTankFieldMatchesBruteForceAtBenchmarkScale)
+{
+	// 与BroadphaseBenchmark相同的场景: 4000个坦克大小的包围盒在平面上各自匀速移动
+	// 扫描剪枝增量更新,空间哈希网格每帧重建,每帧都与暴力检测比较
+	const UINT count = 4000;
+	std::mt19937 rng(16);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> velocity(-0.2f, 0.2f);
+
+	std::vector<BoundingBox> boxes(count);
+	std::vector<XMFLOAT3> velocities(count);
+	for (UINT i = 0; i < count; ++i)
+	{
+		boxes[i] = BoundingBox(XMFLOAT3(position(rng), 0.0f, position(rng)), XMFLOAT3(1.2f, 0.8f, 1.8f));
+		velocities[i] = XMFLOAT3(velocity(rng), 0.0f, velocity(rng));
+	}
+
+	SweepAndPrune sap;
+	for (const BoundingBox& box : boxes)
+		sap.AddProxy(box);
+	SpatialHashGrid grid(4.0f, 4096);
+
+	std::vector<CollisionPair> pairs;
+	for (int frame = 0; frame < 8; ++frame)
+	{
+		// 每帧的速度放大,使排序轴上的顺序发生足够多的变化
+		for (UINT i = 0; i < count; ++i)
+		{
+			boxes[i].Center.x += 10.0f * velocities[i].x;
+			boxes[i].Center.z += 10.0f * velocities[i].z;
+			sap.UpdateProxy(i, boxes[i]);
+		}
+		const std::vector<CollisionPair> expected = BruteForcePairs(boxes);
+		CHECK(!expected.empty());
+
+		sap.FindPairs(pairs);
+		CHECK(SamePairs(pairs, expected));
+
+		grid.Clear();
+		for (const BoundingBox& box : boxes)
+			grid.Insert(box);
+		grid.FindPairs(pairs);
+		CHECK(SamePairs(pairs, expected));
+	}
+}
@@ -0,0 +1,270 @@
+#include "TestHarness.h"
+#include "ClusteredLightCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr UINT CountX = 16;
+	constexpr UINT CountY = 9;
+	constexpr UINT CountZ = 24;
+	constexpr float NearZ = 0.5f;
+	constexpr float FarZ = 200.0f;
+	constexpr float AspectRatio = 16.0f / 9.0f;
+
+	// 观察矩阵为单位矩阵,光源位置即观察空间位置
+	XMMATRIX Projection()
+	{
+		return XMMatrixPerspectiveFovLH(XM_PIDIV2, AspectRatio, NearZ, FarZ);
+	}
+
+	// 簇在观察空间中的近/远深度
+	void SliceDepths(const UINT z, float& z0, float& z1)
+	{
+		z0 = NearZ * std::pow(FarZ / NearZ, static_cast<float>(z) / CountZ);
+		z1 = NearZ * std::pow(FarZ / NearZ, static_cast<float>(z + 1) / CountZ);
+	}
+
+	// 簇内的观察空间点,u, v, w∈[0, 1]分别为簇内x(从左到右)、y(从上到下)与深度方向的位置
+	XMFLOAT3 PointInCluster(const UINT x, const UINT y, const UINT z, const float u, const float v, const float w)
+	{
+		const float xScale = 1.0f / (std::tan(XM_PIDIV4) * AspectRatio);
+		const float yScale = 1.0f / std::tan(XM_PIDIV4);
+		float z0, z1;
+		SliceDepths(z, z0, z1);
+		const float depth = z0 + (z1 - z0) * w;
+		const float ndcX = -1.0f + 2.0f * (x + u) / CountX;
+		const float ndcY = 1.0f - 2.0f * (y + v) / CountY;
+		return XMFLOAT3(ndcX * depth / xScale, ndcY * depth / yScale, depth);
+	}
+
+	bool InsideLight(const XMFLOAT3& p, const XMFLOAT3& center, const float radius, const XMFLOAT3* pSpotDirection)
+	{
+		const XMVECTOR offset = XMLoadFloat3(&p) - XMLoadFloat3(&center);
+		if (XMVectorGetX(XMVector3LengthSq(offset)) > radius * radius)
+			return false;
+		return !pSpotDirection || XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(pSpotDirection))) >= 0.0f;
+	}
+
+	// 暴力参考: 对每个簇取采样点,任何一个采样点位于光源范围内时,该簇必须包含该光源
+	// 簇以其AABB与包围球(及聚光灯半空间)测试,这是结果的上界: 不在上界中的簇不能包含该光源
+	struct BruteForce
+	{
+		std::vector<std::vector<UINT>> required;
+		std::vector<std::vector<UINT>> allowed;
+	};
+
+	BruteForce BruteForceAssign(const std::vector<PointLight>& pointLights, const std::vector<SpotLight>& spotLights)
+	{
+		BruteForce result;
+		result.required.resize(CountX * CountY * CountZ);
+		result.allowed.resize(CountX * CountY * CountZ);
+
+		const UINT lightCount = static_cast<UINT>(pointLights.size() + spotLights.size());
+		for (UINT z = 0; z < CountZ; ++z)
+		{
+			for (UINT y = 0; y < CountY; ++y)
+			{
+				for (UINT x = 0; x < CountX; ++x)
+				{
+					const UINT cluster = (z * CountY + y) * CountX + x;
+
+					// 簇的8个角点的包围盒
+					XMFLOAT3 boxMin(FLT_MAX, FLT_MAX, FLT_MAX), boxMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+					for (int corner = 0; corner < 8; ++corner)
+					{
+						const XMFLOAT3 p = PointInCluster(x, y, z, static_cast<float>(corner & 1), static_cast<float>((corner >> 1) & 1), static_cast<float>(corner >> 2));
+						boxMin = XMFLOAT3((std::min)(boxMin.x, p.x), (std::min)(boxMin.y, p.y), (std::min)(boxMin.z, p.z));
+						boxMax = XMFLOAT3((std::max)(boxMax.x, p.x), (std::max)(boxMax.y, p.y), (std::max)(boxMax.z, p.z));
+					}
+
+					// 点光源的编号为[0, pointCount),聚光灯紧随其后
+					for (UINT light = 0; light < lightCount; ++light)
+					{
+						const bool isSpot = light >= pointLights.size();
+						const XMFLOAT3& center = isSpot ? spotLights[light - pointLights.size()].position : pointLights[light].position;
+						const float range = isSpot ? spotLights[light - pointLights.size()].range : pointLights[light].range;
+						const XMFLOAT3* pDirection = isSpot ? &spotLights[light - pointLights.size()].direction : nullptr;
+
+						// 上界稍微放大,避免与被测代码的舍入差异
+						const float radius = range * 1.001f + 1e-3f;
+						const float dx = (std::max)({ boxMin.x - center.x, center.x - boxMax.x, 0.0f });
+						const float dy = (std::max)({ boxMin.y - center.y, center.y - boxMax.y, 0.0f });
+						const float dz = (std::max)({ boxMin.z - center.z, center.z - boxMax.z, 0.0f });
+						bool isAllowed = dx * dx + dy * dy + dz * dz <= radius * radius;
+						if (isAllowed && pDirection)
+						{
+							const XMFLOAT3 support(pDirection->x > 0.0f ? boxMax.x : boxMin.x, pDirection->y > 0.0f ? boxMax.y : boxMin.y, pDirection->z > 0.0f ? boxMax.z : boxMin.z);
+							isAllowed = XMVectorGetX(XMVector3Dot(XMLoadFloat3(&support) - XMLoadFloat3(&center), XMLoadFloat3(pDirection))) >= -1e-3f;
+						}
+						if (isAllowed)
+							result.allowed[cluster].push_back(light);
+
+						// 下界稍微缩小
+						bool isRequired = false;
+						for (int sample = 0; sample < 125 && !isRequired; ++sample)
+						{
+							const XMFLOAT3 p = PointInCluster(x, y, z, (sample % 5) / 4.0f, (sample / 5 % 5) / 4.0f, (sample / 25) / 4.0f);
+							isRequired = InsideLight(p, center, range * 0.999f, pDirection);
+						}
+						if (isRequired)
+							result.required[cluster].push_back(light);
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	// 簇中的光源,聚光灯的编号加上点光源数目,与BruteForceAssign一致
+	std::vector<UINT> ClusterLights(const ClusteredLightCulling& culling, const UINT cluster, const UINT pointLightCount)
+	{
+		const ClusteredLightCulling::Cluster& range = culling.GetClusters()[cluster];
+		const std::vector<UINT>& indices = culling.GetLightIndices();
+		std::vector<UINT> lights(indices.begin() + range.offset, indices.begin() + range.offset + range.pointLightCount);
+		for (UINT i = 0; i < range.spotLightCount; ++i)
+			lights.push_back(indices[range.offset + range.pointLightCount + i] + pointLightCount);
+		return lights;
+	}
+
+	bool IsSubset(const std::vector<UINT>& subset, const std::vector<UINT>& set)
+	{
+		return std::includes(set.begin(), set.end(), subset.begin(), subset.end());
+	}
+
+	PointLight MakePointLight(const XMFLOAT3& position, const float range)
+	{
+		PointLight light{};
+		light.position = position;
+		light.range = range;
+		return light;
+	}
+
+	SpotLight MakeSpotLight(const XMFLOAT3& position, const float range, const XMFLOAT3& direction)
+	{
+		SpotLight light{};
+		light.position = position;
+		light.range = range;
+		XMStoreFloat3(&light.direction, XMVector3Normalize(XMLoadFloat3(&direction)));
+		return light;
+	}
+}
+
+TEST_CASE(RandomLightsMatchBruteForceAssignment)
+{
+	std::mt19937 rng(61);
+	std::uniform_real_distribution<float> lateral(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> depth(-5.0f, 120.0f);
+	std::uniform_real_distribution<float> range(0.5f, 12.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<PointLight> pointLights;
+	std::vector<SpotLight> spotLights;
+	for (int i = 0; i < 60; ++i)
+		pointLights.push_back(MakePointLight(XMFLOAT3(lateral(rng), lateral(rng) * 0.5f, depth(rng)), range(rng)));
+	for (int i = 0; i < 40; ++i)
+		spotLights.push_back(MakeSpotLight(XMFLOAT3(lateral(rng), lateral(rng) * 0.5f, depth(rng)), range(rng), XMFLOAT3(unit(rng), unit(rng), unit(rng) + 1e-3f)));
+
+	ClusteredLightCulling culling(CountX, CountY, CountZ);
+	culling.SetProjection(Projection());
+	culling.Cull(XMMatrixIdentity(), pointLights.data(), static_cast<UINT>(pointLights.size()), spotLights.data(), static_cast<UINT>(spotLights.size()));
+
+	const BruteForce expected = BruteForceAssign(pointLights, spotLights);
+	UINT requiredPairs = 0;
+	for (UINT cluster = 0; cluster < culling.GetClusterCount(); ++cluster)
+	{
+		const std::vector<UINT> lights = ClusterLights(culling, cluster, static_cast<UINT>(pointLights.size()));
+		// 簇内按点光源、聚光灯的顺序各自升序,编号连续后整体升序
+		CHECK(std::is_sorted(lights.begin(), lights.end()));
+		CHECK(IsSubset(expected.required[cluster], lights));
+		CHECK(IsSubset(lights, expected.allowed[cluster]));
+		requiredPairs += static_cast<UINT>(expected.required[cluster].size());
+	}
+	CHECK(requiredPairs > 500);
+
+	// 索引列表紧凑排列: 各簇的范围首尾相接
+	const std::vector<ClusteredLightCulling::Cluster>& clusters = culling.GetClusters();
+	for (UINT cluster = 1; cluster < culling.GetClusterCount(); ++cluster)
+		CHECK_EQ(clusters[cluster].offset, clusters[cluster - 1].offset + clusters[cluster - 1].pointLightCount + clusters[cluster - 1].spotLightCount);
+	CHECK_EQ(culling.GetStatistics().lightClusterPairs, static_cast<UINT>(culling.GetLightIndices().size()));
+}
+
+TEST_CASE(ClustersWithoutLightsAreEmpty)
+{
+	ClusteredLightCulling culling(CountX, CountY, CountZ);
+	culling.SetProjection(Projection());
+
+	// 没有光源
+	culling.Cull(XMMatrixIdentity(), nullptr, 0, nullptr, 0);
+	for (const ClusteredLightCulling::Cluster& cluster : culling.GetClusters())
+	{
+		CHECK_EQ(cluster.offset, 0u);
+		CHECK_EQ(cluster.pointLightCount + cluster.spotLightCount, 0u);
+	}
+	CHECK(culling.GetLightIndices().empty());
+
+	// 一个位于画面中心附近的小光源,以及摄像机背后、画面之外与远平面之外的光源
+	const PointLight pointLights[] =
+	{
+		MakePointLight(XMFLOAT3(0.1f, 0.1f, 10.0f), 0.2f),
+		MakePointLight(XMFLOAT3(0.0f, 0.0f, -5.0f), 2.0f),
+		MakePointLight(XMFLOAT3(500.0f, 0.0f, 10.0f), 2.0f),
+		MakePointLight(XMFLOAT3(0.0f, 0.0f, 300.0f), 2.0f)
+	};
+	// 聚光灯位于近处,朝向摄像机背后,照不到任何簇
+	const SpotLight spotLights[] = { MakeSpotLight(XMFLOAT3(0.0f, 0.0f, 0.2f), 0.5f, XMFLOAT3(0.0f, 0.0f, -1.0f)) };
+	culling.Cull(XMMatrixIdentity(), pointLights, 4, spotLights, 1);
+
+	CHECK_EQ(culling.GetStatistics().visibleLights, 1u);
+	CHECK_EQ(culling.GetStatistics().maxLightsPerCluster, 1u);
+
+	const UINT slice = culling.GetSlice(10.0f);
+	UINT occupied = 0;
+	for (UINT cluster = 0; cluster < culling.GetClusterCount(); ++cluster)
+	{
+		const ClusteredLightCulling::Cluster& range = culling.GetClusters()[cluster];
+		CHECK_EQ(range.spotLightCount, 0u);
+		if (range.pointLightCount == 0)
+			continue;
+		++occupied;
+		CHECK_EQ(culling.GetLightIndices()[range.offset], 0u);
+		// 只出现在光源深度附近的簇层
+		CHECK(cluster / (CountX * CountY) + 1 >= slice && cluster / (CountX * CountY) <= slice + 1);
+	}
+	CHECK(occupied > 0 && occupied <= 8);
+	CHECK_EQ(static_cast<UINT>(culling.GetLightIndices().size()), occupied);
+}
+
+TEST_CASE(LightStraddlingClusterBoundariesLandsInBothClusters)
+{
+	ClusteredLightCulling culling(CountX, CountY, CountZ);
+	culling.SetProjection(Projection());
+
+	// 光源中心位于第3、4列的分界线上,且位于两个深度层的分界面上
+	const XMFLOAT3 boundary = PointInCluster(4, 4, 10, 0.0f, 0.5f, 1.0f);
+	const PointLight pointLight = MakePointLight(boundary, 0.05f);
+	culling.Cull(XMMatrixIdentity(), &pointLight, 1, nullptr, 0);
+
+	const auto contains = [&culling](const UINT x, const UINT y, const UINT z)
+	{
+		return culling.GetClusters()[culling.GetClusterIndex(x, y, z)].pointLightCount == 1;
+	};
+	CHECK(contains(3, 4, 10));
+	CHECK(contains(4, 4, 10));
+	CHECK(contains(3, 4, 11));
+	CHECK(contains(4, 4, 11));
+	CHECK(!contains(5, 4, 10));
+	CHECK(!contains(4, 4, 12));
+	CHECK_EQ(culling.GetStatistics().lightClusterPairs, 4u);
+
+	// 聚光灯位于两个深度层的分界面上,朝向-z时只照亮较近的深度层
+	const SpotLight spotLight = MakeSpotLight(PointInCluster(4, 4, 10, 0.5f, 0.5f, 1.0f), 0.05f, XMFLOAT3(0.0f, 0.0f, -1.0f));
+	culling.Cull(XMMatrixIdentity(), nullptr, 0, &spotLight, 1);
+	CHECK_EQ(culling.GetClusters()[culling.GetClusterIndex(4, 4, 10)].spotLightCount, 1u);
+	CHECK_EQ(culling.GetClusters()[culling.GetClusterIndex(4, 4, 11)].spotLightCount, 0u);
+}
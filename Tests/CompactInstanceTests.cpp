@@ -0,0 +1,112 @@
+#include "TestHarness.h"
+#include "CompactInstance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// 逆转置矩阵变换法线的参考结果
+	XMVECTOR XM_CALLCONV ReferenceNormal(FXMVECTOR normal, CXMMATRIX world)
+	{
+		XMMATRIX local = world;
+		local.r[3] = g_XMIdentityR3;
+		const XMMATRIX inverseTranspose = XMMatrixTranspose(XMMatrixInverse(nullptr, local));
+		return XMVector3Normalize(XMVector3TransformNormal(normal, inverseTranspose));
+	}
+
+	float AngleBetween(FXMVECTOR lhs, FXMVECTOR rhs)
+	{
+		const float cosine = XMVectorGetX(XMVector3Dot(XMVector3Normalize(lhs), XMVector3Normalize(rhs)));
+		return std::acos((std::max)(-1.0f, (std::min)(cosine, 1.0f)));
+	}
+
+	XMMATRIX RandomWorld(std::mt19937& rng, const bool isUniform, const bool isMirrored)
+	{
+		std::uniform_real_distribution<float> scale(0.2f, 5.0f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+
+		const float sx = scale(rng);
+		const XMVECTOR scaling = isUniform ? XMVectorReplicate(sx) : XMVectorSet(sx, scale(rng), scale(rng), 0.0f);
+		const XMVECTOR mirror = isMirrored ? XMVectorSet(-1.0f, 1.0f, 1.0f, 0.0f) : g_XMOne;
+		return XMMatrixScalingFromVector(XMVectorMultiply(scaling, mirror)) *
+			XMMatrixRotationRollPitchYaw(angle(rng), angle(rng), angle(rng)) *
+			XMMatrixTranslation(position(rng), position(rng), position(rng));
+	}
+
+	XMVECTOR RandomNormal(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		return XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0.0f) + XMVectorSet(0.0f, 0.0f, 1e-3f, 0.0f));
+	}
+}
+
+TEST_CASE(CompactColumnsReproduceTheWorldMatrix)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+	for (int i = 0; i < 200; ++i)
+	{
+		const XMMATRIX world = RandomWorld(rng, i % 2 == 0, i % 3 == 0);
+		const CompactInstancedData data = CreateCompactInstancedData(world);
+
+		const XMVECTOR point = XMVectorSet(position(rng), position(rng), position(rng), 1.0f);
+		const XMVECTOR expected = XMVector3TransformCoord(point, world);
+		const XMVECTOR actual = TransformPointAffine(point, data);
+		CHECK(XMVector3NearEqual(actual, expected, XMVectorReplicate(1e-3f)));
+	}
+}
+
+TEST_CASE(CofactorNormalMatchesInverseTranspose)
+{
+	// 均匀缩放、非均匀缩放与镜像(det < 0)三种情况都需要与逆转置矩阵得到相同的方向
+	std::mt19937 rng(43);
+	for (const bool isUniform : { true, false })
+	{
+		for (const bool isMirrored : { false, true })
+		{
+			for (int i = 0; i < 200; ++i)
+			{
+				const XMMATRIX world = RandomWorld(rng, isUniform, isMirrored);
+				const CompactInstancedData data = CreateCompactInstancedData(world);
+				const XMVECTOR normal = RandomNormal(rng);
+
+				const XMVECTOR actual = TransformNormalAffine(normal, data);
+				CHECK_NEAR(XMVectorGetW(actual), 0.0f, 0.0f);
+				CHECK(AngleBetween(actual, ReferenceNormal(normal, world)) < 1e-3f);
+			}
+		}
+	}
+}
+
+TEST_CASE(WorldMatrixAloneIsWrongUnderNonUniformScale)
+{
+	// 对照: 直接用世界矩阵变换法线在非均匀缩放下会偏离表面法线,说明上面的比较是有意义的
+	const XMMATRIX world = XMMatrixScaling(4.0f, 1.0f, 1.0f) * XMMatrixTranslation(3.0f, 0.0f, 0.0f);
+	const XMVECTOR normal = XMVector3Normalize(XMVectorSet(1.0f, 1.0f, 0.0f, 0.0f));
+
+	const XMVECTOR expected = ReferenceNormal(normal, world);
+	CHECK(AngleBetween(XMVector3TransformNormal(normal, world), expected) > 0.5f);
+	CHECK(AngleBetween(TransformNormalAffine(normal, CreateCompactInstancedData(world)), expected) < 1e-4f);
+
+	// 缩放后的平面x + y = 0: 法线仍需垂直于平面上的切线(4, -1, 0)
+	const XMVECTOR tangent = XMVectorSet(4.0f, -1.0f, 0.0f, 0.0f);
+	CHECK_NEAR(XMVectorGetX(XMVector3Dot(TransformNormalAffine(normal, CreateCompactInstancedData(world)), tangent)), 0.0f, 1e-4f);
+}
+
+TEST_CASE(MirroredInstancesKeepOutwardNormals)
+{
+	// 沿x轴镜像的单位立方体: +x面变为-x面,外法线应指向-x
+	const XMMATRIX world = XMMatrixScaling(-2.0f, 1.0f, 1.0f);
+	const CompactInstancedData data = CreateCompactInstancedData(world);
+	const XMVECTOR normal = XMVector3Normalize(TransformNormalAffine(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), data));
+	CHECK(XMVector3NearEqual(normal, XMVectorSet(-1.0f, 0.0f, 0.0f, 0.0f), XMVectorReplicate(1e-5f)));
+
+	// +y面在镜像后仍为+y面
+	const XMVECTOR up = XMVector3Normalize(TransformNormalAffine(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), data));
+	CHECK(XMVector3NearEqual(up, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), XMVectorReplicate(1e-5f)));
+}
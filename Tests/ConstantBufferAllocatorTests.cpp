@@ -0,0 +1,168 @@
+#include "TestHarness.h"
+#include "ConstantBufferAllocator.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	using Allocation = ConstantBufferAllocator::Allocation;
+
+	Allocation Allocate(ConstantBufferAllocator& allocator, const UINT byteWidth)
+	{
+		Allocation allocation{};
+		CHECK(allocator.Allocate(byteWidth, &allocation));
+		return allocation;
+	}
+}
+
+TEST_CASE(AllocationsAreAlignedTo256Bytes)
+{
+	// 池的大小向下对齐
+	CHECK_EQ(ConstantBufferAllocator(1000).GetByteWidth(), 768u);
+
+	ConstantBufferAllocator allocator(4096);
+
+	// 64字节的常量缓冲区也占用16个常量
+	const Allocation first = Allocate(allocator, 64);
+	CHECK_EQ(first.firstConstant, 0u);
+	CHECK_EQ(first.numConstants, 16u);
+	CHECK(first.mapType == RenderMapType::WriteDiscard);
+
+	const Allocation second = Allocate(allocator, 256);
+	CHECK_EQ(second.firstConstant, 16u);
+	CHECK_EQ(second.numConstants, 16u);
+	CHECK(second.mapType == RenderMapType::WriteNoOverwrite);
+
+	// 多出1字节也需要一整块
+	const Allocation third = Allocate(allocator, 257);
+	CHECK_EQ(third.firstConstant, 32u);
+	CHECK_EQ(third.numConstants, 32u);
+	CHECK(third.mapType == RenderMapType::WriteNoOverwrite);
+	CHECK_EQ(allocator.GetHead(), 1024u);
+
+	// 起始位置与大小都是256字节的倍数
+	std::mt19937 rng(47);
+	std::uniform_int_distribution<UINT> size(1, 1024);
+	for (int i = 0; i < 1000; ++i)
+	{
+		const Allocation allocation = Allocate(allocator, size(rng));
+		CHECK_EQ(allocation.firstConstant % 16, 0u);
+		CHECK_EQ(allocation.numConstants % 16, 0u);
+		CHECK(allocation.firstConstant * 16 + allocation.numConstants * 16 <= allocator.GetByteWidth());
+	}
+}
+
+TEST_CASE(RolloverDiscardsAndBumpsGeneration)
+{
+	ConstantBufferAllocator allocator(1024);
+	Allocate(allocator, 256);
+	Allocate(allocator, 256);
+	const UINT generation = allocator.GetGeneration();
+
+	// 恰好用完剩余空间时不回绕
+	const Allocation last = Allocate(allocator, 512);
+	CHECK_EQ(last.firstConstant, 32u);
+	CHECK(last.mapType == RenderMapType::WriteNoOverwrite);
+	CHECK_EQ(allocator.GetHead(), 1024u);
+	CHECK_EQ(allocator.GetGeneration(), generation);
+
+	// 空间不足: 从头开始并丢弃整个缓冲区,之前分配的位置全部失效
+	const Allocation wrapped = Allocate(allocator, 16);
+	CHECK_EQ(wrapped.firstConstant, 0u);
+	CHECK_EQ(wrapped.numConstants, 16u);
+	CHECK(wrapped.mapType == RenderMapType::WriteDiscard);
+	CHECK_EQ(allocator.GetHead(), 256u);
+	CHECK_EQ(allocator.GetGeneration(), generation + 1);
+
+	// 回绕之后继续追加
+	const Allocation next = Allocate(allocator, 300);
+	CHECK_EQ(next.firstConstant, 16u);
+	CHECK(next.mapType == RenderMapType::WriteNoOverwrite);
+	CHECK_EQ(allocator.GetGeneration(), generation + 1);
+}
+
+TEST_CASE(GenerationChangesExactlyWhenPreviousAllocationsBecomeInvalid)
+{
+	// 与Apply中重新写入的判断相同: 同一代中的分配互不重叠,代数变化时才需要重新写入
+	ConstantBufferAllocator allocator(64 * 1024);
+	std::mt19937 rng(48);
+	std::uniform_int_distribution<UINT> size(1, 4096);
+
+	UINT generation = allocator.GetGeneration();
+	UINT generationEnd = 0;
+	UINT discards = 0;
+	for (int i = 0; i < 10000; ++i)
+	{
+		const Allocation allocation = Allocate(allocator, size(rng));
+		if (allocation.mapType == RenderMapType::WriteDiscard)
+			++discards;
+
+		if (allocator.GetGeneration() != generation)
+		{
+			CHECK_EQ(allocator.GetGeneration(), generation + 1);
+			CHECK(allocation.mapType == RenderMapType::WriteDiscard);
+			CHECK_EQ(allocation.firstConstant, 0u);
+			generation = allocator.GetGeneration();
+		}
+		else
+		{
+			// 紧接在同一代的上一次分配之后
+			CHECK_EQ(allocation.firstConstant * 16, generationEnd);
+		}
+		generationEnd = (allocation.firstConstant + allocation.numConstants) * 16;
+		CHECK_EQ(allocator.GetHead(), generationEnd);
+	}
+
+	// 除第一次分配外,每次丢弃都伴随一次回绕
+	CHECK_EQ(discards, allocator.GetGeneration() + 1);
+}
+
+TEST_CASE(ResetStartsNextCommandListWithDiscard)
+{
+	// 与EffectStateCache::BeginCommandList相同: 每个命令列表从头开始写入
+	ConstantBufferAllocator allocator(4096);
+	for (int commandList = 0; commandList < 3; ++commandList)
+	{
+		const UINT generation = allocator.GetGeneration();
+		allocator.Reset();
+		CHECK_EQ(allocator.GetHead(), 0u);
+		CHECK_EQ(allocator.GetGeneration(), generation + 1);
+
+		// 仍有剩余空间也丢弃原有数据,上一个命令列表写入的位置不再有效
+		const Allocation first = Allocate(allocator, 100);
+		CHECK_EQ(first.firstConstant, 0u);
+		CHECK(first.mapType == RenderMapType::WriteDiscard);
+
+		const Allocation second = Allocate(allocator, 100);
+		CHECK_EQ(second.firstConstant, 16u);
+		CHECK(second.mapType == RenderMapType::WriteNoOverwrite);
+		CHECK_EQ(allocator.GetGeneration(), generation + 1);
+	}
+}
+
+TEST_CASE(AllocationLargerThanArenaFails)
+{
+	ConstantBufferAllocator allocator(1024);
+	Allocate(allocator, 256);
+	const UINT generation = allocator.GetGeneration();
+
+	// 对齐后超过池的大小: 失败且不改变任何状态,不会无限回绕
+	Allocation allocation{ 7, 7, RenderMapType::WriteNoOverwrite };
+	CHECK(!allocator.Allocate(1025, &allocation));
+	CHECK(!allocator.Allocate(0xFFFFFFFFu, &allocation));
+	CHECK_EQ(allocation.firstConstant, 7u);
+	CHECK_EQ(allocator.GetHead(), 256u);
+	CHECK_EQ(allocator.GetGeneration(), generation);
+
+	// 恰好等于池的大小时回绕后占满整个池
+	const Allocation whole = Allocate(allocator, 1024);
+	CHECK_EQ(whole.firstConstant, 0u);
+	CHECK_EQ(whole.numConstants, 64u);
+	CHECK(whole.mapType == RenderMapType::WriteDiscard);
+	CHECK_EQ(allocator.GetGeneration(), generation + 1);
+
+	// 没有池时任何分配都失败
+	ConstantBufferAllocator empty;
+	CHECK(!empty.Allocate(1, &allocation));
+}
@@ -0,0 +1,160 @@
+#include "TestHarness.h"
+#include "ContinuousCollision.h"
+
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float ToiEpsilon = 1e-4f;
+
+	// 厚度只有0.1的薄墙,位于z = 0处
+	const BoundingBox ThinWall(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(2.0f, 2.0f, 0.05f));
+
+	// 逐个测试所有盒子得到的最早碰撞
+	SweepHit BruteForceSweep(const std::vector<BoundingBox>& boxes, FXMVECTOR start, FXMVECTOR end, const float radius)
+	{
+		SweepHit hit{ 1.0f, SweepHit::InvalidIndex, XMFLOAT3() };
+		for (UINT i = 0; i < static_cast<UINT>(boxes.size()); ++i)
+		{
+			float toi;
+			XMFLOAT3 normal;
+			if (ContinuousCollision::SweepSphereBox(start, end - start, radius, boxes[i], &toi, &normal, hit.toi) &&
+				(hit.index == SweepHit::InvalidIndex || toi < hit.toi))
+			{
+				hit = { toi, i, normal };
+			}
+		}
+		return hit;
+	}
+}
+
+TEST_CASE(FastSphereDoesNotTunnelThroughThinBox)
+{
+	// 一帧内移动20个单位,起点与终点都不与墙相交,离散检测会直接穿过
+	const XMVECTOR start = XMVectorSet(0.0f, 0.0f, -10.0f, 0.0f);
+	const XMVECTOR end = XMVectorSet(0.0f, 0.0f, 10.0f, 0.0f);
+	const float radius = 0.25f;
+	CHECK(!ThinWall.Intersects(BoundingSphere(XMFLOAT3(0.0f, 0.0f, -10.0f), radius)));
+	CHECK(!ThinWall.Intersects(BoundingSphere(XMFLOAT3(0.0f, 0.0f, 10.0f), radius)));
+
+	// 球心到达z = -0.05 - 0.25时接触
+	float toi;
+	XMFLOAT3 normal;
+	CHECK(ContinuousCollision::SweepSphereBox(start, end - start, radius, ThinWall, &toi, &normal));
+	CHECK_NEAR(toi, 9.7f / 20.0f, ToiEpsilon);
+	CHECK_NEAR(normal.x, 0.0f, ToiEpsilon);
+	CHECK_NEAR(normal.y, 0.0f, ToiEpsilon);
+	CHECK_NEAR(normal.z, -1.0f, ToiEpsilon);
+
+	// 场景中的同一面墙
+	ContinuousCollision ccd;
+	ccd.Build({ ThinWall });
+	SweepHit hit;
+	CHECK(ccd.SweepSphere(start, end, radius, &hit));
+	CHECK_EQ(hit.index, 0u);
+	CHECK_NEAR(hit.toi, 9.7f / 20.0f, ToiEpsilon);
+
+	// maxToi早于接触时间时不报告碰撞
+	CHECK(!ContinuousCollision::SweepSphereBox(start, end - start, radius, ThinWall, &toi, nullptr, 0.48f));
+}
+
+TEST_CASE(FastSphereGrazesThinBoxEdge)
+{
+	// 球心在x = 2.125处经过,只与x = 2处的棱接触: (0.125, z + 0.05)的长度等于半径
+	const XMVECTOR start = XMVectorSet(2.125f, 0.0f, -10.0f, 0.0f);
+	const XMVECTOR end = XMVectorSet(2.125f, 0.0f, 10.0f, 0.0f);
+	const float radius = 0.25f;
+	const float contactZ = -0.05f - std::sqrt(radius * radius - 0.125f * 0.125f);
+
+	float toi;
+	XMFLOAT3 normal;
+	CHECK(ContinuousCollision::SweepSphereBox(start, end - start, radius, ThinWall, &toi, &normal));
+	CHECK_NEAR(toi, (contactZ + 10.0f) / 20.0f, ToiEpsilon);
+	CHECK_NEAR(normal.x, 0.5f, 1e-3f);
+	CHECK_NEAR(normal.y, 0.0f, 1e-3f);
+	CHECK_NEAR(normal.z, -std::sqrt(0.75f), 1e-3f);
+
+	// 稍远一些就不会碰到棱,虽然线段穿过了按半径膨胀的AABB
+	CHECK(!ContinuousCollision::SweepSphereBox(XMVectorSet(2.2f, 2.2f, -10.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 20.0f, 0.0f),
+		radius, ThinWall, &toi));
+}
+
+TEST_CASE(FastBoxesDoNotTunnelThroughThinBox)
+{
+	// 平移的AABB
+	const BoundingBox moving(XMFLOAT3(0.5f, 0.0f, -10.0f), XMFLOAT3(0.5f, 0.5f, 0.5f));
+	float toi;
+	XMFLOAT3 normal;
+	CHECK(ContinuousCollision::SweepBoxBox(moving, XMVectorSet(0.0f, 0.0f, 20.0f, 0.0f), ThinWall, &toi, &normal));
+	CHECK_NEAR(toi, 9.45f / 20.0f, ToiEpsilon);
+	CHECK_NEAR(normal.z, -1.0f, ToiEpsilon);
+
+	// 不旋转的OBB用保守推进得到相同的TOI(误差在tolerance内,且不会越过接触点)
+	BoundingOrientedBox obbStart, obbEnd;
+	BoundingOrientedBox::CreateFromBoundingBox(obbStart, moving);
+	obbEnd = obbStart;
+	obbEnd.Center.z += 20.0f;
+	CHECK(ContinuousCollision::SweepOrientedBoxBox(obbStart, obbEnd, ThinWall, &toi, &normal));
+	CHECK(toi <= 9.45f / 20.0f + ToiEpsilon);
+	CHECK(toi >= (9.45f - 1e-3f) / 20.0f - ToiEpsilon);
+	CHECK_NEAR(normal.z, -1.0f, ToiEpsilon);
+
+	// 旋转着穿过薄墙
+	XMStoreFloat4(&obbEnd.Orientation, XMQuaternionRotationRollPitchYaw(0.0f, XM_PIDIV2, 0.0f));
+	CHECK(ContinuousCollision::SweepOrientedBoxBox(obbStart, obbEnd, ThinWall, &toi, &normal));
+	CHECK(toi > 0.4f);
+	CHECK(toi < 9.45f / 20.0f + ToiEpsilon);
+}
+
+TEST_CASE(SceneSweepMatchesBruteForce)
+{
+	std::mt19937 rng(9);
+	std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> extent(0.02f, 3.0f);
+
+	// 大量薄板,每个轴上都有一个很薄的方向
+	std::vector<BoundingBox> boxes(3000);
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		boxes[i].Center = XMFLOAT3(position(rng), position(rng), position(rng));
+		boxes[i].Extents = XMFLOAT3(extent(rng), extent(rng), extent(rng));
+		if (i % 3 == 0)
+			boxes[i].Extents.x = 0.02f;
+		else if (i % 3 == 1)
+			boxes[i].Extents.y = 0.02f;
+		else
+			boxes[i].Extents.z = 0.02f;
+	}
+
+	ContinuousCollision ccd;
+	ccd.Build(boxes);
+
+	std::vector<SweptSphere> spheres(500);
+	for (SweptSphere& sphere : spheres)
+	{
+		sphere.start = XMFLOAT3(position(rng), position(rng), position(rng));
+		sphere.end = XMFLOAT3(position(rng), position(rng), position(rng));
+		sphere.radius = 0.1f;
+	}
+
+	std::vector<SweepHit> hits(spheres.size());
+	const UINT hitCount = ccd.SweepSpheres(spheres.data(), static_cast<UINT>(spheres.size()), hits.data());
+
+	UINT expectedCount = 0;
+	for (size_t i = 0; i < spheres.size(); ++i)
+	{
+		const SweepHit expected = BruteForceSweep(boxes, XMLoadFloat3(&spheres[i].start), XMLoadFloat3(&spheres[i].end), spheres[i].radius);
+		CHECK_EQ(hits[i].index != SweepHit::InvalidIndex, expected.index != SweepHit::InvalidIndex);
+		if (expected.index != SweepHit::InvalidIndex)
+		{
+			++expectedCount;
+			CHECK_NEAR(hits[i].toi, expected.toi, ToiEpsilon);
+		}
+	}
+	CHECK_EQ(hitCount, expectedCount);
+	CHECK(hitCount > 0);
+	CHECK(hitCount < spheres.size());
+}
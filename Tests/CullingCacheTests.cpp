@@ -0,0 +1,196 @@
+#include "TestHarness.h"
+#include "CullingCache.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	XMMATRIX XM_CALLCONV ViewProj(FXMVECTOR eye, FXMVECTOR direction, const float farZ = 100.0f)
+	{
+		return XMMatrixLookToLH(eye, direction, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) *
+			XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 1.0f, farZ);
+	}
+
+	// 8个角点都位于同一条裁剪平面之外时不可见
+	bool XM_CALLCONV CornersVisible(const XMFLOAT3 (&corners)[BoundingBox::CORNER_COUNT], FXMMATRIX viewProj)
+	{
+		UINT outside[6] = {};
+		for (const XMFLOAT3& corner : corners)
+		{
+			XMFLOAT4 clip;
+			XMStoreFloat4(&clip, XMVector3Transform(XMLoadFloat3(&corner), viewProj));
+			outside[0] += clip.x < -clip.w;
+			outside[1] += clip.x > clip.w;
+			outside[2] += clip.y < -clip.w;
+			outside[3] += clip.y > clip.w;
+			outside[4] += clip.z < 0.0f;
+			outside[5] += clip.z > clip.w;
+		}
+		return std::none_of(std::begin(outside), std::end(outside), [](const UINT count) { return count == BoundingBox::CORNER_COUNT; });
+	}
+
+	// 缓存的结果必须介于两个参考结果之间:
+	// 实例真实的OBB可见时一定可见(保守),世界空间AABB不可见时一定不可见(包围球只会让结果更紧)
+	// 同时必须与一个刚构建、没有任何帧间信息的缓存完全一致
+	void XM_CALLCONV CheckCull(CullingCache& cache, const BoundingBox& localBox, const std::vector<XMFLOAT4X4>& worlds, FXMMATRIX viewProj)
+	{
+		const std::vector<UINT> visible = cache.Cull(viewProj);
+
+		CullingCache fresh;
+		fresh.Build(localBox, worlds);
+		CHECK(fresh.Cull(viewProj) == visible);
+
+		for (UINT i = 0; i < cache.GetInstanceCount(); ++i)
+		{
+			const bool isVisible = std::binary_search(visible.begin(), visible.end(), i);
+
+			XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+			localBox.GetCorners(corners);
+			for (XMFLOAT3& corner : corners)
+				XMStoreFloat3(&corner, XMVector3Transform(XMLoadFloat3(&corner), XMLoadFloat4x4(&worlds[i])));
+			if (CornersVisible(corners, viewProj))
+				CHECK(isVisible);
+
+			Bounds::ToBoundingBox(cache.GetWorldBox(i)).GetCorners(corners);
+			if (!CornersVisible(corners, viewProj))
+				CHECK(!isVisible);
+		}
+	}
+
+	std::vector<XMFLOAT4X4> RandomInstances(std::mt19937& rng, const UINT count)
+	{
+		std::uniform_real_distribution<float> position(-80.0f, 80.0f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> scale(0.5f, 3.0f);
+
+		std::vector<XMFLOAT4X4> worlds(count);
+		for (XMFLOAT4X4& world : worlds)
+		{
+			XMStoreFloat4x4(&world, XMMatrixScaling(scale(rng), scale(rng), scale(rng)) *
+				XMMatrixRotationRollPitchYaw(angle(rng), angle(rng), angle(rng)) *
+				XMMatrixTranslation(position(rng), position(rng) * 0.2f, position(rng)));
+		}
+		return worlds;
+	}
+
+	const BoundingBox LocalBox(XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 2.0f));
+}
+
+TEST_CASE(CullMatchesReferenceWhileCameraMoves)
+{
+	std::mt19937 rng(30);
+	const std::vector<XMFLOAT4X4> worlds = RandomInstances(rng, 3000);
+	CullingCache cache;
+	cache.Build(LocalBox, worlds);
+	CHECK_EQ(cache.GetInstanceCount(), 3000u);
+
+	// 摄像机绕y轴转动并前后移动,每一帧所有平面都会变化
+	for (int frame = 0; frame < 40; ++frame)
+	{
+		const float yaw = 0.15f * frame;
+		const XMMATRIX viewProj = ViewProj(XMVectorSet(0.0f, 2.0f, -10.0f + frame, 1.0f), XMVectorSet(std::sin(yaw), 0.0f, std::cos(yaw), 0.0f));
+		CheckCull(cache, LocalBox, worlds, viewProj);
+		CHECK(!cache.Cull(viewProj).empty());
+	}
+}
+
+TEST_CASE(UnchangedCameraReusesPreviousResult)
+{
+	std::mt19937 rng(31);
+	CullingCache cache;
+	cache.Build(LocalBox, RandomInstances(rng, 500));
+
+	const XMMATRIX viewProj = ViewProj(XMVectorSet(0.0f, 2.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f));
+	const std::vector<UINT> first = cache.Cull(viewProj);
+	CHECK(cache.GetStatistics().planeTests > 0u);
+	CHECK_EQ(cache.GetStatistics().reusedInstances, 0u);
+
+	// 命中: 摄像机与实例都没有变化,不进行任何平面测试
+	CHECK(cache.Cull(viewProj) == first);
+	CHECK_EQ(cache.GetStatistics().planeTests, 0u);
+	CHECK_EQ(cache.GetStatistics().reusedInstances, 500u);
+}
+
+TEST_CASE(ChangingOnlyFarPlaneRetestsOnlyFarPlane)
+{
+	std::mt19937 rng(32);
+	const std::vector<XMFLOAT4X4> worlds = RandomInstances(rng, 500);
+	CullingCache cache;
+	cache.Build(LocalBox, worlds);
+
+	const XMVECTOR eye = XMVectorSet(0.0f, 2.0f, -60.0f, 1.0f);
+	const XMVECTOR direction = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+	cache.Cull(ViewProj(eye, direction, 100.0f));
+
+	// 远平面拉近,只有远平面(以及数值上受影响的近平面)发生变化
+	// 可见实例只需重新测试变化的平面,被未变化的侧面拒绝的实例直接沿用结果
+	CheckCull(cache, LocalBox, worlds, ViewProj(eye, direction, 40.0f));
+	CHECK(cache.GetStatistics().reusedInstances > 0u);
+	CHECK(cache.GetStatistics().planeTests < 2u * cache.GetInstanceCount());
+
+	// 远平面恢复后,被远平面拒绝的实例从该平面开始重新测试
+	CheckCull(cache, LocalBox, worlds, ViewProj(eye, direction, 100.0f));
+}
+
+TEST_CASE(SetInstanceInvalidatesOnlyThatInstance)
+{
+	std::mt19937 rng(33);
+	std::vector<XMFLOAT4X4> worlds = RandomInstances(rng, 200);
+	CullingCache cache;
+	cache.Build(LocalBox, worlds);
+
+	const XMMATRIX viewProj = ViewProj(XMVectorSet(0.0f, 2.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f));
+	cache.Cull(viewProj);
+
+	// 未命中: 实例移到摄像机正前方,下一次剔除只测试该实例
+	XMStoreFloat4x4(&worlds[7], XMMatrixTranslation(0.0f, 2.0f, 20.0f));
+	cache.SetInstance(7, XMLoadFloat4x4(&worlds[7]));
+	std::vector<UINT> visible = cache.Cull(viewProj);
+	CHECK(std::find(visible.begin(), visible.end(), 7u) != visible.end());
+	CHECK(cache.GetStatistics().planeTests <= 6u);
+	CHECK_EQ(cache.GetStatistics().reusedInstances, 199u);
+
+	// 再移到摄像机后方
+	BasicTransform behind;
+	behind.SetPosition(0.0f, 2.0f, -20.0f);
+	XMStoreFloat4x4(&worlds[7], behind.GetLocalToWorldMatrix());
+	cache.SetInstance(7, behind);
+	visible = cache.Cull(viewProj);
+	CHECK(std::find(visible.begin(), visible.end(), 7u) == visible.end());
+	CheckCull(cache, LocalBox, worlds, viewProj);
+
+	// 包围体随实例变换更新
+	CHECK_NEAR(cache.GetWorldBox(7).center.z, -20.0f, 1e-4f);
+	CHECK_NEAR(cache.GetWorldSphere(7).center.y, 3.0f, 1e-4f);
+}
+
+TEST_CASE(RebuildResetsCachedResults)
+{
+	std::mt19937 rng(34);
+	CullingCache cache;
+	cache.Build(LocalBox, RandomInstances(rng, 300));
+
+	const XMMATRIX viewProj = ViewProj(XMVectorSet(0.0f, 2.0f, 0.0f, 1.0f), XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f));
+	cache.Cull(viewProj);
+
+	// 以相同的摄像机重新构建,所有实例都必须重新测试
+	// 沿视线方向排成一列,超出远平面(100)的实例不可见
+	std::vector<BasicTransform> transforms(120);
+	std::vector<XMFLOAT4X4> worlds(120);
+	for (UINT i = 0; i < 120; ++i)
+	{
+		transforms[i].SetPosition(5.0f + i, 1.0f, 0.0f);
+		XMStoreFloat4x4(&worlds[i], transforms[i].GetLocalToWorldMatrix());
+	}
+	cache.Build(LocalBox, transforms);
+	CHECK_EQ(cache.GetInstanceCount(), 120u);
+
+	CheckCull(cache, LocalBox, worlds, viewProj);
+	CHECK_EQ(cache.GetStatistics().reusedInstances, 0u);
+	const std::vector<UINT>& visible = cache.Cull(viewProj);
+	CHECK_EQ(visible.size(), 97u);
+	CHECK_EQ(visible.front(), 0u);
+}
@@ -0,0 +1,102 @@
+#include "TestHarness.h"
+#include "DebugLineBatch.h"
+
+#include <string>
+
+using namespace DirectX;
+
+namespace
+{
+	const XMFLOAT4 Red(1.0f, 0.0f, 0.0f, 1.0f);
+	const XMFLOAT4 Green(0.0f, 1.0f, 0.0f, 1.0f);
+
+	// 句柄只被比较与编号,不解引用,用一块内存中不同的地址代替D3D资源
+	struct FakeResources
+	{
+		template <typename T>
+		T* Get(const UINT index)
+		{
+			return reinterpret_cast<T*>(storage + index);
+		}
+
+		char storage[8];
+	};
+}
+
+TEST_CASE(ShapesAppendIndexedLineLists)
+{
+	DebugLineBatch batch(0, 0);
+	batch.AddLine(XMVectorZero(), XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), Red);
+	batch.AddBox(BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 2.0f, 3.0f)), Green);
+	batch.AddSphere(BoundingSphere(XMFLOAT3(0.0f, 0.0f, 0.0f), 1.0f), Red, 8);
+	CHECK_EQ(batch.GetVertexCount(), 2u + 8u + 24u);
+	CHECK_EQ(batch.GetIndexCount(), 2u + 24u + 48u);
+
+	// 每个图形的索引只引用自己的顶点
+	const std::vector<UINT>& indices = batch.GetIndices();
+	for (UINT i = 2; i < 26; ++i)
+		CHECK(indices[i] >= 2 && indices[i] < 10);
+	for (UINT i = 26; i < batch.GetIndexCount(); ++i)
+		CHECK(indices[i] >= 10 && indices[i] < 34);
+
+	const DebugLineBatch::Vertex& corner = batch.GetVertices()[2];
+	CHECK_NEAR(corner.pos.x, -1.0f, 1e-6f);
+	CHECK_NEAR(corner.pos.z, 3.0f, 1e-6f);
+	CHECK_NEAR(corner.color.y, 1.0f, 1e-6f);
+
+	batch.Clear();
+	CHECK_EQ(batch.GetVertexCount(), 0u);
+	CHECK_EQ(batch.GetIndexCount(), 0u);
+}
+
+TEST_CASE(BoundingVolumeHierarchyDrawsEveryNodeUpToMaxDepth)
+{
+	std::vector<BoundingBox> boxes;
+	for (int i = 0; i < 64; ++i)
+		boxes.emplace_back(XMFLOAT3(3.0f * i, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+	BoundingVolumeHierarchy bvh;
+	bvh.Build(boxes, 1);
+
+	DebugLineBatch batch(0, 0);
+	batch.AddBoundingVolumeHierarchy(bvh, Red, Green);
+	CHECK_EQ(batch.GetVertexCount(), static_cast<UINT>(bvh.GetNodes().size()) * 8);
+
+	// 只画根节点与第一层
+	batch.Clear();
+	batch.AddBoundingVolumeHierarchy(bvh, Red, Green, 1);
+	CHECK_EQ(batch.GetVertexCount(), 3u * 8u);
+}
+
+TEST_CASE(DrawUploadsOnceAndRestoresTriangleList)
+{
+	FakeResources resources;
+	RenderBuffer* vertexBuffer = resources.Get<RenderBuffer>(0);
+	RenderBuffer* indexBuffer = resources.Get<RenderBuffer>(1);
+	RenderEffect* effect = resources.Get<RenderEffect>(2);
+
+	DebugLineBatch batch(0, 0);
+	RecordingRenderBackend backend;
+	batch.Draw(backend, vertexBuffer, indexBuffer, effect);
+	CHECK(backend.GetCommands().empty());
+
+	batch.AddBox(BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), Red);
+	batch.AddBox(BoundingBox(XMFLOAT3(5.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), Red);
+	batch.Draw(backend, vertexBuffer, indexBuffer, effect);
+
+	const std::string expected =
+		"Map 1 0 0 448\n"
+		"Unmap 1\n"
+		"Map 2 0 0 192\n"
+		"Unmap 2\n"
+		"SetVertexBuffer 0 1 28 0\n"
+		"SetIndexBuffer 2 1 0\n"
+		"SetPrimitiveTopology 1\n"
+		"ApplyEffect 3\n"
+		"DrawIndexed 48 0 0\n"
+		"SetPrimitiveTopology 3\n";
+	CHECK(backend.ToString() == expected);
+	CHECK_EQ(backend.GetStatistics().bytesUploaded, 640u);
+
+	// Draw不清空,清空由调用者决定
+	CHECK_EQ(batch.GetIndexCount(), 48u);
+}
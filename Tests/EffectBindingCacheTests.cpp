@@ -0,0 +1,241 @@
+#include "TestHarness.h"
+#include "EffectBindingCache.h"
+
+#include <vector>
+
+namespace
+{
+	// 带引用计数的假对象,计数为0时视为已经释放
+	struct FakeObject
+	{
+		int refCount = 1;
+	};
+
+	// 与ComPtr相同的语义: 赋值时持有新对象的引用并释放原有的引用
+	class FakeReference
+	{
+	public:
+		FakeReference() = default;
+		~FakeReference() { Release(); }
+
+		FakeReference(const FakeReference&) = delete;
+		FakeReference& operator=(const FakeReference&) = delete;
+
+		FakeReference& operator=(FakeObject* pObject)
+		{
+			if (pObject)
+				++pObject->refCount;
+			Release();
+			m_pObject = pObject;
+			return *this;
+		}
+
+		FakeObject* Get() const { return m_pObject; }
+
+	private:
+		void Release()
+		{
+			if (m_pObject)
+				--m_pObject->refCount;
+			m_pObject = nullptr;
+		}
+
+		FakeObject* m_pObject = nullptr;
+	};
+
+	using Cache = EffectBindingCache<FakeObject, FakeReference>;
+
+	struct FakeStage
+	{
+		Cache::Stage stage;
+		FakeObject* pShader;
+		std::vector<FakeObject*> constantBuffers;		// 槽i绑定第i个元素
+		std::vector<UINT> firstConstants;
+		std::vector<FakeObject*> samplers;
+		std::vector<FakeObject*> shaderResources;
+	};
+
+	// 一个渲染通道需要的全部绑定,未使用的着色器阶段清空着色器
+	struct FakePass
+	{
+		std::vector<FakeStage> stages;
+		FakeObject* pRasterizerState;
+		FakeObject* pBlendState;
+		float blendFactor[4];
+		UINT sampleMask;
+		FakeObject* pDepthStencilState;
+		UINT stencilRef;
+	};
+
+	struct ApplyResult
+	{
+		UINT binds;
+		UINT elided;
+	};
+
+	// 与EffectPass::Apply相同的顺序经过缓存,统计实际需要的D3D调用与省略的调用
+	ApplyResult Apply(Cache& cache, const FakePass& pass)
+	{
+		ApplyResult result{};
+		auto count = [&result](bool needsBind) { ++(needsBind ? result.binds : result.elided); };
+
+		for (UINT s = 0; s < Cache::StageCount; ++s)
+		{
+			const Cache::Stage stage = static_cast<Cache::Stage>(s);
+			const FakeStage* pStage = nullptr;
+			for (const FakeStage& fakeStage : pass.stages)
+			{
+				if (fakeStage.stage == stage)
+					pStage = &fakeStage;
+			}
+
+			if (!pStage)
+			{
+				count(cache.SetShader(stage, nullptr));
+				continue;
+			}
+
+			count(cache.SetShader(stage, pStage->pShader));
+			for (UINT slot = 0; slot < pStage->constantBuffers.size(); ++slot)
+				count(cache.SetConstantBuffer(stage, slot, pStage->constantBuffers[slot], pStage->firstConstants[slot], 16));
+			for (UINT slot = 0; slot < pStage->samplers.size(); ++slot)
+				count(cache.SetSampler(stage, slot, pStage->samplers[slot]));
+			for (UINT slot = 0; slot < pStage->shaderResources.size(); ++slot)
+				count(cache.SetShaderResource(stage, slot, pStage->shaderResources[slot]));
+		}
+
+		count(cache.SetRasterizerState(pass.pRasterizerState));
+		count(cache.SetBlendState(pass.pBlendState, pass.blendFactor, pass.sampleMask));
+		count(cache.SetDepthStencilState(pass.pDepthStencilState, pass.stencilRef));
+		return result;
+	}
+
+	// 与BasicEffect的法线贴图通道类似: 顶点与像素着色器,两个常量缓冲区,一个采样器与三个纹理
+	struct Scene
+	{
+		Scene()
+		{
+			pass.stages.push_back({ Cache::StageVS, &vertexShader, { &frameBuffer, &objectBuffer }, { 0, 16 }, {}, {} });
+			pass.stages.push_back({ Cache::StagePS, &pixelShader, { &frameBuffer, &objectBuffer }, { 0, 16 }, { &sampler },
+				{ &diffuse, &normalMap, &shadowMap } });
+			pass.pRasterizerState = nullptr;
+			pass.pBlendState = &blendState;
+			for (float& factor : pass.blendFactor)
+				factor = 0.0f;
+			pass.sampleMask = 0xFFFFFFFF;
+			pass.pDepthStencilState = nullptr;
+			pass.stencilRef = 0;
+		}
+
+		FakeObject vertexShader, pixelShader;
+		FakeObject frameBuffer, objectBuffer;
+		FakeObject sampler;
+		FakeObject diffuse, normalMap, shadowMap;
+		FakeObject blendState;
+		FakePass pass;
+	};
+
+	// 6个着色器阶段,2 + 2 + 1 + 3个槽,3个渲染状态
+	constexpr UINT PassBindingCount = 6 + 8 + 3;
+}
+
+TEST_CASE(ReapplyingSamePassElidesEveryBind)
+{
+	Scene scene;
+	Cache cache;
+
+	// 状态未知,第一次全部需要设置(包括清空未使用的着色器阶段与nullptr渲染状态)
+	const ApplyResult first = Apply(cache, scene.pass);
+	CHECK_EQ(first.binds, PassBindingCount);
+	CHECK_EQ(first.elided, 0u);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		const ApplyResult again = Apply(cache, scene.pass);
+		CHECK_EQ(again.binds, 0u);
+		CHECK_EQ(again.elided, PassBindingCount);
+	}
+}
+
+TEST_CASE(ChangedSlotRebindsOnlyThatSlot)
+{
+	Scene scene;
+	Cache cache;
+	Apply(cache, scene.pass);
+
+	// 换一张漫反射纹理
+	FakeObject otherDiffuse;
+	scene.pass.stages[1].shaderResources[0] = &otherDiffuse;
+	ApplyResult result = Apply(cache, scene.pass);
+	CHECK_EQ(result.binds, 1u);
+	CHECK_EQ(result.elided, PassBindingCount - 1);
+
+	// 常量缓冲区池中的另一段: 缓冲区相同,起始常量不同
+	scene.pass.stages[0].firstConstants[1] = 32;
+	result = Apply(cache, scene.pass);
+	CHECK_EQ(result.binds, 1u);
+
+	// 只有混合系数变化
+	scene.pass.blendFactor[3] = 0.5f;
+	result = Apply(cache, scene.pass);
+	CHECK_EQ(result.binds, 1u);
+
+	// 只有模板参考值变化
+	scene.pass.stencilRef = 1;
+	result = Apply(cache, scene.pass);
+	CHECK_EQ(result.binds, 1u);
+
+	// 另一个只使用顶点着色器的通道: 像素着色器阶段被清空,之后恢复时重新设置像素着色器
+	FakePass depthOnly = scene.pass;
+	depthOnly.stages.pop_back();
+	result = Apply(cache, depthOnly);
+	CHECK_EQ(result.binds, 1u);
+	result = Apply(cache, scene.pass);
+	CHECK_EQ(result.binds, 1u);
+	CHECK_EQ(Apply(cache, scene.pass).binds, 0u);
+}
+
+TEST_CASE(InvalidateForcesFullRebind)
+{
+	Scene scene;
+	Cache cache;
+	Apply(cache, scene.pass);
+	CHECK_EQ(Apply(cache, scene.pass).binds, 0u);
+
+	// 例如Dear ImGui直接修改了设备上下文的状态
+	cache.Invalidate();
+	const ApplyResult result = Apply(cache, scene.pass);
+	CHECK_EQ(result.binds, PassBindingCount);
+	CHECK_EQ(result.elided, 0u);
+	CHECK_EQ(Apply(cache, scene.pass).binds, 0u);
+}
+
+TEST_CASE(RecordedObjectsAreKeptAlive)
+{
+	Scene scene;
+	Cache cache;
+	Apply(cache, scene.pass);
+
+	// 缓存持有每个绑定对象的一个引用,同一对象绑定在多个槽时持有多个
+	CHECK_EQ(scene.diffuse.refCount, 2);
+	CHECK_EQ(scene.frameBuffer.refCount, 3);
+
+	// 使用者释放了纹理,缓存的引用使它不会被销毁,它的地址也就不会被新纹理复用而被误认为已经绑定
+	FakeObject* pTexture = new FakeObject;
+	scene.pass.stages[1].shaderResources[0] = pTexture;
+	CHECK_EQ(Apply(cache, scene.pass).binds, 1u);
+	--pTexture->refCount;
+	CHECK_EQ(pTexture->refCount, 1);
+	CHECK_EQ(scene.diffuse.refCount, 1);
+
+	// 槽被其它对象替换或缓存失效后才释放引用
+	scene.pass.stages[1].shaderResources[0] = &scene.diffuse;
+	CHECK_EQ(Apply(cache, scene.pass).binds, 1u);
+	CHECK_EQ(pTexture->refCount, 0);
+	delete pTexture;
+
+	cache.Invalidate();
+	CHECK_EQ(scene.diffuse.refCount, 1);
+	CHECK_EQ(scene.frameBuffer.refCount, 1);
+	CHECK_EQ(scene.blendState.refCount, 1);
+}
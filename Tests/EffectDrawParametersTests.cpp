@@ -0,0 +1,270 @@
+#include "TestHarness.h"
+#include "EffectDrawParameters.h"
+#include "PortableTypes.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// 替代IEffectTransform与IEffectTextureDiffuse,用于重现原先按dynamic_cast分派的绘制路径
+	class TransformSetter
+	{
+	public:
+		virtual ~TransformSetter() = default;
+		virtual void XM_CALLCONV SetWorldMatrix(FXMMATRIX world) const = 0;
+	};
+
+	class TextureDiffuseSetter
+	{
+	public:
+		virtual ~TextureDiffuseSetter() = default;
+		virtual void SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const = 0;
+	};
+
+	// 特效最终收到的状态与每个设置函数被调用的次数
+	struct EffectState
+	{
+		const Material* material = nullptr;
+		ID3D11ShaderResourceView* textureDiffuse = nullptr;
+		ID3D11ShaderResourceView* textureNormalMap = nullptr;
+		XMFLOAT4X4 world{};
+		UINT worldSets = 0;
+		UINT materialSets = 0;
+		UINT textureDiffuseSets = 0;
+		UINT textureNormalMapSets = 0;
+
+		bool operator==(const EffectState& other) const
+		{
+			return material == other.material && textureDiffuse == other.textureDiffuse && textureNormalMap == other.textureNormalMap &&
+				std::memcmp(&world, &other.world, sizeof(world)) == 0 &&
+				worldSets == other.worldSets && materialSets == other.materialSets &&
+				textureDiffuseSets == other.textureDiffuseSets && textureNormalMapSets == other.textureNormalMapSets;
+		}
+	};
+
+	class RecordingEffect : public IEffectDrawParameters
+	{
+	public:
+		mutable EffectState state;
+	};
+
+	// 与MinimapEffect/ScreenFadeEffect相同: 不需要任何绘制参数
+	class PlainEffect final : public RecordingEffect
+	{
+	};
+
+	// 与SkyEffect相同: 只需要世界矩阵
+	class TransformEffect final : public RecordingEffect, public TransformSetter
+	{
+	public:
+		void XM_CALLCONV SetWorldMatrix(FXMMATRIX world) const override
+		{
+			XMStoreFloat4x4(&state.world, world);
+			++state.worldSets;
+		}
+
+		void XM_CALLCONV SetDrawParameters(const EffectDrawParameters&, FXMMATRIX world) const override
+		{
+			SetWorldMatrix(world);
+		}
+	};
+
+	// 与ShadowEffect/DebugEffect相同: 世界矩阵与漫反射纹理
+	class TransformTextureEffect final : public RecordingEffect, public TransformSetter, public TextureDiffuseSetter
+	{
+	public:
+		void XM_CALLCONV SetWorldMatrix(FXMMATRIX world) const override
+		{
+			XMStoreFloat4x4(&state.world, world);
+			++state.worldSets;
+		}
+
+		void SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const override
+		{
+			state.textureDiffuse = textureDiffuse;
+			++state.textureDiffuseSets;
+		}
+
+		void XM_CALLCONV SetDrawParameters(const EffectDrawParameters& parameters, FXMMATRIX world) const override
+		{
+			SetWorldMatrix(world);
+			SetInstancedDrawParameters(parameters);
+		}
+
+		void SetInstancedDrawParameters(const EffectDrawParameters& parameters) const override
+		{
+			SetTextureDiffuse(parameters.textureDiffuse);
+		}
+	};
+
+	// 与BasicEffect相同: 使用全部参数
+	class FullEffect final : public RecordingEffect, public TransformSetter, public TextureDiffuseSetter
+	{
+	public:
+		void XM_CALLCONV SetWorldMatrix(FXMMATRIX world) const override
+		{
+			XMStoreFloat4x4(&state.world, world);
+			++state.worldSets;
+		}
+
+		void SetTextureDiffuse(ID3D11ShaderResourceView* textureDiffuse) const override
+		{
+			state.textureDiffuse = textureDiffuse;
+			++state.textureDiffuseSets;
+		}
+
+		void SetMaterial(const Material& material) const
+		{
+			state.material = &material;
+			++state.materialSets;
+		}
+
+		void SetTextureNormalMap(ID3D11ShaderResourceView* textureNormalMap) const
+		{
+			state.textureNormalMap = textureNormalMap;
+			++state.textureNormalMapSets;
+		}
+
+		void XM_CALLCONV SetDrawParameters(const EffectDrawParameters& parameters, FXMMATRIX world) const override
+		{
+			SetWorldMatrix(world);
+			SetInstancedDrawParameters(parameters);
+		}
+
+		void SetInstancedDrawParameters(const EffectDrawParameters& parameters) const override
+		{
+			SetMaterial(*parameters.material);
+			SetTextureDiffuse(parameters.textureDiffuse);
+			SetTextureNormalMap(parameters.textureNormalMap);
+		}
+	};
+
+	// 原先GameObject::DrawParts对每个模型部分的分派方式
+	void XM_CALLCONV CastDispatch(RecordingEffect* effect, const EffectDrawParameters& parameters, FXMMATRIX world)
+	{
+		if (const auto* pFullEffect = dynamic_cast<FullEffect*>(effect))
+		{
+			pFullEffect->SetTextureNormalMap(parameters.textureNormalMap);
+			pFullEffect->SetMaterial(*parameters.material);
+			pFullEffect->SetWorldMatrix(world);
+			pFullEffect->SetTextureDiffuse(parameters.textureDiffuse);
+			return;
+		}
+		if (const auto* pTransform = dynamic_cast<TransformSetter*>(effect))
+			pTransform->SetWorldMatrix(world);
+		if (const auto* pTextureDiffuse = dynamic_cast<TextureDiffuseSetter*>(effect))
+			pTextureDiffuse->SetTextureDiffuse(parameters.textureDiffuse);
+	}
+
+	// 原先GameObject::DrawInstancedParts的分派方式,世界矩阵来自实例缓冲区
+	void CastDispatchInstanced(RecordingEffect* effect, const EffectDrawParameters& parameters)
+	{
+		if (const auto* pFullEffect = dynamic_cast<FullEffect*>(effect))
+		{
+			pFullEffect->SetTextureNormalMap(parameters.textureNormalMap);
+			pFullEffect->SetMaterial(*parameters.material);
+			pFullEffect->SetTextureDiffuse(parameters.textureDiffuse);
+			return;
+		}
+		if (const auto* pTextureDiffuse = dynamic_cast<TextureDiffuseSetter*>(effect))
+			pTextureDiffuse->SetTextureDiffuse(parameters.textureDiffuse);
+	}
+
+	struct Part
+	{
+		EffectDrawParameters parameters;
+		XMFLOAT4X4 world;
+	};
+
+	// 随机的材质、纹理与世界矩阵,纹理只比较指针,用一块内存中不同的地址代替
+	std::vector<Part> RandomParts(const UINT count, const Material* materials, char* textures)
+	{
+		std::mt19937 rng(44);
+		std::vector<Part> parts(count);
+		for (Part& part : parts)
+		{
+			part.parameters.material = &materials[rng() % 4];
+			part.parameters.textureDiffuse = reinterpret_cast<ID3D11ShaderResourceView*>(textures + rng() % 8);
+			part.parameters.textureNormalMap = rng() % 2 ? reinterpret_cast<ID3D11ShaderResourceView*>(textures + 8 + rng() % 8) : nullptr;
+			XMStoreFloat4x4(&part.world, XMMatrixTranslation(static_cast<float>(rng() % 100), 0.0f, static_cast<float>(rng() % 100)));
+		}
+		return parts;
+	}
+
+	template <typename Effect>
+	void CheckParametersMatchCasts(const std::vector<Part>& parts)
+	{
+		Effect byCast;
+		Effect byParameters;
+		for (const Part& part : parts)
+		{
+			const XMMATRIX world = XMLoadFloat4x4(&part.world);
+			CastDispatch(&byCast, part.parameters, world);
+			// 绘制路径只持有IEffect,通过基类调用
+			static_cast<const IEffectDrawParameters&>(byParameters).SetDrawParameters(part.parameters, world);
+			CHECK(byCast.state == byParameters.state);
+		}
+
+		Effect instancedByCast;
+		Effect instancedByParameters;
+		for (const Part& part : parts)
+		{
+			CastDispatchInstanced(&instancedByCast, part.parameters);
+			static_cast<const IEffectDrawParameters&>(instancedByParameters).SetInstancedDrawParameters(part.parameters);
+			CHECK(instancedByCast.state == instancedByParameters.state);
+		}
+		// 实例绘制不会设置世界矩阵
+		CHECK_EQ(instancedByParameters.state.worldSets, 0u);
+	}
+}
+
+TEST_CASE(ParameterBlockMatchesCastDispatch)
+{
+	const Material materials[4]{};
+	char textures[16];
+	const std::vector<Part> parts = RandomParts(200, materials, textures);
+
+	CheckParametersMatchCasts<PlainEffect>(parts);
+	CheckParametersMatchCasts<TransformEffect>(parts);
+	CheckParametersMatchCasts<TransformTextureEffect>(parts);
+	CheckParametersMatchCasts<FullEffect>(parts);
+}
+
+TEST_CASE(EffectsReadOnlyTheParametersTheyUse)
+{
+	const Material material{};
+	char textures[2];
+	const EffectDrawParameters parameters{ &material, reinterpret_cast<ID3D11ShaderResourceView*>(textures), reinterpret_cast<ID3D11ShaderResourceView*>(textures + 1) };
+	const XMMATRIX world = XMMatrixTranslation(1.0f, 2.0f, 3.0f);
+
+	PlainEffect plain;
+	plain.SetDrawParameters(parameters, world);
+	plain.SetInstancedDrawParameters(parameters);
+	CHECK(plain.state == EffectState{});
+
+	TransformEffect transform;
+	transform.SetDrawParameters(parameters, world);
+	transform.SetInstancedDrawParameters(parameters);
+	CHECK_EQ(transform.state.worldSets, 1u);
+	CHECK_EQ(transform.state.textureDiffuseSets, 0u);
+	CHECK_NEAR(transform.state.world._42, 2.0f, 1e-6f);
+
+	TransformTextureEffect transformTexture;
+	transformTexture.SetDrawParameters(parameters, world);
+	CHECK_EQ(transformTexture.state.worldSets, 1u);
+	CHECK(transformTexture.state.textureDiffuse == parameters.textureDiffuse);
+	CHECK_EQ(transformTexture.state.materialSets, 0u);
+	CHECK(transformTexture.state.textureNormalMap == nullptr);
+
+	FullEffect full;
+	full.SetDrawParameters(parameters, world);
+	CHECK_EQ(full.state.worldSets, 1u);
+	CHECK(full.state.material == &material);
+	CHECK(full.state.textureDiffuse == parameters.textureDiffuse);
+	CHECK(full.state.textureNormalMap == parameters.textureNormalMap);
+	CHECK_NEAR(full.state.world._43, 3.0f, 1e-6f);
+}
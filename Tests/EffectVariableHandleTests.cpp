@@ -0,0 +1,162 @@
+#include "TestHarness.h"
+#include "EffectVariableHandle.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+using namespace DirectX;
+
+// 统计堆分配次数,句柄写入期间不应当有任何分配
+static std::atomic<size_t> g_allocationCount{ 0 };
+
+void* operator new(const size_t size)
+{
+	++g_allocationCount;
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace
+{
+	// 一个常量缓冲区的暂存数据与脏标记,变量按16字节对齐排列
+	struct StagingBuffer
+	{
+		EffectVariableHandle GetHandle(const UINT byteOffset, const UINT byteWidth)
+		{
+			return { data + byteOffset, &isDirty, byteWidth };
+		}
+
+		BYTE data[256]{};
+		BOOL isDirty = false;
+	};
+
+	bool IsFilledWith(const BYTE* data, const UINT byteCount, const BYTE value)
+	{
+		for (UINT i = 0; i < byteCount; ++i)
+		{
+			if (data[i] != value)
+				return false;
+		}
+		return true;
+	}
+}
+
+static_assert(std::is_trivially_copyable<EffectVariableHandle>::value, "EffectVariableHandle must stay trivially copyable");
+
+TEST_CASE(WritesLandAtTheVariableOffset)
+{
+	StagingBuffer buffer;
+	const EffectVariableHandle eyePos = buffer.GetHandle(64, 12);
+	const EffectVariableHandle textureUsed = buffer.GetHandle(76, 4);
+
+	const float position[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+	eyePos.SetFloatVector(4, position);
+	CHECK(buffer.isDirty);
+	float stored[3];
+	std::memcpy(stored, buffer.data + 64, sizeof(stored));
+	CHECK_EQ(stored[0], 1.0f);
+	CHECK_EQ(stored[2], 3.0f);
+	// 第四个分量超出变量大小被截断,不会覆盖相邻的变量
+	CHECK(IsFilledWith(buffer.data + 76, 4, 0));
+	CHECK(IsFilledWith(buffer.data, 64, 0));
+
+	textureUsed.SetUInt(0x01020304);
+	UINT used;
+	std::memcpy(&used, buffer.data + 76, sizeof(used));
+	CHECK_EQ(used, 0x01020304u);
+	std::memcpy(stored, buffer.data + 64, sizeof(stored));
+	CHECK_EQ(stored[2], 3.0f);
+}
+
+TEST_CASE(UnchangedValuesDoNotDirtyTheBuffer)
+{
+	StagingBuffer buffer;
+	const EffectVariableHandle world = buffer.GetHandle(0, 64);
+	const XMMATRIX matrix = XMMatrixTranslation(1.0f, 2.0f, 3.0f);
+
+	world.SetMatrix(matrix);
+	CHECK(buffer.isDirty);
+
+	// 上传后清除脏标记,再次写入相同的值
+	buffer.isDirty = false;
+	world.SetMatrix(matrix);
+	CHECK(!buffer.isDirty);
+
+	world.SetMatrix(XMMatrixTranslation(1.0f, 2.0f, 4.0f));
+	CHECK(buffer.isDirty);
+	XMFLOAT4X4 stored;
+	std::memcpy(&stored, buffer.data, sizeof(stored));
+	CHECK_EQ(stored._43, 4.0f);
+}
+
+TEST_CASE(RangesAreClampedToTheVariable)
+{
+	StagingBuffer buffer;
+	std::memset(buffer.data, 0xAB, sizeof(buffer.data));
+	const EffectVariableHandle light = buffer.GetHandle(32, 16);
+
+	const BYTE zeros[32]{};
+	// 从第8个字节开始写入,只剩下8个字节
+	light.SetRaw(zeros, 8, sizeof(zeros));
+	CHECK(IsFilledWith(buffer.data + 32, 8, 0xAB));
+	CHECK(IsFilledWith(buffer.data + 40, 8, 0));
+	CHECK(IsFilledWith(buffer.data + 48, 16, 0xAB));
+
+	// 偏移超出变量时忽略
+	buffer.isDirty = false;
+	light.SetRaw(zeros, 17, 4);
+	CHECK(!buffer.isDirty);
+	CHECK(IsFilledWith(buffer.data + 48, 16, 0xAB));
+}
+
+TEST_CASE(InvalidAndCopiedHandles)
+{
+	// 解析失败得到的句柄可以安全地写入
+	const EffectVariableHandle invalid{};
+	CHECK(!invalid.IsValid());
+	invalid.SetFloat(1.0f);
+	invalid.SetMatrix(XMMatrixIdentity());
+
+	// 拷贝的句柄指向同一份暂存数据
+	StagingBuffer buffer;
+	const EffectVariableHandle handle = buffer.GetHandle(16, 4);
+	const EffectVariableHandle copy = handle;
+	CHECK(copy.IsValid());
+	copy.SetSInt(-7);
+	INT value;
+	std::memcpy(&value, buffer.data + 16, sizeof(value));
+	CHECK_EQ(value, -7);
+	CHECK(buffer.isDirty);
+}
+
+TEST_CASE(PerFrameWritesDoNotAllocate)
+{
+	StagingBuffer buffer;
+	const EffectVariableHandle world = buffer.GetHandle(0, 64);
+	const EffectVariableHandle eyePos = buffer.GetHandle(64, 12);
+	const EffectVariableHandle textureUsed = buffer.GetHandle(76, 4);
+
+	const size_t allocations = g_allocationCount.load();
+	for (UINT frame = 0; frame < 1000; ++frame)
+	{
+		const float position[4] = { static_cast<float>(frame), 0.0f, 1.0f, 0.0f };
+		world.SetMatrix(XMMatrixTranslation(static_cast<float>(frame), 0.0f, 0.0f));
+		eyePos.SetFloatVector(3, position);
+		textureUsed.SetUInt(frame & 1);
+	}
+	CHECK_EQ(g_allocationCount.load(), allocations);
+}
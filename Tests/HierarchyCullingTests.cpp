@@ -0,0 +1,266 @@
+#include "TestHarness.h"
+#include "HierarchyCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// 与GameObject提供相同接口的节点
+	struct Node
+	{
+		const BasicTransform& GetTransform() const { return transform; }
+		const std::vector<Node*>& GetChildren() const { return children; }
+		bool HasLocalBoundingBox() const { return hasBox; }
+		BoundingBox GetLocalBoundingBox() const { return localBox; }
+		HierarchyBounds& GetHierarchyBounds() { return bounds; }
+
+		BasicTransform transform{ { 1.0f, 1.0f, 1.0f }, {}, {} };
+		std::vector<Node*> children;
+		bool hasBox = true;
+		BoundingBox localBox{ XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.5f, 0.5f, 0.5f) };
+		HierarchyBounds bounds;
+	};
+
+	// 与坦克相同的结构: 车身下有若干面,炮台下有炮管,车身两侧各有若干轮子
+	// 中间节点没有模型,只负责传递变换
+	struct Tank
+	{
+		Tank()
+		{
+			nodes.reserve(24);
+			root = Add(nullptr, XMFLOAT3(0.0f, 0.0f, 0.0f), false);
+			Node* body = Add(root, XMFLOAT3(0.0f, 1.0f, 0.0f), true);
+			for (int i = 0; i < 6; ++i)
+				Add(body, XMFLOAT3(0.0f, 0.2f * i, 0.0f), true);
+			Node* battery = Add(root, XMFLOAT3(0.0f, 2.0f, 0.0f), true);
+			Add(battery, XMFLOAT3(0.0f, 0.0f, 2.0f), true);
+			Node* wheels = Add(root, XMFLOAT3(0.0f, 0.5f, 0.0f), false);
+			for (int i = 0; i < 12; ++i)
+				Add(wheels, XMFLOAT3(i % 2 ? 1.5f : -1.5f, 0.0f, 0.5f * (i / 2) - 1.25f), true);
+		}
+
+		Node* Add(Node* parent, const XMFLOAT3& position, const bool hasBox)
+		{
+			nodes.push_back(std::make_unique<Node>());
+			Node* node = nodes.back().get();
+			node->transform.SetPosition(position);
+			node->hasBox = hasBox;
+			if (parent)
+				parent->children.push_back(node);
+			return node;
+		}
+
+		UINT GetNodeCount() const { return static_cast<UINT>(nodes.size()); }
+
+		std::vector<std::unique_ptr<Node>> nodes;
+		Node* root;
+	};
+
+	BoundingFrustum XM_CALLCONV MakeFrustum(FXMVECTOR eye, FXMVECTOR direction)
+	{
+		BoundingFrustum frustum(XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.5f, 200.0f));
+		const XMMATRIX view = XMMatrixLookToLH(eye, direction, g_XMIdentityR1);
+		frustum.Transform(frustum, XMMatrixInverse(nullptr, view));
+		return frustum;
+	}
+
+	struct DrawRecorder
+	{
+		void operator()(Node& node, FXMMATRIX world)
+		{
+			drawn.push_back(&node);
+			XMFLOAT4X4 matrix;
+			XMStoreFloat4x4(&matrix, world);
+			worlds.push_back(matrix);
+		}
+
+		std::vector<Node*> drawn;
+		std::vector<XMFLOAT4X4> worlds;
+	};
+
+	// 以递归方式直接组合矩阵,作为世界矩阵的参考结果
+	void XM_CALLCONV ReferenceWorlds(const Node& node, FXMMATRIX parentScale, CXMMATRIX parentRotTraMatrix, std::vector<std::pair<const Node*, XMFLOAT4X4>>& out)
+	{
+		const XMMATRIX scale = XMMatrixScalingFromVector(node.transform.GetScaleVector());
+		const XMMATRIX rotationTranslation = XMMatrixRotationQuaternion(node.transform.GetRotationQuaternion()) *
+			XMMatrixTranslationFromVector(node.transform.GetPositionVector());
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, scale * parentScale * rotationTranslation * parentRotTraMatrix);
+		out.emplace_back(&node, world);
+		for (const Node* child : node.children)
+			ReferenceWorlds(*child, scale * scale, rotationTranslation * parentRotTraMatrix, out);
+	}
+
+	bool NearEqual(const XMFLOAT4X4& lhs, const XMFLOAT4X4& rhs)
+	{
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				if (std::fabs(lhs.m[i][j] - rhs.m[i][j]) > 1e-4f)
+					return false;
+		return true;
+	}
+}
+
+TEST_CASE(OffscreenTankCullsWholeTreeWithOneTest)
+{
+	Tank tank;
+	HierarchyCulling<Node>::UpdateBounds(*tank.root, XMMatrixIdentity(), XMMatrixIdentity());
+	CHECK_EQ(tank.root->bounds.subtreeNodeCount, tank.GetNodeCount());
+
+	// 摄像机背对坦克
+	const BoundingFrustum frustum = MakeFrustum(XMVectorSet(0.0f, 2.0f, -20.0f, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f));
+	HierarchyCullStatistics statistics{};
+	DrawRecorder recorder;
+	HierarchyCulling<Node>::Cull(*tank.root, frustum, false, &statistics, recorder);
+
+	CHECK(recorder.drawn.empty());
+	CHECK_EQ(statistics.testedNodes, 1u);
+	CHECK_EQ(statistics.acceptedNodes, 0u);
+	CHECK_EQ(statistics.culledNodes, tank.GetNodeCount());
+}
+
+TEST_CASE(FullyVisibleTankIsAcceptedAtTheRoot)
+{
+	Tank tank;
+	HierarchyCulling<Node>::UpdateBounds(*tank.root, XMMatrixIdentity(), XMMatrixIdentity());
+
+	const BoundingFrustum frustum = MakeFrustum(XMVectorSet(0.0f, 2.0f, -20.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f));
+	HierarchyCullStatistics statistics{};
+	DrawRecorder recorder;
+	HierarchyCulling<Node>::Cull(*tank.root, frustum, false, &statistics, recorder);
+
+	// 根节点完全可见,子树不再测试,所有节点都按先序被绘制
+	CHECK_EQ(recorder.drawn.size(), static_cast<size_t>(tank.GetNodeCount()));
+	CHECK_EQ(statistics.testedNodes, 1u);
+	CHECK_EQ(statistics.acceptedNodes, 1u);
+	CHECK_EQ(statistics.culledNodes, 0u);
+
+	// 绘制使用的世界矩阵与直接递归组合的结果一致
+	std::vector<std::pair<const Node*, XMFLOAT4X4>> expected;
+	ReferenceWorlds(*tank.root, XMMatrixIdentity(), XMMatrixIdentity(), expected);
+	CHECK_EQ(expected.size(), recorder.drawn.size());
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		CHECK(expected[i].first == recorder.drawn[i]);
+		CHECK(NearEqual(expected[i].second, recorder.worlds[i]));
+	}
+}
+
+TEST_CASE(PartiallyVisibleTreeDrawsExactlyIntersectingSubtrees)
+{
+	// 随机树: 每个节点只有在自身子树的包围盒与视锥体相交时才被绘制
+	std::mt19937 rng(33);
+	std::uniform_real_distribution<float> offset(-6.0f, 6.0f);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+	std::uniform_int_distribution<int> coin(0, 3);
+
+	std::vector<std::unique_ptr<Node>> nodes;
+	nodes.push_back(std::make_unique<Node>());
+	for (int i = 1; i < 300; ++i)
+	{
+		std::uniform_int_distribution<int> pickParent(0, i - 1);
+		Node* parent = nodes[pickParent(rng)].get();
+		nodes.push_back(std::make_unique<Node>());
+		Node* node = nodes.back().get();
+		node->transform.SetPosition(offset(rng), offset(rng) * 0.3f, offset(rng));
+		node->transform.SetRotation(0.0f, angle(rng), 0.0f);
+		node->hasBox = coin(rng) != 0;
+		parent->children.push_back(node);
+	}
+	Node& root = *nodes[0];
+	HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity());
+	CHECK_EQ(root.bounds.subtreeNodeCount, 300u);
+
+	for (int frame = 0; frame < 8; ++frame)
+	{
+		const float yaw = XM_PIDIV4 * frame;
+		const BoundingFrustum frustum = MakeFrustum(XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f), XMVectorSet(std::sin(yaw), 0.0f, std::cos(yaw), 0.0f));
+
+		HierarchyCullStatistics statistics{};
+		DrawRecorder recorder;
+		HierarchyCulling<Node>::Cull(root, frustum, false, &statistics, recorder);
+
+		UINT expectedDrawn = 0;
+		for (const auto& node : nodes)
+		{
+			// 子树中没有模型的节点不参与测试,与其父节点的结果相同,这里只检查带包围盒的子树
+			if (!node->bounds.hasSubtreeBox)
+				continue;
+			const bool isDrawn = std::find(recorder.drawn.begin(), recorder.drawn.end(), node.get()) != recorder.drawn.end();
+			CHECK_EQ(isDrawn, frustum.Intersects(node->bounds.subtreeBox));
+			expectedDrawn += isDrawn ? 1 : 0;
+		}
+		CHECK(expectedDrawn > 0u);
+		CHECK(expectedDrawn < 300u);
+		CHECK_EQ(static_cast<UINT>(recorder.drawn.size()) + statistics.culledNodes, 300u);
+		CHECK(statistics.testedNodes < 300u);
+	}
+}
+
+TEST_CASE(UpdateBoundsOnlyReportsChangedSubtrees)
+{
+	Tank tank;
+	Node& root = *tank.root;
+	CHECK(HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity()));
+	// 没有任何变化
+	CHECK(!HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity()));
+
+	// 只移动炮管: 炮管、炮台与根节点的包围盒变大,车身不受影响
+	Node& battery = *root.children[1];
+	Node& barrel = *battery.children[0];
+	Node& body = *root.children[0];
+	const BoundingBox bodyBox = body.bounds.subtreeBox;
+	barrel.transform.SetPosition(0.0f, 0.0f, 10.0f);
+	CHECK(HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity()));
+
+	CHECK_NEAR(barrel.bounds.subtreeBox.Center.z, 10.0f, 1e-4f);
+	CHECK_NEAR(battery.bounds.subtreeBox.Center.z + battery.bounds.subtreeBox.Extents.z, 10.5f, 1e-4f);
+	CHECK_NEAR(root.bounds.subtreeBox.Center.z + root.bounds.subtreeBox.Extents.z, 10.5f, 1e-4f);
+	CHECK(std::memcmp(&bodyBox, &body.bounds.subtreeBox, sizeof(BoundingBox)) == 0);
+
+	// 移动根节点: 所有节点的世界矩阵都发生变化
+	root.transform.SetPosition(100.0f, 0.0f, 0.0f);
+	CHECK(HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity()));
+	CHECK_NEAR(body.bounds.subtreeBox.Center.x, 100.0f, 1e-4f);
+
+	// 结构变化(例如添加子对象)需要标记为脏
+	Node extra;
+	extra.hasBox = true;
+	body.children.push_back(&extra);
+	body.bounds.isDirty = true;
+	CHECK(HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity()));
+	CHECK_EQ(root.bounds.subtreeNodeCount, tank.GetNodeCount() + 1);
+}
+
+TEST_CASE(NodesWithoutModelsOnlyPassTransforms)
+{
+	Node root, group, leaf;
+	root.hasBox = false;
+	group.hasBox = false;
+	root.children.push_back(&group);
+	group.children.push_back(&leaf);
+	group.transform.SetPosition(5.0f, 0.0f, 0.0f);
+
+	HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity());
+	CHECK(root.bounds.hasSubtreeBox);
+	CHECK_NEAR(root.bounds.subtreeBox.Center.x, 5.0f, 1e-4f);
+
+	// 整棵树都没有模型时不测试,直接遍历
+	leaf.hasBox = false;
+	leaf.bounds.isDirty = true;
+	HierarchyCulling<Node>::UpdateBounds(root, XMMatrixIdentity(), XMMatrixIdentity());
+	CHECK(!root.bounds.hasSubtreeBox);
+
+	const BoundingFrustum frustum = MakeFrustum(XMVectorSet(0.0f, 0.0f, -10.0f, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f));
+	HierarchyCullStatistics statistics{};
+	DrawRecorder recorder;
+	HierarchyCulling<Node>::Cull(root, frustum, false, &statistics, recorder);
+	CHECK_EQ(recorder.drawn.size(), 3u);
+	CHECK_EQ(statistics.testedNodes, 0u);
+}
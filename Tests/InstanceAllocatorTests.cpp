@@ -0,0 +1,123 @@
+#include "TestHarness.h"
+#include "InstanceAllocator.h"
+
+#include <random>
+#include <vector>
+
+TEST_CASE(FirstAllocationOfFrameDiscardsThenAppends)
+{
+	InstanceAllocator allocator(256);
+
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		allocator.BeginFrame();
+		CHECK_EQ(allocator.GetHead(), 0u);
+
+		const InstanceAllocator::Allocation first = allocator.Allocate(10);
+		CHECK_EQ(first.offset, 0u);
+		CHECK_EQ(first.newCapacity, 0u);
+		CHECK(first.isDiscard);
+
+		// 同一帧之后的分配紧接在已分配范围之后,不丢弃已写入的数据
+		const InstanceAllocator::Allocation second = allocator.Allocate(30);
+		CHECK_EQ(second.offset, 10u);
+		CHECK_EQ(second.newCapacity, 0u);
+		CHECK(!second.isDiscard);
+
+		// 恰好用完剩余空间也不需要扩容
+		const InstanceAllocator::Allocation third = allocator.Allocate(216);
+		CHECK_EQ(third.offset, 40u);
+		CHECK_EQ(third.newCapacity, 0u);
+		CHECK(!third.isDiscard);
+		CHECK_EQ(allocator.GetHead(), 256u);
+	}
+	CHECK_EQ(allocator.GetCapacity(), 256u);
+}
+
+TEST_CASE(GrowsGeometricallyIntoANewBuffer)
+{
+	InstanceAllocator allocator(100);
+	allocator.BeginFrame();
+	CHECK_EQ(allocator.Allocate(80).offset, 0u);
+
+	// 空间不足: 容量翻倍,在新缓冲区的开头分配
+	const InstanceAllocator::Allocation grown = allocator.Allocate(30);
+	CHECK_EQ(grown.newCapacity, 200u);
+	CHECK_EQ(grown.offset, 0u);
+	CHECK(grown.isDiscard);
+	CHECK_EQ(allocator.GetCapacity(), 200u);
+	CHECK_EQ(allocator.GetHead(), 30u);
+
+	// 之后继续在新缓冲区中追加
+	const InstanceAllocator::Allocation appended = allocator.Allocate(5);
+	CHECK_EQ(appended.offset, 30u);
+	CHECK_EQ(appended.newCapacity, 0u);
+	CHECK(!appended.isDiscard);
+
+	// 一次请求超过两倍容量时直接扩容到请求的大小
+	const InstanceAllocator::Allocation huge = allocator.Allocate(1000);
+	CHECK_EQ(huge.newCapacity, 1000u);
+	CHECK_EQ(huge.offset, 0u);
+
+	// 下一帧沿用扩容后的容量
+	allocator.BeginFrame();
+	const InstanceAllocator::Allocation next = allocator.Allocate(900);
+	CHECK_EQ(next.newCapacity, 0u);
+	CHECK(next.isDiscard);
+}
+
+TEST_CASE(EmptyAllocatorStartsWithMinimumCapacity)
+{
+	InstanceAllocator allocator;
+	CHECK_EQ(allocator.GetCapacity(), 0u);
+
+	const InstanceAllocator::Allocation allocation = allocator.Allocate(1);
+	CHECK_EQ(allocation.newCapacity, 64u);
+	CHECK_EQ(allocation.offset, 0u);
+	CHECK(allocation.isDiscard);
+}
+
+TEST_CASE(RangesWithinAFrameNeverOverlap)
+{
+	// 以缓冲区的代数区分扩容前后的缓冲区,同一缓冲区内本帧的范围互不重叠且不越界
+	std::mt19937 rng(41);
+	std::uniform_int_distribution<UINT> countDistribution(1, 300);
+	std::uniform_int_distribution<int> drawsPerFrame(1, 40);
+
+	InstanceAllocator allocator(16);
+	UINT generation = 0;
+	UINT growCount = 0;
+	for (int frame = 0; frame < 50; ++frame)
+	{
+		allocator.BeginFrame();
+		// 每个元素记录最后一次写入它的分配,-1表示本帧尚未写入
+		std::vector<std::vector<int>> owners(1, std::vector<int>(allocator.GetCapacity(), -1));
+		const UINT firstGeneration = generation;
+
+		const int draws = drawsPerFrame(rng);
+		for (int draw = 0; draw < draws; ++draw)
+		{
+			const UINT count = countDistribution(rng);
+			const InstanceAllocator::Allocation allocation = allocator.Allocate(count);
+			CHECK_EQ(allocation.isDiscard, draw == 0 || allocation.newCapacity != 0);
+			if (allocation.newCapacity)
+			{
+				++generation;
+				++growCount;
+				owners.emplace_back(allocation.newCapacity, -1);
+			}
+
+			std::vector<int>& owner = owners[generation - firstGeneration];
+			CHECK(allocation.offset + count <= static_cast<UINT>(owner.size()));
+			for (UINT i = allocation.offset; i < allocation.offset + count && i < owner.size(); ++i)
+			{
+				CHECK_EQ(owner[i], -1);
+				owner[i] = draw;
+			}
+		}
+	}
+
+	// 扩容只在前几帧发生,之后容量足够
+	CHECK(growCount > 0u);
+	CHECK(growCount < 10u);
+}
@@ -0,0 +1,280 @@
+#include "TestHarness.h"
+#include "Narrowphase.h"
+
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float Tolerance = 1e-3f;
+
+	BoundingOrientedBox MakeBox(const XMFLOAT3& center, const XMFLOAT3& extents, FXMVECTOR orientation = XMQuaternionIdentity())
+	{
+		BoundingOrientedBox box(center, extents, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+		XMStoreFloat4(&box.Orientation, orientation);
+		return box;
+	}
+
+	bool NearEqual(const XMFLOAT3& lhs, const XMFLOAT3& rhs, const float epsilon)
+	{
+		return std::fabs(lhs.x - rhs.x) <= epsilon && std::fabs(lhs.y - rhs.y) <= epsilon && std::fabs(lhs.z - rhs.z) <= epsilon;
+	}
+
+	// 轴对齐立方体的8个顶点
+	std::vector<XMFLOAT3> CubeVertices(const XMFLOAT3& center, const float extent)
+	{
+		std::vector<XMFLOAT3> vertices;
+		for (int i = 0; i < 8; ++i)
+		{
+			vertices.emplace_back(
+				center.x + ((i & 1) ? extent : -extent),
+				center.y + ((i & 2) ? extent : -extent),
+				center.z + ((i & 4) ? extent : -extent));
+		}
+		return vertices;
+	}
+
+	// 球面上的随机顶点,只使用mt19937的原始输出,不同标准库实现得到相同的点
+	// 顶点足够多时EPA会达到面数上限
+	std::vector<XMFLOAT3> SphereVertices(std::mt19937& rng, const XMFLOAT3& center, const float radius, const UINT count)
+	{
+		const auto unit = [&rng]() { return static_cast<float>(rng()) / 4294967296.0f * 2.0f - 1.0f; };
+
+		std::vector<XMFLOAT3> vertices;
+		vertices.reserve(count);
+		while (vertices.size() < count)
+		{
+			const float x = unit(), y = unit(), z = unit();
+			const float lengthSq = x * x + y * y + z * z;
+			if (lengthSq > 1.0f || lengthSq < 1e-4f)
+				continue;
+			const float scale = radius / std::sqrt(lengthSq);
+			vertices.emplace_back(center.x + x * scale, center.y + y * scale, center.z + z * scale);
+		}
+		return vertices;
+	}
+
+	// Minkowski差A - B在direction方向上的支撑距离
+	float XM_CALLCONV SupportDistance(const std::vector<XMFLOAT3>& a, const std::vector<XMFLOAT3>& b, FXMVECTOR direction)
+	{
+		float maxA = -FLT_MAX, minB = FLT_MAX;
+		for (const XMFLOAT3& v : a)
+			maxA = (std::max)(maxA, XMVectorGetX(XMVector3Dot(XMLoadFloat3(&v), direction)));
+		for (const XMFLOAT3& v : b)
+			minB = (std::min)(minB, XMVectorGetX(XMVector3Dot(XMLoadFloat3(&v), direction)));
+		return maxA - minB;
+	}
+
+	ContactManifold RestingManifold(const float offset)
+	{
+		ContactManifold manifold{};
+		manifold.normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+		manifold.pointCount = 4;
+		for (UINT i = 0; i < 4; ++i)
+		{
+			ContactPoint& point = manifold.points[i];
+			point.position = XMFLOAT3((i & 1) ? 1.0f + offset : -1.0f, 0.0f, (i & 2) ? 1.0f : -1.0f);
+			point.penetration = 0.01f;
+			point.normalImpulse = 0.0f;
+			point.tangentImpulse[0] = point.tangentImpulse[1] = 0.0f;
+		}
+		return manifold;
+	}
+}
+
+TEST_CASE(BoxBoxFaceContactClipsFourPoints)
+{
+	// B叠放在A之上,穿透0.1
+	const BoundingOrientedBox a = MakeBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+	const BoundingOrientedBox b = MakeBox(XMFLOAT3(0.0f, 1.9f, 0.0f), XMFLOAT3(0.5f, 1.0f, 0.5f));
+
+	ContactManifold manifold;
+	CHECK(Narrowphase::Collide(a, b, manifold));
+	CHECK(NearEqual(manifold.normal, XMFLOAT3(0.0f, 1.0f, 0.0f), Tolerance));
+	CHECK_EQ(manifold.pointCount, 4u);
+	for (UINT i = 0; i < manifold.pointCount; ++i)
+	{
+		const ContactPoint& point = manifold.points[i];
+		CHECK_NEAR(point.penetration, 0.1f, Tolerance);
+		CHECK_NEAR(std::fabs(point.position.x), 0.5f, Tolerance);
+		CHECK_NEAR(std::fabs(point.position.z), 0.5f, Tolerance);
+		CHECK_NEAR(point.position.y, 0.95f, Tolerance);
+	}
+
+	// 交换顺序后法线反向
+	CHECK(Narrowphase::Collide(b, a, manifold));
+	CHECK(NearEqual(manifold.normal, XMFLOAT3(0.0f, -1.0f, 0.0f), Tolerance));
+	CHECK_EQ(manifold.pointCount, 4u);
+
+	// 分离
+	const BoundingOrientedBox c = MakeBox(XMFLOAT3(0.0f, 2.1f, 0.0f), XMFLOAT3(0.5f, 1.0f, 0.5f));
+	CHECK(!Narrowphase::Collide(a, c, manifold));
+}
+
+TEST_CASE(BoxBoxEdgeContactProducesSinglePoint)
+{
+	// A绕z轴旋转45°,顶部为沿z的棱;B绕x轴旋转45°,底部为沿x的棱,两条棱在原点上方垂直交叉
+	const float ridge = std::sqrt(2.0f);
+	const BoundingOrientedBox a = MakeBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f), XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, XM_PIDIV4));
+	const BoundingOrientedBox b = MakeBox(XMFLOAT3(0.0f, 2.0f * ridge - 0.1f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f), XMQuaternionRotationRollPitchYaw(XM_PIDIV4, 0.0f, 0.0f));
+
+	ContactManifold manifold;
+	CHECK(Narrowphase::Collide(a, b, manifold));
+	CHECK(NearEqual(manifold.normal, XMFLOAT3(0.0f, 1.0f, 0.0f), Tolerance));
+	CHECK_EQ(manifold.pointCount, 1u);
+	CHECK_NEAR(manifold.points[0].penetration, 0.1f, Tolerance);
+	CHECK(NearEqual(manifold.points[0].position, XMFLOAT3(0.0f, ridge - 0.05f, 0.0f), Tolerance));
+}
+
+TEST_CASE(SphereBoxContact)
+{
+	const BoundingOrientedBox box = MakeBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+	const BoundingSphere sphere(XMFLOAT3(0.0f, 1.8f, 0.0f), 1.0f);
+
+	// 法线由球指向盒
+	ContactManifold manifold;
+	CHECK(Narrowphase::Collide(sphere, box, manifold));
+	CHECK(NearEqual(manifold.normal, XMFLOAT3(0.0f, -1.0f, 0.0f), Tolerance));
+	CHECK_EQ(manifold.pointCount, 1u);
+	CHECK_NEAR(manifold.points[0].penetration, 0.2f, Tolerance);
+	CHECK(NearEqual(manifold.points[0].position, XMFLOAT3(0.0f, 1.0f, 0.0f), Tolerance));
+
+	CHECK(Narrowphase::Collide(box, sphere, manifold));
+	CHECK(NearEqual(manifold.normal, XMFLOAT3(0.0f, 1.0f, 0.0f), Tolerance));
+
+	// 球心位于盒内,沿最浅的面推出
+	const BoundingSphere inside(XMFLOAT3(0.7f, 0.0f, 0.0f), 0.5f);
+	CHECK(Narrowphase::Collide(inside, box, manifold));
+	CHECK(NearEqual(manifold.normal, XMFLOAT3(-1.0f, 0.0f, 0.0f), Tolerance));
+	CHECK_NEAR(manifold.points[0].penetration, 0.8f, Tolerance);
+
+	const BoundingSphere apart(XMFLOAT3(1.5f, 1.5f, 0.0f), 0.5f);
+	CHECK(!Narrowphase::Collide(apart, box, manifold));
+}
+
+TEST_CASE(ConvexHullCubesMatchBoxPenetration)
+{
+	const std::vector<XMFLOAT3> cubeA = CubeVertices(XMFLOAT3(0.0f, 0.0f, 0.0f), 1.0f);
+	const std::vector<XMFLOAT3> cubeB = CubeVertices(XMFLOAT3(0.3f, 1.9f, -0.2f), 1.0f);
+	const ConvexHull a{ cubeA.data(), static_cast<UINT>(cubeA.size()) };
+	const ConvexHull b{ cubeB.data(), static_cast<UINT>(cubeB.size()) };
+
+	// 与OBB的结果一致: 法线由A指向B
+	ContactManifold manifold;
+	CHECK(Narrowphase::Collide(a, b, manifold));
+	CHECK_EQ(manifold.pointCount, 1u);
+	CHECK_NEAR(manifold.points[0].penetration, 0.1f, Tolerance);
+	CHECK(NearEqual(manifold.normal, XMFLOAT3(0.0f, 1.0f, 0.0f), Tolerance));
+
+	const std::vector<XMFLOAT3> cubeC = CubeVertices(XMFLOAT3(0.0f, 2.1f, 0.0f), 1.0f);
+	const ConvexHull c{ cubeC.data(), static_cast<UINT>(cubeC.size()) };
+	CHECK(!Narrowphase::Collide(a, c, manifold));
+}
+
+TEST_CASE(ConvexHullEpaStaysConsistentAtCapacity)
+{
+	// 两个半径为10、球心相距5的近似球面,穿透深度约为15
+	for (const UINT seed : { 1u, 2u, 3u })
+	{
+		std::mt19937 rng(seed);
+		const std::vector<XMFLOAT3> sphereA = SphereVertices(rng, XMFLOAT3(0.0f, 0.0f, 0.0f), 10.0f, 40000);
+		const std::vector<XMFLOAT3> sphereB = SphereVertices(rng, XMFLOAT3(3.0f, 0.0f, 4.0f), 10.0f, 40000);
+		const ConvexHull a{ sphereA.data(), static_cast<UINT>(sphereA.size()) };
+		const ConvexHull b{ sphereB.data(), static_cast<UINT>(sphereB.size()) };
+
+		ContactManifold manifold;
+		CHECK(Narrowphase::Collide(a, b, manifold));
+		CHECK_EQ(manifold.pointCount, 1u);
+
+		const XMVECTOR normal = XMLoadFloat3(&manifold.normal);
+		const float penetration = manifold.points[0].penetration;
+		CHECK_NEAR(XMVectorGetX(XMVector3Length(normal)), 1.0f, Tolerance);
+		CHECK(XMVectorGetX(XMVector3Dot(normal, XMVectorSet(0.6f, 0.0f, 0.8f, 0.0f))) > 0.99f);
+
+		// 返回的穿透深度必须是法线所在的面到原点的距离:
+		// 不超过Minkowski差在法线方向上的支撑距离,提前停止时也只能略小于它
+		const float support = SupportDistance(sphereA, sphereB, normal);
+		CHECK(penetration <= support + Tolerance);
+		CHECK(penetration > support - 0.05f);
+		CHECK_NEAR(penetration, 15.0f, 0.05f);
+	}
+}
+
+TEST_CASE(ManifoldCacheKeepsRestingContactAcrossFrames)
+{
+	ContactManifoldCache cache(0.05f);
+
+	// 第1帧: 新物体对,冲量清零
+	cache.Update(0, 1, RestingManifold(0.0f));
+	cache.EndFrame();
+	CHECK_EQ(cache.GetManifolds().size(), 1u);
+	for (UINT i = 0; i < 4; ++i)
+	{
+		CHECK_EQ(cache.GetManifolds()[0].manifold.points[i].normalImpulse, 0.0f);
+		// 模拟求解器写回冲量
+		cache.GetManifolds()[0].manifold.points[i].normalImpulse = 1.0f + i;
+		cache.GetManifolds()[0].manifold.points[i].tangentImpulse[0] = 0.5f;
+	}
+
+	// 第2帧: 接触点有微小抖动,仍与旧点匹配并继承冲量;x方向偏移较大的点视为新点
+	cache.Update(0, 1, RestingManifold(0.01f));
+	cache.EndFrame();
+	CHECK_EQ(cache.GetManifolds().size(), 1u);
+	for (UINT i = 0; i < 4; ++i)
+	{
+		CHECK_EQ(cache.GetManifolds()[0].manifold.points[i].normalImpulse, 1.0f + i);
+		CHECK_EQ(cache.GetManifolds()[0].manifold.points[i].tangentImpulse[0], 0.5f);
+	}
+
+	cache.Update(0, 1, RestingManifold(0.2f));
+	cache.EndFrame();
+	for (UINT i = 0; i < 4; ++i)
+		CHECK_EQ(cache.GetManifolds()[0].manifold.points[i].normalImpulse, (i & 1) ? 0.0f : 1.0f + i);
+
+	// 没有更新的物体对在帧末被移除
+	cache.EndFrame();
+	CHECK(cache.GetManifolds().empty());
+}
+
+TEST_CASE(ManifoldCacheMergesRepeatedUpdatesOfNewPair)
+{
+	ContactManifoldCache cache;
+	cache.Update(5, 7, RestingManifold(0.0f));
+	cache.Update(2, 3, RestingManifold(0.0f));
+	ContactManifold last = RestingManifold(0.0f);
+	last.pointCount = 2;
+	cache.Update(5, 7, last);
+	cache.EndFrame();
+
+	// 同一帧内重复更新的新物体对只保留一份,且为最后一次的流形
+	const auto& manifolds = cache.GetManifolds();
+	CHECK_EQ(manifolds.size(), 2u);
+	CHECK_EQ(manifolds[0].first, 2u);
+	CHECK_EQ(manifolds[1].first, 5u);
+	CHECK_EQ(manifolds[1].manifold.pointCount, 2u);
+}
+
+TEST_CASE(CollideBatchUpdatesCache)
+{
+	const std::vector<BoundingOrientedBox> boxes = {
+		MakeBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)),
+		MakeBox(XMFLOAT3(0.0f, 1.9f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)),
+		MakeBox(XMFLOAT3(5.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)),
+	};
+	const std::vector<CollisionPair> pairs = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+
+	Narrowphase narrowphase;
+	ContactManifoldCache cache;
+	for (int frame = 0; frame < 3; ++frame)
+	{
+		narrowphase.CollideBatch(boxes, pairs, cache);
+		cache.EndFrame();
+		CHECK_EQ(cache.GetManifolds().size(), 1u);
+		CHECK_EQ(cache.GetManifolds()[0].first, 0u);
+		CHECK_EQ(cache.GetManifolds()[0].second, 1u);
+		CHECK_EQ(cache.GetManifolds()[0].manifold.pointCount, 4u);
+	}
+}
@@ -0,0 +1,183 @@
+#include "TestHarness.h"
+#include "OcclusionCulling.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float NearZ = 1.0f;
+	constexpr float FarZ = 100.0f;
+
+	// 摄像机位于原点看向+z,水平方向的tan(半视角)为2,竖直方向为1
+	XMMATRIX ViewProj(const UINT width, const UINT height)
+	{
+		const XMMATRIX view = XMMatrixLookAtLH(XMVectorZero(), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV2, static_cast<float>(width) / height, NearZ, FarZ);
+		return view * proj;
+	}
+
+	BoundingOrientedBox Wall(const XMFLOAT3& center, const XMFLOAT3& extents)
+	{
+		return BoundingOrientedBox(center, extents, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	// 视空间深度z对应的NDC深度
+	float NdcDepth(const float z)
+	{
+		return FarZ / (FarZ - NearZ) * (1.0f - NearZ / z);
+	}
+}
+
+TEST_CASE(EmptyDepthBufferOnlyCullsOffscreenObjects)
+{
+	OcclusionCulling culling(256, 128);
+	culling.BeginFrame(ViewProj(256, 128));
+	culling.BuildHiZ();
+
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 10.0f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 95.0f), XMFLOAT3(0.1f, 0.1f, 0.1f))));
+	// 位于视锥体右侧之外
+	CHECK(!culling.IsVisible(BoundingBox(XMFLOAT3(100.0f, 0.0f, 10.0f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+	// 与近平面相交,无论深度缓冲区如何都视为可见
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.5f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+
+	const OcclusionCulling::Statistics& statistics = culling.GetStatistics();
+	CHECK_EQ(statistics.occluderTriangles, 0u);
+	CHECK_EQ(statistics.testedObjects, 4u);
+	CHECK_EQ(statistics.culledObjects, 1u);
+}
+
+TEST_CASE(WallOccludesOnlyObjectsFullyBehindIt)
+{
+	OcclusionCulling culling(256, 128);
+	culling.BeginFrame(ViewProj(256, 128));
+	// 墙的正面位于z = 9.9,覆盖x/z, y/z∈[-0.505, 0.505]
+	culling.RasterizeOccluder(Wall(XMFLOAT3(0.0f, 0.0f, 10.0f), XMFLOAT3(5.0f, 5.0f, 0.1f)));
+	culling.BuildHiZ();
+
+	const OcclusionCulling::Statistics& statistics = culling.GetStatistics();
+	CHECK(statistics.occluderTriangles > 0u);
+	CHECK(statistics.occluderTriangles <= 12u);
+
+	// 屏幕中心像素的深度为墙正面的深度
+	const std::vector<float>& depth = culling.GetDepthBuffer();
+	CHECK_EQ(depth.size(), 256u * 128u);
+	CHECK_NEAR(depth[64 * 256 + 128], NdcDepth(9.9f), 1e-4f);
+	CHECK_EQ(depth[0], 1.0f);
+
+	// 完全在墙后
+	CHECK(!culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 20.0f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+	CHECK(!culling.IsVisible(BoundingBox(XMFLOAT3(2.0f, -2.0f, 50.0f), XMFLOAT3(3.0f, 3.0f, 3.0f))));
+	// 在墙前
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 5.0f), XMFLOAT3(0.5f, 0.5f, 0.5f))));
+	// 与墙相交,最近点位于墙前
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 10.0f), XMFLOAT3(0.5f, 0.5f, 1.0f))));
+	// 在墙后但屏幕矩形跨过墙的边缘
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(10.5f, 0.0f, 20.0f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+	// 在墙后且完全位于墙的侧面
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(12.0f, 0.0f, 20.0f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+
+	CHECK_EQ(statistics.testedObjects, 6u);
+	CHECK_EQ(statistics.culledObjects, 2u);
+
+	// 新的一帧清空深度缓冲区与统计信息
+	culling.BeginFrame(ViewProj(256, 128));
+	culling.BuildHiZ();
+	CHECK_EQ(culling.GetStatistics().testedObjects, 0u);
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, 0.0f, 20.0f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+}
+
+TEST_CASE(TrianglesCrossingNearPlaneAreSkipped)
+{
+	OcclusionCulling culling(64, 32);
+	culling.BeginFrame(ViewProj(64, 32));
+	// 从摄像机之后延伸到前方的地面
+	culling.RasterizeOccluder(Wall(XMFLOAT3(0.0f, -1.0f, 0.0f), XMFLOAT3(50.0f, 0.1f, 50.0f)));
+	culling.BuildHiZ();
+
+	// 只有完全位于摄像机前方的远端侧面(z = 50)被光栅化
+	CHECK_EQ(culling.GetStatistics().occluderTriangles, 2u);
+	// 屏幕底部本应被近处地面覆盖,跳过之后深度保持为最远
+	CHECK_EQ(culling.GetDepthBuffer()[31 * 64 + 32], 1.0f);
+	CHECK(culling.IsVisible(BoundingBox(XMFLOAT3(0.0f, -5.0f, 20.0f), XMFLOAT3(1.0f, 1.0f, 1.0f))));
+}
+
+TEST_CASE(WordAndUintIndicesRasterizeIdentically)
+{
+	const XMFLOAT3 vertices[] = {
+		XMFLOAT3(-1.0f, -1.0f, 0.0f), XMFLOAT3(1.0f, -1.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 0.0f), XMFLOAT3(-1.0f, 1.0f, 0.0f)
+	};
+	const UINT uintIndices[] = { 0, 1, 2, 0, 2, 3 };
+	const WORD wordIndices[] = { 0, 1, 2, 0, 2, 3 };
+	// 倾斜的四边形,深度在屏幕上不是常数
+	const XMMATRIX world = XMMatrixRotationRollPitchYaw(0.3f, 0.5f, 0.0f) * XMMatrixTranslation(0.5f, 0.0f, 8.0f);
+
+	OcclusionCulling a(128, 64), b(128, 64);
+	a.BeginFrame(ViewProj(128, 64));
+	b.BeginFrame(ViewProj(128, 64));
+	a.RasterizeOccluder(vertices, 4, uintIndices, 6, world);
+	b.RasterizeOccluder(vertices, 4, wordIndices, 6, world);
+
+	CHECK_EQ(a.GetStatistics().occluderTriangles, 2u);
+	CHECK(a.GetDepthBuffer() == b.GetDepthBuffer());
+
+	UINT covered = 0;
+	for (const float depth : a.GetDepthBuffer())
+	{
+		if (depth < 1.0f)
+		{
+			++covered;
+			CHECK(depth > NdcDepth(6.0f) && depth < NdcDepth(10.0f));
+		}
+	}
+	CHECK(covered > 0u);
+}
+
+TEST_CASE(HiZIsNeverLessConservativeThanFullResolution)
+{
+	// 宽高不是2的幂时,层次Z的最后一行/列只由一个或两个纹素合并而来
+	const std::pair<UINT, UINT> sizes[] = { { 256u, 128u }, { 100u, 60u } };
+	for (const auto& [width, height] : sizes)
+	{
+		std::mt19937 rng(width);
+		std::uniform_real_distribution<float> x(-15.0f, 15.0f);
+		std::uniform_real_distribution<float> y(-8.0f, 8.0f);
+		std::uniform_real_distribution<float> occluderZ(5.0f, 20.0f);
+		std::uniform_real_distribution<float> objectZ(3.0f, 60.0f);
+		std::uniform_real_distribution<float> extent(0.1f, 4.0f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+		// 两个剔除器光栅化相同的遮挡物,只有一个构建层次Z,另一个逐像素测试
+		OcclusionCulling hiZ(width, height), fullResolution(width, height);
+		hiZ.BeginFrame(ViewProj(width, height));
+		fullResolution.BeginFrame(ViewProj(width, height));
+		for (int i = 0; i < 12; ++i)
+		{
+			BoundingOrientedBox occluder = Wall(XMFLOAT3(x(rng), y(rng), occluderZ(rng)), XMFLOAT3(extent(rng) * 2.0f, extent(rng) * 2.0f, 0.2f));
+			XMStoreFloat4(&occluder.Orientation, XMQuaternionRotationRollPitchYaw(angle(rng) * 0.2f, angle(rng) * 0.2f, angle(rng)));
+			hiZ.RasterizeOccluder(occluder);
+			fullResolution.RasterizeOccluder(occluder);
+		}
+		hiZ.BuildHiZ();
+		CHECK(hiZ.GetDepthBuffer() == fullResolution.GetDepthBuffer());
+
+		UINT culled = 0, visible = 0;
+		for (int i = 0; i < 2000; ++i)
+		{
+			const BoundingBox box(XMFLOAT3(x(rng) * 2.0f, y(rng) * 2.0f, objectZ(rng)), XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+			const bool isVisibleHiZ = hiZ.IsVisible(box);
+			const bool isVisibleFull = fullResolution.IsVisible(box);
+			// 层次Z保存的是覆盖区域内的最远深度,只能比逐像素测试更保守
+			CHECK(isVisibleHiZ || !isVisibleFull);
+			culled += isVisibleHiZ ? 0 : 1;
+			visible += isVisibleFull ? 1 : 0;
+		}
+
+		// 场景需要同时包含被剔除与可见的物体
+		CHECK(culled > 0u);
+		CHECK(visible > 0u);
+		CHECK_EQ(hiZ.GetStatistics().culledObjects, culled);
+	}
+}
@@ -0,0 +1,233 @@
+#include "TestHarness.h"
+#include "RayPacket.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float DistEpsilon = 1e-3f;
+
+	std::vector<BoundingBox> RandomBoxes(std::mt19937& rng, const UINT count, const float range)
+	{
+		std::uniform_real_distribution<float> position(-range, range);
+		std::uniform_real_distribution<float> extent(0.1f, 2.0f);
+
+		std::vector<BoundingBox> boxes(count);
+		for (BoundingBox& box : boxes)
+		{
+			box.Center = XMFLOAT3(position(rng), position(rng), position(rng));
+			box.Extents = XMFLOAT3(extent(rng), extent(rng), extent(rng));
+		}
+		return boxes;
+	}
+
+	// 射线原点位于场景之外的球面上,方向大致指向场景,保证所有命中距离都不为负
+	std::vector<Ray> RandomRays(std::mt19937& rng, const UINT count, const float originRadius, const float targetRange)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> target(-targetRange, targetRange);
+
+		std::vector<Ray> rays;
+		rays.reserve(count);
+		while (rays.size() < count)
+		{
+			const XMVECTOR onSphere = XMVector3Normalize(XMVectorSet(unit(rng), unit(rng), unit(rng), 0.0f));
+			if (XMVectorGetX(XMVector3LengthSq(onSphere)) < 0.5f)
+				continue;
+
+			XMFLOAT3 origin{};
+			XMStoreFloat3(&origin, XMVectorScale(onSphere, originRadius));
+			const XMVECTOR direction = XMVector3Normalize(XMVectorSet(target(rng), target(rng), target(rng), 0.0f) - XMLoadFloat3(&origin));
+			rays.emplace_back(origin, direction);
+		}
+		return rays;
+	}
+
+	template<typename Shape>
+	RayHit ScalarClosest(const Ray& ray, const std::vector<Shape>& shapes, const float maxDist)
+	{
+		RayHit hit{ maxDist, RayHit::InvalidIndex };
+		for (UINT i = 0; i < static_cast<UINT>(shapes.size()); ++i)
+		{
+			float dist;
+			if (ray.Hit(shapes[i], &dist, hit.dist) && dist < hit.dist)
+				hit = { dist, i };
+		}
+		return hit;
+	}
+
+	// 距离相同(两个物体在同一距离被命中)时允许索引不同
+	template<typename Shape>
+	bool SameHit(const Ray& ray, const std::vector<Shape>& shapes, const RayHit& expected, const RayHit& actual)
+	{
+		if (expected.index == RayHit::InvalidIndex || actual.index == RayHit::InvalidIndex)
+			return expected.index == actual.index;
+		if (std::fabs(expected.dist - actual.dist) > DistEpsilon)
+			return false;
+		if (expected.index == actual.index)
+			return true;
+
+		float dist;
+		return ray.Hit(shapes[actual.index], &dist) && std::fabs(dist - expected.dist) <= DistEpsilon;
+	}
+
+	template<typename Shape>
+	void CheckBatchMatchesScalar(const std::vector<Ray>& rays, const std::vector<Shape>& shapes, const float maxDist)
+	{
+		std::vector<RayHit> hits;
+		RayPacket::HitBatch(rays, shapes, hits, maxDist);
+		CHECK_EQ(hits.size(), rays.size());
+
+		UINT hitCount = 0;
+		for (size_t i = 0; i < rays.size(); ++i)
+		{
+			const RayHit expected = ScalarClosest(rays[i], shapes, maxDist);
+			CHECK(SameHit(rays[i], shapes, expected, hits[i]));
+			hitCount += expected.index != RayHit::InvalidIndex ? 1 : 0;
+		}
+
+		// 随机场景需要同时包含命中与未命中的射线,否则比较没有意义
+		CHECK(hitCount > 0);
+		CHECK(hitCount < rays.size());
+	}
+}
+
+TEST_CASE(TraversalStackFallsBackToHeapForDeepTrees)
+{
+	// 深度超过栈上容量时改为堆分配,所有节点都能压入且按后进先出弹出
+	const UINT depth = BoundingVolumeHierarchy::TraversalStack::InlineCapacity * 3;
+	BoundingVolumeHierarchy::TraversalStack stack(depth);
+	for (UINT i = 0; i <= depth; ++i)
+		stack.Push(i);
+	for (UINT i = depth + 1; i > 0; --i)
+		CHECK_EQ(stack.Pop(), i - 1);
+	CHECK(stack.Empty());
+}
+
+TEST_CASE(BuildRecordsTreeDepth)
+{
+	std::mt19937 rng(1);
+
+	BoundingVolumeHierarchy bvh;
+	bvh.Build(RandomBoxes(rng, 1, 10.0f), 1);
+	CHECK_EQ(bvh.GetDepth(), 0u);
+
+	// 中位数划分的树深度为ceil(log2(N / 叶节点大小))
+	bvh.Build(RandomBoxes(rng, 1000, 50.0f), 1);
+	CHECK_EQ(bvh.GetDepth(), 10u);
+
+	UINT maxDepth = 0;
+	std::vector<std::pair<UINT, UINT>> stack{ { 0u, 0u } };
+	while (!stack.empty())
+	{
+		const auto [index, depth] = stack.back();
+		stack.pop_back();
+		const BoundingVolumeHierarchy::Node& node = bvh.GetNodes()[index];
+		maxDepth = (std::max)(maxDepth, depth);
+		if (!node.IsLeaf())
+		{
+			stack.emplace_back(node.leftOrFirst, depth + 1);
+			stack.emplace_back(node.leftOrFirst + 1, depth + 1);
+		}
+	}
+	CHECK_EQ(bvh.GetDepth(), maxDepth);
+
+	bvh.Clear();
+	CHECK_EQ(bvh.GetDepth(), 0u);
+}
+
+TEST_CASE(PacketMatchesScalarForBoxes)
+{
+	std::mt19937 rng(2);
+	const std::vector<BoundingBox> boxes = RandomBoxes(rng, 200, 20.0f);
+	// 射线数目不是4的倍数,最后一个射线包含有非活动通道
+	const std::vector<Ray> rays = RandomRays(rng, 1023, 100.0f, 25.0f);
+
+	CheckBatchMatchesScalar(rays, boxes, FLT_MAX);
+	CheckBatchMatchesScalar(rays, boxes, 95.0f);
+}
+
+TEST_CASE(PacketMatchesScalarForOrientedBoxes)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+
+	std::vector<BoundingOrientedBox> boxes;
+	for (const BoundingBox& box : RandomBoxes(rng, 200, 20.0f))
+	{
+		BoundingOrientedBox obb;
+		BoundingOrientedBox::CreateFromBoundingBox(obb, box);
+		XMStoreFloat4(&obb.Orientation, XMQuaternionRotationRollPitchYaw(angle(rng), angle(rng), angle(rng)));
+		boxes.push_back(obb);
+	}
+	const std::vector<Ray> rays = RandomRays(rng, 1022, 100.0f, 25.0f);
+
+	CheckBatchMatchesScalar(rays, boxes, FLT_MAX);
+}
+
+TEST_CASE(PacketMatchesScalarForSpheres)
+{
+	std::mt19937 rng(4);
+	std::vector<BoundingSphere> spheres;
+	for (const BoundingBox& box : RandomBoxes(rng, 200, 20.0f))
+		spheres.emplace_back(box.Center, box.Extents.x);
+	const std::vector<Ray> rays = RandomRays(rng, 1021, 100.0f, 25.0f);
+
+	CheckBatchMatchesScalar(rays, spheres, FLT_MAX);
+	CheckBatchMatchesScalar(rays, spheres, 95.0f);
+}
+
+TEST_CASE(PacketBvhMatchesScalarBvhAndBruteForce)
+{
+	std::mt19937 rng(5);
+	const std::vector<BoundingBox> boxes = RandomBoxes(rng, 2000, 40.0f);
+	const std::vector<Ray> rays = RandomRays(rng, 2047, 150.0f, 45.0f);
+
+	for (const UINT leafSize : { 1u, 4u, 16u })
+	{
+		BoundingVolumeHierarchy bvh;
+		bvh.Build(boxes, leafSize);
+
+		std::vector<RayHit> hits;
+		RayPacket::HitBatch(rays, bvh, hits);
+		CHECK_EQ(hits.size(), rays.size());
+
+		for (size_t i = 0; i < rays.size(); ++i)
+		{
+			const RayHit expected = ScalarClosest(rays[i], boxes, FLT_MAX);
+			CHECK(SameHit(rays[i], boxes, expected, hits[i]));
+
+			float dist = FLT_MAX;
+			const UINT index = bvh.Hit(XMLoadFloat3(&rays[i].origin), XMLoadFloat3(&rays[i].direction), &dist);
+			CHECK(SameHit(rays[i], boxes, expected, { dist, index }));
+		}
+	}
+}
+
+TEST_CASE(QueryMatchesBruteForce)
+{
+	std::mt19937 rng(6);
+	const std::vector<BoundingBox> boxes = RandomBoxes(rng, 1500, 40.0f);
+	const std::vector<BoundingBox> queries = RandomBoxes(rng, 100, 40.0f);
+
+	BoundingVolumeHierarchy bvh;
+	bvh.Build(boxes, 2);
+
+	std::vector<UINT> indices;
+	for (const BoundingBox& query : queries)
+	{
+		indices.clear();
+		bvh.Query(query, indices);
+		std::sort(indices.begin(), indices.end());
+
+		std::vector<UINT> expected;
+		for (UINT i = 0; i < static_cast<UINT>(boxes.size()); ++i)
+		{
+			if (boxes[i].Intersects(query))
+				expected.push_back(i);
+		}
+		CHECK(indices == expected);
+	}
+}
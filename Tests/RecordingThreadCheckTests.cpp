@@ -0,0 +1,114 @@
+#include "TestHarness.h"
+#include "RecordingThreadCheck.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// 在另一个线程上调用Acquire并返回结果
+	bool AcquireOnOtherThread(RecordingThreadCheck& check)
+	{
+		bool result = false;
+		std::thread thread([&check, &result]() { result = check.Acquire(); });
+		thread.join();
+		return result;
+	}
+}
+
+TEST_CASE(SameThreadMayReacquire)
+{
+	RecordingThreadCheck check;
+	CHECK(check.Acquire());
+	CHECK(check.Acquire());
+
+	RecordingThreadCheck::AdvanceEpoch();
+	CHECK(check.Acquire());
+}
+
+TEST_CASE(SecondThreadWithinOneRecordingFails)
+{
+	// 录制开始: 主线程与工作线程使用同一个特效
+	RecordingThreadCheck::AdvanceEpoch();
+	RecordingThreadCheck check;
+	CHECK(check.Acquire());
+	CHECK(!AcquireOnOtherThread(check));
+	// 所属线程不变
+	CHECK(check.Acquire());
+	RecordingThreadCheck::AdvanceEpoch();
+}
+
+TEST_CASE(OwnershipResetsBetweenRecordings)
+{
+	RecordingThreadCheck check;
+
+	// 上一次录制中由工作线程使用,录制结束后主线程可以继续使用
+	RecordingThreadCheck::AdvanceEpoch();
+	CHECK(AcquireOnOtherThread(check));
+	RecordingThreadCheck::AdvanceEpoch();
+	CHECK(check.Acquire());
+
+	// 下一次录制改由另一个工作线程使用
+	RecordingThreadCheck::AdvanceEpoch();
+	CHECK(AcquireOnOtherThread(check));
+	CHECK(!check.Acquire());
+	RecordingThreadCheck::AdvanceEpoch();
+}
+
+TEST_CASE(DifferentObjectsAreIndependent)
+{
+	// 每个录制任务使用各自的特效对象
+	RecordingThreadCheck::AdvanceEpoch();
+	RecordingThreadCheck shadow;
+	RecordingThreadCheck basic;
+	CHECK(shadow.Acquire());
+	CHECK(AcquireOnOtherThread(basic));
+
+	// 拷贝得到的对象没有所属线程
+	RecordingThreadCheck copy(shadow);
+	CHECK(AcquireOnOtherThread(copy));
+	RecordingThreadCheck::AdvanceEpoch();
+}
+
+TEST_CASE(ConcurrentAcquireHasExactlyOneWinner)
+{
+	// 多个录制任务同时第一次使用同一个特效: 只有一个线程成功,其余线程之后也一直失败
+	for (int round = 0; round < 50; ++round)
+	{
+		RecordingThreadCheck::AdvanceEpoch();
+		RecordingThreadCheck check;
+
+		const int threadCount = 8;
+		std::atomic<bool> start{ false };
+		std::atomic<int> winners{ 0 };
+		std::atomic<int> inconsistent{ 0 };
+		std::vector<std::thread> threads;
+		for (int i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back([&]()
+				{
+					while (!start.load())
+						std::this_thread::yield();
+					const bool isOwner = check.Acquire();
+					if (isOwner)
+						++winners;
+					for (int repeat = 0; repeat < 100; ++repeat)
+					{
+						if (check.Acquire() != isOwner)
+							++inconsistent;
+					}
+				});
+		}
+		start = true;
+		for (std::thread& thread : threads)
+			thread.join();
+
+		CHECK_EQ(winners.load(), 1);
+		CHECK_EQ(inconsistent.load(), 0);
+		// 主线程也不能使用
+		CHECK(!check.Acquire());
+		RecordingThreadCheck::AdvanceEpoch();
+		CHECK(check.Acquire());
+	}
+}
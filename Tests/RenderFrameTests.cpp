@@ -0,0 +1,286 @@
+#include "TestHarness.h"
+#include "RenderQueue.h"
+#include "RenderBackend.h"
+#include "InstanceAllocator.h"
+
+#include <string>
+
+using namespace DirectX;
+
+namespace
+{
+	// 句柄只被比较与编号,不解引用,用一块内存中不同的地址代替D3D资源
+	struct FakeResources
+	{
+		template <typename T>
+		T* Get(const UINT index)
+		{
+			return reinterpret_cast<T*>(storage + index);
+		}
+
+		char storage[64];
+	};
+
+	// 代替特效,只统计设置参数的次数
+	class FakeEffect : public IEffectDrawParameters
+	{
+	public:
+		void XM_CALLCONV SetDrawParameters(const EffectDrawParameters&, FXMMATRIX) const override { ++drawParameterCount; }
+		void SetInstancedDrawParameters(const EffectDrawParameters&) const override { ++instancedParameterCount; }
+
+		RenderEffect* GetHandle() { return reinterpret_cast<RenderEffect*>(this); }
+		void ResetCounts() { drawParameterCount = instancedParameterCount = 0; }
+
+		mutable UINT drawParameterCount = 0;
+		mutable UINT instancedParameterCount = 0;
+	};
+
+	// 与GameApp相同结构的一帧:
+	// 上传圆柱与球体的实例数据,地面与实例提交到阴影与主Pass的渲染队列,
+	// 执行阴影Pass,执行主Pass后直接绘制玩家(GameObject::DrawParts)与天空盒(SkyRender::Draw)
+	struct FrameScene
+	{
+		FrameScene()
+		{
+			const auto renderState = [this](const UINT index)
+			{
+				// 渲染状态由场景持有,队列只需要不释放的句柄
+				return std::shared_ptr<const RenderState>(resources.Get<RenderState>(index), [](const RenderState*) {});
+			};
+			shadowObjectPipeline = queue.RegisterPipeline(shadowEffect.GetHandle(), &shadowEffect, renderState(0));
+			shadowInstancePipeline = queue.RegisterPipeline(shadowEffect.GetHandle(), &shadowEffect, renderState(1));
+			mainObjectPipeline = queue.RegisterPipeline(basicEffect.GetHandle(), &basicEffect, renderState(2));
+			mainInstancePipeline = queue.RegisterPipeline(basicEffect.GetHandle(), &basicEffect, renderState(3));
+
+			ground = MakePart(0, 10, 6);
+			cylinder = MakePart(1, 12, 480);
+			sphere = MakePart(2, 14, 5400);
+			tankBody = MakePart(3, 16, 36);
+			tankTurret = MakePart(3, 18, 72);
+
+			sky = MakePart(0, 20, 2880);
+			sky.material = nullptr;
+			sky.textureDiffuse = nullptr;
+			sky.vertexStride = 12;
+		}
+
+		RenderQueue::PartState MakePart(const UINT material, const UINT mesh, const UINT indexCount)
+		{
+			RenderQueue::PartState state{};
+			state.material = &materials[material];
+			state.textureDiffuse = resources.Get<ID3D11ShaderResourceView>(40 + material);
+			state.vertexBuffer = resources.Get<RenderBuffer>(mesh);
+			state.indexBuffer = resources.Get<RenderBuffer>(mesh + 1);
+			state.indexFormat = mesh == 10 ? RenderIndexFormat::UInt16 : RenderIndexFormat::UInt32;
+			state.indexCount = indexCount;
+			state.vertexStride = 44;
+			return state;
+		}
+
+		// 与InstanceBuffer::Map相同: 第一次以WriteDiscard映射,之后追加
+		RenderQueue::InstanceRange Upload(IRenderBackend& backend, const UINT count)
+		{
+			const InstanceAllocator::Allocation allocation = instanceAllocator.Allocate(count);
+			const RenderQueue::InstanceRange range{ resources.Get<RenderBuffer>(30), InstanceStride, allocation.offset, count };
+			backend.Map(range.buffer, allocation.isDiscard ? RenderMapType::WriteDiscard : RenderMapType::WriteNoOverwrite,
+				allocation.offset * InstanceStride, count * InstanceStride);
+			backend.Unmap(range.buffer);
+			return range;
+		}
+
+		void Record(IRenderBackend& backend)
+		{
+			shadowEffect.ResetCounts();
+			basicEffect.ResetCounts();
+			skyEffect.ResetCounts();
+			instanceAllocator.BeginFrame();
+			queue.Clear();
+			queue.SetViewMatrix(ShadowPass, XMMatrixIdentity());
+			queue.SetViewMatrix(MainPass, XMMatrixIdentity());
+
+			const RenderQueue::InstanceRange cylinders = Upload(backend, 3);
+			const RenderQueue::InstanceRange spheres = Upload(backend, 2);
+
+			// 主Pass先提交,排序后仍然在阴影Pass之后执行
+			queue.SubmitPartInstanced(MainPass, mainInstancePipeline, sphere, spheres);
+			queue.SubmitPart(MainPass, mainObjectPipeline, ground, XMMatrixIdentity());
+			queue.SubmitPartInstanced(MainPass, mainInstancePipeline, cylinder, cylinders);
+			queue.SubmitPartInstanced(ShadowPass, shadowInstancePipeline, sphere, spheres);
+			queue.SubmitPartInstanced(ShadowPass, shadowInstancePipeline, cylinder, cylinders);
+			queue.SubmitPart(ShadowPass, shadowObjectPipeline, ground, XMMatrixIdentity());
+			queue.Sort();
+
+			shadowStatistics = queue.Execute(backend, ShadowPass);
+			mainStatistics = queue.Execute(backend, MainPass);
+
+			const XMMATRIX tankWorld = XMMatrixTranslation(0.0f, 0.6f, -20.0f);
+			RenderQueue::DrawPart(backend, basicEffect.GetHandle(), basicEffect, tankBody, tankWorld);
+			RenderQueue::DrawPart(backend, basicEffect.GetHandle(), basicEffect, tankTurret, tankWorld);
+
+			RenderQueue::DrawPart(backend, skyEffect.GetHandle(), skyEffect, sky, XMMatrixIdentity());
+		}
+
+		static constexpr UINT ShadowPass = 0;
+		static constexpr UINT MainPass = 1;
+		static constexpr UINT InstanceStride = 48;
+
+		FakeResources resources;
+		Material materials[4]{};
+		FakeEffect shadowEffect;
+		FakeEffect basicEffect;
+		FakeEffect skyEffect;
+
+		RenderQueue queue;
+		UINT shadowObjectPipeline = 0;
+		UINT shadowInstancePipeline = 0;
+		UINT mainObjectPipeline = 0;
+		UINT mainInstancePipeline = 0;
+		InstanceAllocator instanceAllocator{ 64 };
+
+		RenderQueue::PartState ground{};
+		RenderQueue::PartState cylinder{};
+		RenderQueue::PartState sphere{};
+		RenderQueue::PartState tankBody{};
+		RenderQueue::PartState tankTurret{};
+		RenderQueue::PartState sky{};
+
+		RenderQueue::Statistics shadowStatistics{};
+		RenderQueue::Statistics mainStatistics{};
+	};
+}
+
+TEST_CASE(FrameCommandStreamMatchesExpected)
+{
+	FrameScene scene;
+	RecordingRenderBackend backend;
+	scene.Record(backend);
+
+	// 对象编号按第一次出现的顺序: 1实例缓冲区 2阴影Pass的地面渲染状态 3地面顶点缓冲区 4地面索引缓冲区
+	// 5阴影特效 6实例渲染状态 7球体顶点缓冲区 8球体索引缓冲区 9圆柱顶点缓冲区 10圆柱索引缓冲区
+	// 11主Pass的地面渲染状态 12基础特效 13主Pass的实例渲染状态 14~17玩家的两个部分 18~19天空盒 20天空盒特效
+	// 纹理组按本帧第一次提交的顺序编号,球体先于圆柱提交,因此也先绘制
+	const std::string expected =
+		"Map 1 0 0 144\n"
+		"Unmap 1\n"
+		"Map 1 1 144 96\n"
+		"Unmap 1\n"
+		// 阴影Pass
+		"SetEffectRenderState 2\n"
+		"SetVertexBuffer 0 3 44 0\n"
+		"SetIndexBuffer 4 0 0\n"
+		"ApplyEffect 5\n"
+		"DrawIndexed 6 0 0\n"
+		"SetEffectRenderState 6\n"
+		"SetVertexBuffer 0 7 44 0\n"
+		"SetVertexBuffer 1 1 48 0\n"
+		"SetIndexBuffer 8 1 0\n"
+		"ApplyEffect 5\n"
+		"DrawIndexedInstanced 5400 2 0 0 3\n"
+		"SetVertexBuffer 0 9 44 0\n"
+		"SetVertexBuffer 1 1 48 0\n"
+		"SetIndexBuffer 10 1 0\n"
+		"ApplyEffect 5\n"
+		"DrawIndexedInstanced 480 3 0 0 0\n"
+		// 主Pass,与阴影Pass的状态相同,只有渲染状态与特效不同
+		"SetEffectRenderState 11\n"
+		"SetVertexBuffer 0 3 44 0\n"
+		"SetIndexBuffer 4 0 0\n"
+		"ApplyEffect 12\n"
+		"DrawIndexed 6 0 0\n"
+		"SetEffectRenderState 13\n"
+		"SetVertexBuffer 0 7 44 0\n"
+		"SetVertexBuffer 1 1 48 0\n"
+		"SetIndexBuffer 8 1 0\n"
+		"ApplyEffect 12\n"
+		"DrawIndexedInstanced 5400 2 0 0 3\n"
+		"SetVertexBuffer 0 9 44 0\n"
+		"SetVertexBuffer 1 1 48 0\n"
+		"SetIndexBuffer 10 1 0\n"
+		"ApplyEffect 12\n"
+		"DrawIndexedInstanced 480 3 0 0 0\n"
+		// 玩家
+		"SetVertexBuffer 0 14 44 0\n"
+		"SetIndexBuffer 15 1 0\n"
+		"ApplyEffect 12\n"
+		"DrawIndexed 36 0 0\n"
+		"SetVertexBuffer 0 16 44 0\n"
+		"SetIndexBuffer 17 1 0\n"
+		"ApplyEffect 12\n"
+		"DrawIndexed 72 0 0\n"
+		// 天空盒
+		"SetVertexBuffer 0 18 12 0\n"
+		"SetIndexBuffer 19 1 0\n"
+		"ApplyEffect 20\n"
+		"DrawIndexed 2880 0 0\n";
+	CHECK(backend.ToString() == expected);
+
+	const RecordingRenderBackend::Statistics& statistics = backend.GetStatistics();
+	CHECK_EQ(statistics.drawCalls, 9u);
+	CHECK_EQ(statistics.effectApplies, 9u);
+	CHECK_EQ(statistics.indexCount, 2ull * (6 + 480 * 3 + 5400 * 2) + 36 + 72 + 2880);
+	CHECK_EQ(statistics.instanceCount, 2ull * (1 + 3 + 2) + 3);
+	CHECK_EQ(statistics.maps, 2u);
+	CHECK_EQ(statistics.bytesUploaded, 5ull * FrameScene::InstanceStride);
+	// 阴影Pass 9次: 2次渲染状态、4个顶点缓冲区槽与3个索引缓冲区,第二次绑定槽1的实例缓冲区没有变化
+	// 主Pass 8次: 实例缓冲区从阴影Pass起一直绑定在槽1上,两次都没有变化;玩家与天空盒6次
+	CHECK_EQ(statistics.stateChanges, 9u + 8u + 6u);
+	CHECK_EQ(statistics.redundantStateChanges, 3u);
+
+	// 渲染队列的统计与命令流一致
+	CHECK_EQ(scene.shadowStatistics.packetCount, 3u);
+	CHECK_EQ(scene.shadowStatistics.pipelineChanges, 2u);
+	CHECK_EQ(scene.shadowStatistics.vertexBufferChanges, 3u);
+	CHECK_EQ(scene.shadowStatistics.indexBufferChanges, 3u);
+	CHECK_EQ(scene.mainStatistics.packetCount, 3u);
+
+	// 普通绘制每次设置参数,实例绘制只在纹理或材质变化时设置
+	CHECK_EQ(scene.shadowEffect.drawParameterCount, 1u);
+	CHECK_EQ(scene.shadowEffect.instancedParameterCount, 2u);
+	CHECK_EQ(scene.basicEffect.drawParameterCount, 3u);
+	CHECK_EQ(scene.basicEffect.instancedParameterCount, 2u);
+	CHECK_EQ(scene.skyEffect.drawParameterCount, 1u);
+}
+
+TEST_CASE(RepeatedFrameHasSameCommandStream)
+{
+	FrameScene scene;
+	RecordingRenderBackend first;
+	scene.Record(first);
+
+	// 句柄在多帧之间不变,同样的场景得到同样的命令流
+	RecordingRenderBackend second;
+	scene.Record(second);
+	CHECK(second.ToString() == first.ToString());
+
+	// 清空后重新录制,对象编号从头开始
+	first.Clear();
+	CHECK(first.GetCommands().empty());
+	CHECK_EQ(first.GetStatistics().drawCalls, 0u);
+	scene.Record(first);
+	CHECK(first.ToString() == second.ToString());
+}
+
+TEST_CASE(ChangedPartShowsUpInCommandStreamDiff)
+{
+	FrameScene scene;
+	RecordingRenderBackend before;
+	scene.Record(before);
+
+	// 球体改用16位索引,两个Pass中绑定球体索引缓冲区的命令各变化一次
+	scene.sphere.indexFormat = RenderIndexFormat::UInt16;
+	RecordingRenderBackend after;
+	scene.Record(after);
+
+	std::string expected = before.ToString();
+	const std::string from = "SetIndexBuffer 8 1 0\n";
+	const std::string to = "SetIndexBuffer 8 0 0\n";
+	UINT replaced = 0;
+	for (size_t pos = expected.find(from); pos != std::string::npos; pos = expected.find(from, pos + to.size()))
+	{
+		expected.replace(pos, from.size(), to);
+		++replaced;
+	}
+	CHECK_EQ(replaced, 2u);
+	CHECK(after.ToString() == expected);
+	CHECK_EQ(after.GetStatistics().drawCalls, before.GetStatistics().drawCalls);
+}
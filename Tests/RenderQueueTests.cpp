@@ -0,0 +1,232 @@
+#include "TestHarness.h"
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <set>
+#include <tuple>
+
+using namespace DirectX;
+
+namespace
+{
+	// 渲染队列只比较资源指针,不解引用,用一块内存中不同的地址代替D3D资源
+	struct FakeResources
+	{
+		template <typename T>
+		T* Get(const UINT index)
+		{
+			return reinterpret_cast<T*>(storage + index);
+		}
+
+		char storage[64];
+	};
+
+	bool SortItemLess(const RenderQueue::SortItem& lhs, const RenderQueue::SortItem& rhs)
+	{
+		return lhs.key < rhs.key;
+	}
+
+	bool SameItems(const std::vector<RenderQueue::SortItem>& lhs, const std::vector<RenderQueue::SortItem>& rhs)
+	{
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+			[](const RenderQueue::SortItem& a, const RenderQueue::SortItem& b) { return a.key == b.key && a.index == b.index; });
+	}
+}
+
+TEST_CASE(RadixSortIsStable)
+{
+	// 大量重复的键分布在不同的字节上,相等的键必须保持提交顺序
+	std::mt19937 rng(43);
+	std::vector<RenderQueue::SortItem> items;
+	for (UINT i = 0; i < 5000; ++i)
+	{
+		const UINT64 key = (static_cast<UINT64>(rng() % 7) << 56) | (static_cast<UINT64>(rng() % 5) << 20) | (rng() % 3);
+		items.push_back({ key, i });
+	}
+
+	std::vector<RenderQueue::SortItem> expected = items;
+	std::stable_sort(expected.begin(), expected.end(), SortItemLess);
+
+	std::vector<RenderQueue::SortItem> temp;
+	RenderQueue::RadixSort(items, temp);
+	CHECK(SameItems(items, expected));
+}
+
+TEST_CASE(RadixSortSkipsUniformBytes)
+{
+	std::vector<RenderQueue::SortItem> temp;
+
+	std::vector<RenderQueue::SortItem> empty;
+	CHECK_EQ(RenderQueue::RadixSort(empty, temp), 0u);
+
+	std::vector<RenderQueue::SortItem> same(100, RenderQueue::SortItem{ 0x0123456789ABCDEFull, 0 });
+	CHECK_EQ(RenderQueue::RadixSort(same, temp), 0u);
+
+	// 只有最低字节不同
+	std::vector<RenderQueue::SortItem> lowByte;
+	for (UINT i = 0; i < 100; ++i)
+		lowByte.push_back({ 0xFF00000000000000ull | ((i * 37) & 0xFF), i });
+	CHECK_EQ(RenderQueue::RadixSort(lowByte, temp), 1u);
+	CHECK(std::is_sorted(lowByte.begin(), lowByte.end(), SortItemLess));
+
+	// 最低字节与最高字节不同
+	std::vector<RenderQueue::SortItem> twoBytes;
+	for (UINT i = 0; i < 100; ++i)
+		twoBytes.push_back({ (static_cast<UINT64>(i % 4) << 56) | (i % 9), i });
+	CHECK_EQ(RenderQueue::RadixSort(twoBytes, temp), 2u);
+	CHECK(std::is_sorted(twoBytes.begin(), twoBytes.end(), SortItemLess));
+}
+
+TEST_CASE(QuantizeDepthIsMonotonic)
+{
+	UINT prev = 0;
+	for (float depth = 1e-3f; depth < 1e5f; depth *= 1.01f)
+	{
+		const UINT quantized = RenderQueue::QuantizeDepth(depth);
+		CHECK(quantized >= prev);
+		CHECK(quantized < (1u << RenderQueue::DepthBits));
+		prev = quantized;
+	}
+
+	// 相差较大的深度量化后严格递增
+	CHECK(RenderQueue::QuantizeDepth(1.0f) < RenderQueue::QuantizeDepth(1.1f));
+	CHECK(RenderQueue::QuantizeDepth(10.0f) < RenderQueue::QuantizeDepth(20.0f));
+
+	// 负数、零与NaN都视为0
+	CHECK_EQ(RenderQueue::QuantizeDepth(0.0f), 0u);
+	CHECK_EQ(RenderQueue::QuantizeDepth(-0.0f), 0u);
+	CHECK_EQ(RenderQueue::QuantizeDepth(-5.0f), 0u);
+	CHECK_EQ(RenderQueue::QuantizeDepth(std::numeric_limits<float>::quiet_NaN()), 0u);
+}
+
+TEST_CASE(MakeKeyOrdersFieldsByPriority)
+{
+	// 高位字段决定顺序,低位字段全满也不会越过高位
+	const UINT maxPipeline = (1u << RenderQueue::PipelineBits) - 1;
+	const UINT maxTextureSet = (1u << RenderQueue::TextureSetBits) - 1;
+	const UINT maxMaterial = (1u << RenderQueue::MaterialBits) - 1;
+	CHECK(RenderQueue::MakeKey(0, maxPipeline, maxTextureSet, maxMaterial, 1e30f) < RenderQueue::MakeKey(1, 0, 0, 0, 0.0f));
+	CHECK(RenderQueue::MakeKey(0, 0, maxTextureSet, maxMaterial, 1e30f) < RenderQueue::MakeKey(0, 1, 0, 0, 0.0f));
+	CHECK(RenderQueue::MakeKey(0, 0, 0, maxMaterial, 1e30f) < RenderQueue::MakeKey(0, 0, 1, 0, 0.0f));
+	CHECK(RenderQueue::MakeKey(0, 0, 0, 0, 1e30f) < RenderQueue::MakeKey(0, 0, 0, 1, 0.0f));
+	CHECK(RenderQueue::MakeKey(0, 0, 0, 0, 1.0f) < RenderQueue::MakeKey(0, 0, 0, 0, 2.0f));
+
+	// 超出位宽的部分被截断,不会影响其他字段
+	CHECK_EQ(RenderQueue::MakeKey(0, maxPipeline + 1, 0, 0, 0.0f), 0ull);
+	CHECK_EQ(RenderQueue::MakeKey(RenderQueue::MaxPassCount + 2, 0, 0, 0, 0.0f) >> RenderQueue::PassShift, 2ull);
+
+	// 同一状态下按量化后的深度由近到远排列,量化值相同时保持提交顺序
+	std::mt19937 rng(44);
+	std::uniform_real_distribution<float> depthDistribution(0.5f, 500.0f);
+	std::vector<float> depths;
+	std::vector<RenderQueue::SortItem> items;
+	for (UINT i = 0; i < 200; ++i)
+	{
+		depths.push_back(depthDistribution(rng));
+		items.push_back({ RenderQueue::MakeKey(3, 7, 11, 13, depths.back()), i });
+	}
+	std::vector<RenderQueue::SortItem> temp;
+	RenderQueue::RadixSort(items, temp);
+	for (size_t i = 1; i < items.size(); ++i)
+	{
+		const UINT prev = RenderQueue::QuantizeDepth(depths[items[i - 1].index]);
+		const UINT curr = RenderQueue::QuantizeDepth(depths[items[i].index]);
+		CHECK(prev < curr || (prev == curr && items[i - 1].index < items[i].index));
+	}
+}
+
+TEST_CASE(SortGroupsPassesAndSharedState)
+{
+	// 2个管线 x 3个纹理组 x 2个材质,两个Pass,以随机顺序提交
+	FakeResources resources;
+	const Material materials[2]{};
+	std::mt19937 rng(45);
+
+	RenderQueue queue;
+	queue.SetViewMatrix(0, XMMatrixIdentity());
+	queue.SetViewMatrix(1, XMMatrixLookToLH(XMVectorSet(0.0f, 10.0f, 0.0f, 1.0f), XMVectorSet(0.0f, -1.0f, 0.0f, 0.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f)));
+
+	UINT passCounts[2]{};
+	std::set<std::tuple<UINT, UINT, UINT>> stateCombinations[2];
+	std::set<std::pair<UINT, UINT>> textureCombinations[2];
+	for (UINT i = 0; i < 600; ++i)
+	{
+		const UINT pass = rng() % 2;
+		const UINT pipeline = rng() % 2;
+		const UINT textureSet = rng() % 3;
+		const UINT material = rng() % 2;
+
+		RenderQueue::PartState state{};
+		state.material = &materials[material];
+		state.textureDiffuse = resources.Get<ID3D11ShaderResourceView>(textureSet);
+		state.textureNormalMap = resources.Get<ID3D11ShaderResourceView>(8);
+		// 每个纹理组对应一个网格
+		state.vertexBuffer = resources.Get<RenderBuffer>(16 + textureSet);
+		state.indexBuffer = resources.Get<RenderBuffer>(24 + textureSet);
+		state.indexCount = 36;
+		state.vertexStride = 32;
+
+		queue.SubmitPart(pass, pipeline, state, XMMatrixTranslation(0.0f, 0.0f, static_cast<float>(rng() % 100)));
+		++passCounts[pass];
+		stateCombinations[pass].emplace(pipeline, textureSet, material);
+		textureCombinations[pass].emplace(pipeline, textureSet);
+	}
+	CHECK_EQ(queue.GetPacketCount(), 600u);
+
+	queue.Sort();
+	CHECK(queue.GetSortPassCount() > 0u);
+
+	for (UINT pass = 0; pass < 2; ++pass)
+	{
+		// 同一状态的绘制包连续排列: 每种组合只切换一次
+		const RenderQueue::Statistics statistics = queue.GetStatistics(pass);
+		CHECK_EQ(statistics.packetCount, passCounts[pass]);
+		CHECK_EQ(statistics.pipelineChanges, 2u);
+		CHECK_EQ(statistics.textureSetChanges, static_cast<UINT>(textureCombinations[pass].size()));
+		CHECK_EQ(statistics.materialChanges, static_cast<UINT>(stateCombinations[pass].size()));
+		CHECK_EQ(statistics.vertexBufferChanges, static_cast<UINT>(textureCombinations[pass].size()));
+		CHECK_EQ(statistics.indexBufferChanges, static_cast<UINT>(textureCombinations[pass].size()));
+	}
+
+	// 没有提交的Pass
+	CHECK_EQ(queue.GetStatistics(2).packetCount, 0u);
+
+	queue.Clear();
+	CHECK_EQ(queue.GetPacketCount(), 0u);
+	CHECK_EQ(queue.GetStatistics(0).packetCount, 0u);
+}
+
+TEST_CASE(InstancedPacketsShareStateAcrossRanges)
+{
+	FakeResources resources;
+	const Material material{};
+
+	RenderQueue::PartState state{};
+	state.material = &material;
+	state.textureDiffuse = resources.Get<ID3D11ShaderResourceView>(0);
+	state.vertexBuffer = resources.Get<RenderBuffer>(1);
+	state.indexBuffer = resources.Get<RenderBuffer>(2);
+	state.indexCount = 60;
+	state.vertexStride = 32;
+
+	RenderQueue queue;
+	RenderBuffer* instanceBuffer = resources.Get<RenderBuffer>(3);
+	queue.SubmitPartInstanced(0, 0, state, { instanceBuffer, 48, 0, 10 });
+	queue.SubmitPartInstanced(0, 0, state, { instanceBuffer, 48, 10, 20 });
+	// 空范围不产生绘制包
+	queue.SubmitPartInstanced(0, 0, state, { instanceBuffer, 48, 30, 0 });
+	// 另一个实例缓冲区需要重新绑定顶点缓冲区
+	queue.SubmitPartInstanced(0, 0, state, { resources.Get<RenderBuffer>(4), 48, 0, 5 });
+	CHECK_EQ(queue.GetPacketCount(), 3u);
+
+	queue.Sort();
+	const RenderQueue::Statistics statistics = queue.GetStatistics(0);
+	CHECK_EQ(statistics.packetCount, 3u);
+	CHECK_EQ(statistics.pipelineChanges, 1u);
+	CHECK_EQ(statistics.textureSetChanges, 1u);
+	CHECK_EQ(statistics.materialChanges, 1u);
+	CHECK_EQ(statistics.vertexBufferChanges, 2u);
+	CHECK_EQ(statistics.indexBufferChanges, 1u);
+}
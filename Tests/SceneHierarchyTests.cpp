@@ -0,0 +1,293 @@
+#include "TestHarness.h"
+#include "SceneHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+	// 与GameObject提供相同接口的节点,HierarchyBounds用于与递归实现比较
+	struct Node
+	{
+		const BasicTransform& GetTransform() const { return transform; }
+		const std::vector<Node*>& GetChildren() const { return children; }
+		bool HasLocalBoundingBox() const { return hasBox; }
+		BoundingBox GetLocalBoundingBox() const { return localBox; }
+		HierarchyBounds& GetHierarchyBounds() { return bounds; }
+
+		BasicTransform transform{ { 1.0f, 1.0f, 1.0f }, {}, {} };
+		std::vector<Node*> children;
+		bool hasBox = true;
+		BoundingBox localBox{ XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.5f, 0.5f, 0.5f) };
+		HierarchyBounds bounds;
+	};
+
+	// 随机树: 随机的父节点、缩放、旋转与位置,部分节点没有模型
+	struct RandomTree
+	{
+		RandomTree(const UINT seed, const UINT count)
+		{
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> offset(-6.0f, 6.0f);
+			std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+			std::uniform_real_distribution<float> scale(0.8f, 1.25f);
+			std::uniform_int_distribution<int> coin(0, 3);
+
+			nodes.push_back(std::make_unique<Node>());
+			for (UINT i = 1; i < count; ++i)
+			{
+				std::uniform_int_distribution<UINT> pickParent(0, i - 1);
+				Node* parent = nodes[pickParent(rng)].get();
+				nodes.push_back(std::make_unique<Node>());
+				Node* node = nodes.back().get();
+				node->transform.SetScale(scale(rng), scale(rng), scale(rng));
+				node->transform.SetRotation(angle(rng) * 0.1f, angle(rng), 0.0f);
+				node->transform.SetPosition(offset(rng), offset(rng) * 0.3f, offset(rng));
+				node->hasBox = coin(rng) != 0;
+				parent->children.push_back(node);
+			}
+		}
+
+		Node& GetRoot() const { return *nodes.front(); }
+
+		std::vector<std::unique_ptr<Node>> nodes;
+	};
+
+	BoundingFrustum XM_CALLCONV MakeFrustum(FXMVECTOR eye, FXMVECTOR direction)
+	{
+		BoundingFrustum frustum(XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.5f, 200.0f));
+		const XMMATRIX view = XMMatrixLookToLH(eye, direction, g_XMIdentityR1);
+		frustum.Transform(frustum, XMMatrixInverse(nullptr, view));
+		return frustum;
+	}
+
+	struct DrawRecorder
+	{
+		void operator()(Node& node, FXMMATRIX world)
+		{
+			drawn.push_back(&node);
+			XMFLOAT4X4 matrix;
+			XMStoreFloat4x4(&matrix, world);
+			worlds.push_back(matrix);
+		}
+
+		std::vector<Node*> drawn;
+		std::vector<XMFLOAT4X4> worlds;
+	};
+
+	bool NearEqual(const XMFLOAT4X4& lhs, const XMFLOAT4X4& rhs)
+	{
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				if (std::fabs(lhs.m[i][j] - rhs.m[i][j]) > 1e-3f)
+					return false;
+		return true;
+	}
+
+	// 深度优先的HierarchyCulling与按层展开的SceneHierarchy应当得到相同的世界矩阵
+	void CheckWorldMatricesMatchRecursive(const RandomTree& tree, const SceneHierarchy<Node>& hierarchy)
+	{
+		HierarchyCulling<Node>::UpdateBounds(tree.GetRoot(), XMMatrixIdentity(), XMMatrixIdentity());
+		const std::vector<XMFLOAT4X4>& worlds = hierarchy.GetWorldMatrices();
+		CHECK_EQ(worlds.size(), tree.nodes.size());
+		for (UINT i = 0; i < hierarchy.GetNodeCount(); ++i)
+			CHECK(NearEqual(worlds[i], hierarchy.GetNode(i)->bounds.world));
+	}
+}
+
+TEST_CASE(BuildOrdersNodesByDepth)
+{
+	const RandomTree tree(40, 300);
+	SceneHierarchy<Node> hierarchy;
+	hierarchy.Build(&tree.GetRoot());
+	CHECK_EQ(hierarchy.GetNodeCount(), 300u);
+	CHECK_EQ(hierarchy.GetLevelBegin(0), 0u);
+	CHECK_EQ(hierarchy.GetLevelEnd(0), 1u);
+	CHECK_EQ(hierarchy.GetLevelEnd(hierarchy.GetLevelCount() - 1), 300u);
+
+	// 每个节点恰好出现一次,父节点位于上一层,且与子节点列表一致
+	std::vector<Node*> seen;
+	for (UINT level = 0; level < hierarchy.GetLevelCount(); ++level)
+	{
+		CHECK(hierarchy.GetLevelBegin(level) < hierarchy.GetLevelEnd(level));
+		for (UINT i = hierarchy.GetLevelBegin(level); i < hierarchy.GetLevelEnd(level); ++i)
+		{
+			Node* node = hierarchy.GetNode(i);
+			seen.push_back(node);
+
+			const UINT parent = hierarchy.GetParentIndex(i);
+			if (level == 0)
+			{
+				CHECK_EQ(parent, SceneHierarchy<Node>::InvalidIndex);
+				continue;
+			}
+			CHECK(parent >= hierarchy.GetLevelBegin(level - 1));
+			CHECK(parent < hierarchy.GetLevelEnd(level - 1));
+			const std::vector<Node*>& siblings = hierarchy.GetNode(parent)->children;
+			CHECK(std::find(siblings.begin(), siblings.end(), node) != siblings.end());
+		}
+	}
+	std::sort(seen.begin(), seen.end());
+	CHECK(std::unique(seen.begin(), seen.end()) == seen.end());
+	CHECK_EQ(seen.size(), tree.nodes.size());
+
+	hierarchy.Clear();
+	CHECK_EQ(hierarchy.GetNodeCount(), 0u);
+	CHECK_EQ(hierarchy.GetLevelCount(), 0u);
+}
+
+TEST_CASE(WorldMatricesMatchRecursiveComposition)
+{
+	RandomTree tree(41, 300);
+	SceneHierarchy<Node> hierarchy;
+	hierarchy.Build(&tree.GetRoot());
+	hierarchy.Update();
+	CheckWorldMatricesMatchRecursive(tree, hierarchy);
+
+	// 修改变换后再次更新,不需要重新构建
+	for (size_t i = 0; i < tree.nodes.size(); i += 7)
+		tree.nodes[i]->transform.Translate(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), 2.5f);
+	tree.GetRoot().transform.SetRotation(0.0f, 1.0f, 0.0f);
+	hierarchy.Update();
+	CheckWorldMatricesMatchRecursive(tree, hierarchy);
+}
+
+TEST_CASE(WideLevelsUpdateInParallel)
+{
+	// 第二、三层的节点数目超过ParallelThreshold,走并行路径
+	const UINT width = SceneHierarchy<Node>::ParallelThreshold * 4;
+	RandomTree tree(42, 1);
+	Node& root = tree.GetRoot();
+	root.transform.SetScale(1.1f, 0.9f, 1.0f);
+	for (UINT i = 0; i < width; ++i)
+	{
+		tree.nodes.push_back(std::make_unique<Node>());
+		Node* child = tree.nodes.back().get();
+		child->transform.SetRotation(0.0f, 0.01f * i, 0.0f);
+		child->transform.SetPosition(static_cast<float>(i % 32), 0.0f, static_cast<float>(i / 32));
+		root.children.push_back(child);
+
+		tree.nodes.push_back(std::make_unique<Node>());
+		Node* grandChild = tree.nodes.back().get();
+		grandChild->transform.SetPosition(0.0f, 1.0f, 0.5f);
+		child->children.push_back(grandChild);
+	}
+
+	SceneHierarchy<Node> hierarchy;
+	hierarchy.Build(&root);
+	CHECK_EQ(hierarchy.GetLevelCount(), 3u);
+	CHECK_EQ(hierarchy.GetLevelEnd(1) - hierarchy.GetLevelBegin(1), width);
+	hierarchy.Update();
+	CheckWorldMatricesMatchRecursive(tree, hierarchy);
+}
+
+TEST_CASE(CullMatchesHierarchyCulling)
+{
+	RandomTree tree(43, 300);
+	SceneHierarchy<Node> hierarchy;
+	hierarchy.Build(&tree.GetRoot());
+	hierarchy.Update();
+	HierarchyCulling<Node>::UpdateBounds(tree.GetRoot(), XMMatrixIdentity(), XMMatrixIdentity());
+
+	for (int frame = 0; frame < 8; ++frame)
+	{
+		const float yaw = XM_PIDIV4 * frame;
+		const BoundingFrustum frustum = MakeFrustum(XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f), XMVectorSet(std::sin(yaw), 0.0f, std::cos(yaw), 0.0f));
+
+		HierarchyCullStatistics expectedStatistics{};
+		DrawRecorder expected;
+		HierarchyCulling<Node>::Cull(tree.GetRoot(), frustum, false, &expectedStatistics, expected);
+
+		HierarchyCullStatistics statistics{};
+		DrawRecorder actual;
+		hierarchy.Cull(frustum, &statistics, actual);
+
+		// 遍历顺序不同(先序与按层),绘制的节点集合与统计信息相同
+		CHECK(!actual.drawn.empty());
+		CHECK(actual.drawn.size() < tree.nodes.size());
+		CHECK_EQ(statistics.testedNodes, expectedStatistics.testedNodes);
+		CHECK_EQ(statistics.acceptedNodes, expectedStatistics.acceptedNodes);
+		CHECK_EQ(statistics.culledNodes, expectedStatistics.culledNodes);
+		CHECK_EQ(actual.drawn.size(), expected.drawn.size());
+		for (size_t i = 0; i < actual.drawn.size(); ++i)
+		{
+			const auto it = std::find(expected.drawn.begin(), expected.drawn.end(), actual.drawn[i]);
+			CHECK(it != expected.drawn.end());
+			if (it != expected.drawn.end())
+				CHECK(NearEqual(actual.worlds[i], expected.worlds[it - expected.drawn.begin()]));
+		}
+	}
+}
+
+TEST_CASE(ConcurrentCullsWithDifferentVolumesDoNotInterfere)
+{
+	RandomTree tree(45, 2000);
+	SceneHierarchy<Node> hierarchy;
+	hierarchy.Build(&tree.GetRoot());
+	hierarchy.Update();
+
+	// 与阴影Pass、主Pass在不同的延迟上下文上同时录制相同: 同一个层次,两个不同的包围体
+	const BoundingFrustum frustum = MakeFrustum(XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f));
+	const BoundingOrientedBox lightVolume(XMFLOAT3(-10.0f, 0.0f, -10.0f), XMFLOAT3(12.0f, 40.0f, 8.0f), XMFLOAT4(0.0f, 0.38268343f, 0.0f, 0.92387953f));
+
+	DrawRecorder expectedFrustum, expectedLight;
+	hierarchy.Cull(frustum, nullptr, expectedFrustum);
+	hierarchy.Cull(lightVolume, nullptr, expectedLight);
+	CHECK(!expectedFrustum.drawn.empty());
+	CHECK(!expectedLight.drawn.empty());
+	CHECK(expectedFrustum.drawn != expectedLight.drawn);
+
+	// 重复多次增加两个线程交错执行的机会,每次的结果都应当与单独剔除时相同
+	constexpr int Repeats = 200;
+	int frustumMismatches = 0, lightMismatches = 0;
+	const SceneHierarchy<Node>& shared = hierarchy;
+	std::thread frustumThread([&]()
+		{
+			for (int i = 0; i < Repeats; ++i)
+			{
+				DrawRecorder recorder;
+				shared.Cull(frustum, nullptr, recorder);
+				frustumMismatches += recorder.drawn != expectedFrustum.drawn;
+			}
+		});
+	std::thread lightThread([&]()
+		{
+			for (int i = 0; i < Repeats; ++i)
+			{
+				DrawRecorder recorder;
+				shared.Cull(lightVolume, nullptr, recorder);
+				lightMismatches += recorder.drawn != expectedLight.drawn;
+			}
+		});
+	frustumThread.join();
+	lightThread.join();
+
+	CHECK_EQ(frustumMismatches, 0);
+	CHECK_EQ(lightMismatches, 0);
+}
+
+TEST_CASE(OffscreenTreeCullsWithOneTest)
+{
+	RandomTree tree(44, 50);
+	SceneHierarchy<Node> hierarchy;
+	hierarchy.Build(&tree.GetRoot());
+	hierarchy.Update();
+
+	// 摄像机位于场景之外并背对场景
+	const BoundingFrustum frustum = MakeFrustum(XMVectorSet(0.0f, 0.0f, -100.0f, 1.0f), XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f));
+	HierarchyCullStatistics statistics{};
+	DrawRecorder recorder;
+	hierarchy.Cull(frustum, &statistics, recorder);
+	CHECK(recorder.drawn.empty());
+	CHECK_EQ(statistics.testedNodes, 1u);
+	CHECK_EQ(statistics.culledNodes, 50u);
+
+	// 统计信息可以为空
+	hierarchy.Cull(frustum, nullptr, recorder);
+	CHECK(recorder.drawn.empty());
+}
@@ -0,0 +1,137 @@
+#include "TestHarness.h"
+#include "ShadowCulling.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// 光源从y = 50处竖直向下照射,投影体覆盖x、z∈[-50, 50],y∈[-50, 50]
+	const float LightWidth = 100.0f, LightHeight = 100.0f, LightNearZ = 0.0f, LightFarZ = 100.0f;
+
+	XMMATRIX LightView()
+	{
+		return XMMatrixLookAtLH(XMVectorSet(0.0f, 50.0f, 0.0f, 1.0f), g_XMZero, g_XMIdentityR2);
+	}
+
+	// 摄像机位于(0, 2, -40)水平看向+z,可见范围大致为z∈[-39, -10]
+	XMMATRIX CameraView()
+	{
+		return XMMatrixLookAtLH(XMVectorSet(0.0f, 2.0f, -40.0f, 1.0f), XMVectorSet(0.0f, 2.0f, 0.0f, 1.0f), g_XMIdentityR1);
+	}
+
+	XMMATRIX CameraProj()
+	{
+		return XMMatrixPerspectiveFovLH(XM_PI / 3.0f, 1.0f, 1.0f, 30.0f);
+	}
+
+	ShadowCulling CreateCulling()
+	{
+		ShadowCulling culling;
+		culling.SetLightVolume(LightView(), LightWidth, LightHeight, LightNearZ, LightFarZ);
+		culling.SetCameraFrustum(CameraView(), CameraProj());
+		return culling;
+	}
+
+	Bounds::Aabb Box(const float x, const float y, const float z)
+	{
+		return { { x, y, z }, { 1.0f, 1.0f, 1.0f } };
+	}
+
+	// 以DirectXCollision的精确OBB测试实现的参考结果
+	bool ReferenceIsCasterVisible(const BoundingBox& box)
+	{
+		const XMMATRIX lightView = LightView();
+		const XMMATRIX invLightView = XMMatrixInverse(nullptr, lightView);
+
+		BoundingOrientedBox lightVolume;
+		BoundingOrientedBox::CreateFromBoundingBox(lightVolume, BoundingBox(
+			XMFLOAT3(0.0f, 0.0f, (LightNearZ + LightFarZ) * 0.5f),
+			XMFLOAT3(LightWidth * 0.5f, LightHeight * 0.5f, (LightFarZ - LightNearZ) * 0.5f)));
+		lightVolume.Transform(lightVolume, invLightView);
+		if (!lightVolume.Intersects(box))
+			return false;
+
+		BoundingBox lightSpaceBox;
+		box.Transform(lightSpaceBox, lightView);
+		const float minZ = lightSpaceBox.Center.z - lightSpaceBox.Extents.z;
+		const float maxZ = (std::max)(lightSpaceBox.Center.z + lightSpaceBox.Extents.z, LightFarZ);
+		lightSpaceBox.Center.z = (minZ + maxZ) * 0.5f;
+		lightSpaceBox.Extents.z = (maxZ - minZ) * 0.5f;
+
+		BoundingOrientedBox shadowVolume;
+		BoundingOrientedBox::CreateFromBoundingBox(shadowVolume, lightSpaceBox);
+		shadowVolume.Transform(shadowVolume, invLightView);
+
+		BoundingFrustum frustum(CameraProj());
+		frustum.Transform(frustum, XMMatrixInverse(nullptr, CameraView()));
+		return frustum.Intersects(shadowVolume);
+	}
+}
+
+TEST_CASE(ClassifiesCasters)
+{
+	ShadowCulling culling = CreateCulling();
+
+	// 位于摄像机视锥体内
+	CHECK(culling.IsCasterVisible(Box(0.0f, 5.0f, -20.0f)));
+	// 位于视锥体上方,但阴影向下落入视锥体
+	CHECK(culling.IsCasterVisible(Box(0.0f, 40.0f, -20.0f)));
+	// 阴影落在摄像机身后
+	CHECK(!culling.IsCasterVisible(Box(0.0f, 5.0f, 30.0f)));
+	// 在光源投影体之外
+	CHECK(!culling.IsCasterVisible(Box(80.0f, 5.0f, -20.0f)));
+
+	const ShadowCulling::Statistics& statistics = culling.GetStatistics();
+	CHECK_EQ(statistics.testedCasters, 4u);
+	CHECK_EQ(statistics.outsideLightVolume, 1u);
+	CHECK_EQ(statistics.outsideReceivers, 1u);
+
+	// 重新设置摄像机时统计信息清零
+	culling.SetCameraFrustum(CameraView(), CameraProj());
+	CHECK_EQ(culling.GetStatistics().testedCasters, 0u);
+}
+
+TEST_CASE(LightVolumeMatchesDirectXCollision)
+{
+	const ShadowCulling culling = CreateCulling();
+	const Bounds::Obb& volume = culling.GetLightVolume();
+
+	// 竖直向下的光源投影体中心位于原点,沿y方向的半长为50
+	BoundingOrientedBox expected;
+	BoundingOrientedBox::CreateFromBoundingBox(expected, BoundingBox(XMFLOAT3(0.0f, 0.0f, 50.0f), XMFLOAT3(50.0f, 50.0f, 50.0f)));
+	expected.Transform(expected, XMMatrixInverse(nullptr, LightView()));
+
+	CHECK_NEAR(volume.center.x, expected.Center.x, 1e-3f);
+	CHECK_NEAR(volume.center.y, expected.Center.y, 1e-3f);
+	CHECK_NEAR(volume.center.z, expected.Center.z, 1e-3f);
+	CHECK(Bounds::ToBoundingOrientedBox(volume).Contains(XMVectorSet(49.0f, -49.0f, 49.0f, 1.0f)) == CONTAINS);
+	CHECK(Bounds::ToBoundingOrientedBox(volume).Contains(XMVectorSet(0.0f, 0.0f, 51.0f, 1.0f)) == DISJOINT);
+}
+
+TEST_CASE(ConservativeAgainstExactReference)
+{
+	// Bounds.h的测试只会比精确的OBB测试更保守: 参考结果可见的投射者一定可见
+	ShadowCulling culling = CreateCulling();
+	std::mt19937 rng(8);
+	std::uniform_real_distribution<float> position(-80.0f, 80.0f);
+	std::uniform_real_distribution<float> extent(0.2f, 4.0f);
+
+	UINT referenceVisible = 0, visible = 0;
+	for (int i = 0; i < 4000; ++i)
+	{
+		const BoundingBox box(XMFLOAT3(position(rng), position(rng), position(rng)), XMFLOAT3(extent(rng), extent(rng), extent(rng)));
+		const bool isReferenceVisible = ReferenceIsCasterVisible(box);
+		const bool isVisible = culling.IsCasterVisible(Bounds::ToAabb(box));
+		if (isReferenceVisible)
+			CHECK(isVisible);
+		referenceVisible += isReferenceVisible ? 1 : 0;
+		visible += isVisible ? 1 : 0;
+	}
+
+	// 仍然能剔除大部分投射者
+	CHECK(referenceVisible > 0);
+	CHECK(visible < 4000u / 2);
+}
@@ -0,0 +1,180 @@
+#include "TestHarness.h"
+#include "StaticBatchBuilder.h"
+
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// 与VertexPosNormalTangentTex布局相同的顶点
+	struct Vertex
+	{
+		XMFLOAT3 pos;
+		XMFLOAT3 normal;
+		XMFLOAT4 tangent;
+		XMFLOAT2 tex;
+	};
+
+	using Builder = StaticBatchBuilder<Vertex>;
+
+	// 一个四边形: 4个顶点,6个索引
+	struct Quad
+	{
+		std::vector<Vertex> vertices
+		{
+			{ XMFLOAT3(-1.0f, 0.0f, -1.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+			{ XMFLOAT3(-1.0f, 0.0f, 1.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
+			{ XMFLOAT3(1.0f, 0.0f, 1.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
+			{ XMFLOAT3(1.0f, 0.0f, -1.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) }
+		};
+		std::vector<DWORD> indices{ 0, 1, 2, 2, 3, 0 };
+	};
+
+	Material MakeMaterial(const float diffuse)
+	{
+		Material material{};
+		material.diffuse = XMFLOAT4(diffuse, diffuse, diffuse, 1.0f);
+		return material;
+	}
+
+	bool SameRange(const Builder::DrawRange& range, const UINT batch, const UINT startIndex, const UINT indexCount, const INT baseVertex)
+	{
+		return range.batch == batch && range.startIndex == startIndex && range.indexCount == indexCount && range.baseVertex == baseVertex;
+	}
+}
+
+TEST_CASE(TextureIdsAndMaterialsKeyBatches)
+{
+	const Quad quad;
+	const Material stone = MakeMaterial(0.5f);
+	const Material brick = MakeMaterial(0.8f);
+
+	Builder builder;
+	builder.Add(quad.vertices, quad.indices, stone, 1, 2, XMMatrixIdentity());
+	builder.Add(quad.vertices, quad.indices, stone, 1, 2, XMMatrixTranslation(3.0f, 0.0f, 0.0f));
+	// 法线贴图不同
+	builder.Add(quad.vertices, quad.indices, stone, 1, 0, XMMatrixIdentity());
+	// 材质不同
+	builder.Add(quad.vertices, quad.indices, brick, 1, 2, XMMatrixIdentity());
+	builder.Build();
+
+	const std::vector<Builder::Batch>& batches = builder.GetBatches();
+	CHECK_EQ(batches.size(), 3u);
+	CHECK_EQ(batches[0].texDiffuse, 1u);
+	CHECK_EQ(batches[0].texNormalMap, 2u);
+	CHECK_EQ(batches[0].vertexCount, 8u);
+	CHECK_EQ(batches[0].indexCount, 12u);
+	CHECK_EQ(batches[1].texNormalMap, 0u);
+	CHECK_EQ(batches[2].baseVertex, 12u);
+	CHECK_EQ(batches[2].startIndex, 18u);
+
+	const std::vector<Builder::Source>& sources = builder.GetSources();
+	CHECK_EQ(sources.size(), 4u);
+	CHECK_EQ(sources[1].batch, 0u);
+	CHECK_EQ(sources[1].startIndex, 6u);
+	CHECK_EQ(sources[3].batch, 2u);
+
+	// 批次内第二个网格的索引相对于批次的起始顶点,顶点已经变换到世界空间
+	const std::vector<DWORD>& indices = builder.GetIndices();
+	CHECK_EQ(indices.size(), 24u);
+	CHECK_EQ(indices[6], 4u);
+	CHECK_EQ(indices[19], 1u);
+	CHECK_NEAR(builder.GetVertices()[4].pos.x, 2.0f, 1e-5f);
+
+	// 所有来源可见时每个批次一个范围
+	std::vector<Builder::DrawRange> ranges;
+	CHECK_EQ(builder.BuildDrawRanges(ranges), 3u);
+	CHECK(SameRange(ranges[0], 0, 0, 12, 0));
+	CHECK(SameRange(ranges[1], 1, 12, 6, 8));
+	CHECK(SameRange(ranges[2], 2, 18, 6, 12));
+
+	builder.ReleaseGeometry();
+	CHECK(builder.GetVertices().empty());
+	CHECK(builder.GetIndices().empty());
+	CHECK_EQ(builder.BuildDrawRanges(ranges), 3u);
+}
+
+TEST_CASE(AdjacentSourcesMergeIntoOneRange)
+{
+	const Quad quad;
+	const Material stone = MakeMaterial(0.5f);
+
+	Builder builder;
+	for (int i = 0; i < 5; ++i)
+		builder.Add(quad.vertices, quad.indices, stone, 1, 2, XMMatrixTranslation(2.0f * i, 0.0f, 0.0f));
+	builder.Build();
+
+	std::vector<Builder::DrawRange> ranges;
+	CHECK_EQ(builder.BuildDrawRanges({ 0, 1, 2, 3, 4 }, ranges), 1u);
+	CHECK(SameRange(ranges[0], 0, 0, 30, 0));
+
+	// 可见来源的顺序不影响结果
+	CHECK_EQ(builder.BuildDrawRanges({ 3, 1, 2 }, ranges), 1u);
+	CHECK(SameRange(ranges[0], 0, 6, 18, 0));
+
+	// 中间的来源不可见时拆分为两个范围
+	CHECK_EQ(builder.BuildDrawRanges({ 4, 0, 1, 3 }, ranges), 2u);
+	CHECK(SameRange(ranges[0], 0, 0, 12, 0));
+	CHECK(SameRange(ranges[1], 0, 18, 12, 0));
+
+	CHECK_EQ(builder.BuildDrawRanges({}, ranges), 0u);
+	CHECK(ranges.empty());
+}
+
+TEST_CASE(DuplicateSourcesDrawOnce)
+{
+	const Quad quad;
+	const Material stone = MakeMaterial(0.5f);
+
+	Builder builder;
+	for (int i = 0; i < 4; ++i)
+		builder.Add(quad.vertices, quad.indices, stone, 1, 2, XMMatrixIdentity());
+	builder.Build();
+
+	// 例如同一个来源同时被两个剔除结果(视锥体与遮挡)报告为可见
+	std::vector<Builder::DrawRange> ranges;
+	CHECK_EQ(builder.BuildDrawRanges({ 1, 1, 0, 1 }, ranges), 1u);
+	CHECK(SameRange(ranges[0], 0, 0, 12, 0));
+
+	CHECK_EQ(builder.BuildDrawRanges({ 3, 3 }, ranges), 1u);
+	CHECK(SameRange(ranges[0], 0, 18, 6, 0));
+
+	// 重复的来源不会把不相邻的两个范围连起来
+	CHECK_EQ(builder.BuildDrawRanges({ 3, 0, 3, 0 }, ranges), 2u);
+	CHECK(SameRange(ranges[0], 0, 0, 6, 0));
+	CHECK(SameRange(ranges[1], 0, 18, 6, 0));
+}
+
+TEST_CASE(RangesAreOrderedByBatchAndNeverMergeAcrossBatches)
+{
+	const Quad quad;
+	const Material stone = MakeMaterial(0.5f);
+	const Material brick = MakeMaterial(0.8f);
+
+	// 两个批次交替添加: 来源0、2、4属于批次0,来源1、3属于批次1,来源5属于批次2
+	Builder builder;
+	for (int i = 0; i < 5; ++i)
+		builder.Add(quad.vertices, quad.indices, i % 2 == 0 ? stone : brick, 1, 2, XMMatrixTranslation(2.0f * i, 0.0f, 0.0f));
+	builder.Add(quad.vertices, quad.indices, stone, 3, 2, XMMatrixIdentity());
+	builder.Build();
+	CHECK_EQ(builder.GetBatches().size(), 3u);
+
+	// 合并后批次0的最后一个来源与批次1的第一个来源在索引数组中首尾相接,但BaseVertex不同,不能合并
+	std::vector<Builder::DrawRange> ranges;
+	CHECK_EQ(builder.BuildDrawRanges({ 5, 3, 4, 1, 0, 2 }, ranges), 3u);
+	CHECK(SameRange(ranges[0], 0, 0, 18, 0));
+	CHECK(SameRange(ranges[1], 1, 18, 12, 12));
+	CHECK(SameRange(ranges[2], 2, 30, 6, 20));
+
+	// 每个批次只剩一个来源时按批次顺序排列
+	CHECK_EQ(builder.BuildDrawRanges({ 5, 1, 4 }, ranges), 3u);
+	CHECK(SameRange(ranges[0], 0, 12, 6, 0));
+	CHECK(SameRange(ranges[1], 1, 18, 6, 12));
+	CHECK(SameRange(ranges[2], 2, 30, 6, 20));
+
+	// 范围的总索引数与可见来源一致
+	CHECK_EQ(builder.BuildDrawRanges({ 4, 3 }, ranges), 2u);
+	CHECK_EQ(ranges[0].indexCount + ranges[1].indexCount, 12u);
+	CHECK(ranges[0].batch < ranges[1].batch);
+}
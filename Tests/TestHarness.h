@@ -0,0 +1,81 @@
+//***************************************************************************************
+// Author: life4gal(NiceT)(MIT License)
+//
+// 极简单元测试框架
+// TEST_CASE注册测试函数,CHECK系列宏记录失败但不中断当前测试,全部执行完后返回失败数目
+// Minimal test registry and assertion macros for the portable module tests.
+//***************************************************************************************
+
+#ifndef TESTHARNESS_H
+#define TESTHARNESS_H
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace TestHarness
+{
+	using TestFunction = void(*)();
+
+	struct TestCase
+	{
+		const char* name;
+		TestFunction function;
+	};
+
+	inline std::vector<TestCase>& GetTestCases()
+	{
+		static std::vector<TestCase> testCases;
+		return testCases;
+	}
+
+	inline int& GetFailureCount()
+	{
+		static int failureCount = 0;
+		return failureCount;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* name, const TestFunction function)
+		{
+			GetTestCases().push_back({ name, function });
+		}
+	};
+
+	inline void ReportFailure(const char* file, const int line, const char* expression)
+	{
+		++GetFailureCount();
+		std::printf("%s(%d): CHECK failed: %s\n", file, line, expression);
+	}
+
+	// 依次执行所有测试,返回失败的检查数目
+	inline int RunAll()
+	{
+		int failedCases = 0;
+		for (const TestCase& testCase : GetTestCases())
+		{
+			const int failuresBefore = GetFailureCount();
+			testCase.function();
+			const bool passed = GetFailureCount() == failuresBefore;
+			failedCases += passed ? 0 : 1;
+			std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", testCase.name);
+		}
+		std::printf("%d/%d test cases passed\n", static_cast<int>(GetTestCases().size()) - failedCases, static_cast<int>(GetTestCases().size()));
+		return GetFailureCount();
+	}
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static const TestHarness::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(expression) \
+	do { if (!(expression)) TestHarness::ReportFailure(__FILE__, __LINE__, #expression); } while (false)
+
+#define CHECK_EQ(lhs, rhs) CHECK((lhs) == (rhs))
+
+#define CHECK_NEAR(lhs, rhs, epsilon) CHECK(std::fabs((lhs) - (rhs)) <= (epsilon))
+
+#endif
@@ -0,0 +1,187 @@
+#include "TestHarness.h"
+#include "TransformStore.h"
+
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr float Epsilon = 1e-4f;
+
+	BasicTransform RandomTransform(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+		std::uniform_real_distribution<float> angle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		return BasicTransform(
+			XMFLOAT3(scale(rng), scale(rng), scale(rng)),
+			XMFLOAT3(angle(rng), angle(rng), angle(rng)),
+			XMFLOAT3(position(rng), position(rng), position(rng)));
+	}
+
+	bool SameMatrix(const XMFLOAT4X4& actual, FXMMATRIX expected)
+	{
+		XMFLOAT4X4 e;
+		XMStoreFloat4x4(&e, expected);
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				if (std::fabs(actual.m[i][j] - e.m[i][j]) > Epsilon * (std::fabs(e.m[i][j]) + 1.0f))
+					return false;
+		return true;
+	}
+}
+
+TEST_CASE(WorldMatricesMatchBasicTransform)
+{
+	std::mt19937 rng(1);
+	std::vector<BasicTransform> transforms;
+	TransformStore store;
+	for (int i = 0; i < 200; ++i)
+	{
+		transforms.push_back(RandomTransform(rng));
+		store.Create(transforms.back());
+	}
+
+	CHECK_EQ(store.UpdateWorldMatrices(), 200u);
+	CHECK_EQ(store.GetWorldMatrices().size(), 200u);
+	for (size_t i = 0; i < transforms.size(); ++i)
+		CHECK(SameMatrix(store.GetWorldMatrices()[i], transforms[i].GetLocalToWorldMatrix()));
+
+	// 欧拉角与BasicTransform的旋转顺序一致
+	const TransformStore::Handle handle = store.Create(BasicTransform());
+	store.SetRotationEuler(handle, XMFLOAT3(0.3f, -1.2f, 2.5f));
+	store.UpdateWorldMatrices();
+	BasicTransform expected;
+	expected.SetRotation(0.3f, -1.2f, 2.5f);
+	CHECK(SameMatrix(store.GetWorldMatrix(handle), expected.GetLocalToWorldMatrix()));
+}
+
+TEST_CASE(UpdatesOnlyDirtyInstances)
+{
+	TransformStore store;
+	std::vector<TransformStore::Handle> handles;
+	for (int i = 0; i < 100; ++i)
+		handles.push_back(store.Create(BasicTransform()));
+	CHECK_EQ(store.UpdateWorldMatrices(), 100u);
+	CHECK_EQ(store.UpdateWorldMatrices(), 0u);
+
+	// 逐个修改,覆盖一个字中的每一位以及跨字的位置
+	for (UINT i = 0; i < 100; ++i)
+	{
+		store.SetPosition(handles[i], XMFLOAT3(static_cast<float>(i), 0.0f, 0.0f));
+		CHECK_EQ(store.UpdateWorldMatrices(), 1u);
+		CHECK_EQ(store.GetWorldMatrix(handles[i])._41, static_cast<float>(i));
+		if (i > 0)
+			CHECK_EQ(store.GetWorldMatrix(handles[i - 1])._41, static_cast<float>(i - 1));
+	}
+
+	// 同一个实例修改多次只重建一次
+	store.SetScale(handles[31], XMFLOAT3(2.0f, 2.0f, 2.0f));
+	store.SetRotation(handles[31], XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	store.SetPosition(handles[32], XMFLOAT3(1.0f, 2.0f, 3.0f));
+	store.SetPosition(handles[99], XMFLOAT3(1.0f, 2.0f, 3.0f));
+	CHECK_EQ(store.UpdateWorldMatrices(), 3u);
+	CHECK_EQ(store.GetWorldMatrix(handles[31])._11, 2.0f);
+}
+
+TEST_CASE(HandlesSurviveSwapRemove)
+{
+	std::mt19937 rng(2);
+	TransformStore store;
+	std::vector<TransformStore::Handle> handles;
+	std::vector<XMFLOAT3> positions;
+	std::vector<bool> alive;
+	for (int i = 0; i < 150; ++i)
+	{
+		const BasicTransform transform = RandomTransform(rng);
+		handles.push_back(store.Create(transform));
+		positions.push_back(transform.GetPositionFloat3());
+		alive.push_back(true);
+	}
+	store.UpdateWorldMatrices();
+
+	std::uniform_int_distribution<size_t> pick(0, 149);
+	UINT aliveCount = 150;
+	for (int i = 0; i < 100; ++i)
+	{
+		const size_t index = pick(rng);
+		store.Destroy(handles[index]);
+		if (alive[index])
+			--aliveCount;
+		alive[index] = false;
+		CHECK(!store.IsValid(handles[index]));
+		CHECK_EQ(store.GetDenseIndex(handles[index]), TransformStore::InvalidIndex);
+	}
+	CHECK_EQ(store.GetCount(), aliveCount);
+
+	// 剩余的句柄仍然指向原来的数据,连续数组中的世界矩阵也随之移动
+	for (size_t i = 0; i < handles.size(); ++i)
+	{
+		if (!alive[i])
+			continue;
+		CHECK(store.IsValid(handles[i]));
+		const UINT denseIndex = store.GetDenseIndex(handles[i]);
+		CHECK(denseIndex < store.GetCount());
+		CHECK_EQ(store.GetPosition(handles[i]).x, positions[i].x);
+		CHECK_EQ(store.GetWorldMatrices()[denseIndex]._41, positions[i].x);
+	}
+
+	// 复用的句柄索引带有新的版本号,旧句柄不会指向新实例
+	size_t removed = 0;
+	while (alive[removed])
+		++removed;
+	const TransformStore::Handle reused = store.Create(BasicTransform());
+	CHECK(store.IsValid(reused));
+	CHECK(!store.IsValid(handles[removed]) || reused.index != handles[removed].index);
+	for (size_t i = 0; i < handles.size(); ++i)
+	{
+		if (!alive[i] && handles[i].index == reused.index)
+			CHECK(reused.generation != handles[i].generation);
+	}
+}
+
+TEST_CASE(DirtyBitMovesWithSwappedInstance)
+{
+	TransformStore store;
+	std::vector<TransformStore::Handle> handles;
+	for (int i = 0; i < 40; ++i)
+		handles.push_back(store.Create(BasicTransform()));
+	store.UpdateWorldMatrices();
+
+	// 最后一个实例被修改后移动到位置0,仍然需要重建
+	store.SetPosition(handles[39], XMFLOAT3(5.0f, 6.0f, 7.0f));
+	store.Destroy(handles[0]);
+	CHECK_EQ(store.GetDenseIndex(handles[39]), 0u);
+	CHECK_EQ(store.UpdateWorldMatrices(), 1u);
+	CHECK_EQ(store.GetWorldMatrix(handles[39])._42, 6.0f);
+
+	// 干净的实例移动到被修改过的位置上时不会被重建
+	store.SetPosition(handles[1], XMFLOAT3(1.0f, 1.0f, 1.0f));
+	store.Destroy(handles[1]);
+	CHECK_EQ(store.UpdateWorldMatrices(), 0u);
+
+	// 删除到恰好32个实例,最后一个字被移除
+	for (size_t i = 2; store.GetCount() > 32; ++i)
+		store.Destroy(handles[i]);
+	store.SetPosition(handles[8], XMFLOAT3(3.0f, 3.0f, 3.0f));
+	CHECK_EQ(store.UpdateWorldMatrices(), 1u);
+	CHECK_EQ(store.GetWorldMatrix(handles[8])._43, 3.0f);
+}
+
+TEST_CASE(ClearInvalidatesHandles)
+{
+	TransformStore store;
+	const TransformStore::Handle a = store.Create(BasicTransform());
+	const TransformStore::Handle b = store.Create(BasicTransform());
+	store.Clear();
+	CHECK_EQ(store.GetCount(), 0u);
+	CHECK(!store.IsValid(a));
+	CHECK(!store.IsValid(b));
+	CHECK_EQ(store.UpdateWorldMatrices(), 0u);
+
+	const TransformStore::Handle c = store.Create(BasicTransform());
+	CHECK(store.IsValid(c));
+	CHECK(!store.IsValid(a));
+	CHECK_EQ(store.UpdateWorldMatrices(), 1u);
+}